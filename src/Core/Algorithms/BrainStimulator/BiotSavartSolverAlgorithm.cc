@@ -28,6 +28,7 @@
  
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/BrainStimulator/BiotSavartSolverAlgorithm.h>
+#include <Core/Algorithms/BrainStimulator/BiotSavartTreecode.h>
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
@@ -66,7 +67,8 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 			  numprocessors_(Parallel::NumCores()),
 			  barrier_("BSV KernelBase Barrier", numprocessors_),
 			  typeOut(t),
-			  matOut(0)
+			  matOut(0),
+			  treecodeTolerance_(0.0)
 			{
 			}
 			
@@ -77,6 +79,13 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 			//! Local entry function, must be implemented by each specific kernel
 			virtual bool Integrate(FieldHandle& mesh, FieldHandle& coil, MatrixHandle& outdata) = 0;
 
+			//! Sum with the treecode to this relative accuracy, 0 for direct summation
+			void SetTreecodeTolerance(double tolerance)
+			{
+				assert(tolerance >= 0.0);
+				treecodeTolerance_ = tolerance;
+			}
+
 	
 			//! Global reference counting
 			int ref_cnt;
@@ -106,6 +115,9 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 			DenseMatrix *matOut;
 			MatrixHandle matOutHandle;
 
+			//! treecode accuracy, 0 for direct summation
+			double treecodeTolerance_;
+
 			bool PreIntegration( FieldHandle& mesh, FieldHandle& coil )
 			{
 					this->vmesh = mesh->vmesh();
@@ -169,6 +181,29 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 				
 				return (true);
 			}
+
+			//! Complexity O(M*log(N)), the coil reduced to point sources of the given kernel
+			bool TreecodeIntegration(SourceKernel kernel, const std::vector<Point>& points, const std::vector<Vector>& strengths, MatrixHandle& outdata)
+			{
+				BiotSavartTreecode treecode(kernel, points, strengths, treecodeTolerance_);
+				algo_->remark("treecode of degree " + boost::lexical_cast<std::string>(treecode.degree()) +
+					" over " + boost::lexical_cast<std::string>(points.size()) + " sources");
+
+				Parallel::For(0, modelSize, [this, &treecode](size_t begins, size_t ends)
+				{
+					Point modelNode;
+					for (size_t iM = begins; iM < ends; iM++)
+					{
+						vmesh->get_node(modelNode, static_cast<VMesh::Node::index_type>(iM));
+						Vector F = treecode.evaluate(modelNode);
+						matOut->put(iM,0, F[0]);
+						matOut->put(iM,1, F[1]);
+						matOut->put(iM,2, F[2]);
+					}
+				}, 256);
+
+				return PostIntegration(outdata);
+			}
 		};
 		
 
@@ -224,6 +259,14 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 						coilNodes.push_back(Vector(enode2));
 					}
 
+					if (treecodeTolerance_ > 0.0)
+					{
+						std::vector<Point> points;
+						std::vector<Vector> strengths;
+						IntegrationSources(points, strengths);
+						return TreecodeIntegration(typeOut == 1 ? SourceKernel::CrossCube : SourceKernel::Inverse, points, strengths, outdata);
+					}
+
 					//! Start the multi threaded
 					Parallel::RunTasks([this](int i) { ParallelKernel(i); }, numprocessors_);
 					
@@ -252,6 +295,54 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 
 				//! keep nodes on the coil cached
 				std::vector<Vector> coilNodes;
+
+				//! The midpoints of the curve elements used by ParallelKernel and their
+				//! current elements, the same for every model node
+				void IntegrationSources(std::vector<Point>& points, std::vector<Vector>& strengths)
+				{
+					double current = 1.0;
+					double prevSegLen = 123456789.12345678;
+					int nips = 0;
+
+					for( size_t iC0 = 0, iC1 =1, iCV = 0; 
+						iC0 < coilNodes.size(); 
+						iC0+=2, iC1+=2, iCV++)
+					{
+						vcoilField->get_value(current,iCV);
+
+						current = current == 0.0 ? 1.0 : current;
+
+						const Vector& coilNodeThis = current >= 0.0 ? coilNodes[iC0] : coilNodes[iC1];
+						const Vector& coilNodeNext = current >= 0.0 ? coilNodes[iC1] : coilNodes[iC0];
+
+						double newSegLen = (coilNodeNext - coilNodeThis).length();
+
+						if(extstep > 0)
+						{
+							nips = newSegLen / extstep;
+						}
+						else if( Abs(prevSegLen - newSegLen ) > 0.00000001 )
+						{
+							prevSegLen = newSegLen;
+							nips =  AdjustNumberOfIntegrationPoints(newSegLen);
+						}
+
+						if( nips < 3 )
+						{
+							algo_->warning("integration step too big");
+						}
+
+						for(int iip = 0; iip < nips -1; iip++)
+						{
+							Vector v0 = Interpolate( coilNodeThis, coilNodeNext, static_cast<double>(iip) / static_cast<double>(nips) );
+							Vector v1 = Interpolate( coilNodeThis, coilNodeNext, static_cast<double>(iip+1) / static_cast<double>(nips) );
+
+							//! Biot-Savart sums with r = model node - midpoint
+							points.push_back( Point( (v0 + v1) / 2 ) );
+							strengths.push_back( 1.0e-7 * Abs(current) * (v1 - v0) );
+						}
+					}
+				}
 				
 				//! execute in parallel
 				void ParallelKernel(int proc_num)
@@ -478,6 +569,23 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 					
 					vmesh->synchronize(Mesh::NODES_E | Mesh::EDGES_E);					
 
+					if (treecodeTolerance_ > 0.0)
+					{
+						std::vector<Point> points(coilSize);
+						std::vector<Vector> strengths(coilSize);
+						Vector current;
+						for(VMesh::Elem::index_type iC = 0; iC < coilSize; iC++)
+						{
+							vcoilField->get_value(current,iC);
+							vcoilField->get_center(points[iC], iC);
+							strengths[iC] = current * ( vcoil->get_volume(iC) / (4.0 * M_PI) );
+
+							//! The field sum below uses R = center - model node
+							if(typeOut == 1) strengths[iC] = -strengths[iC];
+						}
+						return TreecodeIntegration(typeOut == 1 ? SourceKernel::CrossInverse : SourceKernel::Inverse, points, strengths, outdata);
+					}
+
 					//! Start the multi threaded
 					Parallel::RunTasks([this](int i) { ParallelKernel(i); }, numprocessors_);
 					
@@ -606,6 +714,21 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 					//needed?
 					vmesh->synchronize(Mesh::NODES_E | Mesh::EDGES_E);
 										
+					if (treecodeTolerance_ > 0.0)
+					{
+						std::vector<Point> points(coilSize);
+						std::vector<Vector> strengths(coilSize);
+						for(VMesh::Elem::index_type iC = 0; iC < coilSize; iC++)
+						{
+							vcoilField->get_value(strengths[iC],iC);
+							vcoilField->get_center(points[iC], iC);
+
+							//! The potential sum below uses R = dipole location - model node
+							strengths[iC] *= (typeOut == 1) ? 1.0e-7 : -1.0e-7;
+						}
+						return TreecodeIntegration(typeOut == 1 ? SourceKernel::Dipole : SourceKernel::CrossCube, points, strengths, outdata);
+					}
+
 
 					//! Start the multi threaded
 					Parallel::RunTasks([this](int i) { ParallelKernel(i); }, numprocessors_);
@@ -721,6 +844,17 @@ bool BiotSavartSolverAlgorithm::run(FieldHandle mesh, FieldHandle coil, MatrixHa
    error("Need data on coil mesh.");
    return (false);
   }
+
+  double tolerance = 0.0;
+  if (get(Parameters::UseTreecode).toBool())
+  {
+    tolerance = get(Parameters::TreecodeTolerance).toDouble();
+    if (tolerance <= 0.0)
+    {
+      error("Treecode tolerance needs to be positive.");
+      return (false);
+    }
+  }
 	  
   if( coil->vmesh()->is_curvemesh() )
   {
@@ -728,6 +862,7 @@ bool BiotSavartSolverAlgorithm::run(FieldHandle mesh, FieldHandle coil, MatrixHa
     {
       auto pwk = std::unique_ptr<KernelBase>(new PieceWiseKernel(this, outtype));
       //pwk->SetIntegrationStep(this->istep);
+      pwk->SetTreecodeTolerance(tolerance);
       if( !pwk->Integrate(mesh,coil,outdata) )
       {
        error("Aborted during integration");
@@ -745,6 +880,7 @@ bool BiotSavartSolverAlgorithm::run(FieldHandle mesh, FieldHandle coil, MatrixHa
    if((coil->vfield()->is_lineardata() || coil->vfield()->is_constantdata() ) && coil->vfield()->is_vector())
    {
     auto dp = std::unique_ptr<KernelBase>(new DipolesKernel(this, outtype));
+    dp->SetTreecodeTolerance(tolerance);
     if( !dp->Integrate(mesh,coil,outdata) )
       {
        error("Aborted during integration");
@@ -762,6 +898,7 @@ bool BiotSavartSolverAlgorithm::run(FieldHandle mesh, FieldHandle coil, MatrixHa
    if(  coil->vfield()->is_constantdata() && coil->vfield()->is_vector() )
    {
    auto vp = std::unique_ptr<KernelBase>(new VolumetricKernel(this, outtype));
+   vp->SetTreecodeTolerance(tolerance);
    if( !vp->Integrate(mesh,coil,outdata) )
       {
        error("Aborted during integration");
@@ -0,0 +1,316 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/BrainStimulator/BiotSavartTreecode.h>
+#include <Core/Thread/Parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::BrainStimulator;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+ALGORITHM_PARAMETER_DEF(BrainStimulator, UseTreecode);
+ALGORITHM_PARAMETER_DEF(BrainStimulator, TreecodeTolerance);
+
+namespace
+{
+  template <SourceKernel K>
+  inline Vector kernel_value(const Vector& r, const Vector& s)
+  {
+    const double d2 = r.length2();
+    const double d = std::sqrt(d2);
+    switch (K)
+    {
+    case SourceKernel::CrossCube:
+      return Cross(s, r) * (1.0 / (d2 * d));
+    case SourceKernel::Inverse:
+      return s * (1.0 / d);
+    case SourceKernel::CrossInverse:
+      return Cross(s, r) * (1.0 / d);
+    case SourceKernel::Dipole:
+    default:
+      return r * (3.0 * Dot(s, r) / (d2 * d2 * d)) - s * (1.0 / (d2 * d));
+    }
+  }
+
+  /// Weights of the Lagrange polynomials through the Chebyshev points
+  /// cos(k*pi/n), k = 0..n, at t in [-1, 1], in barycentric form
+  void lagrange_weights(int n, double t, double* weights)
+  {
+    if (n == 0)
+    {
+      weights[0] = 1.0;
+      return;
+    }
+    double total = 0.0;
+    for (int k = 0; k <= n; ++k)
+    {
+      const double diff = t - std::cos(k * M_PI / n);
+      if (diff == 0.0)
+      {
+        std::fill(weights, weights + n + 1, 0.0);
+        weights[k] = 1.0;
+        return;
+      }
+      double w = (k % 2 == 0) ? 1.0 : -1.0;
+      if (k == 0 || k == n) w *= 0.5;
+      weights[k] = w / diff;
+      total += weights[k];
+    }
+    for (int k = 0; k <= n; ++k)
+      weights[k] /= total;
+  }
+}
+
+BiotSavartTreecode::BiotSavartTreecode(SourceKernel kernel, const std::vector<Point>& points,
+  const std::vector<Vector>& strengths, double tolerance) :
+  kernel_(kernel),
+  theta_(0.5),
+  points_(points),
+  strengths_(strengths),
+  position_(points.size())
+{
+  // At the opening angle 0.5 the relative error of the sums falls by about
+  // 0.6 digits per interpolation degree, starting from 0.5 at degree zero
+  tolerance = std::min(std::max(tolerance, 1e-12), 0.1);
+  degree_ = static_cast<int>(std::ceil((-std::log10(tolerance) - 0.3) / 0.6));
+  degree_ = std::min(std::max(degree_, 1), 12);
+  leafSize_ = std::max((degree_ + 1) * (degree_ + 1) * (degree_ + 1) / 2, 16);
+
+  std::vector<int> order(points.size());
+  std::iota(order.begin(), order.end(), 0);
+  position_.swap(order);
+  clusters_.reserve(4 * points.size() / leafSize_ + 1);
+  if (!points.empty())
+    split(0, static_cast<int>(points.size()));
+
+  // position_ holds the tree order while the tree is built
+  order.swap(position_);
+  position_.resize(order.size());
+  for (size_t p = 0; p < order.size(); ++p)
+  {
+    points_[p] = points[order[p]];
+    strengths_[p] = strengths[order[p]];
+    position_[order[p]] = static_cast<int>(p);
+  }
+
+  size_t proxies = 0;
+  for (Cluster& c : clusters_)
+  {
+    int count = 1;
+    for (int k = 0; k < 3; ++k)
+      count *= (c.hi[k] > c.lo[k]) ? degree_ + 1 : 1;
+    c.proxyBegin = static_cast<int>(proxies);
+    c.proxyEnd = static_cast<int>(proxies);
+    if (c.end - c.begin > count)
+    {
+      c.proxyEnd += count;
+      proxies += count;
+    }
+  }
+  proxyPoints_.resize(proxies);
+  proxyStrengths_.resize(proxies, Vector(0.0, 0.0, 0.0));
+
+  Parallel::For(0, clusters_.size(), [this](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; ++c)
+      if (clusters_[c].proxyEnd > clusters_[c].proxyBegin)
+        addProxies(clusters_[c]);
+  }, 16);
+}
+
+int BiotSavartTreecode::split(int begin, int end)
+{
+  const int index = static_cast<int>(clusters_.size());
+  clusters_.push_back(Cluster());
+
+  Cluster c;
+  c.begin = begin;
+  c.end = end;
+  c.sons[0] = c.sons[1] = -1;
+  for (int k = 0; k < 3; ++k)
+  {
+    c.lo[k] = std::numeric_limits<double>::max();
+    c.hi[k] = -std::numeric_limits<double>::max();
+  }
+  for (int p = begin; p < end; ++p)
+  {
+    const Point& q = points_[position_[p]];
+    for (int k = 0; k < 3; ++k)
+    {
+      c.lo[k] = std::min(c.lo[k], q[k]);
+      c.hi[k] = std::max(c.hi[k], q[k]);
+    }
+  }
+  c.center = Point(0.5 * (c.lo[0] + c.hi[0]), 0.5 * (c.lo[1] + c.hi[1]), 0.5 * (c.lo[2] + c.hi[2]));
+  c.radius = (Point(c.hi[0], c.hi[1], c.hi[2]) - c.center).length();
+
+  if (end - begin > leafSize_)
+  {
+    int axis = 0;
+    for (int k = 1; k < 3; ++k)
+      if (c.hi[k] - c.lo[k] > c.hi[axis] - c.lo[axis]) axis = k;
+
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(position_.begin() + begin, position_.begin() + middle, position_.begin() + end,
+      [this, axis](int a, int b) { return points_[a][axis] < points_[b][axis]; });
+    c.sons[0] = split(begin, middle);
+    c.sons[1] = split(middle, end);
+  }
+
+  clusters_[index] = c;
+  return index;
+}
+
+void BiotSavartTreecode::addProxies(Cluster& c)
+{
+  int n[3];
+  double mid[3], half[3];
+  for (int k = 0; k < 3; ++k)
+  {
+    n[k] = (c.hi[k] > c.lo[k]) ? degree_ : 0;
+    mid[k] = 0.5 * (c.lo[k] + c.hi[k]);
+    half[k] = 0.5 * (c.hi[k] - c.lo[k]);
+  }
+
+  int q = c.proxyBegin;
+  for (int a = 0; a <= n[0]; ++a)
+    for (int b = 0; b <= n[1]; ++b)
+      for (int d = 0; d <= n[2]; ++d, ++q)
+      {
+        proxyPoints_[q] = Point(mid[0] + half[0] * (n[0] ? std::cos(a * M_PI / n[0]) : 0.0),
+          mid[1] + half[1] * (n[1] ? std::cos(b * M_PI / n[1]) : 0.0),
+          mid[2] + half[2] * (n[2] ? std::cos(d * M_PI / n[2]) : 0.0));
+      }
+
+  std::vector<double> weights(3 * (degree_ + 1));
+  double* wx = &weights[0];
+  double* wy = wx + degree_ + 1;
+  double* wz = wy + degree_ + 1;
+  for (int p = c.begin; p < c.end; ++p)
+  {
+    const Point& y = points_[p];
+    lagrange_weights(n[0], n[0] ? (y.x() - mid[0]) / half[0] : 0.0, wx);
+    lagrange_weights(n[1], n[1] ? (y.y() - mid[1]) / half[1] : 0.0, wy);
+    lagrange_weights(n[2], n[2] ? (y.z() - mid[2]) / half[2] : 0.0, wz);
+
+    q = c.proxyBegin;
+    for (int a = 0; a <= n[0]; ++a)
+      for (int b = 0; b <= n[1]; ++b)
+      {
+        const double wab = wx[a] * wy[b];
+        for (int d = 0; d <= n[2]; ++d, ++q)
+          proxyStrengths_[q] += strengths_[p] * (wab * wz[d]);
+      }
+  }
+}
+
+template <SourceKernel K>
+Vector BiotSavartTreecode::sum(const Point& x, int skip) const
+{
+  Vector total(0.0, 0.0, 0.0);
+  if (clusters_.empty())
+    return total;
+
+  const int skipped = (skip >= 0) ? position_[skip] : -1;
+  const double theta2 = theta_ * theta_;
+
+  // The tree is balanced, its depth stays far below the stack size
+  int stack[128];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    const Cluster& c = clusters_[stack[--top]];
+    if (c.proxyEnd > c.proxyBegin && c.radius * c.radius < theta2 * (x - c.center).length2())
+    {
+      for (int q = c.proxyBegin; q < c.proxyEnd; ++q)
+        total += kernel_value<K>(x - proxyPoints_[q], proxyStrengths_[q]);
+      if (skipped >= c.begin && skipped < c.end)
+        total -= kernel_value<K>(x - points_[skipped], strengths_[skipped]);
+    }
+    else if (c.sons[0] < 0)
+    {
+      for (int p = c.begin; p < c.end; ++p)
+        if (p != skipped)
+          total += kernel_value<K>(x - points_[p], strengths_[p]);
+    }
+    else
+    {
+      stack[top++] = c.sons[1];
+      stack[top++] = c.sons[0];
+    }
+  }
+  return total;
+}
+
+Vector BiotSavartTreecode::evaluate(const Point& x, int skip) const
+{
+  switch (kernel_)
+  {
+  case SourceKernel::CrossCube:
+    return sum<SourceKernel::CrossCube>(x, skip);
+  case SourceKernel::Inverse:
+    return sum<SourceKernel::Inverse>(x, skip);
+  case SourceKernel::CrossInverse:
+    return sum<SourceKernel::CrossInverse>(x, skip);
+  case SourceKernel::Dipole:
+  default:
+    return sum<SourceKernel::Dipole>(x, skip);
+  }
+}
+
+Vector BiotSavartTreecode::evaluateDirect(const Point& x, int skip) const
+{
+  const int skipped = (skip >= 0) ? position_[skip] : -1;
+  Vector total(0.0, 0.0, 0.0);
+  for (int p = 0; p < static_cast<int>(points_.size()); ++p)
+    if (p != skipped)
+      total += contribution(kernel_, x - points_[p], strengths_[p]);
+  return total;
+}
+
+Vector BiotSavartTreecode::contribution(SourceKernel kernel, const Vector& r, const Vector& s)
+{
+  switch (kernel)
+  {
+  case SourceKernel::CrossCube:
+    return kernel_value<SourceKernel::CrossCube>(r, s);
+  case SourceKernel::Inverse:
+    return kernel_value<SourceKernel::Inverse>(r, s);
+  case SourceKernel::CrossInverse:
+    return kernel_value<SourceKernel::CrossInverse>(r, s);
+  case SourceKernel::Dipole:
+  default:
+    return kernel_value<SourceKernel::Dipole>(r, s);
+  }
+}
@@ -0,0 +1,118 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+///@file BiotSavartTreecode
+///@brief Fast evaluation of Biot-Savart sums over many point sources.
+///
+///@details
+/// The sources are sorted into a binary tree of bounding boxes. A cluster that
+/// is far enough from the evaluation point is replaced by a small set of proxy
+/// sources at the tensor Chebyshev points of its box, carrying the strengths
+/// of its sources spread with the barycentric Lagrange interpolation weights.
+/// Near clusters are summed directly. The approximation does not depend on
+/// the kernel, so the same tree serves all of the field and potential sums.
+
+#ifndef CORE_ALGORITHMS_BRAINSTIMULATOR_BIOTSAVARTTREECODE_H
+#define CORE_ALGORITHMS_BRAINSTIMULATOR_BIOTSAVARTTREECODE_H
+
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/GeometryPrimitives/Vector.h>
+#include <boost/noncopyable.hpp>
+#include <vector>
+#include <Core/Algorithms/BrainStimulator/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace BrainStimulator {
+
+  ALGORITHM_PARAMETER_DECL(UseTreecode);
+  ALGORITHM_PARAMETER_DECL(TreecodeTolerance);
+
+  /// The contribution of a source of strength s at y to the sum at x, r = x - y
+  enum class SourceKernel
+  {
+    CrossCube,      ///< s x r / |r|^3, the magnetic field of a current element
+    Inverse,        ///< s / |r|, the vector potential of a current element
+    CrossInverse,   ///< s x r / |r|
+    Dipole          ///< 3 r (s.r) / |r|^5 - s / |r|^3, the field of a magnetic dipole
+  };
+
+  class SCISHARE BiotSavartTreecode : boost::noncopyable
+  {
+  public:
+    /// tolerance is the targeted relative error of a sum; it sets the
+    /// interpolation degree of the proxy sources.
+    BiotSavartTreecode(SourceKernel kernel, const std::vector<Geometry::Point>& points,
+      const std::vector<Geometry::Vector>& strengths, double tolerance);
+
+    /// Sum over all sources but source skip, -1 for none. Safe to call from
+    /// several threads at once.
+    Geometry::Vector evaluate(const Geometry::Point& x, int skip = -1) const;
+    /// The same sum by direct summation, for reference
+    Geometry::Vector evaluateDirect(const Geometry::Point& x, int skip = -1) const;
+
+    static Geometry::Vector contribution(SourceKernel kernel, const Geometry::Vector& r, const Geometry::Vector& s);
+
+    int degree() const { return degree_; }
+    double openingAngle() const { return theta_; }
+    size_t numClusters() const { return clusters_.size(); }
+    size_t numProxies() const { return proxyPoints_.size(); }
+
+  private:
+    struct Cluster
+    {
+      int begin, end;
+      int sons[2]; // -1 for a leaf
+      double lo[3], hi[3];
+      Geometry::Point center;
+      double radius;
+      int proxyBegin, proxyEnd; // empty when direct summation is cheaper
+    };
+
+    int split(int begin, int end);
+    void addProxies(Cluster& c);
+    template <SourceKernel K> Geometry::Vector sum(const Geometry::Point& x, int skip) const;
+
+    SourceKernel kernel_;
+    int degree_;
+    double theta_;
+    int leafSize_;
+
+    std::vector<Cluster> clusters_;
+    std::vector<Geometry::Point> points_;      // in tree order
+    std::vector<Geometry::Vector> strengths_;  // in tree order
+    std::vector<int> position_;                // tree position of each source
+    std::vector<Geometry::Point> proxyPoints_;
+    std::vector<Geometry::Vector> proxyStrengths_;
+  };
+
+}}}}
+
+#endif
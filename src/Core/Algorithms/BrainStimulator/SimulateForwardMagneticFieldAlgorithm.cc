@@ -41,9 +41,11 @@ DEALINGS IN THE SOFTWARE.
 #include <Core/Logging/ScopedTimeRemarker.h>
 #include <Core/Logging/Log.h>
 #include <Core/Algorithms/BrainStimulator/SimulateForwardMagneticFieldAlgorithm.h>
+#include <Core/Algorithms/BrainStimulator/BiotSavartTreecode.h>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Geometry;
@@ -53,6 +55,12 @@ using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::BrainStimulator;
 using namespace SCIRun::Core::Logging;
 
+SimulateForwardMagneticFieldAlgo::SimulateForwardMagneticFieldAlgo()
+{
+  addParameter(Parameters::UseTreecode, false);
+  addParameter(Parameters::TreecodeTolerance, 1e-4);
+}
+
 AlgorithmInputName SimulateForwardMagneticFieldAlgo::ElectricField("ElectricField");
 AlgorithmInputName SimulateForwardMagneticFieldAlgo::ConductivityTensor("ConductivityTensor");
 AlgorithmInputName SimulateForwardMagneticFieldAlgo::DipoleSources("DipoleSources");
@@ -64,7 +72,7 @@ class CalcFMField
 {
   public:
 
-    CalcFMField(const AlgorithmBase* algo) : algo_(algo),
+    CalcFMField(const AlgorithmBase* algo, double tolerance) : algo_(algo), tolerance_(tolerance),
       np_(-1),efld_(0),ctfld_(0),dipfld_(0),detfld_(0),emsh_(0),ctmsh_(0),dipmsh_(0),detmsh_(0),magfld_(0),magmagfld_(0)
     {
     }
@@ -77,9 +85,12 @@ class CalcFMField
   private:
     void interpolate(int proc, Point p);
     void set_up_cell_cache();
+    void set_up_treecode();
     void calc_parallel(int proc);
 
     const AlgorithmBase* algo_;
+    double tolerance_; // 0 for direct summation
+    std::unique_ptr<BiotSavartTreecode> treecode_;
     int np_;
     std::vector<Vector> interp_value_;
     std::vector<std::pair<std::string, Tensor> > tens_;
@@ -186,6 +197,36 @@ void CalcFMField::set_up_cell_cache()
   }
 }
 
+// The cells followed by the dipoles as sources of one treecode sum, so that
+// the index of a cell is also its source index
+void CalcFMField::set_up_treecode()
+{
+  VMesh::size_type num_dipoles = dipmsh_->num_nodes();
+  std::vector<Point> points;
+  std::vector<Vector> strengths;
+  points.reserve(cell_cache_.size() + num_dipoles);
+  strengths.reserve(cell_cache_.size() + num_dipoles);
+
+  for (size_t idx = 0; idx < cell_cache_.size(); idx++)
+  {
+    points.push_back(cell_cache_[idx].center_);
+    strengths.push_back(cell_cache_[idx].cur_density_ * cell_cache_[idx].volume_);
+  }
+
+  Point pt;
+  Vector P;
+  for (VMesh::Node::index_type dip_idx = 0; dip_idx < num_dipoles; dip_idx++)
+  {
+    dipmsh_->get_center(pt, dip_idx);
+    dipfld_->value(P, dip_idx);
+    points.push_back(pt);
+    strengths.push_back(P);
+  }
+
+  emsh_->synchronize(Mesh::ELEM_LOCATE_E);
+  treecode_.reset(new BiotSavartTreecode(SourceKernel::CrossCube, points, strengths, tolerance_));
+}
+
 void CalcFMField::calc_parallel(int proc)
 {
 
@@ -211,28 +252,38 @@ void CalcFMField::calc_parallel(int proc)
 
     detmsh_->get_center(pt, idx);
 
-    // init the interp val to 0
-    interp_value_[proc] = Vector(0,0,0);
-    interpolate(proc, pt);
-
-    mag_field = interp_value_[proc];
+    if (treecode_)
+    {
+      // as in interpolate(), the cell holding the detector is left out
+      VMesh::Elem::index_type inside_cell = 0;
+      bool inside = emsh_->locate(inside_cell, pt);
+      mag_field = treecode_->evaluate(pt, inside ? static_cast<int>(inside_cell) : -1);
+    }
+    else
+    {
+      // init the interp val to 0
+      interp_value_[proc] = Vector(0,0,0);
+      interpolate(proc, pt);
 
-    Vector normal;
-    detfld_->get_value(normal,idx);
+      mag_field = interp_value_[proc];
 
-    // iterate over the dipoles.
-    for (VMesh::Node::index_type dip_idx = 0; dip_idx < num_dipoles; dip_idx++)
-    {
-      dipmsh_->get_center(pt2, dip_idx);
-      dipfld_->value(P,dip_idx);
+      // iterate over the dipoles.
+      for (VMesh::Node::index_type dip_idx = 0; dip_idx < num_dipoles; dip_idx++)
+      {
+        dipmsh_->get_center(pt2, dip_idx);
+        dipfld_->value(P,dip_idx);
 
-      Vector radius = pt - pt2; // detector - source
-      Vector valuePXR = Cross(P, radius);
-      double length = radius.length();
+        Vector radius = pt - pt2; // detector - source
+        Vector valuePXR = Cross(P, radius);
+        double length = radius.length();
 
-      mag_field += valuePXR / (length * length * length);
+        mag_field += valuePXR / (length * length * length);
+      }
     }
 
+    Vector normal;
+    detfld_->get_value(normal,idx);
+
     mag_field *= one_over_4_pi;
     magmagfld_->set_value(Dot(mag_field, normal),idx);
     magfld_->set_value(mag_field,idx);
@@ -303,6 +354,9 @@ boost::tuple<FieldHandle,FieldHandle> CalcFMField::calc_forward_magnetic_field(F
   // cache per cell calculations that are used over and over again.
   set_up_cell_cache();
 
+  if (tolerance_ > 0.0)
+    set_up_treecode();
+
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   // do the parallel work.
   Thread::parallel(this, &CalcFMField::calc_parallel, np_, mod);
@@ -336,7 +390,17 @@ boost::tuple<FieldHandle, FieldHandle> SimulateForwardMagneticFieldAlgo::run(Fie
     THROW_ALGORITHM_INPUT_ERROR("Must have Vector field as Detector Locations input");
   }
 
-  CalcFMField algo(this);
+  double tolerance = 0.0;
+  if (get(Parameters::UseTreecode).toBool())
+  {
+    tolerance = get(Parameters::TreecodeTolerance).toDouble();
+    if (tolerance <= 0.0)
+    {
+      THROW_ALGORITHM_INPUT_ERROR("Treecode tolerance needs to be positive.");
+    }
+  }
+
+  CalcFMField algo(this, tolerance);
   FieldHandle MField, MFieldMagnitudes;
 
   boost::tie(MField,MFieldMagnitudes) = algo.calc_forward_magnetic_field(ElectricField, ConductivityTensors, DipoleSources, DetectorLocations);
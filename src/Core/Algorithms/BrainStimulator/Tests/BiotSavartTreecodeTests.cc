@@ -0,0 +1,289 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/BrainStimulator/BiotSavartTreecode.h>
+#include <Core/Algorithms/BrainStimulator/BiotSavartSolverAlgorithm.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::BrainStimulator;
+
+namespace
+{
+  /// Current elements on two loops of a figure-eight coil 12 cm above the
+  /// origin, with random strengths
+  void CoilSources(int n, std::vector<Point>& points, std::vector<Vector>& strengths)
+  {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    points.clear();
+    strengths.clear();
+    for (int i = 0; i < n; ++i)
+    {
+      const double angle = M_PI * u(gen);
+      const double radius = 0.05 + 0.01 * u(gen);
+      points.push_back(Point(radius * std::cos(angle) + (i % 2 ? 0.06 : -0.06), radius * std::sin(angle), 0.12 + 0.002 * u(gen)));
+      strengths.push_back(Vector(u(gen), u(gen), u(gen)));
+    }
+  }
+
+  /// Points spread through a ball of radius 9 cm, the head under the coil
+  std::vector<Point> HeadPoints(int n)
+  {
+    std::mt19937 gen(6);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    std::vector<Point> points;
+    while (static_cast<int>(points.size()) < n)
+    {
+      Vector d(u(gen), u(gen), u(gen));
+      if (d.length() <= 1.0)
+        points.push_back(Point(d * 0.09));
+    }
+    return points;
+  }
+
+  double RelativeError(const BiotSavartTreecode& treecode, const std::vector<Point>& targets)
+  {
+    double error = 0.0, norm = 0.0;
+    for (const Point& x : targets)
+    {
+      const Vector direct = treecode.evaluateDirect(x);
+      error += (treecode.evaluate(x) - direct).length2();
+      norm += direct.length2();
+    }
+    return std::sqrt(error / norm);
+  }
+
+  /// Closed circular curve of n segments carrying a unit current
+  FieldHandle CircularCoil(int n, double radius, double height)
+  {
+    FieldInformation fi("CurveMesh", CONSTANTDATA_E, "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+    for (int i = 0; i < n; ++i)
+      mesh->add_point(Point(radius * std::cos(2.0 * M_PI * i / n), radius * std::sin(2.0 * M_PI * i / n), height));
+    VMesh::Node::array_type nodes(2);
+    for (int i = 0; i < n; ++i)
+    {
+      nodes[0] = i;
+      nodes[1] = (i + 1) % n;
+      mesh->add_elem(nodes);
+    }
+    field->vfield()->resize_values();
+    for (VMesh::index_type i = 0; i < n; ++i)
+      field->vfield()->set_value(1.0, i);
+    return field;
+  }
+
+  FieldHandle PointCloud(const std::vector<Point>& points)
+  {
+    FieldInformation fi("PointCloudMesh", LINEARDATA_E, "double");
+    FieldHandle field = CreateField(fi);
+    for (const Point& p : points)
+      field->vmesh()->add_point(p);
+    field->vfield()->resize_values();
+    return field;
+  }
+
+  double RelativeDifference(const DenseMatrix& a, const DenseMatrix& b)
+  {
+    return (a - b).norm() / b.norm();
+  }
+}
+
+class BiotSavartTreecodeTests : public ::testing::TestWithParam<SourceKernel>
+{
+};
+
+TEST_P(BiotSavartTreecodeTests, MatchesDirectSum)
+{
+  std::vector<Point> points;
+  std::vector<Vector> strengths;
+  CoilSources(20000, points, strengths);
+
+  BiotSavartTreecode treecode(GetParam(), points, strengths, 1e-4);
+  EXPECT_GT(treecode.numProxies(), 0u);
+  EXPECT_LT(RelativeError(treecode, HeadPoints(500)), 1e-4);
+}
+
+TEST_P(BiotSavartTreecodeTests, ToleranceControlsAccuracy)
+{
+  std::vector<Point> points;
+  std::vector<Vector> strengths;
+  CoilSources(10000, points, strengths);
+  auto targets = HeadPoints(300);
+
+  double previous = 1.0;
+  for (double tolerance : { 1e-2, 1e-4, 1e-6 })
+  {
+    BiotSavartTreecode treecode(GetParam(), points, strengths, tolerance);
+    const double error = RelativeError(treecode, targets);
+    EXPECT_LT(error, tolerance);
+    EXPECT_LT(error, previous);
+    previous = error;
+  }
+}
+
+TEST_P(BiotSavartTreecodeTests, SkipsTheSourceAtTheEvaluationPoint)
+{
+  // Sources and evaluation points in the same volume, every source skipped at
+  // its own location
+  auto points = HeadPoints(5000);
+  std::vector<Vector> strengths(points.size(), Vector(0.0, 0.0, 1.0));
+  BiotSavartTreecode treecode(GetParam(), points, strengths, 1e-6);
+
+  double error = 0.0, norm = 0.0;
+  for (int i = 0; i < 5000; i += 50)
+  {
+    const Vector direct = treecode.evaluateDirect(points[i], i);
+    const Vector approx = treecode.evaluate(points[i], i);
+    ASSERT_TRUE(std::isfinite(approx.length()));
+    error += (approx - direct).length2();
+    norm += direct.length2();
+  }
+  EXPECT_LT(std::sqrt(error / norm), 1e-6);
+}
+
+INSTANTIATE_TEST_CASE_P(
+  BiotSavartTreecodeTestsParameterized,
+  BiotSavartTreecodeTests,
+  ::testing::Values(SourceKernel::CrossCube, SourceKernel::Inverse, SourceKernel::CrossInverse, SourceKernel::Dipole)
+  );
+
+TEST(BiotSavartSolverAlgorithmTests, TreecodeMatchesDirectForCurveCoil)
+{
+  FieldHandle coil = CircularCoil(200, 0.05, 0.12);
+  FieldHandle head = PointCloud(HeadPoints(2000));
+
+  for (int outtype : { 1, 2 })
+  {
+    BiotSavartSolverAlgorithm algo;
+    MatrixHandle direct, treecode;
+    ASSERT_TRUE(algo.run(head, coil, direct, outtype));
+
+    algo.set(Parameters::UseTreecode, true);
+    algo.set(Parameters::TreecodeTolerance, 1e-5);
+    ASSERT_TRUE(algo.run(head, coil, treecode, outtype));
+
+    auto d = boost::dynamic_pointer_cast<DenseMatrix>(direct);
+    auto t = boost::dynamic_pointer_cast<DenseMatrix>(treecode);
+    ASSERT_TRUE(d && t);
+    EXPECT_LT(RelativeDifference(*t, *d), 1e-5);
+  }
+}
+
+TEST(BiotSavartSolverAlgorithmTests, TreecodeMatchesDirectForDipoles)
+{
+  std::vector<Point> points;
+  std::vector<Vector> moments;
+  CoilSources(3000, points, moments);
+
+  FieldInformation fi("PointCloudMesh", LINEARDATA_E, "Vector");
+  FieldHandle coil = CreateField(fi);
+  for (const Point& p : points)
+    coil->vmesh()->add_point(p);
+  coil->vfield()->resize_values();
+  for (VMesh::index_type i = 0; i < static_cast<VMesh::index_type>(moments.size()); ++i)
+    coil->vfield()->set_value(moments[i], i);
+  FieldHandle head = PointCloud(HeadPoints(1000));
+
+  for (int outtype : { 1, 2 })
+  {
+    BiotSavartSolverAlgorithm algo;
+    MatrixHandle direct, treecode;
+    ASSERT_TRUE(algo.run(head, coil, direct, outtype));
+
+    algo.set(Parameters::UseTreecode, true);
+    algo.set(Parameters::TreecodeTolerance, 1e-5);
+    ASSERT_TRUE(algo.run(head, coil, treecode, outtype));
+
+    auto d = boost::dynamic_pointer_cast<DenseMatrix>(direct);
+    auto t = boost::dynamic_pointer_cast<DenseMatrix>(treecode);
+    ASSERT_TRUE(d && t);
+    EXPECT_LT(RelativeDifference(*t, *d), 1e-5);
+  }
+}
+
+// Coil sources against head points, both growing. The direct time and the
+// error come from the first 1000 evaluation points, the direct time is scaled
+// to all of them.
+TEST(BiotSavartTreecodeBenchmark, DISABLED_ErrorAgainstSpeedup)
+{
+  std::cout << std::setw(8) << "sources" << std::setw(9) << "points" << std::setw(8) << "tol"
+    << std::setw(5) << "deg" << std::setw(11) << "direct s" << std::setw(11) << "tree s"
+    << std::setw(9) << "speedup" << std::setw(11) << "error" << std::endl;
+
+  std::vector<Point> points;
+  std::vector<Vector> strengths;
+  for (int n : { 10000, 40000, 160000 })
+  {
+    CoilSources(n, points, strengths);
+    auto targets = HeadPoints(4 * n);
+    const size_t sampled = 1000;
+
+    for (double tolerance : { 1e-3, 1e-5, 1e-7 })
+    {
+      auto start = std::chrono::steady_clock::now();
+      BiotSavartTreecode treecode(SourceKernel::CrossCube, points, strengths, tolerance);
+      std::vector<Vector> approx(targets.size());
+      for (size_t i = 0; i < targets.size(); ++i)
+        approx[i] = treecode.evaluate(targets[i]);
+      const double treeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      start = std::chrono::steady_clock::now();
+      double error = 0.0, norm = 0.0;
+      for (size_t i = 0; i < sampled; ++i)
+      {
+        const Vector direct = treecode.evaluateDirect(targets[i]);
+        error += (approx[i] - direct).length2();
+        norm += direct.length2();
+      }
+      const double directSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+        * targets.size() / sampled;
+
+      std::cout << std::setw(8) << n << std::setw(9) << targets.size() << std::setw(8) << tolerance
+        << std::setw(5) << treecode.degree() << std::setw(11) << std::setprecision(3) << directSeconds
+        << std::setw(11) << treeSeconds << std::setw(9) << directSeconds / treeSeconds
+        << std::setw(11) << std::sqrt(error / norm) << std::endl;
+    }
+  }
+}
@@ -49,6 +49,7 @@ last change: 09/17/2014
 using namespace SCIRun;
 using namespace SCIRun::Core;
 using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::TestUtils;
 using namespace SCIRun::Core::Algorithms::DataIO;
 using namespace SCIRun::Core::Algorithms::Fields;
@@ -128,3 +129,81 @@ TEST(SimulateForwardMagneticFieldAlgoTest, TestOnLatVol)
   EXPECT_MATRIX_EQ_TOLERANCE(*MField_matrix, *MField_expected_matrix, 1e-16);
   EXPECT_MATRIX_EQ_TOLERANCE(*MFieldMagnitudes_matrix, *MFieldMagnitudes_expected_matrix, 1e-16);
 }
+
+namespace
+{
+  /// Electric field and conductivity on the cells of a LatVol over [-1,1]^3
+  void CurrentVolume(int n, FieldHandle& efield, FieldHandle& conductivity)
+  {
+    FieldInformation efi("LatVolMesh", CONSTANTDATA_E, "Vector");
+    MeshHandle mesh = CreateMesh(efi, n, n, n, Point(-1, -1, -1), Point(1, 1, 1));
+    efield = CreateField(efi, mesh);
+    efield->vfield()->resize_values();
+
+    FieldInformation cfi("LatVolMesh", CONSTANTDATA_E, "double");
+    conductivity = CreateField(cfi, mesh);
+    conductivity->vfield()->resize_values();
+
+    Point c;
+    for (VMesh::Elem::index_type idx = 0; idx < mesh->vmesh()->num_elems(); idx++)
+    {
+      mesh->vmesh()->get_center(c, idx);
+      efield->vfield()->set_value(Vector(c.y(), -c.x(), 0.5 + c.z() * c.z()), idx);
+      conductivity->vfield()->set_value(1.0 + 0.5 * c.x(), idx);
+    }
+  }
+
+  FieldHandle VectorPointCloud(const std::vector<Point>& points, const Vector& value)
+  {
+    FieldInformation fi("PointCloudMesh", LINEARDATA_E, "Vector");
+    FieldHandle field = CreateField(fi);
+    for (size_t i = 0; i < points.size(); i++)
+      field->vmesh()->add_point(points[i]);
+    field->vfield()->resize_values();
+    for (VMesh::index_type i = 0; i < static_cast<VMesh::index_type>(points.size()); i++)
+      field->vfield()->set_value(value, i);
+    return field;
+  }
+}
+
+TEST(SimulateForwardMagneticFieldAlgoTest, TreecodeMatchesDirectSummation)
+{
+  FieldHandle efield, conductivity;
+  CurrentVolume(24, efield, conductivity);
+
+  std::vector<Point> dipoles { Point(0.2, 0.1, 0.0), Point(-0.3, 0.4, 0.2) };
+  FieldHandle dipole_field = VectorPointCloud(dipoles, Vector(0.0, 0.0, 1.0));
+
+  // detectors on a helmet outside the volume and a few inside it, where the
+  // cell holding the detector is left out of the sum
+  std::vector<Point> detectors;
+  for (int i = 0; i < 200; i++)
+  {
+    const double z = 1.0 - (i + 0.5) / 200;
+    const double r = std::sqrt(1.0 - z * z);
+    detectors.push_back(Point(2.0 * r * std::cos(2.4 * i), 2.0 * r * std::sin(2.4 * i), 2.0 * z));
+  }
+  detectors.push_back(Point(0.01, 0.02, 0.03));
+  detectors.push_back(Point(-0.5, 0.6, -0.7));
+  FieldHandle detector_field = VectorPointCloud(detectors, Vector(0.0, 0.0, 1.0));
+
+  SimulateForwardMagneticFieldAlgo algo;
+  FieldHandle direct, direct_magnitudes;
+  boost::tie(direct, direct_magnitudes) = algo.run(efield, conductivity, dipole_field, detector_field);
+
+  algo.set(Algorithms::BrainStimulator::Parameters::UseTreecode, true);
+  algo.set(Algorithms::BrainStimulator::Parameters::TreecodeTolerance, 1e-5);
+  FieldHandle treecode, treecode_magnitudes;
+  boost::tie(treecode, treecode_magnitudes) = algo.run(efield, conductivity, dipole_field, detector_field);
+
+  double error = 0.0, norm = 0.0;
+  Vector a, b;
+  for (VMesh::index_type i = 0; i < static_cast<VMesh::index_type>(detectors.size()); i++)
+  {
+    direct->vfield()->get_value(a, i);
+    treecode->vfield()->get_value(b, i);
+    error += (a - b).length2();
+    norm += a.length2();
+  }
+  EXPECT_LT(std::sqrt(error / norm), 1e-5);
+}
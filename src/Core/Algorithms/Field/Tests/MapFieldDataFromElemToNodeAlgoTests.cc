@@ -249,3 +249,25 @@ TEST(MapFieldDataFromElemToNode, TetMeshTestMed)
  }
 
 }
+
+// benchmark: run manually with --gtest_also_run_disabled_tests
+TEST(MapFieldDataFromElemToNode, DISABLED_BenchmarkLatVol)
+{
+  FieldInformation fi(LATVOLMESH_E, CONSTANTDATA_E, DOUBLE_E);
+  MeshHandle mesh = CreateMesh(fi, 101, 101, 101, Point(0, 0, 0), Point(1, 1, 1));
+  FieldHandle field = CreateField(fi, mesh);
+  field->vfield()->resize_values();
+  field->vfield()->set_all_values(1.0);
+
+  MapFieldDataFromElemToNodeAlgo algo;
+  for (const auto& method : { "Interpolation", "Max", "Median" })
+  {
+    algo.setOption(MapFieldDataFromElemToNodeAlgo::Method, method);
+    FieldHandle result;
+    {
+      ScopedTimer t(std::string("elem to node, ") + method);
+      result = algo.runImpl(field);
+    }
+    ASSERT_EQ(mesh->vmesh()->num_nodes(), result->vfield()->num_values());
+  }
+}
@@ -0,0 +1,274 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Datatypes/Legacy/Base/PropertyManager.h>
+#include <Core/Algorithms/Legacy/Fields/MeshData/ReorderMeshAlgo.h>
+#include <Core/GeometryPrimitives/Point.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+
+namespace
+{
+  /// Tet lattice of n^3 cubes with its nodes and elements stored in a random
+  /// order, holding x+2y+3z at the nodes or the element index at the elements
+  FieldHandle ShuffledTetLattice(int n, bool linear)
+  {
+    FieldInformation fi("TetVolMesh", linear ? LINEARDATA_E : CONSTANTDATA_E, "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+
+    const int m = n + 1;
+    std::vector<index_type> node_ids(m*m*m);
+    for (size_t i = 0; i < node_ids.size(); i++) node_ids[i] = i;
+    std::srand(42);
+    std::random_shuffle(node_ids.begin(), node_ids.end());
+
+    std::vector<Point> points(node_ids.size());
+    for (int k = 0; k < m; k++)
+      for (int j = 0; j < m; j++)
+        for (int i = 0; i < m; i++)
+          points[node_ids[i + m*(j + m*k)]] = Point(i, j, k);
+    for (size_t i = 0; i < points.size(); i++) mesh->add_point(points[i]);
+
+    static const int tets[6][4] =
+      { {0,1,3,7}, {0,1,5,7}, {0,2,3,7}, {0,2,6,7}, {0,4,5,7}, {0,4,6,7} };
+    std::vector<VMesh::Node::array_type> elems;
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+          for (int t = 0; t < 6; t++)
+          {
+            VMesh::Node::array_type nodes(4);
+            for (int c = 0; c < 4; c++)
+            {
+              const int corner = tets[t][c];
+              nodes[c] = node_ids[(i + (corner & 1)) + m*((j + ((corner >> 1) & 1)) + m*(k + (corner >> 2)))];
+            }
+            elems.push_back(nodes);
+          }
+    std::random_shuffle(elems.begin(), elems.end());
+    for (size_t e = 0; e < elems.size(); e++) mesh->add_elem(elems[e]);
+
+    VField* vfield = field->vfield();
+    vfield->resize_values();
+    if (linear)
+    {
+      for (VMesh::index_type i = 0; i < mesh->num_nodes(); i++)
+        vfield->set_value(points[i].x() + 2*points[i].y() + 3*points[i].z(), i);
+    }
+    else
+    {
+      for (VMesh::index_type i = 0; i < mesh->num_elems(); i++)
+        vfield->set_value(static_cast<double>(i), i);
+    }
+    field->properties().set_property("units", std::string("mV"), false);
+    return field;
+  }
+
+  /// Largest and mean difference between the indices of two nodes of one element
+  void NodeSpread(VMesh* mesh, index_type& largest, double& mean)
+  {
+    largest = 0;
+    mean = 0.0;
+    VMesh::Node::array_type nodes;
+    for (VMesh::Elem::index_type e = 0; e < mesh->num_elems(); e++)
+    {
+      mesh->get_nodes(nodes, e);
+      index_type lo = nodes[0], hi = nodes[0];
+      for (size_t j = 1; j < nodes.size(); j++)
+      {
+        lo = std::min<index_type>(lo, nodes[j]);
+        hi = std::max<index_type>(hi, nodes[j]);
+      }
+      largest = std::max(largest, hi - lo);
+      mean += hi - lo;
+    }
+    mean /= mesh->num_elems();
+  }
+
+  /// The old index each row of a mapping matrix takes its value from
+  std::vector<index_type> MappingSources(MatrixHandle mapping)
+  {
+    auto sparse = castMatrix::toSparse(mapping);
+    std::vector<index_type> sources;
+    auto rows = sparse->get_rows();
+    auto cols = sparse->get_cols();
+    for (index_type r = 0; r < sparse->nrows(); r++)
+    {
+      EXPECT_EQ(1, rows[r + 1] - rows[r]);
+      sources.push_back(cols[rows[r]]);
+    }
+    return sources;
+  }
+}
+
+class ReorderMeshAlgoTests : public ::testing::TestWithParam<std::string>
+{
+};
+
+TEST_P(ReorderMeshAlgoTests, MappingIsAPermutationThatCarriesGeometryAndData)
+{
+  FieldHandle input = ShuffledTetLattice(4, true);
+  VMesh* imesh = input->vmesh();
+
+  ReorderMeshAlgo algo;
+  algo.setOption(Parameters::NodeOrdering, GetParam());
+
+  FieldHandle output;
+  MatrixHandle node_mapping, elem_mapping;
+  ASSERT_TRUE(algo.run(input, output, node_mapping, elem_mapping));
+
+  VMesh* omesh = output->vmesh();
+  ASSERT_EQ(imesh->num_nodes(), omesh->num_nodes());
+  ASSERT_EQ(imesh->num_elems(), omesh->num_elems());
+
+  auto nodes_from = MappingSources(node_mapping);
+  auto elems_from = MappingSources(elem_mapping);
+  ASSERT_EQ(imesh->num_nodes(), nodes_from.size());
+  ASSERT_EQ(imesh->num_elems(), elems_from.size());
+
+  auto sorted = nodes_from;
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); i++) EXPECT_EQ(i, sorted[i]);
+
+  sorted = elems_from;
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); i++) EXPECT_EQ(i, sorted[i]);
+
+  for (VMesh::Node::index_type i = 0; i < omesh->num_nodes(); i++)
+  {
+    Point p, q;
+    omesh->get_center(p, i);
+    imesh->get_center(q, VMesh::Node::index_type(nodes_from[i]));
+    EXPECT_EQ(q, p);
+
+    double v, w;
+    output->vfield()->get_value(v, i);
+    input->vfield()->get_value(w, nodes_from[i]);
+    EXPECT_EQ(w, v);
+  }
+
+  for (VMesh::Elem::index_type e = 0; e < omesh->num_elems(); e++)
+  {
+    Point p, q;
+    omesh->get_center(p, e);
+    imesh->get_center(q, VMesh::Elem::index_type(elems_from[e]));
+    EXPECT_EQ(q, p);
+  }
+
+  std::string units;
+  EXPECT_TRUE(output->properties().get_property("units", units));
+  EXPECT_EQ("mV", units);
+}
+
+TEST_P(ReorderMeshAlgoTests, ElementDataFollowsElements)
+{
+  FieldHandle input = ShuffledTetLattice(3, false);
+
+  ReorderMeshAlgo algo;
+  algo.setOption(Parameters::NodeOrdering, GetParam());
+
+  FieldHandle output;
+  MatrixHandle node_mapping, elem_mapping;
+  ASSERT_TRUE(algo.run(input, output, node_mapping, elem_mapping));
+
+  auto elems_from = MappingSources(elem_mapping);
+  for (VMesh::index_type e = 0; e < output->vmesh()->num_elems(); e++)
+  {
+    double v;
+    output->vfield()->get_value(v, e);
+    EXPECT_EQ(static_cast<double>(elems_from[e]), v);
+  }
+}
+
+TEST_P(ReorderMeshAlgoTests, KeepsElementNodesClose)
+{
+  FieldHandle input = ShuffledTetLattice(8, true);
+
+  ReorderMeshAlgo algo;
+  algo.setOption(Parameters::NodeOrdering, GetParam());
+
+  FieldHandle output;
+  MatrixHandle node_mapping, elem_mapping;
+  ASSERT_TRUE(algo.run(input, output, node_mapping, elem_mapping));
+
+  index_type in_largest, out_largest;
+  double in_mean, out_mean;
+  NodeSpread(input->vmesh(), in_largest, in_mean);
+  NodeSpread(output->vmesh(), out_largest, out_mean);
+  EXPECT_LT(out_mean, in_mean / 4);
+}
+
+INSTANTIATE_TEST_CASE_P(
+  ReorderMeshAlgoTestsParameterized,
+  ReorderMeshAlgoTests,
+  ::testing::Values("hilbert", "morton", "rcm")
+  );
+
+TEST(ReorderMeshAlgoTest, RcmGivesLatticeBandwidth)
+{
+  FieldHandle input = ShuffledTetLattice(8, true);
+
+  ReorderMeshAlgo algo;
+  algo.setOption(Parameters::NodeOrdering, std::string("rcm"));
+
+  FieldHandle output;
+  MatrixHandle node_mapping, elem_mapping;
+  ASSERT_TRUE(algo.run(input, output, node_mapping, elem_mapping));
+
+  // A lexicographic numbering of the 9^3 lattice has bandwidth 9*9+9+1
+  index_type largest;
+  double mean;
+  NodeSpread(output->vmesh(), largest, mean);
+  EXPECT_LE(largest, 91);
+}
+
+TEST(ReorderMeshAlgoTest, RejectsRegularMesh)
+{
+  FieldInformation fi("LatVolMesh", LINEARDATA_E, "double");
+  MeshHandle mesh = CreateMesh(fi, 3, 3, 3, Point(0,0,0), Point(1,1,1));
+  FieldHandle input = CreateField(fi, mesh);
+
+  ReorderMeshAlgo algo;
+  FieldHandle output;
+  MatrixHandle node_mapping, elem_mapping;
+  EXPECT_FALSE(algo.run(input, output, node_mapping, elem_mapping));
+}
@@ -73,6 +73,47 @@ namespace FEInputData
   {
     return nullptr;
   }
+
+  // n*n*n unit cubes, each split into six tets: 6n^3 elements with constant conductivity
+  FieldHandle latticeTetMesh(int n, double conductivity = 1.0)
+  {
+    FieldInformation fi(TETVOLMESH_E, CONSTANTDATA_E, DOUBLE_E);
+    auto field = CreateField(fi);
+    auto vmesh = field->vmesh();
+    const int np = n + 1;
+    vmesh->node_reserve(np*np*np);
+    vmesh->elem_reserve(6*n*n*n);
+    for (int k = 0; k < np; ++k)
+      for (int j = 0; j < np; ++j)
+        for (int i = 0; i < np; ++i)
+          vmesh->add_point(Point(i, j, k));
+
+    static const int cubeTets[6][4] = { {5,6,0,4}, {0,7,2,3}, {2,6,0,1}, {0,6,5,1}, {0,6,2,7}, {6,7,0,4} };
+    VMesh::Node::array_type vdata(4);
+    for (int k = 0; k < n; ++k)
+      for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+        {
+          auto node = [=](int di, int dj, int dk) { return VMesh::Node::index_type(((k+dk)*np + j+dj)*np + i+di); };
+          const VMesh::Node::index_type corners[8] = { node(0,0,0), node(1,0,0), node(1,1,0), node(0,1,0),
+            node(0,0,1), node(1,0,1), node(1,1,1), node(0,1,1) };
+          for (const auto& tet : cubeTets)
+          {
+            for (int c = 0; c < 4; ++c)
+              vdata[c] = corners[tet[c]];
+            vmesh->add_elem(vdata);
+          }
+        }
+
+    field->vfield()->resize_values();
+    field->vfield()->set_all_values(conductivity);
+    return field;
+  }
+
+  SparseRowMatrixHandle buildStiffness(const BuildFEMatrixAlgo& algo, FieldHandle mesh)
+  {
+    return algo.run(withInputData((Variables::InputField, mesh))).get<SparseRowMatrix>(BuildFEMatrixAlgo::Stiffness_Matrix);
+  }
 }
 
 TEST(BuildFEMatrixAlgorithmTests, ThrowsForNullMesh)
@@ -214,3 +255,101 @@ TEST(BuildFEMatrixAlgorithmTests, DISABLED_TestMeshSize1e6)
 
   EXPECT_TRUE(compare_with_tolerance(*expectedOutput("1e6.mat"), *output));
 }
+
+TEST(BuildFEMatrixAlgorithmTests, ReusesSparsityPatternWhenOnlyConductivityChanges)
+{
+  using namespace FEInputData;
+  auto mesh = latticeTetMesh(4);
+
+  BuildFEMatrixAlgo algo;
+  auto first = buildStiffness(algo, mesh);
+  ASSERT_THAT(first, NotNull());
+  EXPECT_EQ(125, first->nrows());
+
+  mesh->vfield()->set_all_values(2.0);
+  auto second = buildStiffness(algo, mesh);
+  ASSERT_THAT(second, NotNull());
+
+  BuildFEMatrixAlgo fresh;
+  auto expected = buildStiffness(fresh, mesh);
+  EXPECT_EQ(expected->nonZeros(), second->nonZeros());
+  EXPECT_TRUE(expected->isApprox(*second));
+  SparseRowMatrix doubled = 2.0 * *first;
+  EXPECT_TRUE(doubled.isApprox(*second));
+}
+
+TEST(BuildFEMatrixAlgorithmTests, RebuildsSparsityPatternForNewMesh)
+{
+  using namespace FEInputData;
+  BuildFEMatrixAlgo algo;
+  auto small = buildStiffness(algo, latticeTetMesh(2));
+  auto large = buildStiffness(algo, latticeTetMesh(3));
+  ASSERT_THAT(small, NotNull());
+  ASSERT_THAT(large, NotNull());
+
+  EXPECT_EQ(27, small->nrows());
+  EXPECT_EQ(64, large->nrows());
+  BuildFEMatrixAlgo fresh;
+  EXPECT_TRUE(buildStiffness(fresh, latticeTetMesh(3))->isApprox(*large));
+}
+
+TEST(BuildFEMatrixAlgorithmTests, RebuildsSparsityPatternAfterConnectivityEdit)
+{
+  using namespace FEInputData;
+  auto mesh = latticeTetMesh(3);
+  BuildFEMatrixAlgo algo;
+  ASSERT_THAT(buildStiffness(algo, mesh), NotNull());
+
+  // same node and element counts, but tet 0 now reaches the far corner of the lattice
+  VMesh::Node::array_type nodes;
+  mesh->vmesh()->get_nodes(nodes, VMesh::Elem::index_type(0));
+  nodes[3] = VMesh::Node::index_type(63);
+  mesh->vmesh()->set_nodes(nodes, VMesh::Elem::index_type(0));
+
+  auto edited = buildStiffness(algo, mesh);
+  ASSERT_THAT(edited, NotNull());
+  BuildFEMatrixAlgo fresh;
+  auto expected = buildStiffness(fresh, mesh);
+  EXPECT_EQ(expected->nonZeros(), edited->nonZeros());
+  EXPECT_TRUE(expected->isApprox(*edited));
+  bool stored = false;
+  for (SparseRowMatrix::InnerIterator it(*edited, nodes[0]); it; ++it)
+    stored = stored || it.col() == 63;
+  EXPECT_TRUE(stored);
+}
+
+namespace
+{
+  void benchmarkAssembly(int n)
+  {
+    using namespace FEInputData;
+    auto mesh = latticeTetMesh(n);
+    std::cout << "elements: " << mesh->vmesh()->num_elems() << std::endl;
+    BuildFEMatrixAlgo algo;
+    {
+      ScopedTimer t("assembly with new sparsity pattern");
+      ASSERT_THAT(buildStiffness(algo, mesh), NotNull());
+    }
+    mesh->vfield()->set_all_values(0.5);
+    {
+      ScopedTimer t("assembly reusing sparsity pattern");
+      ASSERT_THAT(buildStiffness(algo, mesh), NotNull());
+    }
+  }
+}
+
+// benchmarks: run manually with --gtest_also_run_disabled_tests
+TEST(BuildFEMatrixAlgorithmTests, DISABLED_BenchmarkAssembly1e5)
+{
+  benchmarkAssembly(26);
+}
+
+TEST(BuildFEMatrixAlgorithmTests, DISABLED_BenchmarkAssembly1e6)
+{
+  benchmarkAssembly(55);
+}
+
+TEST(BuildFEMatrixAlgorithmTests, DISABLED_BenchmarkAssembly1e7)
+{
+  benchmarkAssembly(119);
+}
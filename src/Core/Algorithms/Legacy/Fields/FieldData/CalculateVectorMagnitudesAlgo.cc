@@ -74,17 +74,20 @@ CalculateVectorMagnitudesAlgo::run(FieldHandle input, FieldHandle& output) const
   if (num_fielddata!=num_nodes &&  num_fielddata!=num_elems)
     THROW_ALGORITHM_INPUT_ERROR("Input data inconsistent");
   
-  Vector* vec = reinterpret_cast<Vector*>(ifield->get_values_pointer());
-  double* mag = reinterpret_cast<double*>(ofield->get_values_pointer());
+  FieldSpan<Vector> vec = ifield->data_span<Vector>();
+  FieldSpan<double> mag = ofield->data_span<double>();
   
-  if (!vec)
+  if (vec.empty())
    THROW_ALGORITHM_INPUT_ERROR("Could not acces input field pointer");
   
-  if (!mag)
+  if (mag.empty())
    THROW_ALGORITHM_INPUT_ERROR("Could not access output field pointer");
   
+  /// Node data can have fewer values than the output has elements (tet meshes)
+  VField::size_type num_values = std::min(vec.size(), mag.size());
+
   int cnt = 0;
-  for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+  for (VMesh::Elem::index_type idx = 0; idx < num_values; idx++)
   {
    mag[idx] = vec[idx].length();
    cnt++; 
@@ -27,10 +27,10 @@
 */
 
 #include <Core/Algorithms/Legacy/Fields/Mapping/BuildMappingMatrixAlgo.h>
+#include <Core/Algorithms/Legacy/Fields/Mapping/MappingDataSource.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Thread/Parallel.h>
-#include <Core/Thread/Barrier.h>
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
@@ -60,469 +60,160 @@ namespace detail
   //------------------------------------------------------------
   // Algorithm - each destination has its closest source
 
-  class BuildMappingMatrixPAlgoBase
+  void buildClosestData(VField* sfield, VField* dfield, VMesh* smesh, VMesh* dmesh,
+                        index_type* rr, index_type* cc, double* vv,
+                        double maxdist, const AlgorithmBase* algo)
   {
-  public:
-    BuildMappingMatrixPAlgoBase(const std::string& barrierName, int nproc) : 
-      sfield_(0), dfield_(0), smesh_(0), dmesh_(0), rr_(0), cc_(0), vv_(0),
-      maxdist_(0), algo_(0), nproc_(nproc),
-      barrier_(barrierName, nproc) {}
-    VField* sfield_;
-    VField* dfield_;
-    VMesh*  smesh_;
-    VMesh*  dmesh_;
-
-    index_type* rr_;
-    index_type* cc_;
-    double* vv_;
-
-    double  maxdist_;
-    const AlgorithmBase* algo_;
-
-  protected:
-    int nproc_;
-    Barrier  barrier_;
-  };
-
-  class BuildMappingMatrixClosestDataPAlgo : public BuildMappingMatrixPAlgoBase
-  {
-  public:
-    BuildMappingMatrixClosestDataPAlgo(int nproc) :
-        BuildMappingMatrixPAlgoBase("BuildMappingMatrixClosestDataPAlgo Barrier", nproc) {}
-
-        void parallel(int proc);
-  };
-
-  void BuildMappingMatrixClosestDataPAlgo::parallel(int proc)
-  {
-    // Determine which ones to run
-    VField::size_type num_values = dfield_->num_values();
-    VField::size_type localsize = num_values/nproc_;
-    VField::index_type start = localsize*proc;
-    VField::index_type end = localsize*(proc+1);
-    if (proc == nproc_-1) end = num_values;
-
-    barrier_.wait();
+    VField::size_type num_values = dfield->num_values();
+    std::vector<Point> points;
+    std::vector<index_type> values;
 
-    int cnt = 0;
-
-    if (dfield_->basis_order() == 0 && sfield_->basis_order() == 0)
+    rr[0] = 0;
+    VMesh::index_type k = 0;
+    for (VField::index_type start=0; start<num_values; start+=MAPPING_BLOCK_SIZE)
     {
-      Point p, r;
-      VMesh::coords_type coords;
-      VMesh::Elem::index_type didx;
+      Interruptible::checkForInterruption();
+      VField::index_type end = std::min(start+MAPPING_BLOCK_SIZE,num_values);
 
-      for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-      {
-        dmesh_->get_center(p,idx);
-        double dist;
-        if(smesh_->find_closest_elem(dist,r,coords,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-          }
-          else cc_[idx] = -1;
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (dfield_->basis_order() == 1 && sfield_->basis_order() == 0)
-    {
-      Point p, r;
-      VMesh::coords_type coords;
-      VMesh::Elem::index_type didx;
-      for (VMesh::Node::index_type idx=start; idx<end;idx++)
-      {
-        dmesh_->get_center(p,idx);
-        double dist;
-        if(smesh_->find_closest_elem(dist,r,coords,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-          }
-          else cc_[idx] = -1;
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (dfield_->basis_order() == 0 && sfield_->basis_order() == 1)
-    {
-      Point p, r;
-      VMesh::Node::index_type didx;
-      for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-      {
-        dmesh_->get_center(p,idx);
-        double dist;
-        if(smesh_->find_closest_node(dist,r,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-          }
-          else cc_[idx] = -1;
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (dfield_->basis_order() == 1 && sfield_->basis_order() == 1)
-    {
-      Point p, r;
-      VMesh::Node::index_type didx;
-      for (VMesh::Node::index_type idx=start; idx<end;idx++)
-      {
-        dmesh_->get_center(p,idx);
-        double dist;
-        if(smesh_->find_closest_node(dist,r,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-          }
-          else cc_[idx] = -1;
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-
-    barrier_.wait();
-
-    if (proc == 0)
-    {
-      VField::size_type num_dvalues = dfield_->num_values();
+      GetValueCenters(points,dmesh,dfield->basis_order(),start,end);
+      FindClosestValues(values,smesh,sfield->basis_order(),points,maxdist);
 
-      rr_[0] = 0;
-      VMesh::index_type k = 0;
-      for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
+      for (VField::index_type idx=start; idx<end; idx++)
       {
-        if (cc_[idx] >= 0)
+        if (values[idx-start] >= 0)
         {
-          cc_[k] = cc_[idx];
-          vv_[k] = 1.0;
+          cc[k] = values[idx-start];
+          vv[k] = 1.0;
           k++;
         }
-        rr_[idx+1] = k;
+        rr[idx+1] = k;
       }
+      algo->update_progress_max(end,num_values);
     }
   }
 
-
-
   //------------------------------------------------------------
   // Algorithm - each source will map to one destination
 
-  class BuildMappingMatrixSingleDestinationPAlgo : public BuildMappingMatrixPAlgoBase
+  void buildSingleDestination(VField* sfield, VField* dfield, VMesh* smesh, VMesh* dmesh,
+                              index_type* rr, index_type* cc, double* vv,
+                              double maxdist, const AlgorithmBase* algo)
   {
-  public:
-    explicit BuildMappingMatrixSingleDestinationPAlgo(int nproc) :
-        BuildMappingMatrixPAlgoBase("BuildMappingMatrixSingleDestinationPAlgo Barrier", nproc) {}
-
-        void parallel(int proc);
-
-        std::vector<index_type> tcc_;
-  };
+    VField::size_type num_values = sfield->num_values();
+    std::vector<index_type> tcc(dfield->num_values(),-1);
+    std::vector<Point> points;
+    std::vector<index_type> values;
 
-  void
-    BuildMappingMatrixSingleDestinationPAlgo::parallel(int proc)
-  {
-    // Determine which ones to run
-    VField::size_type num_values = sfield_->num_values();
-    VField::size_type localsize = num_values/nproc_;
-    VField::index_type start = localsize*proc;
-    VField::index_type end = localsize*(proc+1);
-    if (proc == nproc_-1) end = num_values;
-
-    if (proc == 0)
+    for (VField::index_type start=0; start<num_values; start+=MAPPING_BLOCK_SIZE)
     {
-      tcc_.resize(dfield_->num_values());
-    }
+      Interruptible::checkForInterruption();
+      VField::index_type end = std::min(start+MAPPING_BLOCK_SIZE,num_values);
 
-    barrier_.wait();
+      GetValueCenters(points,smesh,sfield->basis_order(),start,end);
+      FindClosestValues(values,dmesh,dfield->basis_order(),points,maxdist);
 
-    int cnt = 0;
-
-    if (sfield_->basis_order() == 0 && dfield_->basis_order() == 0)
-    {
-      Point p, r;
-      VMesh::coords_type coords;
-      VMesh::Elem::index_type didx;
-      for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-      {
-        smesh_->get_center(p,idx);
-        double dist;
-        if(dmesh_->find_closest_elem(dist,r,coords,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-          }
-          else cc_[idx] = -1;
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (sfield_->basis_order() == 1 && dfield_->basis_order() == 0)
-    {
-      Point p, r;
-      VMesh::coords_type coords;
-      VMesh::Elem::index_type didx;
-      for (VMesh::Node::index_type idx=start; idx<end;idx++)
-      {
-        smesh_->get_center(p,idx);
-        double dist;
-        if(dmesh_->find_closest_elem(dist,r,coords,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-          }
-          else cc_[idx] = -1;
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (sfield_->basis_order() == 0 && dfield_->basis_order() == 1)
-    {
-      Point p, r;
-      VMesh::Node::index_type didx;
-      for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-      {
-        smesh_->get_center(p,idx);
-        double dist;
-        if(dmesh_->find_closest_node(dist,r,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-          }
-          else cc_[idx] = -1;
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (sfield_->basis_order() == 1 && dfield_->basis_order() == 1)
-    {
-      Point p, r;
-      VMesh::Node::index_type didx;
-      for (VMesh::Node::index_type idx=start; idx<end;idx++)
+      // The last source that lands on a destination wins
+      for (VField::index_type idx=start; idx<end; idx++)
       {
-        smesh_->get_center(p,idx);
-        double dist;
-        if(dmesh_->find_closest_node(dist,r,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-          }
-          else cc_[idx] = -1;
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
+        if (values[idx-start] >= 0) tcc[values[idx-start]] = idx;
       }
+      algo->update_progress_max(end,num_values);
     }
 
-    barrier_.wait();
-
-    if (proc == 0)
+    VField::size_type num_dvalues = dfield->num_values();
+    rr[0] = 0;
+    VMesh::index_type k = 0;
+    for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
     {
-      VField::size_type num_dvalues = dfield_->num_values();
-      for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
-      {
-        tcc_[idx] = -1;
-      }
-      for (VMesh::index_type idx=0; idx<num_values;idx++)
+      if (tcc[idx] >= 0)
       {
-        tcc_[cc_[idx]] = idx;
-      }
-
-      rr_[0] = 0;
-      VMesh::index_type k = 0;
-      for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
-      {
-        if (tcc_[idx] >= 0)
-        {
-          cc_[k] = tcc_[idx];
-          vv_[k] = 1.0;
-          k++;
-        }
-        rr_[idx+1] = k;
+        cc[k] = tcc[idx];
+        vv[k] = 1.0;
+        k++;
       }
+      rr[idx+1] = k;
     }
-
   }
 
-
   //------------------------------------------------------------
   // Algorithm - get interpolated data
 
-
-  class BuildMappingMatrixInterpolatedDataPAlgo : public BuildMappingMatrixPAlgoBase
-  {
-  public:
-    explicit BuildMappingMatrixInterpolatedDataPAlgo(int nproc) :
-        BuildMappingMatrixPAlgoBase("BuildMappingMatrixInterpolatedDataPAlgo Barrier", nproc), e_(0) {}
-
-        void parallel(int proc);
-
-        size_type e_;
-  };
-
-  void BuildMappingMatrixInterpolatedDataPAlgo::parallel(int proc)
+  void buildInterpolatedData(VField* sfield, VField* dfield, VMesh* smesh, VMesh* dmesh,
+                             index_type* rr, index_type* cc, double* vv, size_type e,
+                             double maxdist, const AlgorithmBase* algo)
   {
-    // Determine which ones to run
-    VField::size_type num_values = dfield_->num_values();
-    VField::size_type localsize = num_values/nproc_;
-    VField::index_type start = localsize*proc;
-    VField::index_type end = localsize*(proc+1);
-    if (proc == nproc_-1) end = num_values;
-
-    barrier_.wait();
-
-    int cnt = 0;
+    // Constant data does not interpolate, it is the closest element
+    if (sfield->basis_order() == 0)
+    {
+      buildClosestData(sfield,dfield,smesh,dmesh,rr,cc,vv,maxdist,algo);
+      return;
+    }
 
-    if (dfield_->basis_order() == 0 && sfield_->basis_order() == 0)
+    VField::size_type num_values = dfield->num_values();
+    std::vector<Point> points, result;
+    std::vector<double> dist;
+    std::vector<VMesh::coords_type> coords;
+    std::vector<VMesh::Elem::index_type> elems;
+
+    // Rows of a block are filled in parallel with e entries each, unused ones
+    // are marked -1 and squeezed out once the block is done
+    rr[0] = 0;
+    VMesh::index_type k = 0;
+    for (VField::index_type start=0; start<num_values; start+=MAPPING_BLOCK_SIZE)
     {
-      Point p, r;
-      VMesh::Elem::index_type didx;
+      Interruptible::checkForInterruption();
+      VField::index_type end = std::min(start+MAPPING_BLOCK_SIZE,num_values);
 
-      for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-      {
-        dmesh_->get_center(p,idx);
+      GetValueCenters(points,dmesh,dfield->basis_order(),start,end);
+      smesh->find_closest_elem_many(dist,result,coords,elems,points,maxdist);
 
-        double dist;
-        if(smesh_->find_closest_elem(dist,r,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-            vv_[idx] = 1.0;
-          }
-          else 
-          {
-            cc_[idx] = -1;
-            vv_[idx] = 1.0;
-          }
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (dfield_->basis_order() == 1 && sfield_->basis_order() == 0)
-    {
-      Point p, r;
-      VMesh::Elem::index_type didx;
-      for (VMesh::Node::index_type idx=start; idx<end;idx++)
-      {
-        dmesh_->get_center(p,idx);
-        double dist;
-        if(smesh_->find_closest_elem(dist,r,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            cc_[idx] = didx;
-            vv_[idx] = 1.0;
-          }
-          else 
-          {
-            cc_[idx] = -1;
-            vv_[idx] = 1.0;
-          }
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (dfield_->basis_order() == 0 && sfield_->basis_order() == 1)
-    {
-      Point p, r;
-      VMesh::coords_type coords;
-      VMesh::Elem::index_type didx;
-      VMesh::ElemInterpolate interp;
-      for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-      {
-        dmesh_->get_center(p,idx);
-        double dist;
-        if(smesh_->find_closest_elem(dist,r,coords,didx,p))
-        {
-          if (maxdist_ < 0.0 || dist < maxdist_)
-          {
-            smesh_->get_interpolate_weights(coords,didx,interp,1);
-            for (index_type j=0;j<e_;j++)
-            {
-              cc_[idx*e_+j] = interp.node_index[j];
-              vv_[idx*e_+j] = interp.weights[j];
-            }
-          }
-          else
-          {
-            for (index_type j=0;j<e_;j++)
-            {
-              cc_[idx*e_+j] = -1;
-              vv_[idx*e_+j] = 0.0;          
-            }
-          }
-        }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-    else if (dfield_->basis_order() == 1 && sfield_->basis_order() == 1)
-    {
-      Point p, r;
-      VMesh::coords_type coords;
-      VMesh::Elem::index_type didx;
-      VMesh::ElemInterpolate interp;
-      for (VMesh::Node::index_type idx=start; idx<end;idx++)
+      index_type* bcc = cc + k;
+      double* bvv = vv + k;
+      auto interpolate = [&](size_t first, size_t last)
       {
-        dmesh_->get_center(p,idx);
-        double dist;
-        if(smesh_->find_closest_elem(dist,r,coords,didx,p))
+        VMesh::ElemInterpolate interp;
+        for (size_t j=first; j<last; j++)
         {
-          if (maxdist_ < 0.0 || dist < maxdist_)
+          if (elems[j] >= 0 && (maxdist < 0.0 || dist[j] < maxdist))
           {
-            smesh_->get_interpolate_weights(coords,didx,interp,1);
-            for (index_type j=0;j<e_;j++)
+            smesh->get_interpolate_weights(coords[j],elems[j],interp,1);
+            for (index_type i=0;i<e;i++)
             {
-              cc_[idx*e_+j] = interp.node_index[j];
-              vv_[idx*e_+j] = interp.weights[j];
+              bcc[j*e+i] = interp.node_index[i];
+              bvv[j*e+i] = interp.weights[i];
             }
           }
           else
           {
-            for (index_type j=0;j<e_;j++)
+            for (index_type i=0;i<e;i++)
             {
-              cc_[idx*e_+j] = -1;
-              vv_[idx*e_+j] = 0.0;          
+              bcc[j*e+i] = -1;
+              bvv[j*e+i] = 0.0;
             }
           }
         }
-        if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-      }
-    }
-
-    barrier_.wait();
+      };
+      Parallel::For(0,end-start,interpolate);
 
-    if (proc == 0)
-    {
-      VField::size_type num_dvalues = dfield_->num_values();
-
-      rr_[0] = 0;
-      VMesh::index_type k = 0;
       VMesh::index_type kk = 0;
-      for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
+      for (VField::index_type idx=start; idx<end; idx++)
       {
-        for (VMesh::index_type j=0;j<e_;j++)
+        for (index_type i=0;i<e;i++)
         {
-          if (cc_[kk] >= 0)
+          if (bcc[kk] >= 0)
           {
-            cc_[k] = cc_[kk];
-            vv_[k] = vv_[kk];
+            cc[k] = bcc[kk];
+            vv[k] = bvv[kk];
             k++;
           }
           kk++;
         }
-        rr_[idx+1] = k;
+        rr[idx+1] = k;
       }
+      algo->update_progress_max(end,num_values);
     }
   }
-  
+
 }
 
 bool BuildMappingMatrixAlgo::runImpl(FieldHandle source, FieldHandle destination, MatrixHandle& output) const
@@ -552,13 +243,13 @@ bool BuildMappingMatrixAlgo::runImpl(FieldHandle source, FieldHandle destination
   int sbasis_order = sfield->basis_order();
   int dbasis_order = dfield->basis_order();
 
-  if (sbasis_order < 0)
+  if (sbasis_order < 0 || sbasis_order > 1)
   {
     error("Source field basis order needs to constant or linear");
     return (false);  
   }
 
-  if (dbasis_order < 0)
+  if (dbasis_order < 0 || dbasis_order > 1)
   {
     error("Destination field basis order needs to constant or linear");
     return (false);  
@@ -618,55 +309,17 @@ bool BuildMappingMatrixAlgo::runImpl(FieldHandle source, FieldHandle destination
 
   double maxdist = get(Parameters::MaxDistance).toDouble();
 
-  const int np = Parallel::NumCores();
   if (method == "closestdata")
   {
-    detail::BuildMappingMatrixClosestDataPAlgo algo(np);
-    algo.sfield_ = sfield;
-    algo.dfield_ = dfield;
-    algo.smesh_ = smesh;
-    algo.dmesh_ = dmesh;
-    algo.rr_ = rr;
-    algo.cc_ = cc;
-    algo.vv_ = vv;
-    algo.maxdist_ = maxdist;
-    algo.algo_ = this;
-
-    auto task_i = [&algo,this](int i) { algo.parallel(i); };
-    Parallel::RunTasks(task_i, np);
+    detail::buildClosestData(sfield,dfield,smesh,dmesh,rr,cc,vv,maxdist,this);
   }
   else if(method == "singledestination")
   {
-    detail::BuildMappingMatrixSingleDestinationPAlgo algo(np);
-    algo.sfield_ = sfield;
-    algo.dfield_ = dfield;
-    algo.smesh_ = smesh;
-    algo.dmesh_ = dmesh;
-    algo.rr_ = rr;
-    algo.cc_ = cc;
-    algo.vv_ = vv;
-    algo.maxdist_ = maxdist;
-    algo.algo_ = this;
-
-    auto task_i = [&algo,this](int i) { algo.parallel(i); };
-    Parallel::RunTasks(task_i, np);
+    detail::buildSingleDestination(sfield,dfield,smesh,dmesh,rr,cc,vv,maxdist,this);
   }
   else if (method == "interpolateddata")
-  { 
-    detail::BuildMappingMatrixInterpolatedDataPAlgo algo(np);
-    algo.sfield_ = sfield;
-    algo.dfield_ = dfield;
-    algo.smesh_ = smesh;
-    algo.dmesh_ = dmesh;
-    algo.rr_ = rr;
-    algo.cc_ = cc;
-    algo.vv_ = vv;
-    algo.e_ = e;
-    algo.maxdist_ = maxdist;
-    algo.algo_ = this;
-
-    auto task_i = [&algo,this](int i) { algo.parallel(i); };
-    Parallel::RunTasks(task_i, np);
+  {
+    detail::buildInterpolatedData(sfield,dfield,smesh,dmesh,rr,cc,vv,e,maxdist,this);
   }
 
   output.reset(new SparseRowMatrix(m,n,rr,cc,vv,nnz));
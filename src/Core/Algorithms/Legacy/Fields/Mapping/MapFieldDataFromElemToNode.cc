@@ -38,6 +38,7 @@ TODO: Nrrd aoutput
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/CastFData.h>
 
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Geometry;
@@ -48,22 +49,17 @@ using namespace SCIRun::Core::Logging;
 using namespace SCIRun::Core::Thread;
 using namespace SCIRun;
 
-template <class DATA>
+/// The values are read and written straight from the typed data arrays, DATA is
+/// the type the values are combined in.
+template <class DATA, class T>
 bool
   MapFieldDataFromElemToNodeT(const MapFieldDataFromElemToNodeAlgo *algo,
-  FieldHandle& input,
-  FieldHandle& output)
+  VMesh* mesh,
+  FieldSpan<T> input,
+  FieldSpan<T> output)
 {
   std::string method = algo->getOption(MapFieldDataFromElemToNodeAlgo::Method);
 
-  VField *ifield = input->vfield();
-  VField *ofield = output->vfield();
-
-  /// Make sure that the data vector has the same length
-  ofield->resize_fdata();
-
-  VMesh* mesh = input->vmesh();
-
   VMesh::Elem::array_type elems;
   VMesh::Node::iterator it, eit;
   VMesh::Node::size_type sz;
@@ -93,11 +89,11 @@ bool
       DATA tval;
       for (size_t p = 0; p < nsize; p++)
       {
-        ifield->get_value(tval, elems[p]);
+        tval = CastFData<DATA>(input[elems[p]]);
         val += tval;
       }
       val = static_cast<DATA>(val*(1.0 / static_cast<double>(nsize)));
-      ofield->set_value(val, *(it));
+      output[*it] = CastFData<T>(val);
       ++it;
       cnt++;
       if (cnt == 1000)
@@ -118,14 +114,14 @@ bool
       DATA tval(0);
       if (nsize > 0)
       {
-        ifield->get_value(val, elems[0]);
+        val = CastFData<DATA>(input[elems[0]]);
         for (size_t p = 1; p < nsize; p++)
         {
-          ifield->get_value(tval, elems[p]);
+          tval = CastFData<DATA>(input[elems[p]]);
           if (tval > val) val = tval;
         }
       }
-      ofield->set_value(val, *(it));
+      output[*it] = CastFData<T>(val);
       ++it;
       cnt++;
       if (cnt == 1000)
@@ -146,14 +142,14 @@ bool
       DATA tval(0);
       if (nsize > 0)
       {
-        ifield->get_value(val, elems[0]);
+        val = CastFData<DATA>(input[elems[0]]);
         for (size_t p = 1; p < nsize; p++)
         {
-          ifield->value(tval, elems[p]);
+          tval = CastFData<DATA>(input[elems[p]]);
           if (tval < val) val = tval;
         }
       }
-      ofield->set_value(val, *(it));
+      output[*it] = CastFData<T>(val);
       ++it;
       cnt++;
       if (cnt == 1000)
@@ -174,10 +170,10 @@ bool
       DATA tval(0);
       for (size_t p = 0; p < nsize; p++)
       {
-        ifield->get_value(tval, elems[p]);
+        tval = CastFData<DATA>(input[elems[p]]);
         val += tval;
       }
-      ofield->set_value(val, *(it));
+      output[*it] = CastFData<T>(val);
       ++it;
       cnt++;
       if (cnt == 1000)
@@ -198,11 +194,11 @@ bool
       valarray.resize(nsize);
       for (size_t p = 0; p < nsize; p++)
       {
-        ifield->get_value(valarray[p], elems[p]);
+        valarray[p] = CastFData<DATA>(input[elems[p]]);
       }
       sort(valarray.begin(), valarray.end());
       int idx = static_cast<int>((valarray.size() / 2));
-      ofield->set_value(valarray[idx], *(it));
+      output[*it] = CastFData<T>(valarray[idx]);
       ++it;
       cnt++;
       if (cnt == 1000)
@@ -221,6 +217,41 @@ bool
   return true;
 }
 
+namespace
+{
+  /// Combine integer values as the virtual interface did: signed types as int,
+  /// unsigned types as unsigned int and the other scalars as double
+  template <class T> struct ElemToNodeDataType { typedef double type; };
+  template <> struct ElemToNodeDataType<char> { typedef int type; };
+  template <> struct ElemToNodeDataType<short> { typedef int type; };
+  template <> struct ElemToNodeDataType<int> { typedef int type; };
+  template <> struct ElemToNodeDataType<unsigned char> { typedef unsigned int type; };
+  template <> struct ElemToNodeDataType<unsigned short> { typedef unsigned int type; };
+  template <> struct ElemToNodeDataType<unsigned int> { typedef unsigned int type; };
+  template <> struct ElemToNodeDataType<Vector> { typedef Vector type; };
+  template <> struct ElemToNodeDataType<Tensor> { typedef Tensor type; };
+
+  class MapFieldDataFromElemToNodeKernel
+  {
+  public:
+    MapFieldDataFromElemToNodeKernel(const MapFieldDataFromElemToNodeAlgo* algo, VMesh* mesh, VField* ofield) :
+      algo_(algo), mesh_(mesh), ofield_(ofield), success_(false) {}
+
+    template <class T>
+    void operator()(FieldSpan<T> input)
+    {
+      success_ = MapFieldDataFromElemToNodeT<typename ElemToNodeDataType<T>::type>(algo_, mesh_, input, ofield_->data_span<T>());
+    }
+
+    bool success() const { return success_; }
+
+  private:
+    const MapFieldDataFromElemToNodeAlgo* algo_;
+    VMesh* mesh_;
+    VField* ofield_;
+    bool success_;
+  };
+}
 
 MapFieldDataFromElemToNodeAlgo::MapFieldDataFromElemToNodeAlgo()
 {
@@ -276,41 +307,17 @@ FieldHandle MapFieldDataFromElemToNodeAlgo::runImpl(FieldHandle input_field) con
     THROW_ALGORITHM_INPUT_ERROR("output field cannot be allocated");
   }
 
-  if (input_field->vfield()->is_signed_integer())
-  {
-    if(!MapFieldDataFromElemToNodeT<int>(this,input_field,output))
-    {
-      THROW_ALGORITHM_INPUT_ERROR("output int field cannot be allocated");
-    }
-  }
-  else if (input_field->vfield()->is_unsigned_integer())
-  {
-    if(!MapFieldDataFromElemToNodeT<unsigned int>(this,input_field,output))
-    {
-      THROW_ALGORITHM_INPUT_ERROR("output uint field cannot be allocated");
-    }
-  } else if (input_field->vfield()->is_scalar())
-  {
-    if (!MapFieldDataFromElemToNodeT<double>(this,input_field,output))
-    {
-      THROW_ALGORITHM_INPUT_ERROR("output scalar field cannot be allocated");
-    }
-  } else if (input_field->vfield()->is_vector())
-  {
-    if (!MapFieldDataFromElemToNodeT<Vector>(this,input_field,output))
-    {
-      THROW_ALGORITHM_INPUT_ERROR("output vector field cannot be allocated");
-    }
-  } else if (input_field->vfield()->is_tensor())
+  /// Make sure that the data vector has the same length
+  output->vfield()->resize_fdata();
+
+  MapFieldDataFromElemToNodeKernel kernel(this, input_field->vmesh(), output->vfield());
+  if (!dispatch_values(input_field->vfield(), kernel))
   {
-    if (!MapFieldDataFromElemToNodeT<Tensor>(this,input_field,output))
-    {
-      THROW_ALGORITHM_INPUT_ERROR("output tensor field cannot be allocated");
-    }
+    THROW_ALGORITHM_INPUT_ERROR(" Unknown field data type ");
   }
-  else
+  if (!kernel.success())
   {
-    THROW_ALGORITHM_INPUT_ERROR(" Unknown field data type ");
+    THROW_ALGORITHM_INPUT_ERROR("output field cannot be allocated");
   }
 
   return output;
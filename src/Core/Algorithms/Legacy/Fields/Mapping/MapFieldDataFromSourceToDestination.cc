@@ -27,10 +27,10 @@
 */
 
 #include <Core/Algorithms/Legacy/Fields/Mapping/MapFieldDataFromSourceToDestination.h>
+#include <Core/Algorithms/Legacy/Fields/Mapping/MappingDataSource.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Thread/Parallel.h>
-#include <Core/Thread/Barrier.h>
 
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
@@ -39,7 +39,7 @@
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 
-#include <boost/scoped_ptr.hpp>
+#include <algorithm>
 
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Geometry;
@@ -65,392 +65,115 @@ MapFieldDataFromSourceToDestinationAlgo::MapFieldDataFromSourceToDestinationAlgo
 
 namespace detail
 {
-  class MapFieldDataFromSourceToDestinationPAlgoBase : public Interruptible
-  {
-  public:
-    explicit MapFieldDataFromSourceToDestinationPAlgoBase(const std::string& name, int nproc) :
-      sfield_(0), dfield_(0), smesh_(0), dmesh_(0), maxdist_(0), algo_(0),
-      barrier_(name, nproc), nproc_(nproc) {}
-
-    virtual void parallel(int proc) = 0;
-
-    VField* sfield_;
-    VField* dfield_;
-    VMesh*  smesh_;
-    VMesh*  dmesh_;
-
-    double  maxdist_;
-    const AlgorithmBase* algo_;
-
-  protected:
-    Barrier barrier_;
-    int nproc_;
-  };
-
-
 //------------------------------------------------------------
 // Algorithm - each destination has its closest source
 
-class MapFieldDataFromSourceToDestinationClosestDataPAlgo : public MapFieldDataFromSourceToDestinationPAlgoBase
-{
-  public:
-    explicit MapFieldDataFromSourceToDestinationClosestDataPAlgo(int nproc) :
-      MapFieldDataFromSourceToDestinationPAlgoBase(" MapFieldDataFromSourceToDestinationClosestDataPAlgo Barrier", nproc) {}
-
-    virtual void parallel(int proc) override;
-};
-
 void
-MapFieldDataFromSourceToDestinationClosestDataPAlgo::parallel(int proc)
+mapClosestData(VField* sfield, VField* dfield, VMesh* smesh, VMesh* dmesh,
+               double maxdist, const AlgorithmBase* algo)
 {
-  // Determine which ones to run
-  VField::size_type num_values = dfield_->num_values();
-  VField::size_type localsize = num_values/nproc_;
-  VField::index_type start = localsize*proc;
-  VField::index_type end = localsize*(proc+1);
-  if (proc == nproc_-1) end = num_values;
-
-  barrier_.wait();
-
-  int cnt = 0;
+  VField::size_type num_values = dfield->num_values();
+  std::vector<Point> points;
+  std::vector<index_type> values;
 
-  if (dfield_->basis_order() == 0 && sfield_->basis_order() == 0)
+  for (VField::index_type start=0; start<num_values; start+=MAPPING_BLOCK_SIZE)
   {
-    Point p, r;
-    VMesh::Elem::index_type didx;
+    Interruptible::checkForInterruption();
+    VField::index_type end = std::min(start+MAPPING_BLOCK_SIZE,num_values);
 
-    for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      dmesh_->get_center(p,idx);
-      double dist;
-      if(smesh_->find_closest_elem(dist,r,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          dfield_->copy_value(sfield_,didx,idx);
-        }
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-  else if (dfield_->basis_order() == 1 && sfield_->basis_order() == 0)
-  {
-    Point p, r;
-    VMesh::Elem::index_type didx;
-    for (VMesh::Node::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      dmesh_->get_center(p,idx);
-      double dist;
-      if(smesh_->find_closest_elem(dist,r,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          dfield_->copy_value(sfield_,didx,idx);
-        }
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-  else if (dfield_->basis_order() == 0 && sfield_->basis_order() == 1)
-  {
-    Point p, r;
-    VMesh::Node::index_type didx;
-    for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      dmesh_->get_center(p,idx);
-      double dist;
-      if(smesh_->find_closest_node(dist,r,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          dfield_->copy_value(sfield_,didx,idx);
-        }
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-  else if (dfield_->basis_order() == 1 && sfield_->basis_order() == 1)
-  {
-    Point p, r;
-    VMesh::Node::index_type didx;
-    for (VMesh::Node::index_type idx=start; idx<end;idx++)
+    GetValueCenters(points,dmesh,dfield->basis_order(),start,end);
+    FindClosestValues(values,smesh,sfield->basis_order(),points,maxdist);
+
+    for (VField::index_type idx=start; idx<end; idx++)
     {
-      checkForInterruption();
-      dmesh_->get_center(p,idx);
-      double dist;
-      if(smesh_->find_closest_node(dist,r,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          dfield_->copy_value(sfield_,didx,idx);
-        }
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
+      if (values[idx-start] >= 0) dfield->copy_value(sfield,values[idx-start],idx);
     }
+    algo->update_progress_max(end,num_values);
   }
-
-  barrier_.wait();
 }
 
-
-
 //------------------------------------------------------------
 // Algorithm - each source will map to one destination
 
-class MapFieldDataFromSourceToDestinationSingleDestinationPAlgo : public MapFieldDataFromSourceToDestinationPAlgoBase
-{
-  public:
-    explicit MapFieldDataFromSourceToDestinationSingleDestinationPAlgo(int nproc) :
-      MapFieldDataFromSourceToDestinationPAlgoBase(" MapFieldDataFromSourceToDestinationSingleDestinationPAlgo Barrier", nproc) {}
-
-    virtual void parallel(int proc) override;
-
-    std::vector<index_type> tcc_;
-    std::vector<index_type> cc_;
-};
-
 void
-MapFieldDataFromSourceToDestinationSingleDestinationPAlgo::parallel(int proc)
+mapSingleDestination(VField* sfield, VField* dfield, VMesh* smesh, VMesh* dmesh,
+                     double maxdist, const AlgorithmBase* algo)
 {
-  // Determine which ones to run
-  VField::size_type num_values = sfield_->num_values();
-  VField::size_type localsize = num_values/nproc_;
-  VField::index_type start = localsize*proc;
-  VField::index_type end = localsize*(proc+1);
-  if (proc == nproc_-1) end = num_values;
-
-  if (proc == 0)
+  VField::size_type num_values = sfield->num_values();
+  std::vector<index_type> tcc(dfield->num_values(),-1);
+  std::vector<Point> points;
+  std::vector<index_type> values;
+
+  for (VField::index_type start=0; start<num_values; start+=MAPPING_BLOCK_SIZE)
   {
-    tcc_.resize(dfield_->num_values(),-1);
-    cc_.resize(sfield_->num_values(),-1);
-  }
+    Interruptible::checkForInterruption();
+    VField::index_type end = std::min(start+MAPPING_BLOCK_SIZE,num_values);
 
-  barrier_.wait();
-  int cnt = 0;
+    GetValueCenters(points,smesh,sfield->basis_order(),start,end);
+    FindClosestValues(values,dmesh,dfield->basis_order(),points,maxdist);
 
-  if (sfield_->basis_order() == 0 && dfield_->basis_order() == 0)
-  {
-    Point p, r;
-    VMesh::coords_type coords;
-    VMesh::Elem::index_type didx;
-    for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      smesh_->get_center(p,idx);
-      double dist;
-      if(dmesh_->find_closest_elem(dist,r,coords,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          cc_[idx] = didx;
-        }
-        else cc_[idx] = -1;
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-  else if (sfield_->basis_order() == 1 && dfield_->basis_order() == 0)
-  {
-    Point p, r;
-    VMesh::coords_type coords;
-    VMesh::Elem::index_type didx;
-    for (VMesh::Node::index_type idx=start; idx<end;idx++)
+    // The last source that lands on a destination wins
+    for (VField::index_type idx=start; idx<end; idx++)
     {
-      checkForInterruption();
-      smesh_->get_center(p,idx);
-      double dist;
-      if(dmesh_->find_closest_elem(dist,r,coords,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          cc_[idx] = didx;
-        }
-        else cc_[idx] = -1;
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
+      if (values[idx-start] >= 0) tcc[values[idx-start]] = idx;
     }
+    algo->update_progress_max(end,num_values);
   }
-  else if (sfield_->basis_order() == 0 && dfield_->basis_order() == 1)
-  {
-    Point p, r;
-    VMesh::Node::index_type didx;
-    for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      smesh_->get_center(p,idx);
-      double dist;
-      if(dmesh_->find_closest_node(dist,r,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          cc_[idx] = didx;
-        }
-        else cc_[idx] = -1;
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-  else if (sfield_->basis_order() == 1 && dfield_->basis_order() == 1)
-  {
-    Point p, r;
-    VMesh::Node::index_type didx;
-    for (VMesh::Node::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      smesh_->get_center(p,idx);
-      double dist;
-      if(dmesh_->find_closest_node(dist,r,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          cc_[idx] = didx;
-        }
-        else cc_[idx] = -1;
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-
-  barrier_.wait();
 
-  // Copy the data thread safe
-  if (proc == 0)
+  VField::size_type num_dvalues = dfield->num_values();
+  for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
   {
-    VField::size_type num_dvalues = dfield_->num_values();
-
-    for (VMesh::index_type idx=0; idx<num_values;idx++)
-    {
-      if (cc_[idx] >= 0) tcc_[cc_[idx]] = idx;
-    }
-
-    for (VMesh::index_type idx=0; idx<num_dvalues;idx++)
+    if (tcc[idx] >= 0)
     {
-      if (tcc_[idx] >= 0)
-      {
-        dfield_->copy_value(sfield_,tcc_[idx],idx);
-      }
+      dfield->copy_value(sfield,tcc[idx],idx);
     }
   }
 }
 
-
 //------------------------------------------------------------
 // Algorithm - get interpolated data
 
-
-class MapFieldDataFromSourceToDestinationInterpolatedDataPAlgo : public MapFieldDataFromSourceToDestinationPAlgoBase
-{
-  public:
-    explicit MapFieldDataFromSourceToDestinationInterpolatedDataPAlgo(int nproc) :
-      MapFieldDataFromSourceToDestinationPAlgoBase(" MapFieldDataFromSourceToDestinationInterpolatedDataPAlgo Barrier", nproc) {}
-
-    virtual void parallel(int proc) override;
-};
-
 void
-MapFieldDataFromSourceToDestinationInterpolatedDataPAlgo::parallel(int proc)
+mapInterpolatedData(VField* sfield, VField* dfield, VMesh* smesh, VMesh* dmesh,
+                    double maxdist, const AlgorithmBase* algo)
 {
-  // Determine which ones to run
-  VField::size_type num_values = dfield_->num_values();
-  VField::size_type localsize = num_values/nproc_;
-  VField::index_type start = localsize*proc;
-  VField::index_type end = localsize*(proc+1);
-  if (proc == nproc_-1) end = num_values;
+  // Constant data does not interpolate, it is the closest element
+  if (sfield->basis_order() == 0)
+  {
+    mapClosestData(sfield,dfield,smesh,dmesh,maxdist,algo);
+    return;
+  }
 
-  barrier_.wait();
+  VField::size_type num_values = dfield->num_values();
+  std::vector<Point> points, result;
+  std::vector<double> dist;
+  std::vector<VMesh::coords_type> coords;
+  std::vector<VMesh::Elem::index_type> elems;
 
-  int cnt = 0;
-  if (dfield_->basis_order() == 0 && sfield_->basis_order() == 0)
+  for (VField::index_type start=0; start<num_values; start+=MAPPING_BLOCK_SIZE)
   {
-    Point p, r;
-    VMesh::Elem::index_type didx;
+    Interruptible::checkForInterruption();
+    VField::index_type end = std::min(start+MAPPING_BLOCK_SIZE,num_values);
 
-    for (VMesh::Elem::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      dmesh_->get_center(p,idx);
+    GetValueCenters(points,dmesh,dfield->basis_order(),start,end);
+    smesh->find_closest_elem_many(dist,result,coords,elems,points,maxdist);
 
-      double dist;
-      if(smesh_->find_closest_elem(dist,r,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          dfield_->copy_value(sfield_,didx,idx);
-        }
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-  else if (dfield_->basis_order() == 1 && sfield_->basis_order() == 0)
-  {
-    Point p, r;
-    VMesh::Elem::index_type didx;
-    for (VMesh::Node::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      dmesh_->get_center(p,idx);
-      double dist;
-      if(smesh_->find_closest_elem(dist,r,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          dfield_->copy_value(sfield_,didx,idx);
-        }
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-  else if (dfield_->basis_order() == 0 && sfield_->basis_order() == 1)
-  {
-    Point p, r;
-    VMesh::coords_type coords;
-    VMesh::Elem::index_type didx;
-    VMesh::ElemInterpolate interp;
-    for (VMesh::Elem::index_type idx=start; idx<end;idx++)
+    auto interpolate = [&](size_t first, size_t last)
     {
-      checkForInterruption();
-      dmesh_->get_center(p,idx);
-      double dist;
-      if(smesh_->find_closest_elem(dist,r,coords,didx,p))
+      VMesh::ElemInterpolate interp;
+      for (size_t j=first; j<last; j++)
       {
-        if (maxdist_ < 0.0 || dist < maxdist_)
+        if (elems[j] >= 0 && (maxdist < 0.0 || dist[j] < maxdist))
         {
-          smesh_->get_interpolate_weights(coords,didx,interp,1);
-          dfield_->copy_weighted_value(sfield_,&(interp.node_index[0]),
-              &(interp.weights[0]),interp.node_index.size(),idx);
+          smesh->get_interpolate_weights(coords[j],elems[j],interp,1);
+          dfield->copy_weighted_value(sfield,&(interp.node_index[0]),
+              &(interp.weights[0]),interp.node_index.size(),start+j);
         }
       }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
+    };
+    Parallel::For(0,end-start,interpolate);
+    algo->update_progress_max(end,num_values);
   }
-  else if (dfield_->basis_order() == 1 && sfield_->basis_order() == 1)
-  {
-    Point p, r;
-    VMesh::coords_type coords;
-    VMesh::Elem::index_type didx;
-    VMesh::ElemInterpolate interp;
-    for (VMesh::Node::index_type idx=start; idx<end;idx++)
-    {
-      checkForInterruption();
-      dmesh_->get_center(p,idx);
-      double dist;
-      if(smesh_->find_closest_elem(dist,r,coords,didx,p))
-      {
-        if (maxdist_ < 0.0 || dist < maxdist_)
-        {
-          smesh_->get_interpolate_weights(coords,didx,interp,1);
-          dfield_->copy_weighted_value(sfield_,&(interp.node_index[0]),
-              &(interp.weights[0]),interp.node_index.size(),idx);
-        }
-      }
-      if (proc == 0) { cnt++; if (cnt == 200) {cnt = 0; algo_->update_progress_max(idx,end); } }
-    }
-  }
-
-  barrier_.wait();
 }
 
 }
@@ -514,6 +237,13 @@ MapFieldDataFromSourceToDestinationAlgo::runImpl(FieldHandle source, FieldHandle
     return (false);
   }
 
+  // Higher order data is not mapped, the output keeps the default value
+  if (sbasis_order > 1 || dbasis_order > 1)
+  {
+    CopyProperties(*destination, *output);
+    return (true);
+  }
+
   if (method == "closestdata")
   {
     if (sbasis_order == 0) smesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
@@ -540,34 +270,22 @@ MapFieldDataFromSourceToDestinationAlgo::runImpl(FieldHandle source, FieldHandle
 
   double maxdist = get(MaxDistance).toDouble();
 
-  boost::scoped_ptr<detail::MapFieldDataFromSourceToDestinationPAlgoBase> algoP;
-  int np = Parallel::NumCores();
   if (method == "closestdata")
   {
-    algoP.reset(new detail::MapFieldDataFromSourceToDestinationClosestDataPAlgo(np));
+    detail::mapClosestData(sfield,dfield,smesh,dmesh,maxdist,this);
   }
   else if(method == "singledestination")
   {
-    np = 1; //TODO: ???
-    algoP.reset(new detail::MapFieldDataFromSourceToDestinationSingleDestinationPAlgo(np));
+    detail::mapSingleDestination(sfield,dfield,smesh,dmesh,maxdist,this);
   }
   else if (method == "interpolateddata")
   {
-    algoP.reset(new detail::MapFieldDataFromSourceToDestinationInterpolatedDataPAlgo(np));
+    detail::mapInterpolatedData(sfield,dfield,smesh,dmesh,maxdist,this);
   }
-
-  if (!algoP)
+  else
+  {
     THROW_ALGORITHM_INPUT_ERROR("Invalid mapping method");
-
-  algoP->sfield_ = sfield;
-  algoP->dfield_ = dfield;
-  algoP->smesh_ = smesh;
-  algoP->dmesh_ = dmesh;
-  algoP->maxdist_ = maxdist;
-  algoP->algo_ = this;
-
-  auto task_i = [&algoP,this](int i) { algoP->parallel(i); };
-  Parallel::RunTasks(task_i, np);
+  }
 
   CopyProperties(*destination, *output);
 
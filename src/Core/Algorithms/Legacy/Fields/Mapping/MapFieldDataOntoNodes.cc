@@ -42,6 +42,8 @@
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 
+#include <algorithm>
+
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Core::Datatypes;
@@ -117,19 +119,28 @@ MapFieldDataOntoNodesPAlgo::parallel(int proc)
   VField::index_type      end = localsize*(proc+1);
   if (proc == nproc-1) end = num_nodes;
 
-  int cnt = 0;
+  // Nodes go to the data source in blocks, so it can batch the lookups
+  const VField::size_type block_size = 1024;
+  std::vector<Point> points;
+  VMesh::Node::index_type node;
+
   if (is_flux_)
   {
     // To compute flux through a surface
-    Point p; Vector val; Vector norm;
-    for (VMesh::Node::index_type idx=start; idx<end; idx++)
+    std::vector<Vector> vals;
+    Vector norm;
+    for (VField::index_type bstart=start; bstart<end; bstart+=block_size)
     {
       checkForInterruption();
-      omesh->get_center(p,idx);
-      omesh->get_normal(norm,idx);
-      datasource->get_data(val,p);
-      ofield->set_value(Dot(val,norm),idx);
-      if (proc == 0) { cnt++; if (cnt == 400) {cnt = 0; algo_->update_progress_max(idx,end); } }
+      VField::index_type bend = std::min(bstart+block_size,end);
+      GetValueCenters(points,omesh,1,bstart,bend);
+      datasource->get_data(vals,points);
+      for (node=bstart; node<bend; node++)
+      {
+        omesh->get_normal(norm,node);
+        ofield->set_value(Dot(vals[node-bstart],norm),node);
+      }
+      if (proc == 0) algo_->update_progress_max(bend,end);
     }
   }
   else
@@ -137,38 +148,41 @@ MapFieldDataOntoNodesPAlgo::parallel(int proc)
     // To map value, gradient, or gradientnorm
     if (datasource->is_scalar())
     {
-      Point p; double val;
-      for (VMesh::Node::index_type idx=start; idx<end; idx++)
+      std::vector<double> vals;
+      for (VField::index_type bstart=start; bstart<end; bstart+=block_size)
       {
         checkForInterruption();
-        omesh->get_center(p,idx);
-        datasource->get_data(val,p);
-        ofield->set_value(val,idx);
-        if (proc == 0) { cnt++; if (cnt == 400) {cnt = 0; algo_->update_progress_max(idx,end); } }
+        VField::index_type bend = std::min(bstart+block_size,end);
+        GetValueCenters(points,omesh,1,bstart,bend);
+        datasource->get_data(vals,points);
+        for (node=bstart; node<bend; node++) ofield->set_value(vals[node-bstart],node);
+        if (proc == 0) algo_->update_progress_max(bend,end);
       }
     }
     else if (datasource->is_vector())
     {
-      Point p; Vector val;
-      for (VMesh::Node::index_type idx=start; idx<end; idx++)
+      std::vector<Vector> vals;
+      for (VField::index_type bstart=start; bstart<end; bstart+=block_size)
       {
         checkForInterruption();
-        omesh->get_center(p,idx);
-        datasource->get_data(val,p);
-        ofield->set_value(val,idx);
-        if (proc == 0) { cnt++; if (cnt == 400) {cnt = 0; algo_->update_progress_max(idx,end); } }
+        VField::index_type bend = std::min(bstart+block_size,end);
+        GetValueCenters(points,omesh,1,bstart,bend);
+        datasource->get_data(vals,points);
+        for (node=bstart; node<bend; node++) ofield->set_value(vals[node-bstart],node);
+        if (proc == 0) algo_->update_progress_max(bend,end);
       }
     }
     else
     {
-      Point p; Tensor val;
-      for (VMesh::Node::index_type idx=start; idx<end; idx++)
+      std::vector<Tensor> vals;
+      for (VField::index_type bstart=start; bstart<end; bstart+=block_size)
       {
         checkForInterruption();
-        omesh->get_center(p,idx);
-        datasource->get_data(val,p);
-        ofield->set_value(val,idx);
-        if (proc == 0) { cnt++; if (cnt == 400) {cnt = 0; algo_->update_progress_max(idx,end); } }
+        VField::index_type bend = std::min(bstart+block_size,end);
+        GetValueCenters(points,omesh,1,bstart,bend);
+        datasource->get_data(vals,points);
+        for (node=bstart; node<bend; node++) ofield->set_value(vals[node-bstart],node);
+        if (proc == 0) algo_->update_progress_max(bend,end);
       }
     }
   }
@@ -596,70 +596,17 @@ class ClosestInterpolatedDataSource : public MappingDataSource {
 
     virtual void get_data(std::vector<double>& data, const std::vector<Point>& p) const override
     {
-      data.resize(p.size());
-      for (size_t j=0; j<p.size(); j++)
-      {
-        if(!(sfield_->interpolate(data[j],p[j],def_value_)))
-        {
-          double dist; Point r;
-          VMesh::Elem::index_type elem;
-          VMesh::coords_type coords;
-          if(smesh_->find_closest_elem(dist,r,coords,elem,p[j],maxdist_))
-          {
-            sfield_->interpolate(data[j],coords,elem);
-          }
-          else
-          {
-            data[j] = def_value_;
-          }
-        }
-      }
+      get_closest_data(data,p,def_value_);
     }
 
     virtual void get_data(std::vector<Vector>& data, const std::vector<Point>& p) const override
     {
-      data.resize(p.size());
-      for (size_t j=0; j<p.size(); j++)
-      {
-        if(!(sfield_->interpolate(data[j],p[j],Vector(0,0,0))))
-        {
-          double dist; Point r;
-          VMesh::Elem::index_type elem;
-          VMesh::coords_type coords;
-          smesh_->find_closest_elem(dist,r,coords,elem,p[j]);
-          if (dist < maxdist_)
-          {
-            sfield_->interpolate(data[j],coords,elem);
-          }
-          else
-          {
-            data[j] = Vector(0.0,0.0,0.0);
-          }
-        }
-      }
+      get_closest_data(data,p,Vector(0.0,0.0,0.0));
     }
 
     virtual void get_data(std::vector<Tensor>& data, const std::vector<Point>& p) const override
     {
-      data.resize(p.size());
-      for (size_t j=0; j<p.size(); j++)
-      {
-        if(!(sfield_->interpolate(data[j],p[j],Tensor(def_value_))))
-        {
-          double dist; Point r;
-          VMesh::Elem::index_type elem;
-          VMesh::coords_type coords;
-          smesh_->find_closest_elem(dist,r,coords,elem,p[j]);
-          if (dist < maxdist_)
-          {
-            sfield_->interpolate(data[j],coords,elem);
-          }
-          else
-          {
-            data[j] = Tensor(def_value_);
-          }
-        }
-      }
+      get_closest_data(data,p,Tensor(def_value_));
     }
 
     ClosestInterpolatedDataSource(FieldHandle sfield,double def_value,double max_dist)
@@ -676,6 +623,31 @@ class ClosestInterpolatedDataSource : public MappingDataSource {
     }
 
   private:
+    // One batched query: the closest element of a point inside the mesh is
+    // the element that contains it, at distance zero
+    template <class T>
+    void get_closest_data(std::vector<T>& data, const std::vector<Point>& p, const T& def) const
+    {
+      std::vector<double> dist;
+      std::vector<Point> r;
+      std::vector<VMesh::coords_type> coords;
+      std::vector<VMesh::Elem::index_type> elems;
+      smesh_->find_closest_elem_many(dist,r,coords,elems,p,maxdist_);
+
+      data.resize(p.size());
+      for (size_t j=0; j<p.size(); j++)
+      {
+        if (elems[j] >= 0 && (dist[j] == 0.0 || dist[j] < maxdist_))
+        {
+          sfield_->interpolate(data[j],coords[j],elems[j]);
+        }
+        else
+        {
+          data[j] = def;
+        }
+      }
+    }
+
     double  maxdist_;
     VField *sfield_;
     VMesh  *smesh_;
@@ -1751,56 +1723,17 @@ class ClosestNodeDataSource : public MappingDataSource {
 
     virtual void get_data(std::vector<double>& data, const std::vector<Point>& p) const override
     {
-      data.resize(p.size());
-      for (size_t j=0; j<p.size(); j++)
-      {
-        Point r; double dist;
-        smesh_->find_closest_node(dist,r,node_,p[j]);
-        if (dist < maxdist_)
-        {
-          sfield_->get_value(data[j],node_);
-        }
-        else
-        {
-          data[j] = def_value_;
-        }
-      }
+      get_closest_data(data,p);
     }
 
     virtual void get_data(std::vector<Vector>& data, const std::vector<Point>& p) const override
     {
-      data.resize(p.size());
-      for (size_t j=0; j<p.size(); j++)
-      {
-        Point r; double dist;
-        smesh_->find_closest_node(dist,r,node_,p[j]);
-        if (dist < maxdist_)
-        {
-          sfield_->get_value(data[j],node_);
-        }
-        else
-        {
-          data[j] = def_value_;
-        }
-      }
+      get_closest_data(data,p);
     }
 
     virtual void get_data(std::vector<Tensor>& data, const std::vector<Point>& p) const override
     {
-      data.resize(p.size());
-      for (size_t j=0; j<p.size(); j++)
-      {
-        Point r; double dist;
-        smesh_->find_closest_node(dist,r,node_,p[j]);
-        if (dist < maxdist_)
-        {
-          sfield_->get_value(data[j],node_);
-        }
-        else
-        {
-          data[j] = def_value_;
-        }
-      }
+      get_closest_data(data,p);
     }
 
     ClosestNodeDataSource(FieldHandle sfield,double def_value,double max_dist)
@@ -1817,6 +1750,28 @@ class ClosestNodeDataSource : public MappingDataSource {
     }
 
   private:
+    template <class T>
+    void get_closest_data(std::vector<T>& data, const std::vector<Point>& p) const
+    {
+      std::vector<double> dist;
+      std::vector<Point> r;
+      std::vector<VMesh::Node::index_type> nodes;
+      smesh_->find_closest_node_many(dist,r,nodes,p,maxdist_);
+
+      data.resize(p.size());
+      for (size_t j=0; j<p.size(); j++)
+      {
+        if (nodes[j] >= 0 && dist[j] < maxdist_)
+        {
+          sfield_->get_value(data[j],nodes[j]);
+        }
+        else
+        {
+          data[j] = def_value_;
+        }
+      }
+    }
+
     double  maxdist_;
     VField *sfield_;
     VMesh  *smesh_;
@@ -3368,3 +3323,52 @@ MappingDataSourceHandle SCIRun::Core::Algorithms::Fields::CreateDataSource(Field
 
   return nullptr;
 }
+
+void
+SCIRun::Core::Algorithms::Fields::GetValueCenters(std::vector<Point>& points, VMesh* mesh,
+                                                   int basis_order, index_type start, index_type end)
+{
+  points.resize(end-start);
+  if (basis_order == 0)
+  {
+    for (VMesh::Elem::index_type idx=start; idx<end; idx++)
+      mesh->get_center(points[idx-start],idx);
+  }
+  else
+  {
+    for (VMesh::Node::index_type idx=start; idx<end; idx++)
+      mesh->get_center(points[idx-start],idx);
+  }
+}
+
+void
+SCIRun::Core::Algorithms::Fields::FindClosestValues(std::vector<index_type>& values, VMesh* mesh,
+                                                     int basis_order, const std::vector<Point>& points,
+                                                     double maxdist)
+{
+  std::vector<double> dist;
+  std::vector<Point> result;
+  values.resize(points.size());
+
+  if (basis_order == 0)
+  {
+    std::vector<VMesh::coords_type> coords;
+    std::vector<VMesh::Elem::index_type> elems;
+    mesh->find_closest_elem_many(dist,result,coords,elems,points,maxdist);
+    for (size_t j=0; j<points.size(); j++)
+    {
+      if (elems[j] >= 0 && (maxdist < 0.0 || dist[j] < maxdist)) values[j] = elems[j];
+      else values[j] = -1;
+    }
+  }
+  else
+  {
+    std::vector<VMesh::Node::index_type> nodes;
+    mesh->find_closest_node_many(dist,result,nodes,points,maxdist);
+    for (size_t j=0; j<points.size(); j++)
+    {
+      if (nodes[j] >= 0 && (maxdist < 0.0 || dist[j] < maxdist)) values[j] = nodes[j];
+      else values[j] = -1;
+    }
+  }
+}
@@ -30,10 +30,11 @@
 #define CORE_ALGORTIHMS_FIELDS_MAPPING_MAPPING_DATA_SOURCE_H__
 
 #include <vector>
-#include <Core/Datatypes/DatatypeFwd.h>
+#include <Core/Datatypes/Legacy/Field/FieldFwd.h>
 #include <Core/GeometryPrimitives/GeomFwd.h>
 #include <Core/Algorithms/Base/AlgorithmFwd.h>
 #include <Core/Thread/Interruptible.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
 #include <Core/Algorithms/Legacy/Fields/share.h>
 
 namespace SCIRun {
@@ -72,6 +73,26 @@ typedef boost::shared_ptr<MappingDataSource> MappingDataSourceHandle;
 
 MappingDataSourceHandle SCISHARE CreateDataSource(FieldHandle sfield, FieldHandle wfield, const AlgorithmBase* algo);
 
+// Mapping algorithms process the destination values in blocks of this size:
+// the points of a block are looked up in one batched mesh query, which sorts
+// them for locality and runs them in parallel.
+
+const index_type MAPPING_BLOCK_SIZE = 1 << 16;
+
+// Locations of the values [start,end) of a field: the element centers for
+// constant data and the nodes for linear data.
+
+SCISHARE void GetValueCenters(std::vector<Geometry::Point>& points, VMesh* mesh,
+                              int basis_order, index_type start, index_type end);
+
+// Finds the value of mesh closest to each point, the closest element for
+// constant data and the closest node for linear data. Points that are not
+// closer than maxdist get -1; a negative maxdist does not limit the search.
+
+SCISHARE void FindClosestValues(std::vector<index_type>& values, VMesh* mesh,
+                                int basis_order, const std::vector<Geometry::Point>& points,
+                                double maxdist);
+
 }}}}
 
 #endif
@@ -32,11 +32,14 @@
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/ElementGeometry.h>
+#include <Core/Thread/Parallel.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Thread;
 
 ALGORITHM_PARAMETER_DEF(Fields,Metric);
 
@@ -85,7 +88,25 @@ GetMeshQualityFieldAlgo::run(FieldHandle input, FieldHandle& output) const
   
   VField* ofield = output->vfield();
   VMesh*  imesh  = input->vmesh();
-  
+
+  // Linear TetVol, TriSurf and HexVol meshes are done in parallel by the
+  // batch geometry kernels
+  ElementGeometry<double> geometry(imesh);
+  if (geometry.supported() &&
+      (Metric != "insc_circ_ratio" || geometry.type() == ElementGeometry<double>::TET))
+  {
+    std::vector<double> values(imesh->num_elems());
+    Parallel::For(0, values.size(), [&](size_t begin, size_t end)
+    {
+      if (Metric == "scaled_jacobian") geometry.scaled_jacobians(begin, end, &values[begin]);
+      else if (Metric == "jacobian") geometry.jacobians(begin, end, &values[begin]);
+      else if (Metric == "volume") geometry.volumes(begin, end, &values[begin]);
+      else geometry.inscribed_circumscribed_ratios(begin, end, &values[begin]);
+    });
+    ofield->set_values(values);
+    return true;
+  }
+
   if (Metric == "scaled_jacobian")
   {
     VMesh::Elem::size_type num_values = imesh->num_elems();
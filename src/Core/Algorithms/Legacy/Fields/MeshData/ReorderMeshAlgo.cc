@@ -0,0 +1,322 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Algorithms/Legacy/Fields/MeshData/ReorderMeshAlgo.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/PropertyManagerExtensions.h>
+#include <Core/GeometryPrimitives/SpaceFillingCurve.h>
+
+#include <algorithm>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+
+ALGORITHM_PARAMETER_DEF(Fields, NodeOrdering);
+
+AlgorithmOutputName ReorderMeshAlgo::NodeMapping("NodeMapping");
+AlgorithmOutputName ReorderMeshAlgo::ElemMapping("ElemMapping");
+
+ReorderMeshAlgo::ReorderMeshAlgo()
+{
+  addOption(Parameters::NodeOrdering, "hilbert", "hilbert|morton|rcm");
+}
+
+namespace
+{
+  /// Reverse Cuthill-McKee: breadth first search over the node graph of the
+  /// elements, starting each connected component at a node of lowest degree
+  /// and visiting neighbors by increasing degree. Reversing the visit order
+  /// gives the numbering with the smallest profile.
+  void rcm_order(std::vector<index_type>& order, VMesh* mesh)
+  {
+    const size_type num_nodes = mesh->num_nodes();
+    const size_type num_elems = mesh->num_elems();
+
+    // Node to node adjacency in compressed row form: two nodes are neighbors
+    // if they share an element, which is the sparsity of the FE matrix.
+    std::vector<index_type> rows(num_nodes + 1, 0);
+    VMesh::Node::array_type nodes;
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+    {
+      mesh->get_nodes(nodes, idx);
+      for (size_t j = 0; j < nodes.size(); j++)
+        rows[nodes[j] + 1] += static_cast<index_type>(nodes.size()) - 1;
+    }
+    for (size_type i = 0; i < num_nodes; i++) rows[i + 1] += rows[i];
+
+    std::vector<index_type> columns(rows[num_nodes]);
+    std::vector<index_type> fill(rows.begin(), rows.end() - 1);
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+    {
+      mesh->get_nodes(nodes, idx);
+      for (size_t j = 0; j < nodes.size(); j++)
+        for (size_t k = 0; k < nodes.size(); k++)
+          if (j != k) columns[fill[nodes[j]]++] = nodes[k];
+    }
+
+    // Neighbors appear once per shared element, keep one copy
+    std::vector<index_type> degree(num_nodes);
+    for (size_type i = 0; i < num_nodes; i++)
+    {
+      auto begin = columns.begin() + rows[i];
+      auto end = columns.begin() + rows[i + 1];
+      std::sort(begin, end);
+      degree[i] = static_cast<index_type>(std::unique(begin, end) - begin);
+    }
+
+    auto by_degree = [&degree](index_type a, index_type b)
+    {
+      return (degree[a] < degree[b]);
+    };
+
+    std::vector<index_type> starts(num_nodes);
+    for (size_type i = 0; i < num_nodes; i++) starts[i] = i;
+    std::stable_sort(starts.begin(), starts.end(), by_degree);
+
+    order.clear();
+    order.reserve(num_nodes);
+    std::vector<bool> visited(num_nodes, false);
+    std::vector<index_type> next;
+
+    for (size_type s = 0; s < num_nodes; s++)
+    {
+      if (visited[starts[s]]) continue;
+      visited[starts[s]] = true;
+      order.push_back(starts[s]);
+
+      // order doubles as the queue of the search
+      for (size_t q = order.size() - 1; q < order.size(); q++)
+      {
+        const index_type node = order[q];
+        next.clear();
+        for (index_type c = rows[node]; c < rows[node] + degree[node]; c++)
+        {
+          if (!visited[columns[c]])
+          {
+            visited[columns[c]] = true;
+            next.push_back(columns[c]);
+          }
+        }
+        std::stable_sort(next.begin(), next.end(), by_degree);
+        order.insert(order.end(), next.begin(), next.end());
+      }
+    }
+
+    std::reverse(order.begin(), order.end());
+  }
+
+  /// Copies the values of one field into another of the same type, value i of
+  /// the output taken from value order[i] of the input.
+  class PermuteValues
+  {
+  public:
+    PermuteValues(VField* ofield, const std::vector<index_type>& order) :
+      ofield_(ofield), order_(order) {}
+
+    template<class T>
+    void operator()(FieldSpan<T> in)
+    {
+      FieldSpan<T> out = ofield_->data_span<T>();
+      for (size_t i = 0; i < order_.size(); i++) out[i] = in[order_[i]];
+    }
+
+  private:
+    VField* ofield_;
+    const std::vector<index_type>& order_;
+  };
+
+  MatrixHandle mapping_matrix(const std::vector<index_type>& order)
+  {
+    const size_type size = static_cast<size_type>(order.size());
+
+    typedef SparseRowMatrix::Triplet T;
+    std::vector<T> tripletList;
+    tripletList.reserve(size);
+    for (size_type i = 0; i < size; i++)
+      tripletList.push_back(T(i, order[i], 1));
+
+    SparseRowMatrixHandle mat(new SparseRowMatrix(size, size));
+    mat->setFromTriplets(tripletList.begin(), tripletList.end());
+    return mat;
+  }
+}
+
+bool
+ReorderMeshAlgo::run(FieldHandle input, FieldHandle& output,
+                     MatrixHandle& node_mapping, MatrixHandle& elem_mapping) const
+{
+  ScopedAlgorithmStatusReporter asr(this, "ReorderMesh");
+
+  if (!input)
+  {
+    error("No input field");
+    return (false);
+  }
+
+  FieldInformation fi(input);
+
+  if (!fi.is_unstructuredmesh())
+  {
+    error("This algorithm only works on an unstructured mesh");
+    return (false);
+  }
+
+  if (fi.is_nonlinear())
+  {
+    error("This algorithm has not yet been defined for non-linear elements");
+    return (false);
+  }
+
+  VField* ifield = input->vfield();
+  VMesh*  imesh  = input->vmesh();
+
+  const size_type num_nodes = imesh->num_nodes();
+  const size_type num_elems = imesh->num_elems();
+  const std::string method = getOption(Parameters::NodeOrdering);
+
+  std::vector<Point> points(num_nodes);
+  for (VMesh::Node::index_type idx = 0; idx < num_nodes; idx++)
+    imesh->get_center(points[idx], idx);
+
+  // node_order and elem_order hold the old index of each new index
+  std::vector<index_type> node_order;
+  std::vector<index_type> elem_order;
+  std::vector<index_type> node_rank(num_nodes);
+
+  if (method == "rcm")
+  {
+    rcm_order(node_order, imesh);
+    for (size_type i = 0; i < num_nodes; i++) node_rank[node_order[i]] = i;
+
+    // Elements follow their lowest numbered node, keeping the elements that
+    // reference a node together
+    std::vector<index_type> first_node(num_elems);
+    VMesh::Node::array_type nodes;
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+    {
+      imesh->get_nodes(nodes, idx);
+      index_type lowest = num_nodes;
+      for (size_t j = 0; j < nodes.size(); j++)
+        lowest = std::min(lowest, node_rank[nodes[j]]);
+      first_node[idx] = lowest;
+    }
+
+    elem_order.resize(num_elems);
+    for (size_type i = 0; i < num_elems; i++) elem_order[i] = i;
+    std::stable_sort(elem_order.begin(), elem_order.end(),
+      [&first_node](index_type a, index_type b) { return (first_node[a] < first_node[b]); });
+  }
+  else
+  {
+    std::vector<Point> centers(num_elems);
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+      imesh->get_center(centers[idx], idx);
+
+    if (method == "morton")
+    {
+      morton_order(node_order, points);
+      morton_order(elem_order, centers);
+    }
+    else
+    {
+      hilbert_order(node_order, points);
+      hilbert_order(elem_order, centers);
+    }
+    for (size_type i = 0; i < num_nodes; i++) node_rank[node_order[i]] = i;
+  }
+
+  output = CreateField(fi);
+  if (!output)
+  {
+    error("Could not allocate output field");
+    return (false);
+  }
+
+  VField* ofield = output->vfield();
+  VMesh*  omesh  = output->vmesh();
+
+  omesh->node_reserve(num_nodes);
+  for (size_type i = 0; i < num_nodes; i++)
+    omesh->add_point(points[node_order[i]]);
+
+  omesh->elem_reserve(num_elems);
+  VMesh::Node::array_type nodes;
+  for (size_type i = 0; i < num_elems; i++)
+  {
+    imesh->get_nodes(nodes, VMesh::Elem::index_type(elem_order[i]));
+    for (size_t j = 0; j < nodes.size(); j++) nodes[j] = node_rank[nodes[j]];
+    omesh->add_elem(nodes);
+  }
+
+  ofield->resize_values();
+
+  if (ofield->basis_order() == 0 || ofield->basis_order() == 1)
+  {
+    const std::vector<index_type>& order =
+      (ofield->basis_order() == 0) ? elem_order : node_order;
+
+    PermuteValues permute(ofield, order);
+    if (!dispatch_values(ifield, permute))
+    {
+      for (size_t i = 0; i < order.size(); i++)
+        ofield->copy_value(ifield, order[i], i);
+    }
+  }
+
+  CopyProperties(*input, *output);
+
+  node_mapping = mapping_matrix(node_order);
+  elem_mapping = mapping_matrix(elem_order);
+
+  return (true);
+}
+
+AlgorithmOutput
+ReorderMeshAlgo::run(const AlgorithmInput& input) const
+{
+  auto field = input.get<Field>(Variables::InputField);
+
+  FieldHandle output_field;
+  MatrixHandle node_mapping, elem_mapping;
+  if (!run(field, output_field, node_mapping, elem_mapping))
+    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.");
+
+  AlgorithmOutput output;
+  output[Variables::OutputField] = output_field;
+  output[NodeMapping] = node_mapping;
+  output[ElemMapping] = elem_mapping;
+  return output;
+}
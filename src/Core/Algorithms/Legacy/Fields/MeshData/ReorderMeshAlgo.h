@@ -0,0 +1,75 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_ALGORITHMS_LEGACY_FIELDS_MESHDATA_REORDERMESH_H
+#define CORE_ALGORITHMS_LEGACY_FIELDS_MESHDATA_REORDERMESH_H 1
+
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Datatypes/DatatypeFwd.h>
+
+#include <Core/Algorithms/Legacy/Fields/share.h>
+
+namespace SCIRun {
+    namespace Core {
+        namespace Algorithms {
+            namespace Fields {
+
+ALGORITHM_PARAMETER_DECL(NodeOrdering);
+
+/// Renumbers the nodes and elements of an unstructured mesh so that entities
+/// that are close in space are also close in memory. Assembly and solver loops
+/// that run over the renumbered mesh then touch fewer cache lines.
+///
+/// hilbert, morton: nodes and elements are sorted along a space-filling curve
+///   through the bounding box of the mesh.
+/// rcm: nodes are numbered by reverse Cuthill-McKee over the element
+///   connectivity, which minimizes the bandwidth of the FE matrix. Elements
+///   follow their lowest numbered node.
+///
+/// The field data and properties move with the mesh. The two mapping matrices
+/// have one entry per row, row = new index and column = old index, so applying
+/// one to the old data gives the data in the new numbering.
+class SCISHARE ReorderMeshAlgo : public AlgorithmBase
+{
+  public:
+    ReorderMeshAlgo();
+
+    static AlgorithmOutputName NodeMapping;
+    static AlgorithmOutputName ElemMapping;
+
+    bool run(FieldHandle input, FieldHandle& output,
+             Datatypes::MatrixHandle& node_mapping,
+             Datatypes::MatrixHandle& elem_mapping) const;
+    virtual AlgorithmOutput run(const AlgorithmInput& input) const override;
+};
+
+}}}}
+
+#endif
@@ -28,6 +28,7 @@
 #include <Core/Algorithms/Legacy/Fields/MeshDerivatives/GetCentroids.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/ElementGeometry.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/GeometryPrimitives/Vector.h>
@@ -35,15 +36,37 @@
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <boost/unordered_map.hpp>
 #include <Core/Algorithms/Legacy/Fields/RegisterWithCorrespondences.h>
+#include <Core/Thread/Parallel.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
 
 ALGORITHM_PARAMETER_DEF(Fields, Centroids);
 
+namespace
+{
+  // Element centers of linear TetVol, TriSurf and HexVol meshes, computed in
+  // parallel by the batch geometry kernels. False for other meshes.
+  bool get_element_centers(VMesh* imesh, VMesh* omesh)
+  {
+    ElementGeometry<double> geometry(imesh);
+    if (!geometry.supported())
+      return false;
+
+    omesh->resize_nodes(geometry.num_elems());
+    Point* points = omesh->get_points_pointer();
+    Parallel::For(0, geometry.num_elems(), [&](size_t begin, size_t end)
+    {
+      geometry.centers(begin, end, points + begin);
+    });
+    return true;
+  }
+}
+
 GetCentroids::GetCentroids()
 {
   addOption(Parameters::Centroids,"Element","Node|Edge|Face|Cell|Element|DElement");
@@ -81,13 +104,16 @@ AlgorithmOutput GetCentroids::run(const AlgorithmInput& input) const
   
   if (centroids=="Element")
   {
-    VField::size_type num_elems = imesh->num_elems();
-    omesh->reserve_nodes(num_elems);
-    for (VMesh::Elem::index_type idx=0; idx < num_elems; idx++)
+    if (!get_element_centers(imesh, omesh))
     {
-      Point p;
-      imesh->get_center(p,idx);
-      omesh->add_node(p);
+      VField::size_type num_elems = imesh->num_elems();
+      omesh->reserve_nodes(num_elems);
+      for (VMesh::Elem::index_type idx=0; idx < num_elems; idx++)
+      {
+        Point p;
+        imesh->get_center(p,idx);
+        omesh->add_node(p);
+      }
     }
 
     output = CreateField(fo,mesh);
@@ -155,13 +181,17 @@ AlgorithmOutput GetCentroids::run(const AlgorithmInput& input) const
     VMesh::Face::size_type num_faces;
     imesh->size(num_faces);
     remark("in between");
-    omesh->reserve_nodes(num_faces);
     remark("Before for loop");
-    for (VMesh::Face::index_type idx=0; idx < num_faces; idx++)
+    // The faces of a surface are its elements
+    if (!imesh->is_surface() || !get_element_centers(imesh, omesh))
     {
-      Point p;
-      imesh->get_center(p,idx);
-      omesh->add_node(p);
+      omesh->reserve_nodes(num_faces);
+      for (VMesh::Face::index_type idx=0; idx < num_faces; idx++)
+      {
+        Point p;
+        imesh->get_center(p,idx);
+        omesh->add_node(p);
+      }
     }
 
     output = CreateField(fo,mesh);
@@ -177,13 +207,17 @@ AlgorithmOutput GetCentroids::run(const AlgorithmInput& input) const
 
   else if (centroids=="Cell")
   {
-    VMesh::size_type num_cells = imesh->num_cells();
-    omesh->reserve_nodes(num_cells);
-    for (VMesh::Cell::index_type idx=0; idx < num_cells; idx++)
+    // The cells of a volume are its elements
+    if (!imesh->is_volume() || !get_element_centers(imesh, omesh))
     {
-      Point p;
-      imesh->get_center(p,idx);
-      omesh->add_node(p);
+      VMesh::size_type num_cells = imesh->num_cells();
+      omesh->reserve_nodes(num_cells);
+      for (VMesh::Cell::index_type idx=0; idx < num_cells; idx++)
+      {
+        Point p;
+        imesh->get_center(p,idx);
+        omesh->add_node(p);
+      }
     }
     output = CreateField(fo,mesh);
     output->vfield()->resize_values();
@@ -54,12 +54,12 @@ ScaleFieldMeshAndDataAlgo::ScaleFieldMeshAndDataAlgo()
 namespace
 {
   template <class T>
-  void scale(double scale, FieldHandle output)
+  void scale(double scale, VField* ofield)
   {
     std::vector<T> values;
-    output->vfield()->get_values(values);
+    ofield->get_values(values);
     for (size_t j=0;j<values.size();j++) values[j] = static_cast<T>(scale*values[j]);
-    output->vfield()->set_values(values);
+    ofield->set_values(values);
   }
 }
 
@@ -78,10 +78,12 @@ ScaleFieldMeshAndDataAlgo::runImpl(FieldHandle input, FieldHandle& output) const
   double datascale = get(Parameters::data_scale).toDouble();
   double meshscale = get(Parameters::mesh_scale).toDouble();
 
+  // Only the parts that get scaled are copied; with unit scales the input is passed on as is.
+  FieldCopyOnWrite field(input);
+
   // scale mesh, only when needed
   if (scale_from_center || (meshscale != 1.0))
   {
-    output.reset(input->deep_clone());
     Transform tf;
     BBox box = input->vmesh()->get_bounding_box();
     Vector center = 0.5*(box.get_min()+box.get_max());
@@ -91,37 +93,35 @@ ScaleFieldMeshAndDataAlgo::runImpl(FieldHandle input, FieldHandle& output) const
     tf.pre_scale(Vector(meshscale,meshscale,meshscale));
     if (scale_from_center) tf.pre_translate(center);
     
-    output->vmesh()->transform(tf);
+    field.writeDeep().vmesh()->transform(tf);
   }
-  else
+
+  if (datascale != 1.0)
   {
-    output.reset(input->clone());
+    VField* ofield = field.write().vfield();
+    if (ofield->is_tensor()) scale<Tensor>(datascale,ofield);
+    if (ofield->is_vector()) scale<Vector>(datascale,ofield);
+    if (ofield->is_double()) scale<double>(datascale,ofield);
+    if (ofield->is_float()) scale<float>(datascale,ofield);
+    if (ofield->is_char()) scale<char>(datascale,ofield);
+    if (ofield->is_unsigned_char()) scale<unsigned char>(datascale,ofield);
+    if (ofield->is_short()) scale<short>(datascale,ofield);
+    if (ofield->is_unsigned_short()) scale<unsigned short>(datascale,ofield);
+    if (ofield->is_int()) scale<int>(datascale,ofield);
+    if (ofield->is_unsigned_int()) scale<unsigned int>(datascale,ofield);
+    if (ofield->is_longlong()) scale<long long>(datascale,ofield);
+    if (ofield->is_unsigned_longlong()) scale<unsigned long long>(datascale,ofield);
   }
 
+  output = field.handle();
   if (!output)
   {
     error("Could not allocate output field");
     return (false);  
   }   
 
-  if (datascale != 1.0)
-  {
-    VField* ofield = output->vfield();
-    if (ofield->is_tensor()) scale<Tensor>(datascale,output);
-    if (ofield->is_vector()) scale<Vector>(datascale,output);
-    if (ofield->is_double()) scale<double>(datascale,output);
-    if (ofield->is_float()) scale<float>(datascale,output);
-    if (ofield->is_char()) scale<char>(datascale,output);
-    if (ofield->is_unsigned_char()) scale<unsigned char>(datascale,output);
-    if (ofield->is_short()) scale<short>(datascale,output);
-    if (ofield->is_unsigned_short()) scale<unsigned short>(datascale,output);
-    if (ofield->is_int()) scale<int>(datascale,output);
-    if (ofield->is_unsigned_int()) scale<unsigned int>(datascale,output);
-    if (ofield->is_longlong()) scale<long long>(datascale,output);
-    if (ofield->is_unsigned_longlong()) scale<unsigned long long>(datascale,output);
-  }
-
-  CopyProperties(*input, *output);
+  if (output != input)
+    CopyProperties(*input, *output);
   return true;
 }
 
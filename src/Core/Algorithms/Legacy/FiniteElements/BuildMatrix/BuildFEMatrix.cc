@@ -66,14 +66,50 @@ namespace SCIRun {
         template <typename T>
         using matrix_pointer_type = boost::shared_ptr<matrix_type<T>>;
 
+/// CSR structure of a stiffness matrix together with the mesh it was derived from.
+/// The structure depends only on the mesh connectivity, so a new conductivity
+/// assignment on the same mesh can skip the neighborhood search entirely.
+class FEMatrixSparsityPattern
+{
+public:
+  bool matches(MeshHandle mesh, index_type dimension) const
+  {
+    return mesh_.lock() == mesh && generation_ == mesh->topologyGeneration() &&
+      numElems_ == mesh->vmesh()->num_elems() && dimension_ == dimension;
+  }
+
+  void record(MeshHandle mesh, index_type dimension, const index_type* outer, const index_type* inner)
+  {
+    mesh_ = mesh;
+    generation_ = mesh->topologyGeneration();
+    numElems_ = mesh->vmesh()->num_elems();
+    dimension_ = dimension;
+    outer_.assign(outer, outer + dimension + 1);
+    inner_.assign(inner, inner + outer[dimension]);
+  }
+
+  void clear() { mesh_.reset(); }
+
+  const std::vector<index_type>& outer() const { return outer_; }
+  const std::vector<index_type>& inner() const { return inner_; }
+
+private:
+  boost::weak_ptr<Mesh> mesh_;
+  unsigned int generation_ = 0;
+  size_type numElems_ = 0;
+  index_type dimension_ = 0;
+  std::vector<index_type> outer_, inner_;
+};
+
 template <typename T>
 class BuildFEMatrixAlgoImpl
 {
 public:
-  explicit BuildFEMatrixAlgoImpl(const AlgorithmBase* algo) : algo_(algo) {}
+  BuildFEMatrixAlgoImpl(const AlgorithmBase* algo, FEMatrixSparsityPattern* pattern) : algo_(algo), pattern_(pattern) {}
   bool run(FieldHandle input, Datatypes::DenseMatrixHandle ctable, matrix_pointer_type<T>& output) const;
 private:
   const AlgorithmBase* algo_;
+  FEMatrixSparsityPattern* pattern_;
   mutable int generation_ = 0;
   mutable std::vector<std::vector<T>> basis_values_;
   mutable matrix_pointer_type<T> basis_fematrix_;
@@ -84,10 +120,11 @@ template <typename T>
 class FEMBuilder
 {
 public:
-  explicit FEMBuilder(const AlgorithmBase* algo) :
+  FEMBuilder(const AlgorithmBase* algo, FEMatrixSparsityPattern* pattern) :
     algo_(algo), numprocessors_(Parallel::NumCores()),
     barrier_("FEMBuilder Barrier", numprocessors_),
     mesh_(nullptr), field_(nullptr),
+    pattern_(pattern), reusePattern_(false),
     domain_dimension(0), local_dimension_nodes(0),
     local_dimension_add_nodes(0),
     local_dimension_derivatives(0),
@@ -110,13 +147,18 @@ private:
 
   VMesh* mesh_;
   VField *field_;
+  MeshHandle meshHandle_;
+  FEMatrixSparsityPattern* pattern_;
+  bool reusePattern_;
 
   matrix_pointer_type<T> fematrix_;
 
   std::vector<bool> success_;
+  // per thread: an entry was missing from the reused pattern
+  std::vector<char> patternMissed_;
 
+  // row starts relative to the owning thread's column arena
   boost::shared_array<index_type> rows_;
-  boost::shared_array<index_type> allcols_;
   std::vector<index_type> colidx_;
 
   index_type domain_dimension;
@@ -138,10 +180,25 @@ private:
   // Entry point for the parallel version
   void parallel(int proc);
 
-  void add_lcl_gbl(index_type row, const std::vector<index_type> &cols, const std::vector<T> &lcl_a)
+  // The pattern should already hold every (row, col) pair, so this is a search within the row, never an insertion.
+  // Returns false if a reused pattern lacks one, which happens when the mesh was edited without changing its
+  // topology generation; the entry is dropped and the caller rebuilds the pattern.
+  bool add_lcl_gbl(index_type row, const std::vector<index_type> &cols, const std::vector<T> &lcl_a)
   {
+    const auto inner = fematrix_->innerIndexPtr();
+    const auto rowBegin = inner + fematrix_->outerIndexPtr()[row];
+    const auto rowEnd = inner + fematrix_->outerIndexPtr()[row + 1];
+    auto values = fematrix_->valuePtr();
+    auto found = true;
     for (size_t i = 0; i < lcl_a.size(); i++)
-      fematrix_->coeffRef(row, cols[i]) += lcl_a[i];
+    {
+      auto it = std::lower_bound(rowBegin, rowEnd, cols[i]);
+      if (it != rowEnd && *it == cols[i])
+        values[it - inner] += lcl_a[i];
+      else
+        found = false;
+    }
+    return found;
   }
 
   void create_numerical_integration(std::vector<VMesh::coords_type>& p,
@@ -174,6 +231,7 @@ FEMBuilder<T>::build_matrix(FieldHandle input,
   // Get virtual interface to data
   field_ = input->vfield();
   mesh_  = input->vmesh();
+  meshHandle_ = input->mesh();
 
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   // If we have the Conductivity property use it, if not we assume the values on
@@ -253,6 +311,7 @@ FEMBuilder<T>::build_matrix(FieldHandle input,
   }
 
   success_.resize(numprocessors_,true);
+  patternMissed_.assign(numprocessors_, 0);
 
   // Start the multi threaded FE matrix builder.
   Parallel::RunTasks([this](int i) { parallel(i); }, numprocessors_);
@@ -267,6 +326,13 @@ FEMBuilder<T>::build_matrix(FieldHandle input,
     }
   }
 
+  if (std::find(patternMissed_.begin(), patternMissed_.end(), 1) != patternMissed_.end())
+  {
+    LOG_DEBUG("BuildFEMatrix: mesh connectivity no longer matches the cached sparsity pattern, rebuilding it");
+    pattern_->clear();
+    return build_matrix(input, ctable, output);
+  }
+
   // Make sure it is symmetric
   if (algo_->get(BuildFEMatrixAlgo::ForceSymmetry).toBool())
   {
@@ -669,8 +735,12 @@ FEMBuilder<T>::setup()
     algo_->error("Mesh size < 0");
     success_[0] = false;
   }
-  LOG_DEBUG("Allocating buffer for nonzero row indices of size: {}", global_dimension+1);
-  rows_.reset(new index_type[global_dimension+1]);
+  reusePattern_ = pattern_ && pattern_->matches(meshHandle_, global_dimension);
+  if (!reusePattern_)
+  {
+    LOG_DEBUG("Allocating buffer for nonzero row indices of size: {}", global_dimension+1);
+    rows_.reset(new index_type[global_dimension+1]);
+  }
 
   colidx_.resize(numprocessors_+1);
   return true;
@@ -715,6 +785,8 @@ FEMBuilder<T>::parallel(int proc_num)
   const index_type end_gd  = (global_dimension * (proc_num+1))/numprocessors_;
 
   /// creating sparse matrix structure
+  /// Pass 1 (count): the columns of this thread's rows are collected in one
+  /// arena per thread, the row starts are kept relative to that arena.
   std::vector<index_type> mycols;
 
   VMesh::Elem::array_type ca;
@@ -722,87 +794,89 @@ FEMBuilder<T>::parallel(int proc_num)
   VMesh::Edge::array_type ea;
   std::vector<index_type> neib_dofs;
 
-  /// loop over system dofs for this thread
   int cnt = 0;
   size_type size_gd = end_gd-start_gd;
   auto updateFrequency = 2*size_gd / 100;
-  try
+  if (!reusePattern_)
   {
-    mycols.reserve((end_gd - start_gd)*local_dimension*8);  //<! rough estimate
-
-    for (VMesh::Node::index_type i = start_gd; i<end_gd; ++i)
+    try
     {
-      rows_[i] = mycols.size();
+      mycols.reserve((end_gd - start_gd)*local_dimension*8);  //<! rough estimate
 
-      neib_dofs.clear();
-      /// check for nodes
-      if (i < global_dimension_nodes)
+      for (VMesh::Node::index_type i = start_gd; i<end_gd; ++i)
       {
-        /// get neighboring cells for node
-        mesh_->get_elems(ca, i);
-      }
-      else if (i < global_dimension_nodes+global_dimension_add_nodes)
-      {
-        /// check for additional nodes at edges
-        /// get neighboring cells for node
-        VMesh::Edge::index_type ii(i-global_dimension_nodes);
-        mesh_->get_elems(ca,ii);
-      }
-      else
-      {
-        // There is some functionality implemented for higher order basis functions,
-        // but it seems not to be accessible, entirely implemented nor validated.
-        algo_->warning("BuildFEMatrix only supports linear basis functions.");
-      }
-
-      for(size_t j = 0; j < ca.size(); j++)
-      {
-        /// get neighboring nodes
-        mesh_->get_nodes(na, ca[j]);
+        rows_[i] = mycols.size();
 
-        for(size_t k = 0; k < na.size(); k++)
+        neib_dofs.clear();
+        /// check for nodes
+        if (i < global_dimension_nodes)
+        {
+          /// get neighboring cells for node
+          mesh_->get_elems(ca, i);
+        }
+        else if (i < global_dimension_nodes+global_dimension_add_nodes)
+        {
+          /// check for additional nodes at edges
+          /// get neighboring cells for node
+          VMesh::Edge::index_type ii(i-global_dimension_nodes);
+          mesh_->get_elems(ca,ii);
+        }
+        else
         {
-          neib_dofs.push_back(static_cast<index_type>(na[k]));
+          // There is some functionality implemented for higher order basis functions,
+          // but it seems not to be accessible, entirely implemented nor validated.
+          algo_->warning("BuildFEMatrix only supports linear basis functions.");
         }
 
-        /// check for additional nodes at edges
-        if (global_dimension_add_nodes)
+        for(size_t j = 0; j < ca.size(); j++)
         {
-          /// get neighboring edges
-          mesh_->get_edges(ea, ca[j]);
+          /// get neighboring nodes
+          mesh_->get_nodes(na, ca[j]);
+
+          for(size_t k = 0; k < na.size(); k++)
+          {
+            neib_dofs.push_back(static_cast<index_type>(na[k]));
+          }
 
-          for(size_t k = 0; k < ea.size(); k++)
-            neib_dofs.push_back(global_dimension + ea[k]);
+          /// check for additional nodes at edges
+          if (global_dimension_add_nodes)
+          {
+            /// get neighboring edges
+            mesh_->get_edges(ea, ca[j]);
+
+            for(size_t k = 0; k < ea.size(); k++)
+              neib_dofs.push_back(global_dimension + ea[k]);
+          }
         }
-      }
 
-      std::sort(neib_dofs.begin(), neib_dofs.end());
+        std::sort(neib_dofs.begin(), neib_dofs.end());
 
-      for (size_t j=0; j<neib_dofs.size(); j++)
-      {
-        if (j == 0 || neib_dofs[j] != mycols.back())
+        for (size_t j=0; j<neib_dofs.size(); j++)
         {
-          mycols.push_back(neib_dofs[j]);
+          if (j == 0 || neib_dofs[j] != mycols.back())
+          {
+            mycols.push_back(neib_dofs[j]);
+          }
         }
-      }
-      if (proc_num == 0)
-      {
-        cnt++;
-        if (cnt == updateFrequency)
+        if (proc_num == 0)
         {
-          cnt = 0;
-          algo_->update_progress_max(i,2*size_gd);
+          cnt++;
+          if (cnt == updateFrequency)
+          {
+            cnt = 0;
+            algo_->update_progress_max(i,2*size_gd);
+          }
         }
       }
-    }
 
-    colidx_[proc_num] = mycols.size();
-    success_[proc_num] = true;
-  }
-  catch (...)
-  {
-    algo_->error("BuildFEMatrix crashed mapping out stiffness matrix");
-    success_[proc_num] = false;
+      colidx_[proc_num] = mycols.size();
+      success_[proc_num] = true;
+    }
+    catch (...)
+    {
+      algo_->error("BuildFEMatrix crashed mapping out stiffness matrix");
+      success_[proc_num] = false;
+    }
   }
 
   /// check point
@@ -818,32 +892,36 @@ FEMBuilder<T>::parallel(int proc_num)
   }
 
   std::vector<std::vector<T>> precompute;
-  index_type st = 0;
-
-  if (proc_num == 0)
-    allcols_.reset();
 
+  /// the main thread allocates the CSR storage once, the threads fill it in place
   try
   {
     if (proc_num == 0)
     {
-      for(int i=0; i<numprocessors_; i++)
+      index_type st = 0;
+      if (reusePattern_)
       {
-        const index_type ns = colidx_[i];
-        colidx_[i] = st;
-        st += ns;
+        st = pattern_->outer()[global_dimension];
+      }
+      else
+      {
+        for(int i=0; i<numprocessors_; i++)
+        {
+          const index_type ns = colidx_[i];
+          colidx_[i] = st;
+          st += ns;
+        }
+        colidx_[numprocessors_] = st;
       }
 
-      colidx_[numprocessors_] = st;
-      allcols_.reset(new index_type[st]);
+      fematrix_ = boost::make_shared<matrix_type<T>>(global_dimension, global_dimension);
+      fematrix_->resizeNonZeros(st);
+      fematrix_->outerIndexPtr()[global_dimension] = st;
     }
     success_[proc_num] = true;
   }
   catch (...)
   {
-    if (proc_num == 0)
-      allcols_.reset();
-
     algo_->error("Could not allocate enough memory");
     success_[proc_num] = false;
   }
@@ -858,18 +936,31 @@ FEMBuilder<T>::parallel(int proc_num)
       return;
   }
 
+  /// Pass 2 (fill): every thread writes its rows straight into the matrix
   try
   {
-    /// updating global column by each of the processors
-    const index_type s = colidx_[proc_num];
-    const size_t n = mycols.size();
-
-    for(size_t i=0; i<n; i++)
-      allcols_[i+s] = mycols[i];
-
-    for(index_type i = start_gd; i<end_gd; i++)
-      rows_[i] += s;
+    auto outer = fematrix_->outerIndexPtr();
+    auto inner = fematrix_->innerIndexPtr();
+    if (reusePattern_)
+    {
+      const auto& patternOuter = pattern_->outer();
+      std::copy(patternOuter.begin() + start_gd, patternOuter.begin() + end_gd, outer + start_gd);
+      std::copy(pattern_->inner().begin() + patternOuter[start_gd], pattern_->inner().begin() + patternOuter[end_gd],
+        inner + patternOuter[start_gd]);
+    }
+    else
+    {
+      const index_type s = colidx_[proc_num];
+      for(index_type i = start_gd; i<end_gd; i++)
+        outer[i] = rows_[i] + s;
+      std::copy(mycols.begin(), mycols.end(), inner + s);
+      std::vector<index_type>().swap(mycols);
+    }
 
+    /// zeroing in parallel
+    const auto ns = reusePattern_ ? pattern_->outer()[start_gd] : colidx_[proc_num];
+    const auto ne = reusePattern_ ? pattern_->outer()[end_gd] : colidx_[proc_num+1];
+    std::fill(fematrix_->valuePtr() + ns, fematrix_->valuePtr() + ne, T(0));
     success_[proc_num] = true;
   }
   catch (...)
@@ -888,43 +979,15 @@ FEMBuilder<T>::parallel(int proc_num)
       return;
   }
 
-  try
-  {
-    /// the main thread makes the matrix
-    if (proc_num == 0)
-    {
-      rows_[global_dimension] = st;
-      algo_->remark("Creating fematrix on main thread.");
-      fematrix_ = boost::make_shared<matrix_type<T>>(global_dimension, global_dimension, rows_.get(), allcols_.get(), st);
-      rows_.reset();
-      allcols_.reset();
-    }
-    success_[proc_num] = true;
-  }
-  catch (...)
-  {
-    algo_->error("BuildFEMatrix crashed while creating final stiffness matrix");
-    success_[proc_num] = false;
-  }
-
-  /// check point
-  barrier_.wait();
-
-  // Bail out if one of the processes failed
-  for (auto q=0; q<numprocessors_;q++)
+  if (proc_num == 0)
   {
-    if (!success_[q])
-      return;
+    if (!reusePattern_ && pattern_)
+      pattern_->record(meshHandle_, global_dimension, fematrix_->outerIndexPtr(), fematrix_->innerIndexPtr());
+    rows_.reset();
   }
 
   try
   {
-    /// zeroing in parallel
-    const auto ns = colidx_[proc_num];
-    const auto ne = colidx_[proc_num+1];
-    auto a = &(fematrix_->valuePtr()[ns]), ae=&(fematrix_->valuePtr()[ne]);
-    while (a<ae) *a++=0.0;
-
     std::vector<VMesh::coords_type> ni_points;
     std::vector<double> ni_weights;
     std::vector<std::vector<double>> ni_derivatives;
@@ -977,7 +1040,8 @@ FEMBuilder<T>::parallel(int proc_num)
             if (na[k] == i)
             {
               build_local_matrix_regular(ca[j], k , lsml, ni_points, ni_weights, ni_derivatives,precompute);
-              add_lcl_gbl(i, neib_dofs, lsml);
+              if (!add_lcl_gbl(i, neib_dofs, lsml))
+                patternMissed_[proc_num] = 1;
             }
           }
         }
@@ -1009,7 +1073,8 @@ FEMBuilder<T>::parallel(int proc_num)
             if (na[k] == i)
             {
               build_local_matrix(ca[j], k , lsml, ni_points, ni_weights, ni_derivatives);
-              add_lcl_gbl(i, neib_dofs, lsml);
+              if (!add_lcl_gbl(i, neib_dofs, lsml))
+                patternMissed_[proc_num] = 1;
             }
           }
 
@@ -1020,7 +1085,8 @@ FEMBuilder<T>::parallel(int proc_num)
               if (global_dimension + static_cast<int>(ea[k]) == i)
               {
                 build_local_matrix(ca[j], k+na.size(), lsml, ni_points, ni_weights, ni_derivatives);
-                add_lcl_gbl(i, neib_dofs, lsml);
+                if (!add_lcl_gbl(i, neib_dofs, lsml))
+                  patternMissed_[proc_num] = 1;
               }
             }
           }
@@ -1096,7 +1162,7 @@ BuildFEMatrixAlgoImpl<T>::run(FieldHandle input, DenseMatrixHandle ctable, matri
     }
   }
 
-  FEMBuilder<T> builder(algo_);
+  FEMBuilder<T> builder(algo_, pattern_);
 
   if (algo_->get(BuildFEMatrixAlgo::GenerateBasis).toBool())
   {
@@ -1221,12 +1287,14 @@ AlgorithmOutput BuildFEMatrixAlgo::run(const AlgorithmInput& input) const
 {
   auto field = input.get<Field>(Variables::InputField);
   auto ctable = input.get<DenseMatrix>(Conductivity_Table);
+  if (!pattern_)
+    pattern_.reset(new FEMatrixSparsityPattern);
 
 	AlgorithmOutput output;
   if (field && field->vfield() && field->vfield()->is_complex_double())
 	{
 		matrix_pointer_type<complex> stiffness;
-	  BuildFEMatrixAlgoImpl<complex> impl(this);
+	  BuildFEMatrixAlgoImpl<complex> impl(this, pattern_.get());
 	  if (!impl.run(field, ctable, stiffness))
 	    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.--complex detected	");
 		output[Stiffness_Matrix_Complex] = stiffness;
@@ -1234,7 +1302,7 @@ AlgorithmOutput BuildFEMatrixAlgo::run(const AlgorithmInput& input) const
 	else
 	{
 		matrix_pointer_type<double> stiffness;
-	  BuildFEMatrixAlgoImpl<double> impl(this);
+	  BuildFEMatrixAlgoImpl<double> impl(this, pattern_.get());
 	  if (!impl.run(field, ctable, stiffness))
 	    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.");
 		output[Stiffness_Matrix] = stiffness;
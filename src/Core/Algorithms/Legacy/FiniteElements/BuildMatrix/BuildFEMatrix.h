@@ -39,6 +39,8 @@ namespace SCIRun {
 		namespace Algorithms {
 			namespace FiniteElements {
 
+class FEMatrixSparsityPattern;
+
 class SCISHARE BuildFEMatrixAlgo : public AlgorithmBase
 {
   public:
@@ -62,6 +64,10 @@ class SCISHARE BuildFEMatrixAlgo : public AlgorithmBase
     }
 
     virtual AlgorithmOutput run(const AlgorithmInput &) const override;
+
+  private:
+    // Sparsity of the last mesh, reused while only the conductivities change
+    mutable boost::shared_ptr<FEMatrixSparsityPattern> pattern_;
 };
 
 }}}}
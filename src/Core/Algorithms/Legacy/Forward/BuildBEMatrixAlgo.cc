@@ -55,17 +55,22 @@ DEALINGS IN THE SOFTWARE.
 #include <Core/GeometryPrimitives/Vector.h>
 #include <Core/GeometryPrimitives/Point.h>
 #include <Core/GeometryPrimitives/PointVectorOperators.h>
+#include <Core/Algorithms/Legacy/Forward/HierarchicalMatrix.h>
+#include <Core/Thread/Parallel.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms::Forward;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
 
 ALGORITHM_PARAMETER_DEF(Forward, FieldNameList);
 ALGORITHM_PARAMETER_DEF(Forward, FieldTypeList);
 ALGORITHM_PARAMETER_DEF(Forward, BoundaryConditionList);
 ALGORITHM_PARAMETER_DEF(Forward, InsideConductivityList);
 ALGORITHM_PARAMETER_DEF(Forward, OutsideConductivityList);
+ALGORITHM_PARAMETER_DEF(Forward, UseHierarchicalMatrix);
+ALGORITHM_PARAMETER_DEF(Forward, HierarchicalMatrixTolerance);
 
 void BuildBEMatrixBase::getOmega(
   const Vector& y1,
@@ -515,8 +520,119 @@ public:
   double,
   double,
   const std::vector<double>& );
+
+  // The node positions and triangles of a mesh, copied out once so that the
+  // assembly threads only read plain arrays. Point clouds have no triangles.
+  struct Surface
+  {
+    explicit Surface(VMesh* mesh);
+
+    int numNodes() const { return static_cast<int>(points.size()); }
+    int numFaces() const { return static_cast<int>(faces.size() / 3); }
+    const index_type* face(int f) const { return &faces[3 * f]; }
+
+    std::vector<Vector> points;
+    std::vector<index_type> faces;
+  };
+
+  // The 7 point Radon rule of the G integrals over one triangle, with the
+  // triangle area, the Cruse weights and the Radon weights folded together:
+  // the values for the three vertices are weights * (1/|radon point - op|)
+  struct RadonTriangle
+  {
+    Vector centroid;
+    double weights[3][7];
+  };
+
+  static void radon_rule(DenseMatrix& R_W, double& s, double& r);
+  static std::vector<RadonTriangle> radon_triangles(const Surface& surface, const std::vector<double>& areas);
+  static void radon_g(const Surface& surface, int face, const RadonTriangle& triangle, const Vector& op,
+    double s, double r, DenseMatrix& g_coef, DenseMatrix& g_values);
 };
 
+BuildBEMatrixBaseCompute::Surface::Surface(VMesh* mesh)
+{
+  VMesh::Node::size_type num_nodes;
+  mesh->size(num_nodes);
+  points.resize(num_nodes);
+  for (VMesh::Node::index_type i = 0; i < num_nodes; ++i)
+    points[i] = Vector(mesh->get_point(i));
+
+  if (mesh->is_trisurfmesh())
+  {
+    VMesh::Face::size_type num_faces;
+    mesh->size(num_faces);
+    faces.resize(3 * num_faces);
+    VMesh::Node::array_type nodes;
+    for (VMesh::Face::index_type f = 0; f < num_faces; ++f)
+    {
+      mesh->get_nodes(nodes, f);
+      for (int i = 0; i < 3; ++i)
+        faces[3 * f + i] = nodes[i];
+    }
+  }
+}
+
+void BuildBEMatrixBaseCompute::radon_rule(DenseMatrix& R_W, double& s, double& r)
+{
+  double sqrt15 = sqrt(15.0);
+  R_W.resize(1, 7);
+  R_W(0,0) = 9.0/40.0;
+  R_W(0,1) = (155 + sqrt15) / 1200;
+  R_W(0,2) = R_W(0,1);
+  R_W(0,3) = R_W(0,1);
+  R_W(0,4) = (155 - sqrt15) / 1200;
+  R_W(0,5) = R_W(0,4);
+  R_W(0,6) = R_W(0,4);
+
+  s = (1 - sqrt15) / 7;
+  r = (1 + sqrt15) / 7;
+}
+
+std::vector<BuildBEMatrixBaseCompute::RadonTriangle>
+BuildBEMatrixBaseCompute::radon_triangles(const Surface& surface, const std::vector<double>& areas)
+{
+  DenseMatrix R_W;
+  double s, r;
+  radon_rule(R_W, s, r);
+
+  std::vector<RadonTriangle> triangles(surface.numFaces());
+  Parallel::For(0, triangles.size(), [&](size_t begin, size_t end)
+  {
+    DenseMatrix cruse_weights(3, 7);
+    for (size_t f = begin; f < end; ++f)
+    {
+      const index_type* nodes = surface.face(f);
+      const Vector& p1 = surface.points[nodes[0]];
+      const Vector& p2 = surface.points[nodes[1]];
+      const Vector& p3 = surface.points[nodes[2]];
+
+      get_cruse_weights(p1, p2, p3, s, r, areas[f], cruse_weights);
+      triangles[f].centroid = (p1 + p2 + p3) / 3.0;
+      for (int i = 0; i < 3; ++i)
+        for (int k = 0; k < 7; ++k)
+          triangles[f].weights[i][k] = areas[f] * cruse_weights(i, k) * R_W(0, k);
+    }
+  });
+  return triangles;
+}
+
+void BuildBEMatrixBaseCompute::radon_g(const Surface& surface, int face, const RadonTriangle& triangle,
+  const Vector& op, double s, double r, DenseMatrix& g_coef, DenseMatrix& g_values)
+{
+  const index_type* nodes = surface.face(face);
+  get_g_coef(surface.points[nodes[0]], surface.points[nodes[1]], surface.points[nodes[2]],
+    op, s, r, triangle.centroid, g_coef);
+
+  for (int i = 0; i < 3; ++i)
+  {
+    double g = 0;
+    for (int k = 0; k < 7; ++k)
+      g += triangle.weights[i][k] * g_coef(0, k);
+    g_values(i, 0) = g;
+  }
+}
+
 void BuildBEMatrixBase::make_auto_G_allocate(VMesh* hsurf, DenseMatrixHandle &h_GG_)
 {
   auto nnodes = numNodes(hsurf);
@@ -537,66 +653,42 @@ void BuildBEMatrixBaseCompute::make_auto_G_compute(VMesh* hsurf, MatrixType& aut
   //const double mult = 1/(2*M_PI)*((out_cond - in_cond)/op_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
 
-  VMesh::Node::array_type nodes;
-
-  VMesh::Node::iterator ni, nie;
-  VMesh::Face::iterator fi, fie;
-  DenseMatrix cruse_weights(3, 7);
-  DenseMatrix g_coef(1, 7);
-  DenseMatrix R_W(1,7); // Radon Points Weights
-  DenseMatrix temp(1,7);
-  DenseMatrix g_values(3, 1);
-
-  double area;
-
-  double sqrt15 = sqrt(15.0);
-  //R_W(0,0) = 9/40; // <- Burak! FIX ME!
-  R_W(0,0) = 9.0/40.0;
-  R_W(0,1) = (155 + sqrt15) / 1200;
-  R_W(0,2) = R_W(0,1);
-  R_W(0,3) = R_W(0,1);
-  R_W(0,4) = (155 - sqrt15) / 1200;
-  R_W(0,5) = R_W(0,4);
-  R_W(0,6) = R_W(0,4);
-
-  double s = (1 - sqrt15) / 7;
-  double r = (1 + sqrt15) / 7;
+  const Surface surface(hsurf);
+  const std::vector<RadonTriangle> triangles = radon_triangles(surface, avInn);
 
+  DenseMatrix R_W; // Radon Points Weights
+  double s, r;
+  radon_rule(R_W, s, r);
 
-  hsurf->begin(fi); hsurf->end(fie);
-  for (; fi != fie; ++fi)
-  { //! find contributions from every triangle
-    hsurf->get_nodes(nodes, *fi);
-    Vector p1(hsurf->get_point(nodes[0]));
-    Vector p2(hsurf->get_point(nodes[1]));
-    Vector p3(hsurf->get_point(nodes[2]));
-
-    area = avInn[*fi];
-
-    get_cruse_weights(p1, p2, p3, s, r, area, cruse_weights);
-    Vector centroid = (p1 + p2 + p3) / 3.0;
-    hsurf->begin(ni); hsurf->end(nie);
-    for (; ni != nie; ++ni)
-    { //! for every node
-      VMesh::Node::index_type ppi = *ni;
-      Vector op(hsurf->get_point(ppi));
-
-      if (ppi == nodes[0])       bem_sing(p1, p2, p3, 0, g_values, s, r, R_W);
-      else if (ppi == nodes[1])       bem_sing(p1, p2, p3, 1, g_values, s, r, R_W);
-      else if (ppi == nodes[2])       bem_sing(p1, p2, p3, 2, g_values, s, r, R_W);
-      else
-      {
-        get_g_coef(p1, p2, p3, op, s, r, centroid, g_coef);
-
-        for (int i=0; i<7; i++)  temp(0,i) = g_coef(0,i)*R_W(0,i);
-
-        g_values = area * (cruse_weights * temp.transpose());
-      } // else
-
-      for (int i=0; i<3; ++i)
-        auto_G(ppi, nodes[i])+=g_values(i,0)*mult;
+  //! every thread owns a range of rows and adds the triangles in mesh order,
+  //! so the entries are summed in the same order as by a single thread
+  Parallel::For(0, surface.numNodes(), [&](size_t begin, size_t end)
+  {
+    DenseMatrix g_coef(1, 7);
+    DenseMatrix g_values(3, 1);
+    DenseMatrix weights(R_W);
+
+    for (int f = 0; f < surface.numFaces(); ++f)
+    { //! find contributions from every triangle
+      const index_type* nodes = surface.face(f);
+      const Vector& p1 = surface.points[nodes[0]];
+      const Vector& p2 = surface.points[nodes[1]];
+      const Vector& p3 = surface.points[nodes[2]];
+
+      for (size_t row = begin; row < end; ++row)
+      { //! for every node
+        const index_type ppi = static_cast<index_type>(row);
+
+        if (ppi == nodes[0])       bem_sing(p1, p2, p3, 0, g_values, s, r, weights);
+        else if (ppi == nodes[1])       bem_sing(p1, p2, p3, 1, g_values, s, r, weights);
+        else if (ppi == nodes[2])       bem_sing(p1, p2, p3, 2, g_values, s, r, weights);
+        else radon_g(surface, f, triangles[f], surface.points[ppi], s, r, g_coef, g_values);
+
+        for (int i=0; i<3; ++i)
+          auto_G(ppi, nodes[i])+=g_values(i,0)*mult;
+      }
     }
-  }
+  });
 }
 
 void BuildBEMatrixBase::make_cross_G_allocate(VMesh* hsurf1, VMesh* hsurf2, DenseMatrixHandle &h_GG_)
@@ -618,60 +710,33 @@ void BuildBEMatrixBaseCompute::make_cross_G_compute(VMesh* hsurf1, VMesh* hsurf2
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
   //   out_cond and in_cond belong to hsurf2 and op_cond is the out_cond of hsurf1 for all the surfaces but the outermost surface which in op_cond=in_cond
 
-  VMesh::Node::array_type nodes;
-
-  VMesh::Node::iterator  ni, nie;
-  VMesh::Face::iterator  fi, fie;
-
-  DenseMatrix cruse_weights(3, 7);
-  DenseMatrix g_coef(1, 7);
-  DenseMatrix R_W(1,7); // Radon Points Weights
-  DenseMatrix temp(1,7);
-  DenseMatrix g_values(3, 1);
+  const Surface observers(hsurf1);
+  const Surface surface(hsurf2);
+  const std::vector<RadonTriangle> triangles = radon_triangles(surface, avInn);
 
-  double area;
+  DenseMatrix R_W;
+  double s, r;
+  radon_rule(R_W, s, r);
 
-  double sqrt15 = sqrt(15.0);
-  //R_W(0,0) = 9/40; // <- Burak! FIX ME!
-  R_W(0,0) = 9.0/40.0;
-  R_W(0,1) = (155 + sqrt15) / 1200;
-  R_W(0,2) = R_W(0,1);
-  R_W(0,3) = R_W(0,1);
-  R_W(0,4) = (155 - sqrt15) / 1200;
-  R_W(0,5) = R_W(0,4);
-  R_W(0,6) = R_W(0,4);
-
-  double s = (1 - sqrt15) / 7;
-  double r = (1 + sqrt15) / 7;
-
-  hsurf2->begin(fi); hsurf2->end(fie);
-  for (; fi != fie; ++fi)
-  { //! find contributions from every triangle
-    hsurf2->get_nodes(nodes, *fi);
-    Vector p1(hsurf2->get_point(nodes[0]));
-    Vector p2(hsurf2->get_point(nodes[1]));
-    Vector p3(hsurf2->get_point(nodes[2]));
-
-    area = avInn[*fi];
-
-    get_cruse_weights(p1, p2, p3, s, r, area, cruse_weights);
-    Vector centroid = (p1 + p2 + p3) / 3.0;
-
-    hsurf1->begin(ni); hsurf1->end(nie);
-    for (; ni != nie; ++ni)
-    { //! for every node
-      VMesh::Node::index_type ppi = *ni;
-      Vector op(hsurf1->get_point(ppi));
-      get_g_coef(p1, p2, p3, op, s, r, centroid, g_coef);
+  Parallel::For(0, observers.numNodes(), [&](size_t begin, size_t end)
+  {
+    DenseMatrix g_coef(1, 7);
+    DenseMatrix g_values(3, 1);
 
-      for (int i=0; i<7; i++)  temp(0,i) = g_coef(0,i)*R_W(0,i);
+    for (int f = 0; f < surface.numFaces(); ++f)
+    { //! find contributions from every triangle
+      const index_type* nodes = surface.face(f);
 
-      g_values = area * (cruse_weights * temp.transpose());
+      for (size_t row = begin; row < end; ++row)
+      { //! for every node
+        const index_type ppi = static_cast<index_type>(row);
+        radon_g(surface, f, triangles[f], observers.points[ppi], s, r, g_coef, g_values);
 
-      for (int i=0; i<3; ++i)
-        cross_G(ppi, nodes[i])+=g_values(i,0)*mult;
+        for (int i=0; i<3; ++i)
+          cross_G(ppi, nodes[i])+=g_values(i,0)*mult;
+      }
     }
-  }
+  });
 }
 
 void BuildBEMatrixBase::make_cross_P_allocate(VMesh* hsurf1, VMesh* hsurf2, DenseMatrixHandle &h_PP_)
@@ -691,32 +756,32 @@ void BuildBEMatrixBaseCompute::make_cross_P_compute(VMesh* hsurf1, VMesh* hsurf2
 {
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
   //   out_cond and in_cond belong to hsurf2 and op_cond is the out_cond of hsurf1 for all the surfaces but the outermost surface which in op_cond=in_cond
-  VMesh::Node::array_type nodes;
-  DenseMatrix coef(1, 3);
-  int i;
-
-  VMesh::Node::iterator  ni, nie;
-  VMesh::Face::iterator  fi, fie;
+  const Surface observers(hsurf1);
+  const Surface surface(hsurf2);
 
-  hsurf1->begin(ni); hsurf1->end(nie);
-  for (; ni != nie; ++ni){ //! for every node
-    VMesh::Node::index_type ppi = *ni;
-    Point pp = hsurf1->get_point(ppi);
+  Parallel::For(0, observers.numNodes(), [&](size_t begin, size_t end)
+  {
+    DenseMatrix coef(1, 3);
 
-    hsurf2->begin(fi); hsurf2->end(fie);
-    for (; fi != fie; ++fi){ //! find contributions from every triangle
+    for (size_t row = begin; row < end; ++row)
+    { //! for every node
+      const index_type ppi = static_cast<index_type>(row);
+      const Vector& pp = observers.points[ppi];
 
-      hsurf2->get_nodes(nodes, *fi);
-      Vector v1 = hsurf2->get_point(nodes[0]) - pp;
-      Vector v2 = hsurf2->get_point(nodes[1]) - pp;
-      Vector v3 = hsurf2->get_point(nodes[2]) - pp;
+      for (int f = 0; f < surface.numFaces(); ++f)
+      { //! find contributions from every triangle
+        const index_type* nodes = surface.face(f);
+        Vector v1 = surface.points[nodes[0]] - pp;
+        Vector v2 = surface.points[nodes[1]] - pp;
+        Vector v3 = surface.points[nodes[2]] - pp;
 
-      getOmega(v1, v2, v3, coef);
+        getOmega(v1, v2, v3, coef);
 
-      for (i=0; i<3; ++i)
-        cross_P(ppi, nodes[i])-=coef(0,i)*mult;
+        for (int i=0; i<3; ++i)
+          cross_P(ppi, nodes[i])-=coef(0,i)*mult;
+      }
     }
-  }
+  });
 }
 
 void BuildBEMatrixBase::make_auto_P_allocate(VMesh* hsurf, DenseMatrixHandle &h_PP_)
@@ -740,51 +805,39 @@ int BuildBEMatrixBase::numNodes(VMesh* hsurf)
 template <class MatrixType>
 void BuildBEMatrixBaseCompute::make_auto_P_compute(VMesh* hsurf, MatrixType& auto_P, double in_cond, double out_cond, double op_cond)
 {
-  auto nnodes = auto_P.rows();
-  
-  
-
   //const double mult = 1/(2*M_PI)*((out_cond - in_cond)/op_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
 
-  VMesh::Node::array_type nodes;
-  DenseMatrix coef(1, 3);
-
-  VMesh::Node::iterator ni, nie;
-  VMesh::Face::iterator fi, fie;
+  const Surface surface(hsurf);
 
-  unsigned int i;
-
-  hsurf->begin(ni); hsurf->end(nie);
+  Parallel::For(0, surface.numNodes(), [&](size_t begin, size_t end)
+  {
+    DenseMatrix coef(1, 3);
 
-  for (; ni != nie; ++ni){ //! for every node
-    VMesh::Node::index_type ppi = *ni;
-    Point pp = hsurf->get_point(ppi);
+    for (size_t row = begin; row < end; ++row)
+    { //! for every node
+      const index_type ppi = static_cast<index_type>(row);
+      const Vector& pp = surface.points[ppi];
 
-    hsurf->begin(fi); hsurf->end(fie);
-    
-    for (; fi != fie; ++fi) { //! find contributions from every triangle
+      for (int f = 0; f < surface.numFaces(); ++f)
+      { //! find contributions from every triangle
+        const index_type* nodes = surface.face(f);
+        if (ppi!=nodes[0] && ppi!=nodes[1] && ppi!=nodes[2]){
+          Vector v1 = surface.points[nodes[0]] - pp;
+          Vector v2 = surface.points[nodes[1]] - pp;
+          Vector v3 = surface.points[nodes[2]] - pp;
 
-      hsurf->get_nodes(nodes, *fi);
-      if (ppi!=nodes[0] && ppi!=nodes[1] && ppi!=nodes[2]){
-        Vector v1 = hsurf->get_point(nodes[0]) - pp;
-        Vector v2 = hsurf->get_point(nodes[1]) - pp;
-        Vector v3 = hsurf->get_point(nodes[2]) - pp;
-        
-        getOmega(v1, v2, v3, coef);
+          getOmega(v1, v2, v3, coef);
 
-        for (i=0; i<3; ++i)
-          auto_P(ppi, nodes[i])-=coef(0,i)*mult;
+          for (int i=0; i<3; ++i)
+            auto_P(ppi, nodes[i])-=coef(0,i)*mult;
+        }
       }
-    }
-  }
 
-  //! accounting for autosolid angle
-  auto sumOfRows = auto_P.rowwise().sum().eval();
-  for (i=0; i<nnodes; ++i)
-  {
-    auto_P(i,i) = out_cond - sumOfRows(i);
-  }
+      //! accounting for autosolid angle; the diagonal is still zero here
+      auto_P(ppi, ppi) = out_cond - auto_P.row(ppi).sum();
+    }
+  });
 }
 
 void BuildBEMatrixBase::make_auto_P(VMesh* hsurf, DenseMatrixHandle &h_PP_,
@@ -940,16 +993,217 @@ bool BuildBEMatrixBase::compute_nesting(std::vector<int> &nesting, const std::ve
   return true;
 }
 
+namespace
+{
+  // The nodes of a group of fields, numbered one field after the other as in
+  // the block rows and columns of the dense assembly, with the triangles that
+  // touch every node.
+  class NodeGroup
+  {
+  public:
+    NodeGroup(const bemfield_vector& fields, const std::vector<int>& indices)
+    {
+      first.push_back(0);
+      for (int index : indices)
+      {
+        const int group = static_cast<int>(surfaces.size());
+        surfaces.push_back(BuildBEMatrixBaseCompute::Surface(fields[index].field_->vmesh()));
+        const BuildBEMatrixBaseCompute::Surface& surface = surfaces.back();
+
+        for (const Vector& p : surface.points)
+        {
+          points.push_back(Point(p));
+          field.push_back(group);
+        }
+        first.push_back(static_cast<int>(points.size()));
+
+        std::vector<double> areas;
+        if (surface.numFaces() > 0)
+          BuildBEMatrixBaseCompute::pre_calc_tri_areas(fields[index].field_->vmesh(), areas);
+        radon.push_back(BuildBEMatrixBaseCompute::radon_triangles(surface, areas));
+      }
+
+      faceStart.assign(points.size() + 1, 0);
+      for (size_t g = 0; g < surfaces.size(); ++g)
+        for (index_type n : surfaces[g].faces)
+          faceStart[first[g] + n + 1]++;
+      std::partial_sum(faceStart.begin(), faceStart.end(), faceStart.begin());
+
+      faceList.resize(faceStart.back());
+      std::vector<int> fill(faceStart.begin(), faceStart.end() - 1);
+      for (size_t g = 0; g < surfaces.size(); ++g)
+        for (int f = 0; f < surfaces[g].numFaces(); ++f)
+          for (int i = 0; i < 3; ++i)
+            faceList[fill[first[g] + surfaces[g].face(f)[i]]++] = f;
+    }
+
+    int size() const { return static_cast<int>(points.size()); }
+    int numFields() const { return static_cast<int>(surfaces.size()); }
+    // index of a node within its own field
+    index_type local(int node) const { return node - first[field[node]]; }
+
+    std::vector<Point> points;
+    std::vector<int> field;
+    std::vector<int> first;
+    std::vector<BuildBEMatrixBaseCompute::Surface> surfaces;
+    std::vector<std::vector<BuildBEMatrixBaseCompute::RadonTriangle> > radon;
+    // triangles of node n are faceList[faceStart[n]] .. faceList[faceStart[n + 1] - 1]
+    std::vector<int> faceStart;
+    std::vector<int> faceList;
+  };
+
+  // Entries of a P or G block between two node groups for the hierarchical
+  // matrices. Each triangle of a column node is integrated once per row and
+  // added to all of its vertices in the requested columns, the same sums as
+  // in the dense assembly. mult(a, b) is the conductivity factor of row field
+  // a and column field b. When rows and columns are the same group, nodes of
+  // a triangle take the singular rule (G) or are skipped (P), as in the auto
+  // blocks; the P diagonal is left to the caller.
+  class HierarchicalBEMKernel : public HierarchicalMatrixKernel, public BuildBEMatrixBaseCompute
+  {
+  public:
+    enum Operator { Potential, Current };
+
+    HierarchicalBEMKernel(Operator op, const NodeGroup& rows, const ClusterTree& rowTree,
+      const NodeGroup& cols, const ClusterTree& colTree, const Eigen::MatrixXd& mult) :
+      op_(op), rows_(rows), rowTree_(rowTree), cols_(cols), colTree_(colTree), mult_(mult),
+      square_(&rows == &cols)
+    {
+      radon_rule(R_W_, s_, r_);
+    }
+
+    void fill(int rowBegin, int rowEnd, int colBegin, int colEnd, Eigen::MatrixXd& block) const override
+    {
+      block.setZero();
+      DenseMatrix coef(1, 3);
+      DenseMatrix g_coef(1, 7);
+      DenseMatrix g_values(3, 1);
+      DenseMatrix R_W(R_W_);
+
+      for (int c = colBegin; c < colEnd; ++c)
+      {
+        const int node = colTree_.original(c);
+        const int b = cols_.field[node];
+        const Surface& surface = cols_.surfaces[b];
+
+        for (int t = cols_.faceStart[node]; t < cols_.faceStart[node + 1]; ++t)
+        {
+          const int f = cols_.faceList[t];
+          const index_type* nodes = surface.face(f);
+
+          // the first vertex in the column range does the work for the triangle
+          int column[3];
+          int owner = -1;
+          for (int i = 0; i < 3; ++i)
+          {
+            const int p = colTree_.position(static_cast<int>(cols_.first[b] + nodes[i]));
+            column[i] = (p >= colBegin && p < colEnd) ? p - colBegin : -1;
+            if (owner < 0 && column[i] >= 0) owner = i;
+          }
+          if (nodes[owner] != cols_.local(node))
+            continue;
+
+          const Vector& p1 = surface.points[nodes[0]];
+          const Vector& p2 = surface.points[nodes[1]];
+          const Vector& p3 = surface.points[nodes[2]];
+
+          for (int r = rowBegin; r < rowEnd; ++r)
+          {
+            const int observer = rowTree_.original(r);
+            const int a = rows_.field[observer];
+            const int vertex = (square_ && a == b) ?
+              static_cast<int>(std::find(nodes, nodes + 3, rows_.local(observer)) - nodes) : 3;
+            const Vector op(rows_.points[observer]);
+            const double mult = mult_(a, b);
+
+            if (op_ == Potential)
+            {
+              if (vertex < 3)
+                continue;
+              getOmega(p1 - op, p2 - op, p3 - op, coef);
+              for (int i = 0; i < 3; ++i)
+                if (column[i] >= 0) block(r - rowBegin, column[i]) -= coef(0, i) * mult;
+            }
+            else
+            {
+              if (vertex < 3)
+                bem_sing(p1, p2, p3, vertex, g_values, s_, r_, R_W);
+              else
+                radon_g(surface, f, cols_.radon[b][f], op, s_, r_, g_coef, g_values);
+              for (int i = 0; i < 3; ++i)
+                if (column[i] >= 0) block(r - rowBegin, column[i]) += g_values(i, 0) * mult;
+            }
+          }
+        }
+      }
+    }
+
+  private:
+    Operator op_;
+    const NodeGroup& rows_;
+    const ClusterTree& rowTree_;
+    const NodeGroup& cols_;
+    const ClusterTree& colTree_;
+    Eigen::MatrixXd mult_;
+    bool square_;
+    DenseMatrix R_W_;
+    double s_, r_;
+  };
+
+  // Sets the diagonal of a compressed auto P block: out_cond minus the sum of
+  // the row over the columns of the same field, as make_auto_P_compute does
+  void set_auto_solid_angle(HierarchicalMatrix& P, const NodeGroup& group, const ClusterTree& tree,
+    const std::vector<double>& out_cond)
+  {
+    Eigen::MatrixXd indicator = Eigen::MatrixXd::Zero(group.size(), group.numFields());
+    for (int p = 0; p < group.size(); ++p)
+      indicator(p, group.field[tree.original(p)]) = 1.0;
+
+    Eigen::MatrixXd sums = Eigen::MatrixXd::Zero(group.size(), group.numFields());
+    P.multiply(1.0, indicator, sums);
+
+    Eigen::VectorXd diagonal(group.size());
+    for (int p = 0; p < group.size(); ++p)
+    {
+      const int a = group.field[tree.original(p)];
+      diagonal(p) = out_cond[a] - sums(p, a);
+    }
+    P.addToDiagonal(diagonal);
+  }
+
+  // The dense matrix in the original numbering of a result in tree order
+  DenseMatrixHandle from_tree_order(const Eigen::MatrixXd& x, const ClusterTree& rows, const ClusterTree& cols)
+  {
+    DenseMatrixHandle out(new DenseMatrix(x.rows(), x.cols()));
+    for (int c = 0; c < x.cols(); ++c)
+      for (int r = 0; r < x.rows(); ++r)
+        (*out)(rows.original(r), cols.original(c)) = x(r, c);
+    return out;
+  }
+
+  void add_statistics(BEMStatistics& statistics, const HierarchicalMatrix& H)
+  {
+    statistics.storedBytes += H.memoryBytes();
+    statistics.denseBytes += H.denseBytes();
+    statistics.largestRank = std::max(statistics.largestRank, H.maxRank());
+  }
+}
+
 class SurfaceAndPoints : public BEMAlgoImpl, public BuildBEMatrixBaseCompute
 {
 public:
   virtual MatrixHandle compute(const bemfield_vector& fields) const override;
+private:
+  MatrixHandle compute_compressed(const bemfield_vector& fields, int surface, int nodes) const;
 };
 
 class SurfaceToSurface : public BEMAlgoImpl, public BuildBEMatrixBaseCompute
 {
 public:
   virtual MatrixHandle compute(const bemfield_vector& fields) const override;
+private:
+  MatrixHandle compute_compressed(const bemfield_vector& fields,
+    const std::vector<int>& measurementfieldindices, const std::vector<int>& sourcefieldindices) const;
 };
 
 BEMAlgoPtr BEMAlgoImplFactory::create(const bemfield_vector& fields)
@@ -1089,6 +1343,10 @@ MatrixHandle SurfaceToSurface::compute(const bemfield_vector& fields) const
     }
   }
 
+  statistics_ = BEMStatistics();
+  if (compression_.enabled)
+    return compute_compressed(fields, measurementfieldindices, sourcefieldindices);
+
   std::vector<int> fieldNodeSize(fields.size());
   std::transform(fields.begin(), fields.end(), fieldNodeSize.begin(), [this](const bemfield& f) { return numNodes(f.field_); } );
   DenseBlockMatrix EE(fieldNodeSize, fieldNodeSize);
@@ -1149,6 +1407,9 @@ MatrixHandle SurfaceToSurface::compute(const bemfield_vector& fields) const
 
   printInfo(EJ.matrix(), "EJ");
 
+  statistics_.storedBytes = statistics_.denseBytes =
+    (EE.matrix().size() + EJ.matrix().size()) * sizeof(double);
+
   // This needs to be checked.  It was taken out because the deflation was producing errors
   // Jeroen's matlab code, which was the basis of this code, only does a defation in test cases.
   
@@ -1251,6 +1512,83 @@ MatrixHandle SurfaceToSurface::compute(const bemfield_vector& fields) const
   //MatrixHandle TransferMatrix1 = inv(Pmm - Gms * Gss * Psm) * (Gms * Gss * Pss - Pms);
 }
 
+MatrixHandle SurfaceToSurface::compute_compressed(const bemfield_vector& fields,
+  const std::vector<int>& measurementfieldindices, const std::vector<int>& sourcefieldindices) const
+{
+  // The same blocks as above, built as hierarchical matrices over cluster trees
+  // of the measurement nodes (m) and the source nodes (s). The inverses become
+  // LU factorizations:
+  //   C = Pmm - Gms*(Gss^-1*Psm),  factorized in place of Pmm
+  //   D = Gms*(Gss^-1*Pss) - Pms,  dense as it has the size of T
+  //   T = C^-1*D
+  const NodeGroup measurements(fields, measurementfieldindices);
+  const NodeGroup sources(fields, sourcefieldindices);
+  ClusterTreeHandle mTree(new ClusterTree(measurements.points, compression_.leafSize));
+  ClusterTreeHandle sTree(new ClusterTree(sources.points, compression_.leafSize));
+
+  auto mult = [&fields](int in_out_field) { return 1/(4*M_PI)*(fields[in_out_field].outsideconductivity - fields[in_out_field].insideconductivity); };
+
+  // P takes the conductivities of the column field. G takes those of its own
+  // field on the diagonal blocks and, like the dense assembly of EJ, those of
+  // the field at the source list position elsewhere.
+  auto potential = [&](const std::vector<int>& rowFields, const std::vector<int>& colFields)
+  {
+    Eigen::MatrixXd m(rowFields.size(), colFields.size());
+    for (size_t i = 0; i < rowFields.size(); ++i)
+      for (size_t j = 0; j < colFields.size(); ++j)
+        m(i, j) = mult(colFields[j]);
+    return m;
+  };
+  auto current = [&](const std::vector<int>& rowFields)
+  {
+    Eigen::MatrixXd m(rowFields.size(), sourcefieldindices.size());
+    for (size_t i = 0; i < rowFields.size(); ++i)
+      for (size_t j = 0; j < sourcefieldindices.size(); ++j)
+        m(i, j) = mult(rowFields[i] == sourcefieldindices[j] ? rowFields[i] : static_cast<int>(j));
+    return m;
+  };
+
+  auto build = [&](HierarchicalBEMKernel::Operator op, const NodeGroup& rows, const ClusterTreeHandle& rowTree,
+    const NodeGroup& cols, const ClusterTreeHandle& colTree, const Eigen::MatrixXd& m)
+  {
+    HierarchicalBEMKernel kernel(op, rows, *rowTree, cols, *colTree, m);
+    HierarchicalMatrixHandle H(new HierarchicalMatrix(rowTree, colTree, kernel,
+      compression_.tolerance, compression_.admissibility));
+    add_statistics(statistics_, *H);
+    return H;
+  };
+
+  using K = HierarchicalBEMKernel;
+  auto Pmm = build(K::Potential, measurements, mTree, measurements, mTree, potential(measurementfieldindices, measurementfieldindices));
+  auto Pss = build(K::Potential, sources, sTree, sources, sTree, potential(sourcefieldindices, sourcefieldindices));
+  auto Pms = build(K::Potential, measurements, mTree, sources, sTree, potential(measurementfieldindices, sourcefieldindices));
+  auto Psm = build(K::Potential, sources, sTree, measurements, mTree, potential(sourcefieldindices, measurementfieldindices));
+  auto Gms = build(K::Current, measurements, mTree, sources, sTree, current(measurementfieldindices));
+  auto Gss = build(K::Current, sources, sTree, sources, sTree, current(sourcefieldindices));
+
+  std::vector<double> out_cond;
+  for (int i : measurementfieldindices) out_cond.push_back(fields[i].outsideconductivity);
+  set_auto_solid_angle(*Pmm, measurements, *mTree, out_cond);
+  out_cond.clear();
+  for (int i : sourcefieldindices) out_cond.push_back(fields[i].outsideconductivity);
+  set_auto_solid_angle(*Pss, sources, *sTree, out_cond);
+
+  Gss->factorize();
+  Psm->solveLeft(*Gss);
+  Pmm->addProduct(-1.0, *Gms, *Psm);
+  Psm.reset();
+  Pmm->factorize();
+
+  Eigen::MatrixXd Z = Pss->toDense();
+  Pss.reset();
+  Gss->solve(Z);
+  Eigen::MatrixXd T = -Pms->toDense();
+  Gms->multiply(1.0, Z, T);
+  Pmm->solve(T);
+
+  return from_tree_order(T, *mTree, *sTree);
+}
+
 
 MatrixHandle SurfaceAndPoints::compute(const bemfield_vector& fields) const
 {
@@ -1297,15 +1635,26 @@ MatrixHandle SurfaceAndPoints::compute(const bemfield_vector& fields) const
 
   VMesh *nodes = 0;
   VMesh *surface = 0;
+  int surfaceIndex = 0, nodesIndex = 0;
 
   for (int i=0; i<2; i++)
   {
     if (fields[i].surface)
+    {
       surface = fields[i].field_->vmesh();
+      surfaceIndex = i;
+    }
     else
+    {
       nodes = fields[i].field_->vmesh();
+      nodesIndex = i;
+    }
   }
 
+  statistics_ = BEMStatistics();
+  if (compression_.enabled)
+    return compute_compressed(fields, surfaceIndex, nodesIndex);
+
   DenseMatrixHandle Pss;
   DenseMatrixHandle Gss;
   DenseMatrixHandle Pns;
@@ -1319,5 +1668,44 @@ MatrixHandle SurfaceAndPoints::compute(const bemfield_vector& fields) const
   make_auto_G( surface, Gss, 1.0, 0.0, 1.0, area );
   make_cross_G( nodes, surface, Gns, 1.0, 0.0, 1.0, area );
 
+  statistics_.storedBytes = statistics_.denseBytes =
+    (Pss->size() + Pns->size() + Gss->size() + Gns->size()) * sizeof(double);
+
   return boost::make_shared<DenseMatrix>(*Pns - (*Gns * Gss->inverse() * *Pss));
 }
+
+MatrixHandle SurfaceAndPoints::compute_compressed(const bemfield_vector& fields, int surface, int nodes) const
+{
+  // P_nodes_surf - G_nodes_surf * inv(G_surf_surf) * P_surf_surf with the four
+  // blocks compressed and G_surf_surf factorized
+  const NodeGroup surf(fields, std::vector<int>(1, surface));
+  const NodeGroup points(fields, std::vector<int>(1, nodes));
+  ClusterTreeHandle sTree(new ClusterTree(surf.points, compression_.leafSize));
+  ClusterTreeHandle nTree(new ClusterTree(points.points, compression_.leafSize));
+
+  // in_cond = 1 and out_cond = 0 for all four blocks
+  const Eigen::MatrixXd mult = Eigen::MatrixXd::Constant(1, 1, -1/(4*M_PI));
+
+  auto build = [&](HierarchicalBEMKernel::Operator op, const NodeGroup& rows, const ClusterTreeHandle& rowTree)
+  {
+    HierarchicalBEMKernel kernel(op, rows, *rowTree, surf, *sTree, mult);
+    HierarchicalMatrixHandle H(new HierarchicalMatrix(rowTree, sTree, kernel,
+      compression_.tolerance, compression_.admissibility));
+    add_statistics(statistics_, *H);
+    return H;
+  };
+
+  auto Pss = build(HierarchicalBEMKernel::Potential, surf, sTree);
+  auto Pns = build(HierarchicalBEMKernel::Potential, points, nTree);
+  auto Gss = build(HierarchicalBEMKernel::Current, surf, sTree);
+  auto Gns = build(HierarchicalBEMKernel::Current, points, nTree);
+  set_auto_solid_angle(*Pss, surf, *sTree, std::vector<double>(1, 0.0));
+
+  Gss->factorize();
+  Eigen::MatrixXd Z = Pss->toDense();
+  Gss->solve(Z);
+  Eigen::MatrixXd T = Pns->toDense();
+  Gns->multiply(-1.0, Z, T);
+
+  return from_tree_order(T, *nTree, *sTree);
+}
@@ -55,6 +55,8 @@ namespace SCIRun {
         ALGORITHM_PARAMETER_DECL(BoundaryConditionList);
         ALGORITHM_PARAMETER_DECL(InsideConductivityList);
         ALGORITHM_PARAMETER_DECL(OutsideConductivityList);
+        ALGORITHM_PARAMETER_DECL(UseHierarchicalMatrix);
+        ALGORITHM_PARAMETER_DECL(HierarchicalMatrixTolerance);
 
         typedef std::vector<std::string> FieldTypeListType;
 
@@ -214,11 +216,44 @@ namespace SCIRun {
 
         typedef std::vector<bemfield> bemfield_vector;
 
+        /// Settings of the compressed assembly. When enabled, the P and G blocks
+        /// are built as hierarchical matrices (see HierarchicalMatrix.h) and the
+        /// transfer matrix is computed with their LU factors instead of dense
+        /// inverses. tolerance is the relative accuracy of every compressed block.
+        struct SCISHARE BEMCompression
+        {
+          BEMCompression() : enabled(false), tolerance(1e-6), admissibility(2.0), leafSize(32) {}
+
+          bool enabled;
+          double tolerance;
+          double admissibility;
+          int leafSize;
+        };
+
+        /// Storage of the P and G blocks of the last compute() call, in bytes,
+        /// against the same blocks stored dense
+        struct SCISHARE BEMStatistics
+        {
+          BEMStatistics() : storedBytes(0), denseBytes(0), largestRank(0) {}
+
+          size_t storedBytes;
+          size_t denseBytes;
+          int largestRank;
+        };
+
         class SCISHARE BEMAlgoImpl
         {
         public:
           virtual ~BEMAlgoImpl() {}
           virtual Datatypes::MatrixHandle compute(const bemfield_vector& fields) const = 0;
+
+          void setCompression(const BEMCompression& compression) { compression_ = compression; }
+          const BEMCompression& compression() const { return compression_; }
+          const BEMStatistics& statistics() const { return statistics_; }
+
+        protected:
+          BEMCompression compression_;
+          mutable BEMStatistics statistics_;
         };
 
         typedef boost::shared_ptr<BEMAlgoImpl> BEMAlgoPtr;
@@ -0,0 +1,884 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Algorithms/Legacy/Forward/HierarchicalMatrix.h>
+#include <Core/Thread/Parallel.h>
+#include <Core/Utils/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+using namespace SCIRun::Core::Algorithms::Forward;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+ClusterTree::ClusterTree(const std::vector<Point>& points, int leafSize) :
+  order_(points.size()), position_(points.size())
+{
+  std::iota(order_.begin(), order_.end(), 0);
+  leafSize = std::max(leafSize, 1);
+  clusters_.reserve(4 * points.size() / leafSize + 1);
+  split(points, 0, static_cast<int>(points.size()), leafSize);
+  for (int p = 0; p < size(); ++p)
+    position_[order_[p]] = p;
+}
+
+int ClusterTree::split(const std::vector<Point>& points, int begin, int end, int leafSize)
+{
+  const int index = static_cast<int>(clusters_.size());
+  clusters_.push_back(Cluster());
+
+  Cluster c;
+  c.begin = begin;
+  c.end = end;
+  c.sons[0] = c.sons[1] = -1;
+  for (int k = 0; k < 3; ++k)
+  {
+    c.lo[k] = (begin < end) ? std::numeric_limits<double>::max() : 0.0;
+    c.hi[k] = (begin < end) ? -std::numeric_limits<double>::max() : 0.0;
+  }
+  for (int p = begin; p < end; ++p)
+  {
+    const Point& q = points[order_[p]];
+    for (int k = 0; k < 3; ++k)
+    {
+      c.lo[k] = std::min(c.lo[k], q[k]);
+      c.hi[k] = std::max(c.hi[k], q[k]);
+    }
+  }
+
+  if (end - begin > leafSize)
+  {
+    int axis = 0;
+    for (int k = 1; k < 3; ++k)
+      if (c.hi[k] - c.lo[k] > c.hi[axis] - c.lo[axis]) axis = k;
+
+    const int middle = begin + (end - begin) / 2;
+    std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+      [&points, axis](int a, int b) { return points[a][axis] < points[b][axis]; });
+    c.sons[0] = split(points, begin, middle, leafSize);
+    c.sons[1] = split(points, middle, end, leafSize);
+  }
+
+  clusters_[index] = c;
+  return index;
+}
+
+double ClusterTree::diameter(const Cluster& c)
+{
+  double d2 = 0.0;
+  for (int k = 0; k < 3; ++k)
+    d2 += (c.hi[k] - c.lo[k]) * (c.hi[k] - c.lo[k]);
+  return std::sqrt(d2);
+}
+
+double ClusterTree::distance(const Cluster& a, const Cluster& b)
+{
+  double d2 = 0.0;
+  for (int k = 0; k < 3; ++k)
+  {
+    const double gap = std::max(0.0, std::max(a.lo[k] - b.hi[k], b.lo[k] - a.hi[k]));
+    d2 += gap * gap;
+  }
+  return std::sqrt(d2);
+}
+
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Forward {
+
+        struct HierarchicalBlock
+        {
+          enum Kind { Full, LowRank, Split };
+
+          HierarchicalBlock(const ClusterTree::Cluster& r, const ClusterTree::Cluster& c) :
+            kind(Full), rowBegin(r.begin), rows(r.size()), colBegin(c.begin), cols(c.size()) {}
+
+          HierarchicalBlock& son(int i, int j) const { return *sons[2 * i + j]; }
+          bool isDiagonal() const { return rowBegin == colBegin && rows == cols; }
+
+          Kind kind;
+          int rowBegin, rows;
+          int colBegin, cols;
+          /// Full: the entries; for a factorized diagonal block, L and U packed together
+          Eigen::MatrixXd full;
+          /// LowRank: the block is U*V'
+          Eigen::MatrixXd U, V;
+          /// Row interchanges of a factorized Full diagonal block, P*A = L*U
+          Eigen::PermutationMatrix<Eigen::Dynamic> pivots;
+          /// Split: son(i, j) pairs row son i with column son j
+          std::unique_ptr<HierarchicalBlock> sons[4];
+        };
+
+      }}}}
+
+namespace
+{
+  typedef HierarchicalBlock Block;
+  typedef Eigen::MatrixXd Mat;
+  typedef Eigen::Ref<Mat> MatRef;
+  typedef Eigen::Ref<const Mat> ConstRef;
+
+  /// Blocks with at least this many rows split their recursive work over threads
+  const int parallelBlockRows = 512;
+
+  void inParallel(bool parallel, int count, const std::function<void(int)>& task)
+  {
+    if (!parallel)
+    {
+      for (int i = 0; i < count; ++i) task(i);
+      return;
+    }
+    Parallel::For(0, count, [&task](size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; ++i) task(static_cast<int>(i));
+    }, 1);
+  }
+
+  /// Recompresses U*V' to the smallest rank that keeps the relative Frobenius
+  /// error below eps: orthogonalize both factors, then truncate the SVD of the
+  /// small core.
+  void truncate(Mat& U, Mat& V, double eps)
+  {
+    const Eigen::Index k = U.cols();
+    if (k == 0)
+      return;
+    const Eigen::Index m = U.rows(), n = V.rows();
+    if (m == 0 || n == 0)
+    {
+      U.resize(m, 0);
+      V.resize(n, 0);
+      return;
+    }
+    const Eigen::Index p = std::min(m, k), q = std::min(n, k);
+
+    Eigen::HouseholderQR<Mat> qu(U), qv(V);
+    Mat Ru = qu.matrixQR().topRows(p).triangularView<Eigen::Upper>();
+    Mat Rv = qv.matrixQR().topRows(q).triangularView<Eigen::Upper>();
+    // The core is small; one-sided Jacobi beats the divide and conquer setup
+    // there and needs no preconditioning when it is square
+    Mat core = Ru * Rv.transpose();
+    Mat W, Z;
+    Eigen::VectorXd s;
+    if (p == q && p <= 64)
+    {
+      Eigen::JacobiSVD<Mat, Eigen::NoQRPreconditioner> svd(core, Eigen::ComputeThinU | Eigen::ComputeThinV);
+      s = svd.singularValues();
+      W = svd.matrixU();
+      Z = svd.matrixV();
+    }
+    else
+    {
+      Eigen::BDCSVD<Mat> svd(core, Eigen::ComputeThinU | Eigen::ComputeThinV);
+      s = svd.singularValues();
+      W = svd.matrixU();
+      Z = svd.matrixV();
+    }
+
+    const double allowed = eps * eps * s.squaredNorm();
+    Eigen::Index rank = s.size();
+    double dropped = 0.0;
+    while (rank > 0 && dropped + s(rank - 1) * s(rank - 1) <= allowed)
+    {
+      dropped += s(rank - 1) * s(rank - 1);
+      --rank;
+    }
+
+    U = Mat::Zero(m, rank);
+    U.topRows(p) = W.leftCols(rank) * s.head(rank).asDiagonal();
+    U.applyOnTheLeft(qu.householderQ());
+    V = Mat::Zero(n, rank);
+    V.topRows(q) = Z.leftCols(rank);
+    V.applyOnTheLeft(qv.householderQ());
+  }
+
+  /// Adaptive cross approximation with partial pivoting: adds one rank one
+  /// cross per step, built from a row and a column of the residual, until the
+  /// newest cross is below eps times the approximation. Returns false when the
+  /// rank grows past the point where full storage would be smaller.
+  bool crossApproximation(const HierarchicalMatrixKernel& kernel, const Block& b, double eps, Mat& U, Mat& V)
+  {
+    const int m = b.rows, n = b.cols;
+    const int maxRank = std::min(m, n) / 2;
+    std::vector<Eigen::VectorXd> us, vs;
+    std::vector<bool> used(m, false);
+    Mat row(1, n), col(m, 1);
+    double norm2 = 0.0;
+    int pivot = 0;
+    bool converged = false;
+
+    while (!converged && static_cast<int>(us.size()) < maxRank)
+    {
+      used[pivot] = true;
+      kernel.fill(b.rowBegin + pivot, b.rowBegin + pivot + 1, b.colBegin, b.colBegin + n, row);
+      Eigen::VectorXd v = row.row(0).transpose();
+      for (size_t l = 0; l < us.size(); ++l)
+        v -= us[l](pivot) * vs[l];
+
+      Eigen::Index j;
+      const double largest = v.cwiseAbs().maxCoeff(&j);
+      if (largest == 0.0)
+      {
+        // The row is reproduced exactly, try the next unused one
+        pivot = static_cast<int>(std::find(used.begin(), used.end(), false) - used.begin());
+        converged = (pivot == m);
+        continue;
+      }
+
+      kernel.fill(b.rowBegin, b.rowBegin + m, b.colBegin + j, b.colBegin + j + 1, col);
+      Eigen::VectorXd u = col.col(0);
+      for (size_t l = 0; l < us.size(); ++l)
+        u -= vs[l](j) * us[l];
+      v /= v(j);
+
+      double overlap = 0.0;
+      for (size_t l = 0; l < us.size(); ++l)
+        overlap += us[l].dot(u) * vs[l].dot(v);
+      const double cross2 = u.squaredNorm() * v.squaredNorm();
+      norm2 += cross2 + 2.0 * overlap;
+      us.push_back(u);
+      vs.push_back(v);
+      converged = (cross2 <= eps * eps * norm2);
+
+      double next = -1.0;
+      pivot = m;
+      for (int i = 0; i < m; ++i)
+      {
+        if (!used[i] && std::fabs(u(i)) > next)
+        {
+          next = std::fabs(u(i));
+          pivot = i;
+        }
+      }
+      if (pivot == m)
+        converged = true;
+    }
+
+    if (!converged)
+      return false;
+
+    const int rank = static_cast<int>(us.size());
+    U.resize(m, rank);
+    V.resize(n, rank);
+    for (int l = 0; l < rank; ++l)
+    {
+      U.col(l) = us[l];
+      V.col(l) = vs[l];
+    }
+    truncate(U, V, eps);
+    return true;
+  }
+
+  std::unique_ptr<Block> buildBlocks(const ClusterTree& rows, const ClusterTree& cols, int rc, int cc,
+    double admissibility, std::vector<Block*>& leaves)
+  {
+    const ClusterTree::Cluster& r = rows.cluster(rc);
+    const ClusterTree::Cluster& c = cols.cluster(cc);
+    std::unique_ptr<Block> block(new Block(r, c));
+
+    const double dist = ClusterTree::distance(r, c);
+    if (dist > 0.0 && std::min(ClusterTree::diameter(r), ClusterTree::diameter(c)) <= admissibility * dist)
+    {
+      block->kind = Block::LowRank;
+    }
+    else if (!r.isLeaf() && !c.isLeaf())
+    {
+      block->kind = Block::Split;
+      for (int i = 0; i < 2; ++i)
+        for (int j = 0; j < 2; ++j)
+          block->sons[2 * i + j] = buildBlocks(rows, cols, r.sons[i], c.sons[j], admissibility, leaves);
+      return block;
+    }
+    leaves.push_back(block.get());
+    return block;
+  }
+
+  void fillBlock(const HierarchicalMatrixKernel& kernel, Block& b, double eps)
+  {
+    if (b.kind == Block::LowRank && crossApproximation(kernel, b, eps, b.U, b.V))
+      return;
+    b.kind = Block::Full;
+    b.full.resize(b.rows, b.cols);
+    if (b.rows > 0 && b.cols > 0)
+      kernel.fill(b.rowBegin, b.rowBegin + b.rows, b.colBegin, b.colBegin + b.cols, b.full);
+  }
+
+  /// y += alpha*A*x over one block, x and y restricted to its columns and rows
+  void multiplyBlock(const Block& b, double alpha, const ConstRef& x, MatRef y)
+  {
+    switch (b.kind)
+    {
+    case Block::Full:
+      y.noalias() += alpha * b.full * x;
+      break;
+    case Block::LowRank:
+      if (b.U.cols() > 0)
+        y.noalias() += alpha * b.U * (b.V.transpose() * x);
+      break;
+    case Block::Split:
+      for (int s = 0; s < 4; ++s)
+      {
+        const Block& son = *b.sons[s];
+        multiplyBlock(son, alpha, x.middleRows(son.colBegin - b.colBegin, son.cols),
+          y.middleRows(son.rowBegin - b.rowBegin, son.rows));
+      }
+      break;
+    }
+  }
+
+  /// y += alpha*A'*x over one block
+  void multiplyTransposedBlock(const Block& b, double alpha, const ConstRef& x, MatRef y)
+  {
+    switch (b.kind)
+    {
+    case Block::Full:
+      y.noalias() += alpha * b.full.transpose() * x;
+      break;
+    case Block::LowRank:
+      if (b.U.cols() > 0)
+        y.noalias() += alpha * b.V * (b.U.transpose() * x);
+      break;
+    case Block::Split:
+      for (int s = 0; s < 4; ++s)
+      {
+        const Block& son = *b.sons[s];
+        multiplyTransposedBlock(son, alpha, x.middleRows(son.rowBegin - b.rowBegin, son.rows),
+          y.middleRows(son.colBegin - b.colBegin, son.cols));
+      }
+      break;
+    }
+  }
+
+  void denseBlock(const Block& b, MatRef out)
+  {
+    switch (b.kind)
+    {
+    case Block::Full:
+      out = b.full;
+      break;
+    case Block::LowRank:
+      if (b.U.cols() > 0)
+        out.noalias() = b.U * b.V.transpose();
+      else
+        out.setZero();
+      break;
+    case Block::Split:
+      for (int s = 0; s < 4; ++s)
+      {
+        const Block& son = *b.sons[s];
+        denseBlock(son, out.block(son.rowBegin - b.rowBegin, son.colBegin - b.colBegin, son.rows, son.cols));
+      }
+      break;
+    }
+  }
+
+  /// b += alpha*U*V', truncating wherever the sum lands in a low rank block
+  void addLowRank(Block& b, double alpha, const ConstRef& U, const ConstRef& V, double eps)
+  {
+    if (U.cols() == 0)
+      return;
+    switch (b.kind)
+    {
+    case Block::Full:
+      b.full.noalias() += alpha * U * V.transpose();
+      break;
+    case Block::LowRank:
+    {
+      Mat u(b.rows, b.U.cols() + U.cols()), v(b.cols, b.V.cols() + V.cols());
+      u << b.U, alpha * U;
+      v << b.V, V;
+      truncate(u, v, eps);
+      b.U.swap(u);
+      b.V.swap(v);
+      break;
+    }
+    case Block::Split:
+      for (int s = 0; s < 4; ++s)
+      {
+        Block& son = *b.sons[s];
+        addLowRank(son, alpha, U.middleRows(son.rowBegin - b.rowBegin, son.rows),
+          V.middleRows(son.colBegin - b.colBegin, son.cols), eps);
+      }
+      break;
+    }
+  }
+
+  /// a*b as a low rank product U*V'. A full factor is exactly of low rank in
+  /// its smaller dimension; split factors are multiplied son by son and the
+  /// four products are joined into one and truncated. The other cases are left
+  /// to the truncation of the block the product is added to.
+  void productLowRank(const Block& a, const Block& b, double eps, Mat& U, Mat& V)
+  {
+    if (a.kind == Block::LowRank)
+    {
+      U = a.U;
+      V = Mat::Zero(b.cols, a.V.cols());
+      multiplyTransposedBlock(b, 1.0, a.V, V);
+    }
+    else if (b.kind == Block::LowRank)
+    {
+      U = Mat::Zero(a.rows, b.U.cols());
+      multiplyBlock(a, 1.0, b.U, U);
+      V = b.V;
+    }
+    else if (a.kind == Block::Full)
+    {
+      if (a.cols <= a.rows)
+      {
+        U = a.full;
+        V = Mat::Zero(b.cols, b.rows);
+        multiplyTransposedBlock(b, 1.0, Mat::Identity(b.rows, b.rows), V);
+      }
+      else
+      {
+        U = Mat::Identity(a.rows, a.rows);
+        V = Mat::Zero(b.cols, a.rows);
+        multiplyTransposedBlock(b, 1.0, a.full.transpose(), V);
+      }
+    }
+    else if (b.kind == Block::Full)
+    {
+      if (b.rows <= b.cols)
+      {
+        U = Mat::Zero(a.rows, a.cols);
+        multiplyBlock(a, 1.0, Mat::Identity(a.cols, a.cols), U);
+        V = b.full.transpose();
+      }
+      else
+      {
+        U = Mat::Zero(a.rows, b.cols);
+        multiplyBlock(a, 1.0, b.full, U);
+        V = Mat::Identity(b.cols, b.cols);
+      }
+    }
+    else
+    {
+      Mat us[4], vs[4];
+      Eigen::Index rank = 0;
+      for (int i = 0; i < 2; ++i)
+      {
+        for (int j = 0; j < 2; ++j)
+        {
+          Mat u0, v0, u1, v1;
+          productLowRank(a.son(i, 0), b.son(0, j), eps, u0, v0);
+          productLowRank(a.son(i, 1), b.son(1, j), eps, u1, v1);
+          Mat& u = us[2 * i + j];
+          Mat& v = vs[2 * i + j];
+          u.resize(u0.rows(), u0.cols() + u1.cols());
+          v.resize(v0.rows(), v0.cols() + v1.cols());
+          u << u0, u1;
+          v << v0, v1;
+          truncate(u, v, eps);
+          rank += u.cols();
+        }
+      }
+
+      U = Mat::Zero(a.rows, rank);
+      V = Mat::Zero(b.cols, rank);
+      Eigen::Index offset = 0;
+      for (int i = 0; i < 2; ++i)
+      {
+        for (int j = 0; j < 2; ++j)
+        {
+          const Mat& u = us[2 * i + j];
+          const Mat& v = vs[2 * i + j];
+          U.block(a.son(i, 0).rowBegin - a.rowBegin, offset, u.rows(), u.cols()) = u;
+          V.block(b.son(0, j).colBegin - b.colBegin, offset, v.rows(), v.cols()) = v;
+          offset += u.cols();
+        }
+      }
+      truncate(U, V, eps);
+    }
+  }
+
+  /// a*b in full, for a full block to add it to
+  Mat productFull(const Block& a, const Block& b)
+  {
+    Mat out = Mat::Zero(a.rows, b.cols);
+    if (a.kind == Block::Full)
+    {
+      Mat transposed = Mat::Zero(b.cols, a.rows);
+      multiplyTransposedBlock(b, 1.0, a.full.transpose(), transposed);
+      out = transposed.transpose();
+    }
+    else if (b.kind == Block::Full)
+    {
+      multiplyBlock(a, 1.0, b.full, out);
+    }
+    else if (a.kind == Block::LowRank)
+    {
+      Mat v = Mat::Zero(b.cols, a.V.cols());
+      multiplyTransposedBlock(b, 1.0, a.V, v);
+      out.noalias() = a.U * v.transpose();
+    }
+    else
+    {
+      Mat right(b.rows, b.cols);
+      denseBlock(b, right);
+      multiplyBlock(a, 1.0, right, out);
+    }
+    return out;
+  }
+
+  /// c += alpha*a*b
+  void addProduct(Block& c, double alpha, const Block& a, const Block& b, double eps)
+  {
+    if (c.kind == Block::Split && a.kind == Block::Split && b.kind == Block::Split)
+    {
+      inParallel(c.rows >= parallelBlockRows, 4, [&](int s)
+      {
+        const int i = s / 2, j = s % 2;
+        for (int k = 0; k < 2; ++k)
+          addProduct(c.son(i, j), alpha, a.son(i, k), b.son(k, j), eps);
+      });
+      return;
+    }
+
+    if (c.kind == Block::Full)
+    {
+      c.full += alpha * productFull(a, b);
+      return;
+    }
+
+    Mat U, V;
+    productLowRank(a, b, eps, U, V);
+    addLowRank(c, alpha, U, V, eps);
+  }
+
+  /// x = L^-1*x, L the unit lower factor of a factorized diagonal block
+  void forwardSubstitute(const Block& L, MatRef x)
+  {
+    if (L.kind == Block::Full)
+    {
+      Mat permuted = L.pivots * x;
+      x = permuted;
+      L.full.triangularView<Eigen::UnitLower>().solveInPlace(x);
+      return;
+    }
+    const Block& first = L.son(0, 0);
+    const Block& second = L.son(1, 1);
+    forwardSubstitute(first, x.topRows(first.rows));
+    multiplyBlock(L.son(1, 0), -1.0, x.topRows(first.rows), x.bottomRows(second.rows));
+    forwardSubstitute(second, x.bottomRows(second.rows));
+  }
+
+  /// x = U^-1*x, U the upper factor of a factorized diagonal block
+  void backSubstitute(const Block& U, MatRef x)
+  {
+    if (U.kind == Block::Full)
+    {
+      U.full.triangularView<Eigen::Upper>().solveInPlace(x);
+      return;
+    }
+    const Block& first = U.son(0, 0);
+    const Block& second = U.son(1, 1);
+    backSubstitute(second, x.bottomRows(second.rows));
+    multiplyBlock(U.son(0, 1), -1.0, x.bottomRows(second.rows), x.topRows(first.rows));
+    backSubstitute(first, x.topRows(first.rows));
+  }
+
+  /// x = U'^-1*x
+  void backSubstituteTransposed(const Block& U, MatRef x)
+  {
+    if (U.kind == Block::Full)
+    {
+      U.full.triangularView<Eigen::Upper>().transpose().solveInPlace(x);
+      return;
+    }
+    const Block& first = U.son(0, 0);
+    const Block& second = U.son(1, 1);
+    backSubstituteTransposed(first, x.topRows(first.rows));
+    multiplyTransposedBlock(U.son(0, 1), -1.0, x.topRows(first.rows), x.bottomRows(second.rows));
+    backSubstituteTransposed(second, x.bottomRows(second.rows));
+  }
+
+  void requireSplit(const Block& b)
+  {
+    if (b.kind != Block::Split)
+      THROW_INVALID_ARGUMENT("Hierarchical matrix block structures do not match");
+  }
+
+  /// b = L^-1*b
+  void solveLowerLeft(const Block& L, Block& b, double eps)
+  {
+    switch (b.kind)
+    {
+    case Block::Full:
+      forwardSubstitute(L, b.full);
+      break;
+    case Block::LowRank:
+      forwardSubstitute(L, b.U);
+      break;
+    case Block::Split:
+      requireSplit(L);
+      inParallel(b.rows >= parallelBlockRows, 2, [&](int j)
+      {
+        solveLowerLeft(L.son(0, 0), b.son(0, j), eps);
+        addProduct(b.son(1, j), -1.0, L.son(1, 0), b.son(0, j), eps);
+        solveLowerLeft(L.son(1, 1), b.son(1, j), eps);
+      });
+      break;
+    }
+  }
+
+  /// b = U^-1*b
+  void solveUpperLeft(const Block& U, Block& b, double eps)
+  {
+    switch (b.kind)
+    {
+    case Block::Full:
+      backSubstitute(U, b.full);
+      break;
+    case Block::LowRank:
+      backSubstitute(U, b.U);
+      break;
+    case Block::Split:
+      requireSplit(U);
+      inParallel(b.rows >= parallelBlockRows, 2, [&](int j)
+      {
+        solveUpperLeft(U.son(1, 1), b.son(1, j), eps);
+        addProduct(b.son(0, j), -1.0, U.son(0, 1), b.son(1, j), eps);
+        solveUpperLeft(U.son(0, 0), b.son(0, j), eps);
+      });
+      break;
+    }
+  }
+
+  /// b = b*U^-1
+  void solveUpperRight(const Block& U, Block& b, double eps)
+  {
+    switch (b.kind)
+    {
+    case Block::Full:
+    {
+      Mat transposed = b.full.transpose();
+      backSubstituteTransposed(U, transposed);
+      b.full = transposed.transpose();
+      break;
+    }
+    case Block::LowRank:
+      backSubstituteTransposed(U, b.V);
+      break;
+    case Block::Split:
+      requireSplit(U);
+      inParallel(b.rows >= parallelBlockRows, 2, [&](int i)
+      {
+        solveUpperRight(U.son(0, 0), b.son(i, 0), eps);
+        addProduct(b.son(i, 1), -1.0, b.son(i, 0), U.son(0, 1), eps);
+        solveUpperRight(U.son(1, 1), b.son(i, 1), eps);
+      });
+      break;
+    }
+  }
+
+  void factorizeBlock(Block& a, double eps)
+  {
+    switch (a.kind)
+    {
+    case Block::Full:
+    {
+      Eigen::PartialPivLU<Mat> lu(a.full);
+      a.full = lu.matrixLU();
+      a.pivots = lu.permutationP();
+      break;
+    }
+    case Block::LowRank:
+      THROW_INVALID_ARGUMENT("A low rank diagonal block cannot be factorized");
+    case Block::Split:
+      factorizeBlock(a.son(0, 0), eps);
+      inParallel(a.rows >= parallelBlockRows, 2, [&](int side)
+      {
+        if (side == 0)
+          solveLowerLeft(a.son(0, 0), a.son(0, 1), eps);
+        else
+          solveUpperRight(a.son(0, 0), a.son(1, 0), eps);
+      });
+      addProduct(a.son(1, 1), -1.0, a.son(1, 0), a.son(0, 1), eps);
+      factorizeBlock(a.son(1, 1), eps);
+      break;
+    }
+  }
+
+  void addToDiagonalBlock(Block& b, const Eigen::VectorXd& d)
+  {
+    switch (b.kind)
+    {
+    case Block::Full:
+      b.full.diagonal() += d.segment(b.rowBegin, b.rows);
+      break;
+    case Block::LowRank:
+      THROW_INVALID_ARGUMENT("A low rank block cannot hold the diagonal");
+    case Block::Split:
+      addToDiagonalBlock(b.son(0, 0), d);
+      addToDiagonalBlock(b.son(1, 1), d);
+      break;
+    }
+  }
+
+  void blockStatistics(const Block& b, size_t& entries, int& rank)
+  {
+    switch (b.kind)
+    {
+    case Block::Full:
+      entries += b.full.size();
+      break;
+    case Block::LowRank:
+      entries += b.U.size() + b.V.size();
+      rank = std::max(rank, static_cast<int>(b.U.cols()));
+      break;
+    case Block::Split:
+      for (int s = 0; s < 4; ++s)
+        blockStatistics(*b.sons[s], entries, rank);
+      break;
+    }
+  }
+
+  /// Runs task over chunks of the columns of x on the thread pool
+  void forColumns(Eigen::Index columns, const std::function<void(Eigen::Index, Eigen::Index)>& task)
+  {
+    Parallel::For(0, columns, [&task](size_t begin, size_t end)
+    {
+      task(static_cast<Eigen::Index>(begin), static_cast<Eigen::Index>(end - begin));
+    });
+  }
+}
+
+HierarchicalMatrix::HierarchicalMatrix(ClusterTreeHandle rows, ClusterTreeHandle cols,
+  const HierarchicalMatrixKernel& kernel, double tolerance, double admissibility) :
+  rows_(rows), cols_(cols), tolerance_(tolerance), factorized_(false)
+{
+  std::vector<Block*> leaves;
+  root_ = buildBlocks(*rows_, *cols_, 0, 0, admissibility, leaves);
+
+  // Large blocks first, so that the tail of the loop is made of small ones
+  std::stable_sort(leaves.begin(), leaves.end(), [](const Block* a, const Block* b)
+  {
+    return static_cast<size_t>(a->rows) * a->cols > static_cast<size_t>(b->rows) * b->cols;
+  });
+  Parallel::For(0, leaves.size(), [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i)
+      fillBlock(kernel, *leaves[i], tolerance_);
+  }, 1);
+}
+
+HierarchicalMatrix::~HierarchicalMatrix()
+{
+}
+
+void HierarchicalMatrix::multiply(double alpha, const Eigen::MatrixXd& x, Eigen::MatrixXd& y) const
+{
+  forColumns(x.cols(), [&](Eigen::Index first, Eigen::Index count)
+  {
+    multiplyBlock(*root_, alpha, x.middleCols(first, count), y.middleCols(first, count));
+  });
+}
+
+void HierarchicalMatrix::multiplyTransposed(double alpha, const Eigen::MatrixXd& x, Eigen::MatrixXd& y) const
+{
+  forColumns(x.cols(), [&](Eigen::Index first, Eigen::Index count)
+  {
+    multiplyTransposedBlock(*root_, alpha, x.middleCols(first, count), y.middleCols(first, count));
+  });
+}
+
+Eigen::MatrixXd HierarchicalMatrix::toDense() const
+{
+  Mat out(rows(), cols());
+  denseBlock(*root_, out);
+  return out;
+}
+
+void HierarchicalMatrix::addToDiagonal(const Eigen::VectorXd& d)
+{
+  if (rows_ != cols_)
+    THROW_INVALID_ARGUMENT("The diagonal needs the same row and column cluster tree");
+  addToDiagonalBlock(*root_, d);
+}
+
+void HierarchicalMatrix::addProduct(double alpha, const HierarchicalMatrix& B, const HierarchicalMatrix& C)
+{
+  if (B.rows_ != rows_ || C.cols_ != cols_ || B.cols_ != C.rows_)
+    THROW_INVALID_ARGUMENT("Hierarchical matrix product over different cluster trees");
+  ::addProduct(*root_, alpha, *B.root_, *C.root_, tolerance_);
+}
+
+void HierarchicalMatrix::factorize()
+{
+  if (rows_ != cols_)
+    THROW_INVALID_ARGUMENT("Only a matrix with the same row and column cluster tree can be factorized");
+  factorizeBlock(*root_, tolerance_);
+  factorized_ = true;
+}
+
+void HierarchicalMatrix::solve(Eigen::MatrixXd& x) const
+{
+  if (!factorized_)
+    THROW_INVALID_ARGUMENT("Hierarchical matrix has not been factorized");
+  forColumns(x.cols(), [&](Eigen::Index first, Eigen::Index count)
+  {
+    forwardSubstitute(*root_, x.middleCols(first, count));
+    backSubstitute(*root_, x.middleCols(first, count));
+  });
+}
+
+void HierarchicalMatrix::solveLeft(const HierarchicalMatrix& factors)
+{
+  if (!factors.factorized_)
+    THROW_INVALID_ARGUMENT("Hierarchical matrix has not been factorized");
+  if (factors.rows_ != rows_)
+    THROW_INVALID_ARGUMENT("Hierarchical matrix solve over different cluster trees");
+  solveLowerLeft(*factors.root_, *root_, tolerance_);
+  solveUpperLeft(*factors.root_, *root_, tolerance_);
+}
+
+size_t HierarchicalMatrix::memoryBytes() const
+{
+  size_t entries = 0;
+  int rank = 0;
+  blockStatistics(*root_, entries, rank);
+  return entries * sizeof(double);
+}
+
+size_t HierarchicalMatrix::denseBytes() const
+{
+  return static_cast<size_t>(rows()) * cols() * sizeof(double);
+}
+
+int HierarchicalMatrix::maxRank() const
+{
+  size_t entries = 0;
+  int rank = 0;
+  blockStatistics(*root_, entries, rank);
+  return rank;
+}
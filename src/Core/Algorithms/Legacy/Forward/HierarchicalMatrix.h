@@ -0,0 +1,157 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_ALGORITHMS_LEGACY_FORWARD_HIERARCHICALMATRIX_H
+#define CORE_ALGORITHMS_LEGACY_FORWARD_HIERARCHICALMATRIX_H
+
+#include <Core/GeometryPrimitives/Point.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <Eigen/Dense>
+#include <memory>
+#include <vector>
+#include <Core/Algorithms/Legacy/Forward/share.h>
+
+namespace SCIRun {
+  namespace Core {
+    namespace Algorithms {
+      namespace Forward {
+
+        /// Binary tree of bounding boxes over a point set. Every cluster owns a
+        /// contiguous range of the points in tree order; a cluster is split at
+        /// the median of its longest box axis until it holds at most leafSize
+        /// points. Cluster 0 is the root.
+        class SCISHARE ClusterTree : boost::noncopyable
+        {
+        public:
+          ClusterTree(const std::vector<Geometry::Point>& points, int leafSize);
+
+          struct Cluster
+          {
+            int begin, end;
+            double lo[3], hi[3];
+            int sons[2]; // -1 for a leaf
+
+            bool isLeaf() const { return sons[0] < 0; }
+            int size() const { return end - begin; }
+          };
+
+          const Cluster& cluster(int c) const { return clusters_[c]; }
+          int size() const { return static_cast<int>(order_.size()); }
+          /// Original index of the point at tree position p
+          int original(int p) const { return order_[p]; }
+          /// Tree position of the original point i
+          int position(int i) const { return position_[i]; }
+
+          static double diameter(const Cluster& c);
+          static double distance(const Cluster& a, const Cluster& b);
+
+        private:
+          int split(const std::vector<Geometry::Point>& points, int begin, int end, int leafSize);
+
+          std::vector<Cluster> clusters_;
+          std::vector<int> order_;
+          std::vector<int> position_;
+        };
+
+        typedef boost::shared_ptr<const ClusterTree> ClusterTreeHandle;
+
+        /// Source of the entries of a matrix to compress. Rows and columns are
+        /// addressed by their positions in the row and column cluster trees.
+        class SCISHARE HierarchicalMatrixKernel
+        {
+        public:
+          virtual ~HierarchicalMatrixKernel() {}
+          /// block(r - rowBegin, c - colBegin) = A(r, c) for the rows [rowBegin, rowEnd)
+          /// and columns [colBegin, colEnd). block arrives sized and may hold garbage.
+          /// Called concurrently from several threads.
+          virtual void fill(int rowBegin, int rowEnd, int colBegin, int colEnd, Eigen::MatrixXd& block) const = 0;
+        };
+
+        struct HierarchicalBlock;
+
+        /// Matrix stored as a tree of blocks over a row and a column cluster tree.
+        /// Blocks of well separated clusters, min(diam) <= admissibility * dist,
+        /// are kept as low rank products U*V' built by adaptive cross approximation;
+        /// the rest is split further or, at the leaves, stored in full. tolerance
+        /// bounds the relative Frobenius error of every low rank block, both when
+        /// it is built and after every truncated addition in the arithmetic below.
+        ///
+        /// All vectors are in tree order: entry p belongs to the row or column
+        /// original(p) of the corresponding tree.
+        class SCISHARE HierarchicalMatrix : boost::noncopyable
+        {
+        public:
+          HierarchicalMatrix(ClusterTreeHandle rows, ClusterTreeHandle cols,
+            const HierarchicalMatrixKernel& kernel, double tolerance, double admissibility = 2.0);
+          ~HierarchicalMatrix();
+
+          int rows() const { return rows_->size(); }
+          int cols() const { return cols_->size(); }
+          const ClusterTreeHandle& rowTree() const { return rows_; }
+          const ClusterTreeHandle& colTree() const { return cols_; }
+
+          /// y += alpha*A*x and y += alpha*A'*x, for any number of columns
+          void multiply(double alpha, const Eigen::MatrixXd& x, Eigen::MatrixXd& y) const;
+          void multiplyTransposed(double alpha, const Eigen::MatrixXd& x, Eigen::MatrixXd& y) const;
+
+          Eigen::MatrixXd toDense() const;
+          /// A(p, p) += d(p), for a matrix with the same row and column tree
+          void addToDiagonal(const Eigen::VectorXd& d);
+          /// A += alpha*B*C with truncation, B and C sharing the inner tree
+          void addProduct(double alpha, const HierarchicalMatrix& B, const HierarchicalMatrix& C);
+
+          /// LU factorization in place. Pivoting stays within the full diagonal
+          /// leaves. Afterwards the matrix holds the factors: solve() and
+          /// solveLeft() apply the inverse, multiply() no longer applies A.
+          void factorize();
+          bool isFactorized() const { return factorized_; }
+          /// x = A^-1 x for a factorized A
+          void solve(Eigen::MatrixXd& x) const;
+          /// A = F^-1 A, F factorized with this matrix's row tree
+          void solveLeft(const HierarchicalMatrix& factors);
+
+          /// Storage of the entries, in bytes, and the same for a dense matrix
+          size_t memoryBytes() const;
+          size_t denseBytes() const;
+          int maxRank() const;
+
+        private:
+          ClusterTreeHandle rows_;
+          ClusterTreeHandle cols_;
+          std::unique_ptr<HierarchicalBlock> root_;
+          double tolerance_;
+          bool factorized_;
+        };
+
+        typedef boost::shared_ptr<HierarchicalMatrix> HierarchicalMatrixHandle;
+
+      }}}}
+
+#endif
@@ -0,0 +1,245 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Legacy/Forward/BuildBEMatrixAlgo.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/GeometryPrimitives/Point.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms::Forward;
+
+namespace
+{
+  /// Icosahedron refined subdivisions times, projected onto a sphere, with
+  /// the triangles oriented outwards
+  FieldHandle Sphere(int subdivisions, double radius, const Point& center)
+  {
+    const double t = (1.0 + std::sqrt(5.0)) / 2.0;
+    std::vector<Vector> points = {
+      Vector(-1, t, 0), Vector(1, t, 0), Vector(-1, -t, 0), Vector(1, -t, 0),
+      Vector(0, -1, t), Vector(0, 1, t), Vector(0, -1, -t), Vector(0, 1, -t),
+      Vector(t, 0, -1), Vector(t, 0, 1), Vector(-t, 0, -1), Vector(-t, 0, 1) };
+    std::vector<int> faces = {
+      0,11,5, 0,5,1, 0,1,7, 0,7,10, 0,10,11, 1,5,9, 5,11,4, 11,10,2, 10,7,6, 7,1,8,
+      3,9,4, 3,4,2, 3,2,6, 3,6,8, 3,8,9, 4,9,5, 2,4,11, 6,2,10, 8,6,7, 9,8,1 };
+
+    for (int level = 0; level < subdivisions; ++level)
+    {
+      std::map<std::pair<int, int>, int> middles;
+      auto middle = [&](int a, int b)
+      {
+        auto key = std::make_pair(std::min(a, b), std::max(a, b));
+        auto found = middles.find(key);
+        if (found != middles.end())
+          return found->second;
+        points.push_back((points[a] + points[b]) * 0.5);
+        return middles[key] = static_cast<int>(points.size()) - 1;
+      };
+
+      std::vector<int> refined;
+      for (size_t f = 0; f < faces.size(); f += 3)
+      {
+        const int a = faces[f], b = faces[f + 1], c = faces[f + 2];
+        const int ab = middle(a, b), bc = middle(b, c), ca = middle(c, a);
+        refined.insert(refined.end(), { a,ab,ca, b,bc,ab, c,ca,bc, ab,bc,ca });
+      }
+      faces.swap(refined);
+    }
+
+    FieldInformation fi("TriSurfMesh", LINEARDATA_E, "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+    for (const Vector& p : points)
+      mesh->add_point(center + p * (radius / p.length()));
+    for (size_t f = 0; f < faces.size(); f += 3)
+    {
+      VMesh::Node::array_type nodes(3);
+      for (int i = 0; i < 3; ++i) nodes[i] = faces[f + i];
+      mesh->add_elem(nodes);
+    }
+    field->vfield()->resize_values();
+    return field;
+  }
+
+  FieldHandle Points(const std::vector<Point>& points)
+  {
+    FieldInformation fi("PointCloudMesh", LINEARDATA_E, "double");
+    FieldHandle field = CreateField(fi);
+    for (const Point& p : points)
+      field->vmesh()->add_point(p);
+    field->vfield()->resize_values();
+    return field;
+  }
+
+  /// A torso surface around an eccentric heart surface, as in the heart to
+  /// torso transfer problem
+  bemfield_vector TorsoAndHeart(int torsoSubdivisions, int heartSubdivisions)
+  {
+    bemfield torso(Sphere(torsoSubdivisions, 1.0, Point(0, 0, 0)));
+    torso.surface = true;
+    torso.insideconductivity = 1.0;
+    torso.outsideconductivity = 0.0;
+    torso.set_measurement_neumann();
+
+    bemfield heart(Sphere(heartSubdivisions, 0.4, Point(0.15, 0.05, 0)));
+    heart.surface = true;
+    heart.insideconductivity = 0.0;
+    heart.outsideconductivity = 1.0;
+    heart.set_source_dirichlet();
+
+    return { heart, torso };
+  }
+
+  double RelativeError(const DenseMatrix& a, const DenseMatrix& b)
+  {
+    return (a - b).norm() / b.norm();
+  }
+
+  DenseMatrix ComputeTransfer(const bemfield_vector& fields, bool compressed, double tolerance, BEMStatistics* statistics = nullptr)
+  {
+    auto algo = BEMAlgoImplFactory::create(fields);
+    EXPECT_TRUE(algo != nullptr);
+    BEMCompression compression;
+    compression.enabled = compressed;
+    compression.tolerance = tolerance;
+    algo->setCompression(compression);
+    auto T = boost::dynamic_pointer_cast<DenseMatrix>(algo->compute(fields));
+    EXPECT_TRUE(T != nullptr);
+    if (statistics)
+      *statistics = algo->statistics();
+    return *T;
+  }
+}
+
+TEST(BuildBEMatrixAlgoTests, AutoPRowsSumToOutsideConductivity)
+{
+  FieldHandle sphere = Sphere(2, 1.0, Point(0, 0, 0));
+  DenseMatrixHandle P;
+  BuildBEMatrixBase::make_auto_P(sphere->vmesh(), P, 1.0, 0.0, 1.0);
+
+  ASSERT_EQ(162, P->nrows());
+  for (int i = 0; i < P->nrows(); ++i)
+    EXPECT_NEAR(0.0, P->row(i).sum(), 1e-12);
+}
+
+TEST(BuildBEMatrixAlgoTests, TransferMatrixKeepsConstantPotential)
+{
+  auto fields = TorsoAndHeart(3, 2);
+  DenseMatrix T = ComputeTransfer(fields, false, 0.0);
+  ASSERT_EQ(642, T.nrows());
+  ASSERT_EQ(162, T.ncols());
+
+  // a heart at one potential drives no current, so the torso is at one
+  // potential too, of the same size up to the sign convention of T
+  Eigen::VectorXd u = T * Eigen::VectorXd::Ones(T.ncols());
+  EXPECT_LT(u.maxCoeff() - u.minCoeff(), 1e-3);
+  EXPECT_NEAR(1.0, std::abs(u.mean()), 1e-3);
+}
+
+TEST(BuildBEMatrixAlgoTests, CompressedTransferMatrixMatchesDense)
+{
+  auto fields = TorsoAndHeart(3, 2);
+  DenseMatrix dense = ComputeTransfer(fields, false, 0.0);
+
+  BEMStatistics statistics;
+  DenseMatrix compressed = ComputeTransfer(fields, true, 1e-7, &statistics);
+  ASSERT_EQ(dense.nrows(), compressed.nrows());
+  ASSERT_EQ(dense.ncols(), compressed.ncols());
+  EXPECT_LT(RelativeError(compressed, dense), 1e-4);
+
+  EXPECT_GT(statistics.largestRank, 0);
+  EXPECT_LT(statistics.storedBytes, statistics.denseBytes);
+}
+
+TEST(BuildBEMatrixAlgoTests, ToleranceControlsTransferAccuracy)
+{
+  auto fields = TorsoAndHeart(3, 2);
+  DenseMatrix dense = ComputeTransfer(fields, false, 0.0);
+
+  BEMStatistics coarse, fine;
+  const double coarseError = RelativeError(ComputeTransfer(fields, true, 1e-3, &coarse), dense);
+  const double fineError = RelativeError(ComputeTransfer(fields, true, 1e-7, &fine), dense);
+  EXPECT_LT(fineError, coarseError);
+  EXPECT_LT(coarse.storedBytes, fine.storedBytes);
+}
+
+TEST(BuildBEMatrixAlgoTests, CompressedPointsMatchDense)
+{
+  bemfield surface(Sphere(3, 1.0, Point(0, 0, 0)));
+  surface.surface = true;
+  surface.set_source_dirichlet();
+
+  std::vector<Point> electrodes;
+  for (int i = 0; i < 200; ++i)
+  {
+    const double z = 1.0 - 2.0 * (i + 0.5) / 200;
+    const double r = std::sqrt(1.0 - z * z);
+    electrodes.push_back(Point(1.3 * r * std::cos(2.4 * i), 1.3 * r * std::sin(2.4 * i), 1.3 * z));
+  }
+  bemfield points(Points(electrodes));
+  points.set_measurement_neumann();
+  bemfield_vector fields = { surface, points };
+
+  DenseMatrix dense = ComputeTransfer(fields, false, 0.0);
+  DenseMatrix compressed = ComputeTransfer(fields, true, 1e-7);
+  ASSERT_EQ(200, compressed.nrows());
+  ASSERT_EQ(642, compressed.ncols());
+  EXPECT_LT(RelativeError(compressed, dense), 1e-4);
+}
+
+/// Build time and storage of the compressed path against the dense one, for
+/// a torso of 10242 nodes around a heart of 2562 nodes
+TEST(BuildBEMatrixAlgoTests, DISABLED_CompressedAgainstDenseTiming)
+{
+  auto fields = TorsoAndHeart(5, 4);
+
+  BEMStatistics dense, compressed;
+  auto t0 = std::chrono::steady_clock::now();
+  DenseMatrix T = ComputeTransfer(fields, false, 0.0, &dense);
+  auto t1 = std::chrono::steady_clock::now();
+  DenseMatrix Tc = ComputeTransfer(fields, true, 1e-6, &compressed);
+  auto t2 = std::chrono::steady_clock::now();
+
+  std::chrono::duration<double> denseSeconds = t1 - t0, compressedSeconds = t2 - t1;
+  std::cout << "dense: " << denseSeconds.count() << " s, " << dense.storedBytes / 1e6 << " MB of P and G blocks" << std::endl;
+  std::cout << "compressed: " << compressedSeconds.count() << " s, " << compressed.storedBytes / 1e6 << " MB of "
+    << compressed.denseBytes / 1e6 << " MB, largest rank " << compressed.largestRank << std::endl;
+  std::cout << "relative difference: " << RelativeError(Tc, T) << std::endl;
+}
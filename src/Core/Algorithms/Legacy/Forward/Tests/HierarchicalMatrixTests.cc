@@ -0,0 +1,275 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Legacy/Forward/HierarchicalMatrix.h>
+
+#include <cmath>
+#include <random>
+
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms::Forward;
+
+namespace
+{
+  /// Points spread evenly over a sphere, along a spiral from pole to pole
+  std::vector<Point> SpherePoints(int n, double radius, const Point& center)
+  {
+    std::vector<Point> points;
+    const double golden = M_PI * (3.0 - std::sqrt(5.0));
+    for (int i = 0; i < n; ++i)
+    {
+      const double z = 1.0 - 2.0 * (i + 0.5) / n;
+      const double r = std::sqrt(1.0 - z * z);
+      points.push_back(Point(center.x() + radius * r * std::cos(golden * i),
+        center.y() + radius * r * std::sin(golden * i), center.z() + radius * z));
+    }
+    return points;
+  }
+
+  /// 1/(|x - y| + h), plus shift on the diagonal of a square matrix
+  class DistanceKernel : public HierarchicalMatrixKernel
+  {
+  public:
+    DistanceKernel(const std::vector<Point>& rows, const ClusterTree& rowTree,
+      const std::vector<Point>& cols, const ClusterTree& colTree, double shift) :
+      rows_(rows), rowTree_(rowTree), cols_(cols), colTree_(colTree), shift_(shift) {}
+
+    double entry(int i, int j) const
+    {
+      const double value = 1.0 / ((rows_[i] - cols_[j]).length() + 0.05);
+      return (&rows_ == &cols_ && i == j) ? value + shift_ : value;
+    }
+
+    void fill(int rowBegin, int rowEnd, int colBegin, int colEnd, Eigen::MatrixXd& block) const override
+    {
+      for (int r = rowBegin; r < rowEnd; ++r)
+        for (int c = colBegin; c < colEnd; ++c)
+          block(r - rowBegin, c - colBegin) = entry(rowTree_.original(r), colTree_.original(c));
+    }
+
+    /// The matrix in tree order
+    Eigen::MatrixXd dense() const
+    {
+      Eigen::MatrixXd out(rowTree_.size(), colTree_.size());
+      fill(0, rowTree_.size(), 0, colTree_.size(), out);
+      return out;
+    }
+
+  private:
+    const std::vector<Point>& rows_;
+    const ClusterTree& rowTree_;
+    const std::vector<Point>& cols_;
+    const ClusterTree& colTree_;
+    double shift_;
+  };
+
+  double RelativeError(const Eigen::MatrixXd& a, const Eigen::MatrixXd& b)
+  {
+    return (a - b).norm() / b.norm();
+  }
+
+  Eigen::MatrixXd Random(int rows, int cols)
+  {
+    std::mt19937 gen(7);
+    std::normal_distribution<double> normal;
+    Eigen::MatrixXd m(rows, cols);
+    for (int j = 0; j < cols; ++j)
+      for (int i = 0; i < rows; ++i)
+        m(i, j) = normal(gen);
+    return m;
+  }
+}
+
+TEST(ClusterTreeTests, ClustersPartitionThePoints)
+{
+  auto points = SpherePoints(1000, 1.0, Point(0, 0, 0));
+  ClusterTree tree(points, 24);
+
+  std::vector<int> seen(points.size(), 0);
+  for (int p = 0; p < tree.size(); ++p)
+  {
+    seen[tree.original(p)]++;
+    EXPECT_EQ(p, tree.position(tree.original(p)));
+  }
+  for (size_t i = 0; i < seen.size(); ++i)
+    EXPECT_EQ(1, seen[i]);
+
+  std::vector<int> stack(1, 0);
+  while (!stack.empty())
+  {
+    const ClusterTree::Cluster& c = tree.cluster(stack.back());
+    stack.pop_back();
+    for (int p = c.begin; p < c.end; ++p)
+      for (int k = 0; k < 3; ++k)
+      {
+        EXPECT_LE(c.lo[k], points[tree.original(p)][k]);
+        EXPECT_GE(c.hi[k], points[tree.original(p)][k]);
+      }
+    if (c.isLeaf())
+    {
+      EXPECT_LE(c.size(), 24);
+      continue;
+    }
+    EXPECT_EQ(c.begin, tree.cluster(c.sons[0]).begin);
+    EXPECT_EQ(tree.cluster(c.sons[0]).end, tree.cluster(c.sons[1]).begin);
+    EXPECT_EQ(c.end, tree.cluster(c.sons[1]).end);
+    stack.push_back(c.sons[0]);
+    stack.push_back(c.sons[1]);
+  }
+}
+
+TEST(HierarchicalMatrixTests, MultiplyMatchesDenseAndSavesMemory)
+{
+  auto points = SpherePoints(3000, 1.0, Point(0, 0, 0));
+  ClusterTreeHandle tree(new ClusterTree(points, 32));
+  DistanceKernel kernel(points, *tree, points, *tree, 0.0);
+
+  HierarchicalMatrix H(tree, tree, kernel, 1e-6);
+  Eigen::MatrixXd A = kernel.dense();
+  Eigen::MatrixXd x = Random(3000, 3);
+
+  Eigen::MatrixXd y = Eigen::MatrixXd::Zero(3000, 3);
+  H.multiply(1.0, x, y);
+  EXPECT_LT(RelativeError(y, A * x), 1e-5);
+
+  Eigen::MatrixXd yt = Eigen::MatrixXd::Zero(3000, 3);
+  H.multiplyTransposed(1.0, x, yt);
+  EXPECT_LT(RelativeError(yt, A.transpose() * x), 1e-5);
+
+  EXPECT_LT(RelativeError(H.toDense(), A), 1e-5);
+  EXPECT_LT(H.memoryBytes(), H.denseBytes() / 2);
+  EXPECT_GT(H.maxRank(), 0);
+}
+
+TEST(HierarchicalMatrixTests, ToleranceControlsAccuracy)
+{
+  auto points = SpherePoints(2000, 1.0, Point(0, 0, 0));
+  ClusterTreeHandle tree(new ClusterTree(points, 32));
+  DistanceKernel kernel(points, *tree, points, *tree, 0.0);
+  Eigen::MatrixXd A = kernel.dense();
+
+  double previousError = 1.0;
+  size_t previousBytes = 0;
+  for (double tolerance : { 1e-2, 1e-5, 1e-8 })
+  {
+    HierarchicalMatrix H(tree, tree, kernel, tolerance);
+    const double error = RelativeError(H.toDense(), A);
+    EXPECT_LT(error, 10 * tolerance);
+    EXPECT_LT(error, previousError);
+    EXPECT_GT(H.memoryBytes(), previousBytes);
+    previousError = error;
+    previousBytes = H.memoryBytes();
+  }
+}
+
+TEST(HierarchicalMatrixTests, RectangularBlocksBetweenSurfaces)
+{
+  auto inner = SpherePoints(1500, 1.0, Point(0, 0, 0));
+  auto outer = SpherePoints(3000, 2.5, Point(0.2, 0, 0));
+  ClusterTreeHandle innerTree(new ClusterTree(inner, 32));
+  ClusterTreeHandle outerTree(new ClusterTree(outer, 32));
+  DistanceKernel kernel(outer, *outerTree, inner, *innerTree, 0.0);
+
+  HierarchicalMatrix H(outerTree, innerTree, kernel, 1e-6);
+  EXPECT_EQ(3000, H.rows());
+  EXPECT_EQ(1500, H.cols());
+  EXPECT_LT(RelativeError(H.toDense(), kernel.dense()), 1e-5);
+  EXPECT_LT(H.memoryBytes(), H.denseBytes() / 2);
+}
+
+TEST(HierarchicalMatrixTests, FactorizationSolves)
+{
+  auto points = SpherePoints(2000, 1.0, Point(0, 0, 0));
+  ClusterTreeHandle tree(new ClusterTree(points, 32));
+  DistanceKernel kernel(points, *tree, points, *tree, 20.0);
+  Eigen::MatrixXd A = kernel.dense();
+
+  HierarchicalMatrix H(tree, tree, kernel, 1e-10);
+  H.factorize();
+  EXPECT_TRUE(H.isFactorized());
+
+  Eigen::MatrixXd b = Random(2000, 4);
+  Eigen::MatrixXd x = b;
+  H.solve(x);
+  EXPECT_LT((A * x - b).norm() / b.norm(), 1e-8);
+  EXPECT_LT(RelativeError(x, A.partialPivLu().solve(b)), 1e-8);
+}
+
+TEST(HierarchicalMatrixTests, ProductAndSolveLeftMatchDense)
+{
+  auto inner = SpherePoints(800, 1.0, Point(0, 0, 0));
+  auto outer = SpherePoints(1000, 2.0, Point(0, 0, 0));
+  ClusterTreeHandle innerTree(new ClusterTree(inner, 32));
+  ClusterTreeHandle outerTree(new ClusterTree(outer, 32));
+
+  DistanceKernel innerKernel(inner, *innerTree, inner, *innerTree, 20.0);
+  DistanceKernel outerKernel(outer, *outerTree, outer, *outerTree, 20.0);
+  DistanceKernel crossKernel(outer, *outerTree, inner, *innerTree, 0.0);
+  DistanceKernel backKernel(inner, *innerTree, outer, *outerTree, 0.0);
+  Eigen::MatrixXd G = innerKernel.dense();
+  Eigen::MatrixXd P = outerKernel.dense();
+  Eigen::MatrixXd C = crossKernel.dense();
+  Eigen::MatrixXd B = backKernel.dense();
+
+  // X = G^-1*B in compressed form, then P - C*X, as in a BEM Schur complement
+  HierarchicalMatrix Gh(innerTree, innerTree, innerKernel, 1e-9);
+  HierarchicalMatrix Ph(outerTree, outerTree, outerKernel, 1e-9);
+  HierarchicalMatrix Ch(outerTree, innerTree, crossKernel, 1e-9);
+  HierarchicalMatrix Xh(innerTree, outerTree, backKernel, 1e-9);
+
+  Gh.factorize();
+  Xh.solveLeft(Gh);
+  Eigen::MatrixXd X = G.partialPivLu().solve(B);
+  EXPECT_LT(RelativeError(Xh.toDense(), X), 1e-6);
+
+  Ph.addProduct(-1.0, Ch, Xh);
+  Eigen::MatrixXd S = P - C * X;
+  EXPECT_LT(RelativeError(Ph.toDense(), S), 1e-6);
+
+  Ph.factorize();
+  Eigen::MatrixXd rhs = Random(1000, 2);
+  Eigen::MatrixXd x = rhs;
+  Ph.solve(x);
+  EXPECT_LT(RelativeError(x, S.partialPivLu().solve(rhs)), 1e-6);
+}
+
+TEST(HierarchicalMatrixTests, AddToDiagonal)
+{
+  auto points = SpherePoints(600, 1.0, Point(0, 0, 0));
+  ClusterTreeHandle tree(new ClusterTree(points, 16));
+  DistanceKernel kernel(points, *tree, points, *tree, 0.0);
+
+  HierarchicalMatrix H(tree, tree, kernel, 1e-8);
+  Eigen::VectorXd d = Eigen::VectorXd::LinSpaced(600, 1.0, 2.0);
+  H.addToDiagonal(d);
+
+  Eigen::MatrixXd A = kernel.dense();
+  A.diagonal() += d;
+  EXPECT_LT(RelativeError(H.toDense(), A), 1e-7);
+}
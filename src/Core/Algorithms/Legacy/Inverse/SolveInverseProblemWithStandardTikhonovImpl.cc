@@ -47,6 +47,8 @@
 #include <Core/Logging/LoggerInterface.h>
 #include <Core/Utils/Exception.h>
 
+#include <limits>
+
 using namespace SCIRun;
 using namespace SCIRun::Core;
 using namespace SCIRun::Core::Datatypes;
@@ -79,9 +81,20 @@ using namespace SCIRun::Core::Algorithms::Inverse;
         DenseMatrix solution(sizeSolution,numTimeSamples);
         DenseMatrix G;
 
-        G = M1 + lambda * lambda * M2;
+        if (V.size() > 0)
+        {
+            // factored by prepareLambdaSweep: b = V * (D + lambda^2 * I)^-1 * V^T * y
+            DenseMatrix scaled = Vty;
+            for (size_t i = 0; i < scaled.nrows(); i++)
+                scaled.row(i) /= D[i] + lambda * lambda;
+            b = V * scaled;
+        }
+        else
+        {
+            G = M1 + lambda * lambda * M2;
 
-        b = G.lu().solve(y).eval();
+            b = G.lu().solve(y).eval();
+        }
 
         solution = M3 * b;
 
@@ -96,6 +109,143 @@ using namespace SCIRun::Core::Algorithms::Inverse;
 //////// fi compute inverse solution
 ////////////////////////
 
+/////// prepareLambdaSweep
+///////////////
+    void SolveInverseProblemWithStandardTikhonovImpl::prepareLambdaSweep()
+    {
+        //............................
+        //  M1 is symmetric positive semidefinite and M2 symmetric positive definite, so the
+        //  pair has a generalized eigendecomposition M1 * V = M2 * V * D with V^T * M2 * V = I.
+        //  Then G = M1 + lambda^2 * M2 = V^-T * (D + lambda^2 * I) * V^-1 for every lambda, and
+        //  one decomposition replaces a factorization of G per lambda.
+        //............................
+        if (M2.isIdentity())
+        {
+            Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen(M1);
+            if (eigen.info() != Eigen::Success)
+                return;
+            V = eigen.eigenvectors();
+            D = eigen.eigenvalues();
+            orthonormalV = true;
+        }
+        else
+        {
+            // The generalized solver does not report an M2 that is not positive definite,
+            // so check that first; otherwise keep solving with a factorization per lambda
+            Eigen::LLT<Eigen::MatrixXd> cholesky(M2);
+            if (cholesky.info() != Eigen::Success)
+                return;
+            Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> eigen(M1, M2);
+            if (eigen.info() != Eigen::Success)
+                return;
+            V = eigen.eigenvectors();
+            D = eigen.eigenvalues();
+            orthonormalV = false;
+        }
+        Vty = V.transpose() * y;
+    }
+//////// fi prepareLambdaSweep
+////////////////////////
+
+/////// compute Inverse solution with a lambda per column
+///////////////
+    DenseMatrix SolveInverseProblemWithStandardTikhonovImpl::computeInverseSolutionPerColumn( const std::vector<double>& lambdas ) const
+    {
+        // without the factorization of prepareLambdaSweep there is one LU per distinct lambda
+        if (V.size() == 0)
+            return TikhonovImpl::computeInverseSolutionPerColumn(lambdas);
+
+        //      b(:,t) = V * (D + lambda_t^2 * I)^-1 * V^T * y(:,t)
+        //      x = M3 * b
+        DenseMatrix scaled = Vty;
+        for (size_t t = 0; t < scaled.ncols(); t++)
+            for (size_t i = 0; i < scaled.nrows(); i++)
+                scaled(i, t) /= D[i] + lambdas[t] * lambdas[t];
+
+        DenseMatrix b = V * scaled;
+        return M3 * b;
+    }
+//////// fi compute Inverse solution with a lambda per column
+////////////////////////
+
+/////// influenceTrace
+///////////////
+    double SolveInverseProblemWithStandardTikhonovImpl::influenceTrace( double lambda ) const
+    {
+        //  A * x = M1 * G^-1 * y, and trace(M1 * G^-1) = sum_i D_i / (D_i + lambda^2)
+        if (V.size() == 0)
+            return -1.0;
+
+        double trace = 0.0;
+        for (size_t i = 0; i < D.nrows(); i++)
+            trace += D[i] / (D[i] + lambda * lambda);
+        return trace;
+    }
+//////// fi influenceTrace
+////////////////////////
+
+/////// computeColumnNorms
+///////////////
+    bool SolveInverseProblemWithStandardTikhonovImpl::computeColumnNorms( double lambda, DenseColumnMatrix& rho, DenseColumnMatrix& eta ) const
+    {
+        //............................
+        //  With M2 = I, V is orthonormal and V^T * M1 * V = D. With c = (D + lambda^2 * I)^-1 * V^T * y:
+        //      underdetermined (M1 = A * A^T, x = A^T * V * c):
+        //          ||x||^2 = sum_i D_i * c_i^2
+        //          ||A * x - y||^2 = sum_i ( lambda^2 * c_i )^2
+        //      overdetermined (M1 = A^T * A, y = A^T * measuredData, x = V * c):
+        //          ||x||^2 = sum_i c_i^2
+        //          ||A * x - measuredData||^2 = sum_i ( lambda^2 * c_i )^2 / D_i + part of the data outside the range of A
+        //............................
+        if (V.size() == 0 || !orthonormalV)
+            return false;
+
+        const double lambda_sq = lambda * lambda;
+        const double tolerance = std::numeric_limits<double>::epsilon() * D.nrows() * D.cwiseAbs().maxCoeff();
+        const int numTimeSamples = Vty.ncols();
+        rho = DenseColumnMatrix::Zero(numTimeSamples);
+        eta = DenseColumnMatrix::Zero(numTimeSamples);
+
+        for (size_t i = 0; i < Vty.nrows(); i++)
+        {
+            const double d = std::max(D[i], 0.0);
+            for (int t = 0; t < numTimeSamples; t++)
+            {
+                const double c = Vty(i, t) / (d + lambda_sq);
+                if (underdetermined)
+                {
+                    eta[t] += d * c * c;
+                    rho[t] += lambda_sq * c * lambda_sq * c;
+                }
+                else
+                {
+                    eta[t] += c * c;
+                    if (d > tolerance)
+                        rho[t] += lambda_sq * c * lambda_sq * c / d;
+                }
+            }
+        }
+
+        if (!underdetermined)
+        {
+            // measured data outside the range of A: ||measuredData||^2 - sum_i (V^T * y)_i^2 / D_i
+            for (int t = 0; t < numTimeSamples; t++)
+            {
+                double inRange = 0.0;
+                for (size_t i = 0; i < Vty.nrows(); i++)
+                    if (D[i] > tolerance)
+                        inRange += Vty(i, t) * Vty(i, t) / D[i];
+                rho[t] += std::max(measuredNormSq[t] - inRange, 0.0);
+            }
+        }
+
+        rho = rho.cwiseSqrt();
+        eta = eta.cwiseSqrt();
+        return true;
+    }
+//////// fi computeColumnNorms
+////////////////////////
+
 /////// precomputeInverseMatrices
 ///////////////
     void SolveInverseProblemWithStandardTikhonovImpl::preAlocateInverseMatrices(const SCIRun::Core::Datatypes::DenseMatrix& forwardMatrix_, const SCIRun::Core::Datatypes::DenseMatrix& measuredData_ , const SCIRun::Core::Datatypes::DenseMatrix& sourceWeighting_, const SCIRun::Core::Datatypes::DenseMatrix& sensorWeighting_, const int regularizationChoice_, const int regularizationSolutionSubcase_, const int regularizationResidualSubcase_)
@@ -223,6 +373,8 @@ using namespace SCIRun::Core::Algorithms::Inverse;
             // DEFINE measurement vector
             y = measuredData_;
 
+            underdetermined = true;
+
 
 
         }
@@ -308,6 +460,9 @@ using namespace SCIRun::Core::Algorithms::Inverse;
             // DEFINE measurement vector
             y = CtrCA.transpose() * measuredData_;
 
+            underdetermined = false;
+            measuredNormSq = measuredData_.colwise().squaredNorm().transpose();
+
         }
 
     }
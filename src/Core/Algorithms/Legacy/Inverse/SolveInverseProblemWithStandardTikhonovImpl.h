@@ -66,9 +66,24 @@ namespace SCIRun {
 			        SCIRun::Core::Datatypes::DenseMatrix M4;
 			        SCIRun::Core::Datatypes::DenseMatrix y;
 
+			        // set by prepareLambdaSweep: M1 * V = M2 * V * D with V^T * M2 * V = I, so that
+			        // G^-1 = V * (D + lambda^2 * I)^-1 * V^T. Vty = V^T * y
+			        SCIRun::Core::Datatypes::DenseMatrix V;
+			        SCIRun::Core::Datatypes::DenseColumnMatrix D;
+			        SCIRun::Core::Datatypes::DenseMatrix Vty;
+			        bool orthonormalV;
+
+			        bool underdetermined;
+			        // squared norms of the measured data columns, overdetermined case
+			        SCIRun::Core::Datatypes::DenseColumnMatrix measuredNormSq;
+
 							void preAlocateInverseMatrices(const SCIRun::Core::Datatypes::DenseMatrix& forwardMatrix_, const SCIRun::Core::Datatypes::DenseMatrix& measuredData_ , const SCIRun::Core::Datatypes::DenseMatrix& sourceWeighting_, const SCIRun::Core::Datatypes::DenseMatrix& sensorWeighting_, const int regularizationChoice_, const int regularizationSolutionSubcase_, const int regularizationResidualSubcase_ );
 
 			        virtual SCIRun::Core::Datatypes::DenseMatrix computeInverseSolution( double lambda, bool inverseCalculation) const;
+			        virtual void prepareLambdaSweep();
+			        virtual SCIRun::Core::Datatypes::DenseMatrix computeInverseSolutionPerColumn( const std::vector<double>& lambdas ) const;
+			        virtual double influenceTrace( double lambda ) const;
+			        virtual bool computeColumnNorms( double lambda, SCIRun::Core::Datatypes::DenseColumnMatrix& rho, SCIRun::Core::Datatypes::DenseColumnMatrix& eta ) const;
 			    };
 			}
 		}
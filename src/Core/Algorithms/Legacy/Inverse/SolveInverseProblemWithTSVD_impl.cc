@@ -87,6 +87,8 @@ void SolveInverseProblemWithTSVD_impl::preAlocateInverseMatrices(const SCIRun::C
 		// determine rank
 	        rank = svd_SingularValues.nrows();
 
+	        residualOutsideRange = computeResidualOutsideRange(Uy, rank, measuredData_);
+
 }
 
 void SolveInverseProblemWithTSVD_impl::preAlocateInverseMatrices(const SCIRun::Core::Datatypes::DenseMatrix& forwardMatrix_, const SCIRun::Core::Datatypes::DenseMatrix& measuredData_ , const SCIRun::Core::Datatypes::DenseMatrix& sourceWeighting_, const SCIRun::Core::Datatypes::DenseMatrix& sensorWeighting_)
@@ -105,43 +107,70 @@ void SolveInverseProblemWithTSVD_impl::preAlocateInverseMatrices(const SCIRun::C
 
 	    // Compute the projection of data y on the left singular vectors
 	        Uy = svd_MatrixU.transpose() * (measuredData_);
+
+	        residualOutsideRange = computeResidualOutsideRange(Uy, rank, measuredData_);
 }
 
 //////////////////////////////////////////////////////////////////////
 // THIS FUNCTION returns regularized solution by tikhonov method
 //////////////////////////////////////////////////////////////////////
-SCIRun::Core::Datatypes::DenseMatrix SolveInverseProblemWithTSVD_impl::computeInverseSolution( double lambda, bool inverseCalculation ) const
+SCIRun::Core::Datatypes::DenseMatrix SolveInverseProblemWithTSVD_impl::computeInverseSolution( double lambda, bool ) const
 {
+    return computeInverseSolutionPerColumn( std::vector<double>(Uy.ncols(), lambda) );
+}
 
-    // prealocate matrices
-        const int N = svd_MatrixV.cols();
-        const int M = svd_MatrixU.rows();
-        const int numTimeSamples = Uy.ncols();
-        DenseMatrix solution(DenseMatrix::Zero(N,numTimeSamples));
-        DenseMatrix tempInverse(DenseMatrix::Zero(N,M));
+//////////////////////////////////////////////////////////////////////
+// THIS FUNCTION returns the truncated solution with a truncation point per column (time sample)
+//      x(:,t) = V * diag( 1/s_i for i < lambda_t, 0 otherwise ) * U^T * y(:,t)
+// U^T * y is computed once in preAlocateInverseMatrices, so all columns take a single product with V
+//////////////////////////////////////////////////////////////////////
+SCIRun::Core::Datatypes::DenseMatrix SolveInverseProblemWithTSVD_impl::computeInverseSolutionPerColumn( const std::vector<double>& lambdas ) const
+{
+        DenseMatrix filtered = Uy.topRows(rank);
+        for (size_t tt = 0; tt < filtered.ncols(); tt++)
+        {
+            const int truncationPoint = Min( int(lambdas[tt]), rank, int(9999999999999) );
+            for (int rr = 0; rr < rank; rr++)
+                filtered(rr, tt) = (rr < truncationPoint) ? filtered(rr, tt) / svd_SingularValues[rr] : 0.0;
+        }
 
-		const int truncationPoint = Min( int(lambda), rank, int(9999999999999) );
+        return svd_MatrixV.leftCols(rank) * filtered;
+}
 
-    // Compute inverse SolveInverseProblemWithTSVD
-        for (int rr=0; rr < truncationPoint ; rr++)
-        {
-            // evaluate filter factor
-                double singVal = svd_SingularValues[rr];
-                auto filterFactor_i =  1 / ( singVal );
+//////////////////////////////////////////////////////////////////////
+// THIS FUNCTION returns the trace of the influence matrix U_k * U_k^T, for GCV
+//////////////////////////////////////////////////////////////////////
+double SolveInverseProblemWithTSVD_impl::influenceTrace( double lambda ) const
+{
+        return Min( int(lambda), rank, int(9999999999999) );
+}
 
-            // update solution
-                solution += filterFactor_i * svd_MatrixV.col(rr) * Uy.row(rr);
+//////////////////////////////////////////////////////////////////////
+// THIS FUNCTION returns the residual and solution norms of every column without forming the solution
+//      ||x(:,t)||^2 = sum_{i < k} ( (U^T y)_it / s_i )^2
+//      ||A x(:,t) - y(:,t)||^2 = sum_{i >= k} (U^T y)_it^2 + residual outside the range
+//////////////////////////////////////////////////////////////////////
+bool SolveInverseProblemWithTSVD_impl::computeColumnNorms( double lambda, DenseColumnMatrix& rho, DenseColumnMatrix& eta ) const
+{
+        const int numTimeSamples = Uy.ncols();
+        const int truncationPoint = Min( int(lambda), rank, int(9999999999999) );
+        rho = residualOutsideRange;
+        eta = DenseColumnMatrix::Zero(numTimeSamples);
 
-            // update inverse operator
-                if (inverseCalculation)
-                    tempInverse += filterFactor_i * ( svd_MatrixV.col(rr) *  svd_MatrixU.col(rr).transpose() );
+        for (int rr = 0; rr < rank; rr++)
+        {
+            for (int tt = 0; tt < numTimeSamples; tt++)
+            {
+                if (rr < truncationPoint)
+                    eta[tt] += Uy(rr, tt) * Uy(rr, tt) / ( svd_SingularValues[rr] * svd_SingularValues[rr] );
+                else
+                    rho[tt] += Uy(rr, tt) * Uy(rr, tt);
+            }
         }
 
-    // output solutions
-    //   if (inverseCalculation)
-    //       inverseMatrix_.reset( new SCIRun::Core::Datatypes::DenseMatrix(tempInverse) );
-
-        return solution;
+        rho = rho.cwiseSqrt();
+        eta = eta.cwiseSqrt();
+        return true;
 }
 
 //////////////////////////////////////////////////////////////////////
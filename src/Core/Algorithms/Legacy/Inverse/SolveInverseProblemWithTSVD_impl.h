@@ -77,12 +77,16 @@ namespace Inverse {
 				SCIRun::Core::Datatypes::DenseMatrix svd_MatrixV;
 
 		        SCIRun::Core::Datatypes::DenseMatrix Uy;
+		        SCIRun::Core::Datatypes::DenseColumnMatrix residualOutsideRange;
 
 				// Methods
 				void preAlocateInverseMatrices(const SCIRun::Core::Datatypes::DenseMatrix& forwardMatrix_, const SCIRun::Core::Datatypes::DenseMatrix& measuredData_ , const SCIRun::Core::Datatypes::DenseMatrix& sourceWeighting_, const SCIRun::Core::Datatypes::DenseMatrix& sensorWeighting_, const SCIRun::Core::Datatypes::DenseMatrix& matrixU_, const SCIRun::Core::Datatypes::DenseMatrix& singularValues_, const SCIRun::Core::Datatypes::DenseMatrix& matrixV_);
 				void preAlocateInverseMatrices(const SCIRun::Core::Datatypes::DenseMatrix& forwardMatrix_, const SCIRun::Core::Datatypes::DenseMatrix& measuredData_ , const SCIRun::Core::Datatypes::DenseMatrix& sourceWeighting_, const SCIRun::Core::Datatypes::DenseMatrix& sensorWeighting_);
 
 		        virtual SCIRun::Core::Datatypes::DenseMatrix computeInverseSolution( double truncationPoint, bool inverseCalculation) const;
+		        virtual SCIRun::Core::Datatypes::DenseMatrix computeInverseSolutionPerColumn( const std::vector<double>& lambdas ) const;
+		        virtual double influenceTrace( double lambda ) const;
+		        virtual bool computeColumnNorms( double lambda, SCIRun::Core::Datatypes::DenseColumnMatrix& rho, SCIRun::Core::Datatypes::DenseColumnMatrix& eta ) const;
 				std::vector<double> computeLambdaArray( double lambdaMin, double lambdaMax, int nLambda ) const;
 		        //      bool checkInputMatrixSizes(); // DEFINED IN PARENT, MIGHT WANT TO OVERRIDE SOME OTHER TIME
 
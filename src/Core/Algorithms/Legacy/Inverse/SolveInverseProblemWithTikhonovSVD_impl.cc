@@ -86,6 +86,8 @@ void SolveInverseProblemWithTikhonovSVD_impl::preAlocateInverseMatrices(const SC
 
 		// determine rank
 	        rank = svd_SingularValues.nrows();
+
+	        residualOutsideRange = computeResidualOutsideRange(Uy, rank, measuredData_);
 }
 
 void SolveInverseProblemWithTikhonovSVD_impl::preAlocateInverseMatrices(const SCIRun::Core::Datatypes::DenseMatrix& forwardMatrix_, const SCIRun::Core::Datatypes::DenseMatrix& measuredData_ , const SCIRun::Core::Datatypes::DenseMatrix& sourceWeighting_, const SCIRun::Core::Datatypes::DenseMatrix& sensorWeighting_)
@@ -104,39 +106,80 @@ void SolveInverseProblemWithTikhonovSVD_impl::preAlocateInverseMatrices(const SC
 
 	    // Compute the projection of data y on the left singular vectors
 	        Uy = svd_MatrixU.transpose() * (measuredData_);
+
+	        residualOutsideRange = computeResidualOutsideRange(Uy, rank, measuredData_);
 }
 
 //////////////////////////////////////////////////////////////////////
 // THIS FUNCTION returns regularized solution by tikhonov method
 //////////////////////////////////////////////////////////////////////
-SCIRun::Core::Datatypes::DenseMatrix SolveInverseProblemWithTikhonovSVD_impl::computeInverseSolution( double lambda, bool inverseCalculation ) const
+SCIRun::Core::Datatypes::DenseMatrix SolveInverseProblemWithTikhonovSVD_impl::computeInverseSolution( double lambda, bool ) const
 {
+    return computeInverseSolutionPerColumn( std::vector<double>(Uy.ncols(), lambda) );
+}
 
-    // prealocate matrices
-        const int N = svd_MatrixV.cols();
-        const int M = svd_MatrixU.rows();
-        const int numTimeSamples = Uy.ncols();
-        DenseMatrix solution(DenseMatrix::Zero(N,numTimeSamples));
-        DenseMatrix tempInverse(DenseMatrix::Zero(N,M));
-
-    // Compute inverse solution
-        for (int rr=0; rr<rank ; rr++)
+//////////////////////////////////////////////////////////////////////
+// THIS FUNCTION returns the regularized solution with a lambda per column (time sample)
+//      x(:,t) = V * diag( s_i / (s_i^2 + lambda_t^2) ) * U^T * y(:,t)
+// U^T * y is computed once in preAlocateInverseMatrices, so all columns take a single product with V
+//////////////////////////////////////////////////////////////////////
+SCIRun::Core::Datatypes::DenseMatrix SolveInverseProblemWithTikhonovSVD_impl::computeInverseSolutionPerColumn( const std::vector<double>& lambdas ) const
+{
+    // filtered projections of the data on the singular vectors
+        DenseMatrix filtered = Uy.topRows(rank);
+        for (size_t tt = 0; tt < filtered.ncols(); tt++)
         {
-            // evaluate filter factor
-                double singVal = svd_SingularValues[rr];
-                double filterFactor_i =  singVal / ( lambda * lambda + singVal * singVal );
+            const double lambda = lambdas[tt];
+            for (int rr = 0; rr < rank; rr++)
+            {
+                // evaluate filter factor
+                    double singVal = svd_SingularValues[rr];
+                    filtered(rr, tt) *= singVal / ( lambda * lambda + singVal * singVal );
+            }
+        }
 
-            // u[date solution
-                solution += filterFactor_i * svd_MatrixV.col(rr) * Uy.row(rr);
+        return svd_MatrixV.leftCols(rank) * filtered;
+}
 
-            // update inverse operator
-                if (inverseCalculation)
-                    tempInverse += filterFactor_i * ( svd_MatrixV.col(rr) *  svd_MatrixU.col(rr).transpose() );
+//////////////////////////////////////////////////////////////////////
+// THIS FUNCTION returns the trace of the influence matrix U * diag( s_i^2 / (s_i^2 + lambda^2) ) * U^T, for GCV
+//////////////////////////////////////////////////////////////////////
+double SolveInverseProblemWithTikhonovSVD_impl::influenceTrace( double lambda ) const
+{
+        double trace = 0.0;
+        for (int rr = 0; rr < rank; rr++)
+        {
+            double singVal = svd_SingularValues[rr];
+            trace += singVal * singVal / ( lambda * lambda + singVal * singVal );
         }
+        return trace;
+}
 
-    // output solutions
-    //   if (inverseCalculation)
-    //       inverseMatrix_.reset( new SCIRun::Core::Datatypes::DenseMatrix(tempInverse) );
+//////////////////////////////////////////////////////////////////////
+// THIS FUNCTION returns the residual and solution norms of every column without forming the solution
+//      ||x(:,t)||^2 = sum_i ( s_i / (s_i^2 + lambda^2) * (U^T y)_it )^2
+//      ||A x(:,t) - y(:,t)||^2 = sum_i ( lambda^2 / (s_i^2 + lambda^2) * (U^T y)_it )^2 + residual outside the range
+//////////////////////////////////////////////////////////////////////
+bool SolveInverseProblemWithTikhonovSVD_impl::computeColumnNorms( double lambda, DenseColumnMatrix& rho, DenseColumnMatrix& eta ) const
+{
+        const int numTimeSamples = Uy.ncols();
+        rho = residualOutsideRange;
+        eta = DenseColumnMatrix::Zero(numTimeSamples);
+
+        for (int rr = 0; rr < rank; rr++)
+        {
+            double singVal = svd_SingularValues[rr];
+            double denominator = lambda * lambda + singVal * singVal;
+            double filterFactor_i = singVal / denominator;
+            double residualFactor_i = lambda * lambda / denominator;
+            for (int tt = 0; tt < numTimeSamples; tt++)
+            {
+                eta[tt] += filterFactor_i * Uy(rr, tt) * filterFactor_i * Uy(rr, tt);
+                rho[tt] += residualFactor_i * Uy(rr, tt) * residualFactor_i * Uy(rr, tt);
+            }
+        }
 
-        return solution;
+        rho = rho.cwiseSqrt();
+        eta = eta.cwiseSqrt();
+        return true;
 }
@@ -0,0 +1,165 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Algorithms/Legacy/Inverse/TikhonovAlgoAbstractBase.h>
+#include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithStandardTikhonovImpl.h>
+#include <Core/Datatypes/DenseMatrix.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Inverse;
+
+namespace
+{
+  // Smooth forward matrix with decaying singular values, like a lead field
+  DenseMatrixHandle forwardMatrix(int rows, int cols)
+  {
+    DenseMatrixHandle A(new DenseMatrix(rows, cols));
+    for (int i = 0; i < rows; i++)
+      for (int j = 0; j < cols; j++)
+        (*A)(i, j) = 1.0 / (1.0 + std::abs(i * cols - j * rows) / static_cast<double>(rows)) + 1e-3 * std::sin(i + 3.0 * j);
+    return A;
+  }
+
+  AlgorithmInput problem(int rows, int cols, int samples)
+  {
+    auto A = forwardMatrix(rows, cols);
+    DenseMatrix x(cols, samples);
+    for (int j = 0; j < cols; j++)
+      for (int t = 0; t < samples; t++)
+        x(j, t) = std::sin(0.1 * j * (t + 1));
+    DenseMatrixHandle y(new DenseMatrix((*A) * x));
+    for (int i = 0; i < rows; i++)
+      for (int t = 0; t < samples; t++)
+        (*y)(i, t) += 1e-3 * std::cos(7.0 * i + t);
+
+    AlgorithmInput input;
+    input[TikhonovAlgoAbstractBase::ForwardMatrix] = A;
+    input[TikhonovAlgoAbstractBase::MeasuredPotentials] = y;
+    input[TikhonovAlgoAbstractBase::WeightingInSourceSpace] = boost::make_shared<DenseMatrix>(DenseMatrix::Identity(cols, cols));
+    input[TikhonovAlgoAbstractBase::WeightingInSensorSpace] = boost::make_shared<DenseMatrix>(DenseMatrix::Identity(rows, rows));
+    return input;
+  }
+
+  void useLcurve(TikhonovAlgoAbstractBase& algo, int nLambda)
+  {
+    algo.set(Parameters::TikhonovImplementation, std::string("standardTikhonov"));
+    algo.setOption(Parameters::RegularizationMethod, "lcurve");
+    algo.set(Parameters::LambdaMin, 1e-4);
+    algo.set(Parameters::LambdaMax, 10.0);
+    algo.set(Parameters::LambdaNum, nLambda);
+  }
+}
+
+class TikhonovLcurveTests : public ::testing::TestWithParam<std::pair<int, int>>
+{
+};
+
+// The L-curve of run() factors the problem once; solving with a factorization
+// per lambda has to give the same curve, corner and solution.
+TEST_P(TikhonovLcurveTests, FactorOnceMatchesSolvePerLambda)
+{
+  const int rows = GetParam().first, cols = GetParam().second;
+  auto input = problem(rows, cols, 3);
+  TikhonovAlgoAbstractBase algo;
+  useLcurve(algo, 40);
+  auto output = algo.run(input);
+
+  auto A = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::ForwardMatrix);
+  auto y = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::MeasuredPotentials);
+  auto R = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::WeightingInSourceSpace);
+  auto C = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::WeightingInSensorSpace);
+  SolveInverseProblemWithStandardTikhonovImpl perLambda(*A, *y, *R, *C,
+    TikhonovAlgoAbstractBase::automatic, TikhonovAlgoAbstractBase::solution_constrained,
+    TikhonovAlgoAbstractBase::residual_constrained);
+  DenseMatrixHandle expected;
+  int expectedIndex = -1;
+  const double expectedLambda = algo.computeLcurve(perLambda, input, expected, expectedIndex);
+
+  // A * x - y loses the residual norms that approach the rounding error of y,
+  // which the factorization does not
+  const double roundoff = 1e-13 * y->norm();
+  auto lcurve = output.get<DenseMatrix>(TikhonovAlgoAbstractBase::LambdaArray);
+  ASSERT_EQ(expected->nrows(), lcurve->nrows());
+  for (int j = 0; j < expected->nrows(); j++)
+  {
+    EXPECT_DOUBLE_EQ((*expected)(j, 0), (*lcurve)(j, 0));
+    EXPECT_NEAR((*expected)(j, 1), (*lcurve)(j, 1), 1e-8 * (*expected)(j, 1) + roundoff) << j;
+    EXPECT_NEAR((*expected)(j, 2), (*lcurve)(j, 2), 1e-8 * (*expected)(j, 2)) << j;
+  }
+  EXPECT_EQ(expectedIndex, (*output.get<DenseMatrix>(TikhonovAlgoAbstractBase::Lambda_Index))(0, 0));
+  EXPECT_EQ(expectedLambda, (*output.get<DenseMatrix>(TikhonovAlgoAbstractBase::RegularizationParameter))(0, 0));
+
+  const TikhonovImpl& impl = perLambda;
+  DenseMatrix solution = impl.computeInverseSolution(expectedLambda, true);
+  auto x = output.get<DenseMatrix>(TikhonovAlgoAbstractBase::InverseSolution);
+  ASSERT_EQ(solution.nrows(), x->nrows());
+  ASSERT_EQ(solution.ncols(), x->ncols());
+  EXPECT_NEAR(0.0, (solution - *x).norm(), 1e-8 * solution.norm());
+}
+
+INSTANTIATE_TEST_CASE_P(
+  TikhonovLcurveTestsParameterized,
+  TikhonovLcurveTests,
+  ::testing::Values(std::make_pair(30, 80), std::make_pair(80, 30))
+  );
+
+// 200 point L-curve on an underdetermined problem, factoring once against a
+// factorization per lambda.
+TEST(TikhonovLcurveBenchmark, DISABLED_FactorOnceVersusSolvePerLambda)
+{
+  auto input = problem(1000, 8000, 1);
+  TikhonovAlgoAbstractBase algo;
+  useLcurve(algo, 200);
+
+  auto A = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::ForwardMatrix);
+  auto y = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::MeasuredPotentials);
+  auto R = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::WeightingInSourceSpace);
+  auto C = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::WeightingInSensorSpace);
+
+  for (bool factorOnce : { true, false })
+  {
+    SolveInverseProblemWithStandardTikhonovImpl impl(*A, *y, *R, *C,
+      TikhonovAlgoAbstractBase::automatic, TikhonovAlgoAbstractBase::solution_constrained,
+      TikhonovAlgoAbstractBase::residual_constrained);
+    TikhonovImpl& base = impl;
+    auto start = std::chrono::steady_clock::now();
+    if (factorOnce) base.prepareLambdaSweep();
+    DenseMatrixHandle lcurve;
+    int index = -1;
+    algo.computeLcurve(impl, input, lcurve, index);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (factorOnce ? "factor once: " : "solve per lambda: ") << elapsed.count() << " s, corner " << index << std::endl;
+  }
+}
@@ -0,0 +1,201 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Algorithms/Legacy/Inverse/TikhonovAlgoAbstractBase.h>
+#include <Core/Datatypes/DenseMatrix.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Inverse;
+
+namespace
+{
+  // smoothing kernel: an ill-conditioned forward matrix like a lead field
+  DenseMatrixHandle forwardMatrix(int rows, int cols)
+  {
+    DenseMatrixHandle A(new DenseMatrix(rows, cols));
+    for (int i = 0; i < rows; i++)
+      for (int j = 0; j < cols; j++)
+      {
+        const double d = static_cast<double>(i) / rows - static_cast<double>(j) / cols;
+        (*A)(i, j) = std::exp(-d * d / 0.005) / cols;
+      }
+    return A;
+  }
+
+  // time series whose noise level grows with the time sample, so that the
+  // samples need different amounts of regularization
+  AlgorithmInput timeSeries(int rows, int cols, int samples)
+  {
+    auto A = forwardMatrix(rows, cols);
+    DenseMatrix x(cols, samples);
+    for (int j = 0; j < cols; j++)
+      for (int t = 0; t < samples; t++)
+        x(j, t) = std::sin(6.0 * j / cols + 0.3 * t);
+    DenseMatrixHandle y(new DenseMatrix((*A) * x));
+
+    std::mt19937 generator(7);
+    std::normal_distribution<double> noise;
+    for (int t = 0; t < samples; t++)
+    {
+      const double level = std::pow(10.0, -5.0 + 3.0 * t / samples) * y->col(t).norm();
+      for (int i = 0; i < rows; i++)
+        (*y)(i, t) += level * noise(generator);
+    }
+
+    AlgorithmInput input;
+    input[TikhonovAlgoAbstractBase::ForwardMatrix] = A;
+    input[TikhonovAlgoAbstractBase::MeasuredPotentials] = y;
+    input[TikhonovAlgoAbstractBase::WeightingInSourceSpace] = boost::make_shared<DenseMatrix>(DenseMatrix::Identity(cols, cols));
+    input[TikhonovAlgoAbstractBase::WeightingInSensorSpace] = boost::make_shared<DenseMatrix>(DenseMatrix::Identity(rows, rows));
+    return input;
+  }
+
+  AlgorithmInput column(const AlgorithmInput& input, int t)
+  {
+    AlgorithmInput single = input;
+    auto y = input.get<DenseMatrix>(TikhonovAlgoAbstractBase::MeasuredPotentials);
+    single[TikhonovAlgoAbstractBase::MeasuredPotentials] = boost::make_shared<DenseMatrix>(y->col(t));
+    return single;
+  }
+
+  void setMethod(TikhonovAlgoAbstractBase& algo, const std::string& impl, const std::string& method, bool perTimeSample)
+  {
+    algo.set(Parameters::TikhonovImplementation, impl);
+    algo.setOption(Parameters::RegularizationMethod, method);
+    if (impl == "TSVD")
+    {
+      algo.set(Parameters::LambdaMin, 1.0);
+      algo.set(Parameters::LambdaMax, 20.0);
+      algo.set(Parameters::LambdaNum, 20);
+    }
+    else
+    {
+      algo.set(Parameters::LambdaMin, 1e-6);
+      algo.set(Parameters::LambdaMax, 1e-1);
+      algo.set(Parameters::LambdaNum, 30);
+    }
+    algo.set(Parameters::LambdaPerTimeSample, perTimeSample);
+  }
+}
+
+class TikhonovTimeSeriesTests : public ::testing::TestWithParam<std::tuple<std::string, std::string>>
+{
+};
+
+// Selecting a lambda per time sample gives, for every sample, the lambda and the
+// solution of the same problem run on that sample alone.
+TEST_P(TikhonovTimeSeriesTests, PerTimeSampleMatchesSingleSampleRuns)
+{
+  const std::string impl = std::get<0>(GetParam());
+  const std::string method = std::get<1>(GetParam());
+  const int samples = 6;
+  auto input = timeSeries(25, 40, samples);
+
+  TikhonovAlgoAbstractBase algo;
+  setMethod(algo, impl, method, true);
+  auto output = algo.run(input);
+
+  auto lambdas = output.get<DenseMatrix>(TikhonovAlgoAbstractBase::RegularizationParameter);
+  auto indices = output.get<DenseMatrix>(TikhonovAlgoAbstractBase::Lambda_Index);
+  auto x = output.get<DenseMatrix>(TikhonovAlgoAbstractBase::InverseSolution);
+  ASSERT_EQ(samples, lambdas->nrows());
+  ASSERT_EQ(samples, indices->nrows());
+  ASSERT_EQ(samples, x->ncols());
+
+  TikhonovAlgoAbstractBase single;
+  setMethod(single, impl, method, false);
+  for (int t = 0; t < samples; t++)
+  {
+    auto one = single.run(column(input, t));
+    EXPECT_EQ((*one.get<DenseMatrix>(TikhonovAlgoAbstractBase::Lambda_Index))(0, 0), (*indices)(t, 0)) << t;
+    EXPECT_EQ((*one.get<DenseMatrix>(TikhonovAlgoAbstractBase::RegularizationParameter))(0, 0), (*lambdas)(t, 0)) << t;
+
+    auto xt = one.get<DenseMatrix>(TikhonovAlgoAbstractBase::InverseSolution);
+    DenseMatrix difference = xt->col(0) - x->col(t);
+    EXPECT_NEAR(0.0, difference.norm(), 1e-8 * xt->norm()) << t;
+  }
+
+  // the noise levels differ enough for the samples not to share one lambda
+  EXPECT_LT(lambdas->minCoeff(), lambdas->maxCoeff());
+}
+
+INSTANTIATE_TEST_CASE_P(
+  TikhonovTimeSeriesTestsParameterized,
+  TikhonovTimeSeriesTests,
+  ::testing::Combine(
+    ::testing::Values("standardTikhonov", "TikhonovSVD", "TSVD"),
+    ::testing::Values("lcurve", "gcv"))
+  );
+
+// With identity weightings the standard and the SVD implementations solve the
+// same problem, so they agree on the GCV function and its minimum.
+TEST(TikhonovTimeSeriesTest, GcvAgreesBetweenImplementations)
+{
+  auto input = timeSeries(25, 40, 4);
+
+  TikhonovAlgoAbstractBase standard, svd;
+  setMethod(standard, "standardTikhonov", "gcv", false);
+  setMethod(svd, "TikhonovSVD", "gcv", false);
+  auto a = standard.run(input);
+  auto b = svd.run(input);
+
+  EXPECT_EQ((*a.get<DenseMatrix>(TikhonovAlgoAbstractBase::Lambda_Index))(0, 0),
+    (*b.get<DenseMatrix>(TikhonovAlgoAbstractBase::Lambda_Index))(0, 0));
+  auto xa = a.get<DenseMatrix>(TikhonovAlgoAbstractBase::InverseSolution);
+  auto xb = b.get<DenseMatrix>(TikhonovAlgoAbstractBase::InverseSolution);
+  EXPECT_NEAR(0.0, (*xa - *xb).norm(), 1e-6 * xa->norm());
+}
+
+// 2000 time samples with a lambda selected for each one
+TEST(TikhonovTimeSeriesBenchmark, DISABLED_PerTimeSampleThroughput)
+{
+  const int samples = 2000;
+  auto input = timeSeries(200, 2000, samples);
+
+  for (auto impl : { "standardTikhonov", "TikhonovSVD" })
+  {
+    for (auto method : { "lcurve", "gcv" })
+    {
+      TikhonovAlgoAbstractBase algo;
+      setMethod(algo, impl, method, true);
+      algo.set(Parameters::LambdaNum, 100);
+      auto start = std::chrono::steady_clock::now();
+      algo.run(input);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << impl << " " << method << ": " << elapsed.count() << " s, " << samples / elapsed.count() << " time samples/s" << std::endl;
+    }
+  }
+}
@@ -31,6 +31,10 @@
 
 #include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <sstream>
 
 // Tikhonov specific headers
 #include <Core/Algorithms/Legacy/Inverse/TikhonovAlgoAbstractBase.h>
@@ -46,6 +50,7 @@
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
 #include <Core/Math/MiscMath.h>
+#include <Core/Thread/Parallel.h>
 #include <unsupported/Eigen/Splines>
 
 // SCIRun structural
@@ -89,6 +94,7 @@ ALGORITHM_PARAMETER_DEF( Inverse, LambdaMax);
 ALGORITHM_PARAMETER_DEF( Inverse, LambdaNum);
 ALGORITHM_PARAMETER_DEF( Inverse, LambdaResolution);
 ALGORITHM_PARAMETER_DEF( Inverse, LambdaSliderValue);
+ALGORITHM_PARAMETER_DEF( Inverse, LambdaPerTimeSample);
 //ALGORITHM_PARAMETER_DEF( Inverse, LambdaCorner);
 //ALGORITHM_PARAMETER_DEF( Inverse, LCurveText);
 ALGORITHM_PARAMETER_DEF( Inverse, regularizationSolutionSubcase);
@@ -97,7 +103,7 @@ ALGORITHM_PARAMETER_DEF( Inverse, regularizationResidualSubcase);
 TikhonovAlgoAbstractBase::TikhonovAlgoAbstractBase()
 {
 	addParameter(Parameters::TikhonovImplementation, std::string("NoMethodSelected") );
-	addOption(Parameters::RegularizationMethod, "lcurve", "single|slider|lcurve");
+	addOption(Parameters::RegularizationMethod, "lcurve", "single|slider|lcurve|gcv");
 	addParameter(Parameters::regularizationChoice, 0);
 	addParameter(Parameters::LambdaFromDirectEntry,1e-6);
 	addParameter(Parameters::LambdaMin,1e-6);
@@ -105,6 +111,7 @@ TikhonovAlgoAbstractBase::TikhonovAlgoAbstractBase()
 	addParameter(Parameters::LambdaNum,200);
 	addParameter(Parameters::LambdaResolution,1e-6);
 	addParameter(Parameters::LambdaSliderValue,0);
+	addParameter(Parameters::LambdaPerTimeSample,false);
 	addParameter(Parameters::regularizationSolutionSubcase,solution_constrained);
 	addParameter(Parameters::regularizationResidualSubcase,residual_constrained);
 }
@@ -179,6 +186,8 @@ bool TikhonovAlgoAbstractBase::checkInputMatrixSizes( const AlgorithmInput & inp
 
 AlgorithmOutput TikhonovAlgoAbstractBase::run(const AlgorithmInput & input) const
 {
+	auto start = std::chrono::steady_clock::now();
+
 	auto forwardMatrix = castMatrix::toDense(input.get<Matrix>(TikhonovAlgoAbstractBase::ForwardMatrix));
 	auto measuredData = castMatrix::toDense(input.get<Matrix>(TikhonovAlgoAbstractBase::MeasuredPotentials));
 	auto sourceWeighting = castMatrix::toDense(input.get<Matrix>(TikhonovAlgoAbstractBase::WeightingInSourceSpace));
@@ -234,6 +243,8 @@ AlgorithmOutput TikhonovAlgoAbstractBase::run(const AlgorithmInput & input) cons
 
   double lambda = 0;
   int lambda_index = 0;
+  std::vector<double> lambdas;
+  std::vector<int> lambda_indices;
   AlgorithmOutput output;
   DenseMatrixHandle lambdamatrix;
   //Get Regularization parameter(s) : Lambda
@@ -251,99 +262,169 @@ AlgorithmOutput TikhonovAlgoAbstractBase::run(const AlgorithmInput & input) cons
     }
     lambdamatrix.reset(new DenseMatrix(1,1,lambda));
   }
-  else if (RegularizationMethod_gotten == "lcurve")
+  else if ((RegularizationMethod_gotten == "lcurve") || (RegularizationMethod_gotten == "gcv"))
   {
-    lambda = computeLcurve( *algoImpl, input,  lambdamatrix, lambda_index);
+    algoImpl->prepareLambdaSweep();
+    if (get(Parameters::LambdaPerTimeSample).toBool())
+      lambdas = computeLambdaPerColumn( *algoImpl, input, RegularizationMethod_gotten, lambdamatrix, lambda_indices);
+    else if (RegularizationMethod_gotten == "lcurve")
+      lambda = computeLcurve( *algoImpl, input,  lambdamatrix, lambda_index);
+    else
+      lambda = computeGCV( *algoImpl, input,  lambdamatrix, lambda_index);
   }
 	else
 	{
 		THROW_ALGORITHM_PROCESSING_ERROR("Lambda selection was never set");
 	}
 
-  // compute final inverse solution
-	auto solution = algoImpl->computeInverseSolution(lambda, true);
-
-	// Set outputs
-
-	output[InverseSolution] = boost::make_shared<DenseMatrix>(solution);
-	output[RegularizationParameter] = boost::make_shared<DenseMatrix>(1, 1, lambda);
+	// compute final inverse solution
+	if (lambdas.empty())
+	{
+		auto solution = algoImpl->computeInverseSolution(lambda, true);
+		output[InverseSolution] = boost::make_shared<DenseMatrix>(solution);
+		output[RegularizationParameter] = boost::make_shared<DenseMatrix>(1, 1, lambda);
+		output[Lambda_Index] = boost::make_shared<DenseMatrix>(1, 1, lambda_index);
+	}
+	else
+	{
+		// time series: one lambda and one lambda index per time sample
+		auto solution = algoImpl->computeInverseSolutionPerColumn(lambdas);
+		auto lambdaColumn = boost::make_shared<DenseMatrix>(lambdas.size(), 1);
+		auto indexColumn = boost::make_shared<DenseMatrix>(lambdas.size(), 1);
+		for (size_t t = 0; t < lambdas.size(); t++)
+		{
+			(*lambdaColumn)(t, 0) = lambdas[t];
+			(*indexColumn)(t, 0) = lambda_indices[t];
+		}
+		output[InverseSolution] = boost::make_shared<DenseMatrix>(solution);
+		output[RegularizationParameter] = lambdaColumn;
+		output[Lambda_Index] = indexColumn;
+	}
   output[LambdaArray] = lambdamatrix;
-  output[Lambda_Index]= boost::make_shared<DenseMatrix>(1, 1, lambda_index);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  const int numTimeSamples = measuredData->ncols();
+  std::ostringstream ostr;
+  ostr << "Solved " << numTimeSamples << " time samples in " << elapsed.count() << " s (" << numTimeSamples / elapsed.count() << " time samples/s)";
+  remark(ostr.str());
 
 	return output;
 }
 
-double TikhonovAlgoAbstractBase::computeLcurve( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input , DenseMatrixHandle& lambdamatrix, int& lambda_index) const
+///// Lambda sweep shared by the automatic lambda selections: residual and solution norms of every data column
+///// for every lambda, and the lambda array with the norms over all columns (Frobenius norms) as lambdamatrix
+std::vector<double> TikhonovAlgoAbstractBase::lambdaSweep( const TikhonovImpl& algoImpl, const AlgorithmInput & input, DenseMatrix& rho, DenseMatrix& eta, DenseMatrixHandle& lambdamatrix ) const
 {
-	// get inputs
-	auto forwardMatrix = input.get<Matrix>(TikhonovAlgoAbstractBase::ForwardMatrix);
-	auto measuredData = input.get<Matrix>(TikhonovAlgoAbstractBase::MeasuredPotentials);
-	auto sourceWeighting = input.get<Matrix>(TikhonovAlgoAbstractBase::WeightingInSourceSpace);
-	auto sensorWeighting = input.get<Matrix>(TikhonovAlgoAbstractBase::WeightingInSensorSpace);
   // define the step size of the lambda vector to be computed  (distance between min and max divided by number of desired lambdas in log scale)
   const int nLambda = get(Parameters::LambdaNum).toInt();
 	const double lambdaMin = get(Parameters::LambdaMin).toDouble();
 	const double lambdaMax = get(Parameters::LambdaMax).toDouble();
-	double lambda = 0;
-
-	// prealocate vector of lambdas and eta and rho
-  std::vector<double> rho(nLambda, 0.0);
-  std::vector<double> eta(nLambda, 0.0);
-
-  lambdamatrix.reset(new DenseMatrix(nLambda,3,0.0));
 
   auto lambdaArray = algoImpl.computeLambdaArray( lambdaMin, lambdaMax, nLambda );
 
-  DenseMatrix CAx, Rx;
-  DenseMatrix solution;
-
   lambdaArray[0] = lambdaMin;
 
-  // for all lambdas
+  computeColumnNorms( algoImpl, input, lambdaArray, rho, eta );
+
+  lambdamatrix.reset(new DenseMatrix(nLambda,3,0.0));
   for (int j = 0; j < nLambda; j++)
   {
-    solution = algoImpl.computeInverseSolution( lambdaArray[j], false);
     lambdamatrix->put(j,0,lambdaArray[j]);
+    lambdamatrix->put(j,1,rho.row(j).norm());
+    lambdamatrix->put(j,2,eta.row(j).norm());
+  }
 
-    // if using source regularization matrix, apply it to compute Rx (for the eta computations)
-    if (sourceWeighting)
+  return lambdaArray;
+}
+
+void TikhonovAlgoAbstractBase::computeColumnNorms( const TikhonovImpl& algoImpl, const AlgorithmInput & input, const std::vector<double>& lambdaArray, DenseMatrix& rho, DenseMatrix& eta ) const
+{
+	// get inputs
+	auto forward = castMatrix::toDense(input.get<Matrix>(TikhonovAlgoAbstractBase::ForwardMatrix));
+	auto measured = castMatrix::toDense(input.get<Matrix>(TikhonovAlgoAbstractBase::MeasuredPotentials));
+	auto sourceWeighting = input.get<Matrix>(TikhonovAlgoAbstractBase::WeightingInSourceSpace);
+	auto sensorWeighting = input.get<Matrix>(TikhonovAlgoAbstractBase::WeightingInSensorSpace);
+  auto sourceDense = sourceWeighting ? castMatrix::toDense(sourceWeighting) : DenseMatrixHandle();
+  auto sensorDense = sensorWeighting ? castMatrix::toDense(sensorWeighting) : DenseMatrixHandle();
+
+  const int nLambda = static_cast<int>(lambdaArray.size());
+  rho.resize(nLambda, measured->ncols());
+  eta.resize(nLambda, measured->ncols());
+  std::atomic<bool> sizeMismatch(false);
+
+  // without weightings the implementation may get the norms from its factorization
+  const bool unweighted = (!sourceDense || sourceDense->isIdentity()) && (!sensorDense || sensorDense->isIdentity());
+
+  // lambdas are independent, so they are evaluated in parallel. Each one solves for all
+  // columns at once and takes the norm of every column.
+  auto evaluate = [&](size_t begin, size_t end)
+  {
+    DenseMatrix CAx, Rx;
+    DenseMatrix solution;
+    DenseColumnMatrix columnRho, columnEta;
+    for (size_t j = begin; j < end; j++)
     {
-      if (solution.nrows() == sourceWeighting->ncols()) // check that regularization matrix and solution match sizes
+      if (unweighted && algoImpl.computeColumnNorms( lambdaArray[j], columnRho, columnEta ))
       {
-        auto sw = castMatrix::toDense(sourceWeighting);
-        Rx = (*sw) * solution;
+        rho.row(j) = columnRho.transpose();
+        eta.row(j) = columnEta.transpose();
+        continue;
       }
-      else
+
+      solution = algoImpl.computeInverseSolution( lambdaArray[j], false);
+
+      // if using source regularization matrix, apply it to compute Rx (for the eta computations)
+      if (sourceDense)
       {
-        BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage(" Solution weighting matrix unexpectedly does not fit to compute the weighted solution norm. "));
+        if (solution.nrows() == sourceDense->ncols()) // check that regularization matrix and solution match sizes
+        {
+          Rx = (*sourceDense) * solution;
+        }
+        else
+        {
+          sizeMismatch = true;
+          return;
+        }
       }
-    }
-    else
-      Rx = solution;
+      else
+        Rx = solution;
 
-    auto forward = castMatrix::toDense(forwardMatrix);
-    auto Ax = (*forward) * solution;
-    auto measured = castMatrix::toDense(measuredData);
-    auto residualSolution = Ax - (*measured);
+      DenseMatrix residualSolution = (*forward) * solution - (*measured);
 
-    // if using source regularization matrix, apply it to compute Rx (for the eta computations)
-    if (sensorWeighting)
-    {
-      auto sw = castMatrix::toDense(sensorWeighting);
-      CAx = (*sw) * residualSolution;
+      // if using source regularization matrix, apply it to compute Rx (for the eta computations)
+      if (sensorDense)
+        CAx = (*sensorDense) * residualSolution;
+      else
+        CAx = residualSolution;
+
+      // compute rho and eta of every column
+      rho.row(j) = CAx.colwise().norm();
+      eta.row(j) = Rx.colwise().norm();
     }
-    else
-      CAx = residualSolution;
+  };
+  Thread::Parallel::For(0, nLambda, evaluate, 1);
+
+  if (sizeMismatch)
+    BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage(" Solution weighting matrix unexpectedly does not fit to compute the weighted solution norm. "));
+}
 
-    // compute rho and eta. Using Frobenious norm when using matrices
-    rho[j] = CAx.norm();
-    eta[j] = Rx.norm();
-    lambdamatrix->put(j,1,rho[j]);
-    lambdamatrix->put(j,2,eta[j]);
+double TikhonovAlgoAbstractBase::computeLcurve( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input , DenseMatrixHandle& lambdamatrix, int& lambda_index) const
+{
+  DenseMatrix columnRho, columnEta;
+  auto lambdaArray = lambdaSweep( algoImpl, input, columnRho, columnEta, lambdamatrix );
+  const int nLambda = static_cast<int>(lambdaArray.size());
+
+  // using Frobenious norm when using matrices
+  std::vector<double> rho(nLambda, 0.0);
+  std::vector<double> eta(nLambda, 0.0);
+  for (int j = 0; j < nLambda; j++)
+  {
+    rho[j] = lambdamatrix->get(j,1);
+    eta[j] = lambdamatrix->get(j,2);
   }
 
   // Find corner in L-curve
-  lambda = FindCorner( rho, eta, lambdaArray, nLambda,lambda_index);
+  double lambda = FindCorner( rho, eta, lambdaArray, nLambda,lambda_index);
 
 	LOG_DEBUG("Lambda: {}", lambda);
   // TODO: update GUI
@@ -351,6 +432,101 @@ double TikhonovAlgoAbstractBase::computeLcurve( const SCIRun::Core::Algorithms::
   return lambda;
 }
 
+namespace
+{
+  // index of the minimum of the GCV function rho^2 / (M - trace)^2, M the number of measurements
+  int gcvMinimum( const std::vector<double>& rho, const std::vector<double>& traces, const double M )
+  {
+    int index = 0;
+    double smallest = std::numeric_limits<double>::infinity();
+    for (size_t j = 0; j < rho.size(); j++)
+    {
+      const double dof = M - traces[j];
+      const double gcv = rho[j] * rho[j] / (dof * dof);
+      if (gcv < smallest)
+      {
+        smallest = gcv;
+        index = static_cast<int>(j);
+      }
+    }
+    return index;
+  }
+
+  std::vector<double> influenceTraces( const TikhonovImpl& algoImpl, const std::vector<double>& lambdaArray )
+  {
+    std::vector<double> traces(lambdaArray.size());
+    for (size_t j = 0; j < lambdaArray.size(); j++)
+    {
+      traces[j] = algoImpl.influenceTrace(lambdaArray[j]);
+      if (traces[j] < 0)
+        BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage(" GCV is not available for this problem: the influence matrix of the regularized inverse could not be computed. "));
+    }
+    return traces;
+  }
+}
+
+///// Generalized cross validation: lambda minimizing ||A x - y||^2 / (M - trace(influence matrix))^2
+double TikhonovAlgoAbstractBase::computeGCV( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input , DenseMatrixHandle& lambdamatrix, int& lambda_index) const
+{
+  DenseMatrix columnRho, columnEta;
+  auto lambdaArray = lambdaSweep( algoImpl, input, columnRho, columnEta, lambdamatrix );
+  const int nLambda = static_cast<int>(lambdaArray.size());
+  auto traces = influenceTraces( algoImpl, lambdaArray );
+  const double M = input.get<Matrix>(TikhonovAlgoAbstractBase::ForwardMatrix)->nrows();
+
+  std::vector<double> rho(nLambda, 0.0);
+  for (int j = 0; j < nLambda; j++)
+    rho[j] = lambdamatrix->get(j,1);
+
+  lambda_index = gcvMinimum( rho, traces, M );
+  double lambda = lambdaArray[lambda_index];
+
+	LOG_DEBUG("Lambda: {}", lambda);
+
+  return lambda;
+}
+
+std::vector<double> TikhonovAlgoAbstractBase::computeLambdaPerColumn( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input, const std::string& method, DenseMatrixHandle& lambdamatrix, std::vector<int>& lambda_index ) const
+{
+  // one sweep gives the norms of all the columns for all lambdas
+  DenseMatrix columnRho, columnEta;
+  auto lambdaArray = lambdaSweep( algoImpl, input, columnRho, columnEta, lambdamatrix );
+  const int nLambda = static_cast<int>(lambdaArray.size());
+  const size_t numTimeSamples = columnRho.ncols();
+
+  std::vector<double> traces;
+  if (method == "gcv")
+    traces = influenceTraces( algoImpl, lambdaArray );
+  const double M = input.get<Matrix>(TikhonovAlgoAbstractBase::ForwardMatrix)->nrows();
+
+  // the columns choose their lambda independently
+  std::vector<double> lambdas(numTimeSamples, 0.0);
+  lambda_index.assign(numTimeSamples, 0);
+  auto select = [&](size_t begin, size_t end)
+  {
+    std::vector<double> rho(nLambda), eta(nLambda);
+    for (size_t t = begin; t < end; t++)
+    {
+      for (int j = 0; j < nLambda; j++)
+      {
+        rho[j] = columnRho(j,t);
+        eta[j] = columnEta(j,t);
+      }
+
+      if (method == "gcv")
+      {
+        lambda_index[t] = gcvMinimum( rho, traces, M );
+        lambdas[t] = lambdaArray[lambda_index[t]];
+      }
+      else
+        lambdas[t] = FindCorner( rho, eta, lambdaArray, nLambda, lambda_index[t] );
+    }
+  };
+  Thread::Parallel::For(0, numTimeSamples, select);
+
+  return lambdas;
+}
+
 ///// Find Corner, find the maximal curvature which corresponds to the L-curve corner
 double TikhonovAlgoAbstractBase::FindCorner( const std::vector<double>& rho, const std::vector<double>& eta, const std::vector<double>& lambdaArray, const int nLambda, int& lambda_index )
 {
@@ -53,6 +53,7 @@ namespace Inverse {
 	ALGORITHM_PARAMETER_DECL(LambdaNum);
 	ALGORITHM_PARAMETER_DECL(LambdaResolution);
 	ALGORITHM_PARAMETER_DECL(LambdaSliderValue);
+	ALGORITHM_PARAMETER_DECL(LambdaPerTimeSample);
 	//ALGORITHM_PARAMETER_DECL(LambdaCorner);
 	//ALGORITHM_PARAMETER_DECL(LCurveText);
 
@@ -97,10 +98,18 @@ namespace Inverse {
 
 		static double FindCorner( const std::vector<double>& rho, const std::vector<double>& eta, const std::vector<double>& lambdaArray, const int nLambda,int& lambda_index );
     double computeLcurve( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input,  SCIRun::Core::Datatypes::DenseMatrixHandle& lambdamatrix, int& lambda_index ) const;
+    double computeGCV( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input,  SCIRun::Core::Datatypes::DenseMatrixHandle& lambdamatrix, int& lambda_index ) const;
+
+    // time series: selects a lambda for every column of the measured data with the L-curve or GCV
+    std::vector<double> computeLambdaPerColumn( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input, const std::string& method, SCIRun::Core::Datatypes::DenseMatrixHandle& lambdamatrix, std::vector<int>& lambda_index ) const;
+
+    // residual norm (rho) and solution norm (eta) of every data column for every lambda in lambdaArray
+    void computeColumnNorms( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input, const std::vector<double>& lambdaArray, SCIRun::Core::Datatypes::DenseMatrix& rho, SCIRun::Core::Datatypes::DenseMatrix& eta ) const;
 
 		bool checkInputMatrixSizes( const AlgorithmInput & input ) const;
 
 	private:
+		std::vector<double> lambdaSweep( const SCIRun::Core::Algorithms::Inverse::TikhonovImpl& algoImpl, const AlgorithmInput & input, SCIRun::Core::Datatypes::DenseMatrix& rho, SCIRun::Core::Datatypes::DenseMatrix& eta, SCIRun::Core::Datatypes::DenseMatrixHandle& lambdamatrix ) const;
 		static SCIRun::Core::Datatypes::DenseColumnMatrix InterpolateCurvatureWithSplines( SCIRun::Core::Datatypes::DenseMatrix& samplePoints);
 	// 	SCIRun::Core::Datatypes::DenseMatrix  createBspline(int numKnots, int basisSize);
 	};
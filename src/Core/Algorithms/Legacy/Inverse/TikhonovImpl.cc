@@ -30,6 +30,7 @@
 //    Date       : September 06th, 2017 (last update)
 
 #include <Core/Algorithms/Legacy/Inverse/TikhonovImpl.h>
+#include <algorithm>
 
 
 	// default lambda step. Can ve overriden if necessary (see TSVD as reference)
@@ -46,3 +47,39 @@
 
 		return lambdaArray;
 	}
+
+	// default solution with a lambda per column: one solve for each distinct lambda, keeping the columns that use it
+	SCIRun::Core::Datatypes::DenseMatrix SCIRun::Core::Algorithms::Inverse::TikhonovImpl::computeInverseSolutionPerColumn( const std::vector<double>& lambdas ) const
+	{
+		std::vector<double> distinct(lambdas);
+		std::sort(distinct.begin(), distinct.end());
+		distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+		SCIRun::Core::Datatypes::DenseMatrix solution;
+		for (size_t k = 0; k < distinct.size(); k++)
+		{
+			auto full = computeInverseSolution(distinct[k], false);
+			if (solution.size() == 0)
+				solution.resize(full.rows(), lambdas.size());
+
+			for (size_t t = 0; t < lambdas.size(); t++)
+			{
+				if (lambdas[t] == distinct[k])
+					solution.col(t) = full.col(t);
+			}
+		}
+
+		return solution;
+	}
+
+	// residual outside the range of the SVD, shared by the TikhonovSVD and TSVD implementations
+	SCIRun::Core::Datatypes::DenseColumnMatrix SCIRun::Core::Algorithms::Inverse::TikhonovImpl::computeResidualOutsideRange( const SCIRun::Core::Datatypes::DenseMatrix& Uy, int rank, const SCIRun::Core::Datatypes::DenseMatrix& measuredData )
+	{
+		SCIRun::Core::Datatypes::DenseColumnMatrix outsideRange = Uy.bottomRows(Uy.rows() - rank).colwise().squaredNorm().transpose();
+
+		// data outside the span of U itself, if the SVD given as input is thin
+		SCIRun::Core::Datatypes::DenseColumnMatrix outsideU = measuredData.colwise().squaredNorm().transpose() - Uy.colwise().squaredNorm().transpose();
+		outsideRange += outsideU.cwiseMax(0.0);
+
+		return outsideRange;
+	}
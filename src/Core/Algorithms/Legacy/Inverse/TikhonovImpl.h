@@ -32,6 +32,7 @@
 #define BioPSE_TikhonovImpl_H__
 
 #include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
 #include <Core/Algorithms/Legacy/Inverse/share.h>
 #include <vector>
 
@@ -55,6 +56,31 @@ namespace Inverse {
 		// default lambda step. Can ve overriden if necessary (see TSVD as reference)
 		virtual std::vector<double> computeLambdaArray( double lambdaMin, double lambdaMax, int nLambda ) const;
 
+		// called before solving for many lambdas (L-curve). Implementations that can factor
+		// the problem once for all lambdas do it here, so that computeInverseSolution no
+		// longer needs a factorization per lambda. Nothing to do by default.
+		virtual void prepareLambdaSweep() {}
+
+		// solution with its own lambda for every column (time sample) of the data. The default
+		// solves once for each distinct lambda; implementations holding a factorization of the
+		// problem apply it to all columns in one matrix product.
+		virtual SCIRun::Core::Datatypes::DenseMatrix computeInverseSolutionPerColumn( const std::vector<double>& lambdas ) const;
+
+		// trace of the influence matrix A * (regularized inverse), for GCV. Negative if the
+		// implementation cannot compute it.
+		virtual double influenceTrace( double ) const { return -1.0; }
+
+		// residual norm ||A x - y|| and solution norm ||x|| of every column for one lambda, taken
+		// from the factorization without forming x. Unweighted norms only; returns false if the
+		// implementation cannot compute them.
+		virtual bool computeColumnNorms( double, SCIRun::Core::Datatypes::DenseColumnMatrix&, SCIRun::Core::Datatypes::DenseColumnMatrix& ) const { return false; }
+
+	protected:
+
+		// squared norm of every data column outside the span of the first 'rank' left singular
+		// vectors, given the projections Uy = U^T * y. This is the part of the residual that no lambda removes
+		static SCIRun::Core::Datatypes::DenseColumnMatrix computeResidualOutsideRange( const SCIRun::Core::Datatypes::DenseMatrix& Uy, int rank, const SCIRun::Core::Datatypes::DenseMatrix& measuredData );
+
 	};
 
 	}}}}
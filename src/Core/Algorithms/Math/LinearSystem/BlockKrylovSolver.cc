@@ -0,0 +1,402 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Math/LinearSystem/BlockKrylovSolver.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Utils/Exception.h>
+#include <Core/Thread/Parallel.h>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  // Y = A*X with the rows of A split over the thread pool; each row is read once for all columns.
+  void multiply(const SparseRowMatrix& A, const Eigen::MatrixXd& X, Eigen::MatrixXd& Y)
+  {
+    Y.resize(A.rows(), X.cols());
+    Parallel::For(0, A.rows(), [&A, &X, &Y](size_t begin, size_t end)
+    {
+      const Eigen::Index rows = end - begin;
+      Y.middleRows(begin, rows).noalias() = A.middleRows(begin, rows) * X;
+    });
+  }
+
+  Eigen::VectorXd columnDots(const Eigen::MatrixXd& a, const Eigen::MatrixXd& b)
+  {
+    return a.cwiseProduct(b).colwise().sum().transpose();
+  }
+
+  Eigen::VectorXd columnNorms(const Eigen::MatrixXd& a)
+  {
+    return a.colwise().norm().transpose();
+  }
+
+  Eigen::VectorXd safeInverse(const Eigen::VectorXd& v)
+  {
+    Eigen::VectorXd inv(v.size());
+    for (Eigen::Index i = 0; i < v.size(); ++i)
+      inv[i] = v[i] != 0 ? 1.0 / v[i] : 0.0;
+    return inv;
+  }
+
+  void keepColumns(Eigen::MatrixXd& m, const std::vector<Eigen::Index>& keep)
+  {
+    Eigen::MatrixXd kept(m.rows(), keep.size());
+    for (size_t c = 0; c < keep.size(); ++c)
+      kept.col(c) = m.col(keep[c]);
+    m.swap(kept);
+  }
+
+  void keepEntries(Eigen::VectorXd& v, const std::vector<Eigen::Index>& keep)
+  {
+    Eigen::VectorXd kept(keep.size());
+    for (size_t c = 0; c < keep.size(); ++c)
+      kept[c] = v[keep[c]];
+    v.swap(kept);
+  }
+
+  template <typename T>
+  void keepEntries(std::vector<T>& v, const std::vector<Eigen::Index>& keep)
+  {
+    std::vector<T> kept(keep.size());
+    for (size_t c = 0; c < keep.size(); ++c)
+      kept[c] = v[keep[c]];
+    v.swap(kept);
+  }
+
+  // Which input columns are still iterating, and their right-hand side norms.
+  class ActiveColumns
+  {
+  public:
+    ActiveColumns(const SparseRowMatrix& A, const Eigen::MatrixXd& B, Eigen::MatrixXd& X, BlockSolverResult& result)
+      : index_(B.cols()), bnorm_(columnNorms(B)), result_(result)
+    {
+      if (A.rows() != A.cols() || A.rows() != B.rows())
+        THROW_INVALID_ARGUMENT("Block solver needs a square matrix matching the right-hand side rows");
+      if (X.rows() != B.rows() || X.cols() != B.cols())
+        X = Eigen::MatrixXd::Zero(B.rows(), B.cols());
+
+      std::iota(index_.begin(), index_.end(), 0);
+      for (Eigen::Index c = 0; c < bnorm_.size(); ++c)
+        if (bnorm_[c] == 0)
+          bnorm_[c] = 1;
+      result_.residuals.assign(B.cols(), 0.0);
+    }
+
+    Eigen::VectorXd relative(const Eigen::MatrixXd& R) const
+    {
+      return columnNorms(R).cwiseQuotient(bnorm_);
+    }
+
+    double rhsNorm(Eigen::Index c) const { return bnorm_[c]; }
+
+    // Copies finished columns to X and returns the positions that keep iterating.
+    std::vector<Eigen::Index> retire(const Eigen::VectorXd& residual, const std::vector<bool>& stalled,
+      double tolerance, bool stop, const Eigen::MatrixXd& Xactive, Eigen::MatrixXd& X)
+    {
+      std::vector<Eigen::Index> keep;
+      for (size_t c = 0; c < index_.size(); ++c)
+      {
+        if (!stop && residual[c] > tolerance && !stalled[c])
+        {
+          keep.push_back(c);
+        }
+        else
+        {
+          X.col(index_[c]) = Xactive.col(c);
+          result_.residuals[index_[c]] = residual[c];
+        }
+      }
+      if (keep.size() < index_.size())
+      {
+        keepEntries(index_, keep);
+        keepEntries(bnorm_, keep);
+      }
+      return keep;
+    }
+
+    void finish(double tolerance) const
+    {
+      result_.converged = std::all_of(result_.residuals.begin(), result_.residuals.end(),
+        [tolerance](double r) { return r <= tolerance; });
+    }
+
+  private:
+    std::vector<Eigen::Index> index_;
+    Eigen::VectorXd bnorm_;
+    BlockSolverResult& result_;
+  };
+}
+
+BlockKrylovSolver::BlockKrylovSolver(double tolerance, int maxIterations, size_t memoryLimit) :
+  tolerance_(tolerance), maxIterations_(maxIterations), memoryLimit_(memoryLimit)
+{
+}
+
+const size_t BlockKrylovSolver::DefaultMemoryLimit;
+
+Eigen::Index BlockKrylovSolver::chunkColumns(Eigen::Index rows, int vectorsPerColumn) const
+{
+  const size_t bytesPerColumn = std::max<size_t>(1, rows) * vectorsPerColumn * sizeof(double);
+  return std::max<Eigen::Index>(1, memoryLimit_ / bytesPerColumn);
+}
+
+namespace
+{
+  template <class Solve>
+  BlockSolverResult solveInChunks(const SparseRowMatrix& A, const Eigen::MatrixXd& B, Eigen::MatrixXd& X,
+    Eigen::Index chunk, Solve solve)
+  {
+    if (B.cols() <= chunk)
+      return solve(B, X);
+
+    if (A.rows() != A.cols() || A.rows() != B.rows())
+      THROW_INVALID_ARGUMENT("Block solver needs a square matrix matching the right-hand side rows");
+    if (X.rows() != B.rows() || X.cols() != B.cols())
+      X = Eigen::MatrixXd::Zero(B.rows(), B.cols());
+
+    BlockSolverResult result;
+    result.converged = true;
+    for (Eigen::Index first = 0; first < B.cols(); first += chunk)
+    {
+      const Eigen::Index width = std::min(chunk, B.cols() - first);
+      Eigen::MatrixXd Xc = X.middleCols(first, width);
+      const auto part = solve(B.middleCols(first, width), Xc);
+      X.middleCols(first, width) = Xc;
+      result.iterations = std::max(result.iterations, part.iterations);
+      result.residuals.insert(result.residuals.end(), part.residuals.begin(), part.residuals.end());
+      result.converged = result.converged && part.converged;
+    }
+    return result;
+  }
+}
+
+BlockSolverResult BlockKrylovSolver::solveCG(const SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+  const Eigen::MatrixXd& B, Eigen::MatrixXd& X) const
+{
+  return solveInChunks(A, B, X, chunkColumns(B.rows(), 6),
+    [&](const Eigen::MatrixXd& Bc, Eigen::MatrixXd& Xc) { return solveCGBlock(A, M, Bc, Xc); });
+}
+
+BlockSolverResult BlockKrylovSolver::solveGMRES(const SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+  const Eigen::MatrixXd& B, Eigen::MatrixXd& X, int restart) const
+{
+  return solveInChunks(A, B, X, chunkColumns(B.rows(), std::max(1, restart) + 7),
+    [&](const Eigen::MatrixXd& Bc, Eigen::MatrixXd& Xc) { return solveGMRESBlock(A, M, Bc, Xc, restart); });
+}
+
+BlockSolverResult BlockKrylovSolver::solveCGBlock(const SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+  const Eigen::MatrixXd& B, Eigen::MatrixXd& X) const
+{
+  BlockSolverResult result;
+  ActiveColumns active(A, B, X, result);
+
+  Eigen::MatrixXd Xa = X;
+  Eigen::MatrixXd R;
+  multiply(A, Xa, R);
+  R = B - R;
+  Eigen::MatrixXd Z, Q;
+  M.apply(R, Z);
+  Eigen::MatrixXd P = Z;
+  Eigen::VectorXd rz = columnDots(R, Z);
+  Eigen::VectorXd residual = active.relative(R);
+  std::vector<bool> stalled(B.cols(), false);
+
+  while (true)
+  {
+    const auto keep = active.retire(residual, stalled, tolerance_, result.iterations >= maxIterations_, Xa, X);
+    if (keep.empty())
+      break;
+    if (static_cast<Eigen::Index>(keep.size()) < Xa.cols())
+    {
+      keepColumns(Xa, keep);
+      keepColumns(R, keep);
+      keepColumns(P, keep);
+      keepEntries(rz, keep);
+      keepEntries(stalled, keep);
+    }
+
+    // one sparse product for every active column
+    multiply(A, P, Q);
+    const Eigen::VectorXd pq = columnDots(P, Q);
+    Eigen::VectorXd alpha(pq.size());
+    for (Eigen::Index c = 0; c < pq.size(); ++c)
+    {
+      if (pq[c] > 0)
+      {
+        alpha[c] = rz[c] / pq[c];
+      }
+      else
+      {
+        // A is not positive definite along this direction
+        alpha[c] = 0;
+        stalled[c] = true;
+      }
+    }
+
+    Xa += P * alpha.asDiagonal();
+    R -= Q * alpha.asDiagonal();
+    residual = active.relative(R);
+
+    M.apply(R, Z);
+    const Eigen::VectorXd rzNext = columnDots(R, Z);
+    const Eigen::VectorXd beta = rzNext.cwiseProduct(safeInverse(rz));
+    P = Z + P * beta.asDiagonal();
+    rz = rzNext;
+    ++result.iterations;
+  }
+
+  active.finish(tolerance_);
+  return result;
+}
+
+BlockSolverResult BlockKrylovSolver::solveGMRESBlock(const SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+  const Eigen::MatrixXd& B, Eigen::MatrixXd& X, int restart) const
+{
+  BlockSolverResult result;
+  ActiveColumns active(A, B, X, result);
+  const int m = std::max(1, restart);
+
+  Eigen::MatrixXd Xa = X;
+  Eigen::MatrixXd Ba = B;
+  Eigen::MatrixXd R;
+  multiply(A, Xa, R);
+  R = Ba - R;
+  Eigen::VectorXd residual = active.relative(R);
+  std::vector<bool> stalled(B.cols(), false);
+  Eigen::MatrixXd Z, W;
+
+  while (true)
+  {
+    const auto keep = active.retire(residual, stalled, tolerance_, result.iterations >= maxIterations_, Xa, X);
+    if (keep.empty())
+      break;
+    if (static_cast<Eigen::Index>(keep.size()) < Xa.cols())
+    {
+      keepColumns(Xa, keep);
+      keepColumns(Ba, keep);
+      keepColumns(R, keep);
+      keepEntries(residual, keep);
+      keepEntries(stalled, keep);
+    }
+    const Eigen::Index s = R.cols();
+
+    // Arnoldi on every column; the Hessenberg matrices are reduced by Givens rotations as they grow
+    const Eigen::VectorXd beta = columnNorms(R);
+    std::vector<Eigen::MatrixXd> V;
+    V.reserve(m + 1);
+    V.push_back(R * safeInverse(beta).asDiagonal());
+    std::vector<Eigen::MatrixXd> H(s, Eigen::MatrixXd::Zero(m + 1, m));
+    Eigen::MatrixXd g = Eigen::MatrixXd::Zero(m + 1, s);
+    g.row(0) = beta.transpose();
+    Eigen::MatrixXd cs(m, s), sn(m, s);
+    std::vector<int> steps(s, 0);
+    std::vector<bool> done(s, false);
+
+    for (int k = 0; k < m && result.iterations < maxIterations_; ++k)
+    {
+      M.apply(V[k], Z);
+      multiply(A, Z, W);
+      for (int i = 0; i <= k; ++i)
+      {
+        const Eigen::VectorXd h = columnDots(V[i], W);
+        W -= V[i] * h.asDiagonal();
+        for (Eigen::Index c = 0; c < s; ++c)
+          H[c](i, k) = h[c];
+      }
+      const Eigen::VectorXd hNext = columnNorms(W);
+      for (Eigen::Index c = 0; c < s; ++c)
+        H[c](k + 1, k) = hNext[c];
+      V.push_back(W * safeInverse(hNext).asDiagonal());
+      ++result.iterations;
+
+      bool allDone = true;
+      for (Eigen::Index c = 0; c < s; ++c)
+      {
+        if (done[c])
+          continue;
+        auto& h = H[c];
+        for (int i = 0; i < k; ++i)
+        {
+          const double t = cs(i, c) * h(i, k) + sn(i, c) * h(i + 1, k);
+          h(i + 1, k) = -sn(i, c) * h(i, k) + cs(i, c) * h(i + 1, k);
+          h(i, k) = t;
+        }
+        const double denom = std::hypot(h(k, k), h(k + 1, k));
+        if (denom == 0)
+        {
+          done[c] = true;
+          continue;
+        }
+        cs(k, c) = h(k, k) / denom;
+        sn(k, c) = h(k + 1, k) / denom;
+        h(k, k) = denom;
+        h(k + 1, k) = 0;
+        g(k + 1, c) = -sn(k, c) * g(k, c);
+        g(k, c) = cs(k, c) * g(k, c);
+        steps[c] = k + 1;
+
+        if (std::abs(g(k + 1, c)) <= tolerance_ * active.rhsNorm(c) || hNext[c] == 0)
+          done[c] = true;
+        else
+          allDone = false;
+      }
+      if (allDone)
+        break;
+    }
+
+    Eigen::MatrixXd U = Eigen::MatrixXd::Zero(Xa.rows(), s);
+    for (Eigen::Index c = 0; c < s; ++c)
+    {
+      const int kc = steps[c];
+      if (kc == 0)
+        continue;
+      const Eigen::VectorXd y = H[c].topLeftCorner(kc, kc).triangularView<Eigen::Upper>().solve(g.col(c).head(kc));
+      for (int i = 0; i < kc; ++i)
+        U.col(c) += y[i] * V[i].col(c);
+    }
+    M.apply(U, Z);
+    Xa += Z;
+
+    multiply(A, Xa, R);
+    R = Ba - R;
+    const Eigen::VectorXd previous = residual;
+    residual = active.relative(R);
+    for (Eigen::Index c = 0; c < s; ++c)
+      if (!(residual[c] < previous[c]))
+        stalled[c] = true;
+  }
+
+  active.finish(tolerance_);
+  return result;
+}
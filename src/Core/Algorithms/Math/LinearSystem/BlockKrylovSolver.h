@@ -0,0 +1,88 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_LINEARSYSTEM_BLOCKKRYLOVSOLVER_H
+#define CORE_ALGORITHMS_MATH_LINEARSYSTEM_BLOCKKRYLOVSOLVER_H
+
+#include <Core/Algorithms/Math/LinearSystem/Preconditioners.h>
+#include <vector>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+  struct SCISHARE BlockSolverResult
+  {
+    BlockSolverResult() : iterations(0), converged(false) {}
+    /// block iterations; with several column chunks, those of the slowest chunk
+    int iterations;
+    /// final ||b - A*x|| / ||b|| of every column
+    std::vector<double> residuals;
+    bool converged;
+  };
+
+  /// Krylov iterations for all columns of a right-hand side block at once.
+  /// Every iteration does one sparse product and one preconditioner application
+  /// for the whole block; each column keeps its own recurrence coefficients and
+  /// leaves the block once it has converged. Right-hand sides whose working
+  /// vectors would not fit in memoryLimit bytes are solved in column chunks.
+  class SCISHARE BlockKrylovSolver
+  {
+  public:
+    static const size_t DefaultMemoryLimit = size_t(1) << 30;
+
+    BlockKrylovSolver(double tolerance, int maxIterations, size_t memoryLimit = DefaultMemoryLimit);
+
+    /// Columns solved together: CG keeps about 6 and GMRES restart+7 vectors per column.
+    Eigen::Index chunkColumns(Eigen::Index rows, int vectorsPerColumn) const;
+
+    /// Preconditioned conjugate gradients: A symmetric positive definite, M symmetric.
+    /// X holds the initial guess on entry (resized and zeroed if it does not fit).
+    BlockSolverResult solveCG(const Datatypes::SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+      const Eigen::MatrixXd& B, Eigen::MatrixXd& X) const;
+
+    /// Right-preconditioned restarted GMRES, for nonsymmetric A.
+    BlockSolverResult solveGMRES(const Datatypes::SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+      const Eigen::MatrixXd& B, Eigen::MatrixXd& X, int restart = 30) const;
+
+  private:
+    BlockSolverResult solveCGBlock(const Datatypes::SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+      const Eigen::MatrixXd& B, Eigen::MatrixXd& X) const;
+    BlockSolverResult solveGMRESBlock(const Datatypes::SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+      const Eigen::MatrixXd& B, Eigen::MatrixXd& X, int restart) const;
+
+    double tolerance_;
+    int maxIterations_;
+    size_t memoryLimit_;
+  };
+
+}}}}
+
+#endif
@@ -0,0 +1,179 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Math/LinearSystem/MixedPrecisionSolver.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/VectorKernels.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Thread/Parallel.h>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  // Below this a float CG cannot reduce the residual any further.
+  const double SingleInnerTolerance = 1e-5;
+  const double MinimumProgress = 0.5;
+  // Rows per task of the threaded inner solve; smaller systems stay on one thread.
+  const size_t RowsPerBlock = 8192;
+
+  // Sums kernel(begin, end) over fixed row blocks in block order, so the result
+  // does not depend on how many threads ran the blocks.
+  template <class Kernel>
+  double blockSum(size_t n, std::vector<double>& partial, Kernel kernel)
+  {
+    const size_t blocks = std::max<size_t>(1, (n + RowsPerBlock - 1) / RowsPerBlock);
+    partial.assign(blocks, 0.0);
+    Parallel::For(0, blocks, [&](size_t first, size_t last)
+    {
+      for (size_t b = first; b < last; ++b)
+        partial[b] = kernel(b * RowsPerBlock, std::min(n, (b + 1) * RowsPerBlock));
+    }, 1);
+    return std::accumulate(partial.begin(), partial.end(), 0.0);
+  }
+}
+
+MixedPrecisionSolver::MixedPrecisionSolver(const SparseRowMatrix& A)
+{
+  if (!supports(A))
+    BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("Matrix is too large for the mixed precision solver"));
+  single_ = A.cast<float>();
+  single_.makeCompressed();
+}
+
+bool MixedPrecisionSolver::supports(const SparseRowMatrix& A)
+{
+  return A.nonZeros() < std::numeric_limits<int>::max() && A.nrows() < std::numeric_limits<int>::max();
+}
+
+size_t MixedPrecisionSolver::singlePrecisionBytes() const
+{
+  return single_.nonZeros() * (sizeof(float) + sizeof(int)) + (single_.rows() + 1) * sizeof(int);
+}
+
+MixedPrecisionResult MixedPrecisionSolver::solve(const SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+  const Eigen::VectorXd& b, Eigen::VectorXd& x, double tolerance, int maxIterations) const
+{
+  MixedPrecisionResult result;
+  const double bnorm = b.norm();
+  if (x.size() != b.size())
+    x = Eigen::VectorXd::Zero(b.size());
+  if (bnorm == 0)
+  {
+    x.setZero();
+    result.converged = true;
+    return result;
+  }
+
+  Eigen::VectorXd r = b - A * x;
+  result.residual = r.norm() / bnorm;
+  Eigen::MatrixXf rs, d;
+  while (result.residual > tolerance && result.iterations < maxIterations)
+  {
+    // Solve for a normalized correction, so float range is never an issue, and
+    // stop the inner solve once it is below what the outer target still needs.
+    const double rnorm = r.norm();
+    const double innerTolerance = std::max(SingleInnerTolerance, 0.5 * tolerance / result.residual);
+    rs = (r / rnorm).cast<float>();
+    result.iterations += innerSolve(M, rs, d, innerTolerance, maxIterations - result.iterations);
+    ++result.refinements;
+
+    x += rnorm * d.col(0).cast<double>();
+    r = b - A * x;
+    const double previous = result.residual;
+    result.residual = r.norm() / bnorm;
+    if (!(result.residual < MinimumProgress * previous))
+      break;
+  }
+  result.converged = result.residual <= tolerance;
+  return result;
+}
+
+// Single precision PCG with the vector updates fused into three passes per
+// iteration, each split over row blocks on the thread pool and run with the
+// SIMD kernels; dot products are accumulated in double.
+int MixedPrecisionSolver::innerSolve(const LinearSystemPreconditioner& M, const Eigen::MatrixXf& r0,
+  Eigen::MatrixXf& d, double tolerance, int maxIterations) const
+{
+  const size_t n = static_cast<size_t>(r0.rows());
+  const int* outer = single_.outerIndexPtr();
+  const int* inner = single_.innerIndexPtr();
+  const float* values = single_.valuePtr();
+  const VectorKernels& kernels = vectorKernels();
+  std::vector<double> partial;
+
+  d.setZero(n, 1);
+  Eigen::MatrixXf r = r0, z, q(n, 1);
+  M.applySingle(r, z);
+  Eigen::MatrixXf p = z;
+  double rz = r.col(0).cast<double>().dot(z.col(0).cast<double>());
+  const double target = tolerance * r0.norm();
+
+  int iterations = 0;
+  while (iterations < maxIterations)
+  {
+    // q = A*p and p.q in one pass
+    const double pq = blockSum(n, partial, [&](size_t begin, size_t end)
+    {
+      return kernels.csr_mult_dot_single(outer, inner, values, p.data(), q.data(), begin, end);
+    });
+    if (!(pq > 0))
+      break;
+
+    const float alpha = static_cast<float>(rz / pq);
+    const double rr = blockSum(n, partial, [&](size_t begin, size_t end)
+    {
+      kernels.scale_add_single(alpha, p.data() + begin, d.data() + begin, d.data() + begin, end - begin);
+      return kernels.scale_add_norm2_single(-alpha, q.data() + begin, r.data() + begin, r.data() + begin, end - begin);
+    });
+    ++iterations;
+    if (std::sqrt(rr) <= target)
+      break;
+
+    M.applySingle(r, z);
+    const double rzNext = blockSum(n, partial, [&](size_t begin, size_t end)
+    {
+      return kernels.dot_single(r.data() + begin, z.data() + begin, end - begin);
+    });
+    if (rzNext == 0)
+      break;
+    const float beta = static_cast<float>(rzNext / rz);
+    Parallel::For(0, n, [&](size_t begin, size_t end)
+    {
+      kernels.scale_add_single(beta, p.data() + begin, z.data() + begin, p.data() + begin, end - begin);
+    }, RowsPerBlock);
+    rz = rzNext;
+  }
+  return iterations;
+}
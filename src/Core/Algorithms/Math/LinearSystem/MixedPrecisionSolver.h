@@ -0,0 +1,84 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_LINEARSYSTEM_MIXEDPRECISIONSOLVER_H
+#define CORE_ALGORITHMS_MATH_LINEARSYSTEM_MIXEDPRECISIONSOLVER_H
+
+#include <Core/Algorithms/Math/LinearSystem/Preconditioners.h>
+#include <Eigen/SparseCore>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+  struct SCISHARE MixedPrecisionResult
+  {
+    MixedPrecisionResult() : refinements(0), iterations(0), residual(0), converged(false) {}
+    /// outer double precision corrections
+    int refinements;
+    /// inner single precision CG iterations, summed over all refinements
+    int iterations;
+    /// final ||b - A*x|| / ||b||, computed in double precision
+    double residual;
+    bool converged;
+  };
+
+  /// Iterative refinement: the residual and the solution are kept in double
+  /// precision, each correction is solved with preconditioned CG on a float copy
+  /// of A with 32 bit indices, which moves about half the bytes per iteration.
+  /// Converges to the double precision tolerance as long as cond(A) is well below
+  /// 1/eps(float); otherwise the result reports the residual reached.
+  class SCISHARE MixedPrecisionSolver : boost::noncopyable
+  {
+  public:
+    typedef Eigen::SparseMatrix<float, Eigen::RowMajor, int> SingleMatrix;
+
+    explicit MixedPrecisionSolver(const Datatypes::SparseRowMatrix& A);
+
+    /// False when the matrix has too many entries for 32 bit indices.
+    static bool supports(const Datatypes::SparseRowMatrix& A);
+
+    /// A symmetric positive definite, M symmetric. x holds the initial guess.
+    MixedPrecisionResult solve(const Datatypes::SparseRowMatrix& A, const LinearSystemPreconditioner& M,
+      const Eigen::VectorXd& b, Eigen::VectorXd& x, double tolerance, int maxIterations) const;
+
+    /// Memory of the float copy of A.
+    size_t singlePrecisionBytes() const;
+
+  private:
+    int innerSolve(const LinearSystemPreconditioner& M, const Eigen::MatrixXf& r, Eigen::MatrixXf& d,
+      double tolerance, int maxIterations) const;
+
+    SingleMatrix single_;
+  };
+
+}}}}
+
+#endif
@@ -0,0 +1,571 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Math/LinearSystem/Preconditioners.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Eigen/SparseCholesky>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace SCIRun;
+using namespace SCIRun::Core;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+
+namespace
+{
+  typedef SparseRowMatrix::EigenBase SparseMatrix;
+  typedef Eigen::Triplet<double, index_type> Triplet;
+  // Triangular sweeps walk rows, so every right-hand side of a row is stored contiguously.
+  template <class Scalar>
+  using RowBlockOf = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  typedef RowBlockOf<double> RowBlock;
+
+  /// Float copy of a factor with 32 bit indices: half the bytes per entry of
+  /// the double precision CSR arrays. Left empty when the indices do not fit.
+  struct SingleFactor
+  {
+    SingleFactor() {}
+    explicit SingleFactor(const SparseMatrix& F)
+    {
+      if (F.nonZeros() > std::numeric_limits<int>::max())
+        return;
+      outer.assign(F.outerIndexPtr(), F.outerIndexPtr() + F.rows() + 1);
+      inner.assign(F.innerIndexPtr(), F.innerIndexPtr() + F.nonZeros());
+      values.assign(F.valuePtr(), F.valuePtr() + F.nonZeros());
+    }
+    bool empty() const { return outer.empty(); }
+    size_t bytes() const { return (outer.size() + inner.size()) * sizeof(int) + values.size() * sizeof(float); }
+
+    std::vector<int> outer, inner;
+    std::vector<float> values;
+  };
+
+  void throwPreconditionerError(const std::string& message)
+  {
+    BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage(message));
+  }
+
+  // Same scaling as the threaded Jacobi solvers: 1/|a_ii|, negligible entries left at one.
+  Eigen::VectorXd invertedAbsDiagonal(const SparseMatrix& A)
+  {
+    Eigen::VectorXd d = A.diagonal().cwiseAbs();
+    const double threshold = d.size() > 0 ? 1e-18 * d.maxCoeff() : 0.0;
+    for (Eigen::Index i = 0; i < d.size(); ++i)
+      d[i] = d[i] > threshold ? 1.0 / d[i] : 1.0;
+    return d;
+  }
+
+  std::vector<index_type> diagonalPositions(const SparseMatrix& A)
+  {
+    std::vector<index_type> diag(A.rows());
+    const auto outer = A.outerIndexPtr();
+    const auto inner = A.innerIndexPtr();
+    for (index_type i = 0; i < A.rows(); ++i)
+    {
+      auto pos = std::lower_bound(inner + outer[i], inner + outer[i + 1], i);
+      if (pos == inner + outer[i + 1] || *pos != i)
+        throwPreconditionerError("Incomplete factorization needs a stored diagonal entry in every row");
+      diag[i] = pos - inner;
+    }
+    return diag;
+  }
+
+  class IdentityPreconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    void apply(const Eigen::MatrixXd& R, Eigen::MatrixXd& Z) const override { Z = R; }
+    void applySingle(const Eigen::MatrixXf& R, Eigen::MatrixXf& Z) const override { Z = R; }
+    std::string name() const override { return "None"; }
+  };
+
+  class JacobiPreconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    explicit JacobiPreconditioner(const SparseMatrix& A) : invDiag_(invertedAbsDiagonal(A)),
+      invDiagSingle_(invDiag_.cast<float>()) {}
+    void apply(const Eigen::MatrixXd& R, Eigen::MatrixXd& Z) const override { Z = invDiag_.asDiagonal() * R; }
+    void applySingle(const Eigen::MatrixXf& R, Eigen::MatrixXf& Z) const override { Z = invDiagSingle_.asDiagonal() * R; }
+    size_t singlePrecisionBytes() const override { return invDiagSingle_.size() * sizeof(float); }
+    std::string name() const override { return "Jacobi"; }
+  private:
+    Eigen::VectorXd invDiag_;
+    Eigen::VectorXf invDiagSingle_;
+  };
+
+  /// ILU(0): L and U share the sparsity pattern of A, L has a unit diagonal.
+  class ILU0Preconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    explicit ILU0Preconditioner(const SparseMatrix& A) : LU_(A)
+    {
+      LU_.makeCompressed();
+      const auto n = LU_.rows();
+      const auto outer = LU_.outerIndexPtr();
+      const auto inner = LU_.innerIndexPtr();
+      auto values = LU_.valuePtr();
+      diag_ = diagonalPositions(LU_);
+
+      std::vector<index_type> position(n, -1);
+      for (index_type i = 0; i < n; ++i)
+      {
+        for (auto p = outer[i]; p < outer[i + 1]; ++p)
+          position[inner[p]] = p;
+
+        for (auto p = outer[i]; p < diag_[i]; ++p)
+        {
+          const auto k = inner[p];
+          values[p] /= values[diag_[k]];
+          const double lik = values[p];
+          for (auto q = diag_[k] + 1; q < outer[k + 1]; ++q)
+          {
+            const auto pos = position[inner[q]];
+            if (pos >= 0)
+              values[pos] -= lik * values[q];
+          }
+        }
+        if (values[diag_[i]] == 0.0)
+          throwPreconditionerError("ILU(0) factorization encountered a zero pivot");
+
+        for (auto p = outer[i]; p < outer[i + 1]; ++p)
+          position[inner[p]] = -1;
+      }
+
+      single_ = SingleFactor(LU_);
+      singleDiag_.assign(diag_.begin(), diag_.end());
+    }
+
+    void apply(const Eigen::MatrixXd& R, Eigen::MatrixXd& Z) const override
+    {
+      RowBlock W = R;
+      solve(LU_.outerIndexPtr(), LU_.innerIndexPtr(), LU_.valuePtr(), diag_.data(), W);
+      Z = W;
+    }
+
+    void applySingle(const Eigen::MatrixXf& R, Eigen::MatrixXf& Z) const override
+    {
+      if (single_.empty())
+        return LinearSystemPreconditioner::applySingle(R, Z);
+      RowBlockOf<float> W = R;
+      solve(single_.outer.data(), single_.inner.data(), single_.values.data(), singleDiag_.data(), W);
+      Z = W;
+    }
+
+    size_t singlePrecisionBytes() const override { return single_.bytes() + singleDiag_.size() * sizeof(int); }
+
+    std::string name() const override { return "ILU0"; }
+
+  private:
+    template <class Index, class Scalar>
+    void solve(const Index* outer, const Index* inner, const Scalar* values, const Index* diag, RowBlockOf<Scalar>& W) const
+    {
+      const index_type n = LU_.rows();
+      for (index_type i = 0; i < n; ++i)
+        for (auto p = outer[i]; p < diag[i]; ++p)
+          W.row(i) -= values[p] * W.row(inner[p]);
+
+      for (index_type i = n - 1; i >= 0; --i)
+      {
+        for (auto p = diag[i] + 1; p < outer[i + 1]; ++p)
+          W.row(i) -= values[p] * W.row(inner[p]);
+        W.row(i) /= values[diag[i]];
+      }
+    }
+
+    SparseMatrix LU_;
+    std::vector<index_type> diag_;
+    SingleFactor single_;
+    std::vector<int> singleDiag_;
+  };
+
+  /// IC(0): A ~ L*L^T with L on the lower triangular pattern of A. If a pivot
+  /// breaks down the factorization is retried on A + shift*diag(A).
+  class IncompleteCholeskyPreconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    explicit IncompleteCholeskyPreconditioner(const SparseMatrix& A)
+    {
+      SparseMatrix lower = A.triangularView<Eigen::Lower>();
+      lower.makeCompressed();
+      for (index_type i = 0; i < lower.rows(); ++i)
+      {
+        const auto last = lower.outerIndexPtr()[i + 1] - 1;
+        if (last < lower.outerIndexPtr()[i] || lower.innerIndexPtr()[last] != i)
+          throwPreconditionerError("Incomplete Cholesky factorization needs a stored diagonal entry in every row");
+      }
+
+      double shift = 0;
+      for (int attempt = 0; attempt < 12; ++attempt)
+      {
+        if (factor(lower, shift))
+        {
+          single_ = SingleFactor(L_);
+          return;
+        }
+        shift = shift == 0 ? 1e-3 : 2 * shift;
+      }
+      throwPreconditionerError("Incomplete Cholesky factorization failed, matrix is not positive definite");
+    }
+
+    void apply(const Eigen::MatrixXd& R, Eigen::MatrixXd& Z) const override
+    {
+      RowBlock W = R;
+      solve(L_.outerIndexPtr(), L_.innerIndexPtr(), L_.valuePtr(), W);
+      Z = W;
+    }
+
+    void applySingle(const Eigen::MatrixXf& R, Eigen::MatrixXf& Z) const override
+    {
+      if (single_.empty())
+        return LinearSystemPreconditioner::applySingle(R, Z);
+      RowBlockOf<float> W = R;
+      solve(single_.outer.data(), single_.inner.data(), single_.values.data(), W);
+      Z = W;
+    }
+
+    size_t singlePrecisionBytes() const override { return single_.bytes(); }
+
+    std::string name() const override { return "IncompleteCholesky"; }
+
+  private:
+    template <class Index, class Scalar>
+    void solve(const Index* outer, const Index* inner, const Scalar* values, RowBlockOf<Scalar>& W) const
+    {
+      const index_type n = L_.rows();
+      for (index_type i = 0; i < n; ++i)
+      {
+        const auto diag = outer[i + 1] - 1;
+        for (auto p = outer[i]; p < diag; ++p)
+          W.row(i) -= values[p] * W.row(inner[p]);
+        W.row(i) /= values[diag];
+      }
+
+      // L^T solve: the rows of L are the columns of L^T
+      for (index_type i = n - 1; i >= 0; --i)
+      {
+        const auto diag = outer[i + 1] - 1;
+        W.row(i) /= values[diag];
+        for (auto p = outer[i]; p < diag; ++p)
+          W.row(inner[p]) -= values[p] * W.row(i);
+      }
+    }
+
+    bool factor(const SparseMatrix& lower, double shift)
+    {
+      L_ = lower;
+      const auto n = L_.rows();
+      const auto outer = L_.outerIndexPtr();
+      const auto inner = L_.innerIndexPtr();
+      auto values = L_.valuePtr();
+
+      if (shift != 0)
+      {
+        for (index_type i = 0; i < n; ++i)
+          values[outer[i + 1] - 1] *= 1.0 + shift;
+      }
+
+      std::vector<index_type> position(n, -1);
+      for (index_type i = 0; i < n; ++i)
+      {
+        for (auto p = outer[i]; p < outer[i + 1]; ++p)
+          position[inner[p]] = p;
+
+        for (auto p = outer[i]; p < outer[i + 1]; ++p)
+        {
+          const auto j = inner[p];
+          double s = values[p];
+          const auto diagJ = outer[j + 1] - 1;
+          for (auto q = outer[j]; q < diagJ; ++q)
+          {
+            const auto pos = position[inner[q]];
+            if (pos >= 0)
+              s -= values[pos] * values[q];
+          }
+          if (j < i)
+          {
+            values[p] = s / values[diagJ];
+          }
+          else
+          {
+            if (!(s > 0))
+              return false;
+            values[p] = std::sqrt(s);
+          }
+        }
+
+        for (auto p = outer[i]; p < outer[i + 1]; ++p)
+          position[inner[p]] = -1;
+      }
+      return true;
+    }
+
+    SparseMatrix L_;
+    SingleFactor single_;
+  };
+
+  /// Smoothed aggregation AMG used as one symmetric V-cycle per application:
+  /// damped Jacobi smoothing, Galerkin coarse operators and a sparse direct
+  /// solve on the coarsest level.
+  class AMGPreconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    explicit AMGPreconditioner(SparseRowMatrixHandle A) : fine_(A)
+    {
+      const SparseMatrix* current = fine_.get();
+      while (current->rows() > MaxCoarseSize && levels_.size() < MaxLevels)
+      {
+        Level level;
+        level.invDiag = invertedAbsDiagonal(*current);
+        level.omega = 4.0 / (3.0 * spectralRadiusEstimate(*current, level.invDiag));
+
+        std::vector<index_type> aggregates;
+        const auto numAggregates = aggregate(*current, aggregates);
+        if (numAggregates == 0 || numAggregates >= current->rows())
+          break;
+
+        std::vector<double> aggregateSize(numAggregates, 0.0);
+        for (auto a : aggregates)
+          if (a >= 0)
+            aggregateSize[a] += 1;
+        std::vector<Triplet> entries;
+        entries.reserve(aggregates.size());
+        for (index_type i = 0; i < static_cast<index_type>(aggregates.size()); ++i)
+          if (aggregates[i] >= 0)
+            entries.push_back(Triplet(i, aggregates[i], 1.0 / std::sqrt(aggregateSize[aggregates[i]])));
+        SparseMatrix tentative(current->rows(), numAggregates);
+        tentative.setFromTriplets(entries.begin(), entries.end());
+
+        const SparseMatrix AP0 = *current * tentative;
+        const Eigen::VectorXd jacobiScale = level.omega * level.invDiag;
+        const SparseMatrix smoothing = jacobiScale.asDiagonal() * AP0;
+        level.P = tentative - smoothing;
+        level.R = level.P.transpose();
+        SparseMatrix AP = *current * level.P;
+        coarse_.push_back(SparseMatrix(level.R * AP));
+        levels_.push_back(level);
+        current = &coarse_.back();
+      }
+
+      Eigen::SparseMatrix<double> coarsest = *current;
+      coarseSolver_.compute(coarsest);
+      if (coarseSolver_.info() != Eigen::Success)
+      {
+        // pure Neumann operators are singular on the coarse space as well
+        Eigen::SparseMatrix<double> identity(coarsest.rows(), coarsest.cols());
+        identity.setIdentity();
+        const double scale = coarsest.rows() > 0 ? coarsest.diagonal().cwiseAbs().maxCoeff() : 1.0;
+        coarsest += 1e-10 * scale * identity;
+        coarseSolver_.compute(coarsest);
+        if (coarseSolver_.info() != Eigen::Success)
+          throwPreconditionerError("AMG coarse level factorization failed");
+      }
+    }
+
+    void apply(const Eigen::MatrixXd& R, Eigen::MatrixXd& Z) const override
+    {
+      cycle(0, R, Z);
+    }
+
+    std::string name() const override { return "AMG"; }
+
+  private:
+    static const index_type MaxCoarseSize = 200;
+    static const size_t MaxLevels = 10;
+    static const int Sweeps = 2;
+
+    struct Level
+    {
+      SparseMatrix P, R;
+      Eigen::VectorXd invDiag;
+      double omega;
+    };
+
+    const SparseMatrix& op(size_t level) const
+    {
+      return level == 0 ? *fine_ : coarse_[level - 1];
+    }
+
+    void cycle(size_t level, const Eigen::MatrixXd& b, Eigen::MatrixXd& x) const
+    {
+      if (level == levels_.size())
+      {
+        x = coarseSolver_.solve(b);
+        return;
+      }
+      const auto& L = levels_[level];
+      const auto& A = op(level);
+
+      x = Eigen::MatrixXd::Zero(b.rows(), b.cols());
+      for (int sweep = 0; sweep < Sweeps; ++sweep)
+        smooth(L, A, b, x);
+
+      Eigen::MatrixXd residual = b - A * x;
+      Eigen::MatrixXd coarseRhs = L.R * residual;
+      Eigen::MatrixXd correction;
+      cycle(level + 1, coarseRhs, correction);
+      x += L.P * correction;
+
+      for (int sweep = 0; sweep < Sweeps; ++sweep)
+        smooth(L, A, b, x);
+    }
+
+    static void smooth(const Level& L, const SparseMatrix& A, const Eigen::MatrixXd& b, Eigen::MatrixXd& x)
+    {
+      x += L.omega * (L.invDiag.asDiagonal() * (b - A * x));
+    }
+
+    static double spectralRadiusEstimate(const SparseMatrix& A, const Eigen::VectorXd& invDiag)
+    {
+      Eigen::VectorXd v = Eigen::VectorXd::LinSpaced(A.rows(), 1.0, 2.0);
+      v.normalize();
+      double rho = 1.0;
+      for (int it = 0; it < 15; ++it)
+      {
+        Eigen::VectorXd w = invDiag.cwiseProduct(A * v);
+        const double norm = w.norm();
+        if (norm == 0)
+          break;
+        rho = norm;
+        v = w / norm;
+      }
+      // power iteration approaches from below
+      return 1.1 * rho;
+    }
+
+    // Three-pass aggregation on the strength graph; nodes without strong
+    // couplings (e.g. Dirichlet rows) get -1 and are left to the smoother.
+    static index_type aggregate(const SparseMatrix& A, std::vector<index_type>& aggregates)
+    {
+      const double theta = 0.08;
+      const auto n = A.rows();
+      const Eigen::VectorXd d = A.diagonal().cwiseAbs();
+
+      std::vector<index_type> strongOuter(n + 1, 0), strong;
+      strong.reserve(A.nonZeros());
+      for (index_type i = 0; i < n; ++i)
+      {
+        for (SparseMatrix::InnerIterator it(A, i); it; ++it)
+        {
+          const auto j = it.col();
+          if (j != i && std::abs(it.value()) >= theta * std::sqrt(d[i] * d[j]))
+            strong.push_back(j);
+        }
+        strongOuter[i + 1] = strong.size();
+      }
+
+      const index_type unassigned = -2;
+      aggregates.assign(n, unassigned);
+      for (index_type i = 0; i < n; ++i)
+        if (strongOuter[i] == strongOuter[i + 1])
+          aggregates[i] = -1;
+
+      index_type count = 0;
+      for (index_type i = 0; i < n; ++i)
+      {
+        if (aggregates[i] != unassigned)
+          continue;
+        bool free = true;
+        for (auto p = strongOuter[i]; p < strongOuter[i + 1] && free; ++p)
+          free = aggregates[strong[p]] == unassigned;
+        if (!free)
+          continue;
+        aggregates[i] = count;
+        for (auto p = strongOuter[i]; p < strongOuter[i + 1]; ++p)
+          aggregates[strong[p]] = count;
+        ++count;
+      }
+
+      const auto firstPass = aggregates;
+      for (index_type i = 0; i < n; ++i)
+      {
+        if (aggregates[i] != unassigned)
+          continue;
+        for (auto p = strongOuter[i]; p < strongOuter[i + 1]; ++p)
+        {
+          if (firstPass[strong[p]] >= 0)
+          {
+            aggregates[i] = firstPass[strong[p]];
+            break;
+          }
+        }
+      }
+
+      for (index_type i = 0; i < n; ++i)
+      {
+        if (aggregates[i] != unassigned)
+          continue;
+        aggregates[i] = count;
+        for (auto p = strongOuter[i]; p < strongOuter[i + 1]; ++p)
+          if (aggregates[strong[p]] == unassigned)
+            aggregates[strong[p]] = count;
+        ++count;
+      }
+      return count;
+    }
+
+    SparseRowMatrixHandle fine_;
+    std::vector<Level> levels_;
+    std::vector<SparseMatrix> coarse_;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> coarseSolver_;
+  };
+}
+
+bool PreconditionerFactory::isKnown(const std::string& name)
+{
+  return name == "None" || name == "Jacobi" || name == "IncompleteCholesky" || name == "ILU0" || name == "AMG";
+}
+
+void LinearSystemPreconditioner::applySingle(const Eigen::MatrixXf& R, Eigen::MatrixXf& Z) const
+{
+  Eigen::MatrixXd Zd;
+  apply(R.cast<double>(), Zd);
+  Z = Zd.cast<float>();
+}
+
+LinearSystemPreconditionerHandle PreconditionerFactory::create(const std::string& name, SparseRowMatrixHandle A)
+{
+  if (!A || A->rows() != A->cols())
+    throwPreconditionerError("Preconditioners need a square system matrix");
+
+  if (name == "None")
+    return boost::make_shared<IdentityPreconditioner>();
+  if (name == "Jacobi")
+    return boost::make_shared<JacobiPreconditioner>(*A);
+  if (name == "IncompleteCholesky")
+    return boost::make_shared<IncompleteCholeskyPreconditioner>(*A);
+  if (name == "ILU0")
+    return boost::make_shared<ILU0Preconditioner>(*A);
+  if (name == "AMG")
+    return boost::make_shared<AMGPreconditioner>(A);
+
+  throwPreconditionerError("Unknown preconditioner: " + name);
+  return nullptr;
+}
@@ -0,0 +1,74 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_LINEARSYSTEM_PRECONDITIONERS_H
+#define CORE_ALGORITHMS_MATH_LINEARSYSTEM_PRECONDITIONERS_H
+
+#include <Core/Datatypes/MatrixFwd.h>
+#include <Eigen/Core>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+  /// Approximation of A^-1 that is built once per matrix and then applied to
+  /// whole blocks of vectors, so every right-hand side shares each sweep.
+  class SCISHARE LinearSystemPreconditioner : boost::noncopyable
+  {
+  public:
+    virtual ~LinearSystemPreconditioner() {}
+    /// Z = M^-1 R for all columns of R.
+    virtual void apply(const Eigen::MatrixXd& R, Eigen::MatrixXd& Z) const = 0;
+    /// Single precision version for mixed precision solves. The default rounds
+    /// through apply(); preconditioners that keep a float copy of their data
+    /// override it.
+    virtual void applySingle(const Eigen::MatrixXf& R, Eigen::MatrixXf& Z) const;
+    /// Memory held for applySingle on top of the double precision data.
+    virtual size_t singlePrecisionBytes() const { return 0; }
+    virtual std::string name() const = 0;
+  };
+
+  typedef boost::shared_ptr<LinearSystemPreconditioner> LinearSystemPreconditionerHandle;
+
+  class SCISHARE PreconditionerFactory
+  {
+  public:
+    /// Known names: None, Jacobi, IncompleteCholesky (IC(0), symmetric positive
+    /// definite A only), ILU0 and AMG (smoothed aggregation, symmetric A).
+    static LinearSystemPreconditionerHandle create(const std::string& name, Datatypes::SparseRowMatrixHandle A);
+    static bool isKnown(const std::string& name);
+  };
+
+}}}}
+
+#endif
@@ -32,6 +32,7 @@
 
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Algorithms/Math/LinearSystem/BlockKrylovSolver.h>
 #include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
@@ -39,19 +40,25 @@
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
+#include <iomanip>
 
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Math;
 using namespace SCIRun::Core::Datatypes;
 
+ALGORITHM_PARAMETER_DEF(Math, MatrixLayout);
+ALGORITHM_PARAMETER_DEF(Math, BlockMemoryMegabytes);
+
 SolveLinearSystemAlgo::SolveLinearSystemAlgo()
 {
   // For solver
-  addOption(Variables::Method,"cg","jacobi|cg|bicg|minres");
-  addOption(Variables::Preconditioner,"Jacobi","None|Jacobi");
+  addOption(Variables::Method,"cg","jacobi|cg|bicg|minres|gmres|mixedcg");
+  addOption(Variables::Preconditioner,"Jacobi","None|Jacobi|IncompleteCholesky|ILU0|AMG");
+  addOption(Parameters::MatrixLayout,"CSR","CSR|SlicedEllpack");
 
   addParameter(Variables::TargetError, 1e-5);
   addParameter(Variables::MaxIterations, 500);
+  addParameter(Parameters::BlockMemoryMegabytes, static_cast<int>(BlockKrylovSolver::DefaultMemoryLimit >> 20));
 
   addParameter(Variables::BuildConvergence, true);
 
@@ -88,6 +95,8 @@ SolveLinearSystemParallelAlgo::SolveLinearSystemParallelAlgo(const AlgorithmBase
   pre_conditioner_(base->getOption(Variables::Preconditioner)),
   convergence_(new DenseColumnMatrix(base->get(Variables::MaxIterations).toInt()))
 {
+  if (base->getOption(Parameters::MatrixLayout) == "SlicedEllpack")
+    setSparseMatrixLayout(SparseMatrixLayout::SlicedEllpack);
 }
 
 bool
@@ -256,8 +265,7 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
       return true;
     }
 
-    PLA.mult(R,DIAG,Z);
-    double bknum = PLA.dot(Z,R);
+    double bknum = PLA.mult_dot(R,DIAG,Z);
 
     if (niter == 0)
     {
@@ -268,16 +276,13 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
       double bk = bknum/bkden;
       PLA.scale_add(bk,P,Z,P);
     }
-    PLA.mult(A,P,Z);
+    double akden = PLA.mult_dot(A,P,Z);
     bkden = bknum;
 
-    double akden = PLA.dot(Z,P);
     double ak=bknum/akden;
 
     PLA.scale_add(ak,P,X,X);
-    PLA.scale_add(-ak,Z,R,R);
-
-    error = PLA.norm(R)/bnorm;
+    error = PLA.scale_add_norm(-ak,Z,R,R)/bnorm;
     if (error < xmin)
     {
       PLA.copy(X,XMIN);
@@ -1145,6 +1150,15 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
     THROW_ALGORITHM_INPUT_ERROR("Matrix A and x0 do not have the same number of rows");
   }
 
+  if (needsBlockSolver() || getOption(Variables::Method) == "mixedcg")
+  {
+    DenseMatrixHandle X;
+    if (!run(A, boost::make_shared<DenseMatrix>(*b), boost::make_shared<DenseMatrix>(*x0), X))
+      return false;
+    x = boost::make_shared<DenseColumnMatrix>(X->col(0));
+    return true;
+  }
+
   std::string method = getOption(Variables::Method);
 
   DenseColumnMatrixHandle conv;
@@ -1200,10 +1214,174 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
   return true;
 }
 
+bool SolveLinearSystemAlgo::needsBlockSolver() const
+{
+  // the threaded solvers only know diagonal preconditioning
+  auto preconditioner = getOption(Variables::Preconditioner);
+  return getOption(Variables::Method) == "gmres" || (preconditioner != "None" && preconditioner != "Jacobi");
+}
+
+LinearSystemPreconditionerHandle SolveLinearSystemAlgo::preconditionerFor(SparseRowMatrixHandle A) const
+{
+  auto name = getOption(Variables::Preconditioner);
+  if (!preconditioner_ || preconditioner_->name() != name || preconditionedMatrix_.lock() != A)
+  {
+    preconditioner_ = PreconditionerFactory::create(name, A);
+    preconditionedMatrix_ = A;
+  }
+  else
+  {
+    remark("Reusing " + name + " preconditioner");
+  }
+  return preconditioner_;
+}
+
+bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
+                           DenseMatrixHandle B,
+                           DenseMatrixHandle x0,
+                           DenseMatrixHandle& x) const
+{
+  ScopedAlgorithmStatusReporter ssr(this, "SolveLinearSystem");
+  ENSURE_ALGORITHM_INPUT_NOT_NULL(A, "No matrix A is given");
+  ENSURE_ALGORITHM_INPUT_NOT_NULL(B, "No matrix b is given");
+
+  double tolerance = get(Variables::TargetError).toDouble();
+  int maxIterations = get(Variables::MaxIterations).toInt();
+  ENSURE_POSITIVE_DOUBLE(tolerance, "Tolerance out of range!");
+  ENSURE_POSITIVE_INT(maxIterations, "Max iterations out of range!");
+
+  if (A->nrows() != A->ncols())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix A is not square");
+  }
+
+  if (A->nrows() != B->nrows())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix A and b do not have the same number of rows");
+  }
+
+  if (x0 && (x0->nrows() != B->nrows() || x0->ncols() != B->ncols()))
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix x0 and b need to have the same dimensions");
+  }
+
+  std::string method = getOption(Variables::Method);
+  if (method != "cg" && method != "gmres" && method != "mixedcg")
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Several right-hand sides or incomplete factorization/AMG preconditioners need the cg, gmres or mixedcg method");
+  }
+
+  // DenseMatrix is row major, the solver works on contiguous columns
+  const Eigen::MatrixXd rhs = *B;
+  Eigen::MatrixXd solution = x0 ? Eigen::MatrixXd(*x0) : Eigen::MatrixXd::Zero(B->nrows(), B->ncols());
+
+  if (method == "mixedcg")
+  {
+    if (runMixedPrecision(A, rhs, solution))
+    {
+      x = boost::make_shared<DenseMatrix>(solution);
+      update_progress(1);
+      return true;
+    }
+    // columns that already converged leave the block CG right away
+    remark("Mixed precision solve did not reach the target error, continuing with double precision CG");
+    method = "cg";
+  }
+
+  auto M = preconditionerFor(A);
+  const size_t memoryLimit = static_cast<size_t>(std::max(1, get(Parameters::BlockMemoryMegabytes).toInt())) << 20;
+  BlockKrylovSolver solver(tolerance, maxIterations, memoryLimit);
+  auto result = method == "cg" ? solver.solveCG(*A, *M, rhs, solution) : solver.solveGMRES(*A, *M, rhs, solution);
+  x = boost::make_shared<DenseMatrix>(solution);
+
+  std::ostringstream ostr;
+  ostr << "Block " << method << " solved " << B->ncols() << " right-hand side(s) in " << result.iterations << " iterations";
+  remark(ostr.str());
+  if (!result.converged)
+  {
+    auto worst = *std::max_element(result.residuals.begin(), result.residuals.end());
+    warning("Not all right-hand sides reached the target error, largest relative residual: " + std::to_string(worst));
+  }
+
+  update_progress(1);
+  return true;
+}
+
+bool SolveLinearSystemAlgo::runMixedPrecision(SparseRowMatrixHandle A, const Eigen::MatrixXd& B, Eigen::MatrixXd& X) const
+{
+  if (!MixedPrecisionSolver::supports(*A))
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix A has too many entries for the mixed precision solver");
+  }
+
+  const double tolerance = get(Variables::TargetError).toDouble();
+  const int maxIterations = get(Variables::MaxIterations).toInt();
+  auto M = preconditionerFor(A);
+  if (!mixedPrecisionSolver_ || mixedPrecisionMatrix_.lock() != A)
+  {
+    mixedPrecisionSolver_.reset(new MixedPrecisionSolver(*A));
+    mixedPrecisionMatrix_ = A;
+  }
+
+  const double doubleBytes = A->nonZeros() * (sizeof(double) + sizeof(index_type)) + (A->nrows() + 1) * sizeof(index_type);
+  const double extraBytes = mixedPrecisionSolver_->singlePrecisionBytes() + M->singlePrecisionBytes();
+  std::ostringstream memory;
+  memory << "Mixed precision copies of the matrix and preconditioner use " << std::fixed << std::setprecision(1)
+    << extraBytes / (1024 * 1024) << " MB (" << 100 * extraBytes / doubleBytes << "% of the double precision matrix)";
+  remark(memory.str());
+
+  bool converged = true;
+  for (Eigen::Index c = 0; c < B.cols(); ++c)
+  {
+    Eigen::VectorXd x = X.col(c);
+    auto result = mixedPrecisionSolver_->solve(*A, *M, B.col(c), x, tolerance, maxIterations);
+    if (!result.converged && result.iterations < maxIterations)
+    {
+      // float corrections stopped helping: finish in double precision from where they got
+      remark("Single precision corrections stalled at error " + std::to_string(result.residual) + ", continuing in double precision");
+      Eigen::MatrixXd column = x;
+      auto rest = BlockKrylovSolver(tolerance, maxIterations - result.iterations).solveCG(*A, *M, B.col(c), column);
+      x = column.col(0);
+      result.iterations += rest.iterations;
+      result.residual = rest.residuals.empty() ? result.residual : rest.residuals[0];
+      result.converged = rest.converged;
+    }
+    X.col(c) = x;
+
+    std::ostringstream ostr;
+    ostr << "Mixed precision CG: " << result.refinements << " refinement(s), " << result.iterations
+      << " iterations, error " << result.residual;
+    remark(ostr.str());
+    converged = converged && result.converged;
+  }
+
+  return converged;
+}
+
 AlgorithmOutput SolveLinearSystemAlgo::run(const AlgorithmInput& input) const
 {
   auto lhs = input.get<SparseRowMatrix>(Variables::LHS);
+  auto rhsMatrix = input.get<Matrix>(Variables::RHS);
+
+  AlgorithmOutput output;
+  if (rhsMatrix && rhsMatrix->ncols() > 1)
+  {
+    auto rhs = castMatrix::toDense(rhsMatrix);
+    if (!rhs)
+      rhs = convertMatrix::toDense(rhsMatrix);
+
+    DenseMatrixHandle solution;
+    if (!run(lhs, rhs, DenseMatrixHandle(), solution))
+    {
+      BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("SolveLinearSystem block solve returned false."));
+    }
+    output[Variables::Solution] = solution;
+    return output;
+  }
+
   auto rhs = input.get<DenseColumnMatrix>(Variables::RHS);
+  if (!rhs && rhsMatrix)
+    rhs = convertMatrix::toColumn(rhsMatrix);
 
   DenseColumnMatrixHandle solution;
 
@@ -1212,8 +1390,7 @@ AlgorithmOutput SolveLinearSystemAlgo::run(const AlgorithmInput& input) const
   {
     BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("SolveLinearSystem Algo returned false--need to improve error conditions so it throws before returning."));
   }
-  
-  AlgorithmOutput output;
+
   output[Variables::Solution] = boost::make_shared<DenseMatrix>(solution->col(0));
   return output;
 }
@@ -34,7 +34,10 @@
 #define CORE_ALGORITHMS_MATH_LINEARSYSTEM_SOLVELINEARSYSTEM_H
 
 #include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/Math/LinearSystem/Preconditioners.h>
+#include <Core/Algorithms/Math/LinearSystem/MixedPrecisionSolver.h>
 #include <Core/Datatypes/MatrixFwd.h>
+#include <boost/weak_ptr.hpp>
 #include <Core/Algorithms/Math/share.h>
 
 namespace SCIRun {
@@ -42,8 +45,17 @@ namespace Core {
 namespace Algorithms {
 namespace Math {
 
+  /// Storage of the system matrix in the threaded solvers: "CSR" or "SlicedEllpack".
+  ALGORITHM_PARAMETER_DECL(MatrixLayout);
+  /// Memory for the working vectors of a block solve; wider blocks are solved in column chunks.
+  ALGORITHM_PARAMETER_DECL(BlockMemoryMegabytes);
+
 // Solve a linear system in parallel using a standard iterative method
-// Method solves A*x = b, with x0 being the initializer for the solution
+// Method solves A*x = b, with x0 being the initializer for the solution.
+// A right-hand side with several columns is solved as one block, sharing each
+// sparse product and preconditioner sweep between the columns.
+// Method "mixedcg" solves with single precision CG inside double precision
+// iterative refinement, reaching the same target error.
 
 class SCISHARE SolveLinearSystemAlgo : public AlgorithmBase
 {
@@ -61,7 +73,26 @@ class SCISHARE SolveLinearSystemAlgo : public AlgorithmBase
              Datatypes::DenseColumnMatrixHandle x0, 
              Datatypes::DenseColumnMatrixHandle& x) const;
 
+    /// Block mode: solves A*X = B for every column of B (cg or gmres).
+    bool run(Datatypes::SparseRowMatrixHandle A,
+             Datatypes::DenseMatrixHandle B,
+             Datatypes::DenseMatrixHandle x0,
+             Datatypes::DenseMatrixHandle& x) const;
+
     AlgorithmOutput run(const AlgorithmInput& input) const;
+
+  private:
+    bool needsBlockSolver() const;
+    /// False when a column missed the target error; X keeps what was reached.
+    bool runMixedPrecision(Datatypes::SparseRowMatrixHandle A, const Eigen::MatrixXd& B,
+      Eigen::MatrixXd& X) const;
+    /// Built on first use and kept while the same matrix keeps coming in.
+    LinearSystemPreconditionerHandle preconditionerFor(Datatypes::SparseRowMatrixHandle A) const;
+
+    mutable boost::weak_ptr<Datatypes::SparseRowMatrix> preconditionedMatrix_;
+    mutable LinearSystemPreconditionerHandle preconditioner_;
+    mutable boost::weak_ptr<Datatypes::SparseRowMatrix> mixedPrecisionMatrix_;
+    mutable boost::shared_ptr<MixedPrecisionSolver> mixedPrecisionSolver_;
 };
 
 
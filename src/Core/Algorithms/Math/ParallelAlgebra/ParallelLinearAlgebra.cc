@@ -33,6 +33,7 @@
 ///////////////////////////
 
 #include <cfloat>
+#include <algorithm>
 
 #include <Core/Datatypes/Matrix.h>
 #include <Core/Datatypes/DenseColumnMatrix.h>
@@ -40,6 +41,8 @@
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
 #include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/SlicedEllpackMatrix.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/VectorKernels.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Thread/Parallel.h>
 
@@ -48,7 +51,7 @@ using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Thread;
 
-ParallelLinearAlgebraBase::ParallelLinearAlgebraBase()
+ParallelLinearAlgebraBase::ParallelLinearAlgebraBase() : layout_(SparseMatrixLayout::CSR)
 {}
 
 ParallelLinearAlgebraBase::~ParallelLinearAlgebraBase()
@@ -57,7 +60,8 @@ ParallelLinearAlgebraBase::~ParallelLinearAlgebraBase()
 ParallelLinearAlgebra::ParallelLinearAlgebra(ParallelLinearAlgebraSharedData& data, int proc)
   : data_(data),
   proc_(proc),
-  nproc_(data.numProcs())
+  nproc_(data.numProcs()),
+  kernels_(vectorKernels())
 {
   // Compute local size
   size_ = data.getSize();
@@ -68,7 +72,6 @@ ParallelLinearAlgebra::ParallelLinearAlgebra(ParallelLinearAlgebraSharedData& da
   end_   = (proc+1)*local_size_;
   if (proc == nproc_-1) end_ = size_;
   if (proc == nproc_-1) local_size_ = end_ - start_;
-  local_size16_ = (local_size_&(~0xf));
 
   // Set reduction buffers
   // To optimize performance we alternate buffers
@@ -140,187 +143,39 @@ bool ParallelLinearAlgebra::add_matrix(SparseRowMatrixHandle mat, ParallelMatrix
   M.n_ = mat->ncols();
   M.nnz_ = mat->nonZeros();
 
+  // Each thread packs only the rows it multiplies, so the copy is built in
+  // parallel and lands in memory local to the thread that uses it.
+  M.sliced_.reset();
+  if (data_.layout() == SparseMatrixLayout::SlicedEllpack && SlicedEllpackMatrix::supports(*mat))
+    M.sliced_ = boost::make_shared<SlicedEllpackMatrix>(*mat, start_, end_);
+
   return (true);
 }
 
-/// @todo: refactor duplication
-
 void ParallelLinearAlgebra::mult(const ParallelVector& a, const ParallelVector& b, ParallelVector& r)
 {
-  double* a_ptr = a.data_+start_;
-  double* b_ptr = b.data_+start_;
-  double* r_ptr = r.data_+start_;
-
-  size_t j = 0;
-  for (; j<local_size16_; j+=16)
-  {
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    *r_ptr = (*a_ptr)*(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-  }
+  kernels_.mult(a.data_+start_, b.data_+start_, r.data_+start_, local_size_);
 }
 
 void ParallelLinearAlgebra::add(const ParallelVector& a, const ParallelVector& b, ParallelVector& r)
 {
-  double* a_ptr = a.data_+start_;
-  double* b_ptr = b.data_+start_;
-  double* r_ptr = r.data_+start_;
-
-  size_t j = 0;
-  for (; j<local_size16_; j+=16)
-  {
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    *r_ptr = (*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-  }
+  kernels_.add(a.data_+start_, b.data_+start_, r.data_+start_, local_size_);
 }
 
 void ParallelLinearAlgebra::sub(const ParallelVector& a, const ParallelVector& b, ParallelVector& r)
 {
-  double* a_ptr = a.data_+start_;
-  double* b_ptr = b.data_+start_;
-  double* r_ptr = r.data_+start_;
-
-  size_t j = 0;
-  for (; j<local_size16_; j+=16)
-  {
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    *r_ptr = (*a_ptr)-(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-  }
+  kernels_.sub(a.data_+start_, b.data_+start_, r.data_+start_, local_size_);
 }
 
 void ParallelLinearAlgebra::copy(const ParallelVector& a, ParallelVector& r)
 {
-  double* a_ptr = a.data_+start_;
-  double* r_ptr = r.data_+start_;
-
-  size_t j=0;
-  for (; j<local_size16_; j+=16)
-  {
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    *r_ptr = *a_ptr; r_ptr++; a_ptr++;
-  }
+  if (a.data_ != r.data_)
+    std::copy(a.data_+start_, a.data_+end_, r.data_+start_);
 }
 
 void ParallelLinearAlgebra::scale(double s, ParallelVector& a, ParallelVector& r)
 {
-  double* a_ptr = a.data_+start_;
-  double* r_ptr = r.data_+start_;
-
-  size_t j=0;
-  for (; j<local_size16_; j+=16)
-  {
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    *r_ptr = s*(*a_ptr); r_ptr++; a_ptr++;
-  }
+  kernels_.scale(s, a.data_+start_, r.data_+start_, local_size_);
 }
 
 void ParallelLinearAlgebra::invert(ParallelVector& a, ParallelVector& r)
@@ -328,34 +183,8 @@ void ParallelLinearAlgebra::invert(ParallelVector& a, ParallelVector& r)
   double* a_ptr = a.data_+start_;
   double* r_ptr = r.data_+start_;
 
-  size_t j=0;
-  for (; j<local_size16_; j+=16)
-  {
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    *r_ptr = 1.0/(*a_ptr); r_ptr++; a_ptr++;
-  }
+  for (size_t j=0; j<local_size_; j++)
+    r_ptr[j] = 1.0/a_ptr[j];
 }
 
 void ParallelLinearAlgebra::threshold_invert(ParallelVector& a, ParallelVector& r,double threshold)
@@ -386,184 +215,37 @@ void ParallelLinearAlgebra::absthreshold_invert(const ParallelVector& a, Paralle
 
 void ParallelLinearAlgebra::scale_add(double s, const ParallelVector& a, const ParallelVector& b, ParallelVector& r)
 {
-  double* a_ptr = a.data_+start_;
-  double* b_ptr = b.data_+start_;
-  double* r_ptr = r.data_+start_;
-
-  size_t j=0;
-  for (; j<local_size16_; j+=16)
-  {
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    *r_ptr = s*(*a_ptr)+(*b_ptr); r_ptr++; a_ptr++; b_ptr++;
-  }
+  kernels_.scale_add(s, a.data_+start_, b.data_+start_, r.data_+start_, local_size_);
 }
 
 double ParallelLinearAlgebra::dot(const ParallelVector& a, const ParallelVector& b)
 {
-  double* a_ptr = a.data_+start_;
-  double* b_ptr = b.data_+start_;
-
-  double val = 0.0;
-  size_t j=0;
-  for (; j<local_size16_; j+=16)
-  {
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    val += (*a_ptr)*(*b_ptr); b_ptr++; a_ptr++;
-  }
-
-  return(reduce_sum(val));
+  return(reduce_sum(kernels_.dot(a.data_+start_, b.data_+start_, local_size_)));
 }
 
 void ParallelLinearAlgebra::zeros(ParallelVector& a)
 {
-  double* a_ptr = a.data_+start_;
-
-  size_t j=0;
-
-  for (; j<local_size16_; j+=16)
-  {
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-    (*a_ptr) = 0.0; a_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    (*a_ptr) = 0.0; a_ptr++;
-  }
+  std::fill(a.data_+start_, a.data_+end_, 0.0);
 }
 
 void ParallelLinearAlgebra::ones(ParallelVector& a)
 {
-  double* a_ptr = a.data_+start_;
-
-  size_t j=0;
-
-  for (; j<local_size16_; j+=16)
-  {
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-    (*a_ptr) = 1.0; a_ptr++;
-  }
-
-  for (; j<local_size_; j++)
-  {
-    (*a_ptr) = 1.0; a_ptr++;
-  }
+  std::fill(a.data_+start_, a.data_+end_, 1.0);
 }
 
 double ParallelLinearAlgebra::norm(const ParallelVector& a)
 {
-  double* a_ptr = a.data_+start_;
-
-  double val = 0.0;
-  size_t j=0;
-
-  for (; j<local_size16_; j+=16)
-  {
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-  }
+  return(sqrt(reduce_sum(kernels_.norm2(a.data_+start_, local_size_))));
+}
 
-  for (; j<local_size_; j++)
-  {
-    val += (*a_ptr)*(*a_ptr); a_ptr++;
-  }
+double ParallelLinearAlgebra::mult_dot(const ParallelVector& a, const ParallelVector& b, ParallelVector& r)
+{
+  return(reduce_sum(kernels_.mult_dot(a.data_+start_, b.data_+start_, r.data_+start_, local_size_)));
+}
 
-  return(sqrt(reduce_sum(val)));
+double ParallelLinearAlgebra::scale_add_norm(double s, const ParallelVector& a, const ParallelVector& b, ParallelVector& r)
+{
+  return(sqrt(reduce_sum(kernels_.scale_add_norm2(s, a.data_+start_, b.data_+start_, r.data_+start_, local_size_))));
 }
 
 /// @todo: refactor to use algorithm
@@ -629,24 +311,22 @@ void ParallelLinearAlgebra::mult(const ParallelMatrix& a, const ParallelVector&
 {
   wait();
 
-  double* idata = b.data_;
-  double* odata = r.data_;
+  if (a.sliced_)
+    kernels_.sell_mult(*a.sliced_, b.data_, r.data_);
+  else
+    kernels_.csr_mult(a.rows_, a.columns_, a.data_, b.data_, r.data_, start_, end_);
+}
 
-  double* data = a.data_;
-  auto rows = a.rows_;
-  auto columns = a.columns_;
+double ParallelLinearAlgebra::mult_dot(const ParallelMatrix& a, const ParallelVector& b, ParallelVector& r)
+{
+  wait();
 
-  for(size_t i=start_;i<end_;i++)
-  {
-    double sum = 0.0;
-    index_type row_idx = rows[i];
-    index_type next_idx = rows[i+1];
-    for(index_type j=row_idx;j<next_idx;j++)
-    {
-	    sum+=data[j]*idata[columns[j]];
-    }
-    odata[i]=sum;
-  }
+  double val;
+  if (a.sliced_)
+    val = kernels_.sell_mult_dot(*a.sliced_, b.data_, r.data_);
+  else
+    val = kernels_.csr_mult_dot(a.rows_, a.columns_, a.data_, b.data_, r.data_, start_, end_);
+  return(reduce_sum(val));
 }
 
 void ParallelLinearAlgebra::mult_trans(ParallelMatrix& a, ParallelVector& b, ParallelVector& r)
@@ -785,7 +465,7 @@ bool ParallelLinearAlgebraBase::start_parallel(SolverInputs& matrices, int nproc
     nproc = Parallel::NumCores();
   }
 
-  ParallelLinearAlgebraSharedData sharedData(matrices, nproc);
+  ParallelLinearAlgebraSharedData sharedData(matrices, nproc, layout_);
 
   auto task_i = [&sharedData, this](int i) { run_parallel(sharedData, i); };
   Parallel::RunTasks(task_i, nproc);
@@ -799,12 +479,13 @@ void ParallelLinearAlgebraBase::run_parallel(ParallelLinearAlgebraSharedData& da
   data.setFlag(proc, parallel(PLA, data.inputs()));
 }
 
-ParallelLinearAlgebraSharedData::ParallelLinearAlgebraSharedData(const SolverInputs& inputs, int numProcs) :
+ParallelLinearAlgebraSharedData::ParallelLinearAlgebraSharedData(const SolverInputs& inputs, int numProcs, SparseMatrixLayout layout) :
   size_(inputs.A->nrows()),
   success_(numProcs),
   imatrices_(inputs),
   barrier_("Parallel Linear Algebra", numProcs),
   numProcs_(numProcs),
+  layout_(layout),
   reduce1_(numProcs),
   reduce2_(numProcs)
 {
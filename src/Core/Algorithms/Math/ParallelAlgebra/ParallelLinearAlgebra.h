@@ -36,6 +36,7 @@
 #include <vector>
 #include <list>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 #include <Core/Datatypes/MatrixFwd.h>
 #include <Core/Thread/Barrier.h>
 #include <Core/Datatypes/Legacy/Base/Types.h>
@@ -47,7 +48,18 @@ namespace Algorithms {
 namespace Math {
 
   class ParallelLinearAlgebra;
-  
+  class SlicedEllpackMatrix;
+  struct VectorKernels;
+
+  /// Storage the solver threads use for the system matrix. CSR multiplies the
+  /// input matrix in place; SlicedEllpack gives every thread a SELL-C-sigma copy
+  /// of its rows, which vectorizes better for short, irregular rows.
+  enum class SparseMatrixLayout
+  {
+    CSR,
+    SlicedEllpack
+  };
+
   struct SCISHARE SolverInputs
   {
     Datatypes::SparseRowMatrixHandle A;
@@ -67,8 +79,10 @@ namespace Math {
   class SCISHARE ParallelLinearAlgebraSharedData : boost::noncopyable
   {
   public:
-    explicit ParallelLinearAlgebraSharedData(const SolverInputs& inputs, int numProcs);
+    ParallelLinearAlgebraSharedData(const SolverInputs& inputs, int numProcs,
+      SparseMatrixLayout layout = SparseMatrixLayout::CSR);
     size_t getSize() const { return size_; }
+    SparseMatrixLayout layout() const { return layout_; }
     Datatypes::DenseColumnMatrixHandle getCurrentMatrix() const { return current_matrix_; }
     void setCurrentMatrix(Datatypes::DenseColumnMatrixHandle mat) { current_matrix_ = mat; }
     void addVector(Datatypes::DenseColumnMatrixHandle mat) { vectors_.push_back(mat); }
@@ -104,6 +118,7 @@ namespace Math {
     SolverInputs imatrices_;
     SCIRun::Core::Thread::Barrier barrier_;
     int numProcs_;
+    SparseMatrixLayout layout_;
     /// classes for communication
     std::vector<double> reduce1_;
     std::vector<double> reduce2_;
@@ -119,10 +134,13 @@ public:
   bool start_parallel(SolverInputs& matrices, int nproc = -1) const;
 
   virtual bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const = 0;
+
+  void setSparseMatrixLayout(SparseMatrixLayout layout) { layout_ = layout; }
   
 private:
   void run_parallel(ParallelLinearAlgebraSharedData& data, int proc) const;
   SolverInputs imatrices_;
+  SparseMatrixLayout layout_;
 };
 
 
@@ -145,6 +163,9 @@ public:
       size_t   m_;
       size_t   n_;
       size_t   nnz_;
+
+      /// This thread's rows in SELL-C-sigma form, when that layout is selected.
+      boost::shared_ptr<const SlicedEllpackMatrix> sliced_;
   };
       
   // Constructor
@@ -184,6 +205,14 @@ public:
   double max(const ParallelVector& a);
 
   void mult(const ParallelMatrix& a, const ParallelVector& b, ParallelVector& r);
+
+  // Fused operations for the Krylov solvers: one pass over memory instead of two.
+  // r = a.*b, returns dot(r,a)
+  double mult_dot(const ParallelVector& a, const ParallelVector& b, ParallelVector& r);
+  // r = a*b, returns dot(r,b)
+  double mult_dot(const ParallelMatrix& a, const ParallelVector& b, ParallelVector& r);
+  // r = s*a + b, returns norm(r)
+  double scale_add_norm(double s, const ParallelVector& a, const ParallelVector& b, ParallelVector& r);
   
   void absdiag(const ParallelMatrix& a, ParallelVector& r);
   
@@ -207,13 +236,13 @@ private:
 
   size_t size_;
   size_t local_size_;
-  size_t local_size16_;
   size_t start_;
   size_t end_;
     
   double* reduce_[2];
   int     reduce_buffer_;
 
+  const VectorKernels& kernels_;
  
 };
 
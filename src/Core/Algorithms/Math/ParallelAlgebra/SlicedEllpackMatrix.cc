@@ -0,0 +1,109 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Math/ParallelAlgebra/SlicedEllpackMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+
+SlicedEllpackMatrix::SlicedEllpackMatrix(const SparseRowMatrix& A, index_type beginRow, index_type endRow)
+  : beginRow_(beginRow), endRow_(endRow), nonZeros_(0)
+{
+  const index_type* outer = A.outerIndexPtr();
+  const index_type* inner = A.innerIndexPtr();
+  const double* data = A.valuePtr();
+  auto rowLength = [outer](index_type row) { return outer[row + 1] - outer[row]; };
+
+  const index_type numRows = endRow - beginRow;
+  rows_.resize(numRows);
+  std::iota(rows_.begin(), rows_.end(), beginRow);
+
+  // Sorting only within a window keeps the rows of a chunk close together, so
+  // the scattered stores of the result stay in cache.
+  for (index_type w = 0; w < numRows; w += SortWindow)
+  {
+    auto windowEnd = rows_.begin() + std::min(w + SortWindow, numRows);
+    std::stable_sort(rows_.begin() + w, windowEnd,
+      [&rowLength](index_type r1, index_type r2) { return rowLength(r1) > rowLength(r2); });
+  }
+
+  const size_t numChunks = (numRows + ChunkSize - 1) / ChunkSize;
+  chunkOffsets_.resize(numChunks + 1, 0);
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    index_type width = 0;
+    for (int l = 0; l < chunkRows(c); ++l)
+      width = std::max(width, rowLength(rows_[c*ChunkSize + l]));
+    chunkOffsets_[c+1] = chunkOffsets_[c] + width*ChunkSize;
+  }
+
+  values_.assign(chunkOffsets_.back(), 0.0);
+  columns_.assign(chunkOffsets_.back(), 0);
+  for (size_t c = 0; c < numChunks; ++c)
+  {
+    const size_t width = chunkWidth(c);
+    for (int l = 0; l < ChunkSize; ++l)
+    {
+      size_t slot = chunkOffsets_[c] + l;
+      if (l >= chunkRows(c))
+        continue;
+      const index_type row = rows_[c*ChunkSize + l];
+      const index_type length = rowLength(row);
+      int lastColumn = 0;
+      for (index_type k = 0; k < length; ++k, slot += ChunkSize)
+      {
+        lastColumn = static_cast<int>(inner[outer[row] + k]);
+        values_[slot] = data[outer[row] + k];
+        columns_[slot] = lastColumn;
+      }
+      // padding multiplies zero by an entry that is already in cache
+      for (size_t k = length; k < width; ++k, slot += ChunkSize)
+        columns_[slot] = lastColumn;
+      nonZeros_ += length;
+    }
+  }
+}
+
+bool SlicedEllpackMatrix::supports(const SparseRowMatrix& A)
+{
+  return A.ncols() <= std::numeric_limits<int>::max();
+}
+
+int SlicedEllpackMatrix::chunkRows(size_t c) const
+{
+  return static_cast<int>(std::min<index_type>(ChunkSize, endRow_ - beginRow_ - c*ChunkSize));
+}
+
+double SlicedEllpackMatrix::fillRatio() const
+{
+  return nonZeros_ > 0 ? static_cast<double>(values_.size()) / nonZeros_ : 1.0;
+}
@@ -0,0 +1,88 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_PARALLELALGEBRA_SLICEDELLPACKMATRIX_H
+#define CORE_ALGORITHMS_MATH_PARALLELALGEBRA_SLICEDELLPACKMATRIX_H
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <Core/Datatypes/MatrixFwd.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+  /// SELL-C-sigma copy of a contiguous block of rows of a sparse matrix.
+  /// Rows are sorted by length inside windows of SortWindow rows and packed in
+  /// chunks of ChunkSize rows; each chunk is stored column by column and padded
+  /// to its longest row, so one SIMD register covers the same entry of
+  /// ChunkSize rows. Column indices are 32 bit to save memory bandwidth.
+  class SCISHARE SlicedEllpackMatrix : boost::noncopyable
+  {
+  public:
+    static const int ChunkSize = 8;
+    static const index_type SortWindow = 256;
+
+    SlicedEllpackMatrix(const Datatypes::SparseRowMatrix& A, index_type beginRow, index_type endRow);
+
+    /// False when the column indices do not fit the 32 bit layout.
+    static bool supports(const Datatypes::SparseRowMatrix& A);
+
+    index_type beginRow() const { return beginRow_; }
+    index_type endRow() const { return endRow_; }
+    size_t numChunks() const { return chunkOffsets_.size() - 1; }
+    /// Stored entries, padding included, over the real non-zeros.
+    double fillRatio() const;
+
+    /// Entry k of chunk c for lane l sits at chunkOffset(c) + k*ChunkSize + l.
+    size_t chunkOffset(size_t c) const { return chunkOffsets_[c]; }
+    size_t chunkWidth(size_t c) const { return (chunkOffsets_[c+1] - chunkOffsets_[c]) / ChunkSize; }
+    /// Number of real rows in chunk c; only the last chunk may be partial.
+    int chunkRows(size_t c) const;
+
+    const double* values() const { return values_.data(); }
+    const int* columns() const { return columns_.data(); }
+    /// Original row index of each packed row.
+    const index_type* rows() const { return rows_.data(); }
+
+  private:
+    index_type beginRow_;
+    index_type endRow_;
+    size_t nonZeros_;
+    std::vector<size_t> chunkOffsets_;
+    std::vector<double> values_;
+    std::vector<int> columns_;
+    std::vector<index_type> rows_;
+  };
+
+}}}}
+
+#endif
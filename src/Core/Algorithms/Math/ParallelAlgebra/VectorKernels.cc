@@ -0,0 +1,904 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Math/ParallelAlgebra/VectorKernels.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/SlicedEllpackMatrix.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCIRUN_X86_SIMD_KERNELS
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and clang only emit AVX instructions in functions that ask for them, which
+// keeps the rest of the library runnable on any x86-64 CPU. MSVC accepts the
+// intrinsics anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define SCIRUN_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SCIRUN_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define SCIRUN_TARGET_AVX2
+#define SCIRUN_TARGET_AVX512
+#endif
+
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun;
+
+namespace
+{
+  const int Chunk = SlicedEllpackMatrix::ChunkSize;
+
+  namespace scalar
+  {
+    void mult(const double* a, const double* b, double* r, size_t n)
+    {
+      for (size_t j = 0; j < n; ++j) r[j] = a[j]*b[j];
+    }
+
+    void add(const double* a, const double* b, double* r, size_t n)
+    {
+      for (size_t j = 0; j < n; ++j) r[j] = a[j]+b[j];
+    }
+
+    void sub(const double* a, const double* b, double* r, size_t n)
+    {
+      for (size_t j = 0; j < n; ++j) r[j] = a[j]-b[j];
+    }
+
+    void scale(double s, const double* a, double* r, size_t n)
+    {
+      for (size_t j = 0; j < n; ++j) r[j] = s*a[j];
+    }
+
+    void scale_add(double s, const double* a, const double* b, double* r, size_t n)
+    {
+      for (size_t j = 0; j < n; ++j) r[j] = s*a[j]+b[j];
+    }
+
+    double dot(const double* a, const double* b, size_t n)
+    {
+      double val = 0.0;
+      for (size_t j = 0; j < n; ++j) val += a[j]*b[j];
+      return val;
+    }
+
+    double norm2(const double* a, size_t n)
+    {
+      return dot(a, a, n);
+    }
+
+    double mult_dot(const double* a, const double* b, double* r, size_t n)
+    {
+      double val = 0.0;
+      for (size_t j = 0; j < n; ++j)
+      {
+        r[j] = a[j]*b[j];
+        val += r[j]*a[j];
+      }
+      return val;
+    }
+
+    double scale_add_norm2(double s, const double* a, const double* b, double* r, size_t n)
+    {
+      double val = 0.0;
+      for (size_t j = 0; j < n; ++j)
+      {
+        r[j] = s*a[j]+b[j];
+        val += r[j]*r[j];
+      }
+      return val;
+    }
+
+    double csr_mult_dot(const index_type* rows, const index_type* columns, const double* data,
+      const double* x, double* y, size_t begin, size_t end)
+    {
+      double val = 0.0;
+      for (size_t i = begin; i < end; ++i)
+      {
+        double sum = 0.0;
+        for (index_type j = rows[i]; j < rows[i+1]; ++j)
+          sum += data[j]*x[columns[j]];
+        y[i] = sum;
+        val += sum*x[i];
+      }
+      return val;
+    }
+
+    void csr_mult(const index_type* rows, const index_type* columns, const double* data,
+      const double* x, double* y, size_t begin, size_t end)
+    {
+      csr_mult_dot(rows, columns, data, x, y, begin, end);
+    }
+
+    double sell_mult_dot(const SlicedEllpackMatrix& a, const double* x, double* y)
+    {
+      const double* values = a.values();
+      const int* columns = a.columns();
+      const index_type* rows = a.rows();
+      double val = 0.0;
+      for (size_t c = 0; c < a.numChunks(); ++c)
+      {
+        double sum[Chunk] = { 0 };
+        const size_t width = a.chunkWidth(c);
+        size_t slot = a.chunkOffset(c);
+        for (size_t k = 0; k < width; ++k, slot += Chunk)
+          for (int l = 0; l < Chunk; ++l)
+            sum[l] += values[slot+l]*x[columns[slot+l]];
+        for (int l = 0; l < a.chunkRows(c); ++l)
+        {
+          const index_type row = rows[c*Chunk + l];
+          y[row] = sum[l];
+          val += sum[l]*x[row];
+        }
+      }
+      return val;
+    }
+
+    void sell_mult(const SlicedEllpackMatrix& a, const double* x, double* y)
+    {
+      sell_mult_dot(a, x, y);
+    }
+
+    void scale_add_single(float s, const float* a, const float* b, float* r, size_t n)
+    {
+      for (size_t j = 0; j < n; ++j) r[j] = s*a[j]+b[j];
+    }
+
+    double scale_add_norm2_single(float s, const float* a, const float* b, float* r, size_t n)
+    {
+      double val = 0.0;
+      for (size_t j = 0; j < n; ++j)
+      {
+        r[j] = s*a[j]+b[j];
+        val += static_cast<double>(r[j])*r[j];
+      }
+      return val;
+    }
+
+    double dot_single(const float* a, const float* b, size_t n)
+    {
+      double val = 0.0;
+      for (size_t j = 0; j < n; ++j) val += static_cast<double>(a[j])*b[j];
+      return val;
+    }
+
+    double csr_mult_dot_single(const int* rows, const int* columns, const float* data,
+      const float* x, float* y, size_t begin, size_t end)
+    {
+      double val = 0.0;
+      for (size_t i = begin; i < end; ++i)
+      {
+        float sum = 0.0f;
+        for (int j = rows[i]; j < rows[i+1]; ++j)
+          sum += data[j]*x[columns[j]];
+        y[i] = sum;
+        val += static_cast<double>(sum)*x[i];
+      }
+      return val;
+    }
+  }
+
+#ifdef SCIRUN_X86_SIMD_KERNELS
+  static_assert(sizeof(index_type) == 8, "CSR gathers use 64 bit column indices");
+
+  namespace avx2
+  {
+    SCIRUN_TARGET_AVX2 inline double hsum(__m256d v)
+    {
+      __m128d lo = _mm256_castpd256_pd128(v);
+      __m128d hi = _mm256_extractf128_pd(v, 1);
+      lo = _mm_add_pd(lo, hi);
+      return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+
+    SCIRUN_TARGET_AVX2 void mult(const double* a, const double* b, double* r, size_t n)
+    {
+      size_t j = 0;
+      for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(r+j, _mm256_mul_pd(_mm256_loadu_pd(a+j), _mm256_loadu_pd(b+j)));
+      for (; j < n; ++j) r[j] = a[j]*b[j];
+    }
+
+    SCIRUN_TARGET_AVX2 void add(const double* a, const double* b, double* r, size_t n)
+    {
+      size_t j = 0;
+      for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(r+j, _mm256_add_pd(_mm256_loadu_pd(a+j), _mm256_loadu_pd(b+j)));
+      for (; j < n; ++j) r[j] = a[j]+b[j];
+    }
+
+    SCIRUN_TARGET_AVX2 void sub(const double* a, const double* b, double* r, size_t n)
+    {
+      size_t j = 0;
+      for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(r+j, _mm256_sub_pd(_mm256_loadu_pd(a+j), _mm256_loadu_pd(b+j)));
+      for (; j < n; ++j) r[j] = a[j]-b[j];
+    }
+
+    SCIRUN_TARGET_AVX2 void scale(double s, const double* a, double* r, size_t n)
+    {
+      const __m256d sv = _mm256_set1_pd(s);
+      size_t j = 0;
+      for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(r+j, _mm256_mul_pd(sv, _mm256_loadu_pd(a+j)));
+      for (; j < n; ++j) r[j] = s*a[j];
+    }
+
+    SCIRUN_TARGET_AVX2 void scale_add(double s, const double* a, const double* b, double* r, size_t n)
+    {
+      const __m256d sv = _mm256_set1_pd(s);
+      size_t j = 0;
+      for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(r+j, _mm256_fmadd_pd(sv, _mm256_loadu_pd(a+j), _mm256_loadu_pd(b+j)));
+      for (; j < n; ++j) r[j] = s*a[j]+b[j];
+    }
+
+    // Four independent accumulators hide the latency of the dependent adds.
+    SCIRUN_TARGET_AVX2 double dot(const double* a, const double* b, size_t n)
+    {
+      __m256d acc0 = _mm256_setzero_pd(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+      size_t j = 0;
+      for (; j + 16 <= n; j += 16)
+      {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a+j), _mm256_loadu_pd(b+j), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a+j+4), _mm256_loadu_pd(b+j+4), acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(a+j+8), _mm256_loadu_pd(b+j+8), acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(a+j+12), _mm256_loadu_pd(b+j+12), acc3);
+      }
+      for (; j + 4 <= n; j += 4)
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a+j), _mm256_loadu_pd(b+j), acc0);
+      double val = hsum(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)));
+      for (; j < n; ++j) val += a[j]*b[j];
+      return val;
+    }
+
+    SCIRUN_TARGET_AVX2 double norm2(const double* a, size_t n)
+    {
+      return dot(a, a, n);
+    }
+
+    SCIRUN_TARGET_AVX2 double mult_dot(const double* a, const double* b, double* r, size_t n)
+    {
+      __m256d acc0 = _mm256_setzero_pd(), acc1 = acc0;
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+      {
+        __m256d a0 = _mm256_loadu_pd(a+j), a1 = _mm256_loadu_pd(a+j+4);
+        __m256d r0 = _mm256_mul_pd(a0, _mm256_loadu_pd(b+j));
+        __m256d r1 = _mm256_mul_pd(a1, _mm256_loadu_pd(b+j+4));
+        _mm256_storeu_pd(r+j, r0);
+        _mm256_storeu_pd(r+j+4, r1);
+        acc0 = _mm256_fmadd_pd(r0, a0, acc0);
+        acc1 = _mm256_fmadd_pd(r1, a1, acc1);
+      }
+      double val = hsum(_mm256_add_pd(acc0, acc1));
+      for (; j < n; ++j)
+      {
+        r[j] = a[j]*b[j];
+        val += r[j]*a[j];
+      }
+      return val;
+    }
+
+    SCIRUN_TARGET_AVX2 double scale_add_norm2(double s, const double* a, const double* b, double* r, size_t n)
+    {
+      const __m256d sv = _mm256_set1_pd(s);
+      __m256d acc0 = _mm256_setzero_pd(), acc1 = acc0;
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+      {
+        __m256d r0 = _mm256_fmadd_pd(sv, _mm256_loadu_pd(a+j), _mm256_loadu_pd(b+j));
+        __m256d r1 = _mm256_fmadd_pd(sv, _mm256_loadu_pd(a+j+4), _mm256_loadu_pd(b+j+4));
+        _mm256_storeu_pd(r+j, r0);
+        _mm256_storeu_pd(r+j+4, r1);
+        acc0 = _mm256_fmadd_pd(r0, r0, acc0);
+        acc1 = _mm256_fmadd_pd(r1, r1, acc1);
+      }
+      double val = hsum(_mm256_add_pd(acc0, acc1));
+      for (; j < n; ++j)
+      {
+        r[j] = s*a[j]+b[j];
+        val += r[j]*r[j];
+      }
+      return val;
+    }
+
+    SCIRUN_TARGET_AVX2 inline double csr_row(const index_type* columns, const double* data,
+      const double* x, index_type j, index_type next)
+    {
+      __m256d acc = _mm256_setzero_pd();
+      for (; j + 4 <= next; j += 4)
+      {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns+j));
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(data+j),
+          _mm256_i64gather_pd(x, idx, sizeof(double)), acc);
+      }
+      double sum = hsum(acc);
+      for (; j < next; ++j) sum += data[j]*x[columns[j]];
+      return sum;
+    }
+
+    SCIRUN_TARGET_AVX2 void csr_mult(const index_type* rows, const index_type* columns, const double* data,
+      const double* x, double* y, size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+        y[i] = csr_row(columns, data, x, rows[i], rows[i+1]);
+    }
+
+    SCIRUN_TARGET_AVX2 double csr_mult_dot(const index_type* rows, const index_type* columns, const double* data,
+      const double* x, double* y, size_t begin, size_t end)
+    {
+      double val = 0.0;
+      for (size_t i = begin; i < end; ++i)
+      {
+        y[i] = csr_row(columns, data, x, rows[i], rows[i+1]);
+        val += y[i]*x[i];
+      }
+      return val;
+    }
+
+    // A chunk of eight rows is processed as two four-lane halves.
+    SCIRUN_TARGET_AVX2 double sell_mult_dot(const SlicedEllpackMatrix& a, const double* x, double* y)
+    {
+      const double* values = a.values();
+      const int* columns = a.columns();
+      const index_type* rows = a.rows();
+      double val = 0.0;
+      for (size_t c = 0; c < a.numChunks(); ++c)
+      {
+        __m256d acc0 = _mm256_setzero_pd(), acc1 = acc0;
+        const size_t width = a.chunkWidth(c);
+        size_t slot = a.chunkOffset(c);
+        for (size_t k = 0; k < width; ++k, slot += Chunk)
+        {
+          __m128i idx0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns+slot));
+          __m128i idx1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns+slot+4));
+          acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(values+slot), _mm256_i32gather_pd(x, idx0, sizeof(double)), acc0);
+          acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(values+slot+4), _mm256_i32gather_pd(x, idx1, sizeof(double)), acc1);
+        }
+        double sum[Chunk];
+        _mm256_storeu_pd(sum, acc0);
+        _mm256_storeu_pd(sum+4, acc1);
+        for (int l = 0; l < a.chunkRows(c); ++l)
+        {
+          const index_type row = rows[c*Chunk + l];
+          y[row] = sum[l];
+          val += sum[l]*x[row];
+        }
+      }
+      return val;
+    }
+
+    SCIRUN_TARGET_AVX2 void sell_mult(const SlicedEllpackMatrix& a, const double* x, double* y)
+    {
+      sell_mult_dot(a, x, y);
+    }
+
+    SCIRUN_TARGET_AVX2 inline __m256d lowToDouble(__m256 v)
+    {
+      return _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+    }
+
+    SCIRUN_TARGET_AVX2 inline __m256d highToDouble(__m256 v)
+    {
+      return _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+    }
+
+    SCIRUN_TARGET_AVX2 void scale_add_single(float s, const float* a, const float* b, float* r, size_t n)
+    {
+      const __m256 sv = _mm256_set1_ps(s);
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(r+j, _mm256_fmadd_ps(sv, _mm256_loadu_ps(a+j), _mm256_loadu_ps(b+j)));
+      for (; j < n; ++j) r[j] = s*a[j]+b[j];
+    }
+
+    SCIRUN_TARGET_AVX2 double scale_add_norm2_single(float s, const float* a, const float* b, float* r, size_t n)
+    {
+      const __m256 sv = _mm256_set1_ps(s);
+      __m256d acc0 = _mm256_setzero_pd(), acc1 = acc0;
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+      {
+        __m256 rv = _mm256_fmadd_ps(sv, _mm256_loadu_ps(a+j), _mm256_loadu_ps(b+j));
+        _mm256_storeu_ps(r+j, rv);
+        __m256d lo = lowToDouble(rv), hi = highToDouble(rv);
+        acc0 = _mm256_fmadd_pd(lo, lo, acc0);
+        acc1 = _mm256_fmadd_pd(hi, hi, acc1);
+      }
+      double val = hsum(_mm256_add_pd(acc0, acc1));
+      for (; j < n; ++j)
+      {
+        r[j] = s*a[j]+b[j];
+        val += static_cast<double>(r[j])*r[j];
+      }
+      return val;
+    }
+
+    SCIRUN_TARGET_AVX2 double dot_single(const float* a, const float* b, size_t n)
+    {
+      __m256d acc0 = _mm256_setzero_pd(), acc1 = acc0;
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+      {
+        __m256 av = _mm256_loadu_ps(a+j), bv = _mm256_loadu_ps(b+j);
+        acc0 = _mm256_fmadd_pd(lowToDouble(av), lowToDouble(bv), acc0);
+        acc1 = _mm256_fmadd_pd(highToDouble(av), highToDouble(bv), acc1);
+      }
+      double val = hsum(_mm256_add_pd(acc0, acc1));
+      for (; j < n; ++j) val += static_cast<double>(a[j])*b[j];
+      return val;
+    }
+
+    SCIRUN_TARGET_AVX2 inline float csr_row_single(const int* columns, const float* data,
+      const float* x, int j, int next)
+    {
+      __m256 acc = _mm256_setzero_ps();
+      for (; j + 8 <= next; j += 8)
+      {
+        __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns+j));
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(data+j), _mm256_i32gather_ps(x, idx, sizeof(float)), acc);
+      }
+      __m128 q = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+      q = _mm_add_ps(q, _mm_movehl_ps(q, q));
+      float sum = _mm_cvtss_f32(_mm_add_ss(q, _mm_movehdup_ps(q)));
+      for (; j < next; ++j) sum += data[j]*x[columns[j]];
+      return sum;
+    }
+
+    SCIRUN_TARGET_AVX2 double csr_mult_dot_single(const int* rows, const int* columns, const float* data,
+      const float* x, float* y, size_t begin, size_t end)
+    {
+      double val = 0.0;
+      for (size_t i = begin; i < end; ++i)
+      {
+        y[i] = csr_row_single(columns, data, x, rows[i], rows[i+1]);
+        val += static_cast<double>(y[i])*x[i];
+      }
+      return val;
+    }
+  }
+
+  namespace avx512
+  {
+    inline __mmask8 tailMask(size_t remaining)
+    {
+      return static_cast<__mmask8>((1u << remaining) - 1);
+    }
+
+    SCIRUN_TARGET_AVX512 inline double hsum(__m512d v)
+    {
+      __m256d lo = _mm512_castpd512_pd256(v);
+      __m256d hi = _mm512_extractf64x4_pd(v, 1);
+      lo = _mm256_add_pd(lo, hi);
+      __m128d q = _mm_add_pd(_mm256_castpd256_pd128(lo), _mm256_extractf128_pd(lo, 1));
+      return _mm_cvtsd_f64(_mm_add_sd(q, _mm_unpackhi_pd(q, q)));
+    }
+
+    SCIRUN_TARGET_AVX512 void mult(const double* a, const double* b, double* r, size_t n)
+    {
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(r+j, _mm512_mul_pd(_mm512_loadu_pd(a+j), _mm512_loadu_pd(b+j)));
+      if (j < n)
+      {
+        __mmask8 m = tailMask(n - j);
+        _mm512_mask_storeu_pd(r+j, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, a+j), _mm512_maskz_loadu_pd(m, b+j)));
+      }
+    }
+
+    SCIRUN_TARGET_AVX512 void add(const double* a, const double* b, double* r, size_t n)
+    {
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(r+j, _mm512_add_pd(_mm512_loadu_pd(a+j), _mm512_loadu_pd(b+j)));
+      if (j < n)
+      {
+        __mmask8 m = tailMask(n - j);
+        _mm512_mask_storeu_pd(r+j, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, a+j), _mm512_maskz_loadu_pd(m, b+j)));
+      }
+    }
+
+    SCIRUN_TARGET_AVX512 void sub(const double* a, const double* b, double* r, size_t n)
+    {
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(r+j, _mm512_sub_pd(_mm512_loadu_pd(a+j), _mm512_loadu_pd(b+j)));
+      if (j < n)
+      {
+        __mmask8 m = tailMask(n - j);
+        _mm512_mask_storeu_pd(r+j, m, _mm512_sub_pd(_mm512_maskz_loadu_pd(m, a+j), _mm512_maskz_loadu_pd(m, b+j)));
+      }
+    }
+
+    SCIRUN_TARGET_AVX512 void scale(double s, const double* a, double* r, size_t n)
+    {
+      const __m512d sv = _mm512_set1_pd(s);
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(r+j, _mm512_mul_pd(sv, _mm512_loadu_pd(a+j)));
+      if (j < n)
+      {
+        __mmask8 m = tailMask(n - j);
+        _mm512_mask_storeu_pd(r+j, m, _mm512_mul_pd(sv, _mm512_maskz_loadu_pd(m, a+j)));
+      }
+    }
+
+    SCIRUN_TARGET_AVX512 void scale_add(double s, const double* a, const double* b, double* r, size_t n)
+    {
+      const __m512d sv = _mm512_set1_pd(s);
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(r+j, _mm512_fmadd_pd(sv, _mm512_loadu_pd(a+j), _mm512_loadu_pd(b+j)));
+      if (j < n)
+      {
+        __mmask8 m = tailMask(n - j);
+        _mm512_mask_storeu_pd(r+j, m, _mm512_fmadd_pd(sv, _mm512_maskz_loadu_pd(m, a+j), _mm512_maskz_loadu_pd(m, b+j)));
+      }
+    }
+
+    SCIRUN_TARGET_AVX512 double dot(const double* a, const double* b, size_t n)
+    {
+      __m512d acc0 = _mm512_setzero_pd(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+      size_t j = 0;
+      for (; j + 32 <= n; j += 32)
+      {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a+j), _mm512_loadu_pd(b+j), acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a+j+8), _mm512_loadu_pd(b+j+8), acc1);
+        acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(a+j+16), _mm512_loadu_pd(b+j+16), acc2);
+        acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(a+j+24), _mm512_loadu_pd(b+j+24), acc3);
+      }
+      for (; j + 8 <= n; j += 8)
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a+j), _mm512_loadu_pd(b+j), acc0);
+      if (j < n)
+      {
+        __mmask8 m = tailMask(n - j);
+        acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, a+j), _mm512_maskz_loadu_pd(m, b+j), acc1);
+      }
+      return hsum(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)));
+    }
+
+    SCIRUN_TARGET_AVX512 double norm2(const double* a, size_t n)
+    {
+      return dot(a, a, n);
+    }
+
+    SCIRUN_TARGET_AVX512 double mult_dot(const double* a, const double* b, double* r, size_t n)
+    {
+      __m512d acc = _mm512_setzero_pd();
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+      {
+        __m512d av = _mm512_loadu_pd(a+j);
+        __m512d rv = _mm512_mul_pd(av, _mm512_loadu_pd(b+j));
+        _mm512_storeu_pd(r+j, rv);
+        acc = _mm512_fmadd_pd(rv, av, acc);
+      }
+      if (j < n)
+      {
+        __mmask8 m = tailMask(n - j);
+        __m512d av = _mm512_maskz_loadu_pd(m, a+j);
+        __m512d rv = _mm512_mul_pd(av, _mm512_maskz_loadu_pd(m, b+j));
+        _mm512_mask_storeu_pd(r+j, m, rv);
+        acc = _mm512_fmadd_pd(rv, av, acc);
+      }
+      return hsum(acc);
+    }
+
+    SCIRUN_TARGET_AVX512 double scale_add_norm2(double s, const double* a, const double* b, double* r, size_t n)
+    {
+      const __m512d sv = _mm512_set1_pd(s);
+      __m512d acc = _mm512_setzero_pd();
+      size_t j = 0;
+      for (; j + 8 <= n; j += 8)
+      {
+        __m512d rv = _mm512_fmadd_pd(sv, _mm512_loadu_pd(a+j), _mm512_loadu_pd(b+j));
+        _mm512_storeu_pd(r+j, rv);
+        acc = _mm512_fmadd_pd(rv, rv, acc);
+      }
+      if (j < n)
+      {
+        __mmask8 m = tailMask(n - j);
+        __m512d rv = _mm512_fmadd_pd(sv, _mm512_maskz_loadu_pd(m, a+j), _mm512_maskz_loadu_pd(m, b+j));
+        _mm512_mask_storeu_pd(r+j, m, rv);
+        acc = _mm512_fmadd_pd(rv, rv, acc);
+      }
+      return hsum(acc);
+    }
+
+    SCIRUN_TARGET_AVX512 inline double csr_row(const index_type* columns, const double* data,
+      const double* x, index_type j, index_type next)
+    {
+      __m512d acc = _mm512_setzero_pd();
+      for (; j + 8 <= next; j += 8)
+      {
+        __m512i idx = _mm512_loadu_si512(columns+j);
+        acc = _mm512_fmadd_pd(_mm512_loadu_pd(data+j), _mm512_i64gather_pd(idx, x, sizeof(double)), acc);
+      }
+      if (j < next)
+      {
+        __mmask8 m = tailMask(static_cast<size_t>(next - j));
+        __m512i idx = _mm512_maskz_loadu_epi64(m, columns+j);
+        __m512d xv = _mm512_mask_i64gather_pd(_mm512_setzero_pd(), m, idx, x, sizeof(double));
+        acc = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, data+j), xv, acc);
+      }
+      return hsum(acc);
+    }
+
+    SCIRUN_TARGET_AVX512 void csr_mult(const index_type* rows, const index_type* columns, const double* data,
+      const double* x, double* y, size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+        y[i] = csr_row(columns, data, x, rows[i], rows[i+1]);
+    }
+
+    SCIRUN_TARGET_AVX512 double csr_mult_dot(const index_type* rows, const index_type* columns, const double* data,
+      const double* x, double* y, size_t begin, size_t end)
+    {
+      double val = 0.0;
+      for (size_t i = begin; i < end; ++i)
+      {
+        y[i] = csr_row(columns, data, x, rows[i], rows[i+1]);
+        val += y[i]*x[i];
+      }
+      return val;
+    }
+
+    SCIRUN_TARGET_AVX512 double sell_mult_dot(const SlicedEllpackMatrix& a, const double* x, double* y)
+    {
+      const double* values = a.values();
+      const int* columns = a.columns();
+      const index_type* rows = a.rows();
+      double val = 0.0;
+      for (size_t c = 0; c < a.numChunks(); ++c)
+      {
+        __m512d acc = _mm512_setzero_pd();
+        const size_t width = a.chunkWidth(c);
+        size_t slot = a.chunkOffset(c);
+        for (size_t k = 0; k < width; ++k, slot += Chunk)
+        {
+          __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns+slot));
+          acc = _mm512_fmadd_pd(_mm512_loadu_pd(values+slot), _mm512_i32gather_pd(idx, x, sizeof(double)), acc);
+        }
+        double sum[Chunk];
+        _mm512_storeu_pd(sum, acc);
+        for (int l = 0; l < a.chunkRows(c); ++l)
+        {
+          const index_type row = rows[c*Chunk + l];
+          y[row] = sum[l];
+          val += sum[l]*x[row];
+        }
+      }
+      return val;
+    }
+
+    SCIRUN_TARGET_AVX512 void sell_mult(const SlicedEllpackMatrix& a, const double* x, double* y)
+    {
+      sell_mult_dot(a, x, y);
+    }
+
+    inline __mmask16 tailMask16(size_t remaining)
+    {
+      return static_cast<__mmask16>((1u << remaining) - 1);
+    }
+
+    SCIRUN_TARGET_AVX512 inline __m512d lowToDouble(__m512 v)
+    {
+      return _mm512_cvtps_pd(_mm512_castps512_ps256(v));
+    }
+
+    SCIRUN_TARGET_AVX512 inline __m512d highToDouble(__m512 v)
+    {
+      return _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1)));
+    }
+
+    SCIRUN_TARGET_AVX512 void scale_add_single(float s, const float* a, const float* b, float* r, size_t n)
+    {
+      const __m512 sv = _mm512_set1_ps(s);
+      size_t j = 0;
+      for (; j + 16 <= n; j += 16)
+        _mm512_storeu_ps(r+j, _mm512_fmadd_ps(sv, _mm512_loadu_ps(a+j), _mm512_loadu_ps(b+j)));
+      if (j < n)
+      {
+        __mmask16 m = tailMask16(n - j);
+        _mm512_mask_storeu_ps(r+j, m, _mm512_fmadd_ps(sv, _mm512_maskz_loadu_ps(m, a+j), _mm512_maskz_loadu_ps(m, b+j)));
+      }
+    }
+
+    SCIRUN_TARGET_AVX512 double scale_add_norm2_single(float s, const float* a, const float* b, float* r, size_t n)
+    {
+      const __m512 sv = _mm512_set1_ps(s);
+      __m512d acc0 = _mm512_setzero_pd(), acc1 = acc0;
+      size_t j = 0;
+      for (; j + 16 <= n; j += 16)
+      {
+        __m512 rv = _mm512_fmadd_ps(sv, _mm512_loadu_ps(a+j), _mm512_loadu_ps(b+j));
+        _mm512_storeu_ps(r+j, rv);
+        __m512d lo = lowToDouble(rv), hi = highToDouble(rv);
+        acc0 = _mm512_fmadd_pd(lo, lo, acc0);
+        acc1 = _mm512_fmadd_pd(hi, hi, acc1);
+      }
+      if (j < n)
+      {
+        __mmask16 m = tailMask16(n - j);
+        __m512 rv = _mm512_fmadd_ps(sv, _mm512_maskz_loadu_ps(m, a+j), _mm512_maskz_loadu_ps(m, b+j));
+        _mm512_mask_storeu_ps(r+j, m, rv);
+        __m512d lo = lowToDouble(rv), hi = highToDouble(rv);
+        acc0 = _mm512_fmadd_pd(lo, lo, acc0);
+        acc1 = _mm512_fmadd_pd(hi, hi, acc1);
+      }
+      return hsum(_mm512_add_pd(acc0, acc1));
+    }
+
+    SCIRUN_TARGET_AVX512 double dot_single(const float* a, const float* b, size_t n)
+    {
+      __m512d acc0 = _mm512_setzero_pd(), acc1 = acc0;
+      size_t j = 0;
+      for (; j + 16 <= n; j += 16)
+      {
+        __m512 av = _mm512_loadu_ps(a+j), bv = _mm512_loadu_ps(b+j);
+        acc0 = _mm512_fmadd_pd(lowToDouble(av), lowToDouble(bv), acc0);
+        acc1 = _mm512_fmadd_pd(highToDouble(av), highToDouble(bv), acc1);
+      }
+      if (j < n)
+      {
+        __mmask16 m = tailMask16(n - j);
+        __m512 av = _mm512_maskz_loadu_ps(m, a+j), bv = _mm512_maskz_loadu_ps(m, b+j);
+        acc0 = _mm512_fmadd_pd(lowToDouble(av), lowToDouble(bv), acc0);
+        acc1 = _mm512_fmadd_pd(highToDouble(av), highToDouble(bv), acc1);
+      }
+      return hsum(_mm512_add_pd(acc0, acc1));
+    }
+
+    SCIRUN_TARGET_AVX512 inline float csr_row_single(const int* columns, const float* data,
+      const float* x, int j, int next)
+    {
+      __m512 acc = _mm512_setzero_ps();
+      for (; j + 16 <= next; j += 16)
+      {
+        __m512i idx = _mm512_loadu_si512(columns+j);
+        acc = _mm512_fmadd_ps(_mm512_loadu_ps(data+j), _mm512_i32gather_ps(idx, x, sizeof(float)), acc);
+      }
+      if (j < next)
+      {
+        __mmask16 m = tailMask16(static_cast<size_t>(next - j));
+        __m512i idx = _mm512_maskz_loadu_epi32(m, columns+j);
+        __m512 xv = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), m, idx, x, sizeof(float));
+        acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, data+j), xv, acc);
+      }
+      return _mm512_reduce_add_ps(acc);
+    }
+
+    SCIRUN_TARGET_AVX512 double csr_mult_dot_single(const int* rows, const int* columns, const float* data,
+      const float* x, float* y, size_t begin, size_t end)
+    {
+      double val = 0.0;
+      for (size_t i = begin; i < end; ++i)
+      {
+        y[i] = csr_row_single(columns, data, x, rows[i], rows[i+1]);
+        val += static_cast<double>(y[i])*x[i];
+      }
+      return val;
+    }
+  }
+#endif
+
+#define SCIRUN_VECTOR_KERNEL_TABLE(level, name, ns) \
+  { level, name, ns::mult, ns::add, ns::sub, ns::scale, ns::scale_add, ns::dot, ns::norm2, \
+    ns::mult_dot, ns::scale_add_norm2, ns::csr_mult, ns::csr_mult_dot, ns::sell_mult, ns::sell_mult_dot, \
+    ns::scale_add_single, ns::scale_add_norm2_single, ns::dot_single, ns::csr_mult_dot_single }
+
+  const VectorKernels scalarKernels = SCIRUN_VECTOR_KERNEL_TABLE(SimdLevel::Scalar, "scalar", scalar);
+#ifdef SCIRUN_X86_SIMD_KERNELS
+  const VectorKernels avx2Kernels = SCIRUN_VECTOR_KERNEL_TABLE(SimdLevel::AVX2, "AVX2", avx2);
+  const VectorKernels avx512Kernels = SCIRUN_VECTOR_KERNEL_TABLE(SimdLevel::AVX512, "AVX-512", avx512);
+#endif
+
+#if defined(SCIRUN_X86_SIMD_KERNELS) && defined(_MSC_VER) && !defined(__clang__)
+  bool cpuHasAVX2()
+  {
+    int info[4];
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && fma && (info[1] & (1 << 5));
+  }
+
+  bool cpuHasAVX512()
+  {
+    int info[4];
+    __cpuid(info, 1);
+    const bool osSavesZmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0xe6) == 0xe6;
+    __cpuidex(info, 7, 0);
+    return osSavesZmm && (info[1] & (1 << 16));
+  }
+#elif defined(SCIRUN_X86_SIMD_KERNELS)
+  // libgcc checks both the CPUID bits and that the OS saves the wide registers
+  bool cpuHasAVX2()
+  {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  }
+
+  bool cpuHasAVX512()
+  {
+    return __builtin_cpu_supports("avx512f");
+  }
+#endif
+}
+
+bool SCIRun::Core::Algorithms::Math::simdLevelSupported(SimdLevel level)
+{
+  switch (level)
+  {
+  case SimdLevel::Scalar:
+    return true;
+#ifdef SCIRUN_X86_SIMD_KERNELS
+  case SimdLevel::AVX2:
+    return cpuHasAVX2();
+  case SimdLevel::AVX512:
+    return cpuHasAVX512();
+#endif
+  default:
+    return false;
+  }
+}
+
+SimdLevel SCIRun::Core::Algorithms::Math::bestSimdLevel()
+{
+  if (simdLevelSupported(SimdLevel::AVX512))
+    return SimdLevel::AVX512;
+  if (simdLevelSupported(SimdLevel::AVX2))
+    return SimdLevel::AVX2;
+  return SimdLevel::Scalar;
+}
+
+const VectorKernels& SCIRun::Core::Algorithms::Math::vectorKernels(SimdLevel level)
+{
+  if (!simdLevelSupported(level))
+    return scalarKernels;
+  switch (level)
+  {
+#ifdef SCIRUN_X86_SIMD_KERNELS
+  case SimdLevel::AVX2:
+    return avx2Kernels;
+  case SimdLevel::AVX512:
+    return avx512Kernels;
+#endif
+  default:
+    return scalarKernels;
+  }
+}
+
+const VectorKernels& SCIRun::Core::Algorithms::Math::vectorKernels()
+{
+  static const VectorKernels& best = vectorKernels(bestSimdLevel());
+  return best;
+}
@@ -0,0 +1,114 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_PARALLELALGEBRA_VECTORKERNELS_H
+#define CORE_ALGORITHMS_MATH_PARALLELALGEBRA_VECTORKERNELS_H
+
+#include <cstddef>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+  class SlicedEllpackMatrix;
+
+  enum class SimdLevel
+  {
+    Scalar,
+    AVX2,
+    AVX512
+  };
+
+  /// Low level kernels behind ParallelLinearAlgebra. Every function works on
+  /// the n entries starting at the given pointers, i.e. on one thread's slice
+  /// of the vectors; reductions return the local partial result.
+  struct SCISHARE VectorKernels
+  {
+    SimdLevel level;
+    const char* name;
+
+    // r = a.*b
+    void (*mult)(const double* a, const double* b, double* r, size_t n);
+    // r = a+b
+    void (*add)(const double* a, const double* b, double* r, size_t n);
+    // r = a-b
+    void (*sub)(const double* a, const double* b, double* r, size_t n);
+    // r = s*a
+    void (*scale)(double s, const double* a, double* r, size_t n);
+    // r = s*a+b
+    void (*scale_add)(double s, const double* a, const double* b, double* r, size_t n);
+    // sum a.*b
+    double (*dot)(const double* a, const double* b, size_t n);
+    // sum a.*a
+    double (*norm2)(const double* a, size_t n);
+
+    /// Fused kernels for the Krylov solvers, each saving a full pass over memory.
+    // r = a.*b, returns sum r.*a
+    double (*mult_dot)(const double* a, const double* b, double* r, size_t n);
+    // r = s*a+b, returns sum r.*r
+    double (*scale_add_norm2)(double s, const double* a, const double* b, double* r, size_t n);
+
+    // y[i] = A(i,:)*x for begin <= i < end, with A in CSR storage
+    void (*csr_mult)(const index_type* rows, const index_type* columns, const double* data,
+      const double* x, double* y, size_t begin, size_t end);
+    // as csr_mult, returns sum y[i]*x[i] over the same rows
+    double (*csr_mult_dot)(const index_type* rows, const index_type* columns, const double* data,
+      const double* x, double* y, size_t begin, size_t end);
+
+    // y = A*x for the rows stored in the sliced ELLPACK block
+    void (*sell_mult)(const SlicedEllpackMatrix& a, const double* x, double* y);
+    // as sell_mult, returns sum y[i]*x[i] over the stored rows
+    double (*sell_mult_dot)(const SlicedEllpackMatrix& a, const double* x, double* y);
+
+    /// Single precision kernels for the float inner solves; reductions accumulate in double.
+    // r = s*a+b
+    void (*scale_add_single)(float s, const float* a, const float* b, float* r, size_t n);
+    // r = s*a+b, returns sum r.*r
+    double (*scale_add_norm2_single)(float s, const float* a, const float* b, float* r, size_t n);
+    // sum a.*b
+    double (*dot_single)(const float* a, const float* b, size_t n);
+    // y[i] = A(i,:)*x for begin <= i < end with 32 bit CSR indices, returns sum y[i]*x[i]
+    double (*csr_mult_dot_single)(const int* rows, const int* columns, const float* data,
+      const float* x, float* y, size_t begin, size_t end);
+  };
+
+  /// Widest instruction set that was compiled in and that this CPU and OS support.
+  SCISHARE SimdLevel bestSimdLevel();
+  SCISHARE bool simdLevelSupported(SimdLevel level);
+
+  /// Kernels for the best supported level; selected once at first use.
+  SCISHARE const VectorKernels& vectorKernels();
+  /// Kernels for a specific level, falling back to scalar code when unsupported.
+  SCISHARE const VectorKernels& vectorKernels(SimdLevel level);
+
+}}}}
+
+#endif
@@ -0,0 +1,252 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Algorithms/Math/LinearSystem/BlockKrylovSolver.h>
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Algorithms;
+
+namespace
+{
+  // 5-point stencil on an n x n grid; convection > 0 makes it nonsymmetric
+  SparseRowMatrixHandle gridOperator(int n, double convection = 0)
+  {
+    std::vector<SparseRowMatrix::Triplet> entries;
+    for (int i = 0; i < n; ++i)
+    {
+      for (int j = 0; j < n; ++j)
+      {
+        const int row = i * n + j;
+        entries.push_back(SparseRowMatrix::Triplet(row, row, 4.0));
+        if (i > 0)
+          entries.push_back(SparseRowMatrix::Triplet(row, row - n, -1.0));
+        if (i < n - 1)
+          entries.push_back(SparseRowMatrix::Triplet(row, row + n, -1.0));
+        if (j > 0)
+          entries.push_back(SparseRowMatrix::Triplet(row, row - 1, -1.0 - convection));
+        if (j < n - 1)
+          entries.push_back(SparseRowMatrix::Triplet(row, row + 1, -1.0 + convection));
+      }
+    }
+    auto A = boost::make_shared<SparseRowMatrix>(n * n, n * n);
+    A->setFromTriplets(entries.begin(), entries.end());
+    A->makeCompressed();
+    return A;
+  }
+
+  Eigen::MatrixXd rightHandSides(Eigen::Index rows, int cols)
+  {
+    Eigen::MatrixXd B(rows, cols);
+    for (Eigen::Index i = 0; i < rows; ++i)
+      for (int c = 0; c < cols; ++c)
+        B(i, c) = std::sin(0.37 * (i + 1) * (c + 1)) + (i % (c + 2) == 0 ? 1.0 : 0.0);
+    return B;
+  }
+
+  double relativeResidual(const SparseRowMatrix& A, const Eigen::MatrixXd& B, const Eigen::MatrixXd& X, int c)
+  {
+    return (B.col(c) - A * X.col(c)).norm() / B.col(c).norm();
+  }
+}
+
+class BlockKrylovPreconditionerTest : public ::testing::TestWithParam<const char*>
+{
+};
+
+TEST_P(BlockKrylovPreconditionerTest, BlockCGSolvesEveryColumn)
+{
+  auto A = gridOperator(40);
+  auto B = rightHandSides(A->rows(), 6);
+  auto M = PreconditionerFactory::create(GetParam(), A);
+
+  BlockKrylovSolver solver(1e-8, 2000);
+  Eigen::MatrixXd X;
+  auto result = solver.solveCG(*A, *M, B, X);
+
+  EXPECT_TRUE(result.converged);
+  ASSERT_EQ(6, result.residuals.size());
+  for (int c = 0; c < 6; ++c)
+    EXPECT_LT(relativeResidual(*A, B, X, c), 1e-7);
+}
+
+TEST_P(BlockKrylovPreconditionerTest, BlockGMRESSolvesEveryColumn)
+{
+  // AMG is built for symmetric operators
+  const bool symmetric = std::string(GetParam()) == "AMG" || std::string(GetParam()) == "IncompleteCholesky";
+  auto A = gridOperator(30, symmetric ? 0 : 0.3);
+  auto B = rightHandSides(A->rows(), 4);
+  auto M = PreconditionerFactory::create(GetParam(), A);
+
+  BlockKrylovSolver solver(1e-8, 2000);
+  Eigen::MatrixXd X;
+  auto result = solver.solveGMRES(*A, *M, B, X, 20);
+
+  EXPECT_TRUE(result.converged);
+  for (int c = 0; c < 4; ++c)
+    EXPECT_LT(relativeResidual(*A, B, X, c), 1e-7);
+}
+
+INSTANTIATE_TEST_CASE_P(
+  AllPreconditioners,
+  BlockKrylovPreconditionerTest,
+  ::testing::Values("None", "Jacobi", "IncompleteCholesky", "ILU0", "AMG"));
+
+TEST(BlockKrylovSolverTests, StrongerPreconditionersNeedFewerIterations)
+{
+  auto A = gridOperator(60);
+  auto B = rightHandSides(A->rows(), 3);
+  BlockKrylovSolver solver(1e-8, 5000);
+
+  auto iterations = [&](const std::string& name)
+  {
+    Eigen::MatrixXd X;
+    return solver.solveCG(*A, *PreconditionerFactory::create(name, A), B, X).iterations;
+  };
+  const int jacobi = iterations("Jacobi");
+  const int ic = iterations("IncompleteCholesky");
+  const int amg = iterations("AMG");
+  EXPECT_LT(ic, jacobi);
+  EXPECT_LT(amg, ic);
+}
+
+TEST(BlockKrylovSolverTests, BlockSolveMatchesColumnBySolve)
+{
+  auto A = gridOperator(25);
+  auto B = rightHandSides(A->rows(), 5);
+  auto M = PreconditionerFactory::create("ILU0", A);
+  BlockKrylovSolver solver(1e-10, 1000);
+
+  Eigen::MatrixXd X;
+  solver.solveCG(*A, *M, B, X);
+  for (int c = 0; c < 5; ++c)
+  {
+    Eigen::MatrixXd x;
+    solver.solveCG(*A, *M, B.col(c), x);
+    EXPECT_TRUE(x.isApprox(X.col(c), 1e-8));
+  }
+}
+
+TEST(BlockKrylovSolverTests, MemoryLimitSolvesInColumnChunks)
+{
+  auto A = gridOperator(20, 0.3);
+  auto B = rightHandSides(A->rows(), 7);
+  auto M = PreconditionerFactory::create("ILU0", A);
+  // room for the vectors of two GMRES columns at restart 10
+  BlockKrylovSolver chunked(1e-10, 1000, 2 * 17 * A->rows() * sizeof(double));
+  EXPECT_EQ(2, chunked.chunkColumns(A->rows(), 17));
+
+  Eigen::MatrixXd X, Xchunked;
+  BlockKrylovSolver(1e-10, 1000).solveGMRES(*A, *M, B, X, 10);
+  auto result = chunked.solveGMRES(*A, *M, B, Xchunked, 10);
+  EXPECT_TRUE(result.converged);
+  ASSERT_EQ(7, result.residuals.size());
+  EXPECT_TRUE(Xchunked.isApprox(X, 1e-8));
+}
+
+TEST(BlockKrylovSolverTests, ZeroColumnGivesZeroSolution)
+{
+  auto A = gridOperator(10);
+  auto B = rightHandSides(A->rows(), 3);
+  B.col(1).setZero();
+  BlockKrylovSolver solver(1e-10, 500);
+
+  Eigen::MatrixXd X;
+  auto result = solver.solveCG(*A, *PreconditionerFactory::create("Jacobi", A), B, X);
+  EXPECT_TRUE(result.converged);
+  EXPECT_EQ(0.0, X.col(1).norm());
+}
+
+TEST(BlockKrylovSolverTests, IncompleteCholeskyMatchesILU0ForSymmetricMatrix)
+{
+  auto A = gridOperator(12);
+  auto B = rightHandSides(A->rows(), 2);
+  Eigen::MatrixXd ic, ilu;
+  PreconditionerFactory::create("IncompleteCholesky", A)->apply(B, ic);
+  PreconditionerFactory::create("ILU0", A)->apply(B, ilu);
+  EXPECT_TRUE(ic.isApprox(ilu, 1e-12));
+}
+
+TEST(BlockKrylovSolverTests, UnknownPreconditionerThrows)
+{
+  EXPECT_THROW(PreconditionerFactory::create("SPAI", gridOperator(3)), AlgorithmProcessingException);
+}
+
+TEST(SolveLinearSystemAlgoBlockTests, SolvesMultipleRightHandSides)
+{
+  SolveLinearSystemAlgo algo;
+  algo.setOption(Variables::Method, "cg");
+  algo.setOption(Variables::Preconditioner, "AMG");
+  algo.set(Variables::TargetError, 1e-9);
+
+  auto A = gridOperator(30);
+  auto B = boost::make_shared<DenseMatrix>(rightHandSides(A->rows(), 4));
+  DenseMatrixHandle X;
+  ASSERT_TRUE(algo.run(A, B, DenseMatrixHandle(), X));
+  ASSERT_EQ(4, X->ncols());
+  const Eigen::MatrixXd Xc = *X, Bc = *B;
+  for (int c = 0; c < 4; ++c)
+    EXPECT_LT(relativeResidual(*A, Bc, Xc, c), 1e-8);
+
+  // second solve on the same matrix reuses the hierarchy
+  DenseMatrixHandle X2;
+  ASSERT_TRUE(algo.run(A, B, DenseMatrixHandle(), X2));
+  EXPECT_TRUE(X->isApprox(*X2));
+}
+
+TEST(SolveLinearSystemAlgoBlockTests, SingleColumnWithILU0UsesBlockEngine)
+{
+  SolveLinearSystemAlgo algo;
+  algo.setOption(Variables::Method, "gmres");
+  algo.setOption(Variables::Preconditioner, "ILU0");
+  algo.set(Variables::TargetError, 1e-9);
+
+  auto A = gridOperator(20, 0.2);
+  auto b = boost::make_shared<DenseColumnMatrix>(rightHandSides(A->rows(), 1).col(0));
+  DenseColumnMatrixHandle x;
+  ASSERT_TRUE(algo.run(A, b, DenseColumnMatrixHandle(), x));
+  EXPECT_LT((*b - *A * *x).norm() / b->norm(), 1e-8);
+}
+
+TEST(SolveLinearSystemAlgoBlockTests, BlockModeRejectsOtherMethods)
+{
+  SolveLinearSystemAlgo algo;
+  algo.setOption(Variables::Method, "minres");
+  auto A = gridOperator(5);
+  auto B = boost::make_shared<DenseMatrix>(rightHandSides(A->rows(), 2));
+  DenseMatrixHandle X;
+  EXPECT_THROW(algo.run(A, B, DenseMatrixHandle(), X), AlgorithmInputException);
+}
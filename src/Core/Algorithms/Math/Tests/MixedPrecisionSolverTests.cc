@@ -0,0 +1,254 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <Core/Algorithms/Math/LinearSystem/MixedPrecisionSolver.h>
+#include <Core/Algorithms/Math/LinearSystem/BlockKrylovSolver.h>
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Algorithms;
+
+namespace
+{
+  // 7-point finite volume stencil on an n^3 grid with Dirichlet boundaries;
+  // the upper half of the grid has conductivity contrast to spread the spectrum
+  SparseRowMatrixHandle laplacian3D(int n, double contrast = 1)
+  {
+    std::vector<SparseRowMatrix::Triplet> entries;
+    auto index = [n](int i, int j, int k) { return (i * n + j) * n + k; };
+    auto conductivity = [n, contrast](int i) { return i < n / 2 ? 1.0 : contrast; };
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < n; ++j)
+        for (int k = 0; k < n; ++k)
+        {
+          const int row = index(i, j, k);
+          double diagonal = 0;
+          for (int axis = 0; axis < 3; ++axis)
+          {
+            for (int step = -1; step <= 1; step += 2)
+            {
+              int neighbor[] = { i, j, k };
+              neighbor[axis] += step;
+              const double w = 0.5 * (conductivity(i) + conductivity(neighbor[0]));
+              diagonal += w;
+              if (neighbor[axis] >= 0 && neighbor[axis] < n)
+                entries.push_back(SparseRowMatrix::Triplet(row, index(neighbor[0], neighbor[1], neighbor[2]), -w));
+            }
+          }
+          entries.push_back(SparseRowMatrix::Triplet(row, row, diagonal));
+        }
+    auto A = boost::make_shared<SparseRowMatrix>(n*n*n, n*n*n);
+    A->setFromTriplets(entries.begin(), entries.end());
+    A->makeCompressed();
+    return A;
+  }
+
+  Eigen::VectorXd rightHandSide(Eigen::Index rows)
+  {
+    Eigen::VectorXd b(rows);
+    for (Eigen::Index i = 0; i < rows; ++i)
+      b[i] = std::sin(0.37 * (i + 1)) + (i % 7 == 0 ? 1.0 : 0.0);
+    return b;
+  }
+
+  double relativeResidual(const SparseRowMatrix& A, const Eigen::VectorXd& b, const Eigen::VectorXd& x)
+  {
+    return (b - A * x).norm() / b.norm();
+  }
+}
+
+class MixedPrecisionPreconditionerTest : public ::testing::TestWithParam<const char*>
+{
+};
+
+TEST_P(MixedPrecisionPreconditionerTest, ReachesDoublePrecisionTolerance)
+{
+  auto A = laplacian3D(16);
+  auto b = rightHandSide(A->rows());
+  auto M = PreconditionerFactory::create(GetParam(), A);
+  MixedPrecisionSolver solver(*A);
+
+  Eigen::VectorXd x;
+  auto result = solver.solve(*A, *M, b, x, 1e-10, 2000);
+
+  EXPECT_TRUE(result.converged);
+  EXPECT_GT(result.refinements, 1);
+  EXPECT_LT(relativeResidual(*A, b, x), 1e-10);
+  EXPECT_NEAR(result.residual, relativeResidual(*A, b, x), 1e-12);
+}
+
+INSTANTIATE_TEST_CASE_P(
+  AllPreconditioners,
+  MixedPrecisionPreconditionerTest,
+  ::testing::Values("None", "Jacobi", "IncompleteCholesky", "ILU0", "AMG"));
+
+TEST(MixedPrecisionSolverTests, MatchesDoublePrecisionSolution)
+{
+  auto A = laplacian3D(12);
+  auto b = rightHandSide(A->rows());
+  auto M = PreconditionerFactory::create("Jacobi", A);
+
+  Eigen::VectorXd mixed;
+  MixedPrecisionSolver(*A).solve(*A, *M, b, mixed, 1e-12, 5000);
+  Eigen::MatrixXd reference;
+  BlockKrylovSolver(1e-12, 5000).solveCG(*A, *M, b, reference);
+
+  EXPECT_LT((mixed - reference.col(0)).norm(), 1e-9 * reference.norm());
+}
+
+TEST(MixedPrecisionSolverTests, ZeroRightHandSideGivesZeroSolution)
+{
+  auto A = laplacian3D(5);
+  auto M = PreconditionerFactory::create("Jacobi", A);
+  Eigen::VectorXd x = Eigen::VectorXd::Ones(A->rows());
+  auto result = MixedPrecisionSolver(*A).solve(*A, *M, Eigen::VectorXd::Zero(A->rows()), x, 1e-8, 100);
+  EXPECT_TRUE(result.converged);
+  EXPECT_EQ(0, x.norm());
+}
+
+TEST(MixedPrecisionSolverTests, SinglePrecisionCopyUsesHalfTheMemory)
+{
+  auto A = laplacian3D(10);
+  const double doubleBytes = A->nonZeros() * (sizeof(double) + sizeof(index_type)) + (A->nrows() + 1) * sizeof(index_type);
+  EXPECT_DOUBLE_EQ(0.5, MixedPrecisionSolver(*A).singlePrecisionBytes() / doubleBytes);
+  EXPECT_GT(PreconditionerFactory::create("ILU0", A)->singlePrecisionBytes(), 0u);
+}
+
+TEST(MixedPrecisionSolverTests, FloatPreconditionersMatchDoubleOnes)
+{
+  auto A = laplacian3D(8);
+  Eigen::MatrixXd R(A->rows(), 2);
+  R.col(0) = rightHandSide(A->rows());
+  R.col(1).setOnes();
+  for (auto name : { "Jacobi", "IncompleteCholesky", "ILU0", "AMG" })
+  {
+    SCOPED_TRACE(name);
+    auto M = PreconditionerFactory::create(name, A);
+    Eigen::MatrixXd Z;
+    Eigen::MatrixXf Zs;
+    M->apply(R, Z);
+    M->applySingle(R.cast<float>(), Zs);
+    EXPECT_LT((Zs.cast<double>() - Z).norm(), 1e-5 * Z.norm());
+  }
+}
+
+TEST(SolveLinearSystemAlgoMixedPrecisionTests, MethodOptionSolvesColumnAndBlock)
+{
+  auto A = laplacian3D(12);
+  auto b = boost::make_shared<DenseColumnMatrix>(rightHandSide(A->rows()));
+
+  SolveLinearSystemAlgo algo;
+  algo.setOption(Variables::Method, "mixedcg");
+  algo.setOption(Variables::Preconditioner, "IncompleteCholesky");
+  algo.set(Variables::TargetError, 1e-10);
+  algo.set(Variables::MaxIterations, 1000);
+
+  DenseColumnMatrixHandle x;
+  ASSERT_TRUE(algo.run(A, b, DenseColumnMatrixHandle(), x));
+  EXPECT_LT(relativeResidual(*A, *b, *x), 1e-10);
+
+  auto B = boost::make_shared<DenseMatrix>(A->nrows(), 3);
+  for (int c = 0; c < 3; ++c)
+    B->col(c) = (c + 1) * *b;
+  DenseMatrixHandle X;
+  ASSERT_TRUE(algo.run(A, B, DenseMatrixHandle(), X));
+  for (int c = 0; c < 3; ++c)
+    EXPECT_LT(relativeResidual(*A, B->col(c), X->col(c)), 1e-10);
+}
+
+TEST(SolveLinearSystemAlgoMixedPrecisionTests, ReachesTargetOnHighContrastProblem)
+{
+  // conductivity contrast of 1e9 pushes cond(A) past 1/eps(float)
+  auto A = laplacian3D(10, 1e9);
+  auto b = boost::make_shared<DenseColumnMatrix>(rightHandSide(A->rows()));
+
+  SolveLinearSystemAlgo algo;
+  algo.setOption(Variables::Method, "mixedcg");
+  algo.setOption(Variables::Preconditioner, "None");
+  algo.set(Variables::TargetError, 1e-8);
+  algo.set(Variables::MaxIterations, 5000);
+
+  DenseColumnMatrixHandle x;
+  ASSERT_TRUE(algo.run(A, b, DenseColumnMatrixHandle(), x));
+  EXPECT_LT(relativeResidual(*A, *b, *x), 1e-8);
+}
+
+TEST(SolveLinearSystemAlgoMixedPrecisionTests, FallsBackToDoublePrecisionWhenItRunsOutOfIterations)
+{
+  auto A = laplacian3D(16);
+  auto b = boost::make_shared<DenseColumnMatrix>(rightHandSide(A->rows()));
+
+  SolveLinearSystemAlgo algo;
+  algo.setOption(Variables::Method, "mixedcg");
+  algo.setOption(Variables::Preconditioner, "Jacobi");
+  algo.set(Variables::TargetError, 1e-10);
+  // the mixed solve alone stops around 1e-7 within this budget
+  algo.set(Variables::MaxIterations, 60);
+
+  DenseColumnMatrixHandle x;
+  ASSERT_TRUE(algo.run(A, b, DenseColumnMatrixHandle(), x));
+  EXPECT_LT(relativeResidual(*A, *b, *x), 1e-10);
+}
+
+namespace
+{
+  double timeSolve(const std::string& method, SparseRowMatrixHandle A, DenseColumnMatrixHandle b)
+  {
+    SolveLinearSystemAlgo algo;
+    algo.setOption(Variables::Method, method);
+    algo.setOption(Variables::Preconditioner, "Jacobi");
+    algo.set(Variables::TargetError, 1e-10);
+    algo.set(Variables::MaxIterations, 5000);
+    DenseColumnMatrixHandle x;
+    auto start = std::chrono::steady_clock::now();
+    algo.run(A, b, DenseColumnMatrixHandle(), x);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << method << ": " << elapsed.count() << " s, error " << relativeResidual(*A, *b, *x) << std::endl;
+    return elapsed.count();
+  }
+}
+
+TEST(SolveLinearSystemAlgoMixedPrecisionTests, DISABLED_SpeedupOverDoublePrecisionCG)
+{
+  auto A = laplacian3D(100);
+  auto b = boost::make_shared<DenseColumnMatrix>(rightHandSide(A->rows()));
+  const double cg = timeSolve("cg", A, b);
+  const double mixed = timeSolve("mixedcg", A, b);
+  std::cout << "speedup " << cg / mixed << std::endl;
+}
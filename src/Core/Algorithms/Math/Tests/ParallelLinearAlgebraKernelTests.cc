@@ -0,0 +1,382 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <Core/Algorithms/Math/ParallelAlgebra/VectorKernels.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/SlicedEllpackMatrix.h>
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Algorithms;
+
+namespace
+{
+  std::vector<double> randomVector(size_t n, unsigned seed)
+  {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> v(n);
+    for (auto& x : v)
+      x = dist(gen);
+    return v;
+  }
+
+  // Rows of 1 to 23 entries, so every gather tail and chunk padding case is hit.
+  SparseRowMatrixHandle irregularMatrix(int n)
+  {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> column(0, n - 1);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    std::vector<SparseRowMatrix::Triplet> entries;
+    for (int row = 0; row < n; ++row)
+    {
+      std::set<int> columns { row };
+      const size_t length = 1 + (row * 7919) % 23;
+      while (columns.size() < std::min<size_t>(length, n))
+        columns.insert(column(gen));
+      for (int c : columns)
+        entries.push_back(SparseRowMatrix::Triplet(row, c, c == row ? 30.0 : value(gen)));
+    }
+    auto m = boost::make_shared<SparseRowMatrix>(n, n);
+    m->setFromTriplets(entries.begin(), entries.end());
+    m->makeCompressed();
+    return m;
+  }
+
+  // 7-point stencil on an n^3 grid
+  SparseRowMatrixHandle laplacian3D(int n)
+  {
+    std::vector<SparseRowMatrix::Triplet> entries;
+    auto index = [n](int i, int j, int k) { return (i * n + j) * n + k; };
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < n; ++j)
+        for (int k = 0; k < n; ++k)
+        {
+          const int row = index(i, j, k);
+          entries.push_back(SparseRowMatrix::Triplet(row, row, 6.0));
+          if (i > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i-1, j, k), -1.0));
+          if (i < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i+1, j, k), -1.0));
+          if (j > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j-1, k), -1.0));
+          if (j < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j+1, k), -1.0));
+          if (k > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j, k-1), -1.0));
+          if (k < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j, k+1), -1.0));
+        }
+    auto m = boost::make_shared<SparseRowMatrix>(n*n*n, n*n*n);
+    m->setFromTriplets(entries.begin(), entries.end());
+    m->makeCompressed();
+    return m;
+  }
+
+  std::vector<SimdLevel> supportedLevels()
+  {
+    std::vector<SimdLevel> levels;
+    for (auto level : { SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512 })
+      if (simdLevelSupported(level))
+        levels.push_back(level);
+    return levels;
+  }
+}
+
+class VectorKernelTest : public ::testing::TestWithParam<size_t>
+{
+};
+
+TEST_P(VectorKernelTest, EveryInstructionSetMatchesScalarCode)
+{
+  const size_t n = GetParam();
+  const auto a = randomVector(n, 1), b = randomVector(n, 2);
+  const auto& ref = vectorKernels(SimdLevel::Scalar);
+  const double tol = 1e-12 * (n + 1);
+
+  for (auto level : supportedLevels())
+  {
+    const auto& k = vectorKernels(level);
+    SCOPED_TRACE(k.name);
+    EXPECT_EQ(level, k.level);
+    std::vector<double> r(n), expected(n);
+
+    k.mult(a.data(), b.data(), r.data(), n);
+    ref.mult(a.data(), b.data(), expected.data(), n);
+    EXPECT_EQ(expected, r);
+
+    k.add(a.data(), b.data(), r.data(), n);
+    ref.add(a.data(), b.data(), expected.data(), n);
+    EXPECT_EQ(expected, r);
+
+    k.sub(a.data(), b.data(), r.data(), n);
+    ref.sub(a.data(), b.data(), expected.data(), n);
+    EXPECT_EQ(expected, r);
+
+    k.scale(-2.5, a.data(), r.data(), n);
+    ref.scale(-2.5, a.data(), expected.data(), n);
+    EXPECT_EQ(expected, r);
+
+    // fused multiply-add rounds once, so allow the last bit to differ
+    k.scale_add(0.3, a.data(), b.data(), r.data(), n);
+    ref.scale_add(0.3, a.data(), b.data(), expected.data(), n);
+    for (size_t i = 0; i < n; ++i)
+      EXPECT_NEAR(expected[i], r[i], 1e-15);
+
+    EXPECT_NEAR(ref.dot(a.data(), b.data(), n), k.dot(a.data(), b.data(), n), tol);
+    EXPECT_NEAR(ref.norm2(a.data(), n), k.norm2(a.data(), n), tol);
+
+    const double md = k.mult_dot(a.data(), b.data(), r.data(), n);
+    EXPECT_NEAR(ref.mult_dot(a.data(), b.data(), expected.data(), n), md, tol);
+    EXPECT_EQ(expected, r);
+
+    const double san = k.scale_add_norm2(0.3, a.data(), b.data(), r.data(), n);
+    EXPECT_NEAR(ref.scale_add_norm2(0.3, a.data(), b.data(), expected.data(), n), san, tol);
+    EXPECT_NEAR(ref.dot(r.data(), r.data(), n), san, tol);
+  }
+}
+
+TEST_P(VectorKernelTest, SinglePrecisionKernelsMatchScalarCode)
+{
+  const size_t n = GetParam();
+  const auto ad = randomVector(n, 1), bd = randomVector(n, 2);
+  const std::vector<float> a(ad.begin(), ad.end()), b(bd.begin(), bd.end());
+  const auto& ref = vectorKernels(SimdLevel::Scalar);
+  const double tol = 1e-6 * (n + 1);
+
+  for (auto level : supportedLevels())
+  {
+    const auto& k = vectorKernels(level);
+    SCOPED_TRACE(k.name);
+    std::vector<float> r(n), expected(n);
+
+    k.scale_add_single(0.3f, a.data(), b.data(), r.data(), n);
+    ref.scale_add_single(0.3f, a.data(), b.data(), expected.data(), n);
+    for (size_t i = 0; i < n; ++i)
+      EXPECT_NEAR(expected[i], r[i], 1e-6);
+
+    EXPECT_NEAR(ref.dot_single(a.data(), b.data(), n), k.dot_single(a.data(), b.data(), n), tol);
+
+    const double san = k.scale_add_norm2_single(0.3f, a.data(), b.data(), r.data(), n);
+    EXPECT_NEAR(ref.scale_add_norm2_single(0.3f, a.data(), b.data(), expected.data(), n), san, tol);
+    EXPECT_NEAR(ref.dot_single(r.data(), r.data(), n), san, tol);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+  VectorLengths,
+  VectorKernelTest,
+  ::testing::Values(0, 1, 3, 7, 8, 9, 17, 31, 33, 1000)
+);
+
+TEST(SparseMatrixKernelTests, CsrAndSlicedEllpackProductsMatchEigen)
+{
+  const int n = 517;
+  auto A = irregularMatrix(n);
+  const auto x = randomVector(n, 3);
+  Eigen::Map<const Eigen::VectorXd> xv(x.data(), n);
+  Eigen::VectorXd expected = *A * xv;
+  const double expectedDot = expected.dot(xv);
+
+  // split the rows the way two solver threads would
+  SlicedEllpackMatrix top(*A, 0, 300), bottom(*A, 300, n);
+  EXPECT_GE(top.fillRatio(), 1.0);
+  EXPECT_EQ(0, top.beginRow());
+  EXPECT_EQ(n, bottom.endRow());
+
+  for (auto level : supportedLevels())
+  {
+    const auto& k = vectorKernels(level);
+    SCOPED_TRACE(k.name);
+
+    std::vector<double> y(n, 0.0);
+    k.csr_mult(A->outerIndexPtr(), A->innerIndexPtr(), A->valuePtr(), x.data(), y.data(), 0, n);
+    for (int i = 0; i < n; ++i)
+      ASSERT_NEAR(expected[i], y[i], 1e-12);
+
+    std::fill(y.begin(), y.end(), 0.0);
+    double dot = k.csr_mult_dot(A->outerIndexPtr(), A->innerIndexPtr(), A->valuePtr(), x.data(), y.data(), 0, n);
+    EXPECT_NEAR(expectedDot, dot, 1e-9);
+
+    std::fill(y.begin(), y.end(), 0.0);
+    k.sell_mult(top, x.data(), y.data());
+    k.sell_mult(bottom, x.data(), y.data());
+    for (int i = 0; i < n; ++i)
+      ASSERT_NEAR(expected[i], y[i], 1e-12);
+
+    std::fill(y.begin(), y.end(), 0.0);
+    dot = k.sell_mult_dot(top, x.data(), y.data()) + k.sell_mult_dot(bottom, x.data(), y.data());
+    EXPECT_NEAR(expectedDot, dot, 1e-9);
+  }
+}
+
+TEST(SparseMatrixKernelTests, SinglePrecisionCsrProductMatchesEigen)
+{
+  const int n = 500;
+  const Eigen::SparseMatrix<float, Eigen::RowMajor, int> A = irregularMatrix(n)->cast<float>();
+  const auto xd = randomVector(n, 3);
+  const Eigen::VectorXf x = Eigen::Map<const Eigen::VectorXd>(xd.data(), n).cast<float>();
+  const Eigen::VectorXf expected = A * x;
+
+  for (auto level : supportedLevels())
+  {
+    const auto& k = vectorKernels(level);
+    SCOPED_TRACE(k.name);
+    Eigen::VectorXf y = Eigen::VectorXf::Zero(n);
+    const double xy = k.csr_mult_dot_single(A.outerIndexPtr(), A.innerIndexPtr(), A.valuePtr(), x.data(), y.data(), 0, n);
+    EXPECT_TRUE(y.isApprox(expected, 1e-5f));
+    EXPECT_NEAR(expected.cast<double>().dot(x.cast<double>()), xy, 1e-3);
+  }
+}
+
+TEST(SparseMatrixKernelTests, SlicedEllpackOnlyWritesItsOwnRows)
+{
+  auto A = irregularMatrix(100);
+  const auto x = randomVector(100, 4);
+  SlicedEllpackMatrix middle(*A, 37, 61);
+  EXPECT_EQ(3u, middle.numChunks());
+  EXPECT_EQ(8, middle.chunkRows(1));
+  EXPECT_EQ(8, middle.chunkRows(2));
+
+  std::vector<double> y(100, -7.0);
+  vectorKernels().sell_mult(middle, x.data(), y.data());
+  for (int i = 0; i < 100; ++i)
+  {
+    if (i < 37 || i >= 61)
+      EXPECT_EQ(-7.0, y[i]);
+    else
+      EXPECT_NE(-7.0, y[i]);
+  }
+}
+
+TEST(SparseMatrixKernelTests, SlicedEllpackHandlesEmptyRowRange)
+{
+  auto A = irregularMatrix(20);
+  SlicedEllpackMatrix empty(*A, 10, 10);
+  EXPECT_EQ(0u, empty.numChunks());
+  std::vector<double> x(20, 1.0), y(20, 0.0);
+  EXPECT_EQ(0.0, vectorKernels().sell_mult_dot(empty, x.data(), y.data()));
+}
+
+TEST(SparseMatrixKernelTests, ConjugateGradientGivesSameSolutionForBothLayouts)
+{
+  auto A = laplacian3D(14);
+  const int n = static_cast<int>(A->nrows());
+  auto b = boost::make_shared<DenseColumnMatrix>(n);
+  auto x0 = boost::make_shared<DenseColumnMatrix>(n);
+  b->setOnes();
+  x0->setZero();
+
+  DenseColumnMatrixHandle solution[2];
+  const char* layouts[] = { "CSR", "SlicedEllpack" };
+  for (int i = 0; i < 2; ++i)
+  {
+    SolveLinearSystemAlgo algo;
+    algo.setOption(Variables::Method, "cg");
+    algo.setOption(Parameters::MatrixLayout, layouts[i]);
+    algo.set(Variables::TargetError, 1e-10);
+    algo.set(Variables::MaxIterations, 1000);
+    ASSERT_TRUE(algo.run(A, b, x0, solution[i]));
+    EXPECT_LT((*A * *solution[i] - *b).norm() / b->norm(), 1e-9);
+  }
+  EXPECT_LT((*solution[0] - *solution[1]).norm(), 1e-8 * solution[0]->norm());
+}
+
+namespace
+{
+  template <class Func>
+  double secondsPerCall(Func f, int repeats)
+  {
+    f();
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r)
+      f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+  }
+
+  void report(const std::string& kernel, const VectorKernels& k, double seconds, double flops, double bytes)
+  {
+    std::cout << std::left << std::setw(18) << kernel << std::setw(9) << k.name
+      << std::right << std::fixed << std::setprecision(2)
+      << std::setw(8) << flops / seconds * 1e-9 << " GFLOP/s"
+      << std::setw(9) << bytes / seconds * 1e-9 << " GB/s" << std::endl;
+  }
+}
+
+// Vectors are sized well past the last level cache, so the bandwidth column is
+// the number to compare against the machine's stream bandwidth.
+TEST(ParallelLinearAlgebraKernelBenchmark, DISABLED_VectorKernels)
+{
+  const size_t n = 1 << 23;
+  const int repeats = 20;
+  auto a = randomVector(n, 1), b = randomVector(n, 2);
+  std::vector<double> r(n);
+  const double word = sizeof(double);
+
+  for (auto level : supportedLevels())
+  {
+    const auto& k = vectorKernels(level);
+    report("mult", k, secondsPerCall([&]() { k.mult(a.data(), b.data(), r.data(), n); }, repeats), n, 3*word*n);
+    report("scale_add", k, secondsPerCall([&]() { k.scale_add(0.5, a.data(), b.data(), r.data(), n); }, repeats), 2.0*n, 3*word*n);
+    report("dot", k, secondsPerCall([&]() { k.dot(a.data(), b.data(), n); }, repeats), 2.0*n, 2*word*n);
+    report("norm2", k, secondsPerCall([&]() { k.norm2(a.data(), n); }, repeats), 2.0*n, word*n);
+    report("mult_dot", k, secondsPerCall([&]() { k.mult_dot(a.data(), b.data(), r.data(), n); }, repeats), 3.0*n, 3*word*n);
+    report("scale_add_norm2", k, secondsPerCall([&]() { k.scale_add_norm2(0.5, a.data(), b.data(), r.data(), n); }, repeats), 4.0*n, 3*word*n);
+  }
+}
+
+// Bytes count the matrix, its indices and one read of x and write of y; x is
+// assumed to stay in cache between neighbouring rows.
+TEST(ParallelLinearAlgebraKernelBenchmark, DISABLED_SparseMatrixVectorProduct)
+{
+  auto A = laplacian3D(100);
+  const size_t n = A->nrows(), nnz = A->nonZeros();
+  const auto x = randomVector(n, 3);
+  std::vector<double> y(n);
+  SlicedEllpackMatrix sell(*A, 0, n);
+  std::cout << "rows " << n << ", non-zeros " << nnz << ", SELL fill ratio " << sell.fillRatio() << std::endl;
+
+  const double csrBytes = nnz * (sizeof(double) + sizeof(index_type)) + (n + 1) * sizeof(index_type) + 2.0 * n * sizeof(double);
+  const double sellBytes = sell.fillRatio() * nnz * (sizeof(double) + sizeof(int)) + n * sizeof(index_type) + 2.0 * n * sizeof(double);
+  const int repeats = 20;
+  for (auto level : supportedLevels())
+  {
+    const auto& k = vectorKernels(level);
+    report("spmv CSR", k, secondsPerCall([&]()
+      { k.csr_mult(A->outerIndexPtr(), A->innerIndexPtr(), A->valuePtr(), x.data(), y.data(), 0, n); }, repeats),
+      2.0*nnz, csrBytes);
+    report("spmv SELL-8-256", k, secondsPerCall([&]() { k.sell_mult(sell, x.data(), y.data()); }, repeats),
+      2.0*nnz, sellBytes);
+  }
+}
@@ -35,6 +35,8 @@
 #include <Core/Algorithms/Factory/HardCodedAlgorithmFactory.h>
 #include <Dataflow/State/SimpleMapModuleState.h>
 #include <Dataflow/Network/ModuleReexecutionStrategies.h>
+#include <Dataflow/Network/PortDataCache.h>
+#include <Dataflow/Network/ExecutionCache.h>
 #include <Dataflow/Engine/Scheduler/DesktopExecutionStrategyFactory.h>
 #include <Core/Command/GlobalCommandBuilderFromCommandLine.h>
 #include <Core/Logging/Log.h>
@@ -160,7 +162,22 @@ void Application::readCommandLine(int argc, const char* argv[])
     auto maxCoresOption = private_->parameters_->developerParameters()->maxCores();
     if (maxCoresOption)
       Thread::Parallel::SetMaximumCores(*maxCoresOption);
-      
+
+    auto portCacheDirectory = private_->parameters_->developerParameters()->portCacheDirectory();
+    if (portCacheDirectory)
+      PortDataCache::instance().setSpillDirectory(*portCacheDirectory);
+    auto portCacheMegabytes = private_->parameters_->developerParameters()->portCacheMegabytes();
+    if (portCacheMegabytes)
+      PortDataCache::instance().setMemoryBudget(static_cast<size_t>(*portCacheMegabytes) << 20);
+
+    ExecutionCache::setApplicationVersion(VersionInfo::GIT_VERSION_TAG + " " + VersionInfo::GIT_COMMIT_SHA);
+    auto executionCacheMegabytes = private_->parameters_->developerParameters()->executionCacheMegabytes();
+    if (executionCacheMegabytes)
+    {
+      ExecutionCache::instance().setMaxBytes(static_cast<uintmax_t>(*executionCacheMegabytes) << 20);
+      ExecutionCache::instance().setEnabled(*executionCacheMegabytes > 0);
+    }
+
     LogSettings::Instance().setVerbose(parameters()->verboseMode());
   }
 }
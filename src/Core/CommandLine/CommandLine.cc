@@ -68,6 +68,9 @@ public:
       //("frameInitLimit", po::value<int>(), "ViewScene frame init limit--increase if renderer fails")
       ("guiExpandFactor", po::value<double>(), "Expansion factor for high resolution displays")
       ("max-cores", po::value<unsigned int>(), "Limit the number of cores used by multithreaded algorithms")
+      ("port-cache-mb", po::value<unsigned int>(), "Spill port data to disk beyond this many megabytes")
+      ("port-cache-dir", po::value<std::string>(), "Directory for spilled port data")
+      ("exec-cache-mb", po::value<unsigned int>(), "Cache module results on disk, up to this many megabytes")
       ("list-modules", "print list of available modules")
       ;
 
@@ -117,9 +120,14 @@ public:
     const boost::optional<int>& frameInitLimit,
     const boost::optional<int>& regressionTimeout,
     const boost::optional<unsigned int>& maxCores,
-    const boost::optional<double>& guiExpandFactor
+    const boost::optional<double>& guiExpandFactor,
+    const boost::optional<unsigned int>& portCacheMegabytes,
+    const boost::optional<std::string>& portCacheDirectory,
+    const boost::optional<unsigned int>& executionCacheMegabytes
     ) : threadMode_(threadMode), reexecuteMode_(reexecuteMode), frameInitLimit_(frameInitLimit),
-    regressionTimeout_(regressionTimeout), maxCores_(maxCores), guiExpandFactor_(guiExpandFactor)
+    regressionTimeout_(regressionTimeout), maxCores_(maxCores), guiExpandFactor_(guiExpandFactor),
+    portCacheMegabytes_(portCacheMegabytes), portCacheDirectory_(portCacheDirectory),
+    executionCacheMegabytes_(executionCacheMegabytes)
   {}
   boost::optional<int> regressionTimeoutSeconds() const override
   {
@@ -145,11 +153,26 @@ public:
   {
     return guiExpandFactor_;
   }
+  boost::optional<unsigned int> portCacheMegabytes() const override
+  {
+    return portCacheMegabytes_;
+  }
+  boost::optional<std::string> portCacheDirectory() const override
+  {
+    return portCacheDirectory_;
+  }
+  boost::optional<unsigned int> executionCacheMegabytes() const override
+  {
+    return executionCacheMegabytes_;
+  }
 private:
   boost::optional<std::string> threadMode_, reexecuteMode_;
   boost::optional<int> frameInitLimit_, regressionTimeout_;
   boost::optional<unsigned int> maxCores_;
   boost::optional<double> guiExpandFactor_;
+  boost::optional<unsigned int> portCacheMegabytes_;
+  boost::optional<std::string> portCacheDirectory_;
+  boost::optional<unsigned int> executionCacheMegabytes_;
 };
 
 class ApplicationParametersImpl : public ApplicationParameters
@@ -342,7 +365,10 @@ ApplicationParametersHandle CommandLineParser::parse(int argc, const char* argv[
         parseOptionalArg<int>(parsed, "frameInitLimit"),
         parseOptionalArg<int>(parsed, "regression"),
         parseOptionalArg<unsigned int>(parsed, "max-cores"),
-        parseOptionalArg<double>(parsed, "guiExpandFactor")
+        parseOptionalArg<double>(parsed, "guiExpandFactor"),
+        parseOptionalArg<unsigned int>(parsed, "port-cache-mb"),
+        parseOptionalArg<std::string>(parsed, "port-cache-dir"),
+        parseOptionalArg<unsigned int>(parsed, "exec-cache-mb")
       ),
       ApplicationParametersImpl::Flags(
         parsed.count("help") != 0,
@@ -76,6 +76,9 @@ namespace SCIRun {
         virtual boost::optional<int> frameInitLimit() const = 0;
         virtual boost::optional<unsigned int> maxCores() const = 0;
         virtual boost::optional<double> guiExpandFactor() const = 0;
+        virtual boost::optional<unsigned int> portCacheMegabytes() const = 0;
+        virtual boost::optional<std::string> portCacheDirectory() const = 0;
+        virtual boost::optional<unsigned int> executionCacheMegabytes() const = 0;
       };
 
       typedef boost::shared_ptr<ApplicationParameters> ApplicationParametersHandle;
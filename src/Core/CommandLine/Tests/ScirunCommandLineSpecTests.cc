@@ -57,6 +57,10 @@ TEST(ScirunCommandLineSpecTest, CanReadBasicOptions)
     "  --guiExpandFactor arg   Expansion factor for high resolution displays\n"
     "  --max-cores arg         Limit the number of cores used by multithreaded \n"
     "                          algorithms\n"
+    "  --port-cache-mb arg     Spill port data to disk beyond this many megabytes\n"
+    "  --port-cache-dir arg    Directory for spilled port data\n"
+    "  --exec-cache-mb arg     Cache module results on disk, up to this many \n"
+    "                          megabytes\n"
     "  --list-modules          print list of available modules\n";
 
   EXPECT_EQ(expectedHelp, parser.describe());
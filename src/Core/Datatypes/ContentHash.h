@@ -0,0 +1,79 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_DATATYPES_CONTENTHASH_H
+#define CORE_DATATYPES_CONTENTHASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace SCIRun {
+namespace Core {
+namespace Datatypes {
+
+  /// 64-bit FNV-1a over raw bytes. Unlike std::hash the result is the same in
+  /// every process, so it can key data that outlives a session.
+  class ContentHasher
+  {
+  public:
+    ContentHasher() : hash_(14695981039346656037ULL) {}
+
+    ContentHasher& addBytes(const void* data, size_t bytes)
+    {
+      auto p = static_cast<const unsigned char*>(data);
+      for (size_t i = 0; i < bytes; ++i)
+      {
+        hash_ ^= p[i];
+        hash_ *= 1099511628211ULL;
+      }
+      return *this;
+    }
+
+    template <typename T>
+    ContentHasher& add(const T& value)
+    {
+      return addBytes(&value, sizeof(T));
+    }
+
+    ContentHasher& add(const std::string& s)
+    {
+      add(s.size());
+      return addBytes(s.data(), s.size());
+    }
+
+    /// Never 0, which Datatype::contentHash reserves for "not hashable".
+    uint64_t value() const { return hash_ == 0 ? 1 : hash_; }
+
+  private:
+    uint64_t hash_;
+  };
+
+}}}
+
+#endif
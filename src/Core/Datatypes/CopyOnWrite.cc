@@ -0,0 +1,70 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Datatypes/CopyOnWrite.h>
+#include <boost/atomic.hpp>
+
+using namespace SCIRun::Core::Datatypes;
+
+namespace
+{
+  boost::atomic<size_t> sharedBytes(0);
+  boost::atomic<size_t> copiedBytes(0);
+}
+
+void CopyOnWriteStatistics::recordShared(size_t bytes)
+{
+  sharedBytes.fetch_add(bytes);
+}
+
+void CopyOnWriteStatistics::recordCopied(size_t bytes)
+{
+  copiedBytes.fetch_add(bytes);
+}
+
+size_t CopyOnWriteStatistics::bytesShared()
+{
+  return sharedBytes.load();
+}
+
+size_t CopyOnWriteStatistics::bytesCopied()
+{
+  return copiedBytes.load();
+}
+
+size_t CopyOnWriteStatistics::bytesSaved()
+{
+  size_t shared = bytesShared(), copied = bytesCopied();
+  return shared > copied ? shared - copied : 0;
+}
+
+void CopyOnWriteStatistics::reset()
+{
+  sharedBytes.store(0);
+  copiedBytes.store(0);
+}
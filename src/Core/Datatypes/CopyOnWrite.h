@@ -0,0 +1,130 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_DATATYPES_COPYONWRITE_H
+#define CORE_DATATYPES_COPYONWRITE_H
+
+#include <Core/Datatypes/Datatype.h>
+#include <boost/shared_ptr.hpp>
+#include <Core/Datatypes/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Datatypes {
+
+  /// Process-wide byte counters for datatypes handed to consumers by reference instead of copied.
+  class SCISHARE CopyOnWriteStatistics
+  {
+  public:
+    /// A consumer received data without copying it.
+    static void recordShared(size_t bytes);
+    /// A consumer wrote to shared data and made a private copy.
+    static void recordCopied(size_t bytes);
+
+    static size_t bytesShared();
+    static size_t bytesCopied();
+    /// Bytes that defensive copies would have allocated but sharing did not.
+    static size_t bytesSaved();
+    static void reset();
+  };
+
+  /// How CopyOnWrite makes private copies. copy() backs write(), deepCopy() backs writeDeep().
+  /// Types whose clone() copies everything use it for both; types whose clone() keeps sharing
+  /// parts of the object (fields share their mesh) set sharesSubstructures.
+  template <class T>
+  struct CopyOnWriteTraits
+  {
+    static const bool sharesSubstructures = false;
+    static T* copy(const T& t) { return t.clone(); }
+    static T* deepCopy(const T& t) { return t.clone(); }
+    static size_t copyBytes(const T& t) { return t.sizeInBytes(); }
+    static size_t deepCopyBytes(const T& t) { return t.sizeInBytes(); }
+  };
+
+  /// Handle to a datatype that may be shared with other consumers, such as the other modules
+  /// on a fan-out connection. Reads go to the shared instance; the first call to write() makes
+  /// a private copy, unless this handle is already the only owner.
+  template <class T>
+  class CopyOnWrite
+  {
+  public:
+    typedef boost::shared_ptr<T> Handle;
+    typedef CopyOnWriteTraits<T> Traits;
+
+    CopyOnWrite() : owned_(false), deepOwned_(false) {}
+    explicit CopyOnWrite(const Handle& shared) : data_(shared), owned_(false), deepOwned_(false) {}
+
+    const T& operator*() const { return *data_; }
+    const T* operator->() const { return data_.get(); }
+    const T* get() const { return data_.get(); }
+    explicit operator bool() const { return data_ != nullptr; }
+
+    /// Writable instance private to this handle.
+    T& write()
+    {
+      if (!owned_)
+        detach(false);
+      return *data_;
+    }
+
+    /// Writable instance that also owns every substructure it references, e.g. a field's mesh.
+    /// Call it before write() when both will be needed, or the values are copied twice.
+    T& writeDeep()
+    {
+      if (!deepOwned_)
+        detach(true);
+      return *data_;
+    }
+
+    bool isPrivate() const { return owned_; }
+
+    /// Handle to send downstream: the private copy if one was made, otherwise the shared data.
+    Handle handle() const { return data_; }
+
+  private:
+    void detach(bool deep)
+    {
+      if (!data_)
+        return;
+      // even a sole owner may reference substructures still shared with the instance it was cloned from
+      if (!data_.unique() || (deep && Traits::sharesSubstructures))
+      {
+        CopyOnWriteStatistics::recordCopied(deep ? Traits::deepCopyBytes(*data_) : Traits::copyBytes(*data_));
+        data_.reset(deep ? Traits::deepCopy(*data_) : Traits::copy(*data_));
+      }
+      owned_ = true;
+      deepOwned_ = deepOwned_ || deep || !Traits::sharesSubstructures;
+    }
+
+    Handle data_;
+    bool owned_, deepOwned_;
+  };
+
+}}}
+
+#endif
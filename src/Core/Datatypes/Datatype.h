@@ -33,6 +33,7 @@
 #include <Core/Datatypes/DatatypeFwd.h>
 #include <Core/Datatypes/HasId.h>
 #include <Core/Datatypes/share.h>
+#include <cstdint>
 
 namespace SCIRun {
 namespace Core {
@@ -58,6 +59,12 @@ namespace Datatypes {
     virtual Datatype* clone() const = 0;
 
     virtual std::string dynamic_type_name() const = 0;
+
+    /// Approximate memory footprint of the payload in bytes, 0 when unknown.
+    virtual size_t sizeInBytes() const { return 0; }
+
+    /// Hash of the payload that is stable across sessions, 0 when the type cannot be hashed.
+    virtual uint64_t contentHash() const { return 0; }
   };
 
 }}}
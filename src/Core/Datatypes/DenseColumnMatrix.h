@@ -75,6 +75,11 @@ namespace Datatypes {
 
     virtual size_t nrows() const override { return this->rows(); }
     virtual size_t ncols() const override { return this->cols(); }
+    virtual size_t sizeInBytes() const override { return this->size() * sizeof(T); }
+    virtual uint64_t contentHash() const override
+    {
+      return ContentHasher().add(this->rows()).addBytes(this->data(), sizeInBytes()).value();
+    }
     virtual T get(int i, int j) const override
     {
       return (*this)(i,j);
@@ -88,6 +88,11 @@ namespace Datatypes {
 
     virtual size_t nrows() const override { return this->rows(); }
     virtual size_t ncols() const override { return this->cols(); }
+    virtual size_t sizeInBytes() const override { return this->size() * sizeof(T); }
+    virtual uint64_t contentHash() const override
+    {
+      return ContentHasher().add(this->rows()).add(this->cols()).addBytes(this->data(), sizeInBytes()).value();
+    }
 
     virtual void accept(MatrixVisitorGeneric<T>& visitor) override
     {
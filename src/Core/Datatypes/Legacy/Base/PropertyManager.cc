@@ -41,6 +41,9 @@
 
 #include <Core/Datatypes/Legacy/Base/PropertyManager.h>
 #include <Core/Utils/Legacy/MemoryUtil.h>
+#include <Core/Persistent/Pstreams.h>
+#include <Core/Datatypes/ContentHash.h>
+#include <sstream>
 
 using namespace SCIRun::Core::Thread;
 
@@ -330,4 +333,28 @@ PropertyManager::io(Piostream &stream)
 }
 
 
+uint64_t
+PropertyManager::contentHash() const
+{
+  // Written as in io(), through a text stream, so that any property value
+  // that can be saved is hashed; transient properties are left out
+  std::ostringstream text;
+  {
+    TextPiostream textStream(&text);
+    Piostream& stream = textStream;
+    Guard g(lock.get());
+    for (const auto& p : properties_)
+    {
+      if (p.second->transient())
+        continue;
+      std::string name = p.first;
+      Pio(stream, name);
+      PersistentHandle x = p.second;
+      stream.io(x, PropertyBase::type_id);
+    }
+  }
+  return Core::Datatypes::ContentHasher().add(text.str()).value();
+}
+
+
 } // namespace SCIRun
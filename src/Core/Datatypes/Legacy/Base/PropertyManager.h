@@ -48,6 +48,7 @@
 #include <Core/Thread/Mutex.h>
 #include <Core/Containers/Array1.h>
 
+#include <cstdint>
 #include <iostream>
 #include <map>
 
@@ -222,6 +223,10 @@ public:
 
   void remove_property( const std::string & );
 
+  /// Hash of the names and values of the non-transient properties, the same
+  /// in every process. Covers every property type that can be persisted.
+  uint64_t contentHash() const;
+
   //NOTE: do NOT change this type to size_t to avoid casting below! it will break reading all old matrix/field types.
   typedef unsigned int PropertyManagerSize;
   PropertyManagerSize nproperties() const { return static_cast<PropertyManagerSize>(properties_.size()); }
@@ -252,7 +257,7 @@ protected:
 
   bool frozen_;
 
-  Core::Thread::Mutex lock;
+  mutable Core::Thread::Mutex lock;
 };
 
 
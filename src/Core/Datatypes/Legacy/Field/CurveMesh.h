@@ -492,6 +492,7 @@ public:
   /// use these to build up a new contour mesh
   typename Node::index_type add_node(const Core::Geometry::Point &p)
   {
+    topologyChanged();
     points_.push_back(p);
     return static_cast<under_type>(points_.size() - 1);
   }
@@ -502,6 +503,7 @@ public:
   typename Edge::index_type add_edge(typename Node::index_type i1,
                                      typename Node::index_type i2)
   {
+    topologyChanged();
     edges_.push_back(i1);
     edges_.push_back(i2);
     return static_cast<index_type>((edges_.size()>>1)-1);
@@ -510,6 +512,7 @@ public:
   template <class ARRAY>
   typename Elem::index_type add_elem(ARRAY a)
   {
+    topologyChanged();
     ASSERTMSG(a.size() == 2, "Tried to add non-line element.");
     edges_.push_back(static_cast<typename Node::index_type>(a[0]));
     edges_.push_back(static_cast<typename Node::index_type>(a[1]));
@@ -520,8 +523,8 @@ public:
   /// nodes/elements one needs, prereserving memory is often possible.
   void node_reserve(size_type s) { points_.reserve(static_cast<size_t>(s)); }
   void elem_reserve(size_type s) { edges_.reserve(static_cast<size_t>(2*s)); }
-  void resize_nodes(size_type s) { points_.resize(static_cast<size_t>(s)); }
-  void resize_elems(size_type s) { edges_.resize(static_cast<size_t>(2*s)); }
+  void resize_nodes(size_type s) { topologyChanged(); points_.resize(static_cast<size_t>(s)); }
+  void resize_elems(size_type s) { topologyChanged(); edges_.resize(static_cast<size_t>(2*s)); }
 
   /// Get the local coordinates for a certain point within an element
   /// This function uses a couple of newton iterations to find the local
@@ -621,8 +624,8 @@ public:
     Jv.resize(3); 
     Core::Geometry::Vector v,w;
     Core::Geometry::Vector(Jv[0]).find_orthogonal(v,w);
-    Jv[1] = v.asPoint();
-    Jv[2] = w.asPoint();
+    Jv[1] = Core::Geometry::Point(v);
+    Jv[2] = Core::Geometry::Point(w);
     double min_jacobian = ScaledDetMatrix3P(Jv);
     
     size_type num_vertices = static_cast<size_type>(basis_.number_of_vertices());
@@ -631,8 +634,8 @@ public:
       basis_.derivate(basis_.unit_vertices[j],ed,Jv);
       Jv.resize(3); 
       Core::Geometry::Vector(Jv[0]).find_orthogonal(v,w);
-      Jv[1] = v.asPoint();
-      Jv[2] = w.asPoint();
+      Jv[1] = Core::Geometry::Point(v);
+      Jv[2] = Core::Geometry::Point(w);
       temp = ScaledDetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -653,8 +656,8 @@ public:
     Jv.resize(3); 
     Core::Geometry::Vector v,w;
     Core::Geometry::Vector(Jv[0]).find_orthogonal(v,w);
-    Jv[1] = v.asPoint();
-    Jv[2] = w.asPoint();
+    Jv[1] = Core::Geometry::Point(v);
+    Jv[2] = Core::Geometry::Point(w);
     double min_jacobian = DetMatrix3P(Jv);
     
     size_type num_vertices = static_cast<size_type>(basis_.number_of_vertices());
@@ -663,8 +666,8 @@ public:
       basis_.derivate(basis_.unit_vertices[j],ed,Jv);
       Jv.resize(3); 
       Core::Geometry::Vector(Jv[0]).find_orthogonal(v,w);
-      Jv[1] = v.asPoint();
-      Jv[2] = w.asPoint();
+      Jv[1] = Core::Geometry::Point(v);
+      Jv[2] = Core::Geometry::Point(w);
       temp = DetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -1210,6 +1213,7 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    topologyChanged();
     for (index_type n = 0; n < 2; ++n)
       edges_[idx * 2 + n] = static_cast<index_type>(array[n]);
   }
@@ -1733,6 +1737,7 @@ template <class Basis>
 void
 CurveMesh<Basis>::io(Piostream& stream)
 {
+  topologyChanged();
   int version = stream.begin_class(type_name(-1), CURVE_MESH_VERSION);
 
   Mesh::io(stream);
@@ -0,0 +1,706 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <Core/Datatypes/Legacy/Field/ElementGeometry.h>
+#include <Core/Basis/HexTrilinearLgn.h>
+#include <Core/Thread/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Basis;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  /// Number of elements every kernel processes side by side
+  const int LANES = 16;
+
+  /// Node coordinates of a run of elements, one row per element node
+  template <class T, int N>
+  struct ElementLanes
+  {
+    T x[N][LANES];
+    T y[N][LANES];
+    T z[N][LANES];
+  };
+
+  /// Jacobians of a run of elements, rows (a b c), (d e f) and (g h i)
+  template <class T>
+  struct JacobianLanes
+  {
+    T a[LANES], b[LANES], c[LANES];
+    T d[LANES], e[LANES], f[LANES];
+    T g[LANES], h[LANES], i[LANES];
+
+    void determinant(T* det) const
+    {
+      for (int l = 0; l < LANES; ++l)
+        det[l] = a[l]*e[l]*i[l] - c[l]*e[l]*g[l] + b[l]*f[l]*g[l] +
+                 c[l]*d[l]*h[l] - a[l]*f[l]*h[l] - b[l]*d[l]*i[l];
+    }
+
+    // Same as ScaledDetMatrix3P
+    void scaled_determinant(T* det) const
+    {
+      determinant(det);
+      for (int l = 0; l < LANES; ++l)
+        det[l] /= std::sqrt((a[l]*a[l] + b[l]*b[l] + c[l]*c[l]) *
+                            (d[l]*d[l] + e[l]*e[l] + f[l]*f[l]) *
+                            (g[l]*g[l] + h[l]*h[l] + i[l]*i[l]));
+    }
+
+    // Same as InverseMatrix3P
+    void inverse(T inv[9][LANES], T* det) const
+    {
+      determinant(det);
+      for (int l = 0; l < LANES; ++l)
+      {
+        const T s = (det[l] != 0 ? T(1) / det[l] : T(0));
+        inv[0][l] = (e[l]*i[l] - f[l]*h[l]) * s;
+        inv[1][l] = (c[l]*h[l] - b[l]*i[l]) * s;
+        inv[2][l] = (b[l]*f[l] - c[l]*e[l]) * s;
+        inv[3][l] = (f[l]*g[l] - d[l]*i[l]) * s;
+        inv[4][l] = (a[l]*i[l] - c[l]*g[l]) * s;
+        inv[5][l] = (c[l]*d[l] - a[l]*f[l]) * s;
+        inv[6][l] = (d[l]*h[l] - e[l]*g[l]) * s;
+        inv[7][l] = (b[l]*g[l] - a[l]*h[l]) * s;
+        inv[8][l] = (a[l]*e[l] - b[l]*d[l]) * s;
+      }
+    }
+  };
+
+  template <class T, int N>
+  void gather(ElementLanes<T,N>& lanes, const MeshNodeArrays<T>& nodes,
+              const VMesh::index_type* elems, VMesh::index_type first, int count)
+  {
+    const T* x = nodes.x();
+    const T* y = nodes.y();
+    const T* z = nodes.z();
+    const VMesh::index_type* e = elems + first * N;
+    for (int l = 0; l < count; ++l, e += N)
+    {
+      for (int k = 0; k < N; ++k)
+      {
+        lanes.x[k][l] = x[e[k]];
+        lanes.y[k][l] = y[e[k]];
+        lanes.z[k][l] = z[e[k]];
+      }
+    }
+
+    // Lanes past the end repeat the last element, so kernels always run full width
+    for (int l = count; l < LANES; ++l)
+    {
+      for (int k = 0; k < N; ++k)
+      {
+        lanes.x[k][l] = lanes.x[k][count - 1];
+        lanes.y[k][l] = lanes.y[k][count - 1];
+        lanes.z[k][l] = lanes.z[k][count - 1];
+      }
+    }
+  }
+
+  /// Calls kernel(lanes, result_offset, count) for each run of LANES elements
+  template <class T, int N, class KERNEL>
+  void for_each_run(const MeshNodeArrays<T>& nodes, const VMesh::index_type* elems,
+                    VMesh::index_type begin, VMesh::index_type end, KERNEL kernel)
+  {
+    ElementLanes<T,N> lanes;
+    for (VMesh::index_type first = begin; first < end; first += LANES)
+    {
+      const int count = static_cast<int>(std::min<VMesh::index_type>(LANES, end - first));
+      gather(lanes, nodes, elems, first, count);
+      kernel(lanes, first - begin, count);
+    }
+  }
+
+  template <class T, int N>
+  void first_edges(const ElementLanes<T,N>& p, JacobianLanes<T>& J)
+  {
+    for (int l = 0; l < LANES; ++l)
+    {
+      J.a[l] = p.x[1][l] - p.x[0][l]; J.b[l] = p.y[1][l] - p.y[0][l]; J.c[l] = p.z[1][l] - p.z[0][l];
+      J.d[l] = p.x[2][l] - p.x[0][l]; J.e[l] = p.y[2][l] - p.y[0][l]; J.f[l] = p.z[2][l] - p.z[0][l];
+    }
+  }
+
+  /// Jacobian of a linear tet: rows p1-p0, p2-p0 and p3-p0 (TetLinearLgn::derivate)
+  template <class T>
+  void simplex_jacobian(const ElementLanes<T,4>& p, JacobianLanes<T>& J)
+  {
+    first_edges(p, J);
+    for (int l = 0; l < LANES; ++l)
+    {
+      J.g[l] = p.x[3][l] - p.x[0][l]; J.h[l] = p.y[3][l] - p.y[0][l]; J.i[l] = p.z[3][l] - p.z[0][l];
+    }
+  }
+
+  /// Jacobian of a linear triangle: rows p1-p0, p2-p0 and the unit normal
+  /// (TriSurfMesh::inverse_jacobian)
+  template <class T>
+  void simplex_jacobian(const ElementLanes<T,3>& p, JacobianLanes<T>& J)
+  {
+    first_edges(p, J);
+    for (int l = 0; l < LANES; ++l)
+    {
+      const T nx = J.b[l]*J.f[l] - J.c[l]*J.e[l];
+      const T ny = J.c[l]*J.d[l] - J.a[l]*J.f[l];
+      const T nz = J.a[l]*J.e[l] - J.b[l]*J.d[l];
+      const T len = std::sqrt(nx*nx + ny*ny + nz*nz);
+      const T s = (len > 0 ? T(1) / len : T(1));
+      J.g[l] = nx * s; J.h[l] = ny * s; J.i[l] = nz * s;
+    }
+  }
+
+  /// Jacobian of a trilinear hex for the derivative weights w (HexElementWeights)
+  template <class T>
+  void hex_jacobian(const ElementLanes<T,8>& p, const double* w, JacobianLanes<T>& J)
+  {
+    for (int l = 0; l < LANES; ++l)
+    {
+      J.a[l] = J.b[l] = J.c[l] = J.d[l] = J.e[l] = J.f[l] = J.g[l] = J.h[l] = J.i[l] = 0;
+    }
+    for (int k = 0; k < 8; ++k)
+    {
+      const T wx = static_cast<T>(w[k]), wy = static_cast<T>(w[8 + k]), wz = static_cast<T>(w[16 + k]);
+      for (int l = 0; l < LANES; ++l)
+      {
+        J.a[l] += wx * p.x[k][l]; J.b[l] += wx * p.y[k][l]; J.c[l] += wx * p.z[k][l];
+        J.d[l] += wy * p.x[k][l]; J.e[l] += wy * p.y[k][l]; J.f[l] += wy * p.z[k][l];
+        J.g[l] += wz * p.x[k][l]; J.h[l] += wz * p.y[k][l]; J.i[l] += wz * p.z[k][l];
+      }
+    }
+  }
+
+  /// Edge lengths of a run of elements, for the edge pairs listed in edges
+  template <class T, int N, int M>
+  void edge_lengths(const ElementLanes<T,N>& p, const int (&edges)[M][2], T (&len)[M][LANES])
+  {
+    for (int m = 0; m < M; ++m)
+    {
+      const int u = edges[m][0], v = edges[m][1];
+      for (int l = 0; l < LANES; ++l)
+      {
+        const T dx = p.x[v][l] - p.x[u][l];
+        const T dy = p.y[v][l] - p.y[u][l];
+        const T dz = p.z[v][l] - p.z[u][l];
+        len[m][l] = std::sqrt(dx*dx + dy*dy + dz*dz);
+      }
+    }
+  }
+
+  // The edges in the order TetVolMesh and TriSurfMesh use them in their metrics
+  const int tet_edges[6][2] = { {0,1}, {1,2}, {2,0}, {0,3}, {1,3}, {2,3} };
+  const int tri_edges[3][2] = { {0,1}, {1,2}, {2,0} };
+
+  /// Derivative weights at the center and the vertices of the unit hex
+  struct HexWeights
+  {
+    double metric[9][24];
+    double volume[8][24];
+    HexWeights()
+    {
+      HexElementWeights weights;
+      weights.get_linear_derivate_weights(HexTrilinearLgnUnitElement::unit_center, metric[0]);
+      for (int j = 0; j < 8; ++j)
+      {
+        weights.get_linear_derivate_weights(HexTrilinearLgnUnitElement::unit_vertices[j], metric[j + 1]);
+        weights.get_linear_derivate_weights(HexGaussian2<double>::GaussianPoints[j], volume[j]);
+      }
+    }
+  };
+
+  const HexWeights& hex_weights()
+  {
+    static const HexWeights weights;
+    return weights;
+  }
+
+  template <class T>
+  void store(const T* values, int count, double* result)
+  {
+    for (int l = 0; l < count; ++l) result[l] = static_cast<double>(values[l]);
+  }
+
+  /// Node average of each element, summed in node order as the meshes do
+  template <class T, int N>
+  void store_centers(const ElementLanes<T,N>& p, T scale, int count, Point* result)
+  {
+    T cx[LANES], cy[LANES], cz[LANES];
+    for (int l = 0; l < LANES; ++l)
+    {
+      cx[l] = p.x[0][l]; cy[l] = p.y[0][l]; cz[l] = p.z[0][l];
+    }
+    for (int k = 1; k < N; ++k)
+    {
+      for (int l = 0; l < LANES; ++l)
+      {
+        cx[l] += p.x[k][l]; cy[l] += p.y[k][l]; cz[l] += p.z[k][l];
+      }
+    }
+    for (int l = 0; l < count; ++l)
+      result[l] = Point(cx[l] * scale, cy[l] * scale, cz[l] * scale);
+  }
+}
+
+template <class T>
+void
+MeshNodeArrays<T>::assign(VMesh* mesh)
+{
+  const size_t num_nodes = mesh->num_nodes();
+  x_.resize(num_nodes);
+  y_.resize(num_nodes);
+  z_.resize(num_nodes);
+
+  const Point* points = mesh->get_points_pointer();
+  Parallel::For(0, num_nodes, [&](size_t begin, size_t end)
+  {
+    Point p;
+    for (size_t j = begin; j < end; ++j)
+    {
+      if (points) p = points[j];
+      else mesh->get_center(p, VMesh::Node::index_type(j));
+      x_[j] = static_cast<T>(p.x());
+      y_[j] = static_cast<T>(p.y());
+      z_[j] = static_cast<T>(p.z());
+    }
+  });
+}
+
+template <class T>
+ElementGeometry<T>::ElementGeometry(VMesh* mesh) :
+  type_(NONE),
+  num_elems_(0),
+  nodes_per_elem_(0),
+  elems_(0)
+{
+  if (!mesh || !mesh->is_linearmesh()) return;
+
+  // Only the unstructured meshes have a connectivity array
+  if (mesh->is_tetvolmesh()) { type_ = TET; nodes_per_elem_ = 4; }
+  else if (mesh->is_trisurfmesh()) { type_ = TRI; nodes_per_elem_ = 3; }
+  else if (mesh->is_hexvolmesh()) { type_ = HEX; nodes_per_elem_ = 8; }
+  else return;
+
+  num_elems_ = mesh->num_elems();
+  elems_ = mesh->get_elems_pointer();
+  nodes_.assign(mesh);
+}
+
+template <class T>
+void
+ElementGeometry<T>::volumes(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+                            double* result) const
+{
+  T vol[LANES];
+  if (type_ == TET)
+  {
+    for_each_run<T,4>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,4>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      simplex_jacobian(p, J);
+      J.determinant(vol);
+      for (int l = 0; l < LANES; ++l) vol[l] *= T(1.0/6.0);
+      store(vol, count, result + offset);
+    });
+  }
+  else if (type_ == TRI)
+  {
+    for_each_run<T,3>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,3>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      first_edges(p, J);
+      for (int l = 0; l < LANES; ++l)
+      {
+        const T nx = J.b[l]*J.f[l] - J.c[l]*J.e[l];
+        const T ny = J.c[l]*J.d[l] - J.a[l]*J.f[l];
+        const T nz = J.a[l]*J.e[l] - J.b[l]*J.d[l];
+        vol[l] = std::sqrt(nx*nx + ny*ny + nz*nz) * T(0.5);
+      }
+      store(vol, count, result + offset);
+    });
+  }
+  else if (type_ == HEX)
+  {
+    const HexWeights& w = hex_weights();
+    for_each_run<T,8>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,8>& p, VMesh::index_type offset, int count)
+    {
+      // Second order Gaussian quadrature, as HexTrilinearLgn::get_volume
+      JacobianLanes<T> J;
+      T det[LANES];
+      for (int l = 0; l < LANES; ++l) vol[l] = 0;
+      for (int q = 0; q < 8; ++q)
+      {
+        hex_jacobian(p, w.volume[q], J);
+        J.determinant(det);
+        const T weight = static_cast<T>(HexGaussian2<double>::GaussianWeights[q]);
+        for (int l = 0; l < LANES; ++l) vol[l] += weight * det[l];
+      }
+      store(vol, count, result + offset);
+    });
+  }
+}
+
+template <class T>
+void
+ElementGeometry<T>::centers(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+                            Point* result) const
+{
+  if (type_ == TET)
+  {
+    for_each_run<T,4>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,4>& p, VMesh::index_type offset, int count)
+    {
+      store_centers(p, T(0.25), count, result + offset);
+    });
+  }
+  else if (type_ == TRI)
+  {
+    for_each_run<T,3>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,3>& p, VMesh::index_type offset, int count)
+    {
+      store_centers(p, static_cast<T>(1.0/3.0), count, result + offset);
+    });
+  }
+  else if (type_ == HEX)
+  {
+    for_each_run<T,8>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,8>& p, VMesh::index_type offset, int count)
+    {
+      store_centers(p, T(0.125), count, result + offset);
+    });
+  }
+}
+
+template <class T>
+void
+ElementGeometry<T>::jacobians(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+                              double* result) const
+{
+  // The jacobian of linear simplices is the same at the center and every vertex
+  T det[LANES];
+  if (type_ == TET)
+  {
+    for_each_run<T,4>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,4>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      simplex_jacobian(p, J);
+      J.determinant(det);
+      store(det, count, result + offset);
+    });
+  }
+  else if (type_ == TRI)
+  {
+    for_each_run<T,3>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,3>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      simplex_jacobian(p, J);
+      J.determinant(det);
+      store(det, count, result + offset);
+    });
+  }
+  else if (type_ == HEX)
+  {
+    const HexWeights& w = hex_weights();
+    for_each_run<T,8>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,8>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      T minimum[LANES];
+      for (int q = 0; q < 9; ++q)
+      {
+        hex_jacobian(p, w.metric[q], J);
+        J.determinant(q == 0 ? minimum : det);
+        if (q > 0) for (int l = 0; l < LANES; ++l) minimum[l] = std::min(minimum[l], det[l]);
+      }
+      store(minimum, count, result + offset);
+    });
+  }
+}
+
+template <class T>
+void
+ElementGeometry<T>::scaled_jacobians(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+                                     double* result) const
+{
+  T det[LANES];
+  if (type_ == TET)
+  {
+    for_each_run<T,4>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,4>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      simplex_jacobian(p, J);
+      J.determinant(det);
+      T len[6][LANES];
+      edge_lengths(p, tet_edges, len);
+      for (int l = 0; l < LANES; ++l)
+      {
+        T scale = len[0][l]*len[2][l]*len[3][l];
+        scale = std::max(scale, len[0][l]*len[1][l]*len[4][l]);
+        scale = std::max(scale, len[1][l]*len[2][l]*len[5][l]);
+        scale = std::max(scale, len[3][l]*len[4][l]*len[5][l]);
+        scale = std::max(scale, det[l]);
+        det[l] = T(std::sqrt(2.0)) * det[l] / scale;
+      }
+      store(det, count, result + offset);
+    });
+  }
+  else if (type_ == TRI)
+  {
+    for_each_run<T,3>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,3>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      simplex_jacobian(p, J);
+      J.determinant(det);
+      T len[3][LANES];
+      edge_lengths(p, tri_edges, len);
+      for (int l = 0; l < LANES; ++l)
+      {
+        T scale = len[0][l]*len[1][l];
+        scale = std::max(scale, len[1][l]*len[2][l]);
+        scale = std::max(scale, len[0][l]*len[2][l]);
+        det[l] /= scale;
+      }
+      store(det, count, result + offset);
+    });
+  }
+  else if (type_ == HEX)
+  {
+    const HexWeights& w = hex_weights();
+    for_each_run<T,8>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,8>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      T minimum[LANES];
+      for (int q = 0; q < 9; ++q)
+      {
+        hex_jacobian(p, w.metric[q], J);
+        J.scaled_determinant(q == 0 ? minimum : det);
+        if (q > 0) for (int l = 0; l < LANES; ++l) minimum[l] = std::min(minimum[l], det[l]);
+      }
+      store(minimum, count, result + offset);
+    });
+  }
+}
+
+template <class T>
+bool
+ElementGeometry<T>::inscribed_circumscribed_ratios(VMesh::Elem::index_type begin,
+                                                   VMesh::Elem::index_type end,
+                                                   double* result) const
+{
+  if (type_ != TET) return false;
+
+  T ratio[LANES];
+  for_each_run<T,4>(nodes_, elems_, begin, end,
+    [&](const ElementLanes<T,4>& p, VMesh::index_type offset, int count)
+  {
+    JacobianLanes<T> J;
+    T vol[LANES];
+    simplex_jacobian(p, J);
+    J.determinant(vol);
+    T len[6][LANES];
+    edge_lengths(p, tet_edges, len);
+    for (int l = 0; l < LANES; ++l)
+    {
+      const T l0 = len[0][l], l1 = len[1][l], l2 = len[2][l];
+      const T l3 = len[3][l], l4 = len[4][l], l5 = len[5][l];
+      const T volume = vol[l] * T(1.0/6.0);
+
+      // Faces by Heron's formula
+      const T sa = T(0.5)*(l0 + l1 + l2);
+      const T sb = T(0.5)*(l1 + l4 + l5);
+      const T sc = T(0.5)*(l2 + l3 + l5);
+      const T sd = T(0.5)*(l0 + l3 + l4);
+      const T area = std::sqrt(sa*(sa - l0)*(sa - l1)*(sa - l2)) +
+                     std::sqrt(sb*(sb - l1)*(sb - l4)*(sb - l5)) +
+                     std::sqrt(sc*(sc - l2)*(sc - l3)*(sc - l5)) +
+                     std::sqrt(sd*(sd - l0)*(sd - l3)*(sd - l4));
+
+      const T products = (l0*l5 + l1*l3 + l2*l4) / T(2.0);
+      const T r_in = T(3.0) * volume / area;
+      const T r_cir = std::sqrt(products*(products - l0*l5)*(products - l1*l3)*(products - l2*l4)) /
+                      (T(6.0) * volume);
+      // For an equilateral tet the circumscribed radius is three times the inscribed one
+      ratio[l] = (r_in / r_cir) / T(0.333333);
+    }
+    store(ratio, count, result + offset);
+  });
+  return true;
+}
+
+template <class T>
+bool
+ElementGeometry<T>::inverse_jacobians(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+                                      double* inverse, double* determinant) const
+{
+  if (type_ != TET && type_ != TRI) return false;
+
+  T inv[9][LANES];
+  T det[LANES];
+  auto kernel = [&](const JacobianLanes<T>& J, VMesh::index_type offset, int count)
+  {
+    J.inverse(inv, det);
+    for (int l = 0; l < count; ++l)
+    {
+      double* Ji = inverse + 9 * (offset + l);
+      for (int k = 0; k < 9; ++k) Ji[k] = static_cast<double>(inv[k][l]);
+      determinant[offset + l] = static_cast<double>(det[l]);
+    }
+  };
+
+  if (type_ == TET)
+  {
+    for_each_run<T,4>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,4>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      simplex_jacobian(p, J);
+      kernel(J, offset, count);
+    });
+  }
+  else
+  {
+    for_each_run<T,3>(nodes_, elems_, begin, end,
+      [&](const ElementLanes<T,3>& p, VMesh::index_type offset, int count)
+    {
+      JacobianLanes<T> J;
+      simplex_jacobian(p, J);
+      kernel(J, offset, count);
+    });
+  }
+  return true;
+}
+
+template <class T>
+bool
+ElementGeometry<T>::local_coords(const VMesh::Elem::index_type* elems,
+                                 const Point* points, size_t count,
+                                 VMesh::coords_type* coords) const
+{
+  if (type_ != TET && type_ != TRI) return false;
+
+  const T* x = nodes_.x();
+  const T* y = nodes_.y();
+  const T* z = nodes_.z();
+  const int n = nodes_per_elem_;
+
+  for (size_t first = 0; first < count; first += LANES)
+  {
+    const int num = static_cast<int>(std::min<size_t>(LANES, count - first));
+
+    // Edges from the first node and the offset of the point from it
+    T e[3][3][LANES];
+    T d[3][LANES];
+    for (int l = 0; l < LANES; ++l)
+    {
+      const size_t j = first + std::min(l, num - 1);
+      const VMesh::index_type* nodes = elems_ + elems[j] * n;
+      const VMesh::index_type n0 = nodes[0];
+      for (int k = 1; k < n; ++k)
+      {
+        e[k-1][0][l] = x[nodes[k]] - x[n0];
+        e[k-1][1][l] = y[nodes[k]] - y[n0];
+        e[k-1][2][l] = z[nodes[k]] - z[n0];
+      }
+      d[0][l] = static_cast<T>(points[j].x()) - x[n0];
+      d[1][l] = static_cast<T>(points[j].y()) - y[n0];
+      d[2][l] = static_cast<T>(points[j].z()) - z[n0];
+    }
+
+    T u[3][LANES];
+    if (type_ == TET)
+    {
+      // Cramer's rule on [e0 e1 e2] u = d
+      for (int l = 0; l < LANES; ++l)
+      {
+        // e1 x e2
+        const T c0x = e[1][1][l]*e[2][2][l] - e[1][2][l]*e[2][1][l];
+        const T c0y = e[1][2][l]*e[2][0][l] - e[1][0][l]*e[2][2][l];
+        const T c0z = e[1][0][l]*e[2][1][l] - e[1][1][l]*e[2][0][l];
+        const T det = e[0][0][l]*c0x + e[0][1][l]*c0y + e[0][2][l]*c0z;
+        const T s = (det != 0 ? T(1) / det : T(0));
+
+        // d x e2 and e1 x d
+        const T c1x = d[1][l]*e[2][2][l] - d[2][l]*e[2][1][l];
+        const T c1y = d[2][l]*e[2][0][l] - d[0][l]*e[2][2][l];
+        const T c1z = d[0][l]*e[2][1][l] - d[1][l]*e[2][0][l];
+        const T c2x = e[1][1][l]*d[2][l] - e[1][2][l]*d[1][l];
+        const T c2y = e[1][2][l]*d[0][l] - e[1][0][l]*d[2][l];
+        const T c2z = e[1][0][l]*d[1][l] - e[1][1][l]*d[0][l];
+
+        u[0][l] = (d[0][l]*c0x + d[1][l]*c0y + d[2][l]*c0z) * s;
+        u[1][l] = (e[0][0][l]*c1x + e[0][1][l]*c1y + e[0][2][l]*c1z) * s;
+        u[2][l] = (e[0][0][l]*c2x + e[0][1][l]*c2y + e[0][2][l]*c2z) * s;
+      }
+    }
+    else
+    {
+      // Normal equations of the projection onto the plane of the triangle
+      for (int l = 0; l < LANES; ++l)
+      {
+        const T a = e[0][0][l]*e[0][0][l] + e[0][1][l]*e[0][1][l] + e[0][2][l]*e[0][2][l];
+        const T b = e[0][0][l]*e[1][0][l] + e[0][1][l]*e[1][1][l] + e[0][2][l]*e[1][2][l];
+        const T c = e[1][0][l]*e[1][0][l] + e[1][1][l]*e[1][1][l] + e[1][2][l]*e[1][2][l];
+        const T r0 = e[0][0][l]*d[0][l] + e[0][1][l]*d[1][l] + e[0][2][l]*d[2][l];
+        const T r1 = e[1][0][l]*d[0][l] + e[1][1][l]*d[1][l] + e[1][2][l]*d[2][l];
+        const T det = a*c - b*b;
+        const T s = (det != 0 ? T(1) / det : T(0));
+        u[0][l] = (c*r0 - b*r1) * s;
+        u[1][l] = (a*r1 - b*r0) * s;
+        u[2][l] = 0;
+      }
+    }
+
+    for (int l = 0; l < num; ++l)
+    {
+      VMesh::coords_type& c = coords[first + l];
+      c.resize(n - 1);
+      for (int k = 0; k < n - 1; ++k) c[k] = static_cast<double>(u[k][l]);
+    }
+  }
+  return true;
+}
+
+namespace SCIRun {
+  template class MeshNodeArrays<float>;
+  template class MeshNodeArrays<double>;
+  template class ElementGeometry<float>;
+  template class ElementGeometry<double>;
+}
@@ -0,0 +1,136 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#ifndef CORE_DATATYPES_ELEMENTGEOMETRY_H
+#define CORE_DATATYPES_ELEMENTGEOMETRY_H
+
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+
+#include <vector>
+
+#include <Core/Datatypes/Legacy/Field/share.h>
+
+namespace SCIRun {
+
+/// Structure of arrays copy of the node positions of a mesh, in float or
+/// double precision. The batch kernels below read the coordinates of a run
+/// of elements from here instead of going through Point one node at a time.
+template <class T>
+class SCISHARE MeshNodeArrays
+{
+public:
+  MeshNodeArrays() {}
+  explicit MeshNodeArrays(VMesh* mesh) { assign(mesh); }
+
+  /// Copy the node positions of the mesh, in parallel
+  void assign(VMesh* mesh);
+
+  size_t size() const { return x_.size(); }
+  const T* x() const { return x_.data(); }
+  const T* y() const { return y_.data(); }
+  const T* z() const { return z_.data(); }
+
+private:
+  std::vector<T> x_;
+  std::vector<T> y_;
+  std::vector<T> z_;
+};
+
+/// Batch geometry kernels for linear TetVol, TriSurf and HexVol meshes.
+///
+/// The nodes of each run of elements are gathered into fixed width lanes and
+/// every kernel is a branch free loop over those lanes, which the compiler
+/// vectorizes. The results match the per element VMesh calls named next to
+/// each kernel. The object keeps a pointer to the element connectivity, so
+/// the mesh has to outlive it and must not be edited in the meantime.
+///
+/// T is the precision the node positions are stored and computed in.
+template <class T>
+class SCISHARE ElementGeometry
+{
+public:
+  enum ElementType { NONE, TET, TRI, HEX };
+
+  explicit ElementGeometry(VMesh* mesh);
+
+  /// False if the mesh has no batch kernels (other element types, higher
+  /// order geometry or regular meshes); use the VMesh calls then.
+  bool supported() const { return (type_ != NONE); }
+  ElementType type() const { return type_; }
+  VMesh::size_type num_elems() const { return num_elems_; }
+  const MeshNodeArrays<T>& nodes() const { return nodes_; }
+
+  /// Element volumes for tets and hexes, areas for triangles (VMesh::get_size)
+  void volumes(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+               double* result) const;
+
+  /// Element centers (VMesh::get_center)
+  void centers(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+               Core::Geometry::Point* result) const;
+
+  /// Smallest determinant of the jacobian (VMesh::jacobian_metric)
+  void jacobians(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+                 double* result) const;
+
+  /// Scaled jacobian (VMesh::scaled_jacobian_metric)
+  void scaled_jacobians(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+                        double* result) const;
+
+  /// Inscribed to circumscribed radius ratio
+  /// (VMesh::inscribed_circumscribed_radius_metric), tets only
+  bool inscribed_circumscribed_ratios(VMesh::Elem::index_type begin,
+                                      VMesh::Elem::index_type end,
+                                      double* result) const;
+
+  /// Inverse jacobian (9 values, row major) and its determinant for elements
+  /// whose jacobian is constant, i.e. tets and triangles
+  /// (VMesh::inverse_jacobian). Returns false for hexes.
+  bool inverse_jacobians(VMesh::Elem::index_type begin, VMesh::Elem::index_type end,
+                         double* inverse, double* determinant) const;
+
+  /// Local coordinates of points[j] in element elems[j], solved directly
+  /// instead of iteratively (VMesh::get_coords). Triangles project the point
+  /// onto the plane of the element. Returns false for hexes. There is no
+  /// inside test: points outside an element get coordinates outside [0,1].
+  bool local_coords(const VMesh::Elem::index_type* elems,
+                    const Core::Geometry::Point* points, size_t count,
+                    VMesh::coords_type* coords) const;
+
+private:
+  ElementType type_;
+  VMesh::size_type num_elems_;
+  int nodes_per_elem_;
+  const VMesh::index_type* elems_;
+  MeshNodeArrays<T> nodes_;
+};
+
+} // end namespace SCIRun
+
+#endif
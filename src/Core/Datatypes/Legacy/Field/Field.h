@@ -32,6 +32,7 @@
 #define CORE_DATATYPES_LEGACY_FIELD_H 1
 
 #include <Core/Datatypes/Datatype.h>
+#include <Core/Datatypes/CopyOnWrite.h>
 #include <Core/Datatypes/Legacy/Field/FieldFwd.h>
 #include <Core/Datatypes/PropertyManagerExtensions.h>
 #include <Core/Datatypes/Legacy/Field/share.h>
@@ -59,6 +60,9 @@ class SCISHARE Field : public Core::Datatypes::Datatype, public Core::Datatypes:
     virtual VMesh* vmesh()   const = 0;
     virtual VField* vfield() const = 0;
 
+    /// Bytes held by the field values alone; sizeInBytes() adds the mesh.
+    virtual size_t valuesSizeInBytes() const { return 0; }
+
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
     /// Detach the mesh from the field, if needed make a new copy of it.
     // NOTE: IF THIS FUNCTION IS CALLED IN LEGACY CODE, IT MUST BE CONVERTED TO A deep_clone CALL ON THE FIELD OBJECT
@@ -86,6 +90,24 @@ class SCISHARE Field : public Core::Datatypes::Datatype, public Core::Datatypes:
 };
 
 
+namespace Core {
+namespace Datatypes {
+
+  /// write() clones the values and keeps sharing the mesh; writeDeep() copies the mesh as well.
+  template <>
+  struct CopyOnWriteTraits<Field>
+  {
+    static const bool sharesSubstructures = true;
+    static Field* copy(const Field& f) { return f.clone(); }
+    static Field* deepCopy(const Field& f) { return f.deep_clone(); }
+    static size_t copyBytes(const Field& f) { return f.valuesSizeInBytes(); }
+    static size_t deepCopyBytes(const Field& f) { return f.sizeInBytes(); }
+  };
+
+}}
+
+typedef Core::Datatypes::CopyOnWrite<Field> FieldCopyOnWrite;
+
 class SCISHARE FieldTypeID {
   public:
     // Constructor
@@ -0,0 +1,68 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_DATATYPES_FIELDSPAN_H
+#define CORE_DATATYPES_FIELDSPAN_H 1
+
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+
+namespace SCIRun {
+
+/// Typed view of an array stored inside a field or a mesh, so loops over the
+/// values can index it directly instead of making one virtual call per value.
+/// The view does not own the memory: it becomes invalid once the field or mesh
+/// is resized. A default constructed span is empty.
+template<class T>
+class FieldSpan
+{
+public:
+  typedef T value_type;
+  typedef VMesh::index_type index_type;
+  typedef VMesh::size_type  size_type;
+
+  FieldSpan() : data_(0), size_(0) {}
+  FieldSpan(T* data, size_type size) : data_(data), size_(data ? size : 0) {}
+
+  inline T* data() const { return (data_); }
+  inline size_type size() const { return (size_); }
+  inline bool empty() const { return (size_ == 0); }
+
+  inline T& operator[](index_type idx) const { return (data_[idx]); }
+
+  inline T* begin() const { return (data_); }
+  inline T* end() const { return (data_ + size_); }
+
+private:
+  T*        data_;
+  size_type size_;
+};
+
+}
+
+#endif
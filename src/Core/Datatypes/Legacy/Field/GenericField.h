@@ -41,11 +41,13 @@
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/VFData.h>
 #include <Core/Datatypes/Legacy/Base/TypeName.h>
+#include <Core/Datatypes/Legacy/Base/PropertyManager.h>
 #include <Core/Datatypes/Legacy/Field/MeshTypes.h>
 
 #include <Core/Persistent/PersistentSTL.h>
 #include <Core/Containers/FData.h>
 #include <Core/Datatypes/Legacy/Field/CastFData.h>
+#include <Core/Datatypes/ContentHash.h>
 #include <Core/Containers/StackVector.h>
 
 #include <Core/Datatypes/Legacy/Field/share.h>
@@ -86,6 +88,12 @@ public:
   virtual MeshHandle mesh() const;
   virtual VMesh*  vmesh() const;
   virtual VField* vfield() const;
+
+  /// Field data plus explicit node and connectivity storage of the mesh.
+  virtual size_t sizeInBytes() const;
+  virtual size_t valuesSizeInBytes() const;
+  /// Hashes the type, mesh geometry and connectivity, and the raw field values.
+  virtual uint64_t contentHash() const;
   
   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   /// Clone the mesh
@@ -378,6 +386,65 @@ GenericField<Mesh, Basis, FData>::vfield() const
   return (vfield_);
 }
 
+template <class Mesh, class Basis, class FData>
+size_t
+GenericField<Mesh, Basis, FData>::valuesSizeInBytes() const
+{
+  return fdata_.size() * sizeof(value_type);
+}
+
+template <class Mesh, class Basis, class FData>
+size_t
+GenericField<Mesh, Basis, FData>::sizeInBytes() const
+{
+  size_t bytes = valuesSizeInBytes();
+  if (mesh_)
+  {
+    VMesh* vmesh = mesh_->vmesh();
+    if (vmesh && !vmesh->is_regularmesh())
+    {
+      bytes += vmesh->num_nodes() * sizeof(Core::Geometry::Point);
+      if (!vmesh->is_structuredmesh())
+        bytes += vmesh->num_elems() * vmesh->num_nodes_per_elem() * sizeof(index_type);
+    }
+  }
+  return bytes;
+}
+
+template <class Mesh, class Basis, class FData>
+uint64_t
+GenericField<Mesh, Basis, FData>::contentHash() const
+{
+  Core::Datatypes::ContentHasher hasher;
+  hasher.add(type_id.type).add(basis_order());
+  if (mesh_)
+  {
+    VMesh* vmesh = mesh_->vmesh();
+    VMesh::Node::size_type numNodes = vmesh->num_nodes();
+    VMesh::Elem::size_type numElems = vmesh->num_elems();
+    hasher.add(numNodes).add(numElems);
+
+    Core::Geometry::Point p;
+    for (VMesh::Node::index_type i = 0; i < numNodes; ++i)
+    {
+      vmesh->get_center(p, i);
+      hasher.add(p.x()).add(p.y()).add(p.z());
+    }
+    VMesh::Node::array_type nodes;
+    for (VMesh::Elem::index_type i = 0; i < numElems; ++i)
+    {
+      vmesh->get_nodes(nodes, i);
+      if (!nodes.empty())
+        hasher.addBytes(&nodes[0], nodes.size() * sizeof(nodes[0]));
+    }
+  }
+  if (auto values = vfield_->fdata_pointer())
+    hasher.addBytes(values, valuesSizeInBytes());
+  // algorithms read settings such as conductivity_table from the properties
+  hasher.add(properties().contentHash());
+  return hasher.value();
+}
+
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
 template <class Mesh, class Basis, class FData>
 void
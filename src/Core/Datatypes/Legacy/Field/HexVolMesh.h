@@ -52,6 +52,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/MeshTopology.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Mesh/VirtualMeshFacade.h>
 
@@ -774,8 +775,8 @@ public:
   /// nodes/elements one needs, prereserving memory is often possible.
   void node_reserve(size_type s) { points_.reserve(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
   void elem_reserve(size_type s) { cells_.reserve(static_cast<std::vector<index_type>::size_type>(s*8)); }
-  void resize_nodes(size_type s) { points_.resize(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
-  void resize_elems(size_type s) { cells_.resize(static_cast<std::vector<index_type>::size_type>(s*8)); }
+  void resize_nodes(size_type s) { topologyChanged(); points_.resize(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
+  void resize_elems(size_type s) { topologyChanged(); cells_.resize(static_cast<std::vector<index_type>::size_type>(s*8)); }
 
   /// Get the local coordinates for a certain point within an element
   /// This function uses a couple of newton iterations to find the local
@@ -1809,7 +1810,7 @@ protected:
       "HexVolMesh: Must call synchronize EDGES_E first");
 
     // Get all the nodes that share an edge with this node
-    const std::vector<typename Cell::index_type>& neighbors = node_neighbors_[idx];
+    const typename node_neighbor_table::Row neighbors = node_neighbors_[idx];
 
     array.clear();
     array.reserve(neighbors.size());
@@ -1891,7 +1892,7 @@ protected:
       "HexVolMesh: Must call synchronize FACES_E first");
 
     array.clear();
-    const std::vector<typename Cell::index_type>& neighbors = node_neighbors_[idx];
+    const typename node_neighbor_table::Row neighbors = node_neighbors_[idx];
 
     // Iterate through all those edges
     for (size_t n = 0; n < neighbors.size(); n++)
@@ -2014,6 +2015,7 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    topologyChanged();
     for (index_type n = 0; n < 8; ++n)
       cells_[idx * 8 + n] = static_cast<index_type>(array[n]);
   }
@@ -2433,6 +2435,8 @@ protected:
   void compute_node_neighbors();
   void compute_edges();
   void compute_faces();
+  void compute_edges_sorted();
+  void compute_faces_sorted();
   void compute_node_grid();
   void compute_elem_grid();
   void compute_bounding_box();
@@ -2441,6 +2445,7 @@ protected:
   void remove_elem_from_grid(typename Elem::index_type ci);
   void insert_node_into_grid(typename Node::index_type ci);
   void remove_node_from_grid(typename Node::index_type ci);
+  Core::Geometry::BBox elem_grid_bbox(typename Elem::index_type ci) const;
 
   const Core::Geometry::Point &point(typename Node::index_type i) const { return points_[i]; }
 
@@ -2853,7 +2858,9 @@ protected:
     typename Node::array_type   nodes_;
   };
 
-  std::vector<std::vector<typename Cell::index_type> > node_neighbors_;
+  /// For each node the combined (cell<<3 | corner) indices that use it.
+  typedef MeshTopology::CompressedAdjacency<typename Cell::index_type> node_neighbor_table;
+  node_neighbor_table node_neighbors_;
   std::vector<unsigned char> boundary_faces_;
 
   /// This grid is used as an acceleration structure to expedite calls
@@ -3269,6 +3276,13 @@ template <class Basis>
 void
 HexVolMesh<Basis>::compute_faces()
 {
+  if (MeshTopology::construction() == MeshTopology::Construction::Sorted &&
+      MeshTopology::fitsPackedKeys(points_.size(), (cells_.size() >> 3) * 6))
+  {
+    compute_faces_sorted();
+    return;
+  }
+
   face_table_.clear();
 
   typename Cell::iterator ci, cie;
@@ -3349,6 +3363,13 @@ template <class Basis>
 void
 HexVolMesh<Basis>::compute_edges()
 {
+  if (MeshTopology::construction() == MeshTopology::Construction::Sorted &&
+      MeshTopology::fitsPackedKeys(points_.size(), (cells_.size() >> 3) * 12))
+  {
+    compute_edges_sorted();
+    return;
+  }
+
   typename Cell::iterator ci, cie;
   begin(ci); end(cie);
   edge_ht table;
@@ -3395,6 +3416,117 @@ HexVolMesh<Basis>::compute_edges()
   synchronize_lock_.unlock();
 }
 
+/// Same tables as compute_faces(), built by radix sorting the six faces of
+/// every cell on an orientation independent key so matching faces end up
+/// adjacent.
+template <class Basis>
+void
+HexVolMesh<Basis>::compute_faces_sorted()
+{
+  using namespace MeshTopology;
+  static const int face_nodes[6][4] = { {0,1,2,3}, {7,6,5,4}, {0,4,5,1},
+                                        {2,6,7,3}, {3,7,4,0}, {1,5,6,2} };
+  const size_t num_cells = cells_.size() >> 3;
+  const key_type key_limit = static_cast<key_type>(points_.size());
+  std::vector<Entry<4> > entries(num_cells * 6);
+
+  parallelFill(num_cells, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; ++c)
+    {
+      const under_type* n = &cells_[c << 3];
+      for (size_t f = 0; f < 6; ++f)
+      {
+        under_type q[4] = { n[face_nodes[f][0]], n[face_nodes[f][1]],
+                            n[face_nodes[f][2]], n[face_nodes[f][3]] };
+        if (order_face_nodes(q[0], q[1], q[2], q[3]))
+          setQuadFaceEntry(entries[6*c + f], q, 6*c + f);
+        else
+          setDegenerateEntry(entries[6*c + f], 6*c + f, key_limit);
+      }
+    }
+  });
+
+  sortEntries(entries, key_limit);
+
+  const size_t num_faces = countGroups(entries, key_limit);
+  faces_.clear();
+  faces_.resize(num_faces);
+  face_table_.clear();
+  face_table_.reserve(num_faces);
+  boundary_faces_.assign(num_cells, 0);
+
+  index_type uidx = 0;
+  forEachGroup(entries, key_limit, [&](const Entry<4>* first, const Entry<4>* last)
+  {
+    index_type* cells = faces_[uidx].cells_;
+    cells[0] = ((first->order / 6) << 3) + first->order % 6;
+    // As in hash_face(), a second face of the same cell and a third cell are ignored
+    for (const Entry<4>* e = first + 1; e != last && cells[1] == MESH_NO_NEIGHBOR; ++e)
+      if ((cells[0]>>3) != static_cast<index_type>(e->order / 6))
+        cells[1] = ((e->order / 6) << 3) + e->order % 6;
+
+    face_table_[PFaceNode(static_cast<under_type>(first->nodes[0]), static_cast<under_type>(first->nodes[1]),
+      static_cast<under_type>(first->nodes[2]), static_cast<under_type>(first->nodes[3]))] = uidx;
+
+    if (cells[1] == MESH_NO_NEIGHBOR)
+      boundary_faces_[cells[0] >> 3] |= 1 << (cells[0] & 0x7);
+    ++uidx;
+  });
+
+  synchronize_lock_.lock();
+  synchronized_ |= Mesh::FACES_E;
+  synchronize_lock_.unlock();
+}
+
+/// Same tables as compute_edges(), built by radix sorting the twelve edges of
+/// every cell on their node pairs.
+template <class Basis>
+void
+HexVolMesh<Basis>::compute_edges_sorted()
+{
+  using namespace MeshTopology;
+  static const int edge_nodes[12][2] = { {0,1}, {1,2}, {2,3}, {3,0}, {4,5}, {5,6},
+                                         {6,7}, {7,4}, {0,4}, {5,1}, {2,6}, {7,3} };
+  const size_t num_cells = cells_.size() >> 3;
+  const key_type key_limit = static_cast<key_type>(points_.size());
+  std::vector<Entry<2> > entries(num_cells * 12);
+
+  parallelFill(num_cells, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; ++c)
+    {
+      const under_type* n = &cells_[c << 3];
+      for (size_t j = 0; j < 12; ++j)
+        setEdgeEntry(entries[12*c + j], n[edge_nodes[j][0]], n[edge_nodes[j][1]], 12*c + j, key_limit);
+    }
+  });
+
+  sortEntries(entries, key_limit);
+
+  const size_t num_edges = countGroups(entries, key_limit);
+  edges_.clear();
+  edges_.resize(num_edges);
+  edge_table_.clear();
+  edge_table_.reserve(num_edges);
+
+  index_type uidx = 0;
+  forEachGroup(entries, key_limit, [&](const Entry<2>* first, const Entry<2>* last)
+  {
+    std::vector<index_type>& cells = edges_[uidx].cells_;
+    cells.reserve(last - first);
+    for (const Entry<2>* e = first; e != last; ++e)
+      cells.push_back(((e->order / 12) << 4) + e->order % 12);
+    edge_table_[PEdgeNode(static_cast<under_type>(first->nodes[0]),
+      static_cast<under_type>(first->nodes[1]))] = uidx;
+    ++uidx;
+  });
+
+  synchronize_lock_.lock();
+  synchronized_ |= Mesh::EDGES_E;
+  synchronize_lock_.unlock();
+}
+
 template <class Basis>
 bool
 HexVolMesh<Basis>::synchronize(mask_type sync)
@@ -3678,13 +3810,9 @@ template <class Basis>
 void
 HexVolMesh<Basis>::compute_node_neighbors()
 {
-  node_neighbors_.clear();
-  node_neighbors_.resize(points_.size());
-  index_type i, num_cells = cells_.size();
-  for (i = 0; i < num_cells; i++)
-  {
-    node_neighbors_[cells_[i]].push_back(i);
-  }
+  node_neighbors_.build(points_.size(), cells_.size(),
+    [this](size_t i) { return static_cast<size_t>(cells_[i]); },
+    [](size_t i) { return static_cast<typename Cell::index_type>(i); });
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
@@ -3727,12 +3855,9 @@ HexVolMesh<Basis>::get_weights(const Core::Geometry::Point &p, typename Cell::ar
 }
 
 template <class Basis>
-void
-HexVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+Core::Geometry::BBox
+HexVolMesh<Basis>::elem_grid_bbox(typename Elem::index_type ci) const
 {
-  /// @todo:  This can crash if you insert a new cell outside of the grid.
-  // Need to recompute grid at that point.
-
   const index_type idx = ci*8;
   Core::Geometry::BBox box;
   box.extend(points_[cells_[idx]]);
@@ -3744,26 +3869,23 @@ HexVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
   box.extend(points_[cells_[idx+6]]);
   box.extend(points_[cells_[idx+7]]);
   box.extend(epsilon_);
+  return box;
+}
 
-  elem_grid_->insert(ci, box);
+template <class Basis>
+void
+HexVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+{
+  /// @todo:  This can crash if you insert a new cell outside of the grid.
+  // Need to recompute grid at that point.
+  elem_grid_->insert(ci, elem_grid_bbox(ci));
 }
 
 template <class Basis>
 void
 HexVolMesh<Basis>::remove_elem_from_grid(typename Elem::index_type ci)
 {
-  const index_type idx = ci*8;
-  Core::Geometry::BBox box;
-  box.extend(points_[cells_[idx]]);
-  box.extend(points_[cells_[idx+1]]);
-  box.extend(points_[cells_[idx+2]]);
-  box.extend(points_[cells_[idx+3]]);
-  box.extend(points_[cells_[idx+4]]);
-  box.extend(points_[cells_[idx+5]]);
-  box.extend(points_[cells_[idx+6]]);
-  box.extend(points_[cells_[idx+7]]);
-  box.extend(epsilon_);
-  elem_grid_->remove(ci, box);
+  elem_grid_->remove(ci, elem_grid_bbox(ci));
 }
 
 template <class Basis>
@@ -3803,14 +3925,8 @@ HexVolMesh<Basis>::compute_elem_grid()
 
     Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
     elem_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Elem::iterator ci, cie;
-    begin(ci); end(cie);
-    while(ci != cie)
-    {
-      insert_elem_into_grid(*ci);
-      ++ci;
-    }
+    elem_grid_->fill_boxes(esz, [this](index_type ci)
+      { return elem_grid_bbox(typename Elem::index_type(ci)); });
   }
 
   synchronize_lock_.lock();
@@ -3840,14 +3956,8 @@ HexVolMesh<Basis>::compute_node_grid()
 
     Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
     node_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Node::iterator ni, nie;
-    begin(ni); end(nie);
-    while(ni != nie)
-    {
-      insert_node_into_grid(*ni);
-      ++ni;
-    }
+    node_grid_->fill_points(points_.size(), [this](index_type ni)
+      { return points_[ni]; });
   }
 
   synchronize_lock_.lock();
@@ -3882,6 +3992,7 @@ HexVolMesh<Basis>::add_hex(typename Node::index_type a,
                            typename Node::index_type g,
                            typename Node::index_type h)
 {
+  topologyChanged();
   const index_type hex = static_cast<index_type>(cells_.size()) / 8;
   cells_.push_back(a);
   cells_.push_back(b);
@@ -3898,6 +4009,7 @@ template <class Basis>
 typename HexVolMesh<Basis>::Node::index_type
 HexVolMesh<Basis>::add_point(const Core::Geometry::Point &p)
 {
+  topologyChanged();
   points_.push_back(p);
   return static_cast<typename Node::index_type>(points_.size() - 1);
 }
@@ -3909,6 +4021,7 @@ HexVolMesh<Basis>::add_hex(const Core::Geometry::Point &p0, const Core::Geometry
                            const Core::Geometry::Point &p4, const Core::Geometry::Point &p5,
                            const Core::Geometry::Point &p6, const Core::Geometry::Point &p7)
 {
+  topologyChanged();
   return add_hex(add_find_point(p0), add_find_point(p1),
 		 add_find_point(p2), add_find_point(p3),
 		 add_find_point(p4), add_find_point(p5),
@@ -3921,6 +4034,7 @@ template <class Basis>
 void
 HexVolMesh<Basis>::io(Piostream &stream)
 {
+  topologyChanged();
   const int version = stream.begin_class(type_name(-1), HEXVOLMESH_VERSION);
   Mesh::io(stream);
 
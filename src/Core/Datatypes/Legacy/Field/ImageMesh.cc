@@ -2693,7 +2693,7 @@ scaled_jacobian_metric(const VMesh::Elem::index_type idx) const
   Jv.resize(3);
   Vector v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1]));
   v.normalize();
-  Jv[2] = v.asPoint();
+  Jv[2] = Core::Geometry::Point(v);
   double min_jacobian = ScaledDetMatrix3P(Jv);
 
   size_t num_vertices = this->basis_->number_of_vertices();
@@ -2702,7 +2702,7 @@ scaled_jacobian_metric(const VMesh::Elem::index_type idx) const
     this->basis_->derivate(this->basis_->unit_vertices[j],ed,Jv);
     Jv.resize(3);
     Vector v = Cross(Vector(Jv[0]),Vector(Jv[1])); v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
     temp = ScaledDetMatrix3P(Jv);
     if(temp < min_jacobian) min_jacobian = temp;
   }
@@ -2723,7 +2723,7 @@ jacobian_metric(VMesh::Elem::index_type idx) const
   this->basis_->derivate(this->basis_->unit_center,ed,Jv);
   Jv.resize(3);
   Vector v = Cross(Vector(Jv[0]),Vector(Jv[1])); v.normalize();
-  Jv[2] = v.asPoint();
+  Jv[2] = Core::Geometry::Point(v);
   double min_jacobian = DetMatrix3P(Jv);
 
   size_t num_vertices = this->basis_->number_of_vertices();
@@ -2732,7 +2732,7 @@ jacobian_metric(VMesh::Elem::index_type idx) const
     this->basis_->derivate(this->basis_->unit_vertices[j],ed,Jv);
     Jv.resize(3);
     Vector v = Cross(Vector(Jv[0]),Vector(Jv[1])); v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
     temp = DetMatrix3P(Jv);
     if(temp < min_jacobian) min_jacobian = temp;
   }
@@ -49,7 +49,7 @@ using namespace SCIRun::Core::Thread;
 // initialize the static member type_id
 PersistentTypeID Mesh::type_id("Mesh", "Datatype", 0);
 
-Mesh::Mesh(const Mesh& copy) : Core::Datatypes::Datatype(copy) 
+Mesh::Mesh(const Mesh& copy) : Core::Datatypes::Datatype(copy), topologyGeneration_(0)
 { DEBUG_CONSTRUCTOR("Mesh");  }
 
 namespace 
@@ -365,7 +365,7 @@ MeshTypeID::MeshTypeID(const std::string& type,
 }
 
 
-Mesh::Mesh()
+Mesh::Mesh() : topologyGeneration_(0)
 {
   DEBUG_CONSTRUCTOR("Mesh")  
 }
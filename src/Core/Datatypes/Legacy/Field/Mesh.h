@@ -82,12 +82,22 @@ public:
     BOUNDING_BOX_E = 1 << 12,
     FIND_CLOSEST_NODE_E		= 1 << 13,
     FIND_CLOSEST_ELEM_E		= 1 << 14,
-    FIND_CLOSEST_E = FIND_CLOSEST_NODE_E | FIND_CLOSEST_ELEM_E
+    FIND_CLOSEST_E = FIND_CLOSEST_NODE_E | FIND_CLOSEST_ELEM_E,
+    /// Bounding volume hierarchy over the elements, which locate and
+    /// find_closest_elem then use instead of the element search grid. Only
+    /// TetVolMesh and TriSurfMesh build it; code that handles any mesh type
+    /// should ask for ELEM_LOCATE_E as well.
+    ELEM_BVH_E = 1 << 15
   };
 
   virtual bool synchronize(mask_type) { return false; }
   virtual bool unsynchronize(mask_type) { return false; }
 
+  /// Changes with every edit to the elements or the number of nodes, so data
+  /// derived from the connectivity, such as a matrix sparsity pattern, can
+  /// tell that it is stale. Moving a node leaves it alone.
+  unsigned int topologyGeneration() const { return topologyGeneration_; }
+
   virtual int basis_order();
 
   /// Persistent I/O.
@@ -101,6 +111,12 @@ public:
   /// object that has all the virtual functions. This object will be destroyed
   /// when the mesh is destroyed. The user does not need to destroy the VMesh.
   virtual VMesh* vmesh();
+
+protected:
+  void topologyChanged() { ++topologyGeneration_; }
+
+private:
+  unsigned int topologyGeneration_;
 };
 
 class SCISHARE MeshTypeID {
@@ -0,0 +1,332 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_DATATYPES_MESHTOPOLOGY_H
+#define CORE_DATATYPES_MESHTOPOLOGY_H 1
+
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Thread/Parallel.h>
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
+#include <vector>
+
+#include <Core/Datatypes/Legacy/Field/share.h>
+
+namespace SCIRun {
+namespace MeshTopology {
+
+/// How the unstructured volume meshes build their edge and face tables in
+/// synchronize(). Sorted extraction radix sorts packed node keys in parallel,
+/// Hashed is the original unordered_map construction.
+enum class Construction { Sorted, Hashed };
+
+SCISHARE Construction construction();
+SCISHARE void setConstruction(Construction method);
+
+typedef boost::uint32_t key_type;
+
+/// One edge or face of one cell: its normalized node indices and the position
+/// at which the cell generated it. Positions start out ascending, so after the
+/// stable sort the cells sharing an entity are listed in cell order, as in the
+/// hash tables.
+template <size_t K>
+struct Entry
+{
+  key_type nodes[K];
+  key_type order;
+};
+
+/// The packed entries index nodes and positions with 32 bits, with keyLimit
+/// reserved to mark degenerate entries.
+inline bool fitsPackedKeys(size_t keyLimit, size_t numEntries)
+{
+  return keyLimit < 0xFFFFFFFFu && numEntries < 0xFFFFFFFFu;
+}
+
+template <size_t K>
+inline bool sameNodes(const Entry<K>& a, const Entry<K>& b)
+{
+  for (size_t k = 0; k < K; ++k)
+    if (a.nodes[k] != b.nodes[k]) return (false);
+  return (true);
+}
+
+/// Runs fill(begin, end) over blocks of [0, count) in parallel.
+template <class Fill>
+void parallelFill(size_t count, Fill fill)
+{
+  Core::Thread::Parallel::For(0, count, [&fill](size_t begin, size_t end) { fill(begin, end); });
+}
+
+/// Stable LSD radix sort of the entries by their nodes, lexicographically,
+/// with 8 bit digits. Only the digits needed to represent keyLimit are sorted
+/// and passes where every entry has the same digit are skipped. Histograms
+/// and scatters are split over blocks of entries that run in parallel.
+template <size_t K>
+void sortEntries(std::vector<Entry<K> >& entries, key_type keyLimit)
+{
+  const size_t n = entries.size();
+  if (n < 2) return;
+
+  int digits = 1;
+  while (digits < 4 && (keyLimit >> (8 * digits)) != 0) ++digits;
+
+  const size_t minBlock = 1 << 16;
+  const int blocks = static_cast<int>(std::max<size_t>(1,
+    std::min<size_t>(Core::Thread::Parallel::NumCores(), n / minBlock)));
+  const size_t blockSize = (n + blocks - 1) / blocks;
+
+  std::vector<Entry<K> > buffer(n);
+  std::vector<size_t> offsets(static_cast<size_t>(blocks) * 256);
+  Entry<K>* source = &entries[0];
+  Entry<K>* target = &buffer[0];
+
+  for (int k = static_cast<int>(K) - 1; k >= 0; --k)
+  {
+    for (int d = 0; d < digits; ++d)
+    {
+      const int shift = 8 * d;
+      Core::Thread::Parallel::RunTasks([&](int b)
+      {
+        size_t* count = &offsets[b * 256];
+        std::fill(count, count + 256, 0);
+        const size_t end = std::min(n, (b + 1) * blockSize);
+        for (size_t i = b * blockSize; i < end; ++i)
+          ++count[(source[i].nodes[k] >> shift) & 0xFF];
+      }, blocks);
+
+      size_t sum = 0;
+      bool trivial = false;
+      for (int bucket = 0; bucket < 256; ++bucket)
+      {
+        size_t total = 0;
+        for (int b = 0; b < blocks; ++b)
+        {
+          const size_t c = offsets[b * 256 + bucket];
+          offsets[b * 256 + bucket] = sum + total;
+          total += c;
+        }
+        if (total == n) trivial = true;
+        sum += total;
+      }
+      if (trivial) continue;
+
+      Core::Thread::Parallel::RunTasks([&](int b)
+      {
+        size_t* offset = &offsets[b * 256];
+        const size_t end = std::min(n, (b + 1) * blockSize);
+        for (size_t i = b * blockSize; i < end; ++i)
+          target[offset[(source[i].nodes[k] >> shift) & 0xFF]++] = source[i];
+      }, blocks);
+      std::swap(source, target);
+    }
+  }
+
+  if (source != &entries[0])
+    entries.swap(buffer);
+}
+
+/// Calls visit(first, last) for each run of sorted entries with equal nodes,
+/// stopping at the degenerate entries (first node equal to keyLimit) that
+/// sort last. Returns the number of runs.
+template <size_t K, class Visit>
+size_t forEachGroup(const std::vector<Entry<K> >& entries, key_type keyLimit, Visit visit)
+{
+  size_t groups = 0;
+  size_t i = 0;
+  const size_t n = entries.size();
+  while (i < n && entries[i].nodes[0] != keyLimit)
+  {
+    size_t j = i + 1;
+    while (j < n && sameNodes(entries[i], entries[j])) ++j;
+    visit(&entries[i], &entries[j]);
+    ++groups;
+    i = j;
+  }
+  return (groups);
+}
+
+template <size_t K>
+size_t countGroups(const std::vector<Entry<K> >& entries, key_type keyLimit)
+{
+  return forEachGroup(entries, keyLimit, [](const Entry<K>*, const Entry<K>*) {});
+}
+
+/// Edge key: the two nodes in increasing order; collapsed edges are degenerate.
+template <class INDEX>
+inline void setEdgeEntry(Entry<2>& e, INDEX n1, INDEX n2, size_t order, key_type keyLimit)
+{
+  e.order = static_cast<key_type>(order);
+  if (n1 == n2)
+  {
+    e.nodes[0] = keyLimit;
+    e.nodes[1] = 0;
+  }
+  else
+  {
+    e.nodes[0] = static_cast<key_type>(std::min(n1, n2));
+    e.nodes[1] = static_cast<key_type>(std::max(n1, n2));
+  }
+}
+
+/// Quad face key for nodes already rotated so n[0] is the smallest: the two
+/// nodes adjacent to n[0] are ordered so both windings give the same key.
+/// Faces with a collapsed edge carry their third node twice.
+template <class INDEX>
+inline void setQuadFaceEntry(Entry<4>& e, const INDEX* n, size_t order)
+{
+  e.order = static_cast<key_type>(order);
+  e.nodes[0] = static_cast<key_type>(n[0]);
+  if (n[2] == n[3])
+  {
+    e.nodes[1] = static_cast<key_type>(std::min(n[1], n[2]));
+    e.nodes[2] = e.nodes[3] = static_cast<key_type>(std::max(n[1], n[2]));
+  }
+  else
+  {
+    e.nodes[1] = static_cast<key_type>(std::min(n[1], n[3]));
+    e.nodes[2] = static_cast<key_type>(n[2]);
+    e.nodes[3] = static_cast<key_type>(std::max(n[1], n[3]));
+  }
+}
+
+inline void setDegenerateEntry(Entry<4>& e, size_t order, key_type keyLimit)
+{
+  e.order = static_cast<key_type>(order);
+  e.nodes[0] = keyLimit;
+  e.nodes[1] = e.nodes[2] = e.nodes[3] = 0;
+}
+
+/// Compressed row storage for per-node lists such as node to cell adjacency:
+/// one offsets array and one values array instead of a vector per node.
+/// Rows edited after the bulk build move to a small overflow table, so the
+/// incremental mesh editing functions keep working.
+template <class T>
+class CompressedAdjacency
+{
+public:
+  class Row
+  {
+  public:
+    Row(const T* first, const T* last) : first_(first), last_(last) {}
+    const T* begin() const { return first_; }
+    const T* end() const { return last_; }
+    size_t size() const { return last_ - first_; }
+    bool empty() const { return first_ == last_; }
+    const T& operator[](size_t i) const { return first_[i]; }
+  private:
+    const T* first_;
+    const T* last_;
+  };
+
+  CompressedAdjacency() : rows_(0) {}
+
+  size_t size() const { return rows_; }
+
+  void clear()
+  {
+    rows_ = 0;
+    std::vector<index_type>().swap(offsets_);
+    std::vector<T>().swap(values_);
+    edited_.clear();
+  }
+
+  Row operator[](size_t row) const
+  {
+    if (!edited_.empty())
+    {
+      typename edited_type::const_iterator it = edited_.find(row);
+      if (it != edited_.end())
+        return (Row(it->second.data(), it->second.data() + it->second.size()));
+    }
+    if (row + 1 < offsets_.size())
+      return (Row(values_.data() + offsets_[row], values_.data() + offsets_[row + 1]));
+    return (Row(nullptr, nullptr));
+  }
+
+  /// Builds rows from items 0..count-1: item i is appended to row rowOf(i)
+  /// with value valueOf(i). Counting sort, so rows list items in order.
+  template <class RowOf, class ValueOf>
+  void build(size_t rows, size_t count, RowOf rowOf, ValueOf valueOf)
+  {
+    clear();
+    rows_ = rows;
+    offsets_.assign(rows + 1, 0);
+    for (size_t i = 0; i < count; ++i)
+      ++offsets_[rowOf(i) + 1];
+    for (size_t r = 0; r < rows; ++r)
+      offsets_[r + 1] += offsets_[r];
+    values_.resize(count);
+    std::vector<index_type> next(offsets_.begin(), offsets_.end() - 1);
+    for (size_t i = 0; i < count; ++i)
+      values_[next[rowOf(i)]++] = valueOf(i);
+  }
+
+  void push_back(size_t row, const T& value)
+  {
+    edit(row).push_back(value);
+  }
+
+  /// Removes the first occurrence of value from row; false if not present.
+  bool erase(size_t row, const T& value)
+  {
+    std::vector<T>& values = edit(row);
+    typename std::vector<T>::iterator it = std::find(values.begin(), values.end(), value);
+    if (it == values.end()) return (false);
+    values.erase(it);
+    return (true);
+  }
+
+  void add_row()
+  {
+    edited_[rows_];
+    ++rows_;
+  }
+
+private:
+  typedef boost::unordered_map<size_t, std::vector<T> > edited_type;
+
+  std::vector<T>& edit(size_t row)
+  {
+    typename edited_type::iterator it = edited_.find(row);
+    if (it != edited_.end()) return (it->second);
+    Row current = (*this)[row];
+    return (edited_[row] = std::vector<T>(current.begin(), current.end()));
+  }
+
+  size_t rows_;
+  std::vector<index_type> offsets_;
+  std::vector<T> values_;
+  edited_type edited_;
+};
+
+}} // end namespace SCIRun::MeshTopology
+
+#endif
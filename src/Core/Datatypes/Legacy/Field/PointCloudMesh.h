@@ -460,8 +460,8 @@ public:
 
   void node_reserve(size_t s) { points_.reserve(s); }
   void elem_reserve(size_t s) { points_.reserve(s); }
-  void resize_nodes(size_t s) { points_.resize(s); }
-  void resize_elems(size_t s) { points_.resize(s); }
+  void resize_nodes(size_t s) { topologyChanged(); points_.resize(s); }
+  void resize_elems(size_t s) { topologyChanged(); points_.resize(s); }
 
 
   /// THESE FUNCTIONS ARE DEFINED INSIDE THE CLASS AS THESE ARE TEMPLATED
@@ -1436,6 +1436,7 @@ template <class Basis>
 typename PointCloudMesh<Basis>::Node::index_type
 PointCloudMesh<Basis>::add_point(const Core::Geometry::Point &p)
 {
+  topologyChanged();
   points_.push_back(p);
   return points_.size() - 1;
 }
@@ -1447,6 +1448,7 @@ template <class Basis>
 void
 PointCloudMesh<Basis>::io(Piostream& stream)
 {
+  topologyChanged();
   int version = stream.begin_class(type_name(-1), PointCloudFieldMESH_VERSION);
 
   Mesh::io(stream);
@@ -1681,14 +1683,8 @@ PointCloudMesh<Basis>::compute_grid(Core::Geometry::BBox& bb)
     
     Core::Geometry::BBox b = bb; b.extend(10*epsilon_);
     grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Elem::iterator ci, cie;
-    begin(ci); end(cie);
-    while(ci != cie)
-    {
-      insert_elem_into_grid(*ci);
-      ++ci;
-    }
+    grid_->fill_points(points_.size(), [this](index_type ni)
+      { return points_[ni]; });
   }
   else
   {
@@ -52,6 +52,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/MeshTopology.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 
 #include <Core/Utils/Legacy/CheckSum.h>
@@ -705,8 +706,8 @@ public:
   /// nodes/elements one needs, prereserving memory is often possible.
   void node_reserve(size_type s) { points_.reserve(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
   void elem_reserve(size_type s) { cells_.reserve(static_cast<std::vector<index_type>::size_type>(s*6)); }
-  void resize_nodes(size_type s) { points_.resize(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
-  void resize_elems(size_type s) { cells_.resize(static_cast<std::vector<index_type>::size_type>(s*6)); }
+  void resize_nodes(size_type s) { topologyChanged(); points_.resize(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
+  void resize_elems(size_type s) { topologyChanged(); cells_.resize(static_cast<std::vector<index_type>::size_type>(s*6)); }
 
   /// Get the local coordinates for a certain point within an element
   /// This function uses a couple of newton iterations to find the local
@@ -1734,6 +1735,7 @@ protected:
   {
     ASSERTMSG(synchronized_ & Mesh::EDGES_E,
 	      "PrismVolMesh: Must call synchronize EDGES_E first");
+    array.resize(edges_[idx].cells_.size());
     for (size_t i=0; i<edges_[idx].cells_.size();i++)
       array[i] = static_cast<typename ARRAY::value_type>(edges_[idx].cells_[i]);
   }
@@ -1759,6 +1761,7 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    topologyChanged();
     for (index_type n = 0; n < 6; ++n)
       cells_[idx * 6 + n] = static_cast<index_type>(array[n]);
   }
@@ -2167,6 +2170,8 @@ protected:
   void compute_node_neighbors();
   void compute_edges();
   void compute_faces();
+  void compute_edges_sorted();
+  void compute_faces_sorted();
   void compute_node_grid();
   void compute_elem_grid();
   void compute_bounding_box();
@@ -2175,6 +2180,7 @@ protected:
   void remove_elem_from_grid(typename Elem::index_type ci);
   void insert_node_into_grid(typename Node::index_type ci);
   void remove_node_from_grid(typename Node::index_type ci);
+  Core::Geometry::BBox elem_grid_bbox(typename Elem::index_type ci) const;
 
   const Core::Geometry::Point &point(typename Node::index_type i) { return points_[i]; }
 
@@ -2559,31 +2565,12 @@ protected:
     return (true);
   }
 
-  /// useful functors
-  struct FillNodeNeighbors {
-    FillNodeNeighbors(std::vector<std::vector<typename Node::index_type> > &n,
-                      const PrismVolMesh &m) :
-      nbor_vec_(n),
-      mesh_(m)
-    {}
-
-    void operator()(typename Edge::index_type e) {
-      mesh_.get_nodes(nodes_, e);
-      nbor_vec_[nodes_[0]].push_back(nodes_[1]);
-      nbor_vec_[nodes_[1]].push_back(nodes_[0]);
-    }
-
-    std::vector<std::vector<typename Node::index_type> > &nbor_vec_;
-    const PrismVolMesh            &mesh_;
-    typename Node::array_type   nodes_;
-  };
-
   /// This grid is used as an acceleration structure to expedite calls
   ///  to locate.  For each cell in the grid, we store a list of which
   ///  tets overlap that grid cell -- to find the tet which contains a
   ///  point, we simply find which grid cell contains that point, and
   ///  then search just those tets that overlap that grid cell.
-  std::vector<std::vector<typename Node::index_type> > node_neighbors_;
+  MeshTopology::CompressedAdjacency<typename Node::index_type> node_neighbors_;
 
   std::vector<unsigned char> boundary_faces_;
   boost::shared_ptr<SearchGridT<index_type> >  node_grid_;
@@ -2942,6 +2929,14 @@ template <class Basis>
 void
 PrismVolMesh<Basis>::compute_faces()
 {
+  if (MeshTopology::construction() == MeshTopology::Construction::Sorted &&
+      MeshTopology::fitsPackedKeys(std::max<size_t>(points_.size(), static_cast<under_type>(PRISM_DUMMY_NODE_INDEX) + 1),
+                                   (cells_.size() / 6) * 5))
+  {
+    compute_faces_sorted();
+    return;
+  }
+
   face_table_.clear();
 
   typename Cell::iterator ci, cie;
@@ -3016,6 +3011,13 @@ template <class Basis>
 void
 PrismVolMesh<Basis>::compute_edges()
 {
+  if (MeshTopology::construction() == MeshTopology::Construction::Sorted &&
+      MeshTopology::fitsPackedKeys(points_.size(), (cells_.size() / 6) * 9))
+  {
+    compute_edges_sorted();
+    return;
+  }
+
   typename Cell::iterator ci, cie;
   begin(ci); end(cie);
   typename Node::array_type arr;
@@ -3054,6 +3056,124 @@ PrismVolMesh<Basis>::compute_edges()
   synchronize_lock_.unlock();
 }
 
+/// Same tables as compute_faces(), built by radix sorting the five faces of
+/// every cell on an orientation independent key so matching faces end up
+/// adjacent. Triangles carry PRISM_DUMMY_NODE_INDEX as their fourth node.
+template <class Basis>
+void
+PrismVolMesh<Basis>::compute_faces_sorted()
+{
+  using namespace MeshTopology;
+  static const int face_nodes[5][4] = { {0,1,2,-1}, {5,4,3,-1}, {1,4,5,2},
+                                        {2,5,3,0}, {0,3,4,1} };
+  const size_t num_cells = cells_.size() / 6;
+  const under_type dummy = static_cast<under_type>(PRISM_DUMMY_NODE_INDEX);
+  const key_type key_limit = static_cast<key_type>(std::max<size_t>(points_.size(), dummy + 1));
+  std::vector<Entry<4> > entries(num_cells * 5);
+
+  // face f of cell c, ordered as hash_face() stores it; false if degenerate
+  auto cell_face = [&](size_t c, size_t f, under_type* q)
+  {
+    for (size_t k = 0; k < 4; ++k)
+      q[k] = face_nodes[f][k] < 0 ? dummy : cells_[6*c + face_nodes[f][k]];
+    return (order_face_nodes(q[0], q[1], q[2], q[3]));
+  };
+
+  parallelFill(num_cells, [&](size_t begin, size_t end)
+  {
+    under_type q[4];
+    for (size_t c = begin; c < end; ++c)
+      for (size_t f = 0; f < 5; ++f)
+      {
+        if (cell_face(c, f, q))
+          setQuadFaceEntry(entries[5*c + f], q, 5*c + f);
+        else
+          setDegenerateEntry(entries[5*c + f], 5*c + f, key_limit);
+      }
+  });
+
+  sortEntries(entries, key_limit);
+
+  const size_t num_faces = countGroups(entries, key_limit);
+  faces_.clear();
+  faces_.resize(num_faces);
+  face_table_.clear();
+  face_table_.reserve(num_faces);
+  boundary_faces_.assign(num_cells, 0);
+
+  index_type uidx = 0;
+  forEachGroup(entries, key_limit, [&](const Entry<4>* first, const Entry<4>* last)
+  {
+    under_type q[4];
+    cell_face(first->order / 5, first->order % 5, q);
+    PFace& face = faces_[uidx];
+    face = PFace(q[0], q[1], q[2], q[3]);
+    face.cells_[0] = ((first->order / 5) << 3) + first->order % 5;
+    // As in hash_face(), a second face of the same cell and a third cell are ignored
+    for (const Entry<4>* e = first + 1; e != last && face.cells_[1] == MESH_NO_NEIGHBOR; ++e)
+      if ((face.cells_[0]>>3) != static_cast<index_type>(e->order / 5))
+        face.cells_[1] = ((e->order / 5) << 3) + e->order % 5;
+
+    face_table_[face] = uidx;
+
+    if (face.cells_[1] == MESH_NO_NEIGHBOR)
+      boundary_faces_[face.cells_[0] >> 3] |= 1 << (face.cells_[0] & 0x7);
+    ++uidx;
+  });
+
+  synchronize_lock_.lock();
+  synchronized_ |= Mesh::FACES_E;
+  synchronize_lock_.unlock();
+}
+
+/// Same tables as compute_edges(), built by radix sorting the nine edges of
+/// every cell on their node pairs.
+template <class Basis>
+void
+PrismVolMesh<Basis>::compute_edges_sorted()
+{
+  using namespace MeshTopology;
+  static const int edge_nodes[9][2] = { {0,1}, {1,2}, {2,0}, {3,4}, {4,5},
+                                        {5,3}, {0,3}, {4,1}, {2,5} };
+  const size_t num_cells = cells_.size() / 6;
+  const key_type key_limit = static_cast<key_type>(points_.size());
+  std::vector<Entry<2> > entries(num_cells * 9);
+
+  parallelFill(num_cells, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; ++c)
+    {
+      const under_type* n = &cells_[6*c];
+      for (size_t j = 0; j < 9; ++j)
+        setEdgeEntry(entries[9*c + j], n[edge_nodes[j][0]], n[edge_nodes[j][1]], 9*c + j, key_limit);
+    }
+  });
+
+  sortEntries(entries, key_limit);
+
+  const size_t num_edges = countGroups(entries, key_limit);
+  edges_.clear();
+  edges_.resize(num_edges);
+  edge_table_.clear();
+  edge_table_.reserve(num_edges);
+
+  index_type uidx = 0;
+  forEachGroup(entries, key_limit, [&](const Entry<2>* first, const Entry<2>* last)
+  {
+    PEdge& edge = edges_[uidx];
+    edge = PEdge(static_cast<under_type>(first->nodes[0]), static_cast<under_type>(first->nodes[1]));
+    edge.cells_.reserve(last - first);
+    for (const Entry<2>* e = first; e != last; ++e)
+      edge.cells_.push_back(static_cast<under_type>(e->order / 9));
+    edge_table_[edge] = uidx;
+    ++uidx;
+  });
+
+  synchronize_lock_.lock();
+  synchronized_ |= Mesh::EDGES_E;
+  synchronize_lock_.unlock();
+}
+
 template <class Basis>
 bool
 PrismVolMesh<Basis>::synchronize(mask_type sync)
@@ -3339,11 +3459,10 @@ template <class Basis>
 void
 PrismVolMesh<Basis>::compute_node_neighbors()
 {
-  node_neighbors_.clear();
-  node_neighbors_.resize(points_.size());
-  typename Edge::iterator ei, eie;
-  begin(ei); end(eie);
-  std::for_each(ei, eie, FillNodeNeighbors(node_neighbors_, *this));
+  // Both directions of every edge, in edge order
+  node_neighbors_.build(points_.size(), 2 * edges_.size(),
+    [this](size_t j) { return static_cast<size_t>(edges_[j >> 1].nodes_[j & 1]); },
+    [this](size_t j) { return edges_[j >> 1].nodes_[1 - (j & 1)]; });
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
@@ -3386,12 +3505,9 @@ PrismVolMesh<Basis>::get_weights(const Core::Geometry::Point &p, typename Cell::
 }
 
 template <class Basis>
-void
-PrismVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+Core::Geometry::BBox
+PrismVolMesh<Basis>::elem_grid_bbox(typename Elem::index_type ci) const
 {
-  /// @todo:  This can crash if you insert a new cell outside of the grid.
-  // Need to recompute grid at that point.
-
   const index_type idx = ci*6;
   Core::Geometry::BBox box;
   box.extend(points_[cells_[idx]]);
@@ -3401,23 +3517,23 @@ PrismVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
   box.extend(points_[cells_[idx+4]]);
   box.extend(points_[cells_[idx+5]]);
   box.extend(epsilon_);
-  elem_grid_->insert(ci, box);
+  return box;
+}
+
+template <class Basis>
+void
+PrismVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+{
+  /// @todo:  This can crash if you insert a new cell outside of the grid.
+  // Need to recompute grid at that point.
+  elem_grid_->insert(ci, elem_grid_bbox(ci));
 }
 
 template <class Basis>
 void
 PrismVolMesh<Basis>::remove_elem_from_grid(typename Elem::index_type ci)
 {
-  const index_type idx = ci*6;
-  Core::Geometry::BBox box;
-  box.extend(points_[cells_[idx]]);
-  box.extend(points_[cells_[idx+1]]);
-  box.extend(points_[cells_[idx+2]]);
-  box.extend(points_[cells_[idx+3]]);
-  box.extend(points_[cells_[idx+4]]);
-  box.extend(points_[cells_[idx+5]]);
-  box.extend(epsilon_);
-  elem_grid_->remove(ci, box);
+  elem_grid_->remove(ci, elem_grid_bbox(ci));
 }
 
 template <class Basis>
@@ -3457,14 +3573,8 @@ PrismVolMesh<Basis>::compute_elem_grid()
 
     Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
     elem_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Elem::iterator ci, cie;
-    begin(ci); end(cie);
-    while(ci != cie)
-    {
-      insert_elem_into_grid(*ci);
-      ++ci;
-    }
+    elem_grid_->fill_boxes(esz, [this](index_type ci)
+      { return elem_grid_bbox(typename Elem::index_type(ci)); });
   }
 
   synchronize_lock_.lock();
@@ -3494,14 +3604,8 @@ PrismVolMesh<Basis>::compute_node_grid()
 
     Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
     node_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Node::iterator ni, nie;
-    begin(ni); end(nie);
-    while(ni != nie)
-    {
-      insert_node_into_grid(*ni);
-      ++ni;
-    }
+    node_grid_->fill_points(points_.size(), [this](index_type ni)
+      { return points_[ni]; });
   }
 
   synchronize_lock_.lock();
@@ -3560,6 +3664,7 @@ PrismVolMesh<Basis>::add_prism(typename Node::index_type a,
                                typename Node::index_type e,
                                typename Node::index_type f)
 {
+  topologyChanged();
   const index_type prism = static_cast<index_type>(cells_.size()) / 6;
   cells_.push_back(a);
   cells_.push_back(b);
@@ -3574,6 +3679,7 @@ template <class Basis>
 typename PrismVolMesh<Basis>::Node::index_type
 PrismVolMesh<Basis>::add_point(const Core::Geometry::Point &p)
 {
+  topologyChanged();
   points_.push_back(p);
   return static_cast<typename Node::index_type>(points_.size() - 1);
 }
@@ -3584,6 +3690,7 @@ PrismVolMesh<Basis>::add_prism(const Core::Geometry::Point &p0, const Core::Geom
                                const Core::Geometry::Point &p2, const Core::Geometry::Point &p3,
                                const Core::Geometry::Point &p4, const Core::Geometry::Point &p5)
 {
+  topologyChanged();
   return add_prism(add_find_point(p0), add_find_point(p1),
 		   add_find_point(p2), add_find_point(p3),
 		   add_find_point(p4), add_find_point(p5));
@@ -3595,6 +3702,7 @@ template <class Basis>
 void
 PrismVolMesh<Basis>::io(Piostream &stream)
 {
+  topologyChanged();
   const int version = stream.begin_class(type_name(-1),
                                          PRISM_VOL_MESH_VERSION);
   Mesh::io(stream);
@@ -679,6 +679,7 @@ public:
   template <class ARRAY>
   typename Elem::index_type add_elem(ARRAY a)
   {
+    topologyChanged();
     ASSERTMSG(a.size() == 4, "Tried to add non-quad element.");
     ASSERTMSG(order_face_nodes(a[0],a[1],a[2],a[3]), "add_elem: element that is being added is invalid");
 
@@ -691,8 +692,8 @@ public:
 
   void node_reserve(size_type s) { points_.reserve(static_cast<size_t>(s)); }
   void elem_reserve(size_type s) { faces_.reserve(static_cast<size_t>(s*4)); }
-  void resize_nodes(size_type s) { points_.resize(static_cast<size_t>(s)); }
-  void resize_elems(size_type s) { faces_.resize(static_cast<size_t>(s*4)); }
+  void resize_nodes(size_type s) { topologyChanged(); points_.resize(static_cast<size_t>(s)); }
+  void resize_elems(size_type s) { topologyChanged(); faces_.resize(static_cast<size_t>(s*4)); }
 
 
   /// Get the local coordinates for a certain point within an element
@@ -794,7 +795,7 @@ public:
     Jv.resize(3);
     Core::Geometry::Vector v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1]));
     v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
     double min_jacobian = ScaledDetMatrix3P(Jv);
 
     size_t num_vertices = basis_.number_of_vertices();
@@ -803,7 +804,7 @@ public:
       basis_.derivate(basis_.unit_vertices[j],ed,Jv);
       Jv.resize(3);
       v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1])); v.normalize();
-      Jv[2] = v.asPoint();
+      Jv[2] = Core::Geometry::Point(v);
       temp = ScaledDetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -823,7 +824,7 @@ public:
     basis_.derivate(basis_.unit_center,ed,Jv);
     Jv.resize(3);
     Core::Geometry::Vector v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1])); v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
     double min_jacobian = DetMatrix3P(Jv);
 
     size_t num_vertices = basis_.number_of_vertices();
@@ -832,7 +833,7 @@ public:
       basis_.derivate(basis_.unit_vertices[j],ed,Jv);
       Jv.resize(3);
       v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1])); v.normalize();
-      Jv[2] = v.asPoint();
+      Jv[2] = Core::Geometry::Point(v);
       temp = DetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -1771,6 +1772,7 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    topologyChanged();
     for (index_type n = 0; n < 4; ++n)
       faces_[idx * 4 + n] = static_cast<index_type>(array[n]);
   }
@@ -2163,6 +2165,7 @@ protected:
 
   void insert_node_into_grid(typename Node::index_type ci);
   void remove_node_from_grid(typename Node::index_type ci);
+  Core::Geometry::BBox elem_grid_bbox(typename Elem::index_type ci) const;
 
   template <class NODE>
   bool order_face_nodes(NODE& n1,NODE& n2, NODE& n3, NODE& n4) const
@@ -2842,6 +2845,7 @@ QuadSurfMesh<Basis>::add_quad(typename Node::index_type a,
                               typename Node::index_type c,
                               typename Node::index_type d)
 {
+  topologyChanged();
   ASSERTMSG(order_face_nodes(a,b,c,d), "add_quad: element that is being added is invalid");
   faces_.push_back(a);
   faces_.push_back(b);
@@ -2939,11 +2943,9 @@ QuadSurfMesh<Basis>::compute_node_neighbors()
 
 
 template <class Basis>
-void
-QuadSurfMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+Core::Geometry::BBox
+QuadSurfMesh<Basis>::elem_grid_bbox(typename Elem::index_type ci) const
 {
-  /// @todo:  This can crash if you insert a new cell outside of the grid.
-  // Need to recompute grid at that point.
   const index_type idx = ci*4;
   Core::Geometry::BBox box;
   box.extend(points_[faces_[idx]]);
@@ -2951,7 +2953,16 @@ QuadSurfMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
   box.extend(points_[faces_[idx+2]]);
   box.extend(points_[faces_[idx+3]]);
   box.extend(epsilon_);
-  elem_grid_->insert(ci, box);
+  return box;
+}
+
+template <class Basis>
+void
+QuadSurfMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+{
+  /// @todo:  This can crash if you insert a new cell outside of the grid.
+  // Need to recompute grid at that point.
+  elem_grid_->insert(ci, elem_grid_bbox(ci));
 }
 
 
@@ -2959,14 +2970,7 @@ template <class Basis>
 void
 QuadSurfMesh<Basis>::remove_elem_from_grid(typename Elem::index_type ci)
 {
-  const index_type idx = ci*4;
-  Core::Geometry::BBox box;
-  box.extend(points_[faces_[idx]]);
-  box.extend(points_[faces_[idx+1]]);
-  box.extend(points_[faces_[idx+2]]);
-  box.extend(points_[faces_[idx+3]]);
-  box.extend(epsilon_);
-  elem_grid_->remove(ci, box);
+  elem_grid_->remove(ci, elem_grid_bbox(ci));
 }
 
 
@@ -3010,14 +3014,8 @@ QuadSurfMesh<Basis>::compute_node_grid()
     Core::Geometry::BBox b = bbox_;
     b.extend(10*epsilon_);
     node_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Node::iterator ni, nie;
-    begin(ni); end(nie);
-    while(ni != nie)
-    {
-      insert_node_into_grid(*ni);
-      ++ni;
-    }
+    node_grid_->fill_points(points_.size(), [this](index_type ni)
+      { return points_[ni]; });
   }
 
   synchronize_lock_.lock();
@@ -3047,14 +3045,8 @@ QuadSurfMesh<Basis>::compute_elem_grid()
     Core::Geometry::BBox b = bbox_;
     b.extend(10*epsilon_);
     elem_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Elem::iterator ci, cie;
-    begin(ci); end(cie);
-    while(ci != cie)
-    {
-      insert_elem_into_grid(*ci);
-      ++ci;
-    }
+    elem_grid_->fill_boxes(esz, [this](index_type ci)
+      { return elem_grid_bbox(typename Elem::index_type(ci)); });
   }
 
   synchronize_lock_.lock();
@@ -3092,6 +3084,7 @@ template <class Basis>
 typename QuadSurfMesh<Basis>::Node::index_type
 QuadSurfMesh<Basis>::add_point(const Core::Geometry::Point &p)
 {
+  topologyChanged();
   points_.push_back(p);
   return static_cast<typename Node::index_type>(static_cast<index_type>(points_.size() - 1));
 }
@@ -3102,6 +3095,7 @@ typename QuadSurfMesh<Basis>::Elem::index_type
 QuadSurfMesh<Basis>::add_quad(const Core::Geometry::Point &p0, const Core::Geometry::Point &p1,
                               const Core::Geometry::Point &p2, const Core::Geometry::Point &p3)
 {
+  topologyChanged();
   return add_quad(add_find_point(p0), add_find_point(p1),
                   add_find_point(p2), add_find_point(p3));
 }
@@ -3112,6 +3106,7 @@ template <class Basis>
 void
 QuadSurfMesh<Basis>::io(Piostream &stream)
 {
+  topologyChanged();
   const int version = stream.begin_class(type_name(-1), QUADSURFMESH_VERSION);
 
   Mesh::io(stream);
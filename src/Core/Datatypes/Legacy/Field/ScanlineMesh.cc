@@ -2067,8 +2067,8 @@ VStructCurveMesh<MESH>::scaled_jacobian_metric(const VMesh::Elem::index_type idx
   Jv.resize(3); 
   Vector v,w;
   Vector(Jv[0]).find_orthogonal(v,w);
-  Jv[1] = v.asPoint();
-  Jv[2] = w.asPoint();
+  Jv[1] = Core::Geometry::Point(v);
+  Jv[2] = Core::Geometry::Point(w);
   double min_jacobian = ScaledDetMatrix3P(Jv);
   
   size_t num_vertices = this->basis_->number_of_vertices();
@@ -2078,8 +2078,8 @@ VStructCurveMesh<MESH>::scaled_jacobian_metric(const VMesh::Elem::index_type idx
     Jv.resize(3); 
     Vector v,w;
     Vector(Jv[0]).find_orthogonal(v,w);
-    Jv[1] = v.asPoint();
-    Jv[2] = w.asPoint();
+    Jv[1] = Core::Geometry::Point(v);
+    Jv[2] = Core::Geometry::Point(w);
     temp = ScaledDetMatrix3P(Jv);
     if(temp < min_jacobian) min_jacobian = temp;
   }
@@ -2099,8 +2099,8 @@ VStructCurveMesh<MESH>::jacobian_metric(const  VMesh::Elem::index_type idx) cons
   Jv.resize(3); 
   Vector v,w;
   Vector(Jv[0]).find_orthogonal(v,w);
-  Jv[1] = v.asPoint();
-  Jv[2] = w.asPoint();
+  Jv[1] = Core::Geometry::Point(v);
+  Jv[2] = Core::Geometry::Point(w);
   double min_jacobian = DetMatrix3P(Jv);
   
   size_t num_vertices = this->basis_->number_of_vertices();
@@ -2110,8 +2110,8 @@ VStructCurveMesh<MESH>::jacobian_metric(const  VMesh::Elem::index_type idx) cons
     Jv.resize(3); 
     Vector v,w;
     Vector(Jv[0]).find_orthogonal(v,w);
-    Jv[1] = v.asPoint();
-    Jv[2] = w.asPoint();
+    Jv[1] = Core::Geometry::Point(v);
+    Jv[2] = Core::Geometry::Point(w);
     temp = DetMatrix3P(Jv);
     if(temp < min_jacobian) min_jacobian = temp;
   }
@@ -417,8 +417,8 @@ public:
     Jv.resize(3); 
     Core::Geometry::Vector v,w;
     Core::Geometry::Vector(Jv[0]).find_orthogonal(v,w);
-    Jv[1] = v.asPoint();
-    Jv[2] = w.asPoint();
+    Jv[1] = Core::Geometry::Point(v);
+    Jv[2] = Core::Geometry::Point(w);
     double min_jacobian = ScaledDetMatrix3P(Jv);
     
     size_t num_vertices = this->basis_.number_of_vertices();
@@ -427,8 +427,8 @@ public:
       this->basis_.derivate(this->basis_.unit_vertices[j],ed,Jv);
       Jv.resize(3); 
       Core::Geometry::Vector(Jv[0]).find_orthogonal(v,w);
-      Jv[1] = v.asPoint();
-      Jv[2] = w.asPoint();
+      Jv[1] = Core::Geometry::Point(v);
+      Jv[2] = Core::Geometry::Point(w);
       temp = ScaledDetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -449,8 +449,8 @@ public:
     Jv.resize(3); 
     Core::Geometry::Vector v,w;
     Core::Geometry::Vector(Jv[0]).find_orthogonal(v,w);
-    Jv[1] = v.asPoint();
-    Jv[2] = w.asPoint();
+    Jv[1] = Core::Geometry::Point(v);
+    Jv[2] = Core::Geometry::Point(w);
     double min_jacobian = DetMatrix3P(Jv);
     
     size_t num_vertices = this->basis_.number_of_vertices();
@@ -459,8 +459,8 @@ public:
       this->basis_.derivate(this->basis_.unit_vertices[j],ed,Jv);
       Jv.resize(3); 
       Core::Geometry::Vector(Jv[0]).find_orthogonal(v,w);
-      Jv[1] = v.asPoint();
-      Jv[2] = w.asPoint();
+      Jv[1] = Core::Geometry::Point(v);
+      Jv[2] = Core::Geometry::Point(w);
       temp = DetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
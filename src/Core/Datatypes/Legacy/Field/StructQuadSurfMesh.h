@@ -470,7 +470,7 @@ public:
     this->basis_.derivate(this->basis_.unit_center,ed,Jv);
     Jv.resize(3); 
     Core::Geometry::Vector v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1])); v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
     double min_jacobian = ScaledDetMatrix3P(Jv);
     
     size_t num_vertices = this->basis_.number_of_vertices();
@@ -479,7 +479,7 @@ public:
       this->basis_.derivate(this->basis_.unit_vertices[j],ed,Jv);
       Jv.resize(3); 
       v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1])); v.normalize();
-      Jv[2] = v.asPoint();
+      Jv[2] = Core::Geometry::Point(v);
       temp = ScaledDetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -499,7 +499,7 @@ public:
     this->basis_.derivate(this->basis_.unit_center,ed,Jv);
     Jv.resize(3); 
     Core::Geometry::Vector v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1])); v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
     double min_jacobian = DetMatrix3P(Jv);
     
     size_t num_vertices = this->basis_.number_of_vertices();
@@ -508,7 +508,7 @@ public:
       this->basis_.derivate(this->basis_.unit_vertices[j],ed,Jv);
       Jv.resize(3); 
       v = Cross(Core::Geometry::Vector(Jv[0]),Core::Geometry::Vector(Jv[1])); v.normalize();
-      Jv[2] = v.asPoint();
+      Jv[2] = Core::Geometry::Point(v);
       temp = DetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -0,0 +1,317 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Datatypes/Legacy/Field/ElementGeometry.h>
+#include <Core/Datatypes/Legacy/Field/TetVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/TriSurfMesh.h>
+#include <Core/Datatypes/Legacy/Field/HexVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/LatVolMesh.h>
+#include <Core/Basis/TriLinearLgn.h>
+#include <Core/Basis/HexTrilinearLgn.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  typedef TetVolMesh<Core::Basis::TetLinearLgn<Point> > TetMesh;
+  typedef TriSurfMesh<Core::Basis::TriLinearLgn<Point> > TriMesh;
+  typedef HexVolMesh<Core::Basis::HexTrilinearLgn<Point> > HexMesh;
+
+  const int offset[8][3] = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0},
+                             {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+
+  // Lattice point (i,j,k) of an n^3 lattice over the unit cube, moved by up
+  // to a quarter of a cell so that the elements are not all alike
+  Point jittered(int i, int j, int k, int n)
+  {
+    const double h = 1.0 / n;
+    return Point(h * (i + 0.25 * std::sin(1.3*i + 2.1*j + 0.7*k)),
+                 h * (j + 0.25 * std::sin(0.9*i + 1.7*j + 2.3*k)),
+                 h * (k + 0.25 * std::sin(2.2*i + 0.5*j + 1.1*k)));
+  }
+
+  template <class MESH>
+  void addLatticePoints(MESH& mesh, int n)
+  {
+    for (int k = 0; k <= n; ++k)
+      for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i)
+          mesh.add_point(jittered(i, j, k, n));
+  }
+
+  index_type latticeNode(int i, int j, int k, int n, const int* o)
+  {
+    return (i + o[0]) + (n + 1) * ((j + o[1]) + (n + 1) * (k + o[2]));
+  }
+
+  // Kuhn split of the jittered lattice into tets
+  boost::shared_ptr<TetMesh> tetLattice(int n)
+  {
+    static const int split[6][4] = { {0,1,2,6}, {0,2,3,6}, {0,3,7,6},
+                                     {0,7,4,6}, {0,4,5,6}, {0,5,1,6} };
+    boost::shared_ptr<TetMesh> mesh(new TetMesh());
+    addLatticePoints(*mesh, n);
+    TetMesh::Node::array_type nodes(4);
+    for (int k = 0; k < n; ++k)
+      for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+          for (int t = 0; t < 6; ++t)
+          {
+            for (int v = 0; v < 4; ++v) nodes[v] = latticeNode(i, j, k, n, offset[split[t][v]]);
+            mesh->add_elem(nodes);
+          }
+    return mesh;
+  }
+
+  boost::shared_ptr<HexMesh> hexLattice(int n)
+  {
+    boost::shared_ptr<HexMesh> mesh(new HexMesh());
+    addLatticePoints(*mesh, n);
+    HexMesh::Node::array_type nodes(8);
+    for (int k = 0; k < n; ++k)
+      for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+        {
+          for (int v = 0; v < 8; ++v) nodes[v] = latticeNode(i, j, k, n, offset[v]);
+          mesh->add_elem(nodes);
+        }
+    return mesh;
+  }
+
+  // Jittered height field, two triangles per square
+  boost::shared_ptr<TriMesh> triLattice(int n)
+  {
+    boost::shared_ptr<TriMesh> mesh(new TriMesh());
+    for (int j = 0; j <= n; ++j)
+      for (int i = 0; i <= n; ++i)
+      {
+        const Point p = jittered(i, j, 0, n);
+        mesh->add_point(Point(p.x(), p.y(), 0.5 * p.x() * p.y()));
+      }
+
+    TriMesh::Node::array_type nodes(3);
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i)
+      {
+        const index_type a = i + (n + 1) * j, b = a + 1, c = a + n + 2, d = a + n + 1;
+        nodes[0] = a; nodes[1] = b; nodes[2] = c; mesh->add_elem(nodes);
+        nodes[0] = a; nodes[1] = c; nodes[2] = d; mesh->add_elem(nodes);
+      }
+    return mesh;
+  }
+
+  double relative(double a, double b)
+  {
+    return std::abs(a - b) / std::max(1.0, std::max(std::abs(a), std::abs(b)));
+  }
+
+  // Compares every batch kernel against the per element VMesh calls
+  template <class T>
+  void expectMatchesVMesh(VMesh* vmesh, double tolerance)
+  {
+    ElementGeometry<T> geometry(vmesh);
+    ASSERT_TRUE(geometry.supported());
+    const VMesh::size_type num_elems = vmesh->num_elems();
+    ASSERT_EQ(num_elems, geometry.num_elems());
+
+    // Odd ranges, so that partial runs of lanes are covered too
+    const VMesh::index_type begin = 3, end = num_elems - 5;
+    std::vector<double> volume(end - begin), jacobian(end - begin), scaled(end - begin);
+    std::vector<Point> center(end - begin);
+    geometry.volumes(begin, end, &volume[0]);
+    geometry.jacobians(begin, end, &jacobian[0]);
+    geometry.scaled_jacobians(begin, end, &scaled[0]);
+    geometry.centers(begin, end, &center[0]);
+
+    for (VMesh::Elem::index_type e = begin; e < end; ++e)
+    {
+      const size_t j = e - begin;
+      EXPECT_LT(relative(volume[j], vmesh->volume_metric(e)), tolerance) << e;
+      EXPECT_LT(relative(jacobian[j], vmesh->jacobian_metric(e)), tolerance) << e;
+      EXPECT_LT(relative(scaled[j], vmesh->scaled_jacobian_metric(e)), tolerance) << e;
+      Point c;
+      vmesh->get_center(c, e);
+      EXPECT_LT((center[j] - c).length(), tolerance) << e;
+    }
+
+    std::vector<double> ratio(num_elems);
+    if (geometry.inscribed_circumscribed_ratios(0, num_elems, &ratio[0]))
+    {
+      for (VMesh::Elem::index_type e = 0; e < num_elems; ++e)
+        EXPECT_LT(relative(ratio[e], vmesh->inscribed_circumscribed_radius_metric(e)), tolerance) << e;
+    }
+
+    std::vector<double> inverse(9 * num_elems), det(num_elems);
+    if (geometry.inverse_jacobians(0, num_elems, &inverse[0], &det[0]))
+    {
+      VMesh::coords_type coords;
+      vmesh->get_element_center(coords);
+      for (VMesh::Elem::index_type e = 0; e < num_elems; ++e)
+      {
+        double Ji[9];
+        EXPECT_LT(relative(det[e], vmesh->inverse_jacobian(coords, e, Ji)), tolerance) << e;
+        for (int k = 0; k < 9; ++k)
+          EXPECT_LT(relative(inverse[9 * e + k], Ji[k]), tolerance) << e << " " << k;
+      }
+    }
+  }
+
+  // Points interpolated at known local coordinates of each element
+  template <class T>
+  void expectLocalCoordsRoundTrip(VMesh* vmesh, double tolerance)
+  {
+    ElementGeometry<T> geometry(vmesh);
+    const VMesh::size_type num_elems = vmesh->num_elems();
+    const int dim = vmesh->dimensionality();
+
+    std::vector<VMesh::Elem::index_type> elems(num_elems);
+    std::vector<VMesh::coords_type> expected(num_elems), coords(num_elems);
+    std::vector<Point> points(num_elems);
+    for (VMesh::Elem::index_type e = 0; e < num_elems; ++e)
+    {
+      elems[e] = (e * 7919) % num_elems;
+      VMesh::coords_type& c = expected[e];
+      c.resize(dim);
+      c[0] = 0.1 + 0.2 * ((e % 5) / 5.0);
+      c[1] = 0.2 + 0.3 * ((e % 3) / 3.0);
+      if (dim == 3) c[2] = 0.05 + 0.1 * ((e % 7) / 7.0);
+      vmesh->interpolate(points[e], c, elems[e]);
+    }
+
+    ASSERT_TRUE(geometry.local_coords(&elems[0], &points[0], num_elems, &coords[0]));
+    for (VMesh::Elem::index_type e = 0; e < num_elems; ++e)
+    {
+      ASSERT_EQ(static_cast<size_t>(dim), coords[e].size());
+      for (int k = 0; k < dim; ++k)
+        EXPECT_NEAR(expected[e][k], coords[e][k], tolerance) << e;
+
+      VMesh::coords_type c;
+      ASSERT_TRUE(vmesh->get_coords(c, points[e], elems[e]));
+      for (int k = 0; k < dim; ++k)
+        EXPECT_NEAR(c[k], coords[e][k], 1e-5) << e;
+    }
+  }
+
+  typedef std::chrono::high_resolution_clock Clock;
+
+  double seconds(Clock::time_point start)
+  {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  // Times the per element VMesh calls against the batch kernels
+  void benchmark(const std::string& name, VMesh* vmesh)
+  {
+    const VMesh::size_type num_elems = vmesh->num_elems();
+    std::vector<double> values(num_elems);
+    std::vector<Point> centers(num_elems);
+
+    auto start = Clock::now();
+    for (VMesh::Elem::index_type e = 0; e < num_elems; ++e) values[e] = vmesh->volume_metric(e);
+    const double volumeVMesh = seconds(start);
+    start = Clock::now();
+    for (VMesh::Elem::index_type e = 0; e < num_elems; ++e) values[e] = vmesh->scaled_jacobian_metric(e);
+    const double scaledVMesh = seconds(start);
+    start = Clock::now();
+    for (VMesh::Elem::index_type e = 0; e < num_elems; ++e) vmesh->get_center(centers[e], e);
+    const double centerVMesh = seconds(start);
+
+    start = Clock::now();
+    ElementGeometry<double> geometry(vmesh);
+    const double setup = seconds(start);
+    start = Clock::now();
+    geometry.volumes(0, num_elems, &values[0]);
+    const double volumeBatch = seconds(start);
+    start = Clock::now();
+    geometry.scaled_jacobians(0, num_elems, &values[0]);
+    const double scaledBatch = seconds(start);
+    start = Clock::now();
+    geometry.centers(0, num_elems, &centers[0]);
+    const double centerBatch = seconds(start);
+
+    ElementGeometry<float> single(vmesh);
+    start = Clock::now();
+    single.scaled_jacobians(0, num_elems, &values[0]);
+    const double scaledFloat = seconds(start);
+
+    std::cout << name << " (" << num_elems << " elements), VMesh / batch:\n"
+      << "  volume          " << volumeVMesh << "s / " << volumeBatch << "s\n"
+      << "  scaled jacobian " << scaledVMesh << "s / " << scaledBatch << "s (float " << scaledFloat << "s)\n"
+      << "  center          " << centerVMesh << "s / " << centerBatch << "s\n"
+      << "  node arrays     " << setup << "s" << std::endl;
+  }
+}
+
+TEST(ElementGeometryTests, TetVolKernelsMatchVMesh)
+{
+  auto mesh = tetLattice(6);
+  expectMatchesVMesh<double>(mesh->vmesh(), 1e-12);
+  expectMatchesVMesh<float>(mesh->vmesh(), 1e-4);
+  expectLocalCoordsRoundTrip<double>(mesh->vmesh(), 1e-10);
+}
+
+TEST(ElementGeometryTests, TriSurfKernelsMatchVMesh)
+{
+  auto mesh = triLattice(20);
+  expectMatchesVMesh<double>(mesh->vmesh(), 1e-12);
+  expectMatchesVMesh<float>(mesh->vmesh(), 1e-4);
+  expectLocalCoordsRoundTrip<double>(mesh->vmesh(), 1e-10);
+}
+
+TEST(ElementGeometryTests, HexVolKernelsMatchVMesh)
+{
+  auto mesh = hexLattice(6);
+  expectMatchesVMesh<double>(mesh->vmesh(), 1e-12);
+  expectMatchesVMesh<float>(mesh->vmesh(), 1e-4);
+
+  ElementGeometry<double> geometry(mesh->vmesh());
+  std::vector<double> inverse(9), det(1);
+  EXPECT_FALSE(geometry.inverse_jacobians(0, 1, &inverse[0], &det[0]));
+  EXPECT_FALSE(geometry.inscribed_circumscribed_ratios(0, 1, &det[0]));
+}
+
+TEST(ElementGeometryTests, RegularMeshesAreNotSupported)
+{
+  LatVolMesh<Core::Basis::HexTrilinearLgn<Point> > mesh(3, 3, 3, Point(0,0,0), Point(1,1,1));
+  ElementGeometry<double> geometry(mesh.vmesh());
+  EXPECT_FALSE(geometry.supported());
+}
+
+TEST(ElementGeometryTests, DISABLED_PerElementTypeBenchmark)
+{
+  benchmark("TetVol", tetLattice(60)->vmesh());
+  benchmark("TriSurf", triLattice(1000)->vmesh());
+  benchmark("HexVol", hexLattice(80)->vmesh());
+}
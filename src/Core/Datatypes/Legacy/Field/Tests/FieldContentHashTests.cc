@@ -0,0 +1,90 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/GeometryPrimitives/Tensor.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::TestUtils;
+
+TEST(FieldContentHashTests, IndependentlyBuiltFieldsHashEqual)
+{
+  FieldHandle a = CubeTetVolLinearBasis(DOUBLE_E);
+  FieldHandle b = CubeTetVolLinearBasis(DOUBLE_E);
+  EXPECT_NE(0u, a->contentHash());
+  EXPECT_EQ(a->contentHash(), b->contentHash());
+}
+
+TEST(FieldContentHashTests, ValuesChangeHash)
+{
+  FieldHandle a = CubeTetVolLinearBasis(DOUBLE_E);
+  FieldHandle b(a->deep_clone());
+  EXPECT_EQ(a->contentHash(), b->contentHash());
+  b->vfield()->set_value(3.0, VMesh::index_type(0));
+  EXPECT_NE(a->contentHash(), b->contentHash());
+}
+
+TEST(FieldContentHashTests, GeometryChangesHash)
+{
+  FieldHandle a = CubeTetVolLinearBasis(DOUBLE_E);
+  FieldHandle b(a->deep_clone());
+  Point p;
+  b->vmesh()->get_point(p, VMesh::Node::index_type(0));
+  b->vmesh()->set_point(p + Vector(0, 0, 1), VMesh::Node::index_type(0));
+  EXPECT_NE(a->contentHash(), b->contentHash());
+}
+
+TEST(FieldContentHashTests, PropertiesChangeHash)
+{
+  FieldHandle a = CubeTetVolLinearBasis(DOUBLE_E);
+  FieldHandle b(a->deep_clone());
+  std::vector<std::pair<std::string, Tensor>> table { { "0", Tensor(1.0) } };
+  a->properties().set_property("conductivity_table", table, false);
+  b->properties().set_property("conductivity_table", table, false);
+  EXPECT_EQ(a->contentHash(), b->contentHash());
+
+  table[0].second = Tensor(2.0);
+  b->properties().set_property("conductivity_table", table, false);
+  EXPECT_NE(a->contentHash(), b->contentHash());
+
+  // transient properties are not saved, so they do not count either
+  a->properties().freeze();
+  b->properties().freeze();
+  b->properties().set_property("conductivity_table", table, true);
+  a->properties().set_property("conductivity_table", table, true);
+  a->properties().set_property("scratch", 1.0, true);
+  EXPECT_EQ(a->contentHash(), b->contentHash());
+}
@@ -0,0 +1,87 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/GeometryPrimitives/Point.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::TestUtils;
+
+TEST(FieldCopyOnWriteTests, ValueWriteCopiesValuesAndSharesMesh)
+{
+  FieldHandle source = CubeTetVolLinearBasis(DOUBLE_E);
+  source->vfield()->set_all_values(1.0);
+
+  FieldCopyOnWrite reader(source), writer(source);
+  writer.write().vfield()->set_all_values(2.0);
+
+  EXPECT_EQ(source.get(), reader.get());
+  EXPECT_NE(source.get(), writer.get());
+  EXPECT_EQ(source->vmesh(), writer->vmesh());
+
+  double value;
+  source->vfield()->get_value(value, 0);
+  EXPECT_EQ(1.0, value);
+  writer->vfield()->get_value(value, 0);
+  EXPECT_EQ(2.0, value);
+}
+
+TEST(FieldCopyOnWriteTests, MeshWriteCopiesMesh)
+{
+  FieldHandle source = CubeTetVolLinearBasis(DOUBLE_E);
+  Point original;
+  source->vmesh()->get_point(original, VMesh::Node::index_type(0));
+
+  FieldCopyOnWrite writer(source);
+  writer.writeDeep().vmesh()->set_point(original + Vector(1, 0, 0), VMesh::Node::index_type(0));
+
+  EXPECT_NE(source->vmesh(), writer->vmesh());
+  Point p;
+  source->vmesh()->get_point(p, VMesh::Node::index_type(0));
+  EXPECT_EQ(original, p);
+  writer->vmesh()->get_point(p, VMesh::Node::index_type(0));
+  EXPECT_EQ(original + Vector(1, 0, 0), p);
+}
+
+TEST(FieldCopyOnWriteTests, MeshIsCopiedEvenForSoleOwnerOfAClone)
+{
+  FieldHandle source = CubeTetVolLinearBasis(DOUBLE_E);
+  FieldCopyOnWrite clone((FieldHandle(source->clone())));
+  EXPECT_EQ(source->vmesh(), clone->vmesh());
+
+  clone.writeDeep();
+
+  EXPECT_NE(source->vmesh(), clone->vmesh());
+}
@@ -0,0 +1,415 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Datatypes/Legacy/Field/TetVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/TriSurfMesh.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Basis/TriLinearLgn.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  typedef TetVolMesh<Core::Basis::TetLinearLgn<Point> > TetMesh;
+  typedef TriSurfMesh<Core::Basis::TriLinearLgn<Point> > TriMesh;
+
+  // Lattice coordinate i of n, cubed when graded so that cells near the
+  // origin are up to 3n^2 times smaller than the ones at the far end
+  double coordinate(int i, int n, bool graded)
+  {
+    const double t = static_cast<double>(i) / n;
+    return (graded ? t*t*t : t);
+  }
+
+  // Kuhn split of an n^3 lattice of cubes into tets over the unit cube
+  boost::shared_ptr<TetMesh> tetLattice(int n, bool graded)
+  {
+    static const int offset[8][3] = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0},
+                                      {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+    static const int split[6][4] = { {0,1,2,6}, {0,2,3,6}, {0,3,7,6},
+                                     {0,7,4,6}, {0,4,5,6}, {0,5,1,6} };
+    boost::shared_ptr<TetMesh> mesh(new TetMesh());
+    for (int l = 0; l <= n; ++l)
+      for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i)
+          mesh->add_point(Point(coordinate(i, n, graded), coordinate(j, n, graded), coordinate(l, n, graded)));
+
+    TetMesh::Node::array_type nodes(4);
+    for (int l = 0; l < n; ++l)
+      for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+          for (int t = 0; t < 6; ++t)
+          {
+            for (int k = 0; k < 4; ++k)
+            {
+              const int* o = offset[split[t][k]];
+              nodes[k] = (i + o[0]) + (n + 1) * ((j + o[1]) + (n + 1) * (l + o[2]));
+            }
+            mesh->add_elem(nodes);
+          }
+    return mesh;
+  }
+
+  // Height field z = x*y/2 over an n^2 lattice, two triangles per square
+  boost::shared_ptr<TriMesh> triLattice(int n, bool graded)
+  {
+    boost::shared_ptr<TriMesh> mesh(new TriMesh());
+    for (int j = 0; j <= n; ++j)
+      for (int i = 0; i <= n; ++i)
+      {
+        const double x = coordinate(i, n, graded), y = coordinate(j, n, graded);
+        mesh->add_point(Point(x, y, 0.5 * x * y));
+      }
+
+    TriMesh::Node::array_type nodes(3);
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i)
+      {
+        const index_type a = i + (n + 1) * j, b = a + 1, c = a + n + 2, d = a + n + 1;
+        nodes[0] = a; nodes[1] = b; nodes[2] = c; mesh->add_elem(nodes);
+        nodes[0] = a; nodes[1] = c; nodes[2] = d; mesh->add_elem(nodes);
+      }
+    return mesh;
+  }
+
+  // Points in and around the unit cube, denser near the origin
+  Point sample(int s)
+  {
+    const double x = ((s * 37) % 1009) / 1009.0;
+    const double y = ((s * 53) % 1013) / 1013.0;
+    const double z = ((s * 71) % 1019) / 1019.0;
+    return Point(1.4 * x*x - 0.2, 1.4 * y*y - 0.2, 1.4 * z*z - 0.2);
+  }
+
+  const Mesh::mask_type gridSync = Mesh::ELEM_LOCATE_E | Mesh::FACES_E;
+  const Mesh::mask_type bvhSync = Mesh::ELEM_BVH_E;
+}
+
+TEST(MeshLocateTests, TetVolHierarchyMatchesGrid)
+{
+  for (bool graded : { false, true })
+  {
+    auto grid = tetLattice(8, graded);
+    auto bvh = tetLattice(8, graded);
+    grid->synchronize(gridSync);
+    bvh->synchronize(bvhSync);
+
+    for (int s = 0; s < 2000; ++s)
+    {
+      const Point p = sample(s);
+      TetMesh::Elem::index_type e1(-1), e2(-1);
+      ASSERT_EQ(grid->locate(e1, p), bvh->locate(e2, p)) << p;
+      EXPECT_EQ(e1, e2) << p;
+
+      double d1, d2;
+      Point r1, r2;
+      StackVector<double, 3> c1, c2;
+      TetMesh::Elem::index_type f1(-1), f2(-1);
+      ASSERT_TRUE(grid->find_closest_elem(d1, r1, c1, f1, p));
+      ASSERT_TRUE(bvh->find_closest_elem(d2, r2, c2, f2, p));
+      EXPECT_NEAR(d1, d2, 1e-12) << p;
+      EXPECT_NEAR((r1 - r2).length(), 0.0, 1e-12) << p;
+    }
+  }
+}
+
+TEST(MeshLocateTests, TriSurfHierarchyMatchesGrid)
+{
+  for (bool graded : { false, true })
+  {
+    auto grid = triLattice(16, graded);
+    auto bvh = triLattice(16, graded);
+    grid->synchronize(Mesh::ELEM_LOCATE_E);
+    bvh->synchronize(bvhSync);
+
+    for (int s = 0; s < 2000; ++s)
+    {
+      const Point p = sample(s);
+      double d1, d2;
+      Point r1, r2;
+      StackVector<double, 2> c1, c2;
+      TriMesh::Elem::index_type f1(-1), f2(-1);
+      ASSERT_TRUE(grid->find_closest_elem(d1, r1, c1, f1, p));
+      ASSERT_TRUE(bvh->find_closest_elem(d2, r2, c2, f2, p));
+      // Faces whose squared distances are within epsilon are ties, which
+      // are broken in the order the faces are visited
+      EXPECT_NEAR(d1*d1, d2*d2, grid->get_epsilon()) << p;
+
+      // The closest point lies on the surface, so both find an element there
+      TriMesh::Elem::index_type e1(-1), e2(-1);
+      EXPECT_TRUE(grid->locate(e1, r1)) << r1;
+      EXPECT_TRUE(bvh->locate(e2, r1)) << r1;
+
+      std::vector<TriMesh::Elem::index_type> elems1, elems2;
+      ASSERT_TRUE(grid->find_closest_elems(d1, r1, elems1, p));
+      ASSERT_TRUE(bvh->find_closest_elems(d2, r2, elems2, p));
+      EXPECT_NEAR(d1, d2, 1e-9) << p;
+      // The grid reports a face once for every bin it overlaps
+      std::sort(elems1.begin(), elems1.end());
+      elems1.erase(std::unique(elems1.begin(), elems1.end()), elems1.end());
+      std::sort(elems2.begin(), elems2.end());
+      EXPECT_EQ(elems1, elems2) << p;
+    }
+  }
+}
+
+TEST(MeshLocateTests, EditingDropsHierarchy)
+{
+  auto mesh = tetLattice(2, false);
+  mesh->synchronize(bvhSync | Mesh::ELEM_LOCATE_E);
+  TetMesh::Node::array_type nodes;
+  mesh->get_nodes(nodes, TetMesh::Elem::index_type(0));
+  mesh->set_nodes(nodes, TetMesh::Elem::index_type(0));
+
+  // Queries fall back to the grid, which is updated in place
+  TetMesh::Elem::index_type e(-1);
+  EXPECT_TRUE(mesh->locate(e, Point(0.3, 0.2, 0.1)));
+  mesh->synchronize(bvhSync);
+  TetMesh::Elem::index_type e2(-1);
+  EXPECT_TRUE(mesh->locate(e2, Point(0.3, 0.2, 0.1)));
+  EXPECT_EQ(e, e2);
+}
+
+TEST(MeshLocateTests, EditsUpdateGridsInPlace)
+{
+  auto mesh = tetLattice(3, false);
+  mesh->synchronize(Mesh::NODE_NEIGHBORS_E | Mesh::ELEM_LOCATE_E | Mesh::NODE_LOCATE_E);
+
+  // Nudge the node at (1/3,1/3,1/3) and split a cell next to it at its center
+  const TetMesh::Node::index_type moved(21);
+  mesh->set_point(Point(0.35, 0.32, 0.34), moved);
+
+  TetMesh::Node::array_type n, nodes(4);
+  const TetMesh::Elem::index_type split(0);
+  mesh->get_nodes(n, split);
+  Point center;
+  mesh->get_center(center, split);
+  const TetMesh::Node::index_type added = mesh->add_point(center);
+  nodes[0] = n[0]; nodes[1] = n[1]; nodes[2] = n[2]; nodes[3] = added;
+  mesh->set_nodes(nodes, split);
+  nodes[0] = n[0]; nodes[1] = n[1]; nodes[2] = added; nodes[3] = n[3];
+  mesh->add_elem(nodes);
+  nodes[0] = n[0]; nodes[1] = added; nodes[2] = n[2]; nodes[3] = n[3];
+  mesh->add_elem(nodes);
+  nodes[0] = added; nodes[1] = n[1]; nodes[2] = n[2]; nodes[3] = n[3];
+  mesh->add_elem(nodes);
+
+  TetMesh::Elem::size_type numElems;
+  mesh->size(numElems);
+  for (index_type c = 0; c < static_cast<index_type>(numElems); ++c)
+  {
+    Point p;
+    mesh->get_center(p, TetMesh::Elem::index_type(c));
+    TetMesh::Elem::index_type e(-1);
+    EXPECT_TRUE(mesh->locate(e, p)) << c;
+    EXPECT_EQ(c, e);
+  }
+
+  TetMesh::Node::size_type numNodes;
+  mesh->size(numNodes);
+  for (index_type i = 0; i < static_cast<index_type>(numNodes); ++i)
+  {
+    double dist;
+    Point p, r;
+    mesh->get_point(p, TetMesh::Node::index_type(i));
+    TetMesh::Node::index_type found(-1);
+    EXPECT_TRUE(mesh->find_closest_node(dist, r, found, p));
+    EXPECT_EQ(i, found);
+  }
+
+  // A node outside the grids makes the next query rebuild them
+  const TetMesh::Node::index_type outside = mesh->add_point(Point(2, 2, 2));
+  double dist;
+  Point r;
+  TetMesh::Node::index_type found(-1);
+  mesh->synchronize(Mesh::NODE_LOCATE_E);
+  EXPECT_TRUE(mesh->find_closest_node(dist, r, found, Point(1.9, 2, 2)));
+  EXPECT_EQ(outside, found);
+}
+
+TEST(MeshLocateTests, BatchedQueriesMatchSingleQueries)
+{
+  auto mesh = tetLattice(6, true);
+  mesh->synchronize(Mesh::ELEM_LOCATE_E | Mesh::FIND_CLOSEST_ELEM_E | Mesh::FIND_CLOSEST_NODE_E);
+  VMesh* vmesh = mesh->vmesh();
+
+  std::vector<Point> points;
+  for (int s = 0; s < 5000; ++s)
+    points.push_back(sample(s));
+
+  // Points on shared faces may land in either element, so compare what the
+  // answers mean rather than the indices
+  std::vector<VMesh::Elem::index_type> elems;
+  std::vector<VMesh::coords_type> coords;
+  vmesh->locate_many(elems, coords, points);
+  ASSERT_EQ(points.size(), elems.size());
+  for (size_t j = 0; j < points.size(); ++j)
+  {
+    VMesh::Elem::index_type e(-1);
+    ASSERT_EQ(vmesh->locate(e, points[j]), elems[j] >= 0) << j;
+    if (elems[j] < 0) continue;
+    Point q;
+    vmesh->interpolate(q, coords[j], elems[j]);
+    EXPECT_NEAR(0.0, (q - points[j]).length(), 1e-9) << j;
+  }
+
+  for (double maxdist : { -1.0, 0.05 })
+  {
+    std::vector<double> dist;
+    std::vector<Point> result;
+    vmesh->find_closest_elem_many(dist, result, coords, elems, points, maxdist);
+    for (size_t j = 0; j < points.size(); ++j)
+    {
+      double d;
+      Point r;
+      VMesh::coords_type c;
+      VMesh::Elem::index_type e(-1);
+      ASSERT_EQ(vmesh->find_closest_elem(d, r, c, e, points[j], maxdist), elems[j] >= 0) << j;
+      if (elems[j] < 0) continue;
+      EXPECT_NEAR(d, dist[j], 1e-9) << j;
+      Point q;
+      vmesh->interpolate(q, coords[j], elems[j]);
+      EXPECT_NEAR(0.0, (q - result[j]).length(), 1e-9) << j;
+    }
+
+    std::vector<VMesh::Node::index_type> nodes;
+    vmesh->find_closest_node_many(dist, result, nodes, points, maxdist);
+    for (size_t j = 0; j < points.size(); ++j)
+    {
+      double d;
+      Point r;
+      VMesh::Node::index_type n(-1);
+      ASSERT_EQ(vmesh->find_closest_node(d, r, n, points[j], maxdist), nodes[j] >= 0) << j;
+      if (nodes[j] < 0) continue;
+      EXPECT_NEAR(d, dist[j], 1e-9) << j;
+      Point q;
+      vmesh->get_center(q, nodes[j]);
+      EXPECT_EQ(q, result[j]) << j;
+    }
+  }
+}
+
+namespace
+{
+  template <class MESH>
+  void timeQueries(const char* name, MESH& mesh, Mesh::mask_type sync)
+  {
+    auto t0 = std::chrono::steady_clock::now();
+    mesh.synchronize(sync);
+    auto t1 = std::chrono::steady_clock::now();
+
+    int inside = 0;
+    for (int s = 0; s < 200000; ++s)
+    {
+      typename MESH::Elem::index_type e(-1);
+      if (mesh.locate(e, sample(s))) inside++;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double total = 0;
+    for (int s = 0; s < 20000; ++s)
+    {
+      double d;
+      Point r;
+      typename MESH::Elem::index_type e(-1);
+      mesh.find_closest_elem(d, r, e, sample(s) + Vector(0.3, 0.3, 0.3));
+      total += d;
+    }
+    auto t3 = std::chrono::steady_clock::now();
+
+    std::cout << name << ": build " << std::chrono::duration<double>(t1 - t0).count()
+      << " s, 200k locate " << std::chrono::duration<double>(t2 - t1).count()
+      << " s (" << inside << " inside), 20k closest " << std::chrono::duration<double>(t3 - t2).count()
+      << " s (sum " << total << ")" << std::endl;
+  }
+}
+
+TEST(MeshLocateTests, DISABLED_GradedVersusUniformBenchmark)
+{
+  for (bool graded : { false, true })
+  {
+    const char* shape = graded ? "graded" : "uniform";
+    std::cout << shape << " tet lattice, " << 6 * 40 * 40 * 40 << " cells" << std::endl;
+    timeQueries("  grid", *tetLattice(40, graded), gridSync);
+    timeQueries("  bvh ", *tetLattice(40, graded), bvhSync);
+
+    std::cout << shape << " tri surface, " << 2 * 400 * 400 << " faces" << std::endl;
+    timeQueries("  grid", *triLattice(400, graded), Mesh::ELEM_LOCATE_E);
+    timeQueries("  bvh ", *triLattice(400, graded), bvhSync);
+  }
+}
+
+// Mapping a 1M node destination onto a 5M tet source, the shape of the
+// closest data and interpolated mappings: one virtual query per point in
+// destination order against one batched query.
+TEST(MeshLocateTests, DISABLED_BatchedVersusSingleQueriesBenchmark)
+{
+  auto mesh = tetLattice(94, false);
+  auto t0 = std::chrono::steady_clock::now();
+  mesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
+  auto t1 = std::chrono::steady_clock::now();
+  VMesh* vmesh = mesh->vmesh();
+  std::cout << vmesh->num_elems() << " cells, synchronize "
+    << std::chrono::duration<double>(t1 - t0).count() << " s" << std::endl;
+
+  std::vector<Point> points;
+  for (int s = 0; s < 1000000; ++s)
+    points.push_back(sample(s));
+
+  std::vector<double> dist(points.size());
+  std::vector<Point> result(points.size());
+  std::vector<VMesh::coords_type> coords(points.size());
+  std::vector<VMesh::Elem::index_type> elems(points.size());
+
+  t0 = std::chrono::steady_clock::now();
+  double total = 0;
+  for (size_t j = 0; j < points.size(); ++j)
+  {
+    vmesh->find_closest_elem(dist[j], result[j], coords[j], elems[j], points[j]);
+    total += dist[j];
+  }
+  t1 = std::chrono::steady_clock::now();
+  std::cout << "single:  " << std::chrono::duration<double>(t1 - t0).count()
+    << " s (sum " << total << ")" << std::endl;
+
+  t0 = std::chrono::steady_clock::now();
+  vmesh->find_closest_elem_many(dist, result, coords, elems, points, -1.0);
+  t1 = std::chrono::steady_clock::now();
+  total = 0;
+  for (size_t j = 0; j < points.size(); ++j)
+    total += dist[j];
+  std::cout << "batched: " << std::chrono::duration<double>(t1 - t0).count()
+    << " s (sum " << total << ")" << std::endl;
+}
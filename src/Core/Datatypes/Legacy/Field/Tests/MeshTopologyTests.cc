@@ -0,0 +1,514 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Datatypes/Legacy/Field/TetVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/HexVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/PrismVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/MeshTopology.h>
+#include <Core/Basis/PrismLinearLgn.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::MeshTopology;
+
+namespace
+{
+  typedef TetVolMesh<Core::Basis::TetLinearLgn<Point> > TetMesh;
+  typedef HexVolMesh<Core::Basis::HexTrilinearLgn<Point> > HexMesh;
+  typedef PrismVolMesh<Core::Basis::PrismLinearLgn<Point> > PrismMesh;
+
+  typedef std::vector<index_type> IndexList;
+
+  // Corner k of cube (i,j,l) in an (n+1)^3 lattice of points, in hex node order
+  index_type corner(int n, int i, int j, int l, int k)
+  {
+    static const int offset[8][3] = { {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0},
+                                      {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+    return (i + offset[k][0]) + (n + 1) * ((j + offset[k][1]) + (n + 1) * (l + offset[k][2]));
+  }
+
+  // Fills an n^3 lattice of cubes, each split into the given cells over its corners
+  template <class MESH, size_t NODES>
+  boost::shared_ptr<MESH> cubeLattice(int n, const std::vector<std::array<int, NODES> >& split)
+  {
+    boost::shared_ptr<MESH> mesh(new MESH());
+    for (int l = 0; l <= n; ++l)
+      for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i)
+          mesh->add_point(Point(i, j, l));
+
+    typename MESH::Node::array_type nodes(NODES);
+    for (int l = 0; l < n; ++l)
+      for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+          for (const auto& cell : split)
+          {
+            for (size_t k = 0; k < NODES; ++k)
+              nodes[k] = corner(n, i, j, l, cell[k]);
+            mesh->add_elem(nodes);
+          }
+    return mesh;
+  }
+
+  boost::shared_ptr<TetMesh> tetLattice(int n)
+  {
+    // Kuhn split around the 0-6 diagonal, conforming between cubes
+    return cubeLattice<TetMesh, 4>(n, { {{0,1,2,6}}, {{0,2,3,6}}, {{0,3,7,6}},
+                                        {{0,7,4,6}}, {{0,4,5,6}}, {{0,5,1,6}} });
+  }
+
+  boost::shared_ptr<HexMesh> hexLattice(int n)
+  {
+    return cubeLattice<HexMesh, 8>(n, { {{0,1,2,3,4,5,6,7}} });
+  }
+
+  boost::shared_ptr<PrismMesh> prismLattice(int n)
+  {
+    return cubeLattice<PrismMesh, 6>(n, { {{0,1,2,4,5,6}}, {{0,2,3,4,6,7}} });
+  }
+
+  IndexList sorted(IndexList list)
+  {
+    std::sort(list.begin(), list.end());
+    return list;
+  }
+
+  // StackVector iterates over its whole capacity, so stop at size()
+  template <class ARRAY>
+  IndexList toList(const ARRAY& array)
+  {
+    return IndexList(array.begin(), array.begin() + array.size());
+  }
+
+  // Everything synchronize() derives, keyed by node indices so that it does
+  // not depend on how edges and faces happen to be numbered.
+  struct Topology
+  {
+    // nodes to the cells of each edge or face with those nodes
+    std::map<IndexList, std::vector<IndexList> > edgeCells, faceCells;
+    std::vector<IndexList> nodeCells, nodeNeighbors, cellEdges, cellFaces, cellNeighbors;
+    size_t edges, faces;
+  };
+
+  template <class MESH>
+  Topology topologyOf(MESH& mesh)
+  {
+    mesh.synchronize(Mesh::EDGES_E | Mesh::FACES_E | Mesh::NODE_NEIGHBORS_E | Mesh::ELEM_NEIGHBORS_E);
+
+    Topology t;
+    typename MESH::Node::array_type nodes;
+    typename MESH::Elem::array_type cells;
+
+    typename MESH::Edge::size_type numEdges;
+    mesh.size(numEdges);
+    t.edges = numEdges;
+    for (index_type e = 0; e < static_cast<index_type>(numEdges); ++e)
+    {
+      mesh.get_nodes(nodes, typename MESH::Edge::index_type(e));
+      mesh.get_elems(cells, typename MESH::Edge::index_type(e));
+      t.edgeCells[sorted(toList(nodes))].push_back(sorted(toList(cells)));
+    }
+
+    typename MESH::Face::size_type numFaces;
+    mesh.size(numFaces);
+    t.faces = numFaces;
+    for (index_type f = 0; f < static_cast<index_type>(numFaces); ++f)
+    {
+      mesh.get_nodes(nodes, typename MESH::Face::index_type(f));
+      mesh.get_elems(cells, typename MESH::Face::index_type(f));
+      t.faceCells[sorted(toList(nodes))].push_back(sorted(toList(cells)));
+    }
+
+    // PrismVolMesh does not match the triangles shared between prisms, so a
+    // node set can appear on more than one face
+    for (auto& face : t.faceCells)
+      std::sort(face.second.begin(), face.second.end());
+
+    typename MESH::Node::size_type numNodes;
+    mesh.size(numNodes);
+    std::vector<typename MESH::Node::index_type> neighbors;
+    for (index_type n = 0; n < static_cast<index_type>(numNodes); ++n)
+    {
+      mesh.get_elems(cells, typename MESH::Node::index_type(n));
+      t.nodeCells.push_back(sorted(toList(cells)));
+      mesh.get_neighbors(neighbors, typename MESH::Node::index_type(n));
+      t.nodeNeighbors.push_back(sorted(toList(neighbors)));
+    }
+
+    typename MESH::Cell::size_type numCells;
+    mesh.size(numCells);
+    typename MESH::Edge::array_type edges;
+    typename MESH::Face::array_type faces;
+    for (index_type c = 0; c < static_cast<index_type>(numCells); ++c)
+    {
+      const typename MESH::Cell::index_type ci(c);
+      // get_edges/get_faces of a cell fill a presized array on some meshes
+      edges.assign(12, typename MESH::Edge::index_type(-1));
+      mesh.get_edges(edges, ci);
+      IndexList edgeKeys;
+      for (auto e : edges)
+      {
+        if (index_type(e) < 0) continue;
+        mesh.get_nodes(nodes, e);
+        auto key = sorted(toList(nodes));
+        edgeKeys.insert(edgeKeys.end(), key.begin(), key.end());
+      }
+      t.cellEdges.push_back(edgeKeys);
+
+      faces.assign(6, typename MESH::Face::index_type(-1));
+      mesh.get_faces(faces, ci);
+      IndexList faceKeys, neighborCells;
+      for (auto f : faces)
+      {
+        if (index_type(f) < 0) continue;
+        mesh.get_nodes(nodes, f);
+        auto key = sorted(toList(nodes));
+        faceKeys.insert(faceKeys.end(), key.begin(), key.end());
+        typename MESH::Elem::index_type neighbor;
+        neighborCells.push_back(mesh.get_neighbor(neighbor, ci, f) ? index_type(neighbor) : -1);
+      }
+      t.cellFaces.push_back(faceKeys);
+      t.cellNeighbors.push_back(neighborCells);
+    }
+    return t;
+  }
+
+  void expectSameTopology(const Topology& sorted, const Topology& hashed)
+  {
+    EXPECT_EQ(hashed.edges, sorted.edges);
+    EXPECT_EQ(hashed.faces, sorted.faces);
+    EXPECT_EQ(hashed.edgeCells, sorted.edgeCells);
+    EXPECT_EQ(hashed.faceCells, sorted.faceCells);
+    EXPECT_EQ(hashed.nodeCells, sorted.nodeCells);
+    EXPECT_EQ(hashed.nodeNeighbors, sorted.nodeNeighbors);
+    EXPECT_EQ(hashed.cellEdges, sorted.cellEdges);
+    EXPECT_EQ(hashed.cellFaces, sorted.cellFaces);
+    EXPECT_EQ(hashed.cellNeighbors, sorted.cellNeighbors);
+  }
+
+  // Builds the mesh twice and compares the topology of both construction methods
+  template <class MAKE>
+  void compareConstructions(MAKE make)
+  {
+    setConstruction(Construction::Hashed);
+    auto hashedMesh = make();
+    auto hashed = topologyOf(*hashedMesh);
+    setConstruction(Construction::Sorted);
+    auto sortedMesh = make();
+    auto sortedTopology = topologyOf(*sortedMesh);
+    expectSameTopology(sortedTopology, hashed);
+  }
+
+  // Resets the peak resident set size so each construction is measured alone
+  void resetPeakMemory()
+  {
+    std::ofstream("/proc/self/clear_refs") << "5";
+  }
+
+  double peakMemoryMB()
+  {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+      if (line.compare(0, 6, "VmHWM:") == 0)
+        return std::stod(line.substr(6)) / 1024.0;
+    return 0;
+  }
+}
+
+TEST(MeshTopologyTests, RadixSortIsStableAndLexicographic)
+{
+  std::vector<Entry<2> > entries;
+  const key_type limit = 300;
+  for (key_type i = 0; i < 1000; ++i)
+  {
+    Entry<2> e;
+    e.nodes[0] = (i * 7919) % limit;
+    e.nodes[1] = (i * 104729) % 5;
+    e.order = i;
+    entries.push_back(e);
+  }
+  auto expected = entries;
+  std::stable_sort(expected.begin(), expected.end(), [](const Entry<2>& a, const Entry<2>& b)
+    { return a.nodes[0] < b.nodes[0] || (a.nodes[0] == b.nodes[0] && a.nodes[1] < b.nodes[1]); });
+
+  sortEntries(entries, limit);
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    EXPECT_EQ(expected[i].nodes[0], entries[i].nodes[0]);
+    EXPECT_EQ(expected[i].nodes[1], entries[i].nodes[1]);
+    EXPECT_EQ(expected[i].order, entries[i].order);
+  }
+}
+
+TEST(MeshTopologyTests, CompressedAdjacencyEditsRowsAfterBuild)
+{
+  CompressedAdjacency<index_type> adjacency;
+  const std::vector<size_t> rows = { 2, 0, 2, 1, 0, 2 };
+  adjacency.build(3, rows.size(), [&](size_t i) { return rows[i]; }, [](size_t i) { return index_type(i); });
+
+  ASSERT_EQ(3u, adjacency.size());
+  EXPECT_EQ(IndexList({ 1, 4 }), toList(adjacency[0]));
+  EXPECT_EQ(IndexList({ 3 }), toList(adjacency[1]));
+  EXPECT_EQ(IndexList({ 0, 2, 5 }), toList(adjacency[2]));
+
+  adjacency.push_back(1, 7);
+  EXPECT_TRUE(adjacency.erase(2, 2));
+  EXPECT_FALSE(adjacency.erase(0, 9));
+  adjacency.add_row();
+  adjacency.push_back(3, 8);
+
+  ASSERT_EQ(4u, adjacency.size());
+  EXPECT_EQ(IndexList({ 1, 4 }), toList(adjacency[0]));
+  EXPECT_EQ(IndexList({ 3, 7 }), toList(adjacency[1]));
+  EXPECT_EQ(IndexList({ 0, 5 }), toList(adjacency[2]));
+  EXPECT_EQ(IndexList({ 8 }), toList(adjacency[3]));
+}
+
+TEST(MeshTopologyTests, TetVolSortedMatchesHashed)
+{
+  compareConstructions([]() { return tetLattice(4); });
+}
+
+TEST(MeshTopologyTests, HexVolSortedMatchesHashed)
+{
+  compareConstructions([]() { return hexLattice(4); });
+}
+
+TEST(MeshTopologyTests, HexVolSortedMatchesHashedWithDegenerateCells)
+{
+  compareConstructions([]()
+  {
+    auto mesh = hexLattice(2);
+    // a hex collapsed into a prism onto the lattice, and one collapsed to a quad
+    mesh->add_elem(IndexList({ 2, 9, 9, 5, 11, 18, 18, 14 }));
+    mesh->add_elem(IndexList({ 0, 1, 4, 3, 0, 1, 4, 3 }));
+    return mesh;
+  });
+}
+
+TEST(MeshTopologyTests, PrismVolSortedMatchesHashed)
+{
+  compareConstructions([]() { return prismLattice(4); });
+}
+
+TEST(MeshTopologyTests, SortedCountsMatchLattice)
+{
+  const int n = 5;
+  auto hex = hexLattice(n);
+  auto t = topologyOf(*hex);
+  EXPECT_EQ(3u * n * (n + 1) * (n + 1), t.edges);
+  EXPECT_EQ(3u * n * n * (n + 1), t.faces);
+  size_t boundary = 0;
+  for (const auto& neighbors : t.cellNeighbors)
+    boundary += std::count(neighbors.begin(), neighbors.end(), -1);
+  EXPECT_EQ(6u * n * n, boundary);
+}
+
+TEST(MeshTopologyTests, TetVolEditsKeepNodeNeighbors)
+{
+  auto mesh = tetLattice(2);
+  mesh->synchronize(Mesh::NODE_NEIGHBORS_E);
+
+  // cell 0 is {0,1,4,13}; move its last two corners onto nodes 3 and 9
+  TetMesh::Node::array_type nodes(4);
+  nodes[0] = 0; nodes[1] = 1; nodes[2] = 3; nodes[3] = 9;
+  mesh->set_nodes(nodes, TetMesh::Cell::index_type(0));
+
+  auto cellsOf = [&mesh](index_type node)
+  {
+    TetMesh::Elem::array_type elems;
+    mesh->get_elems(elems, TetMesh::Node::index_type(node));
+    return sorted(toList(elems));
+  };
+  auto uses = [&cellsOf](index_type node, index_type cell)
+  {
+    auto cells = cellsOf(node);
+    return std::count(cells.begin(), cells.end(), cell);
+  };
+
+  EXPECT_EQ(1, uses(0, 0));
+  EXPECT_EQ(1, uses(3, 0));
+  EXPECT_EQ(1, uses(9, 0));
+  EXPECT_EQ(0, uses(4, 0));
+  EXPECT_EQ(0, uses(13, 0));
+}
+
+TEST(MeshTopologyTests, TopologyGenerationChangesWithConnectivityOnly)
+{
+  auto mesh = tetLattice(2);
+  auto generation = mesh->topologyGeneration();
+
+  mesh->set_point(Point(0.1, 0, 0), TetMesh::Node::index_type(0));
+  EXPECT_EQ(generation, mesh->topologyGeneration());
+
+  TetMesh::Node::array_type nodes(4);
+  nodes[0] = 0; nodes[1] = 1; nodes[2] = 3; nodes[3] = 9;
+  mesh->set_nodes(nodes, TetMesh::Cell::index_type(0));
+  EXPECT_NE(generation, mesh->topologyGeneration());
+
+  generation = mesh->topologyGeneration();
+  mesh->add_point(Point(3, 3, 3));
+  EXPECT_NE(generation, mesh->topologyGeneration());
+}
+
+namespace
+{
+  // Splits each cell at its centroid in place: the cell keeps three of its
+  // corners and the new node, three new cells take the rest
+  void splitCells(TetMesh& mesh, const IndexList& cells)
+  {
+    TetMesh::Node::array_type n, nodes(4);
+    for (auto c : cells)
+    {
+      const TetMesh::Cell::index_type ci(c);
+      mesh.get_nodes(n, ci);
+      Point center;
+      mesh.get_center(center, ci);
+      const TetMesh::Node::index_type p = mesh.add_point(center);
+
+      nodes[0] = n[0]; nodes[1] = n[1]; nodes[2] = n[2]; nodes[3] = p;
+      mesh.set_nodes(nodes, ci);
+      nodes[0] = n[0]; nodes[1] = n[1]; nodes[2] = p; nodes[3] = n[3];
+      mesh.add_elem(nodes);
+      nodes[0] = n[0]; nodes[1] = p; nodes[2] = n[2]; nodes[3] = n[3];
+      mesh.add_elem(nodes);
+      nodes[0] = p; nodes[1] = n[1]; nodes[2] = n[2]; nodes[3] = n[3];
+      mesh.add_elem(nodes);
+    }
+  }
+
+  // A mesh with the same nodes and cells that has never been synchronized
+  boost::shared_ptr<TetMesh> rebuilt(TetMesh& mesh)
+  {
+    boost::shared_ptr<TetMesh> copy(new TetMesh());
+    TetMesh::Node::size_type numNodes;
+    mesh.size(numNodes);
+    Point p;
+    for (index_type n = 0; n < static_cast<index_type>(numNodes); ++n)
+    {
+      mesh.get_point(p, TetMesh::Node::index_type(n));
+      copy->add_point(p);
+    }
+
+    TetMesh::Cell::size_type numCells;
+    mesh.size(numCells);
+    TetMesh::Node::array_type nodes;
+    for (index_type c = 0; c < static_cast<index_type>(numCells); ++c)
+    {
+      mesh.get_nodes(nodes, TetMesh::Cell::index_type(c));
+      copy->add_elem(nodes);
+    }
+    return copy;
+  }
+}
+
+TEST(MeshTopologyTests, TetVolIncrementalEditsMatchRebuild)
+{
+  auto mesh = tetLattice(4);
+  mesh->synchronize(Mesh::EDGES_E | Mesh::FACES_E | Mesh::NODE_NEIGHBORS_E);
+
+  // Cells on the boundary and inside, the first and last cell, and cells
+  // added by an earlier split
+  splitCells(*mesh, { 0, 1, 100, 101, 200, 383 });
+  splitCells(*mesh, { 384, 390, 400 });
+
+  // Edges and faces are renumbered by the edits, but must have no holes
+  expectSameTopology(topologyOf(*rebuilt(*mesh)), topologyOf(*mesh));
+}
+
+// Time and peak resident memory of synchronize(EDGES_E|FACES_E|NODE_NEIGHBORS_E)
+// with both constructions; memory is the growth over the mesh itself.
+template <class MAKE>
+void benchmarkSynchronize(MAKE make)
+{
+  for (auto method : { Construction::Hashed, Construction::Sorted })
+  {
+    setConstruction(method);
+    auto mesh = make();
+    resetPeakMemory();
+    const double base = peakMemoryMB();
+    auto start = std::chrono::steady_clock::now();
+    mesh->synchronize(Mesh::EDGES_E | Mesh::FACES_E | Mesh::NODE_NEIGHBORS_E);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (method == Construction::Sorted ? "sorted" : "hashed") << ": " << elapsed.count()
+      << " s, peak +" << peakMemoryMB() - base << " MB over the mesh" << std::endl;
+  }
+  setConstruction(Construction::Sorted);
+}
+
+TEST(MeshTopologyBenchmark, DISABLED_TetVolSynchronize)
+{
+  benchmarkSynchronize([]() { return tetLattice(60); });
+}
+
+// Splitting cells of a synchronized mesh in place: tables kept up to date by
+// the edits against synchronizing again from scratch after them.
+TEST(MeshTopologyBenchmark, DISABLED_TetVolInPlaceCellSplits)
+{
+  const Mesh::mask_type sync = Mesh::EDGES_E | Mesh::FACES_E | Mesh::NODE_NEIGHBORS_E |
+                               Mesh::NODE_LOCATE_E | Mesh::ELEM_LOCATE_E;
+  // 1200 cells in a corner of the lattice
+  IndexList cells;
+  for (index_type c = 0; c < 200; ++c)
+    for (index_type t = 0; t < 6; ++t)
+      cells.push_back(6 * (c % 10 + 94 * (c / 10)) + t);
+
+  for (bool incremental : { true, false })
+  {
+    auto mesh = tetLattice(94);
+    mesh->synchronize(sync);
+    auto start = std::chrono::steady_clock::now();
+    if (!incremental) mesh->clear_synchronization();
+    splitCells(*mesh, cells);
+    mesh->synchronize(sync);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (incremental ? "incremental" : "resynchronized") << ": " << elapsed.count()
+      << " s" << std::endl;
+  }
+}
+
+TEST(MeshTopologyBenchmark, DISABLED_HexVolSynchronize)
+{
+  benchmarkSynchronize([]() { return hexLattice(80); });
+}
+
+TEST(MeshTopologyBenchmark, DISABLED_PrismVolSynchronize)
+{
+  benchmarkSynchronize([]() { return prismLattice(60); });
+}
@@ -34,9 +34,11 @@
 #include <Testing/Utils/SCIRunFieldSamples.h>
 
 #include <vector>
+#include <typeinfo>
 
 using namespace SCIRun;
 using namespace SCIRun::TestUtils;
+using namespace SCIRun::Core::Geometry;
 
 TEST(VFieldTest, EmptyFieldConstantBasis)
 {
@@ -191,4 +193,71 @@ TEST(VFieldTest, TetVolMeshSetFieldValueTest2)
  
 }
 
+TEST(VFieldTest, DataSpanMatchesStorageType)
+{
+  FieldHandle field = TetrahedronTetVolLinearBasis(DOUBLE_E);
+  VField *vfield = field->vfield();
+  vfield->resize_values();
+  std::vector<double> values = { 1.0, 2.0, 3.0, 4.0 };
+  vfield->set_values(values);
+
+  auto span = vfield->data_span<double>();
+  ASSERT_EQ(4, span.size());
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(values[i], span[i]);
+
+  span[2] = 7.0;
+  double value;
+  vfield->get_value(value, 2);
+  EXPECT_EQ(7.0, value);
+
+  EXPECT_TRUE(vfield->data_span<float>().empty());
+  EXPECT_TRUE(vfield->data_span<Vector>().empty());
+}
+
+TEST(VFieldTest, MeshNodesSpanOnlyForIrregularMeshes)
+{
+  FieldHandle tets = TetrahedronTetVolLinearBasis(DOUBLE_E);
+  auto nodes = tets->vfield()->mesh_nodes_span();
+  ASSERT_EQ(tets->vmesh()->num_nodes(), nodes.size());
+  Point p;
+  tets->vmesh()->get_center(p, VMesh::Node::index_type(3));
+  EXPECT_EQ(p, nodes[3]);
+
+  FieldHandle latvol = CreateEmptyLatVol(2, 2, 2);
+  EXPECT_TRUE(latvol->vfield()->mesh_nodes_span().empty());
+}
+
+namespace
+{
+  struct RecordSpanType
+  {
+    template <class T>
+    void operator()(FieldSpan<T> span)
+    {
+      type = &typeid(T);
+      size = span.size();
+    }
+    const std::type_info* type = nullptr;
+    size_t size = 0;
+  };
+}
 
+TEST(VFieldTest, DispatchValuesRunsKernelOnStorageType)
+{
+  FieldHandle ints = TetrahedronTetVolLinearBasis(INT_E);
+  ints->vfield()->resize_values();
+  RecordSpanType kernel;
+  ASSERT_TRUE(dispatch_scalar_values(ints->vfield(), kernel));
+  EXPECT_EQ(typeid(int), *kernel.type);
+  EXPECT_EQ(4, kernel.size);
+
+  FieldHandle vectors = TetrahedronTetVolConstantBasis(VECTOR_E);
+  vectors->vfield()->resize_values();
+  RecordSpanType vkernel;
+  EXPECT_FALSE(dispatch_scalar_values(vectors->vfield(), vkernel));
+  EXPECT_EQ(nullptr, vkernel.type);
+  ASSERT_TRUE(dispatch_values(vectors->vfield(), vkernel));
+  EXPECT_EQ(typeid(Vector), *vkernel.type);
+  EXPECT_EQ(1, vkernel.size);
+}
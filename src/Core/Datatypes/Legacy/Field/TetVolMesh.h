@@ -38,6 +38,7 @@
 #include <Core/Persistent/PersistentSTL.h>
 
 #include <Core/GeometryPrimitives/SearchGridT.h>
+#include <Core/GeometryPrimitives/BoundingVolumeHierarchy.h>
 #include <Core/GeometryPrimitives/BBox.h>
 #include <Core/GeometryPrimitives/CompGeom.h>
 #include <Core/GeometryPrimitives/Point.h>
@@ -52,6 +53,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/MeshTopology.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Mesh/VirtualMeshFacade.h>
 #include <Core/Math/MiscMath.h>
@@ -334,6 +336,18 @@ public:
           if (sync_ & Mesh::ELEM_LOCATE_E) mesh_->compute_elem_grid();
         }
 
+        // The hierarchy depends on the bounding box and the boundary faces
+        if (sync_ & Mesh::ELEM_BVH_E)
+        {
+          {
+            const mask_type needed = Mesh::BOUNDING_BOX_E|Mesh::FACES_E;
+            Core::Thread::UniqueLock lock(mesh_->synchronize_lock_.get());
+            while((mesh_->synchronized_ & needed) != needed)
+              mesh_->synchronize_cond_.wait(lock);
+          }
+          mesh_->compute_elem_bvh();
+        }
+
         mesh_->synchronize_lock_.lock();
         // Mark the ones that were just synchronized
         mesh_->synchronized_ |= sync_;
@@ -407,7 +421,11 @@ public:
   double get_epsilon() const { return (epsilon_); }
 
   /// Compute tables for doing topology, these need to be synchronized
-  /// before doing a lot of operations.
+  /// before doing a lot of operations. Tables that are synchronized when
+  /// add_point, add_elem, set_point or set_nodes edit the mesh are updated
+  /// in place. A mesh built from scratch, as the output of
+  /// RefineTetMeshLocally is, still pays for a full build on its first
+  /// synchronize.
   virtual bool synchronize(mask_type mask) override;
   virtual bool unsynchronize(mask_type mask) override;
   bool clear_synchronization();
@@ -647,8 +665,8 @@ public:
   /// Access the nodes of the mesh
   void get_point(Core::Geometry::Point &result, typename Node::index_type index) const
   { result = points_[index]; }
-  void set_point(const Core::Geometry::Point &point, typename Node::index_type index)
-  { points_[index] = point; }
+  /// Moves a node. Synchronized search grids are updated in place.
+  void set_point(const Core::Geometry::Point &point, typename Node::index_type index);
   void get_random_point(Core::Geometry::Point &p, typename Elem::index_type i, FieldRNG &r) const;
 
   /// Normals for visualizations
@@ -702,8 +720,8 @@ public:
   /// nodes/elements one needs, prereserving memory is often possible.
   void node_reserve(size_type s) { points_.reserve(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
   void elem_reserve(size_type s) { cells_.reserve(static_cast<std::vector<index_type>::size_type>(s*4)); }
-  void resize_nodes(size_type s) { points_.resize(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
-  void resize_elems(size_type s) { cells_.resize(static_cast<std::vector<index_type>::size_type>(s*4)); }
+  void resize_nodes(size_type s) { topologyChanged(); points_.resize(static_cast<std::vector<Core::Geometry::Point>::size_type>(s)); }
+  void resize_elems(size_type s) { topologyChanged(); cells_.resize(static_cast<std::vector<index_type>::size_type>(s*4)); }
 
   /// Get the local coordinates for a certain point within an element
   /// This function uses a couple of newton iterations to find the local
@@ -1183,6 +1201,9 @@ public:
       }
     }
 
+    if (synchronized_ & Mesh::ELEM_BVH_E)
+      return (find_closest_elem_bvh(pdist, result, coords, elem, p, maxdist));
+
     ASSERTMSG(synchronized_ & Mesh::FACES_E,
               "TetVolMesh: need to synchronize FACES_E first");
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
@@ -1447,6 +1468,7 @@ public:
 
   void create_cell_syncinfo(typename Cell::index_type ci);
   void delete_cell_syncinfo(typename Cell::index_type ci);
+  void create_node_syncinfo(typename Node::index_type ni);
   // Create the partial sync info needed by insert_node_in_elem
   void create_cell_syncinfo_special(typename Cell::index_type ci);
   void delete_cell_syncinfo_special(typename Cell::index_type ci);
@@ -1721,7 +1743,7 @@ protected:
       "HexVolMesh: Must call synchronize EDGES_E first");
 
     // Get all the nodes that share an edge with this node
-    const std::vector<typename Cell::index_type>& neighbors = node_neighbors_[idx];
+    const typename node_neighbor_table::Row neighbors = node_neighbors_[idx];
 
     array.clear();
     array.reserve(neighbors.size());
@@ -1797,7 +1819,7 @@ protected:
       "TetVolMesh: Must call synchronize FACES_E first");
 
     // Get all the nodes that share an edge with this node
-    const std::vector<typename Cell::index_type>& neighbors = node_neighbors_[idx];
+    const typename node_neighbor_table::Row neighbors = node_neighbors_[idx];
 
     array.clear();
     array.reserve(neighbors.size());
@@ -1835,8 +1857,9 @@ protected:
   {
     ASSERTMSG(synchronized_ & Mesh::EDGES_E,
               "TetVolMesh: Must call synchronize EDGES_E first");
+    array.resize(edges_[idx].cells_.size());
     for (size_t i=0; i< edges_[idx].cells_.size(); i++)
-      array[i] = static_cast<typename ARRAY::value_type>(edges_[idx].cells_[i]);
+      array[i] = static_cast<typename ARRAY::value_type>((edges_[idx].cells_[i])>>3);
   }
 
   template<class ARRAY, class INDEX>
@@ -1860,8 +1883,16 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    topologyChanged();
+    // Edits through the virtual interface keep synchronized tables up to date like set_nodes
+    const bool synced = (synchronized_ & (Mesh::NODE_NEIGHBORS_E|Mesh::EDGES_E|Mesh::FACES_E|
+                                          Mesh::ELEM_LOCATE_E|Mesh::ELEM_BVH_E)) != 0;
+    if (synced)
+      delete_cell_syncinfo(static_cast<index_type>(idx));
     for (index_type n = 0; n < 4; ++n)
       cells_[idx * 4 + n] = static_cast<index_type>(array[n]);
+    if (synced)
+      create_cell_syncinfo(static_cast<index_type>(idx));
   }
 
   template <class INDEX1, class INDEX2>
@@ -2113,6 +2144,16 @@ protected:
       if (inside(elem,p)) return (true);
     }
 
+    if (synchronized_ & Mesh::ELEM_BVH_E)
+    {
+      return (elem_bvh_->locate(p, [&](index_type ci) -> bool
+      {
+        if (!inside(typename Elem::index_type(ci), p)) return (false);
+        elem = static_cast<INDEX>(ci);
+        return (true);
+      }));
+    }
+
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
                 "TetVolMesh: need to synchronize ELEM_LOCATE_E first");
 
@@ -2186,6 +2227,18 @@ protected:
       }
     }
 
+    if (synchronized_ & Mesh::ELEM_BVH_E)
+    {
+      return (elem_bvh_->locate(p, [&](index_type ci) -> bool
+      {
+        if (!inside(typename Elem::index_type(ci), p)) return (false);
+        elem = static_cast<INDEX>(ci);
+        ElemData ed(*this, elem);
+        basis_.get_coords(coords, p, ed);
+        return (true);
+      }));
+    }
+
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
                 "TetVolMesh: need to synchronize ELEM_LOCATE_E first");
 
@@ -2261,14 +2314,80 @@ protected:
   void compute_node_neighbors();
   void compute_edges();
   void compute_faces();
+  void compute_edges_sorted();
+  void compute_faces_sorted();
   void compute_node_grid();
   void compute_elem_grid();
+  void compute_elem_bvh();
   void compute_bounding_box();
 
   void insert_elem_into_grid(typename Elem::index_type ci);
   void remove_elem_from_grid(typename Elem::index_type ci);
   void insert_node_into_grid(typename Node::index_type ci);
   void remove_node_from_grid(typename Node::index_type ci);
+  Core::Geometry::BBox elem_grid_bbox(typename Elem::index_type ci) const;
+
+  /// find_closest_elem through the bounding volume hierarchies, maxdist squared
+  template <class INDEX, class ARRAY>
+  bool find_closest_elem_bvh(double& pdist,
+                             Core::Geometry::Point &result,
+                             ARRAY &coords,
+                             INDEX &elem,
+                             const Core::Geometry::Point &p,
+                             double maxdist) const
+  {
+    // First check are we inside an element
+    if (elem_bvh_->locate(p, [&](index_type ci) -> bool
+        {
+          if (!inside(typename Elem::index_type(ci), p)) return (false);
+          elem = static_cast<INDEX>(ci);
+          return (true);
+        }))
+    {
+      pdist = 0.0;
+      result = p;
+      ElemData ed(*this, elem);
+      basis_.get_coords(coords, p, ed);
+      return (true);
+    }
+
+    // If not search the closest boundary face, faces in boundary_faces_ bit order
+    static const int face_nodes[4][3] = { {0,2,1}, {1,2,3}, {0,1,3}, {0,3,2} };
+    double dmin = maxdist;
+    bool found_one = false;
+    boundary_bvh_->closest(p, dmin, [&](index_type ci) -> bool
+    {
+      const index_type idx = ci*4;
+      const unsigned char b = boundary_faces_[ci];
+      for (int f = 0; f < 4; f++)
+      {
+        if (!(b & (1 << f))) continue;
+        Core::Geometry::Point r;
+        closest_point_on_tri(r, p,
+                             points_[cells_[idx+face_nodes[f][0]]],
+                             points_[cells_[idx+face_nodes[f][1]]],
+                             points_[cells_[idx+face_nodes[f][2]]]);
+        const double dtmp = (p - r).length2();
+        if (dtmp < dmin)
+        {
+          found_one = true;
+          result = r;
+          elem = INDEX(ci);
+          dmin = dtmp;
+          if (dmin < epsilon2_) return (true);
+        }
+      }
+      return (false);
+    });
+
+    if (!found_one) return (false);
+
+    ElemData ed(*this,elem);
+    basis_.get_coords(coords,result,ed);
+
+    pdist = sqrt(dmin);
+    return (true);
+  }
 
   const Core::Geometry::Point &point(typename Node::index_type i) { return points_[i]; }
 
@@ -2597,7 +2716,17 @@ protected:
                        typename Node::index_type n3,
                        index_type combined_index);
 
-  std::vector<std::vector<typename Cell::index_type> > node_neighbors_;
+  /// Table keys of the edge or face with the given combined index
+  inline PEdgeNode edge_nodes(index_type combined_index) const;
+  inline PFaceNode face_nodes(index_type combined_index) const;
+  /// Move the last entry of edges_ or faces_ into a slot freed by
+  /// remove_edge or remove_face, so that incremental edits do not leave holes
+  void fill_edge_hole(index_type idx);
+  void fill_face_hole(index_type idx);
+
+  /// For each node the combined (cell<<2 | corner) indices that use it.
+  typedef MeshTopology::CompressedAdjacency<typename Cell::index_type> node_neighbor_table;
+  node_neighbor_table node_neighbors_;
   std::vector<unsigned char> boundary_faces_;
 
   /// This grid is used as an acceleration structure to expedite calls
@@ -2607,6 +2736,9 @@ protected:
   ///  then search just those tets that overlap that grid cell.
   boost::shared_ptr<SearchGridT<index_type> >  node_grid_;
   boost::shared_ptr<SearchGridT<index_type> >  elem_grid_;
+  boost::shared_ptr<BoundingVolumeHierarchy>   elem_bvh_;
+  /// Cells with a face on the boundary, for find_closest_elem
+  boost::shared_ptr<BoundingVolumeHierarchy>   boundary_bvh_;
 
   // Lock and Condition Variable for hand shaking
   mutable Core::Thread::Mutex                 synchronize_lock_;
@@ -2911,7 +3043,7 @@ TetVolMesh<Basis>::remove_face(typename Node::index_type n1,
 			       typename Node::index_type n2,
 			       typename Node::index_type n3,
 			       typename Cell::index_type ci,
-			       bool /*table_only*/)
+			       bool table_only)
 {
   PFaceNode f(n1, n2, n3);
   typename face_nt::iterator iter = face_table_.find(f);
@@ -2927,9 +3059,11 @@ TetVolMesh<Basis>::remove_face(typename Node::index_type n1,
   if (cells[1] == MESH_NO_NEIGHBOR)
   {
     // this face belongs to only one cell
+    boundary_faces_[cells[0] >> 2] &= ~(1 << (cells[0] & 0x3));
     cells[0] = MESH_NO_NEIGHBOR;
     cells[1] = MESH_NO_NEIGHBOR;
     face_table_.erase(iter);
+    if (!table_only) fill_face_hole(found_idx);
   }
   else
   {
@@ -2946,9 +3080,45 @@ TetVolMesh<Basis>::remove_face(typename Node::index_type n1,
     {
       ASSERTFAIL("remove face: face does exist but is ");
     }
+    // the remaining cell is now on the boundary
+    boundary_faces_[cells[0] >> 2] |= 1 << (cells[0] & 0x3);
   }
 }
 
+template <class Basis>
+typename TetVolMesh<Basis>::PFaceNode
+TetVolMesh<Basis>::face_nodes(index_type combined_index) const
+{
+  // same local faces as create_cell_faces()
+  static const int local[4][3] = { {0,2,1}, {1,2,3}, {0,1,3}, {0,3,2} };
+  const under_type* n = &cells_[(combined_index >> 2) << 2];
+  const int* f = local[combined_index & 0x3];
+  return (PFaceNode(n[f[0]], n[f[1]], n[f[2]]));
+}
+
+template <class Basis>
+void
+TetVolMesh<Basis>::fill_face_hole(index_type idx)
+{
+  const index_type last = static_cast<index_type>(faces_.size()) - 1;
+  if (idx == last)
+  {
+    faces_.pop_back();
+    return;
+  }
+
+  // Leave the hole if the last entry is a hole itself, which the table_only
+  // removals of insert_node_in_elem can leave behind
+  const index_type c = faces_[last].cells_[0];
+  if (c == MESH_NO_NEIGHBOR) return;
+  typename face_nt::iterator iter = face_table_.find(face_nodes(c));
+  if (iter == face_table_.end() || iter->second != last) return;
+
+  faces_[idx] = faces_[last];
+  iter->second = idx;
+  faces_.pop_back();
+}
+
 template <class Basis>
 void
 TetVolMesh<Basis>::hash_face(typename Node::index_type n1,
@@ -2998,6 +3168,13 @@ template <class Basis>
 void
 TetVolMesh<Basis>::compute_faces()
 {
+  if (MeshTopology::construction() == MeshTopology::Construction::Sorted &&
+      MeshTopology::fitsPackedKeys(points_.size(), cells_.size()))
+  {
+    compute_faces_sorted();
+    return;
+  }
+
   typename Cell::iterator ci, cie;
   begin(ci); end(cie);
   typename Node::array_type arr(4);
@@ -3018,11 +3195,12 @@ TetVolMesh<Basis>::compute_faces()
   }
 
   faces_.resize(table.size());
+  face_table_.clear();
 
   typename face_ht::iterator ht_iter = table.begin();
   typename face_ht::iterator ht_iter_end = table.end();
 
-  boundary_faces_.resize(cells_.size() >> 2);
+  boundary_faces_.assign(cells_.size() >> 2, 0);
 
   index_type uidx = 0;
   while (ht_iter != ht_iter_end)
@@ -3060,6 +3238,10 @@ TetVolMesh<Basis>::add_face(typename Node::index_type n1,
   PFaceNode e(n1,n2,n3);
   typename face_nt::iterator nt_iter = face_table_.find(e);
 
+  const index_type cell = combined_index >> 2;
+  if (static_cast<size_t>(cell) >= boundary_faces_.size())
+    boundary_faces_.resize(cell + 1, 0);
+
   if (nt_iter == face_table_.end())
   {
     index_type uidx = static_cast<index_type>(faces_.size());
@@ -3067,6 +3249,7 @@ TetVolMesh<Basis>::add_face(typename Node::index_type n1,
     PFaceCell c;
     faces_.push_back(c);
     faces_[uidx].cells_[0] = combined_index;
+    boundary_faces_[cell] |= 1 << (combined_index & 0x3);
   }
   else
   {
@@ -3080,6 +3263,8 @@ TetVolMesh<Basis>::add_face(typename Node::index_type n1,
     }
 
     faces_[nt_iter->second].cells_[1] = combined_index;
+    const index_type other = faces_[nt_iter->second].cells_[0];
+    boundary_faces_[other >> 2] &= ~(1 << (other & 0x3));
   }
 }
 
@@ -3112,6 +3297,13 @@ template <class Basis>
 void
 TetVolMesh<Basis>::compute_edges()
 {
+  if (MeshTopology::construction() == MeshTopology::Construction::Sorted &&
+      MeshTopology::fitsPackedKeys(points_.size(), (cells_.size() >> 2) * 6))
+  {
+    compute_edges_sorted();
+    return;
+  }
+
   typename Cell::iterator ci, cie;
   begin(ci); end(cie);
   edge_ht table;
@@ -3131,6 +3323,7 @@ TetVolMesh<Basis>::compute_edges()
   }
 
   edges_.resize(table.size());
+  edge_table_.clear();
 
   typename edge_ht::iterator ht_iter = table.begin();
   typename edge_ht::iterator ht_iter_end = table.end();
@@ -3149,6 +3342,115 @@ TetVolMesh<Basis>::compute_edges()
   synchronize_lock_.unlock();
 }
 
+/// Same tables as compute_faces(), built by radix sorting the four faces of
+/// every cell on their sorted nodes so matching faces end up adjacent.
+template <class Basis>
+void
+TetVolMesh<Basis>::compute_faces_sorted()
+{
+  using namespace MeshTopology;
+  const size_t num_entries = cells_.size();
+  const key_type key_limit = static_cast<key_type>(points_.size());
+  std::vector<Entry<3> > entries(num_entries);
+
+  parallelFill(num_entries >> 2, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; ++c)
+    {
+      // same faces and combined indices as compute_faces()
+      const size_t off = c << 2;
+      const under_type* n = &cells_[off];
+      const PFaceNode faces[4] = { PFaceNode(n[0], n[2], n[1]), PFaceNode(n[1], n[2], n[3]),
+                                   PFaceNode(n[0], n[1], n[3]), PFaceNode(n[0], n[3], n[2]) };
+      for (size_t f = 0; f < 4; ++f)
+      {
+        Entry<3>& e = entries[off + f];
+        e.nodes[0] = static_cast<key_type>(faces[f].nodes_[0]);
+        e.nodes[1] = static_cast<key_type>(faces[f].nodes_[1]);
+        e.nodes[2] = static_cast<key_type>(faces[f].nodes_[2]);
+        e.order = static_cast<key_type>(off + f);
+      }
+    }
+  });
+
+  sortEntries(entries, key_limit);
+
+  const size_t num_faces = countGroups(entries, key_limit);
+  faces_.clear();
+  faces_.resize(num_faces);
+  face_table_.clear();
+  face_table_.reserve(num_faces);
+  boundary_faces_.assign(cells_.size() >> 2, 0);
+
+  index_type uidx = 0;
+  forEachGroup(entries, key_limit, [&](const Entry<3>* first, const Entry<3>* last)
+  {
+    index_type* cells = faces_[uidx].cells_;
+    cells[0] = first->order;
+    // As in hash_face(), a second face of the same cell and a third cell are ignored
+    for (const Entry<3>* e = first + 1; e != last && cells[1] == MESH_NO_NEIGHBOR; ++e)
+      if ((cells[0]>>2) != (e->order>>2)) cells[1] = e->order;
+
+    face_table_[PFaceNode(static_cast<under_type>(first->nodes[0]),
+      static_cast<under_type>(first->nodes[1]), static_cast<under_type>(first->nodes[2]))] = uidx;
+
+    if (cells[1] == MESH_NO_NEIGHBOR)
+      boundary_faces_[cells[0] >> 2] |= 1 << (cells[0] & 0x3);
+    ++uidx;
+  });
+
+  synchronize_lock_.lock();
+  synchronized_ |= Mesh::FACES_E;
+  synchronize_lock_.unlock();
+}
+
+/// Same tables as compute_edges(), built by radix sorting the six edges of
+/// every cell on their node pairs.
+template <class Basis>
+void
+TetVolMesh<Basis>::compute_edges_sorted()
+{
+  using namespace MeshTopology;
+  static const int edge_nodes[6][2] = { {0,1}, {1,2}, {2,0}, {3,0}, {3,1}, {3,2} };
+  const size_t num_cells = cells_.size() >> 2;
+  const key_type key_limit = static_cast<key_type>(points_.size());
+  std::vector<Entry<2> > entries(num_cells * 6);
+
+  parallelFill(num_cells, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; ++c)
+    {
+      const under_type* n = &cells_[c << 2];
+      for (size_t j = 0; j < 6; ++j)
+        setEdgeEntry(entries[6*c + j], n[edge_nodes[j][0]], n[edge_nodes[j][1]], 6*c + j, key_limit);
+    }
+  });
+
+  sortEntries(entries, key_limit);
+
+  const size_t num_edges = countGroups(entries, key_limit);
+  edges_.clear();
+  edges_.resize(num_edges);
+  edge_table_.clear();
+  edge_table_.reserve(num_edges);
+
+  index_type uidx = 0;
+  forEachGroup(entries, key_limit, [&](const Entry<2>* first, const Entry<2>* last)
+  {
+    std::vector<index_type>& cells = edges_[uidx].cells_;
+    cells.reserve(last - first);
+    for (const Entry<2>* e = first; e != last; ++e)
+      cells.push_back(((e->order / 6) << 3) + e->order % 6);
+    edge_table_[PEdgeNode(static_cast<under_type>(first->nodes[0]),
+      static_cast<under_type>(first->nodes[1]))] = uidx;
+    ++uidx;
+  });
+
+  synchronize_lock_.lock();
+  synchronized_ |= Mesh::EDGES_E;
+  synchronize_lock_.unlock();
+}
+
 template <class Basis>
 void
 TetVolMesh<Basis>::add_edge(typename Node::index_type n1,
@@ -3186,10 +3488,12 @@ TetVolMesh<Basis>::synchronize(mask_type sync)
 
   if (sync & (Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E)) sync |= Mesh::BOUNDING_BOX_E;
 
+  if (sync & Mesh::ELEM_BVH_E) sync |= Mesh::BOUNDING_BOX_E|Mesh::FACES_E;
+
   // Filter out the only tables available
   sync &= (Mesh::EDGES_E|Mesh::FACES_E|
            Mesh::NODE_NEIGHBORS_E|Mesh::BOUNDING_BOX_E|
-           Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E);
+           Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E|Mesh::ELEM_BVH_E);
 
   Core::Thread::UniqueLock lock(synchronize_lock_.get());
 
@@ -3280,6 +3584,20 @@ TetVolMesh<Basis>::synchronize(mask_type sync)
     boost::thread syncthread(syncclass);
   }
 
+  if (sync == Mesh::ELEM_BVH_E)
+  {
+    Synchronize Synchronize(this,sync);
+    synchronize_lock_.unlock();
+    Synchronize.run();
+    synchronize_lock_.lock();
+  }
+  else if (sync & Mesh::ELEM_BVH_E)
+  {
+    mask_type tosync = Mesh::ELEM_BVH_E;
+    Synchronize syncclass(this,tosync);
+    boost::thread syncthread(syncclass);
+  }
+
   // Wait until threads are done
   while ((synchronized_ & sync) != sync)
   {
@@ -3316,6 +3634,8 @@ TetVolMesh<Basis>::clear_synchronization()
 
   node_grid_.reset();
   elem_grid_.reset();
+  elem_bvh_.reset();
+  boundary_bvh_.reset();
 
   synchronize_lock_.unlock();
 
@@ -3470,7 +3790,11 @@ TetVolMesh<Basis>::remove_edge(typename Node::index_type n1,
       ASSERTFAIL("this edge does exist in the table but is not connected to this cell");
     }
     edge_table_.erase(iter);
-    if (!table_only) edges_[found_idx].cells_.clear();
+    if (!table_only)
+    {
+      edges_[found_idx].cells_.clear();
+      fill_edge_hole(found_idx);
+    }
   }
   else
   {
@@ -3494,6 +3818,39 @@ TetVolMesh<Basis>::remove_edge(typename Node::index_type n1,
   }
 }
 
+template <class Basis>
+typename TetVolMesh<Basis>::PEdgeNode
+TetVolMesh<Basis>::edge_nodes(index_type combined_index) const
+{
+  // same local edges as create_cell_edges()
+  static const int local[6][2] = { {0,1}, {1,2}, {2,0}, {3,0}, {3,1}, {3,2} };
+  const under_type* n = &cells_[(combined_index >> 3) << 2];
+  const int* e = local[combined_index & 0x7];
+  return (PEdgeNode(n[e[0]], n[e[1]]));
+}
+
+template <class Basis>
+void
+TetVolMesh<Basis>::fill_edge_hole(index_type idx)
+{
+  const index_type last = static_cast<index_type>(edges_.size()) - 1;
+  if (idx == last)
+  {
+    edges_.pop_back();
+    return;
+  }
+
+  // Leave the hole if the last entry is a hole itself, which the table_only
+  // removals of insert_node_in_elem can leave behind
+  if (edges_[last].cells_.empty()) return;
+  typename edge_nt::iterator iter = edge_table_.find(edge_nodes(edges_[last].cells_[0]));
+  if (iter == edge_table_.end() || iter->second != last) return;
+
+  edges_[idx].cells_.swap(edges_[last].cells_);
+  iter->second = idx;
+  edges_.pop_back();
+}
+
 template <class Basis>
 void
 TetVolMesh<Basis>::delete_cell_edges(typename Cell::index_type c,
@@ -3543,7 +3900,7 @@ TetVolMesh<Basis>::create_cell_node_neighbors(typename Cell::index_type c)
 {
   for (index_type i = c*4; i < c*4+4; ++i)
   {
-    node_neighbors_[cells_[i]].push_back(i);
+    node_neighbors_.push_back(cells_[i], i);
   }
 }
 
@@ -3555,16 +3912,10 @@ TetVolMesh<Basis>::delete_cell_node_neighbors(typename Cell::index_type c)
   for (index_type i = c*4; i < c*4+4; ++i)
   {
     const index_type n = cells_[i];
-    typename std::vector<typename Cell::index_type>::iterator node_cells_end =
-      node_neighbors_[n].end();
-    typename std::vector<typename Cell::index_type>::iterator cell =
-      node_neighbors_[n].begin();
-    while (cell != node_cells_end && (*cell) != i) ++cell;
+    const bool found = node_neighbors_.erase(n, i);
 
     /// ASSERT that the node_neighbors_ structure contains this cell
-    ASSERT(cell != node_cells_end);
-
-    node_neighbors_[n].erase(cell);
+    ASSERT(found);
   }
 }
 
@@ -3579,8 +3930,9 @@ TetVolMesh<Basis>::create_cell_syncinfo(typename Cell::index_type ci)
     create_cell_edges(ci);
   if (synchronized_&Mesh::FACES_E)
     create_cell_faces(ci);
-  if (synchronized_ & Mesh::LOCATE_E)
+  if ((synchronized_ & Mesh::ELEM_LOCATE_E) && elem_grid_)
     insert_elem_into_grid(ci);
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
   synchronize_lock_.unlock();
 }
 
@@ -3595,8 +3947,9 @@ TetVolMesh<Basis>::delete_cell_syncinfo(typename Cell::index_type ci)
     delete_cell_edges(ci);
   if (synchronized_&Mesh::FACES_E)
     delete_cell_faces(ci);
-  if (synchronized_ & Mesh::LOCATE_E)
+  if ((synchronized_ & Mesh::ELEM_LOCATE_E) && elem_grid_)
     remove_elem_from_grid(ci);
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
   synchronize_lock_.unlock();
 }
 
@@ -3631,8 +3984,9 @@ TetVolMesh<Basis>::create_cell_syncinfo_special(typename Cell::index_type ci)
     add_face(arr[0], arr[1], arr[3], cell_index+2);
     add_face(arr[0], arr[3], arr[2], cell_index+3);
   }
-  if (synchronized_ & Mesh::LOCATE_E)
+  if ((synchronized_ & Mesh::ELEM_LOCATE_E) && elem_grid_)
     insert_elem_into_grid(ci);
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
   synchronize_lock_.unlock();
 }
 
@@ -3647,8 +4001,9 @@ TetVolMesh<Basis>::delete_cell_syncinfo_special(typename Cell::index_type ci)
     delete_cell_edges(ci, true);
   if (synchronized_&Mesh::FACES_E)
     delete_cell_faces(ci, true);
-  if (synchronized_ & Mesh::LOCATE_E)
+  if ((synchronized_ & Mesh::ELEM_LOCATE_E) && elem_grid_)
     remove_elem_from_grid(ci);
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
   synchronize_lock_.unlock();
 }
 
@@ -3658,6 +4013,7 @@ void
 TetVolMesh<Basis>::set_nodes(typename Node::array_type &array,
                              typename Cell::index_type idx)
 {
+  topologyChanged();
   ASSERT(array.size() == 4);
 
   delete_cell_syncinfo(idx);
@@ -3672,13 +4028,9 @@ template <class Basis>
 void
 TetVolMesh<Basis>::compute_node_neighbors()
 {
-  node_neighbors_.clear();
-  node_neighbors_.resize(points_.size());
-  index_type i, num_cells = cells_.size();
-  for (i = 0; i < num_cells; i++)
-  {
-    node_neighbors_[cells_[i]].push_back(i);
-  }
+  node_neighbors_.build(points_.size(), cells_.size(),
+    [this](size_t i) { return static_cast<size_t>(cells_[i]); },
+    [](size_t i) { return static_cast<typename Cell::index_type>(i); });
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
@@ -3721,12 +4073,9 @@ TetVolMesh<Basis>::get_weights(const Core::Geometry::Point &p, typename Node::ar
 }
 
 template <class Basis>
-void
-TetVolMesh<Basis>::insert_elem_into_grid(typename Cell::index_type ci)
+Core::Geometry::BBox
+TetVolMesh<Basis>::elem_grid_bbox(typename Cell::index_type ci) const
 {
-  /// @todo:  This can crash if you insert a new cell outside of the grid.
-  // Need to recompute grid at that point.
-
   const index_type idx = ci*4;
   Core::Geometry::BBox box;
   box.extend(points_[cells_[idx]]);
@@ -3734,7 +4083,16 @@ TetVolMesh<Basis>::insert_elem_into_grid(typename Cell::index_type ci)
   box.extend(points_[cells_[idx+2]]);
   box.extend(points_[cells_[idx+3]]);
   box.extend(epsilon_);
-  elem_grid_->insert(ci, box);
+  return box;
+}
+
+template <class Basis>
+void
+TetVolMesh<Basis>::insert_elem_into_grid(typename Cell::index_type ci)
+{
+  /// @todo:  This can crash if you insert a new cell outside of the grid.
+  // Need to recompute grid at that point.
+  elem_grid_->insert(ci, elem_grid_bbox(ci));
 }
 
 
@@ -3742,14 +4100,7 @@ template <class Basis>
 void
 TetVolMesh<Basis>::remove_elem_from_grid(typename Cell::index_type ci)
 {
-  const index_type idx = ci*4;
-  Core::Geometry::BBox box;
-  box.extend(points_[cells_[idx]]);
-  box.extend(points_[cells_[idx+1]]);
-  box.extend(points_[cells_[idx+2]]);
-  box.extend(points_[cells_[idx+3]]);
-  box.extend(epsilon_);
-  elem_grid_->remove(ci, box);
+  elem_grid_->remove(ci, elem_grid_bbox(ci));
 }
 
 template <class Basis>
@@ -3789,14 +4140,8 @@ TetVolMesh<Basis>::compute_elem_grid()
 
     Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
     elem_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Elem::iterator ci, cie;
-    begin(ci); end(cie);
-    while(ci != cie)
-    {
-      insert_elem_into_grid(*ci);
-      ++ci;
-    }
+    elem_grid_->fill_boxes(esz, [this](index_type ci)
+      { return elem_grid_bbox(typename Elem::index_type(ci)); });
   }
 
   synchronize_lock_.lock();
@@ -3804,6 +4149,25 @@ TetVolMesh<Basis>::compute_elem_grid()
   synchronize_lock_.unlock();
 }
 
+template <class Basis>
+void
+TetVolMesh<Basis>::compute_elem_bvh()
+{
+  typename Elem::size_type esz;  size(esz);
+  elem_bvh_.reset(new BoundingVolumeHierarchy(esz, [this](index_type ci)
+    { return elem_grid_bbox(typename Elem::index_type(ci)); }));
+
+  std::vector<index_type> boundary;
+  for (index_type ci = 0; ci < esz; ci++)
+    if (boundary_faces_[ci]) boundary.push_back(ci);
+  boundary_bvh_.reset(new BoundingVolumeHierarchy(boundary, [this](index_type ci)
+    { return elem_grid_bbox(typename Elem::index_type(ci)); }));
+
+  synchronize_lock_.lock();
+  synchronized_ |= Mesh::ELEM_BVH_E;
+  synchronize_lock_.unlock();
+}
+
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_node_grid()
@@ -3826,14 +4190,8 @@ TetVolMesh<Basis>::compute_node_grid()
 
     Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
     node_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Node::iterator ni, nie;
-    begin(ni); end(nie);
-    while(ni != nie)
-    {
-      insert_node_into_grid(*ni);
-      ++ni;
-    }
+    node_grid_->fill_points(points_.size(), [this](index_type ni)
+      { return points_[ni]; });
   }
 
   synchronize_lock_.lock();
@@ -3886,14 +4244,7 @@ TetVolMesh<Basis>::add_find_point(const Core::Geometry::Point &p, double /*err*/
   }
   else
   {
-    points_.push_back(p);
-    if (synchronized_ & Mesh::NODE_NEIGHBORS_E)
-    {
-      synchronize_lock_.lock();
-      node_neighbors_.push_back(std::vector<typename Cell::index_type>());
-      synchronize_lock_.unlock();
-    }
-    return static_cast<typename Node::index_type>(points_.size() - 1);
+    return add_point(p);
   }
 }
 
@@ -3904,11 +4255,18 @@ TetVolMesh<Basis>::add_tet(typename Node::index_type a,
 			   typename Node::index_type c,
 			   typename Node::index_type d)
 {
+  topologyChanged();
   const index_type tet = static_cast<index_type>(cells_.size()) / 4;
   cells_.push_back(a);
   cells_.push_back(b);
   cells_.push_back(c);
   cells_.push_back(d);
+
+  // Keep tables that were synchronized before the edit up to date, so
+  // editing a synchronized mesh costs in proportion to the edit
+  if (synchronized_ & (Mesh::NODE_NEIGHBORS_E|Mesh::EDGES_E|Mesh::FACES_E|
+                       Mesh::ELEM_LOCATE_E|Mesh::ELEM_BVH_E))
+    create_cell_syncinfo(tet);
   return tet;
 }
 
@@ -3916,8 +4274,80 @@ template <class Basis>
 typename TetVolMesh<Basis>::Node::index_type
 TetVolMesh<Basis>::add_point(const Core::Geometry::Point &p)
 {
+  topologyChanged();
   points_.push_back(p);
-  return static_cast<typename Node::index_type>(points_.size() - 1);
+  const typename Node::index_type ni =
+    static_cast<typename Node::index_type>(points_.size() - 1);
+  if (synchronized_ & (Mesh::NODE_NEIGHBORS_E|Mesh::BOUNDING_BOX_E))
+    create_node_syncinfo(ni);
+  return ni;
+}
+
+template <class Basis>
+void
+TetVolMesh<Basis>::create_node_syncinfo(typename Node::index_type ni)
+{
+  synchronize_lock_.lock();
+  if (synchronized_ & Mesh::NODE_NEIGHBORS_E)
+    node_neighbors_.add_row();
+  if (synchronized_ & Mesh::BOUNDING_BOX_E)
+  {
+    if (!bbox_.inside(points_[ni]))
+    {
+      // The search grids only cover the old bounding box
+      synchronized_ &= ~(Mesh::BOUNDING_BOX_E|Mesh::LOCATE_E|Mesh::ELEM_BVH_E);
+    }
+    else if ((synchronized_ & Mesh::NODE_LOCATE_E) && node_grid_)
+    {
+      insert_node_into_grid(ni);
+    }
+  }
+  synchronize_lock_.unlock();
+}
+
+template <class Basis>
+void
+TetVolMesh<Basis>::set_point(const Core::Geometry::Point &point,
+                             typename Node::index_type ni)
+{
+  // Nothing depends on the node positions when neither the bounding box, the
+  // search grids nor the BVH were built, so skip the lock in that case
+  if (!(synchronized_ & (Mesh::LOCATE_E|Mesh::BOUNDING_BOX_E|Mesh::ELEM_BVH_E)))
+  {
+    points_[ni] = point;
+    return;
+  }
+
+  synchronize_lock_.lock();
+  // The cells whose grid bins change are found through the node neighbors,
+  // and the grids only cover the old bounding box
+  if (!(synchronized_ & Mesh::NODE_NEIGHBORS_E))
+    synchronized_ &= ~Mesh::ELEM_LOCATE_E;
+  if (!bbox_.inside(point))
+    synchronized_ &= ~(Mesh::BOUNDING_BOX_E|Mesh::LOCATE_E);
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
+
+  const bool node_grid = (synchronized_ & Mesh::NODE_LOCATE_E) && node_grid_;
+  const bool elem_grid = (synchronized_ & Mesh::ELEM_LOCATE_E) && elem_grid_;
+
+  if (node_grid) remove_node_from_grid(ni);
+  if (elem_grid)
+  {
+    typename node_neighbor_table::Row cells = node_neighbors_[ni];
+    for (size_t i = 0; i < cells.size(); i++)
+      remove_elem_from_grid(typename Elem::index_type(cells[i] >> 2));
+  }
+
+  points_[ni] = point;
+
+  if (node_grid) insert_node_into_grid(ni);
+  if (elem_grid)
+  {
+    typename node_neighbor_table::Row cells = node_neighbors_[ni];
+    for (size_t i = 0; i < cells.size(); i++)
+      insert_elem_into_grid(typename Elem::index_type(cells[i] >> 2));
+  }
+  synchronize_lock_.unlock();
 }
 
 
@@ -3926,6 +4356,7 @@ typename TetVolMesh<Basis>::Elem::index_type
 TetVolMesh<Basis>::add_tet(const Core::Geometry::Point &p0, const Core::Geometry::Point &p1,
 			   const Core::Geometry::Point &p2, const Core::Geometry::Point &p3)
 {
+  topologyChanged();
   return add_tet(add_find_point(p0), add_find_point(p1),
                  add_find_point(p2), add_find_point(p3));
 }
@@ -3989,59 +4420,57 @@ template <class Basis>
 void
 TetVolMesh<Basis>::delete_cells(std::set<index_type> &to_delete)
 {
+  topologyChanged();
+  // Compact the remaining cells in one pass
+  const index_type num_cells = static_cast<index_type>(cells_.size() >> 2);
+  std::set<index_type>::const_iterator del = to_delete.lower_bound(0);
+  index_type kept = 0;
+  for (index_type ci = 0; ci < num_cells; ++ci)
+  {
+    if (del != to_delete.end() && *del == ci) { ++del; continue; }
+    if (kept != ci)
+      std::copy(cells_.begin() + ci*4, cells_.begin() + ci*4 + 4,
+                cells_.begin() + kept*4);
+    ++kept;
+  }
+  cells_.resize(kept*4);
+
+  // The cells are renumbered, so the tables are rebuilt
   synchronize_lock_.lock();
-  std::set<index_type>::reverse_iterator iter = to_delete.rbegin();
-  while (iter != to_delete.rend())
-  {
-    // erase the correct cell
-    typename TetVolMesh<Basis>::Cell::index_type ci = *iter++;
-    index_type ind = ci * 4;
-    std::vector<index_type>::iterator cb = cells_.begin() + ind;
-    std::vector<index_type>::iterator ce = cb;
-    ce+=4;
-    cells_.erase(cb, ce);
-  }
-
-  synchronized_ &= ~Mesh::LOCATE_E;
-  synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
-  if (synchronized_ & Mesh::FACES_E)
-  {
-    synchronized_ &= ~Mesh::FACES_E;
-    compute_faces();
-  }
-  if (synchronized_ & Mesh::EDGES_E)
-  {
-    synchronized_ &= ~Mesh::EDGES_E;
-    compute_edges();
-  }
+  const mask_type rebuild = synchronized_ & (Mesh::FACES_E|Mesh::EDGES_E);
+  synchronized_ &= ~(Mesh::LOCATE_E|Mesh::NODE_NEIGHBORS_E|Mesh::ELEM_BVH_E|
+                     Mesh::FACES_E|Mesh::EDGES_E);
   synchronize_lock_.unlock();
+
+  if (rebuild & Mesh::FACES_E) compute_faces();
+  if (rebuild & Mesh::EDGES_E) compute_edges();
 }
 
 template <class Basis>
 void
 TetVolMesh<Basis>::delete_nodes(std::set<index_type> &to_delete)
 {
-  synchronize_lock_.lock();
-  std::set<index_type>::reverse_iterator iter = to_delete.rbegin();
-  while (iter != to_delete.rend())
+  topologyChanged();
+  // Compact the remaining nodes in one pass
+  const index_type num_nodes = static_cast<index_type>(points_.size());
+  std::set<index_type>::const_iterator del = to_delete.lower_bound(0);
+  index_type kept = 0;
+  for (index_type ni = 0; ni < num_nodes; ++ni)
   {
-    typename TetVolMesh::Node::index_type n = *iter++;
-    std::vector<Core::Geometry::Point>::iterator pit = points_.begin() + n;
-    points_.erase(pit);
-  }
-  synchronized_ &= ~Mesh::LOCATE_E;
-  synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
-  if (synchronized_ & Mesh::FACES_E)
-  {
-    synchronized_ &= ~Mesh::FACES_E;
-    compute_faces();
-  }
-  if (synchronized_ & Mesh::EDGES_E)
-  {
-    synchronized_ &= ~Mesh::EDGES_E;
-    compute_edges();
+    if (del != to_delete.end() && *del == ni) { ++del; continue; }
+    if (kept != ni) points_[kept] = points_[ni];
+    ++kept;
   }
+  points_.resize(kept);
+
+  synchronize_lock_.lock();
+  const mask_type rebuild = synchronized_ & (Mesh::FACES_E|Mesh::EDGES_E);
+  synchronized_ &= ~(Mesh::LOCATE_E|Mesh::NODE_NEIGHBORS_E|Mesh::ELEM_BVH_E|
+                     Mesh::BOUNDING_BOX_E|Mesh::FACES_E|Mesh::EDGES_E);
   synchronize_lock_.unlock();
+
+  if (rebuild & Mesh::FACES_E) compute_faces();
+  if (rebuild & Mesh::EDGES_E) compute_edges();
 }
 
 template <class Basis>
@@ -4201,6 +4630,7 @@ TetVolMesh<Basis>::insert_node_in_elem(typename Elem::array_type &tets,
                                        typename Elem::index_type ci,
                                        const Core::Geometry::Point &p)
 {
+  topologyChanged();
 
   const Core::Geometry::Point &p0 = points_[cells_[ci*4 + 0]];
   const Core::Geometry::Point &p1 = points_[cells_[ci*4 + 1]];
@@ -4359,6 +4789,7 @@ template <class Basis>
 void
 TetVolMesh<Basis>::orient(typename Cell::index_type ci)
 {
+  topologyChanged();
   const Core::Geometry::Point &p0 = point(cells_[ci*4+0]);
   const Core::Geometry::Point &p1 = point(cells_[ci*4+1]);
   const Core::Geometry::Point &p2 = point(cells_[ci*4+2]);
@@ -4380,6 +4811,7 @@ template <class Basis>
 void
 TetVolMesh<Basis>::io(Piostream &stream)
 {
+  topologyChanged();
   const int version = stream.begin_class(type_name(-1),
 					 TETVOLMESH_VERSION);
   Mesh::io(stream);
@@ -42,6 +42,7 @@
 #include <Core/GeometryPrimitives/CompGeom.h>
 #include <Core/Containers/StackVector.h>
 #include <Core/GeometryPrimitives/SearchGridT.h>
+#include <Core/GeometryPrimitives/BoundingVolumeHierarchy.h>
 #include <Core/Datatypes/Mesh/VirtualMeshFacade.h>
 
 #include <Core/Basis/Locate.h>
@@ -276,6 +277,17 @@ public:
           }
         }
 
+        // The hierarchy depends on the bounding box too
+        if (sync_ & Mesh::ELEM_BVH_E)
+        {
+          {
+            Core::Thread::UniqueLock lock(mesh_->synchronize_lock_.get());
+            while(!(mesh_->synchronized_ & Mesh::BOUNDING_BOX_E))
+              mesh_->synchronize_cond_.wait(lock);
+          }
+          mesh_->compute_elem_bvh();
+        }
+
         mesh_->synchronize_lock_.lock();
         // Mark the ones that were just synchronized
         mesh_->synchronized_ |= sync_;
@@ -585,6 +597,7 @@ public:
   template <class ARRAY>
   typename Elem::index_type add_elem(ARRAY a)
   {
+    topologyChanged();
     ASSERTMSG(a.size() == 3, "TriSurfMesh: Tried to add non-tri element.");
 
     faces_.push_back(static_cast<typename Node::index_type>(a[0]));
@@ -596,8 +609,8 @@ public:
 
   void node_reserve(size_type s) { points_.reserve(static_cast<size_t>(s)); }
   void elem_reserve(size_type s) { faces_.reserve(static_cast<size_t>(s*3)); }
-  void resize_nodes(size_type s) { points_.resize(static_cast<size_t>(s)); }
-  void resize_elems(size_type s) { faces_.resize(static_cast<size_t>(s*3)); }
+  void resize_nodes(size_type s) { topologyChanged(); points_.resize(static_cast<size_t>(s)); }
+  void resize_elems(size_type s) { topologyChanged(); faces_.resize(static_cast<size_t>(s*3)); }
 
   /// Get the local coordinates for a certain point within an element
   /// This function uses a couple of newton iterations to find the local
@@ -671,7 +684,7 @@ public:
     basis_.derivate(coords,ed,Jv);
     Jv.resize(3);
     Core::Geometry::Vector v = Cross(Core::Geometry::Vector(Jv[0]), Core::Geometry::Vector(Jv[1])); v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
 
     return (InverseMatrix3P(Jv,Ji));
   }
@@ -703,7 +716,7 @@ public:
     Jv.resize(3);
     Core::Geometry::Vector v = Cross(Core::Geometry::Vector(Jv[0]), Core::Geometry::Vector(Jv[1]));
     v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
     double min_jacobian = DetMatrix3P(Jv);
     size_t num_vertices = basis_.number_of_vertices();
     for (size_t j=0;j < num_vertices;j++)
@@ -712,7 +725,7 @@ public:
       Jv.resize(3);
       v = Cross(Core::Geometry::Vector(Jv[0]), Core::Geometry::Vector(Jv[1]));
       v.normalize();
-      Jv[2] = v.asPoint();
+      Jv[2] = Core::Geometry::Point(v);
       temp = DetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -733,7 +746,7 @@ public:
     Jv.resize(3);
     Core::Geometry::Vector v = Cross(Core::Geometry::Vector(Jv[0]), Core::Geometry::Vector(Jv[1]));
     v.normalize();
-    Jv[2] = v.asPoint();
+    Jv[2] = Core::Geometry::Point(v);
     double min_jacobian = DetMatrix3P(Jv);
 
     size_t num_vertices = basis_.number_of_vertices();
@@ -743,7 +756,7 @@ public:
       Jv.resize(3);
       v = Cross(Core::Geometry::Vector(Jv[0]), Core::Geometry::Vector(Jv[1]));
       v.normalize();
-      Jv[2] = v.asPoint();
+      Jv[2] = Core::Geometry::Point(v);
       temp = DetMatrix3P(Jv);
       if(temp < min_jacobian) min_jacobian = temp;
     }
@@ -1056,162 +1069,177 @@ public:
       }
     }
 
-    ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
-        "TriSurfMesh::find_closest_elem requires synchronize(ELEM_LOCATE_E).")
-
-    // get grid sizes
-    const size_type ni = elem_grid_->get_ni()-1;
-    const size_type nj = elem_grid_->get_nj()-1;
-    const size_type nk = elem_grid_->get_nk()-1;
-
-    // Convert to grid coordinates.
-    index_type bi, ei, bj, ej, bk, ek;
-    elem_grid_->unsafe_locate(bi, bj, bk, p);
-
-    // Clamp to closest point on the grid.
-    if (bi > ni) 
-      bi = ni; 
-    if (bi < 0) 
-      bi = 0;
-    if (bj > nj) 
-      bj = nj; 
-    if (bj < 0) 
-      bj = 0;
-    if (bk > nk) 
-      bk = nk; 
-    if (bk < 0)
-      bk = 0;
-
-    ei = bi; ej = bj; ek = bk;
-
     double dmin = maxdist;
     double dmean = maxdist;
-    bool found = true;
     bool found_one = false;
     double perturb= epsilon_*100; //value to move to find new point.
 
-    do
+    // Compares face f with the closest face so far. Returns true when p lies
+    // on the face, after setting pdist and coords.
+    auto check_face = [&](index_type f) -> bool
     {
-      found = true;
-      /// We need to do a full shell without any elements that are closer
-      /// to make sure there no closer elements in neighboring searchgrid cells
-      for (index_type i = bi; i <= ei; i++)
+      Core::Geometry::Point r, r_pert;
+      index_type idx = f * 3;
+      
+      closest_point_on_tri(r, p, points_[faces_[idx]], points_[faces_[idx+1]], points_[faces_[idx+2]]);
+      double dtmp = (p - r).length2();
+      
+      
+      //test triangle size for scaling
+      Core::Geometry::Vector v1= Core::Geometry::Vector(points_[faces_[idx+1]]-points_[faces_[idx  ]]); v1.normalize();
+      Core::Geometry::Vector v2= Core::Geometry::Vector(points_[faces_[idx+2]]-points_[faces_[idx  ]]); v2.normalize();
+      
+      Core::Geometry::Vector n=Cross(v1,v2); n.normalize();
+      Core::Geometry::Vector pr=Core::Geometry::Vector(r-p); pr.normalize();
+      
+      if (std::abs(Dot(pr,n))>1-perturb)
       {
-        if (i < 0 || i > ni) continue;
-        for (index_type j = bj; j <= ej; j++)
+        r_pert=r;
+      }
+      else
+      {
+          
+        Core::Geometry::Vector pp=Cross(n,pr); pp.normalize();
+        Core::Geometry::Vector vect=Cross(pp,n); vect.normalize();
+        
+        r_pert=Core::Geometry::Point(r+vect*perturb);
+      }
+      
+      double dtmp2=(p-r_pert).length2();
+
+      //check for closest face and check within precision
+      if (dtmp-dmin <= epsilon_)
+      {
+        if (dtmp-dmin < - epsilon_)
         {
-        if (j < 0 || j > nj) continue;
-          for (index_type k = bk; k <= ek; k++)
+          found_one = true;
+          result = r;
+          face = INDEX(f);
+          dmin = dtmp;
+          dmean =dtmp2;
+          
+          if (dmin < epsilon2_)
           {
-            if (k < 0 || k > nk) continue;
-            if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
+            
+            pdist = sqrt(dmin);
+            pdist = sqrt(dmean);
+                
+            ElemData ed(*this,face);
+            basis_.get_coords(coords,result,ed);
+            return (true);
+          }
+        }
+        else if (dtmp2-dmean < - epsilon_ )
+        {
+          found_one = true;
+          result = r;
+          face = INDEX(f);
+          if (dmin>=dtmp) dmin=dtmp;
+          dmean =dtmp2;
+        }
+        else if (dtmp<dmin  && std::abs(dtmp2-dmean) < epsilon_ )
+        {
+          found_one = true;
+          result = r;
+          face = INDEX(f);
+          dmin = dtmp;
+          dmean =dtmp2;
+          if (dmin < epsilon2_)
+          {
+            
+            pdist = sqrt(dmin);
+            pdist = sqrt(dmean);
+            
+            ElemData ed(*this,face);
+            basis_.get_coords(coords,result,ed);
+          }
+        }
+        else if (dtmp2 < dmean && dtmp-dmin > - epsilon_)
+        {
+          found_one = true;
+          result = r;
+          face = INDEX(f);
+          dmean =dtmp2;
+        }
+      }
+      return (false);
+    };
+
+    if (synchronized_ & Mesh::ELEM_BVH_E)
+    {
+      // Faces within epsilon_ of the closest one take part in the tie break
+      if (elem_bvh_->closest(p, dmin, check_face, epsilon_)) return (true);
+    }
+    else
+    {
+      ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
+          "TriSurfMesh::find_closest_elem requires synchronize(ELEM_LOCATE_E).")
+
+      // get grid sizes
+      const size_type ni = elem_grid_->get_ni()-1;
+      const size_type nj = elem_grid_->get_nj()-1;
+      const size_type nk = elem_grid_->get_nk()-1;
+
+      // Convert to grid coordinates.
+      index_type bi, ei, bj, ej, bk, ek;
+      elem_grid_->unsafe_locate(bi, bj, bk, p);
+
+      // Clamp to closest point on the grid.
+      if (bi > ni) 
+        bi = ni; 
+      if (bi < 0) 
+        bi = 0;
+      if (bj > nj) 
+        bj = nj; 
+      if (bj < 0) 
+        bj = 0;
+      if (bk > nk) 
+        bk = nk; 
+      if (bk < 0)
+        bk = 0;
+
+      ei = bi; ej = bj; ek = bk;
+
+      bool found = true;
+
+      do
+      {
+        found = true;
+        /// We need to do a full shell without any elements that are closer
+        /// to make sure there no closer elements in neighboring searchgrid cells
+        for (index_type i = bi; i <= ei; i++)
+        {
+          if (i < 0 || i > ni) continue;
+          for (index_type j = bj; j <= ej; j++)
+          {
+          if (j < 0 || j > nj) continue;
+            for (index_type k = bk; k <= ek; k++)
             {
-              if (elem_grid_->min_distance_squared(p, i, j, k) < dmin)
+              if (k < 0 || k > nk) continue;
+              if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
               {
-                found = false;
-                typename SearchGridT<index_type>::iterator it, eit;
-                elem_grid_->lookup_ijk(it,eit, i, j, k);
-
-                while (it != eit)
+                if (elem_grid_->min_distance_squared(p, i, j, k) < dmin)
                 {
-                  Core::Geometry::Point r, r_pert;
-                  index_type idx = (*it) * 3;
-                  
-                  closest_point_on_tri(r, p, points_[faces_[idx]], points_[faces_[idx+1]], points_[faces_[idx+2]]);
-                  double dtmp = (p - r).length2();
-                  
-                  
-                  //test triangle size for scaling
-                  Core::Geometry::Vector v1= Core::Geometry::Vector(points_[faces_[idx+1]]-points_[faces_[idx  ]]); v1.normalize();
-                  Core::Geometry::Vector v2= Core::Geometry::Vector(points_[faces_[idx+2]]-points_[faces_[idx  ]]); v2.normalize();
-                  
-                  Core::Geometry::Vector n=Cross(v1,v2); n.normalize();
-                  Core::Geometry::Vector pr=Core::Geometry::Vector(r-p); pr.normalize();
-                  
-                  if (std::abs(Dot(pr,n))>1-perturb)
-                  {
-                    r_pert=r;
-                  }
-                  else
-                  {
-                      
-                    Core::Geometry::Vector pp=Cross(n,pr); pp.normalize();
-                    Core::Geometry::Vector vect=Cross(pp,n); vect.normalize();
-                    
-                    r_pert=Core::Geometry::Point(r+vect*perturb);
-                  }
-                  
-                  double dtmp2=(p-r_pert).length2();
+                  found = false;
+                  typename SearchGridT<index_type>::iterator it, eit;
+                  elem_grid_->lookup_ijk(it,eit, i, j, k);
 
-                  //check for closest face and check within precision
-                  if (dtmp-dmin <= epsilon_)
+                  while (it != eit)
                   {
-                    if (dtmp-dmin < - epsilon_)
-                    {
-                      found_one = true;
-                      result = r;
-                      face = INDEX(*it);
-                      dmin = dtmp;
-                      dmean =dtmp2;
-                      
-                      if (dmin < epsilon2_)
-                      {
-                        
-                        pdist = sqrt(dmin);
-                        pdist = sqrt(dmean);
-                            
-                        ElemData ed(*this,face);
-                        basis_.get_coords(coords,result,ed);
-                        return (true);
-                      }
-                    }
-                    else if (dtmp2-dmean < - epsilon_ )
-                    {
-                      found_one = true;
-                      result = r;
-                      face = INDEX(*it);
-                      if (dmin>=dtmp) dmin=dtmp;
-                      dmean =dtmp2;
-                    }
-                    else if (dtmp<dmin  && std::abs(dtmp2-dmean) < epsilon_ )
-                    {
-                      found_one = true;
-                      result = r;
-                      face = INDEX(*it);
-                      dmin = dtmp;
-                      dmean =dtmp2;
-                      if (dmin < epsilon2_)
-                      {
-                        
-                        pdist = sqrt(dmin);
-                        pdist = sqrt(dmean);
-                        
-                        ElemData ed(*this,face);
-                        basis_.get_coords(coords,result,ed);
-                      }
-                    }
-                    else if (dtmp2 < dmean && dtmp-dmin > - epsilon_)
-                    {
-                      found_one = true;
-                      result = r;
-                      face = INDEX(*it);
-                      dmean =dtmp2;
-                    }
+                    if (check_face(*it)) return (true);
+                    ++it;
                   }
-                  
-
-                  ++it;
                 }
               }
             }
           }
         }
+        bi--;ei++;
+        bj--;ej++;
+        bk--;ek++;
       }
-      bi--;ei++;
-      bj--;ej++;
-      bk--;ek++;
+      while (!found) ;
     }
-    while (!found) ;
 
     ElemData ed(*this,face);
     basis_.get_coords(coords,result,ed);
@@ -1279,94 +1307,107 @@ public:
     /// If there are no nodes we cannot find the closest one
     if (sz == 0) return (false);
 
-    ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
-        "TriSurfMesh::find_closest_elems requires synchronize(ELEM_LOCATE_E).")
-
-    // get grid sizes
-    const size_type ni = elem_grid_->get_ni()-1;
-    const size_type nj = elem_grid_->get_nj()-1;
-    const size_type nk = elem_grid_->get_nk()-1;
-
-    // Convert to grid coordinates.
-    index_type bi, ei, bj, ej, bk, ek;
-    elem_grid_->unsafe_locate(bi, bj, bk, p);
-
-    // Clamp to closest point on the grid.
-    if (bi > ni) 
-      bi = ni; 
-    if (bi < 0) 
-      bi = 0;
-    if (bj > nj) 
-      bj = nj; 
-    if (bj < 0) 
-      bj = 0;
-    if (bk > nk) 
-      bk = nk; 
-    if (bk < 0)
-      bk = 0;
-
-    ei = bi; ej = bj; ek = bk;
-
     double dmin = DBL_MAX;
 
-    bool found;
-    do
+    // Collects face f if it is as close as the closest faces so far
+    auto check_face = [&](index_type f) -> bool
     {
-      found = true;
-      /// This looks incorrect - but it is correct
-      /// We need to do a full shell without any elements that are closer
-      /// to make sure there no closer elements
-      for (index_type i = bi; i <= ei; i++)
+      Core::Geometry::Point rtmp;
+      index_type idx = f * 3;
+      closest_point_on_tri(rtmp, p,
+                           points_[faces_[idx  ]],
+                           points_[faces_[idx+1]],
+                           points_[faces_[idx+2]]);
+      const double dtmp = (p - rtmp).length2();
+
+      if (dtmp < dmin - epsilon2_)
       {
-        if (i < 0|| i > ni) continue;
-        for (index_type j = bj; j <= ej; j++)
+        elems.clear();
+        result = rtmp;
+        elems.push_back(typename ARRAY::value_type(f));
+        dmin = dtmp;
+      }
+      else if (dtmp < dmin + epsilon2_)
+      {
+        elems.push_back(typename ARRAY::value_type(f));
+      }
+      return (false);
+    };
+
+    if (synchronized_ & Mesh::ELEM_BVH_E)
+    {
+      elem_bvh_->closest(p, dmin, check_face, epsilon2_);
+    }
+    else
+    {
+      ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
+          "TriSurfMesh::find_closest_elems requires synchronize(ELEM_LOCATE_E).")
+
+      // get grid sizes
+      const size_type ni = elem_grid_->get_ni()-1;
+      const size_type nj = elem_grid_->get_nj()-1;
+      const size_type nk = elem_grid_->get_nk()-1;
+
+      // Convert to grid coordinates.
+      index_type bi, ei, bj, ej, bk, ek;
+      elem_grid_->unsafe_locate(bi, bj, bk, p);
+
+      // Clamp to closest point on the grid.
+      if (bi > ni) 
+        bi = ni; 
+      if (bi < 0) 
+        bi = 0;
+      if (bj > nj) 
+        bj = nj; 
+      if (bj < 0) 
+        bj = 0;
+      if (bk > nk) 
+        bk = nk; 
+      if (bk < 0)
+        bk = 0;
+
+      ei = bi; ej = bj; ek = bk;
+
+      bool found;
+      do
+      {
+        found = true;
+        /// This looks incorrect - but it is correct
+        /// We need to do a full shell without any elements that are closer
+        /// to make sure there no closer elements
+        for (index_type i = bi; i <= ei; i++)
         {
-        if (j < 0 || j > nj) continue;
-          for (index_type k = bk; k <= ek; k++)
+          if (i < 0|| i > ni) continue;
+          for (index_type j = bj; j <= ej; j++)
           {
-            if (k < 0 || k > nk) continue;
-            if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
+          if (j < 0 || j > nj) continue;
+            for (index_type k = bk; k <= ek; k++)
             {
-              if (elem_grid_->min_distance_squared(p, i, j, k) < dmin)
+              if (k < 0 || k > nk) continue;
+              if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
               {
-                found = false;
-                typename SearchGridT<index_type>::iterator it, eit;
-                elem_grid_->lookup_ijk(it,eit, i, j, k);
-
-                while (it != eit)
+                if (elem_grid_->min_distance_squared(p, i, j, k) < dmin)
                 {
-                  Core::Geometry::Point rtmp;
-                  index_type idx = (*it) * 3;
-                  closest_point_on_tri(rtmp, p,
-                                       points_[faces_[idx  ]],
-                                       points_[faces_[idx+1]],
-                                       points_[faces_[idx+2]]);
-                  const double dtmp = (p - rtmp).length2();
-
-                  if (dtmp < dmin - epsilon2_)
-                  {
-                    elems.clear();
-                    result = rtmp;
-                    elems.push_back(typename ARRAY::value_type(*it));
-                    found = false;
-                    dmin = dtmp;
-                  }
-                  else if (dtmp < dmin + epsilon2_)
+                  found = false;
+                  typename SearchGridT<index_type>::iterator it, eit;
+                  elem_grid_->lookup_ijk(it,eit, i, j, k);
+
+                  while (it != eit)
                   {
-                    elems.push_back(typename ARRAY::value_type(*it));
+                    check_face(*it);
+                    ++it;
                   }
-                  ++it;
                 }
               }
             }
           }
         }
+        bi--;ei++;
+        bj--;ej++;
+        bk--;ek++;
       }
-      bi--;ei++;
-      bj--;ej++;
-      bk--;ek++;
+      while ((!found)||(dmin == DBL_MAX)) ;
     }
-    while ((!found)||(dmin == DBL_MAX)) ;
 
     pdist = sqrt(dmin);
     return (true);
@@ -1621,6 +1662,7 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    topologyChanged();
     for (index_type n = 0; n < 3; ++n)
       faces_[idx * 3 + n] = static_cast<index_type>(array[n]);
   }
@@ -1873,6 +1915,16 @@ protected:
       if (inside3_p(elem*3,p)) return (true);
     }
 
+    if (synchronized_ & Mesh::ELEM_BVH_E)
+    {
+      return (elem_bvh_->locate(p, [&](index_type f) -> bool
+      {
+        if (!inside3_p(f * 3, p)) return (false);
+        elem = static_cast<INDEX>(f);
+        return (true);
+      }));
+    }
+
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
               "TriSurfMesh::locate_elem requires synchronize(ELEM_LOCATE_E).")
 
@@ -1943,6 +1995,18 @@ protected:
       }
     }
 
+    if (synchronized_ & Mesh::ELEM_BVH_E)
+    {
+      return (elem_bvh_->locate(p, [&](index_type f) -> bool
+      {
+        if (!inside3_p(f * 3, p)) return (false);
+        elem = static_cast<INDEX>(f);
+        ElemData ed(*this, elem);
+        basis_.get_coords(coords, p, ed);
+        return (true);
+      }));
+    }
+
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
               "TriSurfMesh::locate_node requires synchronize(ELEM_LOCATE_E).")
 
@@ -2010,6 +2074,7 @@ protected:
 
   void compute_node_grid();
   void compute_elem_grid();
+  void compute_elem_bvh();
   void compute_bounding_box();
 
   /// Used to recompute data for individual cells.
@@ -2018,6 +2083,7 @@ protected:
 
   void insert_node_into_grid(typename Node::index_type ci);
   void remove_node_from_grid(typename Node::index_type ci);
+  Core::Geometry::BBox elem_grid_bbox(typename Elem::index_type ci) const;
 
   void debug_test_edge_neighbors();
 
@@ -2038,6 +2104,7 @@ protected:
 
   boost::shared_ptr<SearchGridT<index_type> > node_grid_; // Lookup table for nodes
   boost::shared_ptr<SearchGridT<index_type> > elem_grid_; // Lookup table for elements
+  boost::shared_ptr<BoundingVolumeHierarchy> elem_bvh_; // Alternative lookup for elements
 
   // Lock and Condition Variable for hand shaking
   mutable Core::Thread::Mutex         synchronize_lock_;
@@ -2425,14 +2492,14 @@ TriSurfMesh<Basis>::synchronize(mask_type sync)
   if (sync & Mesh::FIND_CLOSEST_ELEM_E)
   { sync |= ELEM_LOCATE_E; sync &=  ~(Mesh::FIND_CLOSEST_ELEM_E); }
 
-  if (sync & (Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E)) sync |= Mesh::BOUNDING_BOX_E;
+  if (sync & (Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E|Mesh::ELEM_BVH_E)) sync |= Mesh::BOUNDING_BOX_E;
   if (sync & Mesh::ELEM_NEIGHBORS_E) sync |= Mesh::EDGES_E;
 
   // Filter out the only tables available
   sync &= (Mesh::EDGES_E|Mesh::NORMALS_E|
            Mesh::NODE_NEIGHBORS_E|Mesh::BOUNDING_BOX_E|
            Mesh::ELEM_NEIGHBORS_E|
-           Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E);
+           Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E|Mesh::ELEM_BVH_E);
 
   Core::Thread::UniqueLock lock(synchronize_lock_.get());
 
@@ -2537,6 +2604,20 @@ TriSurfMesh<Basis>::synchronize(mask_type sync)
     boost::thread syncthread(syncclass);
   }
 
+  if (sync == Mesh::ELEM_BVH_E)
+  {
+    Synchronize Synchronize(this,sync);
+    synchronize_lock_.unlock();
+    Synchronize.run();
+    synchronize_lock_.lock();
+  }
+  else if (sync & Mesh::ELEM_BVH_E)
+  {
+    mask_type tosync = Mesh::ELEM_BVH_E;
+    Synchronize syncclass(this,tosync);
+    boost::thread syncthread(syncclass);
+  }
+
   // Wait until threads are done
   while ((synchronized_ & sync) != sync)
   {
@@ -2569,6 +2650,7 @@ TriSurfMesh<Basis>::clear_synchronization()
   edges_.clear();
   node_grid_.reset();
   elem_grid_.reset();
+  elem_bvh_.reset();
 
   synchronize_lock_.unlock();
   return (true);
@@ -2641,6 +2723,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::insert_node(typename Face::index_type face, const Core::Geometry::Point &p)
 {
+  topologyChanged();
   const bool do_neighbors = synchronized_ & Mesh::ELEM_NEIGHBORS_E;
   const bool do_normals = false; // synchronized_ & NORMALS_E;
 
@@ -2702,6 +2785,7 @@ TriSurfMesh<Basis>::insert_node(typename Face::index_type face, const Core::Geom
   if (!do_neighbors) synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
   synchronized_ &= ~(Mesh::EDGES_E);
   if (!do_normals) synchronized_ &= ~Mesh::NORMALS_E;
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
 
   synchronize_lock_.unlock();
 }
@@ -2711,6 +2795,7 @@ template <class Basis>
 bool
 TriSurfMesh<Basis>::insert_node(const Core::Geometry::Point &p)
 {
+  topologyChanged();
   typename Face::index_type face;
   if (!locate(face,p)) return false;
   insert_node(face,p);
@@ -2804,6 +2889,7 @@ TriSurfMesh<Basis>::insert_node_in_edge_aux(typename Face::array_type &tris,
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
   synchronized_ &= ~(Mesh::EDGES_E);
   synchronized_ &= ~Mesh::NORMALS_E;
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
 
   for (size_t i = 0; i < tris.size(); i++)
   {
@@ -2871,6 +2957,7 @@ TriSurfMesh<Basis>::insert_node_in_face_aux(typename Face::array_type &tris,
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
   synchronized_ &= ~(Mesh::EDGES_E);
   synchronized_ &= ~Mesh::NORMALS_E;
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
 
   for (size_t i = 0; i < tris.size(); i++)
   {
@@ -2959,6 +3046,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::collapse_edges(const std::vector<index_type> &nodemap)
 {
+  topologyChanged();
   for (size_t i = 0; i < faces_.size(); i++)
   {
     faces_[i] = nodemap[faces_[i]];
@@ -2970,6 +3058,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::remove_obvious_degenerate_triangles()
 {
+  topologyChanged();
   std::vector<index_type> oldfaces = faces_;
   faces_.clear();
   for (size_t i = 0; i< oldfaces.size(); i+=3)
@@ -3163,6 +3252,7 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
   if (!do_neighbors) synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
   synchronized_ &= ~(Mesh::EDGES_E);
   if (!do_normals) synchronized_ &= ~Mesh::NORMALS_E;
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
 
   synchronize_lock_.unlock();
 }
@@ -3310,6 +3400,7 @@ bool
 TriSurfMesh<Basis>::swap_shared_edge(typename Face::index_type f1,
                                      typename Face::index_type f2)
 {
+  topologyChanged();
   const index_type face1 = f1 * 3;
   std::set<index_type, less_int> shared;
   shared.insert(faces_[face1]);
@@ -3351,6 +3442,7 @@ TriSurfMesh<Basis>::swap_shared_edge(typename Face::index_type f1,
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
   synchronized_ &= ~Mesh::NORMALS_E;
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
   synchronize_lock_.unlock();
 
   return true;
@@ -3360,6 +3452,7 @@ template <class Basis>
 bool
 TriSurfMesh<Basis>::remove_orphan_nodes()
 {
+  topologyChanged();
   bool rval = false;
 
   /// find the orphan nodes.
@@ -3403,6 +3496,7 @@ template <class Basis>
 bool
 TriSurfMesh<Basis>::remove_face(typename Face::index_type f)
 {
+  topologyChanged();
   bool rval = true;
 
   synchronize_lock_.lock();
@@ -3417,6 +3511,7 @@ TriSurfMesh<Basis>::remove_face(typename Face::index_type f)
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
   synchronized_ &= ~Mesh::NORMALS_E;
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
   synchronize_lock_.unlock();
 
   return rval;
@@ -3429,6 +3524,7 @@ TriSurfMesh<Basis>::add_triangle(typename Node::index_type a,
                                  typename Node::index_type b,
                                  typename Node::index_type c)
 {
+  topologyChanged();
   synchronize_lock_.lock();
   faces_.push_back(a);
   faces_.push_back(b);
@@ -3436,6 +3532,7 @@ TriSurfMesh<Basis>::add_triangle(typename Node::index_type a,
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
   synchronized_ &= ~Mesh::NORMALS_E;
+  synchronized_ &= ~Mesh::ELEM_BVH_E;
   synchronize_lock_.unlock();
   return static_cast<typename Elem::index_type>((static_cast<index_type>(faces_.size()) / 3) - 1);
 }
@@ -3466,6 +3563,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::flip_face(typename Face::index_type face)
 {
+  topologyChanged();
   const index_type base = face * 3;
   index_type tmp = faces_[base + 1];
   faces_[base + 1] = faces_[base + 2];
@@ -3505,6 +3603,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::orient_faces()
 {
+  topologyChanged();
   synchronize(Mesh::EDGES_E | Mesh::ELEM_NEIGHBORS_E);
   synchronize_lock_.lock();
 
@@ -3586,18 +3685,25 @@ TriSurfMesh<Basis>::compute_edge_neighbors()
 
 
 template <class Basis>
-void
-TriSurfMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+Core::Geometry::BBox
+TriSurfMesh<Basis>::elem_grid_bbox(typename Elem::index_type ci) const
 {
-  /// @todo:  This can crash if you insert a new cell outside of the grid.
-  // Need to recompute grid at that point.
   const index_type idx = ci*3;
   Core::Geometry::BBox box;
   box.extend(points_[faces_[idx]]);
   box.extend(points_[faces_[idx+1]]);
   box.extend(points_[faces_[idx+2]]);
   box.extend(epsilon_);
-  elem_grid_->insert(ci, box);
+  return box;
+}
+
+template <class Basis>
+void
+TriSurfMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+{
+  /// @todo:  This can crash if you insert a new cell outside of the grid.
+  // Need to recompute grid at that point.
+  elem_grid_->insert(ci, elem_grid_bbox(ci));
 }
 
 
@@ -3605,13 +3711,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::remove_elem_from_grid(typename Elem::index_type ci)
 {
-  const index_type idx = ci*3;
-  Core::Geometry::BBox box;
-  box.extend(points_[faces_[idx]]);
-  box.extend(points_[faces_[idx+1]]);
-  box.extend(points_[faces_[idx+2]]);
-  box.extend(epsilon_);
-  elem_grid_->remove(ci, box);
+  elem_grid_->remove(ci, elem_grid_bbox(ci));
 }
 
 
@@ -3654,14 +3754,8 @@ TriSurfMesh<Basis>::compute_elem_grid()
 
     Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
     elem_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Elem::iterator ci, cie;
-    begin(ci); end(cie);
-    while(ci != cie)
-    {
-      insert_elem_into_grid(*ci);
-      ++ci;
-    }
+    elem_grid_->fill_boxes(esz, [this](index_type ci)
+      { return elem_grid_bbox(typename Elem::index_type(ci)); });
   }
 
   synchronize_lock_.lock();
@@ -3669,6 +3763,19 @@ TriSurfMesh<Basis>::compute_elem_grid()
   synchronize_lock_.unlock();
 }
 
+template <class Basis>
+void
+TriSurfMesh<Basis>::compute_elem_bvh()
+{
+  typename Elem::size_type esz;  size(esz);
+  elem_bvh_.reset(new BoundingVolumeHierarchy(esz, [this](index_type ci)
+    { return elem_grid_bbox(typename Elem::index_type(ci)); }));
+
+  synchronize_lock_.lock();
+  synchronized_ |= Mesh::ELEM_BVH_E;
+  synchronize_lock_.unlock();
+}
+
 
 template <class Basis>
 void
@@ -3691,15 +3798,8 @@ TriSurfMesh<Basis>::compute_node_grid()
 
     Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
     node_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Node::iterator ni, nie;
-    begin(ni); end(nie);
-
-    while(ni != nie)
-    {
-      insert_node_into_grid(*ni);
-      ++ni;
-    }
+    node_grid_->fill_points(points_.size(), [this](index_type ni)
+      { return points_[ni]; });
   }
 
   synchronize_lock_.lock();
@@ -3738,6 +3838,7 @@ template <class Basis>
 typename TriSurfMesh<Basis>::Node::index_type
 TriSurfMesh<Basis>::add_point(const Core::Geometry::Point &p)
 {
+  topologyChanged();
   points_.push_back(p);
   return static_cast<typename Node::index_type>(points_.size() - 1);
 }
@@ -3750,6 +3851,7 @@ TriSurfMesh<Basis>::add_triangle(const Core::Geometry::Point &p0,
                                  const Core::Geometry::Point &p1,
                                  const Core::Geometry::Point &p2)
 {
+  topologyChanged();
   return add_triangle(add_find_point(p0), add_find_point(p1), add_find_point(p2));
 }
 
@@ -3759,6 +3861,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::io(Piostream &stream)
 {
+  topologyChanged();
   int version = stream.begin_class(type_name(-1), TRISURFMESH_VERSION);
 
   Mesh::io(stream);
@@ -33,6 +33,7 @@
 
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/VFData.h>
+#include <Core/Datatypes/Legacy/Field/FieldSpan.h>
 #include <Core/Datatypes/Legacy/Base/PropertyManager.h>
 
 
@@ -605,6 +606,29 @@ public:
   inline void* fdata_pointer()   { return (vfdata_->fdata_pointer()); }
   inline void* efdata_pointer()   { return (vfdata_->efdata_pointer()); }
 
+  /// Type checked versions of the above: the values viewed as their storage
+  /// type T, or an empty span if the values are not stored as T.
+  /// Use dispatch_values() below to pick T from the field.
+  template<class T> inline FieldSpan<T> data_span()
+  {
+    if (!is_type(static_cast<T*>(0))) return (FieldSpan<T>());
+    return (FieldSpan<T>(static_cast<T*>(vfdata_->fdata_pointer()),vfdata_->fdata_size()));
+  }
+
+  template<class T> inline FieldSpan<T> edata_span()
+  {
+    if (!is_type(static_cast<T*>(0))) return (FieldSpan<T>());
+    return (FieldSpan<T>(static_cast<T*>(vfdata_->efdata_pointer()),vfdata_->efdata_size()));
+  }
+
+  /// The node positions of irregular meshes, empty for regular meshes whose
+  /// nodes are computed from a transform.
+  inline FieldSpan<Core::Geometry::Point> mesh_nodes_span()
+  {
+    if (vmesh_->is_regularmesh()) return (FieldSpan<Core::Geometry::Point>());
+    return (FieldSpan<Core::Geometry::Point>(vmesh_->get_points_pointer(),vmesh_->num_nodes()));
+  }
+
   inline bool is_nodata()        { return (basis_order_ == -1); }
   inline bool is_constantdata()  { return (basis_order_ == 0); }
   inline bool is_lineardata()    { return (basis_order_ == 1); }
@@ -723,6 +747,46 @@ protected:
 
 };
 
+/// Run a templated kernel once on the concrete value type of a field:
+/// kernel(field->data_span<T>()) is called with T the storage type, so the
+/// kernel loops over plain typed memory instead of calling the virtual
+/// get_value()/set_value() for every value. The kernel is a functor with a
+/// template operator()(FieldSpan<T>). Returns false, without calling the
+/// kernel, for value types that are not covered (complex data).
+
+template<class T, class KERNEL>
+inline bool dispatch_values_as(VField* field, KERNEL& kernel)
+{
+  if (!field->is_type(static_cast<T*>(0))) return (false);
+  kernel(field->data_span<T>());
+  return (true);
+}
+
+/// Scalar value types only
+template<class KERNEL>
+inline bool dispatch_scalar_values(VField* field, KERNEL& kernel)
+{
+  return (dispatch_values_as<double>(field,kernel) ||
+          dispatch_values_as<float>(field,kernel) ||
+          dispatch_values_as<int>(field,kernel) ||
+          dispatch_values_as<unsigned int>(field,kernel) ||
+          dispatch_values_as<char>(field,kernel) ||
+          dispatch_values_as<unsigned char>(field,kernel) ||
+          dispatch_values_as<short>(field,kernel) ||
+          dispatch_values_as<unsigned short>(field,kernel) ||
+          dispatch_values_as<long long>(field,kernel) ||
+          dispatch_values_as<unsigned long long>(field,kernel));
+}
+
+/// Scalar, Vector and Tensor value types
+template<class KERNEL>
+inline bool dispatch_values(VField* field, KERNEL& kernel)
+{
+  return (dispatch_scalar_values(field,kernel) ||
+          dispatch_values_as<Core::Geometry::Vector>(field,kernel) ||
+          dispatch_values_as<Core::Geometry::Tensor>(field,kernel));
+}
+
 
 }
 
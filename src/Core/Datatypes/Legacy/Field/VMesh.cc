@@ -31,9 +31,14 @@
 
 #include <Core/GeometryPrimitives/Transform.h>
 #include <Core/GeometryPrimitives/BBox.h>
+#include <Core/GeometryPrimitives/SpaceFillingCurve.h>
+#include <Core/Thread/Parallel.h>
+
+#include <algorithm>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
 
 void 
 VMesh::size(Node::size_type& size) const
@@ -592,6 +597,96 @@ VMesh::find_closest_elems(double&, Point&, VMesh::Elem::array_type&,
   ASSERTFAIL("VMesh interface: find_closest_elems(dist,Point,Elem::array_type,Point) has not been implemented");
 }
 
+void
+VMesh::run_batch(const std::vector<Point>& points, const batch_type& batch) const
+{
+  if (points.empty()) return;
+
+  std::vector<index_type> order;
+  morton_order(order,points);
+  const index_type* first = &(order[0]);
+
+  // Below a few thousand points the threads cost more than they save
+  const size_t min_grain = 2048;
+  const size_t grain = std::max(min_grain, order.size()/(8*Parallel::NumCores()));
+  if (order.size() < 2*grain)
+  {
+    batch(first,first+order.size());
+    return;
+  }
+
+  Parallel::For(0,order.size(),
+    [first,&batch](size_t begin, size_t end) { batch(first+begin,first+end); },
+    grain);
+}
+
+void
+VMesh::locate_many(std::vector<Elem::index_type>& elems,
+                   std::vector<coords_type>& coords,
+                   const std::vector<Point>& points) const
+{
+  elems.resize(points.size());
+  coords.resize(points.size());
+
+  run_batch(points,[&](const index_type* it, const index_type* end)
+  {
+    Elem::index_type elem(-1);
+    for (; it != end; ++it)
+    {
+      if (locate(elem,coords[*it],points[*it])) elems[*it] = elem;
+      else elems[*it] = -1;
+    }
+  });
+}
+
+void
+VMesh::find_closest_elem_many(std::vector<double>& dist,
+                              std::vector<Point>& result,
+                              std::vector<coords_type>& coords,
+                              std::vector<Elem::index_type>& elems,
+                              const std::vector<Point>& points,
+                              double maxdist) const
+{
+  dist.resize(points.size());
+  result.resize(points.size());
+  coords.resize(points.size());
+  elems.resize(points.size());
+
+  run_batch(points,[&](const index_type* it, const index_type* end)
+  {
+    Elem::index_type elem(-1);
+    for (; it != end; ++it)
+    {
+      if (find_closest_elem(dist[*it],result[*it],coords[*it],elem,points[*it],maxdist))
+        elems[*it] = elem;
+      else elems[*it] = -1;
+    }
+  });
+}
+
+void
+VMesh::find_closest_node_many(std::vector<double>& dist,
+                              std::vector<Point>& result,
+                              std::vector<Node::index_type>& nodes,
+                              const std::vector<Point>& points,
+                              double maxdist) const
+{
+  dist.resize(points.size());
+  result.resize(points.size());
+  nodes.resize(points.size());
+
+  run_batch(points,[&](const index_type* it, const index_type* end)
+  {
+    Node::index_type node(-1);
+    for (; it != end; ++it)
+    {
+      if (find_closest_node(dist[*it],result[*it],node,points[*it],maxdist))
+        nodes[*it] = node;
+      else nodes[*it] = -1;
+    }
+  });
+}
+
   
 bool 
 VMesh::get_coords(coords_type&, const Point&, Elem::index_type) const
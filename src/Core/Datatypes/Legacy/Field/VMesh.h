@@ -41,6 +41,8 @@
 
 #include <Core/Utils/Legacy/Debug.h>
 
+#include <boost/function.hpp>
+
 #include <Core/Datatypes/Legacy/Field/share.h>
 
 namespace SCIRun {
@@ -703,6 +705,32 @@ public:
                                   VMesh::Elem::array_type &i,
                                   const Core::Geometry::Point &point) const;
 
+  /// Batched versions of locate and find_closest_elem/node for large sets of
+  /// query points. The points are visited in Morton order, so consecutive
+  /// queries touch the same part of the mesh and each one starts from the
+  /// answer of the previous one as estimate, and the work is split over the
+  /// available cores. The outputs are resized to points.size() and ordered as
+  /// the points; a point that is not found gets index -1 and its other
+  /// outputs are undefined. A negative maxdist does not limit the search.
+  /// Unstructured meshes override these with direct calls into the mesh, so
+  /// there is no virtual function call per point.
+  virtual void locate_many(std::vector<Elem::index_type> &elems,
+                           std::vector<coords_type> &coords,
+                           const std::vector<Core::Geometry::Point> &points) const;
+
+  virtual void find_closest_elem_many(std::vector<double> &dist,
+                                      std::vector<Core::Geometry::Point> &result,
+                                      std::vector<coords_type> &coords,
+                                      std::vector<Elem::index_type> &elems,
+                                      const std::vector<Core::Geometry::Point> &points,
+                                      double maxdist) const;
+
+  virtual void find_closest_node_many(std::vector<double> &dist,
+                                      std::vector<Core::Geometry::Point> &result,
+                                      std::vector<Node::index_type> &nodes,
+                                      const std::vector<Core::Geometry::Point> &points,
+                                      double maxdist) const;
+
   /// Find the coordinates of a point in a certain element
   virtual bool get_coords(coords_type& coords,
                                 const Core::Geometry::Point &point, Elem::index_type i) const;
@@ -1225,6 +1253,13 @@ public:
 #endif
 
 protected:
+  /// Driver of the batched queries: calls batch(first,last) on consecutive
+  /// ranges of the indices of points in Morton order, in parallel when there
+  /// are enough points to share out.
+  typedef boost::function<void (const index_type*, const index_type*)> batch_type;
+  void run_batch(const std::vector<Core::Geometry::Point> &points,
+                 const batch_type& batch) const;
+
   /// Properties of meshes that do not change during the lifetime of the mesh
   /// and hence they can be stored for fast use.
   int basis_order_;
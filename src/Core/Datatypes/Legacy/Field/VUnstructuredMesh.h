@@ -236,6 +236,23 @@ public:
                                   VMesh::Elem::array_type &i, 
                                   const Core::Geometry::Point &point) const;
 
+  virtual void locate_many(std::vector<VMesh::Elem::index_type> &elems,
+                           std::vector<VMesh::coords_type> &coords,
+                           const std::vector<Core::Geometry::Point> &points) const;
+
+  virtual void find_closest_elem_many(std::vector<double> &dist,
+                                      std::vector<Core::Geometry::Point> &result,
+                                      std::vector<VMesh::coords_type> &coords,
+                                      std::vector<VMesh::Elem::index_type> &elems,
+                                      const std::vector<Core::Geometry::Point> &points,
+                                      double maxdist) const;
+
+  virtual void find_closest_node_many(std::vector<double> &dist,
+                                      std::vector<Core::Geometry::Point> &result,
+                                      std::vector<VMesh::Node::index_type> &nodes,
+                                      const std::vector<Core::Geometry::Point> &points,
+                                      double maxdist) const;
+
 };
 
 
@@ -701,7 +718,7 @@ void
 VUnstructuredMesh<MESH>::
 set_point(const Core::Geometry::Point &point, VMesh::Node::index_type i)
 {
-  this->mesh_->points_[i] = point;
+  this->mesh_->set_point(point, typename MESH::Node::index_type(i));
 }
 
 template <class MESH>
@@ -876,104 +893,23 @@ get_minterpolate_weights(const std::vector<Core::Geometry::Point>& point,
                          VMesh::MultiElemInterpolate& ei,
                          int basis_order) const
 {
+  std::vector<VMesh::Elem::index_type> elems;
+  std::vector<VMesh::coords_type> coords;
+  VUnstructuredMesh<MESH>::locate_many(elems,coords,point);
+
   ei.resize(point.size());
-  typename MESH::Elem::index_type elem;
-  
-  switch (basis_order)
+  for (size_t i=0; i<ei.size();i++)
   {
-    case 0:
-      {
-        for (size_t i=0; i<ei.size();i++)
-        {
-          if (i == 0) elem = ei[0].elem_index;
-          if(this->mesh_->locate(elem,point[i]))
-          {
-            ei[i].basis_order = basis_order;
-            ei[i].elem_index = elem;
-          }
-          else
-          {
-            ei[i].basis_order = basis_order;
-            ei[i].elem_index  = -1;  
-          }      
-        }
-      }
-      return;
-    case 1:
-      {
-        StackVector<double,3> coords;        
-        for (size_t i=0; i<ei.size();i++)
-        {
-          if (i == 0) elem = ei[0].elem_index;
-          if(this->mesh_->locate(elem,point[i]))
-          {
-            this->mesh_->get_coords(coords,point[i],elem);
-            ei[i].basis_order = basis_order;
-            ei[i].elem_index = elem;
-            ei[i].weights.resize(this->basis_->num_linear_weights());
-            this->basis_->get_linear_weights(coords,&(ei[i].weights[0]));
-            this->mesh_->get_nodes_from_elem(ei[i].node_index,elem);
-          }
-          else
-          {
-            ei[i].basis_order = basis_order;
-            ei[i].elem_index  = -1;  
-          }      
-        }
-      }
-      return;
-    case 2:
-      {
-        StackVector<double,3> coords;
-        
-        for (size_t i=0; i<ei.size();i++)
-        {
-          if (i == 0) elem = ei[0].elem_index;
-          if(this->mesh_->locate(elem,point[i]))
-          {
-            this->mesh_->get_coords(coords,point[i],elem);
-            ei[i].basis_order = basis_order;
-            ei[i].elem_index = elem;
-            ei[i].weights.resize(this->basis_->num_quadratic_weights());
-            this->basis_->get_quadratic_weights(coords,&(ei[i].weights[0]));
-            this->mesh_->get_nodes_from_elem(ei[i].node_index,elem);
-            this->mesh_->get_edges_from_elem(ei[i].edge_index,elem);
-          }
-          else
-          {
-            ei[i].basis_order = basis_order;
-            ei[i].elem_index  = -1;  
-          }      
-        }
-      }
-      return;    
-    case 3:   
-      {
-        StackVector<double,3> coords;
-        
-        for (size_t i=0; i<ei.size();i++)
-        {
-          if (i == 0) elem = ei[0].elem_index;
-          if(this->mesh_->locate(elem,point[i]))
-          {
-            this->mesh_->get_coords(coords,point[i],elem);
-            ei[i].basis_order = basis_order;
-            ei[i].elem_index = elem;
-            ei[i].weights.resize(this->basis_->num_cubic_weights());
-            this->basis_->get_cubic_weights(coords,&(ei[i].weights[0]));
-            this->mesh_->get_nodes_from_elem(ei[i].node_index,elem);
-            ei[i].num_hderivs = this->basis_->num_hderivs();
-          }
-          else
-          {
-            ei[i].basis_order = basis_order;
-            ei[i].elem_index  = -1;  
-          }      
-        }
-      }
-      return;
+    if (elems[i] >= 0)
+    {
+      VUnstructuredMesh<MESH>::get_interpolate_weights(coords[i],elems[i],ei[i],basis_order);
+    }
+    else
+    {
+      ei[i].basis_order = basis_order;
+      ei[i].elem_index  = -1;
+    }
   }
-  ASSERTFAIL("Interpolation of unknown order requested");
 }
 
 template <class MESH>
@@ -1396,6 +1332,80 @@ find_closest_elems(double& pdist, Core::Geometry::Point& result,
   return(this->mesh_->find_closest_elems(pdist,result,i,point));
 } 
 
+template <class MESH>
+void
+VUnstructuredMesh<MESH>::
+locate_many(std::vector<VMesh::Elem::index_type>& elems,
+            std::vector<VMesh::coords_type>& coords,
+            const std::vector<Core::Geometry::Point>& points) const
+{
+  elems.resize(points.size());
+  coords.resize(points.size());
+
+  this->run_batch(points,[&](const VMesh::index_type* it, const VMesh::index_type* end)
+  {
+    VMesh::Elem::index_type elem(-1);
+    for (; it != end; ++it)
+    {
+      if (this->mesh_->locate_elem(elem,coords[*it],points[*it])) elems[*it] = elem;
+      else elems[*it] = -1;
+    }
+  });
+}
+
+template <class MESH>
+void
+VUnstructuredMesh<MESH>::
+find_closest_elem_many(std::vector<double>& dist,
+                       std::vector<Core::Geometry::Point>& result,
+                       std::vector<VMesh::coords_type>& coords,
+                       std::vector<VMesh::Elem::index_type>& elems,
+                       const std::vector<Core::Geometry::Point>& points,
+                       double maxdist) const
+{
+  dist.resize(points.size());
+  result.resize(points.size());
+  coords.resize(points.size());
+  elems.resize(points.size());
+
+  this->run_batch(points,[&](const VMesh::index_type* it, const VMesh::index_type* end)
+  {
+    VMesh::Elem::index_type elem(-1);
+    for (; it != end; ++it)
+    {
+      if (this->mesh_->find_closest_elem(dist[*it],result[*it],coords[*it],
+                                         elem,points[*it],maxdist))
+        elems[*it] = elem;
+      else elems[*it] = -1;
+    }
+  });
+}
+
+template <class MESH>
+void
+VUnstructuredMesh<MESH>::
+find_closest_node_many(std::vector<double>& dist,
+                       std::vector<Core::Geometry::Point>& result,
+                       std::vector<VMesh::Node::index_type>& nodes,
+                       const std::vector<Core::Geometry::Point>& points,
+                       double maxdist) const
+{
+  dist.resize(points.size());
+  result.resize(points.size());
+  nodes.resize(points.size());
+
+  this->run_batch(points,[&](const VMesh::index_type* it, const VMesh::index_type* end)
+  {
+    VMesh::Node::index_type node(-1);
+    for (; it != end; ++it)
+    {
+      if (this->mesh_->find_closest_node(dist[*it],result[*it],node,points[*it],maxdist))
+        nodes[*it] = node;
+      else nodes[*it] = -1;
+    }
+  });
+}
+
 
 }
 
@@ -31,6 +31,7 @@
 #define CORE_DATATYPES_MATRIX_H
 
 #include <Core/Datatypes/Datatype.h>
+#include <Core/Datatypes/ContentHash.h>
 #include <Core/Datatypes/MatrixFwd.h>
 #include <Core/Datatypes/PropertyManagerExtensions.h>
 #include <iosfwd>
@@ -138,6 +138,20 @@ namespace Datatypes {
 
     virtual size_t nrows() const override { return this->rows(); }
     virtual size_t ncols() const override { return this->cols(); }
+    virtual size_t sizeInBytes() const override
+    {
+      return this->nonZeros() * (sizeof(T) + sizeof(index_type)) + (this->outerSize() + 1) * sizeof(index_type);
+    }
+    virtual uint64_t contentHash() const override
+    {
+      if (!this->isCompressed())
+        return 0;
+      const size_t nnz = this->nonZeros();
+      return ContentHasher().add(this->rows()).add(this->cols()).add(nnz)
+        .addBytes(this->outerIndexPtr(), (this->outerSize() + 1) * sizeof(index_type))
+        .addBytes(this->innerIndexPtr(), nnz * sizeof(index_type))
+        .addBytes(this->valuePtr(), nnz * sizeof(T)).value();
+    }
 
     typedef index_type RowsData;
     typedef index_type ColumnsData;
@@ -31,6 +31,7 @@
 #define CORE_DATATYPES_STRING_H 
 
 #include <Core/Datatypes/Datatype.h>
+#include <Core/Datatypes/ContentHash.h>
 #include <Core/Datatypes/share.h>
 
 namespace SCIRun {
@@ -44,6 +45,7 @@ namespace Datatypes {
 
     const std::string& value() const { return value_; }
     virtual String* clone() const override { return new String(*this); }
+    virtual uint64_t contentHash() const override { return ContentHasher().add(value_).value(); }
 
     //! Persistent representation
     virtual void io(Piostream&) override;
@@ -0,0 +1,88 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/String.h>
+#include <Core/Datatypes/Scalar.h>
+
+using namespace SCIRun::Core::Datatypes;
+
+TEST(ContentHashTests, EqualDenseMatricesHashEqual)
+{
+  DenseMatrix m1(DenseMatrix::Identity(3, 3));
+  DenseMatrix m2(DenseMatrix::Identity(3, 3));
+  EXPECT_NE(0u, m1.contentHash());
+  EXPECT_EQ(m1.contentHash(), m2.contentHash());
+  EXPECT_NE(m1.id(), m2.id());
+
+  m2(1, 2) = 1e-12;
+  EXPECT_NE(m1.contentHash(), m2.contentHash());
+}
+
+TEST(ContentHashTests, ShapeIsPartOfTheHash)
+{
+  DenseMatrix row(DenseMatrix::Zero(1, 4));
+  DenseMatrix column(DenseMatrix::Zero(4, 1));
+  EXPECT_NE(row.contentHash(), column.contentHash());
+}
+
+TEST(ContentHashTests, CloneHashesEqual)
+{
+  DenseColumnMatrix v(DenseColumnMatrix::LinSpaced(5, 0, 1));
+  std::unique_ptr<DenseColumnMatrix> copy(v.clone());
+  EXPECT_EQ(v.contentHash(), copy->contentHash());
+}
+
+TEST(ContentHashTests, SparseMatrixHashUsesStructureAndValues)
+{
+  SparseRowMatrix a(3, 3), b(3, 3);
+  a.insert(0, 1) = 2.0;
+  b.insert(1, 0) = 2.0;
+  a.makeCompressed();
+  b.makeCompressed();
+  EXPECT_NE(0u, a.contentHash());
+  EXPECT_NE(a.contentHash(), b.contentHash());
+
+  SparseRowMatrix c(a);
+  EXPECT_EQ(a.contentHash(), c.contentHash());
+}
+
+TEST(ContentHashTests, StringsHashByValue)
+{
+  EXPECT_EQ(String("abc").contentHash(), String("abc").contentHash());
+  EXPECT_NE(String("abc").contentHash(), String("abd").contentHash());
+}
+
+TEST(ContentHashTests, TypesWithoutHashReturnZero)
+{
+  EXPECT_EQ(0u, Double(1.0).contentHash());
+}
@@ -0,0 +1,105 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Datatypes/CopyOnWrite.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/SparseRowMatrixFromMap.h>
+
+using namespace SCIRun::Core::Datatypes;
+
+TEST(CopyOnWriteTests, ReadersShareStorage)
+{
+  CopyOnWriteStatistics::reset();
+  DenseMatrixHandle source(new DenseMatrix(DenseMatrix::Identity(3, 3)));
+
+  CopyOnWrite<DenseMatrix> reader1(source), reader2(source);
+
+  EXPECT_EQ(source.get(), reader1.get());
+  EXPECT_EQ(source.get(), reader2.get());
+  EXPECT_EQ(1.0, (*reader1)(1, 1));
+  EXPECT_FALSE(reader1.isPrivate());
+  EXPECT_EQ(source, reader2.handle());
+  EXPECT_EQ(0, CopyOnWriteStatistics::bytesCopied());
+}
+
+TEST(CopyOnWriteTests, FirstWriteMakesPrivateCopy)
+{
+  CopyOnWriteStatistics::reset();
+  DenseMatrixHandle source(new DenseMatrix(DenseMatrix::Identity(3, 3)));
+
+  CopyOnWrite<DenseMatrix> writer(source), reader(source);
+  writer.write()(1, 1) = 5;
+  writer.write()(2, 2) = 7;
+
+  EXPECT_NE(source.get(), writer.get());
+  EXPECT_TRUE(writer.isPrivate());
+  EXPECT_EQ(5.0, (*writer)(1, 1));
+  EXPECT_EQ(7.0, (*writer)(2, 2));
+  EXPECT_EQ(1.0, (*source)(1, 1));
+  EXPECT_EQ(source.get(), reader.get());
+  EXPECT_EQ(9 * sizeof(double), CopyOnWriteStatistics::bytesCopied());
+}
+
+TEST(CopyOnWriteTests, SoleOwnerWritesInPlace)
+{
+  CopyOnWriteStatistics::reset();
+  DenseMatrix* raw = new DenseMatrix(DenseMatrix::Zero(2, 2));
+  CopyOnWrite<DenseMatrix> only((DenseMatrixHandle(raw)));
+
+  only.write()(0, 0) = 1;
+
+  EXPECT_EQ(raw, only.get());
+  EXPECT_EQ(0, CopyOnWriteStatistics::bytesCopied());
+}
+
+TEST(CopyOnWriteTests, SparseWriteLeavesSharedMatrixUnchanged)
+{
+  SparseRowMatrixFromMap::Values data;
+  data[0][0] = 1;
+  data[1][1] = 2;
+  SparseRowMatrixHandle source(SparseRowMatrixFromMap::make(2, 2, data));
+
+  CopyOnWrite<SparseRowMatrix> writer(source);
+  writer.write().coeffRef(1, 1) = 3;
+
+  EXPECT_EQ(3.0, writer->coeff(1, 1));
+  EXPECT_EQ(2.0, source->coeff(1, 1));
+}
+
+TEST(CopyOnWriteTests, SavedBytesCountSharedMinusCopied)
+{
+  CopyOnWriteStatistics::reset();
+  CopyOnWriteStatistics::recordShared(1000);
+  CopyOnWriteStatistics::recordShared(1000);
+  CopyOnWriteStatistics::recordCopied(400);
+
+  EXPECT_EQ(2000, CopyOnWriteStatistics::bytesShared());
+  EXPECT_EQ(1600, CopyOnWriteStatistics::bytesSaved());
+}
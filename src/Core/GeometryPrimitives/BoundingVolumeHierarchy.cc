@@ -0,0 +1,281 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/GeometryPrimitives/BoundingVolumeHierarchy.h>
+
+#include <algorithm>
+#include <cfloat>
+
+using namespace SCIRun;
+
+namespace
+{
+  typedef SCIRun::index_type index_type;
+
+  /// Leaves hold at most this many values
+  const index_type max_leaf = 4;
+  /// Buckets of the binned surface area heuristic
+  const int num_bins = 16;
+  /// Below this depth ranges are split at the object median, which bounds
+  /// the depth of the tree, and therefore the traversal stack, whatever the
+  /// boxes look like
+  const int median_depth = 48;
+
+  struct Box
+  {
+    double lo[3], hi[3];
+
+    Box()
+    {
+      for (int a = 0; a < 3; a++) { lo[a] = DBL_MAX; hi[a] = -DBL_MAX; }
+    }
+
+    void extend(const double* box)
+    {
+      for (int a = 0; a < 3; a++)
+      {
+        lo[a] = std::min(lo[a], box[a]);
+        hi[a] = std::max(hi[a], box[a+3]);
+      }
+    }
+
+    void extend(const Box& box)
+    {
+      for (int a = 0; a < 3; a++)
+      {
+        lo[a] = std::min(lo[a], box.lo[a]);
+        hi[a] = std::max(hi[a], box.hi[a]);
+      }
+    }
+
+    double half_area() const
+    {
+      if (lo[0] > hi[0]) return (0.0);
+      const double dx = hi[0] - lo[0], dy = hi[1] - lo[1], dz = hi[2] - lo[2];
+      return (dx*dy + dy*dz + dz*dx);
+    }
+  };
+
+  struct Range
+  {
+    index_type begin, end;
+    Box box;
+  };
+
+  class Builder
+  {
+    public:
+      Builder(const std::vector<double>& bounds, std::vector<index_type>& order) :
+        bounds_(bounds), order_(order) {}
+
+      Range range(index_type begin, index_type end) const
+      {
+        Range r;
+        r.begin = begin; r.end = end;
+        for (index_type i = begin; i < end; i++) r.box.extend(&bounds_[6 * order_[i]]);
+        return (r);
+      }
+
+      /// Twice the box center of value i along axis a
+      double center(index_type i, int a) const
+      {
+        return (bounds_[6*i + a] + bounds_[6*i + 3 + a]);
+      }
+
+      /// Splits r in two and returns the start of the second half
+      index_type split(const Range& r, bool median)
+      {
+        Box centers;
+        for (index_type i = r.begin; i < r.end; i++)
+        {
+          double c[6];
+          for (int a = 0; a < 3; a++) c[a] = c[a+3] = center(order_[i], a);
+          centers.extend(c);
+        }
+
+        int axis = 0;
+        for (int a = 1; a < 3; a++)
+          if (centers.hi[a] - centers.lo[a] > centers.hi[axis] - centers.lo[axis]) axis = a;
+        const double lo = centers.lo[axis];
+        const double extent = centers.hi[axis] - lo;
+
+        if (!median && extent > 0.0)
+        {
+          const double scale = num_bins / extent;
+          Box bin_box[num_bins];
+          index_type bin_count[num_bins] = { 0 };
+          for (index_type i = r.begin; i < r.end; i++)
+          {
+            const int b = bin(order_[i], axis, lo, scale);
+            bin_count[b]++;
+            bin_box[b].extend(&bounds_[6 * order_[i]]);
+          }
+
+          // Cost of splitting after bin b: area times count on either side
+          double right_cost[num_bins];
+          Box right;
+          index_type right_count = 0;
+          for (int b = num_bins - 1; b > 0; b--)
+          {
+            right.extend(bin_box[b]);
+            right_count += bin_count[b];
+            right_cost[b] = right.half_area() * right_count;
+          }
+
+          int best = -1;
+          double best_cost = DBL_MAX;
+          Box left;
+          index_type left_count = 0;
+          for (int b = 0; b < num_bins - 1; b++)
+          {
+            left.extend(bin_box[b]);
+            left_count += bin_count[b];
+            const double cost = left.half_area() * left_count + right_cost[b+1];
+            if (left_count > 0 && left_count < r.end - r.begin && cost < best_cost)
+            {
+              best = b;
+              best_cost = cost;
+            }
+          }
+
+          if (best >= 0)
+          {
+            index_type* mid = std::partition(&order_[0] + r.begin, &order_[0] + r.end,
+              [&](index_type i) { return (bin(i, axis, lo, scale) <= best); });
+            return (static_cast<index_type>(mid - &order_[0]));
+          }
+        }
+
+        const index_type mid = r.begin + (r.end - r.begin) / 2;
+        std::nth_element(&order_[0] + r.begin, &order_[0] + mid, &order_[0] + r.end,
+          [&](index_type i, index_type j) { return (center(i, axis) < center(j, axis)); });
+        return (mid);
+      }
+
+    private:
+      int bin(index_type i, int axis, double lo, double scale) const
+      {
+        return (std::min(num_bins - 1, static_cast<int>((center(i, axis) - lo) * scale)));
+      }
+
+      const std::vector<double>& bounds_;
+      std::vector<index_type>& order_;
+  };
+
+  struct Task
+  {
+    index_type node;
+    index_type begin, end;
+    int depth;
+  };
+}
+
+void
+BoundingVolumeHierarchy::build(const std::vector<index_type>& values,
+                               const std::vector<double>& bounds)
+{
+  nodes_.clear();
+  values_.clear();
+
+  const index_type n = static_cast<index_type>(values.size());
+  if (n == 0) return;
+
+  std::vector<index_type> order(n);
+  for (index_type i = 0; i < n; i++) order[i] = i;
+  Builder builder(bounds, order);
+
+  nodes_.push_back(Node());
+  std::vector<Task> tasks;
+  Task root = { 0, 0, n, 0 };
+  tasks.push_back(root);
+
+  while (!tasks.empty())
+  {
+    const Task task = tasks.back();
+    tasks.pop_back();
+
+    // Split the range into up to four children, the largest one first:
+    // by surface area normally, by count for median splits
+    const bool median = task.depth >= median_depth;
+    Range ranges[4];
+    int num_ranges = 1;
+    ranges[0] = builder.range(task.begin, task.end);
+    while (num_ranges < 4)
+    {
+      int pick = -1;
+      double pick_size = -1.0;
+      for (int r = 0; r < num_ranges; r++)
+      {
+        const index_type count = ranges[r].end - ranges[r].begin;
+        const double size = median ? static_cast<double>(count) : ranges[r].box.half_area();
+        if (count > max_leaf && size > pick_size)
+        {
+          pick = r;
+          pick_size = size;
+        }
+      }
+      if (pick < 0) break;
+
+      const index_type mid = builder.split(ranges[pick], median);
+      ranges[num_ranges++] = builder.range(mid, ranges[pick].end);
+      ranges[pick] = builder.range(ranges[pick].begin, mid);
+    }
+
+    for (int c = 0; c < 4; c++)
+    {
+      Node& node = nodes_[task.node];
+      if (c >= num_ranges)
+      {
+        for (int a = 0; a < 3; a++) { node.lo[a][c] = DBL_MAX; node.hi[a][c] = -DBL_MAX; }
+        node.first[c] = 0;
+        node.count[c] = -1;
+        continue;
+      }
+
+      const Range& r = ranges[c];
+      for (int a = 0; a < 3; a++) { node.lo[a][c] = r.box.lo[a]; node.hi[a][c] = r.box.hi[a]; }
+      if (r.end - r.begin <= max_leaf)
+      {
+        node.first[c] = r.begin;
+        node.count[c] = r.end - r.begin;
+      }
+      else
+      {
+        const index_type child = static_cast<index_type>(nodes_.size());
+        node.first[c] = child;
+        node.count[c] = 0;
+        Task t = { child, r.begin, r.end, task.depth + 1 };
+        tasks.push_back(t);
+        nodes_.push_back(Node());
+      }
+    }
+  }
+
+  values_.resize(n);
+  for (index_type i = 0; i < n; i++) values_[i] = values[order[i]];
+}
@@ -0,0 +1,217 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_GEOMETRYPRIMITIVES_BOUNDINGVOLUMEHIERARCHY_H
+#define CORE_GEOMETRYPRIMITIVES_BOUNDINGVOLUMEHIERARCHY_H 1
+
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/GeometryPrimitives/BBox.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <Core/GeometryPrimitives/share.h>
+
+namespace SCIRun {
+
+/// Bounding volume hierarchy over the bounding boxes of the nodes or elements
+/// of a mesh, an alternative to SearchGridT for point location. Every node
+/// has four children whose boxes are stored side by side, so one node visit
+/// tests four boxes with straight line code the compiler vectorizes. The tree
+/// is built top down with the binned surface area heuristic, so it adapts to
+/// element sizes that vary by orders of magnitude, where a uniform grid
+/// either wastes bins or overfills them. The hierarchy is static: a mesh
+/// that is edited has to rebuild it.
+class SCISHARE BoundingVolumeHierarchy
+{
+  public:
+    typedef SCIRun::index_type                    index_type;
+    typedef SCIRun::size_type                     size_type;
+
+    /// Builds the hierarchy over the values 0..count-1 with boxes bbox_of(v).
+    template <class BOXFUNC>
+    BoundingVolumeHierarchy(size_type count, BOXFUNC bbox_of)
+    {
+      std::vector<index_type> values(count);
+      for (size_type v = 0; v < count; v++) values[v] = v;
+      build(values, bbox_of);
+    }
+
+    /// Builds the hierarchy over the given values with boxes bbox_of(v).
+    template <class BOXFUNC>
+    BoundingVolumeHierarchy(const std::vector<index_type>& values, BOXFUNC bbox_of)
+    {
+      build(values, bbox_of);
+    }
+
+    /// Number of values in the hierarchy
+    size_type size() const { return (static_cast<size_type>(values_.size())); }
+
+    /// Calls visit(v) for the values whose boxes may contain p, until visit
+    /// returns true. Returns whether a visit returned true.
+    template <class VISIT>
+    bool locate(const Core::Geometry::Point& p, VISIT visit) const
+    {
+      if (nodes_.empty()) return (false);
+
+      index_type stack[max_stack];
+      int top = 0;
+      stack[top++] = 0;
+      while (top > 0)
+      {
+        const Node& node = nodes_[stack[--top]];
+        const int hits = node.contains(p.x(), p.y(), p.z());
+        for (int c = 0; c < 4; c++)
+        {
+          if (!(hits & (1 << c))) continue;
+          if (node.count[c] == 0)
+          {
+            stack[top++] = node.first[c];
+          }
+          else
+          {
+            for (index_type v = node.first[c]; v < node.first[c] + node.count[c]; v++)
+              if (visit(values_[v])) return (true);
+          }
+        }
+      }
+      return (false);
+    }
+
+    /// Calls visit(v) for the values whose boxes are within squared distance
+    /// dmin + slack of p, nearest boxes first, until visit returns true.
+    /// visit is expected to lower dmin, which it shares with the caller, as
+    /// it finds closer values; that prunes the rest of the search. Returns
+    /// whether a visit returned true.
+    template <class VISIT>
+    bool closest(const Core::Geometry::Point& p, double& dmin, VISIT visit,
+                 double slack = 0.0) const
+    {
+      if (nodes_.empty()) return (false);
+
+      index_type stack[max_stack];
+      double stack_dist[max_stack];
+      int top = 0;
+      stack[top] = 0; stack_dist[top] = 0.0; top++;
+      while (top > 0)
+      {
+        --top;
+        if (stack_dist[top] > dmin + slack) continue;
+        const Node& node = nodes_[stack[top]];
+
+        double dist[4];
+        node.distance2(p.x(), p.y(), p.z(), dist);
+
+        // Visit the children nearest first: leaves right away, nodes are
+        // pushed farthest first so the nearest one is popped next
+        int order[4] = { 0, 1, 2, 3 };
+        for (int i = 1; i < 4; i++)
+          for (int j = i; j > 0 && dist[order[j]] < dist[order[j-1]]; j--)
+            std::swap(order[j], order[j-1]);
+
+        for (int i = 0; i < 4; i++)
+        {
+          const int c = order[i];
+          if (node.count[c] <= 0 || dist[c] > dmin + slack) continue;
+          for (index_type v = node.first[c]; v < node.first[c] + node.count[c]; v++)
+            if (visit(values_[v])) return (true);
+        }
+        for (int i = 3; i >= 0; i--)
+        {
+          const int c = order[i];
+          if (node.count[c] != 0 || dist[c] > dmin + slack) continue;
+          stack[top] = node.first[c]; stack_dist[top] = dist[c]; top++;
+        }
+      }
+      return (false);
+    }
+
+  private:
+    /// Four children: a child with count 0 is the node first, a child with a
+    /// positive count is the leaf values_[first, first+count), and a child
+    /// with count -1 is unused and has an empty box.
+    struct Node
+    {
+      double lo[3][4];
+      double hi[3][4];
+      index_type first[4];
+      index_type count[4];
+
+      inline int contains(double x, double y, double z) const
+      {
+        int hits = 0;
+        for (int c = 0; c < 4; c++)
+          hits |= int((x >= lo[0][c]) & (x <= hi[0][c]) &
+                      (y >= lo[1][c]) & (y <= hi[1][c]) &
+                      (z >= lo[2][c]) & (z <= hi[2][c])) << c;
+        return (hits);
+      }
+
+      inline void distance2(double x, double y, double z, double* dist) const
+      {
+        for (int c = 0; c < 4; c++)
+        {
+          const double dx = std::max(std::max(lo[0][c] - x, x - hi[0][c]), 0.0);
+          const double dy = std::max(std::max(lo[1][c] - y, y - hi[1][c]), 0.0);
+          const double dz = std::max(std::max(lo[2][c] - z, z - hi[2][c]), 0.0);
+          dist[c] = dx*dx + dy*dy + dz*dz;
+        }
+      }
+    };
+
+    /// Bound on the traversal stack; build() limits the depth to fit it
+    enum { max_stack = 256 };
+
+    template <class BOXFUNC>
+    void build(const std::vector<index_type>& values, BOXFUNC bbox_of)
+    {
+      std::vector<double> bounds(6 * values.size());
+      for (size_t v = 0; v < values.size(); v++)
+      {
+        const Core::Geometry::BBox b = bbox_of(values[v]);
+        const Core::Geometry::Point& lo = b.get_min();
+        const Core::Geometry::Point& hi = b.get_max();
+        double* box = &bounds[6 * v];
+        box[0] = lo.x(); box[1] = lo.y(); box[2] = lo.z();
+        box[3] = hi.x(); box[4] = hi.y(); box[5] = hi.z();
+      }
+      build(values, bounds);
+    }
+
+    /// Builds the tree from six doubles lo, hi per value
+    void build(const std::vector<index_type>& values, const std::vector<double>& bounds);
+
+    std::vector<Node> nodes_;
+    /// Values in leaf order
+    std::vector<index_type> values_;
+};
+
+} // namespace SCIRun
+
+#endif
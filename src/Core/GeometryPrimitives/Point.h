@@ -214,6 +214,12 @@ inline Point Max(const Point& p1, const Point& p2)
 /// @todo: This one is obsolete when last part dynamic compilation is gone
 SCISHARE const std::string& Point_get_h_file_path();
 SCISHARE const SCIRun::TypeDescription* get_type_description(Core::Geometry::Point*);
+
+template <>
+struct PioAsDoubles<Core::Geometry::Point>
+{
+  static const size_t count = 3;
+};
 }
 
 #include <Core/GeometryPrimitives/PointVectorOperators.h>
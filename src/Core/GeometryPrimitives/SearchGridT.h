@@ -35,14 +35,21 @@
 #include <Core/GeometryPrimitives/BBox.h>
 #include <Core/GeometryPrimitives/Transform.h>
 #include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Thread/Parallel.h>
 
 #include <algorithm>
+#include <atomic>
 #include <vector>
 
 #include <Core/GeometryPrimitives/share.h>
 
 namespace SCIRun {
 
+/// Uniform grid of bins holding the indices of the nodes or elements that
+/// overlap each bin. A grid filled with fill_boxes() or fill_points() keeps
+/// all bins in one flat array (compressed row storage). The first insert()
+/// or remove() converts it to a vector per bin, so meshes that are being
+/// edited keep updating the grid incrementally.
 template<class INDEX>
 class SearchGridT 
 {
@@ -50,7 +57,7 @@ class SearchGridT
     /// Include the types defined in Types into this class
     typedef SCIRun::index_type                    index_type;
     typedef SCIRun::size_type                     size_type;
-    typedef typename std::vector<INDEX>::iterator iterator;
+    typedef const INDEX*                          iterator;
 
     SearchGridT(size_type x, size_type y, size_type z,
                const Core::Geometry::Point &min, const Core::Geometry::Point &max) :
@@ -61,7 +68,6 @@ class SearchGridT
 
         transform_.pre_translate(Core::Geometry::Vector(min));
         transform_.compute_imat();
-        bin_.resize(x*y*z);
       }
 
     inline void transform(const Core::Geometry::Transform &t) 
@@ -150,7 +156,7 @@ class SearchGridT
         {
           for (index_type k = mink; k <= maxk; k++)
           {
-            bin_[linearize(i, j, k)].push_back(val);
+            dynamic_bin(linearize(i, j, k)).push_back(val);
           }
         }
       }
@@ -169,8 +175,7 @@ class SearchGridT
         {
           for (index_type k = mink; k <= maxk; k++)
           {
-            index_type q = linearize(i, j, k);
-            std::remove(bin_[q].begin(),bin_[q].end(),val);
+            erase(dynamic_bin(linearize(i, j, k)), val);
           }
         }
       }
@@ -180,36 +185,59 @@ class SearchGridT
     {
       index_type i, j, k;
       unsafe_locate(i, j, k, point);
-      bin_[linearize(i, j, k)].push_back(val);
+      dynamic_bin(linearize(i, j, k)).push_back(val);
     }  
 
     void remove(INDEX val, const Core::Geometry::Point &point)
     {
       index_type i, j, k;
       unsafe_locate(i, j, k, point);
-      index_type q = linearize(i, j, k);
-      std::remove(bin_[q].begin(),bin_[q].end(),val);
+      erase(dynamic_bin(linearize(i, j, k)), val);
     }
-    
-    inline bool lookup(iterator &begin, iterator &end, const Core::Geometry::Point &p)
+
+    /// Replaces the contents of the grid with the values 0..count-1, where
+    /// value v goes in the bins insert(v, bbox_of(v)) would put it in. The
+    /// bins are counted and filled in parallel and list their values in
+    /// increasing order, as serial insertion would.
+    template <class BOXFUNC>
+    void fill_boxes(size_type count, BOXFUNC bbox_of)
+    {
+      fill(count, [this, &bbox_of](index_type v, index_type* range)
+      {
+        const Core::Geometry::BBox bbox = bbox_of(v);
+        range[0] = range[1] = range[2] = range[3] = range[4] = range[5] = 0;
+        locate(range[0], range[1], range[2], bbox.get_min());
+        locate(range[3], range[4], range[5], bbox.get_max());
+      });
+    }
+
+    /// Same as fill_boxes() for values inserted at a point, like
+    /// insert(v, point_of(v)).
+    template <class POINTFUNC>
+    void fill_points(size_type count, POINTFUNC point_of)
+    {
+      fill(count, [this, &point_of](index_type v, index_type* range)
+      {
+        unsafe_locate(range[0], range[1], range[2], point_of(v));
+        range[3] = range[0]; range[4] = range[1]; range[5] = range[2];
+      });
+    }
+
+    inline bool lookup(iterator &begin, iterator &end, const Core::Geometry::Point &p) const
     {
       index_type i, j, k;
       if (locate(i, j, k, p))
       {
-        index_type q = linearize(i, j, k);
-        begin = bin_[q].begin();
-        end   = bin_[q].end();
+        get_bin(linearize(i, j, k), begin, end);
         return (true);
       }
       return (false);    
     }
     
     inline void lookup_ijk(iterator &begin, iterator &end, size_type i, size_type j, 
-                    size_type k)
+                    size_type k) const
     {
-      index_type q = linearize(i, j, k);
-      begin = bin_[q].begin();
-      end   = bin_[q].end();    
+      get_bin(linearize(i, j, k), begin, end);
     }                
                       
     
@@ -241,6 +269,105 @@ class SearchGridT
     index_type linearize(index_type i, index_type j, index_type k) const
       { return (((i * nj_) + j) * nk_ + k); }
 
+    size_type num_bins() const { return (ni_ * nj_ * nk_); }
+
+    inline void get_bin(index_type q, iterator &begin, iterator &end) const
+    {
+      if (!bin_.empty())
+      {
+        begin = bin_[q].data();
+        end   = begin + bin_[q].size();
+      }
+      else if (!offsets_.empty())
+      {
+        begin = values_.data() + offsets_[q];
+        end   = values_.data() + offsets_[q+1];
+      }
+      else
+      {
+        begin = end = nullptr;
+      }
+    }
+
+    /// Bin q as a vector, moving the flat storage into per bin vectors first.
+    std::vector<INDEX>& dynamic_bin(index_type q)
+    {
+      if (bin_.empty())
+      {
+        bin_.resize(num_bins());
+        if (!offsets_.empty())
+        {
+          for (size_type b = 0; b < num_bins(); b++)
+            bin_[b].assign(values_.begin() + offsets_[b], values_.begin() + offsets_[b+1]);
+          std::vector<index_type>().swap(offsets_);
+          std::vector<INDEX>().swap(values_);
+        }
+      }
+      return (bin_[q]);
+    }
+
+    static void erase(std::vector<INDEX>& bin, INDEX val)
+    {
+      bin.erase(std::remove(bin.begin(), bin.end(), val), bin.end());
+    }
+
+    template <class RANGEFUNC, class VISIT>
+    void for_each_bin(RANGEFUNC& range, index_type v, VISIT visit) const
+    {
+      index_type r[6];
+      range(v, r);
+      for (index_type i = r[0]; i <= r[3]; i++)
+        for (index_type j = r[1]; j <= r[4]; j++)
+          for (index_type k = r[2]; k <= r[5]; k++)
+            visit(linearize(i, j, k));
+    }
+
+    /// Counting sort of the values 0..count-1 into the flat storage; range(v, r)
+    /// sets r to the inclusive bin range mini, minj, mink, maxi, maxj, maxk of v.
+    /// Threads count into and scatter through one shared atomic histogram, so the
+    /// extra memory is a single counter per bin whatever the thread count; each
+    /// bin is sorted afterwards to keep its values in increasing order.
+    template <class RANGEFUNC>
+    void fill(size_type count, RANGEFUNC range)
+    {
+      std::vector<std::vector<INDEX> >().swap(bin_);
+      const size_type nbins = num_bins();
+      const size_t grain = 1024;
+      std::vector<std::atomic<index_type> > next(nbins);
+      for (auto& n : next)
+        n.store(0, std::memory_order_relaxed);
+
+      Core::Thread::Parallel::For(0, count, [&](size_t begin, size_t end)
+      {
+        for (index_type v = begin; v < static_cast<index_type>(end); v++)
+          for_each_bin(range, v, [&next](index_type q) { next[q].fetch_add(1, std::memory_order_relaxed); });
+      }, grain);
+
+      offsets_.resize(nbins + 1);
+      index_type total = 0;
+      for (size_type q = 0; q < nbins; q++)
+      {
+        offsets_[q] = total;
+        total += next[q].load(std::memory_order_relaxed);
+        next[q].store(offsets_[q], std::memory_order_relaxed);
+      }
+      offsets_[nbins] = total;
+      values_.resize(total);
+
+      INDEX* values = values_.data();
+      Core::Thread::Parallel::For(0, count, [&](size_t begin, size_t end)
+      {
+        for (index_type v = begin; v < static_cast<index_type>(end); v++)
+          for_each_bin(range, v, [&next, values, v](index_type q)
+            { values[next[q].fetch_add(1, std::memory_order_relaxed)] = static_cast<INDEX>(v); });
+      }, grain);
+
+      Core::Thread::Parallel::For(0, nbins, [&](size_t begin, size_t end)
+      {
+        for (size_t q = begin; q < end; q++)
+          std::sort(values + offsets_[q], values + offsets_[q+1]);
+      });
+    }
 
   private:
     /// Size of the search grid
@@ -248,7 +375,10 @@ class SearchGridT
     /// Transformation to unitary coordinate system
     Core::Geometry::Transform transform_;
     
-    /// Where to store the lookup table
+    /// Flat lookup table: the values of bin q are values_[offsets_[q]..offsets_[q+1])
+    std::vector<index_type> offsets_;
+    std::vector<INDEX> values_;
+    /// Lookup table with a vector per bin, used once the grid is edited
     std::vector<std::vector<INDEX> > bin_;   
 };
 
@@ -0,0 +1,196 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/GeometryPrimitives/SpaceFillingCurve.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  /// Bits per coordinate, three of them fit in 64 bits
+  const int morton_bits = 21;
+
+  /// Moves the low 21 bits of v to every third bit position
+  inline boost::uint64_t spread_bits(boost::uint64_t v)
+  {
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x1f00000000ffffULL;
+    v = (v | (v << 16)) & 0x1f0000ff0000ffULL;
+    v = (v | (v << 8))  & 0x100f00f00f00f00fULL;
+    v = (v | (v << 4))  & 0x10c30c30c30c30c3ULL;
+    v = (v | (v << 2))  & 0x1249249249249249ULL;
+    return (v);
+  }
+
+  inline boost::uint64_t quantize(double v, double min, double scale)
+  {
+    double q = (v - min) * scale;
+    if (!(q > 0.0)) return (0);
+    const double top = static_cast<double>((1 << morton_bits) - 1);
+    if (q > top) q = top;
+    return (static_cast<boost::uint64_t>(q));
+  }
+
+  /// Maps points to integer grid coordinates over a bounding box
+  class GridQuantizer
+  {
+    public:
+      explicit GridQuantizer(const BBox& bbox)
+      {
+        if (bbox.valid())
+        {
+          min_ = bbox.get_min();
+          const Vector d = bbox.diagonal();
+          const double top = static_cast<double>((1 << morton_bits) - 1);
+          for (int k = 0; k < 3; k++)
+            scale_[k] = d[k] > 0.0 ? top / d[k] : 0.0;
+        }
+        else
+        {
+          scale_[0] = scale_[1] = scale_[2] = 0.0;
+        }
+      }
+
+      void operator()(const Point& p, boost::uint64_t q[3]) const
+      {
+        q[0] = quantize(p.x(), min_.x(), scale_[0]);
+        q[1] = quantize(p.y(), min_.y(), scale_[1]);
+        q[2] = quantize(p.z(), min_.z(), scale_[2]);
+      }
+
+    private:
+      Point  min_;
+      double scale_[3];
+  };
+
+  class MortonEncoder
+  {
+    public:
+      explicit MortonEncoder(const BBox& bbox) : grid_(bbox) {}
+
+      boost::uint64_t operator()(const Point& p) const
+      {
+        boost::uint64_t q[3];
+        grid_(p, q);
+        return (spread_bits(q[0]) | (spread_bits(q[1]) << 1) | (spread_bits(q[2]) << 2));
+      }
+
+    private:
+      GridQuantizer grid_;
+  };
+
+  /// Hilbert index from grid coordinates, following J. Skilling, "Programming
+  /// the Hilbert curve" (2004): the coordinates are transformed in place into
+  /// the transposed index, whose bits are then interleaved like a Morton code.
+  class HilbertEncoder
+  {
+    public:
+      explicit HilbertEncoder(const BBox& bbox) : grid_(bbox) {}
+
+      boost::uint64_t operator()(const Point& p) const
+      {
+        boost::uint64_t x[3];
+        grid_(p, x);
+
+        // Written without branches, as the bits tested are close to random
+        // for shuffled input: if bit b of x[i] is set the low bits of x[0]
+        // are inverted, otherwise they are exchanged with those of x[i].
+        for (int b = morton_bits - 1; b > 0; b--)
+        {
+          const boost::uint64_t mask = (boost::uint64_t(1) << b) - 1;
+          for (int i = 0; i < 3; i++)
+          {
+            const boost::uint64_t set = boost::uint64_t(0) - ((x[i] >> b) & 1);
+            const boost::uint64_t t = (x[0] ^ x[i]) & mask & ~set;
+            x[0] ^= (mask & set) | t;
+            x[i] ^= t;
+          }
+        }
+
+        x[1] ^= x[0];
+        x[2] ^= x[1];
+        boost::uint64_t t = 0;
+        for (int b = morton_bits - 1; b > 0; b--)
+          if ((x[2] >> b) & 1) t ^= (boost::uint64_t(1) << b) - 1;
+        for (int i = 0; i < 3; i++) x[i] ^= t;
+
+        return ((spread_bits(x[0]) << 2) | (spread_bits(x[1]) << 1) | spread_bits(x[2]));
+      }
+
+    private:
+      GridQuantizer grid_;
+  };
+
+  template<class ENCODER>
+  void curve_order(std::vector<SCIRun::index_type>& order,
+                   const std::vector<Point>& points)
+  {
+    const size_t num_points = points.size();
+    const BBox bbox(points);
+    const ENCODER encode(bbox);
+
+    std::vector<std::pair<boost::uint64_t, SCIRun::index_type> > keys(num_points);
+    for (size_t j = 0; j < num_points; j++)
+      keys[j] = std::make_pair(encode(points[j]), static_cast<SCIRun::index_type>(j));
+    std::sort(keys.begin(), keys.end());
+
+    order.resize(num_points);
+    for (size_t j = 0; j < num_points; j++)
+      order[j] = keys[j].second;
+  }
+}
+
+boost::uint64_t
+Core::Geometry::morton_code(const Point& p, const BBox& bbox)
+{
+  return (MortonEncoder(bbox)(p));
+}
+
+void
+Core::Geometry::morton_order(std::vector<SCIRun::index_type>& order,
+                             const std::vector<Point>& points)
+{
+  curve_order<MortonEncoder>(order, points);
+}
+
+boost::uint64_t
+Core::Geometry::hilbert_code(const Point& p, const BBox& bbox)
+{
+  return (HilbertEncoder(bbox)(p));
+}
+
+void
+Core::Geometry::hilbert_order(std::vector<SCIRun::index_type>& order,
+                              const std::vector<Point>& points)
+{
+  curve_order<HilbertEncoder>(order, points);
+}
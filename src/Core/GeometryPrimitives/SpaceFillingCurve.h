@@ -0,0 +1,67 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_GEOMETRYPRIMITIVES_SPACEFILLINGCURVE_H
+#define CORE_GEOMETRYPRIMITIVES_SPACEFILLINGCURVE_H 1
+
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/GeometryPrimitives/BBox.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+
+#include <boost/cstdint.hpp>
+#include <vector>
+
+#include <Core/GeometryPrimitives/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Geometry {
+
+/// Morton (Z-order) code of p: its position in a 2^21 grid over bbox, with
+/// the bits of the three grid coordinates interleaved. Points with close
+/// codes are close in space, so visiting points in code order keeps the
+/// mesh data a query touches in cache.
+SCISHARE boost::uint64_t morton_code(const Point& p, const BBox& bbox);
+
+/// Fills order with the indices 0..points.size()-1 sorted by the Morton codes
+/// of the points over their bounding box. Equal codes keep index order.
+SCISHARE void morton_order(std::vector<SCIRun::index_type>& order,
+                           const std::vector<Point>& points);
+
+/// Hilbert code of p on the same 2^21 grid. Unlike the Morton curve, the
+/// Hilbert curve only steps between neighboring grid cells, so consecutive
+/// codes are always adjacent in space. It costs a few more operations per point.
+SCISHARE boost::uint64_t hilbert_code(const Point& p, const BBox& bbox);
+
+/// Same as morton_order(), sorted by Hilbert codes
+SCISHARE void hilbert_order(std::vector<SCIRun::index_type>& order,
+                            const std::vector<Point>& points);
+
+}}}
+
+#endif
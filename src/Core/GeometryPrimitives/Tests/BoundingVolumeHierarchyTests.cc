@@ -0,0 +1,142 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/GeometryPrimitives/BoundingVolumeHierarchy.h>
+
+#include <algorithm>
+#include <cfloat>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  // Boxes whose sizes span three orders of magnitude, clustered towards the origin
+  BBox gradedBox(index_type v)
+  {
+    const double x = ((v * 37) % 101) / 101.0;
+    const double y = ((v * 53) % 103) / 103.0;
+    const double z = ((v * 71) % 107) / 107.0;
+    const Point c(x*x*x, y*y*y, z*z*z);
+    const double h = 0.001 * (1 + (v % 13) * 10.0 * c.x());
+    return BBox(c - Vector(h, h, h), c + Vector(h, h, h));
+  }
+
+  Point query(int s)
+  {
+    return Point(((s * 29) % 97) / 97.0 - 0.1, ((s * 31) % 89) / 89.0 - 0.1, ((s * 43) % 83) / 83.0 - 0.1);
+  }
+
+  const size_type count = 3000;
+}
+
+TEST(BoundingVolumeHierarchyTests, EmptyHierarchyFindsNothing)
+{
+  BoundingVolumeHierarchy bvh(0, gradedBox);
+  EXPECT_EQ(0, bvh.size());
+  EXPECT_FALSE(bvh.locate(Point(0, 0, 0), [](index_type) { return true; }));
+  double dmin = DBL_MAX;
+  EXPECT_FALSE(bvh.closest(Point(0, 0, 0), dmin, [](index_type) { return true; }));
+}
+
+TEST(BoundingVolumeHierarchyTests, LocateVisitsEveryContainingBox)
+{
+  BoundingVolumeHierarchy bvh(count, gradedBox);
+  EXPECT_EQ(count, bvh.size());
+
+  for (int s = 0; s < 500; s++)
+  {
+    const Point p = (s % 2) ? query(s) : gradedBox(s).center();
+    std::vector<index_type> expected, visited;
+    for (index_type v = 0; v < count; v++)
+      if (gradedBox(v).inside(p)) expected.push_back(v);
+
+    EXPECT_FALSE(bvh.locate(p, [&](index_type v) { visited.push_back(v); return false; }));
+    std::sort(visited.begin(), visited.end());
+    // Every box containing p is visited exactly once
+    std::vector<index_type> hits;
+    for (index_type v : visited)
+      if (gradedBox(v).inside(p)) hits.push_back(v);
+    EXPECT_EQ(expected, hits);
+    EXPECT_EQ(std::unique(visited.begin(), visited.end()), visited.end());
+  }
+}
+
+TEST(BoundingVolumeHierarchyTests, LocateStopsAtFirstAccepted)
+{
+  BoundingVolumeHierarchy bvh(count, gradedBox);
+  int visits = 0;
+  const Point p = gradedBox(7).center();
+  EXPECT_TRUE(bvh.locate(p, [&](index_type v) { visits++; return v == 7; }));
+  int all = 0;
+  bvh.locate(p, [&](index_type) { all++; return false; });
+  EXPECT_LE(visits, all);
+}
+
+TEST(BoundingVolumeHierarchyTests, ClosestMatchesBruteForce)
+{
+  BoundingVolumeHierarchy bvh(count, gradedBox);
+
+  for (int s = 0; s < 500; s++)
+  {
+    const Point p = query(s) + Vector(0.5, 0.5, 0.5) * (s % 3);
+
+    double expected = DBL_MAX;
+    for (index_type v = 0; v < count; v++)
+      expected = std::min(expected, (gradedBox(v).center() - p).length2());
+
+    double dmin = DBL_MAX;
+    index_type best = -1;
+    int visits = 0;
+    bvh.closest(p, dmin, [&](index_type v)
+    {
+      visits++;
+      const double d = (gradedBox(v).center() - p).length2();
+      if (d < dmin) { dmin = d; best = v; }
+      return false;
+    });
+    EXPECT_DOUBLE_EQ(expected, dmin);
+    EXPECT_DOUBLE_EQ(expected, (gradedBox(best).center() - p).length2());
+    EXPECT_LT(visits, count / 4);
+  }
+}
+
+TEST(BoundingVolumeHierarchyTests, HandlesIdenticalBoxesAndSubsets)
+{
+  std::vector<index_type> values;
+  for (index_type v = 0; v < 1000; v++) values.push_back(3 * v + 1);
+  BoundingVolumeHierarchy bvh(values, [](index_type) { return BBox(Point(0, 0, 0), Point(1, 1, 1)); });
+  EXPECT_EQ(1000, bvh.size());
+
+  std::vector<index_type> visited;
+  bvh.locate(Point(0.5, 0.5, 0.5), [&](index_type v) { visited.push_back(v); return false; });
+  std::sort(visited.begin(), visited.end());
+  EXPECT_EQ(values, visited);
+}
@@ -30,7 +30,13 @@
 
 #include <Core/GeometryPrimitives/Point.h>
 #include <Core/GeometryPrimitives/PointVectorOperators.h>
+#include <Core/Persistent/Pstreams.h>
+#include <Core/Persistent/PersistentSTL.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
 
+using namespace SCIRun;
 using namespace SCIRun::Core::Geometry;
 
 TEST(PointTests, CanDefaultConstruct)
@@ -70,4 +76,57 @@ TEST(PointTests, CanSubtractVector)
   p1 -= v;
 
   EXPECT_EQ(Point(-1,3,2), p1);
-}
\ No newline at end of file
+}
+
+namespace
+{
+  std::string readBytes(const std::string& filename)
+  {
+    std::ifstream in(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+}
+
+// Point arrays go through block_io in binary streams, which must write the
+// same bytes as persisting the points one at a time
+TEST(PointTests, PointArraysPersistAsBefore)
+{
+  std::vector<Point> points;
+  for (int i = 0; i < 1000; ++i)
+    points.push_back(Point(i, 0.5 * i, -i));
+  auto temp = [](const char* model) { return (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path(model)).string(); };
+  const std::string block = temp("points-%%%%%%%%.fld"), elementwise = temp("points-%%%%%%%%.fld"), text = temp("points-%%%%%%%%.fld");
+
+  {
+    PiostreamPtr stream = auto_ostream(block, "Binary", nullptr);
+    Pio(*stream, points);
+  }
+  {
+    PiostreamPtr stream = auto_ostream(elementwise, "Binary", nullptr);
+    stream->begin_class("STLVector", STLVECTOR_VERSION);
+    int size = static_cast<int>(points.size());
+    stream->io(size);
+    for (auto& p : points)
+      Pio(*stream, p);
+    stream->end_class();
+  }
+  {
+    PiostreamPtr stream = auto_ostream(text, "Text", nullptr);
+    Pio(*stream, points);
+  }
+  EXPECT_EQ(readBytes(elementwise), readBytes(block));
+
+  for (const auto& filename : { block, text })
+  {
+    std::vector<Point> read;
+    {
+      PiostreamPtr stream = auto_istream(filename, nullptr);
+      ASSERT_TRUE(stream != nullptr);
+      Pio(*stream, read);
+      EXPECT_FALSE(stream->error());
+    }
+    EXPECT_EQ(points, read);
+    boost::filesystem::remove(filename);
+  }
+  boost::filesystem::remove(elementwise);
+}
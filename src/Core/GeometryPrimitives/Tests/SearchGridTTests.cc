@@ -0,0 +1,140 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/GeometryPrimitives/SearchGridT.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  typedef SearchGridT<index_type> Grid;
+
+  Point pointOf(index_type v)
+  {
+    return Point(((v * 37) % 101) / 101.0, ((v * 53) % 103) / 103.0, ((v * 71) % 107) / 107.0);
+  }
+
+  BBox boxOf(index_type v)
+  {
+    // Overlapping boxes of varying size scattered through the unit cube
+    const Point c = Point(0.15, 0.15, 0.15) + 0.7 * Vector(pointOf(v));
+    const Vector h(0.01 + (v % 7) * 0.02, 0.01 + (v % 7) * 0.02, 0.01 + (v % 7) * 0.02);
+    return BBox(c - h, c + h);
+  }
+
+  std::vector<index_type> bin(const Grid& grid, index_type i, index_type j, index_type k)
+  {
+    Grid::iterator it, eit;
+    grid.lookup_ijk(it, eit, i, j, k);
+    return std::vector<index_type>(it, eit);
+  }
+
+  void expectSameBins(const Grid& expected, const Grid& actual)
+  {
+    for (index_type i = 0; i < expected.get_ni(); i++)
+      for (index_type j = 0; j < expected.get_nj(); j++)
+        for (index_type k = 0; k < expected.get_nk(); k++)
+          ASSERT_EQ(bin(expected, i, j, k), bin(actual, i, j, k)) << i << " " << j << " " << k;
+  }
+
+  const size_type count = 5000;
+}
+
+TEST(SearchGridTTests, EmptyGridHasEmptyBins)
+{
+  Grid grid(4, 4, 4, Point(0, 0, 0), Point(1, 1, 1));
+  Grid::iterator it, eit;
+  EXPECT_TRUE(grid.lookup(it, eit, Point(0.5, 0.5, 0.5)));
+  EXPECT_EQ(it, eit);
+  EXPECT_FALSE(grid.lookup(it, eit, Point(2, 2, 2)));
+}
+
+TEST(SearchGridTTests, FillBoxesMatchesSerialInsert)
+{
+  Grid inserted(9, 10, 11, Point(0, 0, 0), Point(1, 1, 1));
+  Grid filled(9, 10, 11, Point(0, 0, 0), Point(1, 1, 1));
+
+  for (index_type v = 0; v < count; v++)
+    inserted.insert(v, boxOf(v));
+  filled.fill_boxes(count, boxOf);
+
+  expectSameBins(inserted, filled);
+}
+
+TEST(SearchGridTTests, FillPointsMatchesSerialInsert)
+{
+  Grid inserted(9, 10, 11, Point(0, 0, 0), Point(1, 1, 1));
+  Grid filled(9, 10, 11, Point(0, 0, 0), Point(1, 1, 1));
+
+  for (index_type v = 0; v < count; v++)
+    inserted.insert(v, pointOf(v));
+  filled.fill_points(count, pointOf);
+
+  expectSameBins(inserted, filled);
+}
+
+TEST(SearchGridTTests, CanEditFilledGrid)
+{
+  Grid inserted(6, 6, 6, Point(0, 0, 0), Point(1, 1, 1));
+  Grid filled(6, 6, 6, Point(0, 0, 0), Point(1, 1, 1));
+
+  for (index_type v = 0; v < count; v++)
+    inserted.insert(v, boxOf(v));
+  filled.fill_boxes(count, boxOf);
+
+  for (index_type v = 0; v < count; v += 3)
+  {
+    inserted.remove(v, boxOf(v));
+    filled.remove(v, boxOf(v));
+  }
+  inserted.insert(count, boxOf(count));
+  filled.insert(count, boxOf(count));
+
+  expectSameBins(inserted, filled);
+
+  Grid::iterator it, eit;
+  ASSERT_TRUE(filled.lookup(it, eit, pointOf(3)));
+  EXPECT_EQ(eit, std::find(it, eit, 3));
+}
+
+TEST(SearchGridTTests, RefillReplacesContents)
+{
+  Grid grid(5, 5, 5, Point(0, 0, 0), Point(1, 1, 1));
+  for (index_type v = 0; v < count; v++)
+    grid.insert(v, boxOf(v));
+
+  Grid expected(5, 5, 5, Point(0, 0, 0), Point(1, 1, 1));
+  for (index_type v = 0; v < 100; v++)
+    expected.insert(v, pointOf(v));
+
+  grid.fill_points(100, pointOf);
+  expectSameBins(expected, grid);
+}
@@ -0,0 +1,147 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/GeometryPrimitives/SpaceFillingCurve.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+TEST(SpaceFillingCurveTests, CodesInterleaveCoordinateBits)
+{
+  const BBox box(Point(0, 0, 0), Point(1, 1, 1));
+  EXPECT_EQ(0u, morton_code(Point(0, 0, 0), box));
+  EXPECT_EQ(0x7fffffffffffffffULL, morton_code(Point(1, 1, 1), box));
+  // On a box one grid cell per unit, the top bit of each coordinate lands
+  // in the top three bits of the code, x lowest
+  const double top = (1 << 21) - 1, half = 1 << 20;
+  const BBox grid(Point(0, 0, 0), Point(top, top, top));
+  EXPECT_EQ(1ULL << 60, morton_code(Point(half, 0, 0), grid));
+  EXPECT_EQ(1ULL << 61, morton_code(Point(0, half, 0), grid));
+  EXPECT_EQ(1ULL << 62, morton_code(Point(0, 0, half), grid));
+  EXPECT_EQ(7ULL, morton_code(Point(1, 1, 1), grid));
+  // Points outside the box are clamped to it
+  EXPECT_EQ(morton_code(Point(1, 1, 1), box), morton_code(Point(2, 3, 4), box));
+  EXPECT_EQ(0u, morton_code(Point(-1, -1, -1), box));
+}
+
+TEST(SpaceFillingCurveTests, OrderVisitsOctantsInTurn)
+{
+  // Corners of a cube, given in reverse Z order
+  std::vector<Point> points;
+  for (int c = 7; c >= 0; --c)
+    points.push_back(Point(c & 1, (c >> 1) & 1, (c >> 2) & 1));
+
+  std::vector<index_type> order;
+  morton_order(order, points);
+  ASSERT_EQ(8u, order.size());
+  for (int c = 0; c < 8; ++c)
+    EXPECT_EQ(7 - c, order[c]);
+}
+
+TEST(SpaceFillingCurveTests, OrderIsPermutationWithNondecreasingCodes)
+{
+  std::vector<Point> points;
+  for (int v = 0; v < 5000; ++v)
+    points.push_back(Point(((v * 37) % 101) / 101.0, ((v * 53) % 103) / 103.0, (v % 7) * 0.5));
+  // Duplicates and a flat extent in no direction must be handled
+  points.push_back(points[10]);
+
+  std::vector<index_type> order;
+  morton_order(order, points);
+  ASSERT_EQ(points.size(), order.size());
+
+  std::vector<index_type> sorted(order);
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t j = 0; j < sorted.size(); ++j)
+    ASSERT_EQ(static_cast<index_type>(j), sorted[j]);
+
+  const BBox box(points);
+  for (size_t j = 1; j < order.size(); ++j)
+    EXPECT_LE(morton_code(points[order[j-1]], box), morton_code(points[order[j]], box));
+}
+
+TEST(SpaceFillingCurveTests, EmptyAndDegenerateInputs)
+{
+  std::vector<index_type> order(3, 7);
+  morton_order(order, std::vector<Point>());
+  EXPECT_TRUE(order.empty());
+
+  // All points equal: every code is zero and the order is the input order
+  morton_order(order, std::vector<Point>(4, Point(1, 2, 3)));
+  ASSERT_EQ(4u, order.size());
+  for (int j = 0; j < 4; ++j)
+    EXPECT_EQ(j, order[j]);
+}
+
+TEST(SpaceFillingCurveTests, HilbertCodesStepBetweenNeighborCells)
+{
+  // The 8x8x8 cells in the corner of the grid form one block of the curve
+  const double top = (1 << 21) - 1;
+  const BBox grid(Point(0, 0, 0), Point(top, top, top));
+  std::vector<std::pair<boost::uint64_t, Point> > cells;
+  for (int k = 0; k < 8; ++k)
+    for (int j = 0; j < 8; ++j)
+      for (int i = 0; i < 8; ++i)
+        cells.push_back(std::make_pair(hilbert_code(Point(i, j, k), grid), Point(i, j, k)));
+  std::sort(cells.begin(), cells.end(),
+    [](const std::pair<boost::uint64_t, Point>& a, const std::pair<boost::uint64_t, Point>& b) { return a.first < b.first; });
+
+  EXPECT_EQ(0u, cells.front().first);
+  EXPECT_EQ(511u, cells.back().first);
+  for (size_t j = 1; j < cells.size(); ++j)
+  {
+    EXPECT_EQ(cells[j-1].first + 1, cells[j].first);
+    const Vector step = cells[j].second - cells[j-1].second;
+    EXPECT_EQ(1.0, std::abs(step.x()) + std::abs(step.y()) + std::abs(step.z()));
+  }
+}
+
+TEST(SpaceFillingCurveTests, HilbertOrderIsPermutation)
+{
+  std::vector<Point> points;
+  for (int v = 0; v < 5000; ++v)
+    points.push_back(Point(((v * 37) % 101) / 101.0, ((v * 53) % 103) / 103.0, (v % 7) * 0.5));
+
+  std::vector<index_type> order;
+  hilbert_order(order, points);
+  ASSERT_EQ(points.size(), order.size());
+
+  std::vector<index_type> sorted(order);
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t j = 0; j < sorted.size(); ++j)
+    ASSERT_EQ(static_cast<index_type>(j), sorted[j]);
+
+  const BBox box(points);
+  for (size_t j = 1; j < order.size(); ++j)
+    EXPECT_LE(hilbert_code(points[order[j-1]], box), hilbert_code(points[order[j]], box));
+}
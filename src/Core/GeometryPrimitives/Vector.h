@@ -475,6 +475,12 @@ SCISHARE const TypeDescription* get_type_description(Vector*);
 }}
 /// @todo: This one is obsolete when dynamic compilation will be abandoned
 const std::string& Vector_get_h_file_path();
+
+template <>
+struct PioAsDoubles<Core::Geometry::Vector>
+{
+  static const size_t count = 3;
+};
 }
 
 #endif
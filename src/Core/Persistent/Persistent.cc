@@ -455,6 +455,16 @@ auto_istream(const std::string& filename, LoggerHandle pr)
   {
     return PiostreamPtr(new TextPiostream(filename, Piostream::Read, pr));
   }
+  else if (m1 == 'B' && m2 == 'C' && m3 == 'Z')
+  {
+    if (file_endian != Piostream::Little)
+    {
+      if (pr) pr->error("Block compressed file " + filename + " has a byte order that is not supported.");
+      else std::cerr << "ERROR - Block compressed file " << filename << " has a byte order that is not supported." << std::endl;
+      return PiostreamPtr();
+    }
+    return PiostreamPtr(new BlockCompressedPiostream(filename, Piostream::Read, version, pr));
+  }
 
   if (pr) pr->error(filename + " is an unknown type!");
   else std::cerr << filename << " is an unknown type!" << std::endl;
@@ -470,6 +480,7 @@ auto_ostream(const std::string& filename, const std::string& type, LoggerHandle
   //     Binary:  Return a BinaryPiostream 
   //     Fast:    Return FastPiostream
   //     Text:    Return a TextPiostream
+  //     Compressed: Return a BlockCompressedPiostream
   //     Default: Return BinaryPiostream 
   // NOTE: Binary will never return BinarySwap so we always write
   //       out the endianness of the machine we are on
@@ -486,6 +497,10 @@ auto_ostream(const std::string& filename, const std::string& type, LoggerHandle
   {
     stream = new FastPiostream(filename, Piostream::Write, pr);
   }
+  else if (type == "Compressed")
+  {
+    stream = new BlockCompressedPiostream(filename, Piostream::Write, -1, pr);
+  }
   else
   {
     stream = new BinaryPiostream(filename, Piostream::Write, -1, pr);
@@ -556,6 +571,8 @@ Piostream::readHeader( LoggerHandle pr,
   bool is_binary = false;
   if (hdr[4] == 'B' && hdr[5] == 'I' && hdr[6] == 'N' && hdr[7] == '\n')
     is_binary = true;
+  if (hdr[4] == 'B' && hdr[5] == 'C' && hdr[6] == 'Z' && hdr[7] == '\n')
+    is_binary = true;
   if(version > 1 && is_binary) 
   {
     // can only be BIG or LIT
@@ -180,6 +180,10 @@ class SCISHARE Piostream {
     
     // Returns true if block_io was supported (even on error).
     virtual bool block_io(void*, size_t, size_t) { return false; }
+
+    // Completes a stream that is being written, so that error() also covers
+    // data the stream still buffers; nothing may be written afterwards.
+    virtual void finish() {}
     
     void disable_pointer_hashing() { disable_pointer_hashing_ = true; }
 
@@ -32,6 +32,7 @@
 #define CORE_PERSISTENT_FWD_H 
 
 #include <Core/Persistent/share.h>
+#include <cstddef>
 
 namespace SCIRun {
 
@@ -41,5 +42,14 @@ namespace SCIRun {
 class Persistent;
 class Piostream;
 class Piostream;
+
+/// Number of doubles a T is made of, for types whose Pio writes just those
+/// doubles in memory order. Vectors of such types are read and written with
+/// one block_io call where the stream supports it. Zero for other types.
+template <class T>
+struct PioAsDoubles
+{
+  static const size_t count = 0;
+};
 }
 #endif
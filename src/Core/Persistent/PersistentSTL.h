@@ -164,6 +164,15 @@ void Pio(Piostream& stream, std::vector<T>& data)
     data.resize(size);
   }
 
+  static_assert(PioAsDoubles<T>::count == 0 || sizeof(T) == PioAsDoubles<T>::count * sizeof(double),
+    "PioAsDoubles count does not match the size of the type");
+  if (PioAsDoubles<T>::count != 0 && size > 0 &&
+      stream.block_io(&data.front(), sizeof(double), PioAsDoubles<T>::count * size))
+  {
+    stream.end_class();
+    return;
+  }
+
   for (int i = 0; i < size; i++)
   {
     Pio(stream, data[i]);
@@ -45,13 +45,16 @@
 #include <Core/Persistent/Pstreams.h>
 #include <Core/Logging/LoggerInterface.h>
 #include <Core/Utils/Legacy/StringUtil.h>
+#include <Core/Thread/Parallel.h>
 
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
 #include <teem/air.h>
 #include <teem/nrrd.h>
-#include <zlib.h>
 #endif
 
+#include <zlib.h>
+
+#include <algorithm>
 #include <string.h>
 #include <stdio.h>
 #include <fstream>
@@ -65,6 +68,7 @@
 #endif
 
 using namespace SCIRun::Core::Logging;
+using namespace SCIRun::Core::Thread;
 
 namespace SCIRun {
 
@@ -2061,4 +2065,575 @@ FastPiostream::block_io(void *data, size_t s, size_t nmemb)
 }
 
 
+////
+// BlockCompressedPiostream -- portable
+// Binary stream split into independently compressed blocks
+
+namespace
+{
+  // Trailer at the very end of the file. The index of the blocks starts at
+  // index_offset and is followed by the index of the block_io arrays.
+  struct BlockCompressedTrailer
+  {
+    boost::uint64_t index_offset;
+    boost::uint64_t num_blocks;
+    boost::uint64_t num_arrays;
+    boost::uint64_t block_size;
+    boost::uint64_t total_size;
+    char magic[8];
+  };
+
+  const char BLOCK_COMPRESSED_MAGIC[8] = { 'S', 'C', 'I', 'B', 'C', 'Z', '\n', '\0' };
+
+  // Number of blocks compressed or decompressed in one go
+  size_t block_batch_size()
+  {
+    return 4 * std::max(1u, Parallel::NumCores());
+  }
+
+  // fseek and ftell with 64 bit offsets, block compressed files can be larger than 2GB
+  int seek_file(FILE* fp, boost::int64_t offset, int whence)
+  {
+#ifdef _WIN32
+    return _fseeki64(fp, offset, whence);
+#else
+    return fseeko(fp, static_cast<off_t>(offset), whence);
+#endif
+  }
+
+  boost::int64_t tell_file(FILE* fp)
+  {
+#ifdef _WIN32
+    return _ftelli64(fp);
+#else
+    return ftello(fp);
+#endif
+  }
+}
+
+const size_t BlockCompressedPiostream::BLOCK_SIZE = 1 << 20;
+
+BlockCompressedPiostream::BlockCompressedPiostream(const std::string& filename,
+                                                   Direction dir, const int& v,
+                                                   LoggerHandle pr)
+  : Piostream(dir, v, filename, pr),
+    fp_(0),
+    finished_(false),
+    block_size_(BLOCK_SIZE),
+    total_size_(0),
+    batch_blocks_(block_batch_size()),
+    file_offset_(0),
+    position_(0),
+    cached_block_(static_cast<size_t>(-1))
+{
+  if (v == -1) // no version given so use PERSISTENT_VERSION
+    version_ = PERSISTENT_VERSION;
+  else
+    version_ = v;
+
+  if (version() == 1)
+  {
+    reporter_->error("Block compressed files require a persistent version above 1.");
+    err = true;
+    return;
+  }
+
+  if (dir == Read)
+  {
+    fp_ = fopen(filename.c_str(), "rb");
+    if (!fp_)
+    {
+      reporter_->error("Error opening file: " + filename + " for reading.");
+      err = true;
+      return;
+    }
+
+    if (!read_index())
+    {
+      reporter_->error("File " + filename + " has a damaged block index.");
+      err = true;
+      return;
+    }
+  }
+  else
+  {
+    fp_ = fopen(filename.c_str(), "wb");
+    if (!fp_)
+    {
+      reporter_->error("Error opening file '" + filename + "' for writing.");
+      err = true;
+      return;
+    }
+
+    // write out 16 bytes, but we need 17 for \0
+    char hdr[17];
+    sprintf(hdr, "SCI\nBCZ\n%03d\n%s", version_, endianness());
+    if (!fwrite(hdr, 1, 16, fp_))
+    {
+      reporter_->error("Header write failed.");
+      err = true;
+      return;
+    }
+    file_offset_ = 16;
+    pending_.reserve(batch_blocks_ * BLOCK_SIZE);
+  }
+}
+
+
+BlockCompressedPiostream::~BlockCompressedPiostream()
+{
+  if (!fp_) return;
+  finish();
+  fclose(fp_);
+}
+
+
+void
+BlockCompressedPiostream::finish()
+{
+  if (!fp_ || !writing() || finished_) return;
+  finished_ = true;
+  if (err) return;
+
+  compress_pending(true);
+  if (err) return;
+
+  BlockCompressedTrailer trailer;
+  trailer.index_offset = file_offset_;
+  trailer.num_blocks = blocks_.size();
+  trailer.num_arrays = arrays_.size();
+  trailer.block_size = block_size_;
+  trailer.total_size = total_size_;
+  memcpy(trailer.magic, BLOCK_COMPRESSED_MAGIC, sizeof(trailer.magic));
+
+  if ((!blocks_.empty() && fwrite(&blocks_[0], sizeof(Block), blocks_.size(), fp_) != blocks_.size()) ||
+      (!arrays_.empty() && fwrite(&arrays_[0], sizeof(Array), arrays_.size(), fp_) != arrays_.size()) ||
+      fwrite(&trailer, sizeof(trailer), 1, fp_) != 1 ||
+      fflush(fp_) != 0)
+  {
+    err = true;
+    reporter_->error("BlockCompressedPiostream error writing block index.");
+  }
+}
+
+
+bool
+BlockCompressedPiostream::read_index()
+{
+  BlockCompressedTrailer trailer;
+  if (seek_file(fp_, -static_cast<boost::int64_t>(sizeof(trailer)), SEEK_END) != 0 ||
+      fread(&trailer, sizeof(trailer), 1, fp_) != 1 ||
+      memcmp(trailer.magic, BLOCK_COMPRESSED_MAGIC, sizeof(trailer.magic)) != 0 ||
+      trailer.block_size == 0)
+  {
+    return false;
+  }
+
+  // Both indices lie between index_offset and the trailer
+  boost::int64_t end = 0;
+  if (seek_file(fp_, 0, SEEK_END) != 0 || (end = tell_file(fp_)) < 0 ||
+      trailer.index_offset > static_cast<boost::uint64_t>(end) ||
+      trailer.num_blocks > (end - trailer.index_offset) / sizeof(Block) ||
+      trailer.num_arrays > (end - trailer.index_offset) / sizeof(Array))
+  {
+    return false;
+  }
+
+  blocks_.resize(trailer.num_blocks);
+  arrays_.resize(trailer.num_arrays);
+  if (seek_file(fp_, trailer.index_offset, SEEK_SET) != 0 ||
+      (!blocks_.empty() && fread(&blocks_[0], sizeof(Block), blocks_.size(), fp_) != blocks_.size()) ||
+      (!arrays_.empty() && fread(&arrays_[0], sizeof(Array), arrays_.size(), fp_) != arrays_.size()))
+  {
+    return false;
+  }
+
+  // Every block but the last one holds exactly block_size bytes
+  boost::uint64_t total = 0;
+  for (size_t j = 0; j < blocks_.size(); j++)
+  {
+    if (blocks_[j].size > trailer.block_size ||
+        (j + 1 < blocks_.size() && blocks_[j].size != trailer.block_size) ||
+        blocks_[j].offset + blocks_[j].compressed_size > trailer.index_offset)
+    {
+      return false;
+    }
+    total += blocks_[j].size;
+  }
+  if (total != trailer.total_size) return false;
+  for (size_t j = 0; j < arrays_.size(); j++)
+  {
+    if (arrays_[j].offset > total || arrays_[j].size > total - arrays_[j].offset)
+      return false;
+  }
+
+  block_size_ = trailer.block_size;
+  total_size_ = trailer.total_size;
+  return true;
+}
+
+
+void
+BlockCompressedPiostream::compress_pending(bool last)
+{
+  const size_t num_blocks = last ? (pending_.size() + BLOCK_SIZE - 1) / BLOCK_SIZE
+                                 : pending_.size() / BLOCK_SIZE;
+  if (num_blocks == 0) return;
+
+  std::vector<std::vector<Bytef> > compressed(num_blocks);
+  std::vector<int> status(num_blocks, Z_OK);
+  const char* src = &pending_[0];
+  const size_t available = pending_.size();
+
+  Parallel::For(0, num_blocks, [&](size_t begin, size_t end)
+  {
+    for (size_t j = begin; j < end; j++)
+    {
+      const size_t offset = j * BLOCK_SIZE;
+      const uLong size = static_cast<uLong>(std::min(BLOCK_SIZE, available - offset));
+      uLongf csize = compressBound(size);
+      compressed[j].resize(csize);
+      status[j] = compress2(&compressed[j][0], &csize,
+        reinterpret_cast<const Bytef*>(src + offset), size, Z_DEFAULT_COMPRESSION);
+      compressed[j].resize(csize);
+    }
+  }, 1);
+
+  size_t written = 0;
+  for (size_t j = 0; j < num_blocks; j++)
+  {
+    if (status[j] != Z_OK ||
+        fwrite(&compressed[j][0], 1, compressed[j].size(), fp_) != compressed[j].size())
+    {
+      err = true;
+      reporter_->error("BlockCompressedPiostream error writing compressed block.");
+      return;
+    }
+
+    Block block;
+    block.offset = file_offset_;
+    block.compressed_size = static_cast<boost::uint32_t>(compressed[j].size());
+    block.size = static_cast<boost::uint32_t>(std::min(BLOCK_SIZE, available - written));
+    blocks_.push_back(block);
+
+    file_offset_ += block.compressed_size;
+    written += block.size;
+  }
+
+  pending_.erase(pending_.begin(), pending_.begin() + written);
+}
+
+
+void
+BlockCompressedPiostream::write_bytes(const void* data, size_t size)
+{
+  if (err) return;
+  if (finished_)
+  {
+    err = true;
+    reporter_->error("BlockCompressedPiostream written to after it was finished.");
+    return;
+  }
+
+  const char* src = static_cast<const char*>(data);
+  const size_t batch = batch_blocks_ * BLOCK_SIZE;
+  total_size_ += size;
+
+  while (size > 0)
+  {
+    const size_t count = std::min(size, batch - pending_.size());
+    pending_.insert(pending_.end(), src, src + count);
+    src += count;
+    size -= count;
+    if (pending_.size() == batch) compress_pending(false);
+  }
+}
+
+
+bool
+BlockCompressedPiostream::decompress_blocks(size_t first, size_t count, char* dest)
+{
+  // Blocks are stored back to back, so they can be read in one go
+  const Block& front = blocks_[first];
+  const Block& back = blocks_[first + count - 1];
+  std::vector<Bytef> compressed(back.offset + back.compressed_size - front.offset);
+
+  if (seek_file(fp_, front.offset, SEEK_SET) != 0 ||
+      fread(&compressed[0], 1, compressed.size(), fp_) != compressed.size())
+  {
+    return false;
+  }
+
+  std::vector<int> status(count, Z_OK);
+  Parallel::For(0, count, [&](size_t begin, size_t end)
+  {
+    for (size_t j = begin; j < end; j++)
+    {
+      const Block& block = blocks_[first + j];
+      uLongf size = block.size;
+      status[j] = uncompress(reinterpret_cast<Bytef*>(dest + j * block_size_), &size,
+        &compressed[block.offset - front.offset], block.compressed_size);
+      if (status[j] == Z_OK && size != block.size) status[j] = Z_DATA_ERROR;
+    }
+  }, 1);
+
+  return std::find_if(status.begin(), status.end(), [](int s) { return s != Z_OK; }) == status.end();
+}
+
+
+bool
+BlockCompressedPiostream::read_bytes(void* data, size_t size)
+{
+  if (err) return false;
+  if (position_ + size > total_size_) return false;
+
+  char* dest = static_cast<char*>(data);
+  const size_t batch = batch_blocks_;
+
+  while (size > 0)
+  {
+    const size_t block = static_cast<size_t>(position_ / block_size_);
+    const size_t offset = static_cast<size_t>(position_ % block_size_);
+
+    // Whole blocks go straight into the destination
+    size_t whole = 0;
+    if (offset == 0)
+    {
+      while (block + whole < blocks_.size() && whole < batch &&
+             blocks_[block + whole].size <= size - whole * block_size_)
+      {
+        whole++;
+      }
+    }
+
+    if (whole > 0)
+    {
+      if (!decompress_blocks(block, whole, dest)) return false;
+      size_t count = 0;
+      for (size_t j = 0; j < whole; j++) count += blocks_[block + j].size;
+      dest += count;
+      size -= count;
+      position_ += count;
+      continue;
+    }
+
+    if (block != cached_block_)
+    {
+      cache_.resize(blocks_[block].size);
+      if (!decompress_blocks(block, 1, &cache_[0])) return false;
+      cached_block_ = block;
+    }
+
+    const size_t count = std::min(size, cache_.size() - offset);
+    memcpy(dest, &cache_[offset], count);
+    dest += count;
+    size -= count;
+    position_ += count;
+  }
+  return true;
+}
+
+
+bool
+BlockCompressedPiostream::seek(boost::uint64_t position)
+{
+  if (err || !reading() || position > total_size_) return false;
+  position_ = position;
+  return true;
+}
+
+
+bool
+BlockCompressedPiostream::seek_array(size_t n)
+{
+  if (n >= arrays_.size()) return false;
+  return seek(arrays_[n].offset);
+}
+
+
+void
+BlockCompressedPiostream::reset_post_header()
+{
+  if (!reading()) return;
+  position_ = 0;
+}
+
+
+const char *
+BlockCompressedPiostream::endianness()
+{
+  return "LIT\n";
+}
+
+
+template <class T>
+inline void
+BlockCompressedPiostream::gen_io(T& data, const char *iotype)
+{
+  if (err) return;
+  if (dir == Read)
+  {
+    if (!read_bytes(&data, sizeof(data)))
+    {
+      err = true;
+      reporter_->error(std::string("BlockCompressedPiostream error reading ") +
+                       iotype + ".");
+    }
+  }
+  else
+  {
+    write_bytes(&data, sizeof(data));
+  }
+}
+
+
+void
+BlockCompressedPiostream::io(char& data)
+{
+  gen_io(data, "char");
+}
+
+
+void
+BlockCompressedPiostream::io(signed char& data)
+{
+  gen_io(data, "signed char");
+}
+
+
+void
+BlockCompressedPiostream::io(unsigned char& data)
+{
+  gen_io(data, "unsigned char");
+}
+
+
+void
+BlockCompressedPiostream::io(short& data)
+{
+  gen_io(data, "short");
+}
+
+
+void
+BlockCompressedPiostream::io(unsigned short& data)
+{
+  gen_io(data, "unsigned short");
+}
+
+
+void
+BlockCompressedPiostream::io(int& data)
+{
+  gen_io(data, "int");
+}
+
+
+void
+BlockCompressedPiostream::io(unsigned int& data)
+{
+  gen_io(data, "unsigned int");
+}
+
+
+void
+BlockCompressedPiostream::io(long& data)
+{
+  // Stored as 32 bits, as in BinaryPiostream
+  int tmp = data;
+  gen_io(tmp, "long");
+  data = tmp;
+}
+
+
+void
+BlockCompressedPiostream::io(unsigned long& data)
+{
+  // Stored as 32 bits, as in BinaryPiostream
+  unsigned int tmp = data;
+  gen_io(tmp, "unsigned long");
+  data = tmp;
+}
+
+
+void
+BlockCompressedPiostream::io(long long& data)
+{
+  gen_io(data, "long long");
+}
+
+
+void
+BlockCompressedPiostream::io(unsigned long long& data)
+{
+  gen_io(data, "unsigned long long");
+}
+
+
+void
+BlockCompressedPiostream::io(double& data)
+{
+  gen_io(data, "double");
+}
+
+
+void
+BlockCompressedPiostream::io(float& data)
+{
+  gen_io(data, "float");
+}
+
+
+void
+BlockCompressedPiostream::io(std::string& data)
+{
+  if (err) return;
+  unsigned int chars = 0;
+  if (dir == Write)
+  {
+    const char* p = data.c_str();
+    chars = static_cast<int>(strlen(p)) + 1;
+    io(chars);
+    write_bytes(p, chars);
+  }
+  else
+  {
+    io(chars);
+    if (err) return;
+    std::vector<char> buf(chars + 1, '\0');
+    if (!read_bytes(&buf[0], chars))
+    {
+      err = true;
+      reporter_->error("BlockCompressedPiostream error reading string.");
+      return;
+    }
+    data = std::string(&buf[0]);
+  }
+}
+
+
+bool
+BlockCompressedPiostream::block_io(void *data, size_t s, size_t nmemb)
+{
+  if (err) { return false; }
+  if (dir == Read)
+  {
+    if (!read_bytes(data, s * nmemb))
+    {
+      err = true;
+      reporter_->error("BlockCompressedPiostream error reading block io.");
+    }
+  }
+  else
+  {
+    Array array;
+    array.offset = total_size_;
+    array.size = s * nmemb;
+    write_bytes(data, s * nmemb);
+    if (!err) arrays_.push_back(array);
+  }
+  return true;
+}
+
+
 } // End namespace SCIRun
@@ -43,8 +43,10 @@
 #define SCI_project_Pstream_h 1
 
 #include <Core/Persistent/Persistent.h>
+#include <boost/cstdint.hpp>
 #include <cstdio>
 #include <iosfwd>
+#include <vector>
 
 #include <Core/Persistent/share.h>
 
@@ -197,6 +199,100 @@ public:
 };
 
 
+/// Binary stream stored as independently compressed zlib blocks of a fixed
+/// uncompressed size, followed by an index of the blocks. Blocks are
+/// compressed and decompressed on the thread pool, and block_io only
+/// decompresses the blocks that overlap the requested array. The byte
+/// stream inside the blocks is identical to BinaryPiostream.
+class SCISHARE BlockCompressedPiostream : public Piostream {
+public:
+  /// Uncompressed size of every block but the last
+  static const size_t BLOCK_SIZE;
+
+  BlockCompressedPiostream(const std::string& filename, Direction dir,
+                           const int& v = -1, Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
+  virtual ~BlockCompressedPiostream();
+
+  virtual void io(char&);
+  virtual void io(signed char&);
+  virtual void io(unsigned char&);
+  virtual void io(short&);
+  virtual void io(unsigned short&);
+  virtual void io(int&);
+  virtual void io(unsigned int&);
+  virtual void io(long&);
+  virtual void io(unsigned long&);
+  virtual void io(long long&);
+  virtual void io(unsigned long long&);
+  virtual void io(double&);
+  virtual void io(float&);
+  virtual void io(std::string& str);
+
+  virtual bool supports_block_io() { return true; }
+  virtual bool block_io(void*, size_t, size_t);
+
+  /// Writes the last blocks and the index; failures set error().
+  virtual void finish();
+
+  /// Reading: position in the uncompressed stream.
+  boost::uint64_t tell() const { return position_; }
+  /// Reading: moves to an uncompressed position. Only the blocks that the next
+  /// read overlaps are decompressed.
+  bool seek(boost::uint64_t position);
+
+  /// Reading: the arrays written with block_io, in the order they were written.
+  size_t num_arrays() const { return arrays_.size(); }
+  boost::uint64_t array_size(size_t n) const { return arrays_[n].size; }
+  /// Reading: moves to the start of the n-th array.
+  bool seek_array(size_t n);
+
+protected:
+  virtual const char *endianness();
+  virtual void reset_post_header();
+
+private:
+  struct Block
+  {
+    boost::uint64_t offset;
+    boost::uint32_t compressed_size;
+    boost::uint32_t size;
+  };
+
+  /// Position and size in bytes of a block_io array in the uncompressed stream
+  struct Array
+  {
+    boost::uint64_t offset;
+    boost::uint64_t size;
+  };
+
+  template <class T> void gen_io(T&, const char *);
+  bool read_bytes(void* data, size_t size);
+  void write_bytes(const void* data, size_t size);
+  bool read_index();
+  void compress_pending(bool last);
+  bool decompress_blocks(size_t first, size_t count, char* dest);
+
+  FILE* fp_;
+  std::vector<Block> blocks_;
+  std::vector<Array> arrays_;
+  /// Writing: the index has been written
+  bool finished_;
+  boost::uint64_t block_size_;
+  boost::uint64_t total_size_;
+  /// Number of blocks compressed or decompressed in one parallel pass
+  size_t batch_blocks_;
+  /// Writing: position in the file of the next block
+  boost::uint64_t file_offset_;
+  /// Writing: uncompressed data that has not been compressed yet
+  std::vector<char> pending_;
+  /// Reading: position in the uncompressed stream
+  boost::uint64_t position_;
+  /// Reading: last decompressed block, for small reads
+  size_t cached_block_;
+  std::vector<char> cache_;
+};
+
+
 } // End namespace SCIRun
 
 
@@ -0,0 +1,216 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Persistent/Pstreams.h>
+#include <Core/Persistent/PersistentSTL.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+using namespace SCIRun;
+
+class BlockCompressedPiostreamTests : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    filename_ = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("pstream-%%%%%%%%.fld")).string();
+  }
+
+  virtual void TearDown()
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove(filename_, ec);
+  }
+
+  std::string filename_;
+};
+
+namespace
+{
+  // Mildly compressible data that spans several blocks
+  std::vector<double> makeValues(size_t n)
+  {
+    std::vector<double> values(n);
+    for (size_t i = 0; i < n; i++)
+      values[i] = static_cast<double>(i % 1000) * 0.5 + static_cast<double>(i / 1000);
+    return values;
+  }
+}
+
+TEST_F(BlockCompressedPiostreamTests, MixedDataRoundTrips)
+{
+  const std::vector<double> values = makeValues(3 * BlockCompressedPiostream::BLOCK_SIZE / sizeof(double) + 17);
+  {
+    PiostreamPtr stream = auto_ostream(filename_, "Compressed", nullptr);
+    ASSERT_FALSE(stream->error());
+    int i = -42;
+    std::string s = "block compressed";
+    char c = 'x';
+    long long ll = 1LL << 40;
+    float f = 2.5f;
+    std::vector<double> v = values;
+    Pio(*stream, i);
+    Pio(*stream, s);
+    Pio(*stream, c);
+    Pio(*stream, v);
+    Pio(*stream, ll);
+    Pio(*stream, f);
+    EXPECT_FALSE(stream->error());
+  }
+
+  PiostreamPtr stream = auto_istream(filename_, nullptr);
+  ASSERT_TRUE(stream != nullptr);
+  ASSERT_TRUE(dynamic_cast<BlockCompressedPiostream*>(stream.get()) != nullptr);
+
+  int i;
+  std::string s;
+  char c;
+  long long ll;
+  float f;
+  std::vector<double> v;
+  Pio(*stream, i);
+  Pio(*stream, s);
+  Pio(*stream, c);
+  Pio(*stream, v);
+  Pio(*stream, ll);
+  Pio(*stream, f);
+  EXPECT_FALSE(stream->error());
+  EXPECT_EQ(-42, i);
+  EXPECT_EQ("block compressed", s);
+  EXPECT_EQ('x', c);
+  EXPECT_EQ(values, v);
+  EXPECT_EQ(1LL << 40, ll);
+  EXPECT_EQ(2.5f, f);
+}
+
+TEST_F(BlockCompressedPiostreamTests, CompressesRepetitiveData)
+{
+  std::vector<int> zeros(4 * BlockCompressedPiostream::BLOCK_SIZE / sizeof(int), 7);
+  {
+    BlockCompressedPiostream stream(filename_, Piostream::Write);
+    Pio(stream, zeros);
+  }
+  EXPECT_LT(boost::filesystem::file_size(filename_), zeros.size() * sizeof(int) / 100);
+
+  BlockCompressedPiostream stream(filename_, Piostream::Read);
+  std::vector<int> result;
+  Pio(stream, result);
+  EXPECT_FALSE(stream.error());
+  EXPECT_EQ(zeros, result);
+}
+
+TEST_F(BlockCompressedPiostreamTests, EmptyStreamRoundTrips)
+{
+  {
+    BlockCompressedPiostream stream(filename_, Piostream::Write);
+  }
+  BlockCompressedPiostream stream(filename_, Piostream::Read);
+  EXPECT_FALSE(stream.error());
+  int i = 0;
+  stream.io(i);
+  EXPECT_TRUE(stream.error());
+}
+
+TEST_F(BlockCompressedPiostreamTests, ReadingPastTheEndFails)
+{
+  {
+    BlockCompressedPiostream stream(filename_, Piostream::Write);
+    std::vector<double> v = makeValues(100);
+    stream.block_io(&v[0], sizeof(double), v.size());
+  }
+  BlockCompressedPiostream stream(filename_, Piostream::Read);
+  std::vector<double> v(101);
+  stream.block_io(&v[0], sizeof(double), v.size());
+  EXPECT_TRUE(stream.error());
+}
+
+TEST_F(BlockCompressedPiostreamTests, RejectsDamagedIndex)
+{
+  {
+    BlockCompressedPiostream stream(filename_, Piostream::Write);
+    std::vector<double> v = makeValues(1000);
+    Pio(stream, v);
+  }
+  boost::filesystem::resize_file(filename_, boost::filesystem::file_size(filename_) - 4);
+  BlockCompressedPiostream stream(filename_, Piostream::Read);
+  EXPECT_TRUE(stream.error());
+}
+
+TEST_F(BlockCompressedPiostreamTests, SeeksToArraysThroughTheIndex)
+{
+  const std::vector<double> first = makeValues(2 * BlockCompressedPiostream::BLOCK_SIZE / sizeof(double) + 5);
+  std::vector<int> second(BlockCompressedPiostream::BLOCK_SIZE / sizeof(int) + 3);
+  for (size_t i = 0; i < second.size(); i++)
+    second[i] = static_cast<int>(i * 3);
+  {
+    BlockCompressedPiostream stream(filename_, Piostream::Write);
+    int header = 11;
+    stream.io(header);
+    stream.block_io(const_cast<double*>(&first[0]), sizeof(double), first.size());
+    stream.block_io(&second[0], sizeof(int), second.size());
+    stream.finish();
+    EXPECT_FALSE(stream.error());
+  }
+
+  BlockCompressedPiostream stream(filename_, Piostream::Read);
+  ASSERT_FALSE(stream.error());
+  ASSERT_EQ(2u, stream.num_arrays());
+  EXPECT_EQ(second.size() * sizeof(int), stream.array_size(1));
+
+  // the second array first, then back to the first one
+  std::vector<int> secondRead(second.size());
+  ASSERT_TRUE(stream.seek_array(1));
+  stream.block_io(&secondRead[0], sizeof(int), secondRead.size());
+  EXPECT_EQ(second, secondRead);
+
+  std::vector<double> firstRead(first.size());
+  ASSERT_TRUE(stream.seek_array(0));
+  EXPECT_EQ(sizeof(int), stream.tell());
+  stream.block_io(&firstRead[0], sizeof(double), firstRead.size());
+  EXPECT_EQ(first, firstRead);
+
+  ASSERT_TRUE(stream.seek(0));
+  int header = 0;
+  stream.io(header);
+  EXPECT_EQ(11, header);
+  EXPECT_FALSE(stream.seek_array(2));
+  EXPECT_FALSE(stream.error());
+}
+
+TEST_F(BlockCompressedPiostreamTests, IndexWriteFailureSetsTheErrorState)
+{
+  if (!boost::filesystem::exists("/dev/full"))
+    return;
+  BlockCompressedPiostream stream("/dev/full", Piostream::Write);
+  ASSERT_FALSE(stream.error());
+  std::vector<double> v = makeValues(1000);
+  stream.block_io(&v[0], sizeof(double), v.size());
+  stream.finish();
+  EXPECT_TRUE(stream.error());
+}
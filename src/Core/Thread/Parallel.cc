@@ -27,6 +27,7 @@
  */
 
 #include <Core/Thread/Parallel.h>
+#include <Core/Thread/ThreadPool.h>
 #include <Core/Logging/Log.h>
 #include <boost/thread/thread.hpp>
 #include <vector>
@@ -37,22 +38,12 @@ using namespace SCIRun::Core::Logging;
 
 void Parallel::RunTasks(IndexedTask task, int numProcs)
 {
-  boost::thread_group threads;
-
-  for (int i = 0; i < capByUserCoreCount(numProcs); ++i)
-  {
-    threads.create_thread(boost::bind(task, i));
-  }
+  ThreadPool::global().runConcurrently(task, capByUserCoreCount(numProcs));
+}
 
-  try
-  {
-    threads.join_all();
-  }
-  catch (boost::thread_interrupted&)
-  {
-    threads.interrupt_all();
-    throw;
-  }
+void Parallel::For(size_t begin, size_t end, RangeTask body, size_t grainSize)
+{
+  ThreadPool::global().parallelFor(begin, end, grainSize, NumCores(), body);
 }
 
 unsigned int Parallel::NumCores()
@@ -43,7 +43,11 @@ namespace Thread
   {
   public:
     typedef boost::function<void(int)> IndexedTask;
+    typedef boost::function<void(size_t, size_t)> RangeTask;
+    /// Runs task(0)..task(numProcs-1) concurrently on the shared thread pool; tasks may sync on a Barrier.
     static void RunTasks(IndexedTask task, int numProcs);
+    /// Runs body over consecutive chunks [b, e) of [begin, end) on the shared thread pool.
+    static void For(size_t begin, size_t end, RangeTask body, size_t grainSize = 0);
     static unsigned int NumCores();
     static void SetMaximumCores(unsigned int max);
   private:
@@ -29,9 +29,15 @@
 #include <gtest/gtest.h>
 #include <numeric>
 #include <fstream>
+#include <atomic>
+#include <cmath>
 
 #include <Core/Thread/Parallel.h>
+#include <Core/Thread/Barrier.h>
+#include <Core/Thread/Interruptible.h>
 #include <boost/filesystem/path.hpp>
+#include <boost/thread/thread.hpp>
+#include <chrono>
 #include <Testing/Utils/SCIRunUnitTests.h>
 
 using namespace SCIRun::Core::Thread;
@@ -52,6 +58,138 @@ TEST(ParallelTests, CanDoubleNumberInParallel)
   EXPECT_EQ(expectedSum * 2, std::accumulate(nums.begin(), nums.end(), 0, std::plus<int>()));
 }
 
+TEST(ParallelTests, TasksCanSynchronizeOnBarrier)
+{
+  const int np = Parallel::NumCores() + 2;
+  Barrier barrier("ParallelTests", np);
+  std::vector<int> phase(np, 0);
+  std::atomic<int> mismatches(0);
+
+  Parallel::RunTasks([&](int i)
+  {
+    phase[i] = 1;
+    barrier.wait();
+    for (int j = 0; j < np; ++j)
+      if (phase[j] != 1)
+        ++mismatches;
+    barrier.wait();
+  }, np);
+
+  EXPECT_EQ(0, mismatches);
+}
+
+TEST(ParallelTests, CanNestRunTasks)
+{
+  const int outer = 4, inner = 3;
+  std::atomic<int> count(0);
+  Parallel::RunTasks([&](int)
+  {
+    Barrier barrier("inner", inner);
+    Parallel::RunTasks([&](int) { barrier.wait(); ++count; }, inner);
+  }, outer);
+  EXPECT_EQ(outer * inner, count);
+}
+
+TEST(ParallelTests, CanDoubleNumbersWithParallelFor)
+{
+  const size_t size = 100000;
+  std::vector<int> nums(size);
+  std::iota(nums.begin(), nums.end(), 0);
+
+  Parallel::For(0, size, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i)
+      nums[i] *= 2;
+  }, 1000);
+
+  for (size_t i = 0; i < size; ++i)
+    ASSERT_EQ(2 * static_cast<int>(i), nums[i]);
+}
+
+TEST(ParallelTests, NestedParallelForCoversWholeRange)
+{
+  std::atomic<int> count(0);
+  Parallel::For(0, 64, [&](size_t b, size_t e)
+  {
+    for (size_t i = b; i < e; ++i)
+      Parallel::For(0, 100, [&](size_t b2, size_t e2) { count += static_cast<int>(e2 - b2); }, 10);
+  }, 1);
+  EXPECT_EQ(6400, count);
+}
+
+TEST(ParallelTests, ExceptionInTaskIsRethrownToCaller)
+{
+  EXPECT_THROW(Parallel::For(0, 1000, [](size_t b, size_t e)
+  {
+    if (b <= 500 && 500 < e)
+      throw std::runtime_error("task failure");
+  }, 10), std::runtime_error);
+}
+
+TEST(ParallelTests, InterruptingCallerCancelsTasks)
+{
+  std::atomic<int> started(0);
+  boost::thread caller([&]()
+  {
+    Parallel::RunTasks([&](int)
+    {
+      ++started;
+      for (;;)
+      {
+        Interruptible::checkForInterruption();
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+      }
+    }, 4);
+  });
+  while (started < 4)
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+  caller.interrupt();
+  EXPECT_TRUE(caller.try_join_for(boost::chrono::seconds(10)));
+}
+
+namespace
+{
+  void spawnPerCall(const Parallel::IndexedTask& task, int numProcs)
+  {
+    boost::thread_group threads;
+    for (int i = 0; i < numProcs; ++i)
+      threads.create_thread(boost::bind(task, i));
+    threads.join_all();
+  }
+
+  template <class Runner>
+  double timeSmallTasks(Runner run, int calls, size_t workPerCall)
+  {
+    const int np = Parallel::NumCores();
+    std::vector<double> out(np);
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < calls; ++c)
+    {
+      run([&](int i)
+      {
+        double sum = 0;
+        for (size_t k = 0; k < workPerCall; ++k)
+          sum += std::sqrt(static_cast<double>(k + i));
+        out[i] = sum;
+      }, np);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+}
+
+TEST(ParallelBenchmark, DISABLED_PersistentPoolAgainstSpawnPerCall)
+{
+  const int calls = 2000;
+  for (size_t work : { 0, 1000, 100000 })
+  {
+    const int n = work > 10000 ? calls / 20 : calls;
+    double spawn = timeSmallTasks(spawnPerCall, n, work);
+    double pool = timeSmallTasks(Parallel::RunTasks, n, work);
+    std::cout << "work/task " << work << ", " << n << " calls: spawn-per-call " << spawn
+      << " s, persistent pool " << pool << " s, speedup " << spawn / pool << std::endl;
+  }
+}
+
 /// @todo
 #if 0
 TEST(ParallelTests, CanDoubleNumberWithParallelForEach)
@@ -0,0 +1,523 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#include <Core/Thread/ThreadPool.h>
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <algorithm>
+#include <exception>
+
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  thread_local ThreadPool* currentPool = nullptr;
+  thread_local size_t currentWorker = 0;
+}
+
+struct ThreadPool::Worker
+{
+  Worker() : currentGroup(nullptr) {}
+  boost::mutex mutex;
+  // owner pushes and pops at the back, thieves take from the front
+  std::deque<WorkItem> tasks;
+  const detail::TaskGroupState* currentGroup;
+  boost::thread thread;
+};
+
+namespace SCIRun
+{
+namespace Core
+{
+namespace Thread
+{
+namespace detail
+{
+  class TaskGroupState : boost::noncopyable
+  {
+  public:
+    explicit TaskGroupState(ThreadPool& pool) : pool_(pool), pending_(0), cancelled_(false) {}
+
+    void added()
+    {
+      ++pending_;
+    }
+
+    void invoke(const ThreadPool::Task& task)
+    {
+      if (!cancelled_)
+      {
+        try
+        {
+          task();
+        }
+        catch (...)
+        {
+          fail(std::current_exception());
+        }
+      }
+      finished();
+    }
+
+    void fail(std::exception_ptr error)
+    {
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        if (!error_)
+          error_ = error;
+      }
+      cancel();
+    }
+
+    void cancel()
+    {
+      if (!cancelled_.exchange(true))
+        pool_.interruptWorkersRunning(this);
+    }
+
+    bool cancelled() const { return cancelled_; }
+    bool done() const { return pending_ == 0; }
+
+    void waitBriefly()
+    {
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      if (pending_ > 0)
+        done_.wait_for(lock, boost::chrono::milliseconds(1));
+    }
+
+    void rethrowIfFailed()
+    {
+      std::exception_ptr error;
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        std::swap(error, error_);
+      }
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+  private:
+    void finished()
+    {
+      if (--pending_ == 0)
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        done_.notify_all();
+      }
+    }
+
+    ThreadPool& pool_;
+    std::atomic<int> pending_;
+    std::atomic<bool> cancelled_;
+    std::exception_ptr error_;
+    boost::mutex mutex_;
+    boost::condition_variable done_;
+  };
+}
+}}}
+
+ThreadPool::ThreadPool(unsigned int numWorkers) : workers_(MaxWorkers), numWorkers_(0), pending_(0),
+  injectedPending_(0), gangPending_(0), gangCommitted_(0), shutdown_(false)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  numWorkers = std::min<size_t>(std::max(1u, numWorkers), MaxWorkers);
+  while (numWorkers_ < numWorkers)
+    addWorker();
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  wake_.notify_all();
+  for (size_t i = 0; i < numWorkers_; ++i)
+    workers_[i]->thread.join();
+}
+
+ThreadPool& ThreadPool::global()
+{
+  // never destroyed: workers may still be parked when static destructors run at exit
+  static ThreadPool* pool = new ThreadPool(std::max(2u, boost::thread::hardware_concurrency()) - 1);
+  return *pool;
+}
+
+unsigned int ThreadPool::numWorkers() const
+{
+  return static_cast<unsigned int>(numWorkers_);
+}
+
+bool ThreadPool::isWorkerThread() const
+{
+  return currentPool == this;
+}
+
+void ThreadPool::addWorker()
+{
+  const size_t index = numWorkers_;
+  workers_[index].reset(new Worker);
+  {
+    boost::lock_guard<boost::mutex> lock(workers_[index]->mutex);
+    workers_[index]->thread = boost::thread(boost::bind(&ThreadPool::workerLoop, this, index));
+  }
+  numWorkers_ = index + 1;
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+  currentPool = this;
+  currentWorker = index;
+
+  // interruption is only meaningful while a task runs, see interruptWorkersRunning
+  boost::this_thread::disable_interruption noInterrupts;
+  for (;;)
+  {
+    WorkItem item;
+    if (tryPop(item, true))
+    {
+      boost::this_thread::restore_interruption allowInterrupts(noInterrupts);
+      execute(item);
+      continue;
+    }
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while (!shutdown_ && pending_ == 0)
+      wake_.wait(lock);
+    if (shutdown_ && pending_ == 0)
+      return;
+  }
+}
+
+void ThreadPool::submit(const WorkItem& item, bool gang)
+{
+  ++pending_;
+  if (gang)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    gang_.push_back(item);
+    ++gangPending_;
+  }
+  else if (isWorkerThread())
+  {
+    Worker& worker = *workers_[currentWorker];
+    boost::lock_guard<boost::mutex> lock(worker.mutex);
+    worker.tasks.push_back(item);
+  }
+  else
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    injected_.push_back(item);
+    ++injectedPending_;
+  }
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+  }
+  wake_.notify_one();
+}
+
+bool ThreadPool::tryPop(WorkItem& item, bool takeGangWork)
+{
+  if (takeGangWork && gangPending_ > 0)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    if (!gang_.empty())
+    {
+      item = gang_.front();
+      gang_.pop_front();
+      --gangPending_;
+      --pending_;
+      return true;
+    }
+  }
+
+  const bool onWorker = isWorkerThread();
+  if (onWorker)
+  {
+    Worker& worker = *workers_[currentWorker];
+    boost::lock_guard<boost::mutex> lock(worker.mutex);
+    if (!worker.tasks.empty())
+    {
+      item = worker.tasks.back();
+      worker.tasks.pop_back();
+      --pending_;
+      return true;
+    }
+  }
+
+  if (injectedPending_ > 0)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    if (!injected_.empty())
+    {
+      item = injected_.front();
+      injected_.pop_front();
+      --injectedPending_;
+      --pending_;
+      return true;
+    }
+  }
+
+  const size_t count = numWorkers_;
+  const size_t start = onWorker ? currentWorker + 1 : 0;
+  for (size_t k = 0; k < count; ++k)
+  {
+    const size_t victim = (start + k) % count;
+    if (onWorker && victim == currentWorker)
+      continue;
+    Worker& worker = *workers_[victim];
+    boost::lock_guard<boost::mutex> lock(worker.mutex);
+    if (!worker.tasks.empty())
+    {
+      item = worker.tasks.front();
+      worker.tasks.pop_front();
+      --pending_;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::helpOnce()
+{
+  WorkItem item;
+  if (!tryPop(item, false))
+    return false;
+  execute(item);
+  return true;
+}
+
+void ThreadPool::execute(WorkItem& item)
+{
+  Worker* worker = isWorkerThread() ? workers_[currentWorker].get() : nullptr;
+  const detail::TaskGroupState* previous = nullptr;
+  if (worker)
+  {
+    boost::lock_guard<boost::mutex> lock(worker->mutex);
+    previous = worker->currentGroup;
+    worker->currentGroup = item.group.get();
+  }
+
+  item.group->invoke(item.task);
+
+  if (worker)
+  {
+    {
+      boost::lock_guard<boost::mutex> lock(worker->mutex);
+      worker->currentGroup = previous;
+    }
+    // drop an interruption aimed at the finished task so it does not leak into the next one
+    if (boost::this_thread::interruption_enabled())
+    {
+      try
+      {
+        boost::this_thread::interruption_point();
+      }
+      catch (boost::thread_interrupted&)
+      {
+      }
+    }
+    if (previous && previous->cancelled())
+      worker->thread.interrupt();
+  }
+  item = WorkItem();
+}
+
+void ThreadPool::interruptWorkersRunning(const detail::TaskGroupState* group)
+{
+  const size_t count = numWorkers_;
+  for (size_t i = 0; i < count; ++i)
+  {
+    Worker& worker = *workers_[i];
+    boost::lock_guard<boost::mutex> lock(worker.mutex);
+    if (worker.currentGroup == group)
+      worker.thread.interrupt();
+  }
+}
+
+bool ThreadPool::reserveGangWorkers(unsigned int count)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  if (gangCommitted_ + count > MaxWorkers)
+    return false;
+  gangCommitted_ += count;
+  while (numWorkers_ < gangCommitted_)
+    addWorker();
+  return true;
+}
+
+void ThreadPool::releaseGangWorkers(unsigned int count)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  gangCommitted_ -= count;
+}
+
+void ThreadPool::runConcurrently(const IndexedTask& task, int count)
+{
+  if (count <= 0)
+    return;
+  if (count == 1)
+  {
+    task(0);
+    return;
+  }
+
+  // a worker that blocks in task(0) is unavailable to the gang as well
+  const unsigned int needed = count - 1 + (isWorkerThread() ? 1 : 0);
+  if (!reserveGangWorkers(needed))
+  {
+    boost::thread_group threads;
+    for (int i = 0; i < count; ++i)
+      threads.create_thread(boost::bind(task, i));
+    try
+    {
+      threads.join_all();
+    }
+    catch (boost::thread_interrupted&)
+    {
+      threads.interrupt_all();
+      throw;
+    }
+    return;
+  }
+
+  struct Reservation
+  {
+    Reservation(ThreadPool& pool, unsigned int count) : pool_(pool), count_(count) {}
+    ~Reservation() { pool_.releaseGangWorkers(count_); }
+    ThreadPool& pool_;
+    unsigned int count_;
+  } reservation(*this, needed);
+
+  TaskGroup group(*this);
+  for (int i = 1; i < count; ++i)
+    group.runGang(boost::bind(task, i));
+  group.runAndWait(boost::bind(task, 0));
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grainSize, unsigned int maxConcurrency, const RangeTask& body)
+{
+  if (end <= begin)
+    return;
+
+  const size_t count = end - begin;
+  const size_t concurrency = std::max(1u, maxConcurrency);
+  const size_t grain = grainSize > 0 ? grainSize : std::max<size_t>(1, count / (concurrency * 8));
+  const size_t numChunks = (count + grain - 1) / grain;
+  const size_t runners = std::min(numChunks, concurrency);
+  if (runners <= 1)
+  {
+    body(begin, end);
+    return;
+  }
+
+  std::atomic<size_t> nextChunk(0);
+  TaskGroup group(*this);
+  auto runChunks = [&]()
+  {
+    for (size_t chunk = nextChunk++; chunk < numChunks && !group.isCancelled(); chunk = nextChunk++)
+    {
+      const size_t first = begin + chunk * grain;
+      body(first, std::min(end, first + grain));
+    }
+  };
+  for (size_t i = 1; i < runners; ++i)
+    group.run(runChunks);
+  group.runAndWait(runChunks);
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool_(pool), state_(new detail::TaskGroupState(pool))
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+  boost::this_thread::disable_interruption noInterrupts;
+  while (!state_->done())
+  {
+    if (!pool_.helpOnce())
+      state_->waitBriefly();
+  }
+}
+
+void TaskGroup::run(const ThreadPool::Task& task)
+{
+  state_->added();
+  ThreadPool::WorkItem item = { task, state_ };
+  pool_.submit(item, false);
+}
+
+void TaskGroup::runGang(const ThreadPool::Task& task)
+{
+  state_->added();
+  ThreadPool::WorkItem item = { task, state_ };
+  pool_.submit(item, true);
+}
+
+void TaskGroup::runAndWait(const ThreadPool::Task& task)
+{
+  state_->added();
+  ThreadPool::WorkItem item = { task, state_ };
+  pool_.execute(item);
+  wait();
+}
+
+void TaskGroup::wait()
+{
+  try
+  {
+    while (!state_->done())
+    {
+      boost::this_thread::interruption_point();
+      if (!pool_.helpOnce())
+        state_->waitBriefly();
+    }
+  }
+  catch (boost::thread_interrupted&)
+  {
+    cancel();
+    boost::this_thread::disable_interruption noInterrupts;
+    while (!state_->done())
+    {
+      if (!pool_.helpOnce())
+        state_->waitBriefly();
+    }
+    throw;
+  }
+  state_->rethrowIfFailed();
+}
+
+void TaskGroup::cancel()
+{
+  state_->cancel();
+}
+
+bool TaskGroup::isCancelled() const
+{
+  return state_->cancelled();
+}
@@ -0,0 +1,141 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CORE_THREAD_THREADPOOL_H
+#define CORE_THREAD_THREADPOOL_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <Core/Thread/share.h>
+
+namespace SCIRun
+{
+namespace Core
+{
+namespace Thread
+{
+  namespace detail
+  {
+    class TaskGroupState;
+  }
+
+  /// Process-wide pool of persistent worker threads. Each worker owns a deque of tasks;
+  /// owners work LIFO on their own deque and idle workers steal FIFO from the others.
+  /// Threads that wait on a TaskGroup help execute queued tasks, so nested parallel
+  /// sections do not deadlock and do not oversubscribe the machine.
+  class SCISHARE ThreadPool : boost::noncopyable
+  {
+  public:
+    typedef boost::function<void()> Task;
+    typedef boost::function<void(int)> IndexedTask;
+    typedef boost::function<void(size_t, size_t)> RangeTask;
+
+    explicit ThreadPool(unsigned int numWorkers);
+    ~ThreadPool();
+
+    static ThreadPool& global();
+
+    unsigned int numWorkers() const;
+    bool isWorkerThread() const;
+
+    /// Runs task(0)..task(count-1) so that all of them are live at the same time; the
+    /// calling thread runs task(0). Required by algorithms that synchronize their tasks
+    /// with a Barrier. The pool grows if it does not have enough free workers.
+    void runConcurrently(const IndexedTask& task, int count);
+
+    /// Splits [begin, end) into chunks of grainSize (0 picks one) and runs body over them
+    /// with at most maxConcurrency threads, including the caller.
+    void parallelFor(size_t begin, size_t end, size_t grainSize, unsigned int maxConcurrency, const RangeTask& body);
+
+  private:
+    friend class TaskGroup;
+    friend class detail::TaskGroupState;
+    struct Worker;
+    struct WorkItem
+    {
+      Task task;
+      boost::shared_ptr<detail::TaskGroupState> group;
+    };
+
+    void workerLoop(size_t index);
+    void submit(const WorkItem& item, bool gang);
+    bool tryPop(WorkItem& item, bool takeGangWork);
+    bool helpOnce();
+    void execute(WorkItem& item);
+    bool reserveGangWorkers(unsigned int count);
+    void releaseGangWorkers(unsigned int count);
+    void addWorker();
+    void interruptWorkersRunning(const detail::TaskGroupState* group);
+
+    static const size_t MaxWorkers = 512;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> numWorkers_;
+    std::atomic<int> pending_;
+    std::atomic<int> injectedPending_;
+    std::atomic<int> gangPending_;
+    std::deque<WorkItem> injected_;
+    std::deque<WorkItem> gang_;
+    unsigned int gangCommitted_;
+    bool shutdown_;
+    mutable boost::mutex mutex_;
+    boost::condition_variable wake_;
+  };
+
+  /// A set of tasks submitted to a ThreadPool that can be waited on as a unit. The first
+  /// exception thrown by a task cancels the remaining unstarted tasks, interrupts the
+  /// running ones, and is rethrown by wait(). Interrupting the waiting thread cancels the group.
+  class SCISHARE TaskGroup : boost::noncopyable
+  {
+  public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::global());
+    ~TaskGroup();
+
+    void run(const ThreadPool::Task& task);
+    void runAndWait(const ThreadPool::Task& task);
+    void wait();
+    void cancel();
+    bool isCancelled() const;
+
+  private:
+    friend class ThreadPool;
+    void runGang(const ThreadPool::Task& task);
+    ThreadPool& pool_;
+    boost::shared_ptr<detail::TaskGroupState> state_;
+  };
+
+}}}
+
+#endif
@@ -28,14 +28,19 @@
 
 #include <Dataflow/Engine/Scheduler/GraphNetworkAnalyzer.h>
 #include <Dataflow/Engine/Scheduler/BoostGraphParallelScheduler.h>
+#include <Dataflow/Engine/Scheduler/ModuleRuntimeHistory.h>
 #include <Dataflow/Network/NetworkInterface.h>
+#include <Dataflow/Network/ModuleInterface.h>
 #include <Core/Logging/Log.h>
 
 using namespace SCIRun::Dataflow::Engine;
 using namespace SCIRun::Dataflow::Engine::NetworkGraph;
 using namespace SCIRun::Dataflow::Networks;
 
-BoostGraphParallelScheduler::BoostGraphParallelScheduler(const ModuleFilter& filter) : filter_(filter) {}
+BoostGraphParallelScheduler::BoostGraphParallelScheduler(const ModuleFilter& filter) : filter_(filter), history_(nullptr) {}
+
+BoostGraphParallelScheduler::BoostGraphParallelScheduler(const ModuleFilter& filter, const ModuleRuntimeHistory* history)
+  : filter_(filter), history_(history) {}
 
 ParallelModuleExecutionOrder BoostGraphParallelScheduler::schedule(const NetworkInterface& network) const
 {
@@ -68,5 +73,31 @@ ParallelModuleExecutionOrder BoostGraphParallelScheduler::schedule(const Network
     [&](int vertex){ return std::make_pair(time[vertex], graphAnalyzer.moduleAt(vertex)); }
   );
 
-  return ParallelModuleExecutionOrder(map);
+  ParallelModuleExecutionOrder order(map);
+
+  if (history_)
+  {
+    // Modules never timed before count as one second, so unknown networks still favor long chains.
+    std::vector<double> cost(graphAnalyzer.moduleCount(), 1.0);
+    for (int v = 0; v < graphAnalyzer.moduleCount(); ++v)
+    {
+      const auto& id = graphAnalyzer.moduleAt(v);
+      auto module = network.lookupModule(id);
+      // Before upstream modules run there is no input to measure, and scaling a recorded
+      // runtime down to zero bytes would make the heaviest modules look free.
+      auto estimate = module && ModuleRuntimeHistory::inputsAvailable(*module) ?
+        history_->estimate(id.name_, ModuleRuntimeHistory::inputBytes(*module)) :
+        history_->estimate(id.name_);
+      if (estimate)
+        cost[v] = *estimate;
+    }
+
+    auto pathLengths = criticalPathLengths(g, cost);
+    ParallelModuleExecutionOrder::Priorities priorities;
+    for (int v = 0; v < graphAnalyzer.moduleCount(); ++v)
+      priorities[graphAnalyzer.moduleAt(v)] = pathLengths[v];
+    order.setPriorities(priorities);
+  }
+
+  return order;
 }
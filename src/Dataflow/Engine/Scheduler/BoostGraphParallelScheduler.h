@@ -38,13 +38,18 @@ namespace SCIRun {
 namespace Dataflow {
 namespace Engine {
 
+  class ModuleRuntimeHistory;
+
   class SCISHARE BoostGraphParallelScheduler : public Scheduler<ParallelModuleExecutionOrder>
   {
   public:
     explicit BoostGraphParallelScheduler(const Networks::ModuleFilter& filter);
+    /// With a runtime history, the returned order also carries critical-path priorities.
+    BoostGraphParallelScheduler(const Networks::ModuleFilter& filter, const ModuleRuntimeHistory* history);
     virtual ParallelModuleExecutionOrder schedule(const Networks::NetworkInterface& network) const;
   private:
     Networks::ModuleFilter filter_;
+    const ModuleRuntimeHistory* history_;
   };
 
 }}}
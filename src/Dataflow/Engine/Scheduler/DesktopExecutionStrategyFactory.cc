@@ -42,7 +42,8 @@ DesktopExecutionStrategyFactory::DesktopExecutionStrategyFactory(const boost::op
   threadMode_(threadMode),
   serial_(new SerialExecutionStrategy),
   parallel_(new BasicParallelExecutionStrategy),
-  dynamic_(new DynamicParallelExecutionStrategy)
+  dynamic_(new DynamicParallelExecutionStrategy),
+  criticalPath_(new DynamicParallelExecutionStrategy(true))
 {
 }
 
@@ -56,6 +57,8 @@ ExecutionStrategyHandle DesktopExecutionStrategyFactory::create(ExecutionStrateg
     return parallel_;
   case ExecutionStrategy::DYNAMIC_PARALLEL:
     return dynamic_;
+  case ExecutionStrategy::CRITICAL_PATH_PARALLEL:
+    return criticalPath_;
   default:
     THROW_INVALID_ARGUMENT("Unknown execution strategy type.");
   }
@@ -73,6 +76,8 @@ ExecutionStrategyHandle DesktopExecutionStrategyFactory::createDefault() const
       return create(ExecutionStrategy::BASIC_PARALLEL);
     if (*threadMode_ == "dynamicParallel")
       return create(ExecutionStrategy::DYNAMIC_PARALLEL);
+    if (*threadMode_ == "criticalPath")
+      return create(ExecutionStrategy::CRITICAL_PATH_PARALLEL);
     else
       return create(latestWorkingVersion);
   }
@@ -0,0 +1,114 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ENGINE_SCHEDULER_DYNAMICEXECUTOR_EXECUTIONSTATISTICS_H
+#define ENGINE_SCHEDULER_DYNAMICEXECUTOR_EXECUTIONSTATISTICS_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <algorithm>
+#include <ostream>
+#include <Dataflow/Engine/Scheduler/share.h>
+
+namespace SCIRun {
+namespace Dataflow {
+namespace Engine {
+  namespace DynamicExecutor {
+
+    /// Timings of one dynamic network execution, in seconds.
+    struct SCISHARE ExecutionStatistics
+    {
+      ExecutionStatistics() : modulesExecuted(0), workers(0), totalQueueWait(0), maxQueueWait(0),
+        totalModuleRun(0), totalWorkerIdle(0), wallTime(0) {}
+      size_t modulesExecuted;
+      size_t workers;
+      double totalQueueWait;
+      double maxQueueWait;
+      double totalModuleRun;
+      double totalWorkerIdle;
+      double wallTime;
+    };
+
+    inline std::ostream& operator<<(std::ostream& o, const ExecutionStatistics& s)
+    {
+      return o << s.modulesExecuted << " modules on " << s.workers << " workers in " << s.wallTime
+        << "s: run " << s.totalModuleRun << "s, queue wait " << s.totalQueueWait << "s (max " << s.maxQueueWait
+        << "s), worker idle " << s.totalWorkerIdle << "s";
+    }
+
+    class SCISHARE ExecutionStatisticsCollector : boost::noncopyable
+    {
+    public:
+      void reset(size_t workers)
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        stats_ = ExecutionStatistics();
+        stats_.workers = workers;
+      }
+      void moduleDequeued(double queueWait, double workerIdle)
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        stats_.totalQueueWait += queueWait;
+        stats_.maxQueueWait = std::max(stats_.maxQueueWait, queueWait);
+        stats_.totalWorkerIdle += workerIdle;
+      }
+      void moduleFinished(double run)
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        ++stats_.modulesExecuted;
+        stats_.totalModuleRun += run;
+      }
+      void workerIdle(double idle)
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        stats_.totalWorkerIdle += idle;
+      }
+      void executionFinished(double wall)
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        stats_.wallTime = wall;
+      }
+      ExecutionStatistics snapshot() const
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        return stats_;
+      }
+    private:
+      mutable boost::mutex mutex_;
+      ExecutionStatistics stats_;
+    };
+
+    typedef boost::shared_ptr<ExecutionStatisticsCollector> ExecutionStatisticsCollectorPtr;
+
+  }}
+
+}}
+
+#endif
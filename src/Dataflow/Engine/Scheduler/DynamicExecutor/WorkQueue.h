@@ -30,8 +30,13 @@
 #define ENGINE_SCHEDULER_DYNAMICEXECUTOR_WORKQUEUE_H
 
 #include <Dataflow/Network/NetworkFwd.h>
-#include <boost/next_prior.hpp>
-#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <map>
+#include <functional>
 #include <Dataflow/Engine/Scheduler/share.h>
 
 namespace SCIRun {
@@ -39,14 +44,67 @@ namespace Dataflow {
 namespace Engine {
   namespace DynamicExecutor {
 
+    /// Multi-producer, multi-consumer ready queue. Consumers block until work arrives or the
+    /// queue is closed, instead of polling. Units with higher priority are popped first; equal
+    /// priorities keep FIFO order.
     template <class Unit>
-    class WorkQueue
+    class WorkQueue : boost::noncopyable
     {
     public:
-      typedef boost::lockfree::spsc_queue<Unit> Impl;
+      typedef boost::chrono::steady_clock Clock;
+
+      WorkQueue() : closed_(false) {}
+
+      void push(const Unit& unit, double priority = 0)
+      {
+        {
+          boost::lock_guard<boost::mutex> lock(mutex_);
+          queue_.insert(std::make_pair(priority, Entry(unit, Clock::now())));
+        }
+        ready_.notify_one();
+      }
+
+      /// Returns false once the queue is closed and drained. waited is the time the unit spent queued.
+      bool pop(Unit& unit, Clock::duration& waited)
+      {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        while (queue_.empty() && !closed_)
+          ready_.wait(lock);
+        if (queue_.empty())
+          return false;
+        auto next = queue_.begin();
+        unit = next->second.first;
+        waited = Clock::now() - next->second.second;
+        queue_.erase(next);
+        return true;
+      }
+
+      /// Wakes all consumers; they exit after the remaining units are popped.
+      void close()
+      {
+        {
+          boost::lock_guard<boost::mutex> lock(mutex_);
+          closed_ = true;
+        }
+        ready_.notify_all();
+      }
+
+      bool empty() const
+      {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        return queue_.empty();
+      }
+
+    private:
+      typedef std::pair<Unit, Clock::time_point> Entry;
+      // multimap inserts equal keys after existing ones, which keeps ties FIFO
+      std::multimap<double, Entry, std::greater<double>> queue_;
+      bool closed_;
+      mutable boost::mutex mutex_;
+      boost::condition_variable ready_;
     };
 
-    typedef WorkQueue<Networks::ModuleHandle>::Impl ModuleWorkQueue;
+    typedef WorkQueue<Networks::ModuleHandle> ModuleWorkQueue;
     typedef boost::shared_ptr<ModuleWorkQueue> ModuleWorkQueuePtr;
 
   }}
@@ -32,6 +32,8 @@
 #include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkQueue.h>
 #include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkUnitProducerInterface.h>
 #include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkUnitExecutor.h>
+#include <Dataflow/Engine/Scheduler/DynamicExecutor/ExecutionStatistics.h>
+#include <Dataflow/Engine/Scheduler/ModuleRuntimeHistory.h>
 #include <Dataflow/Network/NetworkInterface.h>
 #include <Core/Logging/Log.h>
 #include <Core/Thread/Mutex.h>
@@ -44,6 +46,8 @@ namespace Dataflow {
 namespace Engine {
 namespace DynamicExecutor {
 
+  /// Bounded set of worker threads that pull ready modules off the work queue. Keeps track of
+  /// which worker runs which module so a single module can be interrupted.
   class SCISHARE ExecutionThreadGroup : boost::noncopyable
   {
   public:
@@ -51,11 +55,49 @@ namespace DynamicExecutor {
     {
       clear();
     }
-    void startExecution(const ModuleExecutor& executor)
+    template <class WorkerLoop>
+    void startWorkers(size_t count, WorkerLoop loop)
     {
-      auto thread = executeThreads_->create_thread(boost::bind(&ModuleExecutor::run, executor));
+      // workers cannot register a module before all threads are in the map
       Core::Thread::Guard g(mapLock_->get());
-      threadsByModuleId_[executor.module_->get_id().id_] = thread;
+      for (size_t i = 0; i < count; ++i)
+      {
+        auto thread = executeThreads_->create_thread(loop);
+        threadsById_[thread->get_id()] = thread;
+      }
+    }
+    void runModule(ModuleExecutor& executor)
+    {
+      const auto moduleId = executor.module_->get_id().id_;
+      {
+        Core::Thread::Guard g(mapLock_->get());
+        threadIdsByModuleId_[moduleId] = boost::this_thread::get_id();
+      }
+      executor.run();
+      {
+        Core::Thread::Guard g(mapLock_->get());
+        threadIdsByModuleId_.erase(moduleId);
+      }
+      // an interrupt that arrived after the module finished must not hit the next one
+      try
+      {
+        boost::this_thread::interruption_point();
+      }
+      catch (boost::thread_interrupted&)
+      {
+      }
+    }
+    void interruptModule(const std::string& moduleId)
+    {
+      if (!mapLock_)
+        return;
+      Core::Thread::Guard g(mapLock_->get());
+      auto module = threadIdsByModuleId_.find(moduleId);
+      if (module == threadIdsByModuleId_.end())
+        return;
+      auto thread = threadsById_.find(module->second);
+      if (thread != threadsById_.end())
+        thread->second->interrupt();
     }
     void joinAll()
     {
@@ -64,41 +106,30 @@ namespace DynamicExecutor {
     void clear()
     {
       executeThreads_.reset(new boost::thread_group);
-      threadsByModuleId_.clear();
+      threadsById_.clear();
+      threadIdsByModuleId_.clear();
       std::ostringstream lockName;
       lockName << "threadMap " << this;
       mapLock_.reset(new Core::Thread::Mutex(lockName.str()));
     }
-    boost::thread* getThreadForModule(const std::string& moduleId) const
-    {
-      if (!mapLock_)
-      {
-        return nullptr;
-      }
-      Core::Thread::Guard g(mapLock_->get());
-
-      auto it = threadsByModuleId_.find(moduleId);
-      if (it == threadsByModuleId_.end())
-        return nullptr;
-      if (!executeThreads_->is_thread_in(it->second))
-        return nullptr;
-      return it->second;
-    }
   private:
     mutable boost::shared_ptr<boost::thread_group> executeThreads_;
-    std::map<std::string, boost::thread*> threadsByModuleId_;
+    std::map<boost::thread::id, boost::thread*> threadsById_;
+    std::map<std::string, boost::thread::id> threadIdsByModuleId_;
     mutable boost::shared_ptr<Core::Thread::Mutex> mapLock_;
   };
 
   typedef boost::shared_ptr<ExecutionThreadGroup> ExecutionThreadGroupPtr;
 
+  /// Worker loop: blocks on the ready queue and runs modules until the producer closes it.
   class SCISHARE ModuleConsumer : boost::noncopyable
   {
   public:
     explicit ModuleConsumer(ModuleWorkQueuePtr workQueue, const Networks::ExecutableLookup* lookup, ProducerInterfacePtr producer,
-      ExecutionThreadGroupPtr executeThreadGroup) :
+      ExecutionThreadGroupPtr executeThreadGroup, ExecutionStatisticsCollectorPtr statistics,
+      ModuleRuntimeHistory* history = nullptr) :
     work_(workQueue), producer_(producer), lookup_(lookup),
-    executeThreadGroup_(executeThreadGroup),
+    executeThreadGroup_(executeThreadGroup), statistics_(statistics), history_(history),
     shouldLog_(false)//SCIRun::Core::Logging::Log::get().verbose())
     {
       //log_.setVerbose(shouldLog_);
@@ -114,29 +145,41 @@ namespace DynamicExecutor {
 
       //log_->trace_if(shouldLog_, "Consumer started.");
 
-      while (!producer_->isDone() || moreWork())
+      typedef ModuleWorkQueue::Clock Clock;
+      // only module execution may be interrupted, never the wait on the queue
+      boost::this_thread::disable_interruption noInterrupts;
+      for (;;)
       {
-        if (moreWork())
+        Networks::ModuleHandle unit;
+        Clock::duration queued;
+        auto idleStart = Clock::now();
+        if (!work_->pop(unit, queued))
         {
-          //log_->trace_if(shouldLog_, "\tConsumer thinks work queue is not empty.");
-          //log_->trace_if(shouldLog_, "\tConsumer accessing front of work queue.");
-
-          Networks::ModuleHandle unit;
-          work_->pop(unit);
-
-          //log_->trace_if(shouldLog_, "\tConsumer popping front of work queue.");
+          statistics_->workerIdle(seconds(Clock::now() - idleStart));
+          break;
+        }
+        statistics_->moduleDequeued(seconds(queued), seconds(Clock::now() - idleStart));
 
-          if (unit)
-          {
-            //log_->trace_if(shouldLog_, "~~~Processing {}", unit->get_id());
+        if (unit)
+        {
+          //log_->trace_if(shouldLog_, "~~~Processing {}", unit->get_id());
 
-            ModuleExecutor executor(unit, lookup_, producer_);
-            executeThreadGroup_->startExecution(executor);
-          }
-          else
+          ModuleExecutor executor(unit, lookup_, producer_);
+          // inputs are all present once a module is ready, so this is the size it runs on
+          const size_t inputBytes = history_ ? ModuleRuntimeHistory::inputBytes(*unit) : 0;
+          auto runStart = Clock::now();
           {
-            //log_->trace_if(shouldLog_, "\tConsumer received null module");
+            boost::this_thread::restore_interruption allowInterrupts(noInterrupts);
+            executeThreadGroup_->runModule(executor);
           }
+          const double runtime = seconds(Clock::now() - runStart);
+          statistics_->moduleFinished(runtime);
+          if (history_)
+            history_->record(unit->get_id().name_, inputBytes, runtime);
+        }
+        else
+        {
+          //log_->trace_if(shouldLog_, "\tConsumer received null module");
         }
       }
      // log_->trace_if(shouldLog_, "Consumer done.");
@@ -148,10 +191,17 @@ namespace DynamicExecutor {
     }
 
   private:
+    static double seconds(ModuleWorkQueue::Clock::duration d)
+    {
+      return boost::chrono::duration<double>(d).count();
+    }
+
     ModuleWorkQueuePtr work_;
     ProducerInterfacePtr producer_;
     const Networks::ExecutableLookup* lookup_;
     ExecutionThreadGroupPtr executeThreadGroup_;
+    ExecutionStatisticsCollectorPtr statistics_;
+    ModuleRuntimeHistory* history_;
 
     //static Core::Logging::Logger2 log_;
     bool shouldLog_;
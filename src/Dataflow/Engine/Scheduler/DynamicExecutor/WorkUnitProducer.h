@@ -49,8 +49,9 @@ namespace SCIRun {
         {
         public:
           ModuleProducer(const Networks::ModuleFilter& filter,
-            const Networks::NetworkInterface* network, Core::Thread::Mutex* lock, ModuleWorkQueuePtr work, size_t numModules) :
-            scheduler_(filter), network_(network), enqueueLock_(lock),
+            const Networks::NetworkInterface* network, Core::Thread::Mutex* lock, ModuleWorkQueuePtr work, size_t numModules,
+            const ModuleRuntimeHistory* history = nullptr) :
+            scheduler_(filter, history), network_(network), enqueueLock_(lock),
             work_(work), doneCount_(0), badGroup_(false),
             //shouldLog_(SCIRun::Core::Logging::Log::get().verbose()),
             numModules_(numModules)
@@ -71,6 +72,7 @@ namespace SCIRun {
               if (order.minGroup() < 0)
               {
                 badGroup_ = true;
+                std::cerr << "producer is done with bad group, something went wrong. probably a race condition..." << std::endl;
               }
               auto groupIter = order.getGroup(order.minGroup());
               BOOST_FOREACH(const ParallelModuleExecutionOrder::ModulesByGroup::value_type& mod, groupIter)
@@ -89,7 +91,7 @@ namespace SCIRun {
                   }
                   else
                   {
-                    work_->push(module);
+                    work_->push(module, order.priorityOf(mod.second));
                     doneIds_.insert(mod.second);
                     doneCount_.fetch_add(1);
 
@@ -99,26 +101,10 @@ namespace SCIRun {
                 }
               }
             }
-          }
-
-          void operator()() const
-          {
-            id_ = boost::this_thread::get_id();
-
-            //log_->trace_if(shouldLog_, "Producer started {}", id_);
-
-            enqueueReadyModules();
-
-            while (!badGroup_ && !isDone())
-            {
-              boost::this_thread::sleep(boost::posix_time::milliseconds(100));
-              //std::cout << "producer thread waiting " << id_ << std::endl;
-            }
-
-            if (badGroup_)
-              std::cerr << "producer is done with bad group, something went wrong. probably a race condition..." << std::endl;
 
-            //log_->trace_if(shouldLog_, "Producer is done. {}", id_);
+            // consumers block on the queue; closing it lets them exit once the last module is popped
+            if (badGroup_ || isDone())
+              work_->close();
           }
 
           bool isDone() const
@@ -136,7 +122,6 @@ namespace SCIRun {
           //static Core::Logging::Logger2 log_;
           bool shouldLog_;
           size_t numModules_;
-          mutable boost::thread::id id_;
         };
 
         typedef boost::shared_ptr<ModuleProducer> ModuleProducerPtr;
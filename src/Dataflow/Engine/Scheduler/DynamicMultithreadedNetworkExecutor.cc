@@ -32,6 +32,8 @@
 #include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkUnitProducer.h>
 
 #include <Dataflow/Engine/Scheduler/DynamicMultithreadedNetworkExecutor.h>
+#include <Core/Thread/Parallel.h>
+#include <Core/Datatypes/CopyOnWrite.h>
 
 using namespace SCIRun::Dataflow::Engine;
 using namespace SCIRun::Dataflow::Networks;
@@ -53,16 +55,20 @@ namespace SCIRun {
       {
       public:
         DynamicMultithreadedNetworkExecutorImpl(const ExecutionContext& context, const NetworkInterface* network,
-          Mutex* lock, size_t numModules, Mutex* executionLock, DynamicExecutor::ExecutionThreadGroupPtr threadGroup) :
+          Mutex* lock, size_t numModules, Mutex* executionLock, DynamicExecutor::ExecutionThreadGroupPtr threadGroup,
+          DynamicExecutor::ExecutionStatisticsCollectorPtr statistics, ModuleRuntimeHistory* history) :
           executeThreads_(threadGroup),
+          statistics_(statistics),
           lookup_(&context.lookup),
           bounds_(&context.bounds()),
-          work_(new DynamicExecutor::ModuleWorkQueue(numModules)),
+          work_(new DynamicExecutor::ModuleWorkQueue),
           producer_(new DynamicExecutor::ModuleProducer(context.addAdditionalFilter(ModuleWaitingFilter::Instance()),
-            network, lock, work_, numModules)),
-            consumer_(new DynamicExecutor::ModuleConsumer(work_, lookup_, producer_, executeThreads_)),
+            network, lock, work_, numModules, history)),
+            consumer_(new DynamicExecutor::ModuleConsumer(work_, lookup_, producer_, executeThreads_, statistics_, history)),
           network_(network),
-          executionLock_(executionLock)
+          history_(history),
+          executionLock_(executionLock),
+          numWorkers_(std::max<size_t>(1, std::min<size_t>(numModules, Parallel::NumCores())))
         {
         }
         ~DynamicMultithreadedNetworkExecutorImpl()
@@ -82,40 +88,46 @@ namespace SCIRun {
 
           waitForStartupInit(*network_);
 
-          boost::thread consume(boost::ref(*consumer_));
-          boost::thread produce(boost::ref(*producer_));
-          consume.join();
-          produce.join();
+          auto start = boost::chrono::steady_clock::now();
+          statistics_->reset(numWorkers_);
+          executeThreads_->startWorkers(numWorkers_, boost::ref(*consumer_));
+          producer_->enqueueReadyModules();
           executeThreads_->joinAll();
+          statistics_->executionFinished(boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count());
+
+          LOG_DEBUG("DMTNE execution statistics: {}", statistics_->snapshot());
+          LOG_DEBUG("Port data shared instead of copied so far: {} bytes", Core::Datatypes::CopyOnWriteStatistics::bytesSaved());
+
+          if (history_)
+            history_->save();
         }
 
         void interruptModule(const std::string& id) const
         {
           if (executeThreads_)
-          {
-            auto thread = executeThreads_->getThreadForModule(id);
-            if (thread)
-            {
-              thread->interrupt();
-            }
-          }
+            executeThreads_->interruptModule(id);
         }
       private:
         mutable DynamicExecutor::ExecutionThreadGroupPtr executeThreads_;
+        DynamicExecutor::ExecutionStatisticsCollectorPtr statistics_;
         const Networks::ExecutableLookup* lookup_;
         const ExecutionBounds* bounds_;
         DynamicExecutor::ModuleWorkQueuePtr work_;
         DynamicExecutor::ModuleProducerPtr producer_;
         DynamicExecutor::ModuleConsumerPtr consumer_;
         const NetworkInterface* network_;
+        ModuleRuntimeHistory* history_;
         Mutex* executionLock_;
+        size_t numWorkers_;
         mutable boost::signals2::connection interruptCxn_;
       };
 }}}
 
-DynamicMultithreadedNetworkExecutor::DynamicMultithreadedNetworkExecutor(const NetworkInterface& network) :
+DynamicMultithreadedNetworkExecutor::DynamicMultithreadedNetworkExecutor(const NetworkInterface& network, ModuleRuntimeHistory* history) :
   network_(network),
-  threadGroup_(new DynamicExecutor::ExecutionThreadGroup)
+  threadGroup_(new DynamicExecutor::ExecutionThreadGroup),
+  statistics_(new DynamicExecutor::ExecutionStatisticsCollector),
+  history_(history)
 {
 }
 
@@ -127,10 +139,15 @@ void DynamicMultithreadedNetworkExecutor::execute(const ExecutionContext& contex
     LOG_TRACE("DMTNE::executeAll order received: {}", order);
 
   threadGroup_->clear();
-  DynamicMultithreadedNetworkExecutorImpl runner(context, &network_, &lock, order.size(), &executionLock, threadGroup_);
+  DynamicMultithreadedNetworkExecutorImpl runner(context, &network_, &lock, order.size(), &executionLock, threadGroup_, statistics_, history_);
   boost::thread execution(runner);
 }
 
+DynamicExecutor::ExecutionStatistics DynamicMultithreadedNetworkExecutor::lastExecutionStatistics() const
+{
+  return statistics_->snapshot();
+}
+
 bool ModuleWaitingFilter::operator()(ModuleHandle mh) const
 {
   auto state = mh->executionState().currentState();
@@ -32,6 +32,7 @@
 
 #include <Dataflow/Engine/Scheduler/ParallelModuleExecutionOrder.h>
 #include <Dataflow/Engine/Scheduler/SchedulerInterfaces.h>
+#include <Dataflow/Engine/Scheduler/DynamicExecutor/ExecutionStatistics.h>
 #include <Dataflow/Engine/Scheduler/share.h>
 
 namespace SCIRun {
@@ -42,15 +43,21 @@ namespace Dataflow {
     {
       class ExecutionThreadGroup;
     }
+    class ModuleRuntimeHistory;
 
   class SCISHARE DynamicMultithreadedNetworkExecutor : public NetworkExecutor<ParallelModuleExecutionOrder>
   {
   public:
-    explicit DynamicMultithreadedNetworkExecutor(const Networks::NetworkInterface& network);
+    /// With a history, module runtimes are recorded and ready modules are dispatched longest critical path first.
+    explicit DynamicMultithreadedNetworkExecutor(const Networks::NetworkInterface& network, ModuleRuntimeHistory* history = nullptr);
     virtual void execute(const ExecutionContext& context, ParallelModuleExecutionOrder order, Core::Thread::Mutex& executionLock) override;
+    /// Queue wait, module run and worker idle times of the most recent execute(); filled in as it runs.
+    DynamicExecutor::ExecutionStatistics lastExecutionStatistics() const;
   private:
     const Networks::NetworkInterface& network_;
     boost::shared_ptr<DynamicExecutor::ExecutionThreadGroup> threadGroup_;
+    DynamicExecutor::ExecutionStatisticsCollectorPtr statistics_;
+    ModuleRuntimeHistory* history_;
   };
 
 }}}
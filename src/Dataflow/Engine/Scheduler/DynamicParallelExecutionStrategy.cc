@@ -30,16 +30,22 @@
 #include <Dataflow/Engine/Scheduler/DynamicParallelExecutionStrategy.h>
 #include <Dataflow/Engine/Scheduler/BoostGraphParallelScheduler.h>
 #include <Dataflow/Engine/Scheduler/DynamicMultithreadedNetworkExecutor.h>
+#include <Dataflow/Engine/Scheduler/ModuleRuntimeHistory.h>
 #include <Dataflow/Network/NetworkInterface.h>
 
 using namespace SCIRun::Dataflow::Engine;
 using namespace SCIRun::Dataflow::Networks;
 using namespace SCIRun::Core::Thread;
 
+DynamicParallelExecutionStrategy::DynamicParallelExecutionStrategy(bool criticalPath) : criticalPath_(criticalPath)
+{
+}
+
 void DynamicParallelExecutionStrategy::execute(const ExecutionContext& context, Mutex& executionLock)
 {
   auto filter = context.addAdditionalFilter(ExecuteAllModules::Instance());
-  BoostGraphParallelScheduler scheduler(filter);
-  DynamicMultithreadedNetworkExecutor executor(context.network);
+  auto history = criticalPath_ ? &ModuleRuntimeHistory::instance() : nullptr;
+  BoostGraphParallelScheduler scheduler(filter, history);
+  DynamicMultithreadedNetworkExecutor executor(context.network, history);
   executeWithCycleCheck(scheduler, executor, context, executionLock);
 }
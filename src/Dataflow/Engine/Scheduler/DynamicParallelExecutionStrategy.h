@@ -39,7 +39,12 @@ namespace SCIRun {
       class SCISHARE DynamicParallelExecutionStrategy : public ExecutionStrategy
       {
       public:
+        /// criticalPath: dispatch ready modules by their longest remaining path, using runtimes
+        /// recorded in ModuleRuntimeHistory::instance().
+        explicit DynamicParallelExecutionStrategy(bool criticalPath = false);
         virtual void execute(const ExecutionContext& context, Core::Thread::Mutex& executionLock) override;
+      private:
+        bool criticalPath_;
       };
 
     }
@@ -30,7 +30,7 @@
 #define ENGINE_SCHEDULER_EXECUTION_STRATEGY_H
 
 #include <Dataflow/Engine/Scheduler/SchedulerInterfaces.h>
-#include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkQueue.h>
+#include <boost/lockfree/spsc_queue.hpp>
 #include <boost/thread.hpp>
 #include <boost/atomic.hpp>
 #include <Core/Thread/ConditionVariable.h>
@@ -50,7 +50,8 @@ namespace Engine {
     {
       SERIAL,
       BASIC_PARALLEL,
-      DYNAMIC_PARALLEL
+      DYNAMIC_PARALLEL,
+      CRITICAL_PATH_PARALLEL
       // next: pausable, then with loops
     };
 
@@ -80,7 +81,7 @@ namespace Engine {
     void stop();
   private:
     void executeImpl(ExecutionContextHandle context);
-    typedef DynamicExecutor::WorkQueue<ExecutionContextHandle>::Impl ExecutionContextQueue;
+    typedef boost::lockfree::spsc_queue<ExecutionContextHandle> ExecutionContextQueue;
     ExecutionContextQueue contexts_;
 
     ExecutionStrategyHandle currentExecutor_;
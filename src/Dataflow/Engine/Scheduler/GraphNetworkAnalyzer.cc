@@ -121,6 +121,24 @@ void NetworkGraphAnalyzer::computeExecutionOrder()
   }
 }
 
+std::vector<double> NetworkGraph::criticalPathLengths(const DirectedGraph& graph, const std::vector<double>& cost)
+{
+  // topological_sort emits sinks first, so every successor is done before its predecessors
+  std::vector<Vertex> reverseOrder;
+  boost::topological_sort(graph, std::back_inserter(reverseOrder));
+
+  std::vector<double> length(boost::num_vertices(graph), 0.0);
+  for (auto v : reverseOrder)
+  {
+    double longestSuccessor = 0;
+    DirectedGraph::out_edge_iterator e, e_end;
+    for (boost::tie(e, e_end) = out_edges(v, graph); e != e_end; ++e)
+      longestSuccessor = std::max(longestSuccessor, length[target(*e, graph)]);
+    length[v] = cost[v] + longestSuccessor;
+  }
+  return length;
+}
+
 ComponentMap NetworkGraphAnalyzer::connectedComponents()
 {
   auto edges = constructEdgeListFromNetwork();
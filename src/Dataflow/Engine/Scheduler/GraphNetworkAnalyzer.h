@@ -50,6 +50,9 @@ namespace Engine {
     typedef std::list<Vertex> ExecutionOrder;
     typedef ExecutionOrder::const_iterator ExecutionOrderIterator;
     typedef std::map<std::string, int> ComponentMap;
+
+    /// Longest cost-weighted path from each vertex to a sink, including the vertex's own cost.
+    SCISHARE std::vector<double> criticalPathLengths(const DirectedGraph& graph, const std::vector<double>& cost);
   }
 
   class SCISHARE NetworkGraphAnalyzer : boost::noncopyable
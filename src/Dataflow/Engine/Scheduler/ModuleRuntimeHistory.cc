@@ -0,0 +1,185 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Engine/Scheduler/ModuleRuntimeHistory.h>
+#include <Dataflow/Network/ModuleInterface.h>
+#include <Dataflow/Network/PortInterface.h>
+#include <Core/Datatypes/Datatype.h>
+#include <Core/Logging/ApplicationHelper.h>
+#include <boost/filesystem.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <cmath>
+#include <fstream>
+
+using namespace SCIRun::Dataflow::Engine;
+using namespace SCIRun::Dataflow::Networks;
+
+namespace
+{
+  // recent runs dominate so the history follows code and hardware changes
+  const size_t maxAveragingWindow = 10;
+}
+
+ModuleRuntimeHistory::ModuleRuntimeHistory(const boost::filesystem::path& file) : file_(file), dirty_(false)
+{
+}
+
+ModuleRuntimeHistory& ModuleRuntimeHistory::instance()
+{
+  static ModuleRuntimeHistory history(Core::Logging::ApplicationHelper().configDirectory() / "module_runtimes.txt");
+  static bool loaded = history.load();
+  (void)loaded;
+  return history;
+}
+
+int ModuleRuntimeHistory::sizeBucket(size_t bytes)
+{
+  int bucket = 0;
+  while (bytes > 1)
+  {
+    bytes >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+void ModuleRuntimeHistory::record(const std::string& moduleName, size_t inputBytes, double seconds)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  auto& samples = samples_[moduleName];
+  auto bucket = samples.find(sizeBucket(inputBytes));
+  if (bucket == samples.end())
+  {
+    Sample first = { seconds, 1 };
+    samples[sizeBucket(inputBytes)] = first;
+  }
+  else
+  {
+    auto& sample = bucket->second;
+    sample.count = std::min(sample.count + 1, maxAveragingWindow);
+    sample.meanSeconds += (seconds - sample.meanSeconds) / sample.count;
+  }
+  dirty_ = true;
+}
+
+boost::optional<double> ModuleRuntimeHistory::estimate(const std::string& moduleName, size_t inputBytes) const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  auto module = samples_.find(moduleName);
+  if (module == samples_.end() || module->second.empty())
+    return boost::none;
+
+  const int wanted = sizeBucket(inputBytes);
+  const auto& samples = module->second;
+  auto nearest = samples.begin();
+  for (auto i = samples.begin(); i != samples.end(); ++i)
+  {
+    if (std::abs(i->first - wanted) < std::abs(nearest->first - wanted))
+      nearest = i;
+  }
+  return nearest->second.meanSeconds * std::pow(2.0, wanted - nearest->first);
+}
+
+boost::optional<double> ModuleRuntimeHistory::estimate(const std::string& moduleName) const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  auto module = samples_.find(moduleName);
+  if (module == samples_.end() || module->second.empty())
+    return boost::none;
+  return module->second.rbegin()->second.meanSeconds;
+}
+
+size_t ModuleRuntimeHistory::numberOfEntries() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  size_t entries = 0;
+  for (const auto& module : samples_)
+    entries += module.second.size();
+  return entries;
+}
+
+bool ModuleRuntimeHistory::load()
+{
+  std::ifstream in(file_.string().c_str());
+  if (!in)
+    return false;
+
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  std::string name;
+  int bucket;
+  Sample sample;
+  while (in >> name >> bucket >> sample.meanSeconds >> sample.count)
+    samples_[name][bucket] = sample;
+  dirty_ = false;
+  return true;
+}
+
+bool ModuleRuntimeHistory::save()
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  if (!dirty_)
+    return true;
+
+  boost::system::error_code ec;
+  if (file_.has_parent_path())
+    boost::filesystem::create_directories(file_.parent_path(), ec);
+
+  std::ofstream out(file_.string().c_str());
+  if (!out)
+    return false;
+  for (const auto& module : samples_)
+    for (const auto& sample : module.second)
+      out << module.first << ' ' << sample.first << ' ' << sample.second.meanSeconds << ' ' << sample.second.count << '\n';
+  dirty_ = false;
+  return static_cast<bool>(out);
+}
+
+size_t ModuleRuntimeHistory::inputBytes(const ModuleInterface& module)
+{
+  size_t bytes = 0;
+  for (const auto& port : module.inputPorts())
+  {
+    auto data = port->getData();
+    if (data && *data)
+      bytes += (*data)->sizeInBytes();
+  }
+  return bytes;
+}
+
+bool ModuleRuntimeHistory::inputsAvailable(const ModuleInterface& module)
+{
+  for (const auto& port : module.inputPorts())
+  {
+    if (port->nconnections() == 0)
+      continue;
+    auto data = port->getData();
+    if (!data || !*data)
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,88 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ENGINE_SCHEDULER_MODULERUNTIMEHISTORY_H
+#define ENGINE_SCHEDULER_MODULERUNTIMEHISTORY_H
+
+#include <Dataflow/Network/NetworkFwd.h>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <Dataflow/Engine/Scheduler/share.h>
+
+namespace SCIRun {
+namespace Dataflow {
+namespace Engine {
+
+  /// Measured module runtimes per module type and input size, persisted between sessions.
+  /// Input sizes are bucketed by powers of two; estimates for an unseen size scale the
+  /// nearest recorded bucket linearly. Before upstream modules have run the input size is
+  /// unknown, and the estimate is the unscaled mean of the largest size recorded.
+  class SCISHARE ModuleRuntimeHistory : boost::noncopyable
+  {
+  public:
+    explicit ModuleRuntimeHistory(const boost::filesystem::path& file);
+
+    /// Shared history stored in the SCIRun config directory.
+    static ModuleRuntimeHistory& instance();
+
+    void record(const std::string& moduleName, size_t inputBytes, double seconds);
+    boost::optional<double> estimate(const std::string& moduleName, size_t inputBytes) const;
+    boost::optional<double> estimate(const std::string& moduleName) const;
+    size_t numberOfEntries() const;
+
+    bool load();
+    bool save();
+
+    /// Sum of Datatype::sizeInBytes over the data currently on the module's input ports.
+    static size_t inputBytes(const Networks::ModuleInterface& module);
+    /// False while a connected input port has no data yet, so inputBytes would undercount.
+    static bool inputsAvailable(const Networks::ModuleInterface& module);
+
+  private:
+    static int sizeBucket(size_t bytes);
+
+    struct Sample
+    {
+      double meanSeconds;
+      size_t count;
+    };
+    typedef std::map<int, Sample> SamplesBySize;
+    typedef std::map<std::string, SamplesBySize> SamplesByModule;
+
+    boost::filesystem::path file_;
+    SamplesByModule samples_;
+    bool dirty_;
+    mutable boost::mutex mutex_;
+  };
+
+}}}
+
+#endif
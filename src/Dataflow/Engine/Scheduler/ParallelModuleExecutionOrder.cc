@@ -35,7 +35,7 @@ ParallelModuleExecutionOrder::ParallelModuleExecutionOrder()
 {
 }
 
-ParallelModuleExecutionOrder::ParallelModuleExecutionOrder(const ParallelModuleExecutionOrder& other) : map_(other.map_)
+ParallelModuleExecutionOrder::ParallelModuleExecutionOrder(const ParallelModuleExecutionOrder& other) : map_(other.map_), priorities_(other.priorities_)
 {
 }
 
@@ -83,6 +83,17 @@ int ParallelModuleExecutionOrder::groupOf(const ModuleId& id) const
   return -1;
 }
 
+double ParallelModuleExecutionOrder::priorityOf(const ModuleId& id) const
+{
+  auto p = priorities_.find(id);
+  return p != priorities_.end() ? p->second : 0;
+}
+
+void ParallelModuleExecutionOrder::setPriorities(const Priorities& priorities)
+{
+  priorities_ = priorities;
+}
+
 std::ostream& SCIRun::Dataflow::Engine::operator<<(std::ostream& out, const ParallelModuleExecutionOrder& order)
 {
   // platform-independent sorting for verification purposes.
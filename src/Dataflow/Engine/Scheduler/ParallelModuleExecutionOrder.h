@@ -45,6 +45,7 @@ namespace Engine {
     typedef ModulesByGroup::value_type value_type;
     typedef ModulesByGroup::iterator iterator;
     typedef ModulesByGroup::const_iterator const_iterator;
+    typedef std::map<Networks::ModuleId, double> Priorities;
 
     ParallelModuleExecutionOrder();
     ParallelModuleExecutionOrder(const ParallelModuleExecutionOrder& other);
@@ -56,8 +57,13 @@ namespace Engine {
     int maxGroup() const;
     std::pair<const_iterator,const_iterator> getGroup(int order) const;
     int groupOf(const Networks::ModuleId& id) const;
+    /// Length of the longest remaining path through the module, in estimated seconds; modules
+    /// without an estimate report 0.
+    double priorityOf(const Networks::ModuleId& id) const;
+    void setPriorities(const Priorities& priorities);
   private:
     ModulesByGroup map_;
+    Priorities priorities_;
   };
 
   SCISHARE std::ostream& operator<<(std::ostream& out, const ParallelModuleExecutionOrder& order);
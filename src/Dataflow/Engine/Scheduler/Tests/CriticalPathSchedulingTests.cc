@@ -0,0 +1,230 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Dataflow/Engine/Scheduler/GraphNetworkAnalyzer.h>
+#include <Dataflow/Engine/Scheduler/ModuleRuntimeHistory.h>
+#include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkQueue.h>
+#include <Dataflow/Serialization/Network/XMLSerializer.h>
+#include <Dataflow/Serialization/Network/NetworkDescriptionSerialization.h>
+#include <boost/filesystem.hpp>
+#include <boost/graph/exception.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <iostream>
+
+using namespace SCIRun::Dataflow::Engine;
+using namespace SCIRun::Dataflow::Engine::NetworkGraph;
+using namespace SCIRun::Dataflow::Engine::DynamicExecutor;
+using namespace SCIRun::Dataflow::Networks;
+
+TEST(CriticalPathTests, PathLengthsAccumulateTowardSources)
+{
+  // 0 -> 1 -> 3, 0 -> 2 -> 3
+  std::vector<Edge> edges { Edge(0,1), Edge(0,2), Edge(1,3), Edge(2,3) };
+  DirectedGraph g(edges.begin(), edges.end(), 4);
+  std::vector<double> cost { 1, 5, 2, 1 };
+
+  auto length = criticalPathLengths(g, cost);
+
+  EXPECT_EQ(7, length[0]);
+  EXPECT_EQ(6, length[1]);
+  EXPECT_EQ(3, length[2]);
+  EXPECT_EQ(1, length[3]);
+}
+
+TEST(CriticalPathTests, WorkQueuePopsHighestPriorityFirstAndTiesInOrder)
+{
+  WorkQueue<int> queue;
+  queue.push(1, 1.0);
+  queue.push(2, 3.0);
+  queue.push(3, 1.0);
+  queue.push(4, 2.0);
+
+  std::vector<int> popped;
+  int unit;
+  WorkQueue<int>::Clock::duration waited;
+  while (!queue.empty() && queue.pop(unit, waited))
+    popped.push_back(unit);
+
+  EXPECT_EQ(std::vector<int>({ 2, 4, 1, 3 }), popped);
+}
+
+TEST(ModuleRuntimeHistoryTests, EstimatesScaleFromNearestRecordedSize)
+{
+  ModuleRuntimeHistory history(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path());
+
+  EXPECT_FALSE(history.estimate("SolveLinearSystem", 1024));
+
+  history.record("SolveLinearSystem", 1024, 2.0);
+  history.record("SolveLinearSystem", 1024, 4.0);
+
+  EXPECT_DOUBLE_EQ(3.0, *history.estimate("SolveLinearSystem", 1024));
+  EXPECT_DOUBLE_EQ(6.0, *history.estimate("SolveLinearSystem", 2048));
+  EXPECT_DOUBLE_EQ(1.5, *history.estimate("SolveLinearSystem", 512));
+  EXPECT_FALSE(history.estimate("BuildFEMatrix", 1024));
+}
+
+TEST(ModuleRuntimeHistoryTests, UnknownInputSizeUsesLargestRecordedSize)
+{
+  ModuleRuntimeHistory history(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path());
+
+  EXPECT_FALSE(history.estimate("SolveLinearSystem"));
+
+  history.record("SolveLinearSystem", 1024, 0.5);
+  history.record("SolveLinearSystem", 100 << 20, 40.0);
+
+  EXPECT_DOUBLE_EQ(40.0, *history.estimate("SolveLinearSystem"));
+  EXPECT_DOUBLE_EQ(0.5, *history.estimate("SolveLinearSystem", 1024));
+}
+
+TEST(ModuleRuntimeHistoryTests, SavedHistoryIsReloaded)
+{
+  auto file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  {
+    ModuleRuntimeHistory history(file);
+    history.record("BuildFEMatrix", 1 << 20, 12.5);
+    history.record("ShowField", 0, 0.25);
+    EXPECT_TRUE(history.save());
+  }
+
+  ModuleRuntimeHistory reloaded(file);
+  EXPECT_TRUE(reloaded.load());
+  EXPECT_EQ(2, reloaded.numberOfEntries());
+  EXPECT_DOUBLE_EQ(12.5, *reloaded.estimate("BuildFEMatrix", 1 << 20));
+  EXPECT_DOUBLE_EQ(0.25, *reloaded.estimate("ShowField", 0));
+  boost::filesystem::remove(file);
+}
+
+namespace
+{
+  // Stand-in runtimes in seconds: the solver and assembly modules dominate real regression networks.
+  double syntheticRuntime(const std::string& moduleName)
+  {
+    static const char* heavy[] = { "BuildFEMatrix", "BuildBEMatrix", "SolveLinearSystem", "SolveInverseProblemWithTikhonov", "MapFieldData" };
+    for (auto name : heavy)
+      if (boost::starts_with(moduleName, name))
+        return 10;
+    return 1;
+  }
+
+  // List scheduling of the graph on a fixed number of workers, dispatching ready modules through
+  // the executor's WorkQueue. Returns the makespan.
+  double simulateMakespan(const DirectedGraph& g, const std::vector<double>& cost, const std::vector<double>& priority, size_t workers)
+  {
+    const size_t n = boost::num_vertices(g);
+    std::vector<size_t> waitingOn(n, 0);
+    for (size_t v = 0; v < n; ++v)
+      waitingOn[v] = in_degree(v, g);
+
+    WorkQueue<size_t> ready;
+    for (size_t v = 0; v < n; ++v)
+      if (0 == waitingOn[v])
+        ready.push(v, priority[v]);
+
+    std::multimap<double, size_t> running;
+    double now = 0;
+    size_t done = 0;
+    while (done < n)
+    {
+      while (running.size() < workers && !ready.empty())
+      {
+        size_t v;
+        WorkQueue<size_t>::Clock::duration waited;
+        ready.pop(v, waited);
+        running.insert(std::make_pair(now + cost[v], v));
+      }
+      auto next = running.begin();
+      now = next->first;
+      auto finished = next->second;
+      running.erase(next);
+      ++done;
+      DirectedGraph::out_edge_iterator e, e_end;
+      for (boost::tie(e, e_end) = out_edges(finished, g); e != e_end; ++e)
+      {
+        auto succ = target(*e, g);
+        if (0 == --waitingOn[succ])
+          ready.push(succ, priority[succ]);
+      }
+    }
+    return now;
+  }
+}
+
+TEST(CriticalPathBenchmark, DISABLED_RegressionNetworkMakespans)
+{
+  const size_t workers = 2;
+  double totalFifo = 0, totalCriticalPath = 0;
+  size_t networks = 0;
+
+  boost::filesystem::path dir(SCIRUN_EXAMPLE_NETS_DIR);
+  dir /= "regression";
+  for (boost::filesystem::directory_iterator file(dir), end; file != end; ++file)
+  {
+    if (file->path().extension() != ".srn5")
+      continue;
+    auto networkFile = XMLSerializer::load_xml<NetworkFile>(file->path().string());
+    if (!networkFile || networkFile->network.modules.empty())
+      continue;
+
+    std::map<std::string, int> vertexOf;
+    std::vector<double> cost;
+    for (const auto& module : networkFile->network.modules)
+    {
+      vertexOf[module.first] = static_cast<int>(cost.size());
+      cost.push_back(syntheticRuntime(module.second.module.module_name_));
+    }
+    std::vector<Edge> edges;
+    for (const auto& cd : networkFile->network.connections)
+      edges.push_back(Edge(vertexOf[cd.out_.moduleId_.id_], vertexOf[cd.in_.moduleId_.id_]));
+    DirectedGraph g(edges.begin(), edges.end(), cost.size());
+
+    std::vector<double> pathLengths;
+    try
+    {
+      pathLengths = criticalPathLengths(g, cost);
+    }
+    catch (boost::not_a_dag&)
+    {
+      continue;
+    }
+    std::vector<double> fifo(cost.size(), 0);
+    auto fifoMakespan = simulateMakespan(g, cost, fifo, workers);
+    auto criticalPathMakespan = simulateMakespan(g, cost, pathLengths, workers);
+    if (criticalPathMakespan != fifoMakespan)
+      std::cout << file->path().filename().string() << ": " << fifoMakespan << "s -> " << criticalPathMakespan << "s" << std::endl;
+
+    totalFifo += fifoMakespan;
+    totalCriticalPath += criticalPathMakespan;
+    ++networks;
+  }
+
+  std::cout << networks << " networks on " << workers << " workers, total makespan FIFO " << totalFifo
+    << "s, critical path " << totalCriticalPath << "s" << std::endl;
+  EXPECT_GT(networks, 0);
+  EXPECT_LE(totalCriticalPath, totalFifo);
+}
@@ -28,10 +28,90 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkQueue.h>
+#include <Dataflow/Engine/Scheduler/DynamicExecutor/ExecutionStatistics.h>
+#include <boost/thread/thread.hpp>
+#include <ctime>
 
 using ::testing::_;
 using ::testing::NiceMock;
 using ::testing::DefaultValue;
 using ::testing::Return;
+using namespace SCIRun::Dataflow::Engine::DynamicExecutor;
 
-/// @todo DAN
\ No newline at end of file
+/// @todo DAN
+
+TEST(DynamicExecutorWorkQueueTest, PopBlocksUntilPush)
+{
+  WorkQueue<int> queue;
+  int popped = 0;
+  boost::thread consumer([&]()
+  {
+    WorkQueue<int>::Clock::duration waited;
+    queue.pop(popped, waited);
+  });
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+  EXPECT_EQ(0, popped);
+  queue.push(7);
+  consumer.join();
+  EXPECT_EQ(7, popped);
+}
+
+TEST(DynamicExecutorWorkQueueTest, CloseReleasesConsumersAfterDraining)
+{
+  WorkQueue<int> queue;
+  queue.push(1);
+  queue.push(2);
+  queue.close();
+
+  int unit;
+  WorkQueue<int>::Clock::duration waited;
+  EXPECT_TRUE(queue.pop(unit, waited));
+  EXPECT_EQ(1, unit);
+  EXPECT_TRUE(queue.pop(unit, waited));
+  EXPECT_EQ(2, unit);
+  EXPECT_FALSE(queue.pop(unit, waited));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(DynamicExecutorWorkQueueTest, IdleConsumersDoNotSpin)
+{
+  WorkQueue<int> queue;
+  boost::thread_group consumers;
+  for (int i = 0; i < 4; ++i)
+  {
+    consumers.create_thread([&]()
+    {
+      int unit;
+      WorkQueue<int>::Clock::duration waited;
+      while (queue.pop(unit, waited)) {}
+    });
+  }
+  auto cpuStart = std::clock();
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(200));
+  auto cpuUsed = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+  queue.close();
+  consumers.join_all();
+  EXPECT_LT(cpuUsed, 0.05);
+}
+
+TEST(DynamicExecutorStatisticsTest, AccumulatesTimings)
+{
+  ExecutionStatisticsCollector collector;
+  collector.reset(2);
+  collector.moduleDequeued(0.5, 0.25);
+  collector.moduleDequeued(1.5, 0.0);
+  collector.moduleFinished(2.0);
+  collector.moduleFinished(3.0);
+  collector.workerIdle(0.75);
+  collector.executionFinished(4.0);
+
+  auto stats = collector.snapshot();
+  EXPECT_EQ(2, stats.workers);
+  EXPECT_EQ(2, stats.modulesExecuted);
+  EXPECT_DOUBLE_EQ(2.0, stats.totalQueueWait);
+  EXPECT_DOUBLE_EQ(1.5, stats.maxQueueWait);
+  EXPECT_DOUBLE_EQ(5.0, stats.totalModuleRun);
+  EXPECT_DOUBLE_EQ(1.0, stats.totalWorkerIdle);
+  EXPECT_DOUBLE_EQ(4.0, stats.wallTime);
+}
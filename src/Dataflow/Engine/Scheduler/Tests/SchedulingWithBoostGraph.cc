@@ -45,6 +45,7 @@
 #include <Dataflow/Engine/Scheduler/BoostGraphSerialScheduler.h>
 #include <Dataflow/Engine/Scheduler/LinearSerialNetworkExecutor.h>
 #include <Dataflow/Engine/Scheduler/BoostGraphParallelScheduler.h>
+#include <Dataflow/Engine/Scheduler/ModuleRuntimeHistory.h>
 #include <Dataflow/Engine/Scheduler/BasicMultithreadedNetworkExecutor.h>
 #include <Dataflow/Engine/Scheduler/BasicParallelExecutionStrategy.h>
 #include <Core/Algorithms/Factory/HardCodedAlgorithmFactory.h>
@@ -53,6 +54,7 @@
 
 #include <boost/config.hpp> // put this first to suppress some VC++ warnings
 #include <boost/lockfree/spsc_queue.hpp>
+#include <boost/filesystem.hpp>
 
 #include <iostream>
 #include <iterator>
@@ -341,6 +343,30 @@ TEST_F(SchedulingWithBoostGraph, ParallelNetworkOrder)
   EXPECT_EQ(expected, ostr.str());
 }
 
+TEST_F(SchedulingWithBoostGraph, CriticalPathPrioritiesBeforeAnyModuleHasRun)
+{
+  setupBasicNetwork();
+
+  // Nothing has executed, so no input port holds data and input sizes are unknown.
+  ModuleRuntimeHistory history(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path());
+  history.record("CreateMatrix", 0, 0.01);
+  history.record("EvaluateLinearAlgebraUnary", 1 << 20, 0.1);
+  history.record("EvaluateLinearAlgebraBinary", 100 << 20, 20.0);
+  history.record("ReportMatrixInfo", 100 << 20, 0.01);
+
+  BoostGraphParallelScheduler scheduler(ExecuteAllModules::Instance(), &history);
+  auto order = scheduler.schedule(matrixMathNetwork);
+
+  // multiply -> add -> report is the critical path
+  EXPECT_NEAR(20.01, order.priorityOf(ModuleId("EvaluateLinearAlgebraBinary:6")), 1e-9);
+  EXPECT_NEAR(40.01, order.priorityOf(ModuleId("EvaluateLinearAlgebraBinary:5")), 1e-9);
+  EXPECT_NEAR(40.11, order.priorityOf(ModuleId("EvaluateLinearAlgebraUnary:3")), 1e-9);
+  EXPECT_NEAR(20.11, order.priorityOf(ModuleId("EvaluateLinearAlgebraUnary:2")), 1e-9);
+  EXPECT_NEAR(40.12, order.priorityOf(ModuleId("CreateMatrix:0")), 1e-9);
+  EXPECT_NEAR(40.12, order.priorityOf(ModuleId("CreateMatrix:1")), 1e-9);
+  EXPECT_NEAR(0.01, order.priorityOf(ModuleId("ReportMatrixInfo:7")), 1e-9);
+}
+
 TEST_F(SchedulingWithBoostGraph, ParallelNetworkOrderWithSomeModulesDone)
 {
   setupBasicNetwork();
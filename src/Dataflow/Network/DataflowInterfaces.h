@@ -48,6 +48,8 @@ namespace Networks {
     virtual void send(DatatypeSinkInterfaceHandle receiver) const = 0;
     virtual bool hasData() const = 0;
     virtual std::string describeData() const = 0;
+    /// Seconds the producing module took; sources that may evict their data use it to rank entries.
+    virtual void setRecomputeCost(double) {}
   };
 
   typedef boost::signals2::signal<void(SCIRun::Core::Datatypes::DatatypeHandle)> DataHasChangedSignalType;
@@ -0,0 +1,385 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/ExecutionCache.h>
+#include <Dataflow/Network/ModuleInterface.h>
+#include <Dataflow/Network/ModuleStateInterface.h>
+#include <Dataflow/Network/PortInterface.h>
+#include <Core/Datatypes/ContentHash.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/MatrixIO.h>
+#include <Core/Logging/ApplicationHelper.h>
+#include <Core/Logging/Log.h>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Logging;
+
+namespace
+{
+  // bump when the key or file layout changes so stale entries are never matched
+  const int CacheFormatVersion = 1;
+  const char* ManifestName = "manifest.txt";
+
+  // modules may send null on ports they do not fill
+  enum StoredType { STORED_FIELD, STORED_MATRIX, STORED_NULL };
+
+  uintmax_t directorySize(const boost::filesystem::path& dir)
+  {
+    uintmax_t bytes = 0;
+    for (boost::filesystem::directory_iterator file(dir), end; file != end; ++file)
+    {
+      if (boost::filesystem::is_regular_file(file->status()))
+        bytes += boost::filesystem::file_size(file->path());
+    }
+    return bytes;
+  }
+
+  uint64_t now()
+  {
+    return static_cast<uint64_t>(std::time(nullptr));
+  }
+
+  std::string& applicationVersion()
+  {
+    static std::string version;
+    return version;
+  }
+}
+
+ExecutionCache& ExecutionCache::instance()
+{
+  static ExecutionCache cache(ApplicationHelper().configDirectory() / "execution_cache", uintmax_t(1) << 30);
+  return cache;
+}
+
+ExecutionCache::ExecutionCache(const boost::filesystem::path& directory, uintmax_t maxBytes) :
+  directory_(directory), maxBytes_(maxBytes), enabled_(false), indexLoaded_(false), bytesUsed_(0), clock_(0),
+  hits_(0), misses_(0)
+{
+}
+
+std::string ExecutionCache::composeKey(const std::string& moduleName, const ModuleStateInterface& state, const std::vector<uint64_t>& inputHashes)
+{
+  ContentHasher hasher;
+  hasher.add(CacheFormatVersion).add(applicationVersion()).add(moduleName);
+
+  // getKeys comes from a std::map, so the order is stable
+  for (const auto& name : state.getKeys())
+  {
+    std::ostringstream value;
+    value << std::setprecision(17) << state.getValue(name);
+    hasher.add(name.name()).add(value.str());
+  }
+  hasher.add(inputHashes.size());
+  for (auto h : inputHashes)
+    hasher.add(h);
+
+  std::ostringstream key;
+  key << moduleName << '-' << std::hex << std::setw(16) << std::setfill('0') << hasher.value();
+  return key.str();
+}
+
+void ExecutionCache::setApplicationVersion(const std::string& version)
+{
+  applicationVersion() = version;
+}
+
+boost::optional<std::string> ExecutionCache::keyFor(ModuleInterface& module)
+{
+  auto state = module.get_state();
+  if (!state)
+    return boost::none;
+
+  std::vector<uint64_t> inputHashes;
+  for (const auto& input : module.inputPorts())
+  {
+    auto data = input->getData();
+    if (!data || !*data)
+    {
+      inputHashes.push_back(0);
+      continue;
+    }
+    auto hash = (*data)->contentHash();
+    if (0 == hash)
+      return boost::none;
+    inputHashes.push_back(hash);
+  }
+  return composeKey(module.get_module_name(), *state, inputHashes);
+}
+
+boost::filesystem::path ExecutionCache::entryDirectory(const std::string& key) const
+{
+  return directory_ / key;
+}
+
+void ExecutionCache::loadIndex() const
+{
+  if (indexLoaded_)
+    return;
+  indexLoaded_ = true;
+
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_directory(directory_, ec))
+    return;
+
+  for (boost::filesystem::directory_iterator dir(directory_, ec), end; !ec && dir != end; ++dir)
+  {
+    auto manifest = dir->path() / ManifestName;
+    if (!boost::filesystem::exists(manifest))
+      continue;
+    Entry entry;
+    entry.bytes = directorySize(dir->path());
+    entry.lastUsed = static_cast<uint64_t>(boost::filesystem::last_write_time(manifest));
+    index_[dir->path().filename().string()] = entry;
+    bytesUsed_ += entry.bytes;
+    clock_ = std::max(clock_, entry.lastUsed);
+  }
+}
+
+bool ExecutionCache::lookup(const std::string& key, Outputs& outputs)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  loadIndex();
+  auto entry = index_.find(key);
+  if (!enabled_ || entry == index_.end())
+  {
+    ++misses_;
+    return false;
+  }
+
+  Outputs restored;
+  try
+  {
+    auto dir = entryDirectory(key);
+    std::ifstream manifest((dir / ManifestName).string());
+    size_t portIndex;
+    int type;
+    std::string portName;
+    for (size_t i = 0; manifest >> portIndex >> type >> std::ws && std::getline(manifest, portName); ++i)
+    {
+      DatatypeHandle data;
+      if (STORED_NULL == type)
+      {
+        restored.push_back(std::make_pair(PortId(portIndex, portName), data));
+        continue;
+      }
+      auto stream = auto_istream((dir / (boost::lexical_cast<std::string>(i) + ".out")).string());
+      if (!stream)
+        throw std::runtime_error("missing output file");
+      if (STORED_FIELD == type)
+      {
+        FieldHandle field;
+        Pio(*stream, field);
+        data = field;
+      }
+      else
+      {
+        MatrixHandle matrix;
+        Pio(*stream, matrix);
+        data = matrix;
+      }
+      if (!data)
+        throw std::runtime_error("unreadable output file");
+      restored.push_back(std::make_pair(PortId(portIndex, portName), data));
+    }
+    if (restored.empty())
+      throw std::runtime_error("empty manifest");
+  }
+  catch (std::exception& e)
+  {
+    LOG_DEBUG("Discarding execution cache entry {}: {}", key, e.what());
+    bytesUsed_ -= entry->second.bytes;
+    index_.erase(entry);
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(entryDirectory(key), ec);
+    ++misses_;
+    return false;
+  }
+
+  clock_ = std::max(clock_ + 1, now());
+  entry->second.lastUsed = clock_;
+  boost::system::error_code ec;
+  boost::filesystem::last_write_time(entryDirectory(key) / ManifestName, static_cast<std::time_t>(clock_), ec);
+  ++hits_;
+  outputs.swap(restored);
+  return true;
+}
+
+bool ExecutionCache::store(const std::string& key, const Outputs& outputs)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  if (!enabled_ || outputs.empty())
+    return false;
+  loadIndex();
+  if (index_.find(key) != index_.end())
+    return true;
+
+  for (const auto& output : outputs)
+  {
+    if (output.second && !boost::dynamic_pointer_cast<Field>(output.second) && !boost::dynamic_pointer_cast<Matrix>(output.second))
+      return false;
+  }
+
+  auto dir = entryDirectory(key);
+  try
+  {
+    boost::filesystem::create_directories(dir);
+    std::ostringstream manifest;
+    for (size_t i = 0; i < outputs.size(); ++i)
+    {
+      if (!outputs[i].second)
+      {
+        manifest << outputs[i].first.id << ' ' << STORED_NULL << ' ' << outputs[i].first.name << '\n';
+        continue;
+      }
+      auto stream = auto_ostream((dir / (boost::lexical_cast<std::string>(i) + ".out")).string(), "Binary");
+      if (!stream || stream->error())
+        throw std::runtime_error("cannot open output file");
+      auto field = boost::dynamic_pointer_cast<Field>(outputs[i].second);
+      auto matrix = boost::dynamic_pointer_cast<Matrix>(outputs[i].second);
+      if (field)
+        Pio(*stream, field);
+      else
+        Pio(*stream, matrix);
+      if (stream->error())
+        throw std::runtime_error("write failed");
+      manifest << outputs[i].first.id << ' ' << (field ? STORED_FIELD : STORED_MATRIX) << ' ' << outputs[i].first.name << '\n';
+    }
+    // written last, so an interrupted store is never picked up by loadIndex
+    std::ofstream((dir / ManifestName).string()) << manifest.str();
+  }
+  catch (std::exception& e)
+  {
+    LOG_DEBUG("Could not store execution cache entry {}: {}", key, e.what());
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(dir, ec);
+    return false;
+  }
+
+  clock_ = std::max(clock_ + 1, now());
+  Entry entry = { directorySize(dir), clock_ };
+  boost::system::error_code ec;
+  boost::filesystem::last_write_time(dir / ManifestName, static_cast<std::time_t>(clock_), ec);
+  index_[key] = entry;
+  bytesUsed_ += entry.bytes;
+  evict();
+  return true;
+}
+
+void ExecutionCache::evict()
+{
+  while (bytesUsed_ > maxBytes_ && !index_.empty())
+  {
+    auto oldest = std::min_element(index_.begin(), index_.end(),
+      [](const std::pair<const std::string, Entry>& a, const std::pair<const std::string, Entry>& b) { return a.second.lastUsed < b.second.lastUsed; });
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(entryDirectory(oldest->first), ec);
+    bytesUsed_ -= oldest->second.bytes;
+    index_.erase(oldest);
+  }
+}
+
+bool ExecutionCache::contains(const std::string& key) const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  loadIndex();
+  return index_.find(key) != index_.end();
+}
+
+void ExecutionCache::clear()
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  loadIndex();
+  for (const auto& entry : index_)
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(entryDirectory(entry.first), ec);
+  }
+  index_.clear();
+  bytesUsed_ = 0;
+}
+
+bool ExecutionCache::enabled() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  return enabled_;
+}
+
+void ExecutionCache::setEnabled(bool enabled)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  enabled_ = enabled;
+}
+
+uintmax_t ExecutionCache::maxBytes() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  return maxBytes_;
+}
+
+void ExecutionCache::setMaxBytes(uintmax_t bytes)
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  maxBytes_ = bytes;
+  loadIndex();
+  evict();
+}
+
+uintmax_t ExecutionCache::bytesUsed() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  loadIndex();
+  return bytesUsed_;
+}
+
+size_t ExecutionCache::numberOfEntries() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  loadIndex();
+  return index_.size();
+}
+
+size_t ExecutionCache::hits() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  return hits_;
+}
+
+size_t ExecutionCache::misses() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex_);
+  return misses_;
+}
@@ -0,0 +1,108 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DATAFLOW_NETWORK_EXECUTIONCACHE_H
+#define DATAFLOW_NETWORK_EXECUTIONCACHE_H
+
+#include <Dataflow/Network/NetworkFwd.h>
+#include <Dataflow/Network/ModuleDescription.h>
+#include <Core/Datatypes/Datatype.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <vector>
+#include <Dataflow/Network/share.h>
+
+namespace SCIRun
+{
+  namespace Dataflow
+  {
+    namespace Networks
+    {
+      /// On-disk memo of module outputs, shared across sessions. Entries are keyed by
+      /// module type, module state and the content hashes of the inputs, and hold the
+      /// persisted output port data. The least recently used entries are removed once
+      /// the cache grows past its size bound. The cache is off until enabled, see
+      /// the --exec-cache-mb command line option.
+      class SCISHARE ExecutionCache : boost::noncopyable
+      {
+      public:
+        typedef std::vector<std::pair<PortId, Core::Datatypes::DatatypeHandle>> Outputs;
+
+        /// Stored under the configuration directory, bounded to 1 GB and disabled.
+        static ExecutionCache& instance();
+        ExecutionCache(const boost::filesystem::path& directory, uintmax_t maxBytes);
+
+        /// None if some connected input has no content hash.
+        static boost::optional<std::string> keyFor(ModuleInterface& module);
+        static std::string composeKey(const std::string& moduleName, const ModuleStateInterface& state, const std::vector<uint64_t>& inputHashes);
+        /// Part of every key, so that results of another build are never replayed.
+        static void setApplicationVersion(const std::string& version);
+
+        bool lookup(const std::string& key, Outputs& outputs);
+        /// Returns false, and stores nothing, if some output type cannot be persisted.
+        bool store(const std::string& key, const Outputs& outputs);
+        bool contains(const std::string& key) const;
+        void clear();
+
+        bool enabled() const;
+        void setEnabled(bool enabled);
+        uintmax_t maxBytes() const;
+        void setMaxBytes(uintmax_t bytes);
+        uintmax_t bytesUsed() const;
+        size_t numberOfEntries() const;
+        size_t hits() const;
+        size_t misses() const;
+
+      private:
+        struct Entry
+        {
+          uintmax_t bytes;
+          uint64_t lastUsed;
+        };
+        void loadIndex() const;
+        void evict();
+        boost::filesystem::path entryDirectory(const std::string& key) const;
+
+        boost::filesystem::path directory_;
+        uintmax_t maxBytes_;
+        bool enabled_;
+        mutable bool indexLoaded_;
+        mutable std::map<std::string, Entry> index_;
+        mutable uintmax_t bytesUsed_;
+        mutable uint64_t clock_;
+        size_t hits_, misses_;
+        mutable boost::mutex mutex_;
+      };
+    }
+  }
+}
+
+#endif
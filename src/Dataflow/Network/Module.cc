@@ -45,6 +45,7 @@
 // ReSharper disable once CppUnusedIncludeDirective
 #include <Dataflow/Network/DataflowInterfaces.h>
 #include <Dataflow/Network/ModuleBuilder.h>
+#include <Dataflow/Network/ExecutionCache.h>
 #include <Core/Logging/ConsoleLogger.h>
 #include <Core/Logging/Log.h>
 #include <Core/Thread/Mutex.h>
@@ -191,6 +192,9 @@ namespace SCIRun
         LoggerHandle log_;
         AlgorithmStatusReporter::UpdaterFunc updaterFunc_;
         UiToggleFunc uiToggleFunc_;
+
+        boost::optional<std::string> lastExecutionCacheKey_;
+        boost::optional<ExecutionCache::Outputs> recordedOutputs_;
       };
     }
   }
@@ -387,7 +391,7 @@ bool Module::executeWithSignals() NOEXCEPT
   try
   {
     if (!executionDisabled())
-      execute();
+      executeOrRestoreFromCache();
     returnCode = true;
   }
   catch (const std::bad_alloc&)
@@ -437,6 +441,11 @@ bool Module::executeWithSignals() NOEXCEPT
     ostr << executionTime;
     impl_->metadata_.setMetadata("Last execution duration (seconds)", ostr.str());
   }
+  for (const auto& output : outputPorts())
+  {
+    if (auto source = output->source())
+      source->setRecomputeCost(executionTime);
+  }
 
   std::ostringstream finished;
   finished << "MODULE " << get_id().id_ << " FINISHED " <<
@@ -591,6 +600,50 @@ void Module::send_output_handle(const PortId& id, DatatypeHandle data)
   }
 
   impl_->oports_[id]->sendData(data);
+  if (impl_->recordedOutputs_)
+    impl_->recordedOutputs_->push_back(std::make_pair(id, data));
+}
+
+void Module::executeOrRestoreFromCache()
+{
+  auto& cache = ExecutionCache::instance();
+  boost::optional<std::string> key;
+  if (isExecutionCacheable() && cache.enabled())
+    key = ExecutionCache::keyFor(*this);
+  if (!key)
+  {
+    execute();
+    return;
+  }
+
+  // same inputs as the last run in this session: the outputs are still on the ports, let the module's own check decide
+  ExecutionCache::Outputs outputs;
+  if (key != impl_->lastExecutionCacheKey_ && cache.lookup(*key, outputs))
+  {
+    // consume the change flags the skipped execute() would have read
+    for (const auto& input : inputPorts())
+      input->hasChanged();
+    for (const auto& output : outputs)
+      send_output_handle(output.first, output.second);
+    remark("Outputs restored from the execution cache.");
+  }
+  else
+  {
+    impl_->recordedOutputs_ = ExecutionCache::Outputs();
+    try
+    {
+      execute();
+    }
+    catch (...)
+    {
+      impl_->recordedOutputs_.reset();
+      throw;
+    }
+    if (!impl_->recordedOutputs_->empty())
+      cache.store(*key, *impl_->recordedOutputs_);
+    impl_->recordedOutputs_.reset();
+  }
+  impl_->lastExecutionCacheKey_ = key;
 }
 
 std::vector<InputPortHandle> Module::findInputPortsWithName(const std::string& name) const
@@ -75,6 +75,9 @@ namespace Networks {
     void status(const std::string& msg) const override final { getLogger()->status(msg); }
     bool needToExecute() const override final;
     bool hasDynamicPorts() const override;
+    // override (see CACHEABLE_EXECUTION) for expensive, side-effect free modules whose outputs can be memoized on disk.
+    // A cache hit skips execute(), so modules that write state there that others read (the L-curve transients, say) must not opt in.
+    virtual bool isExecutionCacheable() const { return false; }
 
     /*** public Dev-interface ****/
     boost::signals2::connection connectExecuteSelfRequest(const ExecutionSelfRequestSignalType::slot_type& subscriber) override final;
@@ -190,6 +193,7 @@ namespace Networks {
     boost::optional<boost::shared_ptr<T>> getOptionalInputAtIndex(const PortId& id);
     template <class T>
     boost::shared_ptr<T> checkInput(Core::Datatypes::DatatypeHandleOption inputOpt, const PortId& id);
+    void executeOrRestoreFromCache();
 
     friend class ModuleImpl;
     boost::shared_ptr<class ModuleImpl> impl_;
@@ -86,6 +86,7 @@ namespace Modules
   #define MODULE_INFO_DEF(moduleName, category, package) const SCIRun::Dataflow::Networks::ModuleLookupInfo moduleName::staticInfo_(#moduleName, #category, #package);
 
   #define HAS_DYNAMIC_PORTS public: virtual bool hasDynamicPorts() const override { return true; }
+  #define CACHEABLE_EXECUTION public: virtual bool isExecutionCacheable() const override { return true; }
 
   #define LEGACY_BIOPSE_MODULE public: virtual std::string legacyPackageName() const override { return "BioPSE"; }
   #define LEGACY_MATLAB_MODULE public: virtual std::string legacyPackageName() const override { return "MatlabInterface"; }
@@ -0,0 +1,316 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/PortDataCache.h>
+#include <Dataflow/Network/SimpleSourceSink.h>
+#include <Core/Logging/Log.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <limits>
+#include <set>
+
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Datatypes;
+
+PortDataCache& PortDataCache::instance()
+{
+  // never destroyed: sources held by static objects unregister during exit
+  static PortDataCache* cache = new PortDataCache;
+  return *cache;
+}
+
+PortDataCache::PortDataCache() : nextKey_(1), budget_(0), bytesInMemory_(0), spills_(0), reloads_(0), inflation_(0),
+  spillDirectory_(boost::filesystem::temp_directory_path() / "scirun_port_cache")
+{
+}
+
+PortDataCache::~PortDataCache()
+{
+}
+
+void PortDataCache::setMemoryBudget(size_t bytes)
+{
+  {
+    Guard g(mutex_);
+    budget_ = bytes;
+  }
+  enforceBudget(0);
+}
+
+size_t PortDataCache::memoryBudget() const
+{
+  Guard g(mutex_);
+  return budget_;
+}
+
+void PortDataCache::setSpillDirectory(const boost::filesystem::path& dir)
+{
+  Guard g(mutex_);
+  spillDirectory_ = dir;
+}
+
+boost::filesystem::path PortDataCache::spillDirectory() const
+{
+  Guard g(mutex_);
+  return spillDirectory_;
+}
+
+size_t PortDataCache::bytesInMemory() const
+{
+  Guard g(mutex_);
+  return bytesInMemory_;
+}
+
+size_t PortDataCache::spillCount() const
+{
+  Guard g(mutex_);
+  return spills_;
+}
+
+size_t PortDataCache::reloadCount() const
+{
+  Guard g(mutex_);
+  return reloads_;
+}
+
+bool PortDataCache::isSpilled(Key key) const
+{
+  Guard g(mutex_);
+  auto entry = entries_.find(key);
+  return entry != entries_.end() && entry->second.source->spilledType_ != SimpleSource::NOT_SPILLED;
+}
+
+PortDataCache::Key PortDataCache::add(SimpleSource* source)
+{
+  Guard g(mutex_);
+  Entry entry = { source, 0, 1.0, 0.0, false, false };
+  refresh(entry);
+  entries_[nextKey_] = entry;
+  return nextKey_++;
+}
+
+void PortDataCache::remove(Key key)
+{
+  Guard g(mutex_);
+  released(key);
+  entries_.erase(key);
+}
+
+void PortDataCache::stored(Key key, size_t bytes)
+{
+  Guard g(mutex_);
+  auto entry = entries_.find(key);
+  if (entry == entries_.end())
+    return;
+  if (entry->second.inMemory)
+    bytesInMemory_ -= entry->second.bytes;
+  entry->second.bytes = bytes;
+  entry->second.inMemory = true;
+  bytesInMemory_ += bytes;
+  refresh(entry->second);
+}
+
+void PortDataCache::released(Key key)
+{
+  Guard g(mutex_);
+  auto entry = entries_.find(key);
+  if (entry == entries_.end() || !entry->second.inMemory)
+    return;
+  bytesInMemory_ -= entry->second.bytes;
+  entry->second.inMemory = false;
+}
+
+void PortDataCache::touched(Key key)
+{
+  Guard g(mutex_);
+  auto entry = entries_.find(key);
+  if (entry != entries_.end())
+    refresh(entry->second);
+}
+
+void PortDataCache::setRecomputeCost(Key key, double seconds)
+{
+  Guard g(mutex_);
+  auto entry = entries_.find(key);
+  if (entry != entries_.end())
+  {
+    // a module that finished instantly still costs something to run again
+    entry->second.cost = std::max(seconds, 1e-3);
+    refresh(entry->second);
+  }
+}
+
+DatatypeHandle PortDataCache::fetch(Key key, size_t* generation)
+{
+  for (;;)
+  {
+    SimpleSource::SpilledType type;
+    boost::filesystem::path file;
+    {
+      Guard g(mutex_);
+      auto entry = entries_.find(key);
+      if (entry == entries_.end())
+        return nullptr;
+      auto source = entry->second.source;
+      if (generation)
+        *generation = source->generation_;
+      if (source->spilledType_ == SimpleSource::NOT_SPILLED)
+      {
+        refresh(entry->second);
+        return source->data_;
+      }
+      type = source->spilledType_;
+      file = source->spillFile_;
+    }
+
+    auto data = SimpleSource::readSpill(type, file);
+
+    boost::filesystem::path stale;
+    {
+      Guard g(mutex_);
+      // the source may have been destroyed, refilled or reloaded by another sink meanwhile
+      auto entry = entries_.find(key);
+      if (entry == entries_.end())
+        return nullptr;
+      auto source = entry->second.source;
+      if (source->spillFile_ != file)
+        continue;
+      if (generation)
+        *generation = source->generation_;
+      if (!data)
+        LOG_DEBUG("Could not reload spilled port data from {}", file.string());
+      source->data_ = data;
+      stale = source->releaseSpillFile();
+      if (data)
+      {
+        ++reloads_;
+        stored(key, data->sizeInBytes());
+      }
+    }
+    SimpleSource::removeFile(stale);
+    enforceBudget(key);
+    return data;
+  }
+}
+
+boost::filesystem::path PortDataCache::newSpillFile() const
+{
+  auto dir = spillDirectory();
+  boost::filesystem::create_directories(dir);
+  return dir / boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%.port");
+}
+
+void PortDataCache::refresh(Entry& entry)
+{
+  entry.priority = inflation_ + entry.cost / std::max<size_t>(entry.bytes, 1);
+}
+
+void PortDataCache::enforceBudget(Key justStored)
+{
+  // the value being stored is about to be sent, so spilling it would only cost a reload
+  std::set<Key> considered;
+  considered.insert(justStored);
+
+  for (;;)
+  {
+    Key key = 0;
+    DatatypeHandle data;
+    SimpleSource::SpilledType type;
+    size_t generation;
+    {
+      Guard g(mutex_);
+      if (0 == budget_ || bytesInMemory_ <= budget_)
+        return;
+
+      auto lowest = std::numeric_limits<double>::max();
+      for (const auto& entry : entries_)
+      {
+        if (entry.second.inMemory && !entry.second.spilling && entry.second.bytes > 0
+          && entry.second.priority < lowest && considered.count(entry.first) == 0)
+        {
+          key = entry.first;
+          lowest = entry.second.priority;
+        }
+      }
+      if (0 == key)
+        return;
+      considered.insert(key);
+
+      auto& entry = entries_[key];
+      auto source = entry.source;
+      type = SimpleSource::spillTypeOf(source->data_);
+      // releasing a value someone else still holds would not free anything
+      if (type == SimpleSource::NOT_SPILLED || !source->data_.unique())
+        continue;
+      data = source->data_;
+      generation = source->generation_;
+      entry.spilling = true;
+    }
+
+    // sinks keep reading the in-memory value while it is written out
+    boost::filesystem::path file;
+    std::string description;
+    auto written = false;
+    try
+    {
+      file = newSpillFile();
+      description = SimpleSource::describe(data);
+      written = SimpleSource::writeSpill(data, type, file);
+    }
+    catch (std::exception& e)
+    {
+      LOG_DEBUG("Port data spill to {} failed: {}", file.string(), e.what());
+    }
+
+    auto kept = false;
+    {
+      Guard g(mutex_);
+      auto entry = entries_.find(key);
+      if (entry != entries_.end())
+      {
+        entry->second.spilling = false;
+        auto source = entry->second.source;
+        // our copy is the only other reference, and the source has not moved on
+        if (written && source->data_ == data && source->generation_ == generation && data.use_count() == 2)
+        {
+          source->data_.reset();
+          source->spilledType_ = type;
+          source->spillFile_ = file;
+          source->spilledDescription_ = description;
+          bytesInMemory_ -= entry->second.bytes;
+          entry->second.inMemory = false;
+          inflation_ = entry->second.priority;
+          ++spills_;
+          kept = true;
+        }
+      }
+    }
+    if (written && !kept)
+      SimpleSource::removeFile(file);
+  }
+}
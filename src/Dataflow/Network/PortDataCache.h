@@ -0,0 +1,119 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DATAFLOW_NETWORK_PORTDATACACHE_H
+#define DATAFLOW_NETWORK_PORTDATACACHE_H
+
+#include <Core/Datatypes/Datatype.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <map>
+#include <Dataflow/Network/share.h>
+
+namespace SCIRun
+{
+  namespace Dataflow
+  {
+    namespace Networks
+    {
+      class SimpleSource;
+
+      /// Tracks the data held by every SimpleSource against a global memory budget.
+      /// When the budget is exceeded, the entry with the lowest GreedyDual-Size
+      /// priority (recompute cost per byte, aged by an inflation value) is written
+      /// to the spill directory and released; it is read back the next time a sink
+      /// asks for it. A budget of zero, the default, disables eviction.
+      /// Spill files are written and read without holding mutex(), so callers of
+      /// fetch, setMemoryBudget and enforceBudget must not hold it either.
+      class SCISHARE PortDataCache : boost::noncopyable
+      {
+      public:
+        typedef size_t Key;
+        typedef boost::recursive_mutex Mutex;
+        typedef boost::lock_guard<Mutex> Guard;
+
+        static PortDataCache& instance();
+        PortDataCache();
+        ~PortDataCache();
+
+        void setMemoryBudget(size_t bytes);
+        size_t memoryBudget() const;
+        void setSpillDirectory(const boost::filesystem::path& dir);
+        boost::filesystem::path spillDirectory() const;
+
+        size_t bytesInMemory() const;
+        size_t spillCount() const;
+        size_t reloadCount() const;
+        bool isSpilled(Key key) const;
+
+        /// Re-reads spilled data for a sink whose weak reference expired; null if the source is gone.
+        /// generation, if given, receives the source generation the returned value belongs to.
+        Core::Datatypes::DatatypeHandle fetch(Key key, size_t* generation = nullptr);
+
+        Key add(SimpleSource* source);
+        void remove(Key key);
+        /// The source now holds this many bytes in memory. Does not evict, see enforceBudget.
+        void stored(Key key, size_t bytes);
+        void released(Key key);
+        void touched(Key key);
+        void setRecomputeCost(Key key, double seconds);
+        /// Spills the cheapest entries other than justStored until the budget holds.
+        void enforceBudget(Key justStored);
+
+        Mutex& mutex() const { return mutex_; }
+        boost::filesystem::path newSpillFile() const;
+
+      private:
+        struct Entry
+        {
+          SimpleSource* source;
+          size_t bytes;
+          double cost;
+          double priority;
+          bool inMemory;
+          bool spilling;
+        };
+        void refresh(Entry& entry);
+
+        std::map<Key, Entry> entries_;
+        Key nextKey_;
+        size_t budget_;
+        size_t bytesInMemory_;
+        size_t spills_;
+        size_t reloads_;
+        double inflation_;
+        boost::filesystem::path spillDirectory_;
+        mutable Mutex mutex_;
+      };
+    }
+  }
+}
+
+#endif
@@ -31,6 +31,12 @@ DEALINGS IN THE SOFTWARE.
 #include <iostream>
 #include <Dataflow/Network/SimpleSourceSink.h>
 #include <Core/Logging/Log.h>
+#include <Core/Datatypes/CopyOnWrite.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/MatrixIO.h>
+#include <Core/Persistent/Persistent.h>
+#include <boost/filesystem.hpp>
+#include <vector>
 // don't really like this dependency
 #include <Core/Algorithms/Describe/DescribeDatatype.h>
 
@@ -39,6 +45,8 @@ using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Algorithms::General;
 
 SimpleSink::SimpleSink() :
+  sourceKey_(0),
+  sourceGeneration_(0),
   hasChanged_(false),
   checkForNewDataOnSetting_(false)
 {
@@ -83,10 +91,19 @@ DatatypeHandleOption SimpleSink::receive()
   {
     return strong;
   }
+  // the source may have spilled its data to disk under memory pressure
+  if (sourceKey_ != 0)
+  {
+    if (auto reloaded = PortDataCache::instance().fetch(sourceKey_))
+    {
+      weakData_ = reloaded;
+      return reloaded;
+    }
+  }
   return DatatypeHandleOption();
 }
 
-void SimpleSink::setData(DatatypeHandle data)
+bool SimpleSink::setData(DatatypeHandle data, PortDataCache::Key source, size_t generation)
 {
   if (auto strong = weakData_.lock())
   {
@@ -97,12 +114,16 @@ void SimpleSink::setData(DatatypeHandle data)
   }
   else if (data)
   {
-    hasChanged_ = true;
+    // a reloaded spill has a fresh id but the same contents
+    hasChanged_ = source == 0 || source != sourceKey_ || generation != sourceGeneration_;
   }
 
+  sourceKey_ = source;
+  sourceGeneration_ = generation;
   weakData_ = data;
   if (data && hasChanged_ && checkForNewDataOnSetting_)
     dataHasChanged_(data);
+  return data && hasChanged_;
 }
 
 void SimpleSink::forceFireDataHasChanged()
@@ -131,7 +152,18 @@ boost::signals2::connection SimpleSink::connectDataHasChanged(const DataHasChang
 
 void SimpleSource::cacheData(DatatypeHandle data)
 {
-  data_ = data;
+  auto& cache = PortDataCache::instance();
+  boost::filesystem::path stale;
+  {
+    PortDataCache::Guard g(cache.mutex());
+    stale = releaseSpillFile();
+    data_ = data;
+    ++generation_;
+    receivers_ = 0;
+    cache.stored(cacheKey_, data ? data->sizeInBytes() : 0);
+  }
+  removeFile(stale);
+  cache.enforceBudget(cacheKey_);
 }
 
 void SimpleSource::send(DatatypeSinkInterfaceHandle receiver) const
@@ -140,34 +172,144 @@ void SimpleSource::send(DatatypeSinkInterfaceHandle receiver) const
   if (!sink)
     THROW_INVALID_ARGUMENT("SimpleSource can only send to SimpleSinks");
 
-  sink->setData(data_);
+  size_t generation;
+  auto data = PortDataCache::instance().fetch(cacheKey_, &generation);
+  if (sink->setData(data, cacheKey_, generation))
+  {
+    // Every receiver shares the source's instance, CopyOnWrite counts the ones that had to
+    // copy. The first receiver would have held the data anyway, so it saves nothing.
+    PortDataCache::Guard g(PortDataCache::instance().mutex());
+    if (generation == generation_ && receivers_++ > 0)
+      CopyOnWriteStatistics::recordShared(data->sizeInBytes());
+  }
 }
 
 bool SimpleSource::hasData() const
 {
-  return data_ != nullptr;
+  PortDataCache::Guard g(PortDataCache::instance().mutex());
+  return data_ != nullptr || spilledType_ != NOT_SPILLED;
+}
+
+void SimpleSource::setRecomputeCost(double seconds)
+{
+  PortDataCache::instance().setRecomputeCost(cacheKey_, seconds);
 }
 
-SimpleSource::SimpleSource()
+SimpleSource::SimpleSource() : generation_(0), receivers_(0), spilledType_(NOT_SPILLED)
 {
   instances_.insert(this);
+  cacheKey_ = PortDataCache::instance().add(this);
 }
 
 SimpleSource::~SimpleSource()
 {
   instances_.erase(this);
+  boost::filesystem::path stale;
+  {
+    PortDataCache::Guard g(PortDataCache::instance().mutex());
+    stale = releaseSpillFile();
+    PortDataCache::instance().remove(cacheKey_);
+  }
+  removeFile(stale);
 }
 
 std::set<SimpleSource*> SimpleSource::instances_;
 
 void SimpleSource::clearAllSources()
 {
-  for (auto source : instances_)
-    source->data_.reset();
+  auto& cache = PortDataCache::instance();
+  std::vector<boost::filesystem::path> stale;
+  {
+    PortDataCache::Guard g(cache.mutex());
+    for (auto source : instances_)
+    {
+      source->data_.reset();
+      stale.push_back(source->releaseSpillFile());
+      cache.released(source->cacheKey_);
+    }
+  }
+  for (const auto& file : stale)
+    removeFile(file);
 }
 
 std::string SimpleSource::describeData() const
+{
+  DatatypeHandle data;
+  {
+    PortDataCache::Guard g(PortDataCache::instance().mutex());
+    if (spilledType_ != NOT_SPILLED)
+      return spilledDescription_;
+    data = data_;
+  }
+  return describe(data);
+}
+
+std::string SimpleSource::describe(const DatatypeHandle& data)
 {
   DescribeDatatype dd;
-  return dd.describe(data_);
+  return dd.describe(data);
+}
+
+SimpleSource::SpilledType SimpleSource::spillTypeOf(const DatatypeHandle& data)
+{
+  if (boost::dynamic_pointer_cast<Field>(data))
+    return SPILLED_FIELD;
+  if (boost::dynamic_pointer_cast<Matrix>(data))
+    return SPILLED_MATRIX;
+  return NOT_SPILLED;
+}
+
+bool SimpleSource::writeSpill(const DatatypeHandle& data, SpilledType type, const boost::filesystem::path& file)
+{
+  auto stream = auto_ostream(file.string(), "Binary");
+  if (!stream || stream->error())
+    return false;
+  if (type == SPILLED_FIELD)
+  {
+    auto field = boost::dynamic_pointer_cast<Field>(data);
+    Pio(*stream, field);
+  }
+  else
+  {
+    auto matrix = boost::dynamic_pointer_cast<Matrix>(data);
+    Pio(*stream, matrix);
+  }
+  auto ok = !stream->error();
+  stream.reset();
+  if (!ok)
+    removeFile(file);
+  return ok;
+}
+
+DatatypeHandle SimpleSource::readSpill(SpilledType type, const boost::filesystem::path& file)
+{
+  auto stream = auto_istream(file.string());
+  if (!stream)
+    return nullptr;
+  if (type == SPILLED_FIELD)
+  {
+    FieldHandle field;
+    Pio(*stream, field);
+    return field;
+  }
+  MatrixHandle matrix;
+  Pio(*stream, matrix);
+  return matrix;
+}
+
+boost::filesystem::path SimpleSource::releaseSpillFile() const
+{
+  auto file = spillFile_;
+  spillFile_.clear();
+  spilledType_ = NOT_SPILLED;
+  spilledDescription_.clear();
+  return file;
+}
+
+void SimpleSource::removeFile(const boost::filesystem::path& file)
+{
+  if (file.empty())
+    return;
+  boost::system::error_code ec;
+  boost::filesystem::remove(file, ec);
 }
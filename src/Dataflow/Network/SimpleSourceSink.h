@@ -32,6 +32,7 @@
 #define DATAFLOW_NETWORK_SIMPLESOURCESINK_H
 
 #include <Dataflow/Network/DataflowInterfaces.h>
+#include <Dataflow/Network/PortDataCache.h>
 #include <boost/function.hpp>
 #include <set>
 #include <Dataflow/Network/share.h>
@@ -53,7 +54,9 @@ namespace SCIRun
         Core::Datatypes::DatatypeHandleOption receive() override;
         DatatypeSinkInterface* clone() const override;
         bool hasChanged() const override;
-        void setData(Core::Datatypes::DatatypeHandle data);
+        /// source/generation identify a cached value, so data reloaded from a spill file is not seen as new.
+        /// Returns whether the data is new to this sink.
+        bool setData(Core::Datatypes::DatatypeHandle data, PortDataCache::Key source = 0, size_t generation = 0);
         void invalidateProvider() override { /*TODO*/ }
         boost::signals2::connection connectDataHasChanged(const DataHasChangedSignalType::slot_type& subscriber) override;
         void forceFireDataHasChanged() override;
@@ -63,6 +66,8 @@ namespace SCIRun
 
       private:
         WeakDatatypeHandle weakData_;
+        PortDataCache::Key sourceKey_;
+        size_t sourceGeneration_;
         mutable bool hasChanged_;
         DataHasChangedSignalType dataHasChanged_;
         bool checkForNewDataOnSetting_;
@@ -94,11 +99,33 @@ namespace SCIRun
         virtual void send(DatatypeSinkInterfaceHandle receiver) const override;
         virtual bool hasData() const override;
         virtual std::string describeData() const override;
+        virtual void setRecomputeCost(double seconds) override;
 
         static void clearAllSources();
       protected:
-        SCIRun::Core::Datatypes::DatatypeHandle data_;
+        mutable SCIRun::Core::Datatypes::DatatypeHandle data_;
         static std::set<SimpleSource*> instances_;
+      private:
+        friend class PortDataCache;
+        enum SpilledType { NOT_SPILLED, SPILLED_FIELD, SPILLED_MATRIX };
+        /// NOT_SPILLED if the type cannot be persisted.
+        static SpilledType spillTypeOf(const Core::Datatypes::DatatypeHandle& data);
+        /// The file I/O runs without the cache mutex; the cache decides what to do with the result under it.
+        static bool writeSpill(const Core::Datatypes::DatatypeHandle& data, SpilledType type, const boost::filesystem::path& file);
+        static Core::Datatypes::DatatypeHandle readSpill(SpilledType type, const boost::filesystem::path& file);
+        static std::string describe(const Core::Datatypes::DatatypeHandle& data);
+        static void removeFile(const boost::filesystem::path& file);
+        /// Forgets the spill file and returns it, for removal once the cache mutex is released.
+        boost::filesystem::path releaseSpillFile() const;
+
+        PortDataCache::Key cacheKey_;
+        size_t generation_;
+        /// Sinks that received the current generation as new data
+        mutable size_t receivers_;
+        mutable SpilledType spilledType_;
+        mutable boost::filesystem::path spillFile_;
+        /// describeData of a spilled value, recorded when it was written out
+        mutable std::string spilledDescription_;
       };
     }
   }
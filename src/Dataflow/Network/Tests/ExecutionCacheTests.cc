@@ -0,0 +1,188 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/ExecutionCache.h>
+#include <Dataflow/State/SimpleMapModuleState.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/MatrixComparison.h>
+#include <Core/Datatypes/String.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/GeometryPrimitives/Tensor.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Dataflow::State;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::TestUtils;
+
+class ExecutionCacheTests : public ::testing::Test
+{
+protected:
+  virtual void SetUp() override
+  {
+    dir_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("execution-cache-test-%%%%%%%%");
+  }
+  virtual void TearDown() override
+  {
+    boost::filesystem::remove_all(dir_);
+  }
+  static ExecutionCache::Outputs outputsWith(double value)
+  {
+    ExecutionCache::Outputs outputs;
+    outputs.push_back(std::make_pair(PortId(0, "Result"), boost::make_shared<DenseMatrix>(DenseMatrix::Constant(20, 20, value))));
+    outputs.push_back(std::make_pair(PortId(1, "Unused"), DatatypeHandle()));
+    return outputs;
+  }
+  boost::filesystem::path dir_;
+};
+
+TEST_F(ExecutionCacheTests, KeyDependsOnModuleStateAndInputs)
+{
+  SimpleMapModuleState state;
+  state.setValue(Name("Tolerance"), 1e-6);
+  auto key = ExecutionCache::composeKey("BuildFEMatrix", state, { 42 });
+
+  EXPECT_EQ(key, ExecutionCache::composeKey("BuildFEMatrix", state, { 42 }));
+  EXPECT_NE(key, ExecutionCache::composeKey("BuildBEMatrix", state, { 42 }));
+  EXPECT_NE(key, ExecutionCache::composeKey("BuildFEMatrix", state, { 43 }));
+  EXPECT_NE(key, ExecutionCache::composeKey("BuildFEMatrix", state, { 42, 0 }));
+
+  state.setValue(Name("Tolerance"), 1.0000001e-6);
+  EXPECT_NE(key, ExecutionCache::composeKey("BuildFEMatrix", state, { 42 }));
+}
+
+TEST_F(ExecutionCacheTests, KeyDependsOnApplicationVersion)
+{
+  SimpleMapModuleState state;
+  ExecutionCache::setApplicationVersion("v5.0-beta.1 abc");
+  auto key = ExecutionCache::composeKey("BuildFEMatrix", state, { 42 });
+  ExecutionCache::setApplicationVersion("v5.0-beta.2 def");
+  EXPECT_NE(key, ExecutionCache::composeKey("BuildFEMatrix", state, { 42 }));
+  ExecutionCache::setApplicationVersion("");
+}
+
+TEST_F(ExecutionCacheTests, ChangedFieldPropertiesMissTheCache)
+{
+  ExecutionCache cache(dir_, 1 << 20);
+  cache.setEnabled(true);
+  SimpleMapModuleState state;
+  FieldHandle mesh = CubeTetVolLinearBasis(DOUBLE_E);
+  std::vector<std::pair<std::string, Tensor>> table { { "0", Tensor(1.0) } };
+  mesh->properties().set_property("conductivity_table", table, false);
+  auto key = ExecutionCache::composeKey("BuildFEMatrix", state, { mesh->contentHash() });
+  ASSERT_TRUE(cache.store(key, outputsWith(1)));
+
+  table[0].second = Tensor(2.0);
+  mesh->properties().set_property("conductivity_table", table, false);
+  ExecutionCache::Outputs restored;
+  EXPECT_FALSE(cache.lookup(ExecutionCache::composeKey("BuildFEMatrix", state, { mesh->contentHash() }), restored));
+}
+
+TEST_F(ExecutionCacheTests, StoreThenLookupRestoresOutputs)
+{
+  ExecutionCache cache(dir_, 1 << 20);
+  cache.setEnabled(true);
+  ExecutionCache::Outputs restored;
+  EXPECT_FALSE(cache.lookup("key", restored));
+  EXPECT_EQ(1u, cache.misses());
+
+  ASSERT_TRUE(cache.store("key", outputsWith(2.5)));
+  ASSERT_TRUE(cache.lookup("key", restored));
+  EXPECT_EQ(1u, cache.hits());
+
+  ASSERT_EQ(2u, restored.size());
+  EXPECT_EQ(0u, restored[0].first.id);
+  EXPECT_EQ("Result", restored[0].first.name);
+  auto matrix = boost::dynamic_pointer_cast<DenseMatrix>(restored[0].second);
+  ASSERT_TRUE(matrix != nullptr);
+  EXPECT_EQ(DenseMatrix(DenseMatrix::Constant(20, 20, 2.5)), *matrix);
+  EXPECT_EQ("Unused", restored[1].first.name);
+  EXPECT_FALSE(restored[1].second);
+}
+
+TEST_F(ExecutionCacheTests, EntriesSurviveAcrossInstances)
+{
+  {
+    ExecutionCache cache(dir_, 1 << 20);
+    cache.setEnabled(true);
+    cache.store("key", outputsWith(1));
+  }
+  ExecutionCache reopened(dir_, 1 << 20);
+  reopened.setEnabled(true);
+  EXPECT_EQ(1u, reopened.numberOfEntries());
+  EXPECT_GT(reopened.bytesUsed(), 20u * 20u * sizeof(double));
+  ExecutionCache::Outputs restored;
+  EXPECT_TRUE(reopened.lookup("key", restored));
+}
+
+TEST_F(ExecutionCacheTests, UnsupportedOutputTypesAreNotStored)
+{
+  ExecutionCache cache(dir_, 1 << 20);
+  cache.setEnabled(true);
+  ExecutionCache::Outputs outputs;
+  outputs.push_back(std::make_pair(PortId(0, "Text"), boost::make_shared<String>("hi")));
+  EXPECT_FALSE(cache.store("key", outputs));
+  EXPECT_FALSE(cache.contains("key"));
+}
+
+TEST_F(ExecutionCacheTests, LeastRecentlyUsedEntryIsEvicted)
+{
+  ExecutionCache cache(dir_, 1 << 20);
+  cache.setEnabled(true);
+  cache.store("a", outputsWith(1));
+  auto entryBytes = cache.bytesUsed();
+  cache.store("b", outputsWith(2));
+  ExecutionCache::Outputs restored;
+  cache.lookup("a", restored);
+
+  cache.setMaxBytes(2 * entryBytes + entryBytes / 2);
+  cache.store("c", outputsWith(3));
+
+  EXPECT_TRUE(cache.contains("a"));
+  EXPECT_FALSE(cache.contains("b"));
+  EXPECT_TRUE(cache.contains("c"));
+  EXPECT_LE(cache.bytesUsed(), cache.maxBytes());
+}
+
+TEST_F(ExecutionCacheTests, DisabledCacheNeitherStoresNorHits)
+{
+  ExecutionCache cache(dir_, 1 << 20);
+  EXPECT_FALSE(cache.enabled());
+  EXPECT_FALSE(cache.store("key", outputsWith(1)));
+  cache.setEnabled(true);
+  cache.store("key", outputsWith(1));
+  cache.setEnabled(false);
+  ExecutionCache::Outputs restored;
+  EXPECT_FALSE(cache.lookup("key", restored));
+  EXPECT_FALSE(cache.store("other", outputsWith(1)));
+}
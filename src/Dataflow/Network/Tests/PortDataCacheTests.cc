@@ -0,0 +1,188 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/SimpleSourceSink.h>
+#include <Dataflow/Network/PortDataCache.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/MatrixComparison.h>
+#include <Core/Datatypes/CopyOnWrite.h>
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Datatypes;
+
+namespace
+{
+  DenseMatrixHandle matrixOfSize(int n, double value)
+  {
+    return boost::make_shared<DenseMatrix>(DenseMatrix::Constant(n, n, value));
+  }
+
+  // 10x10 doubles
+  const size_t MatrixBytes = 800;
+}
+
+class PortDataCacheTests : public ::testing::Test
+{
+protected:
+  virtual void SetUp() override
+  {
+    spillDir_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("port-cache-test-%%%%%%%%");
+    cache().setSpillDirectory(spillDir_);
+  }
+  virtual void TearDown() override
+  {
+    cache().setMemoryBudget(0);
+    boost::filesystem::remove_all(spillDir_);
+  }
+  static PortDataCache& cache() { return PortDataCache::instance(); }
+  boost::filesystem::path spillDir_;
+};
+
+TEST_F(PortDataCacheTests, UnlimitedBudgetKeepsEverythingInMemory)
+{
+  auto spills = cache().spillCount();
+  auto bytes = cache().bytesInMemory();
+  SimpleSource a, b;
+  a.cacheData(matrixOfSize(10, 1));
+  b.cacheData(matrixOfSize(10, 2));
+  EXPECT_EQ(bytes + 2 * MatrixBytes, cache().bytesInMemory());
+  EXPECT_EQ(spills, cache().spillCount());
+}
+
+TEST_F(PortDataCacheTests, OverBudgetSpillsAndReloadsOnSend)
+{
+  SimpleSource a, b;
+  a.cacheData(matrixOfSize(10, 1));
+  auto spills = cache().spillCount();
+  auto reloads = cache().reloadCount();
+  cache().setMemoryBudget(cache().bytesInMemory() + MatrixBytes / 2);
+
+  b.cacheData(matrixOfSize(10, 2));
+  EXPECT_EQ(spills + 1, cache().spillCount());
+  EXPECT_TRUE(a.hasData());
+  EXPECT_FALSE(boost::filesystem::is_empty(spillDir_));
+
+  auto sink = boost::make_shared<SimpleSink>();
+  a.send(sink);
+  EXPECT_EQ(reloads + 1, cache().reloadCount());
+  auto received = boost::dynamic_pointer_cast<DenseMatrix>(*sink->receive());
+  ASSERT_TRUE(received != nullptr);
+  EXPECT_EQ(*matrixOfSize(10, 1), *received);
+  EXPECT_TRUE(sink->hasChanged());
+}
+
+TEST_F(PortDataCacheTests, DescribingSpilledDataDoesNotReloadIt)
+{
+  SimpleSource a, b;
+  a.cacheData(matrixOfSize(10, 12));
+  auto description = a.describeData();
+  cache().setMemoryBudget(cache().bytesInMemory() + MatrixBytes / 2);
+  b.cacheData(matrixOfSize(10, 13));
+
+  auto reloads = cache().reloadCount();
+  EXPECT_EQ(description, a.describeData());
+  EXPECT_EQ(reloads, cache().reloadCount());
+}
+
+TEST_F(PortDataCacheTests, SinkReloadsExpiredDataWithoutReportingChange)
+{
+  SimpleSource a, b;
+  auto sink = boost::make_shared<SimpleSink>();
+  a.cacheData(matrixOfSize(10, 3));
+  a.send(sink);
+  EXPECT_TRUE(sink->hasChanged());
+
+  cache().setMemoryBudget(cache().bytesInMemory() + MatrixBytes / 2);
+  b.cacheData(matrixOfSize(10, 4));
+
+  auto received = sink->receive();
+  ASSERT_TRUE(received);
+  EXPECT_EQ(*matrixOfSize(10, 3), *boost::dynamic_pointer_cast<DenseMatrix>(*received));
+
+  a.send(sink);
+  EXPECT_FALSE(sink->hasChanged());
+}
+
+TEST_F(PortDataCacheTests, ReceiversBeyondTheFirstCountAsShared)
+{
+  SimpleSource a;
+  auto first = boost::make_shared<SimpleSink>();
+  auto second = boost::make_shared<SimpleSink>();
+  auto third = boost::make_shared<SimpleSink>();
+  a.cacheData(matrixOfSize(10, 10));
+  CopyOnWriteStatistics::reset();
+
+  a.send(first);
+  EXPECT_EQ(0, CopyOnWriteStatistics::bytesShared());
+  a.send(second);
+  a.send(third);
+  EXPECT_EQ(2 * MatrixBytes, CopyOnWriteStatistics::bytesShared());
+
+  // sending the same data again shares nothing new
+  a.send(second);
+  EXPECT_EQ(2 * MatrixBytes, CopyOnWriteStatistics::bytesShared());
+
+  a.cacheData(matrixOfSize(10, 11));
+  a.send(first);
+  EXPECT_EQ(2 * MatrixBytes, CopyOnWriteStatistics::bytesShared());
+  a.send(second);
+  EXPECT_EQ(3 * MatrixBytes, CopyOnWriteStatistics::bytesShared());
+}
+
+TEST_F(PortDataCacheTests, DataHeldElsewhereIsNotSpilled)
+{
+  SimpleSource a, b;
+  auto held = matrixOfSize(10, 5);
+  a.cacheData(held);
+  auto spills = cache().spillCount();
+  cache().setMemoryBudget(cache().bytesInMemory() + MatrixBytes / 2);
+
+  b.cacheData(matrixOfSize(10, 6));
+  EXPECT_EQ(spills, cache().spillCount());
+}
+
+TEST_F(PortDataCacheTests, ExpensiveDataStaysInMemory)
+{
+  SimpleSource cheap, expensive, incoming;
+  expensive.cacheData(matrixOfSize(10, 7));
+  expensive.setRecomputeCost(100);
+  cheap.cacheData(matrixOfSize(10, 8));
+  cheap.setRecomputeCost(0.01);
+  cache().setMemoryBudget(cache().bytesInMemory() + MatrixBytes / 2);
+
+  incoming.cacheData(matrixOfSize(10, 9));
+  auto sinkCheap = boost::make_shared<SimpleSink>();
+  auto sinkExpensive = boost::make_shared<SimpleSink>();
+  auto reloads = cache().reloadCount();
+  expensive.send(sinkExpensive);
+  EXPECT_EQ(reloads, cache().reloadCount());
+  cheap.send(sinkCheap);
+  EXPECT_EQ(reloads + 1, cache().reloadCount());
+}
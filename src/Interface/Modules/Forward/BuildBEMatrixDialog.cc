@@ -58,6 +58,9 @@ BuildBEMatrixDialog::BuildBEMatrixDialog(const std::string& name, ModuleStateHan
   tableWidget->resizeColumnsToContents();
 
   connect(tableWidget, SIGNAL(cellChanged(int,int)), this, SLOT(pushTable(int,int)));
+
+  addCheckBoxManager(useHierarchicalMatrixCheckBox_, Parameters::UseHierarchicalMatrix);
+  addDoubleLineEditManager(hierarchicalMatrixToleranceLineEdit_, Parameters::HierarchicalMatrixTolerance);
 }
 
 void BuildBEMatrixDialog::updateFromPortChange(int numPorts, const std::string&, DynamicPortChange)
@@ -48,6 +48,7 @@ SolveInverseProblemWithTSVDDialog::SolveInverseProblemWithTSVDDialog(const std::
   lambdaMethod_.insert(StringPair("Direct entry", "single"));
   lambdaMethod_.insert(StringPair("Slider", "slider"));
   lambdaMethod_.insert(StringPair("L-curve", "lcurve"));
+  lambdaMethod_.insert(StringPair("GCV", "gcv"));
 
   addSpinBoxManager(lambdaNumberSpinBox_, Parameters::LambdaNum);
   addDoubleSpinBoxManager(lambdaDoubleSpinBox_, Parameters::LambdaFromDirectEntry);
@@ -60,12 +61,15 @@ SolveInverseProblemWithTSVDDialog::SolveInverseProblemWithTSVDDialog(const std::
   addDoubleSpinBoxManager(lambdaSliderDoubleSpinBox_, Parameters::LambdaSliderValue);
 
   addComboBoxManager(lambdaMethodComboBox_, Parameters::RegularizationMethod, lambdaMethod_);
+  addCheckBoxManager(lambdaPerTimeSampleCheckBox_, Parameters::LambdaPerTimeSample);
 
   connect(lambdaSlider_, SIGNAL(valueChanged(int)), this, SLOT(setSpinBoxValue(int)));
   connect(lambdaSliderDoubleSpinBox_, SIGNAL(valueChanged(double)), this, SLOT(setSliderValue(double)));
   connect(lambdaMinDoubleSpinBox_, SIGNAL(valueChanged(double)), this, SLOT(setSliderMin(double)));
   connect(lambdaMaxDoubleSpinBox_, SIGNAL(valueChanged(double)), this, SLOT(setSliderMax(double)));
   connect(lambdaResolutionDoubleSpinBox_, SIGNAL(valueChanged(double)), this, SLOT(setSliderStep(double)));
+  connect(lambdaMethodComboBox_, SIGNAL(currentIndexChanged(int)), this, SLOT(showLambdaMethodPage(int)));
+  showLambdaMethodPage(lambdaMethodComboBox_->currentIndex());
 
   WidgetStyleMixin::tabStyle(tabWidget);
 }
@@ -97,11 +101,17 @@ void SolveInverseProblemWithTSVDDialog::setSliderStep(double value)
   lambdaSlider_->setSingleStep(static_cast<int>(value));
 }
 
+// GCV has no page of its own: it sweeps the same lambda range as the L-curve
+void SolveInverseProblemWithTSVDDialog::showLambdaMethodPage(int index)
+{
+  stackedWidget->setCurrentIndex(index < stackedWidget->count() ? index : stackedWidget->count() - 1);
+}
+
 void SolveInverseProblemWithTSVDDialog::pullAndDisplayInfo()
 {
   auto str = transient_value_cast<std::string>(state_->getTransientValue("LambdaCurveInfo"));
   lCurveTextEdit_->setPlainText(QString::fromStdString(str));
-  auto lambda = transient_value_cast<double>(state_->getTransientValue("LambdaCorner"));
-  lCurveLambdaLineEdit_->setText(QString::number(lambda));
+  auto lambda = transient_value_cast<std::string>(state_->getTransientValue("LambdaCorner"));
+  lCurveLambdaLineEdit_->setText(QString::fromStdString(lambda));
   lCurvePlotWidgetHelper_.updatePlot(state_, plotTab_);
 }
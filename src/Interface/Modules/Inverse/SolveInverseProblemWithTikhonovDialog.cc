@@ -55,6 +55,7 @@ SolveInverseProblemWithTikhonovDialog::SolveInverseProblemWithTikhonovDialog(con
   lambdaMethod_.insert(StringPair("Direct entry", "single"));
   lambdaMethod_.insert(StringPair("Slider", "slider"));
   lambdaMethod_.insert(StringPair("L-curve", "lcurve"));
+  lambdaMethod_.insert(StringPair("GCV", "gcv"));
 
   WidgetStyleMixin::tabStyle(inputTabWidget_);
 
@@ -73,12 +74,15 @@ SolveInverseProblemWithTikhonovDialog::SolveInverseProblemWithTikhonovDialog(con
   addRadioButtonGroupManager({ residualConstraintRadioButton_, squaredResidualSolutionRadioButton_ }, Parameters::regularizationResidualSubcase);
 
   addComboBoxManager(lambdaMethodComboBox_, Parameters::RegularizationMethod, lambdaMethod_);
+  addCheckBoxManager(lambdaPerTimeSampleCheckBox_, Parameters::LambdaPerTimeSample);
 
   connect(lambdaSlider_, SIGNAL(valueChanged(int)), this, SLOT(setSpinBoxValue(int)));
   connect(lambdaSliderDoubleSpinBox_, SIGNAL(valueChanged(double)), this, SLOT(setSliderValue(double)));
   connect(lambdaMinDoubleSpinBox_, SIGNAL(valueChanged(double)), this, SLOT(setSliderMin(double)));
   connect(lambdaMaxDoubleSpinBox_, SIGNAL(valueChanged(double)), this, SLOT(setSliderMax(double)));
   connect(lambdaResolutionDoubleSpinBox_, SIGNAL(valueChanged(double)), this, SLOT(setSliderStep(double)));
+  connect(lambdaMethodComboBox_, SIGNAL(currentIndexChanged(int)), this, SLOT(showLambdaMethodPage(int)));
+  showLambdaMethodPage(lambdaMethodComboBox_->currentIndex());
 
   WidgetStyleMixin::tabStyle(tabWidget);
 }
@@ -109,12 +113,18 @@ void SolveInverseProblemWithTikhonovDialog::setSliderStep(double value)
   lambdaSlider_->setSingleStep(static_cast<int>(value));
 }
 
+// GCV has no page of its own: it sweeps the same lambda range as the L-curve
+void SolveInverseProblemWithTikhonovDialog::showLambdaMethodPage(int index)
+{
+  stackedWidget->setCurrentIndex(index < stackedWidget->count() ? index : stackedWidget->count() - 1);
+}
+
 void SolveInverseProblemWithTikhonovDialog::pullAndDisplayInfo()
 {
   auto str = transient_value_cast<std::string>(state_->getTransientValue("LambdaCurveInfo"));
   lCurveTextEdit_->setPlainText(QString::fromStdString(str));
-  auto lambda = transient_value_cast<double>(state_->getTransientValue("LambdaCorner"));
-  lCurveLambdaLineEdit_->setText(QString::number(lambda));
+  auto lambda = transient_value_cast<std::string>(state_->getTransientValue("LambdaCorner"));
+  lCurveLambdaLineEdit_->setText(QString::fromStdString(lambda));
   lCurvePlotWidgetHelper_.updatePlot(state_, plotTab_);
 }
 
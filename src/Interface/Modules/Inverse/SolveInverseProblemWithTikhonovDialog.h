@@ -63,6 +63,7 @@ private Q_SLOTS:
   void setSliderMin(double value);
   void setSliderMax(double value);
   void setSliderStep(double value);
+  void showLambdaMethodPage(int index);
   void pullAndDisplayInfo();
 private:
   LCurvePlotWidgetHelper lCurvePlotWidgetHelper_;
@@ -53,6 +53,8 @@ namespace SCIRun {
         solverNameLookup_.insert(StringPair("BiConjugate Gradient (SCI)", "bicg"));
         solverNameLookup_.insert(StringPair("Jacobi (SCI)", "jacobi"));
         solverNameLookup_.insert(StringPair("MINRES (SCI)", "minres"));
+        solverNameLookup_.insert(StringPair("GMRES (SCI)", "gmres"));
+        solverNameLookup_.insert(StringPair("Mixed precision CG (SCI)", "mixedcg"));
       }
       GuiStringTranslationMap solverNameLookup_;
     };
@@ -0,0 +1,264 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Interface/Modules/Render/ES/DepthSorter.h>
+#include <Core/Thread/Parallel.h>
+#include <Core/Logging/Log.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+namespace SCIRun {
+namespace Render {
+
+namespace
+{
+  const int RadixBits = 11;
+  const uint32_t NumBuckets = 1u << RadixBits;
+  const uint32_t MaxKey = (1u << DepthSorter::DepthBits) - 1;
+  /// Triangles per task; chunk c covers [c*ChunkSize, (c+1)*ChunkSize)
+  const size_t ChunkSize = 1 << 15;
+
+  uint32_t float_bits(float f)
+  {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+  }
+
+  float bits_float(uint32_t u)
+  {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+  }
+
+  void for_chunks(size_t numChunks, const std::function<void(size_t)>& body)
+  {
+    Parallel::For(0, numChunks, [&body](size_t begin, size_t end)
+    {
+      for (size_t c = begin; c < end; ++c)
+        body(c);
+    }, 1);
+  }
+
+  /// Turns the per chunk bucket counts into the position where each chunk
+  /// starts writing each bucket, so that the scatter is stable.
+  void bucket_offsets(std::vector<size_t>& counts, size_t numChunks)
+  {
+    size_t offset = 0;
+    for (uint32_t b = 0; b < NumBuckets; ++b)
+      for (size_t c = 0; c < numChunks; ++c)
+      {
+        const size_t count = counts[c * NumBuckets + b];
+        counts[c * NumBuckets + b] = offset;
+        offset += count;
+      }
+  }
+}
+
+TriangleBuffers::TriangleBuffers() :
+  vertices(nullptr),
+  stride(0),
+  indices(nullptr),
+  numTriangles(0)
+{}
+
+DepthSorter::DepthSorter(const TriangleBuffers& triangles) :
+  triangles_(triangles),
+  sorting_(false),
+  ready_(false)
+{}
+
+void DepthSorter::sort(const TriangleBuffers& triangles, const Vector& dir, uint32_t* out)
+{
+  Workspace workspace;
+  sort(triangles, dir, out, workspace);
+}
+
+void DepthSorter::sort(const TriangleBuffers& triangles, const Vector& dir,
+  uint32_t* out, Workspace& workspace)
+{
+  const size_t n = triangles.numTriangles;
+  if (n == 0)
+    return;
+
+  const size_t numChunks = (n + ChunkSize - 1) / ChunkSize;
+  auto chunkEnd = [n](size_t c) { return std::min(n, (c + 1) * ChunkSize); };
+
+  std::vector<uint32_t>& keys = workspace.keys[0];
+  std::vector<uint32_t>& sortedKeys = workspace.keys[1];
+  std::vector<uint32_t>& ids = workspace.ids;
+  std::vector<size_t>& counts = workspace.counts;
+  keys.resize(n);
+  sortedKeys.resize(n);
+  ids.resize(n);
+  counts.assign(numChunks * NumBuckets, 0);
+
+  const float d[3] = { static_cast<float>(dir.x()), static_cast<float>(dir.y()), static_cast<float>(dir.z()) };
+  const char* vertices = triangles.vertices;
+  const size_t stride = triangles.stride;
+  const uint32_t* indices = triangles.indices;
+
+  // Depth of each triangle, kept as float bits in keys until the range is known
+  std::vector<float> lo(numChunks), hi(numChunks);
+  for_chunks(numChunks, [&](size_t c)
+  {
+    float l = std::numeric_limits<float>::max();
+    float h = -std::numeric_limits<float>::max();
+    for (size_t j = c * ChunkSize; j < chunkEnd(c); ++j)
+    {
+      float depth = 0.0f;
+      for (int v = 0; v < 3; ++v)
+      {
+        const float* p = reinterpret_cast<const float*>(vertices + stride * indices[3 * j + v]);
+        depth += d[0] * p[0] + d[1] * p[1] + d[2] * p[2];
+      }
+      // NaN fails both comparisons and does not widen the range
+      if (depth < l) l = depth;
+      if (depth > h) h = depth;
+      keys[j] = float_bits(depth);
+    }
+    lo[c] = l;
+    hi[c] = h;
+  });
+
+  const float low = *std::min_element(lo.begin(), lo.end());
+  const float high = *std::max_element(hi.begin(), hi.end());
+  const double range = static_cast<double>(high) - low;
+  const float scale = (range > 0.0 && range < std::numeric_limits<double>::infinity()) ?
+    static_cast<float>(MaxKey / range) : 0.0f;
+
+  // Quantize, counting the low digit of each chunk on the way
+  for_chunks(numChunks, [&](size_t c)
+  {
+    size_t* count = &counts[c * NumBuckets];
+    for (size_t j = c * ChunkSize; j < chunkEnd(c); ++j)
+    {
+      const float t = (bits_float(keys[j]) - low) * scale;
+      const uint32_t key = t > 0.0f ? (t < MaxKey ? static_cast<uint32_t>(t) : MaxKey) : 0;
+      keys[j] = key;
+      ++count[key & (NumBuckets - 1)];
+    }
+  });
+  bucket_offsets(counts, numChunks);
+
+  // Low digit: keys and triangle ids into sortedKeys and ids
+  for_chunks(numChunks, [&](size_t c)
+  {
+    size_t* offset = &counts[c * NumBuckets];
+    for (size_t j = c * ChunkSize; j < chunkEnd(c); ++j)
+    {
+      const size_t to = offset[keys[j] & (NumBuckets - 1)]++;
+      sortedKeys[to] = keys[j];
+      ids[to] = static_cast<uint32_t>(j);
+    }
+  });
+
+  std::fill(counts.begin(), counts.end(), 0);
+  for_chunks(numChunks, [&](size_t c)
+  {
+    size_t* count = &counts[c * NumBuckets];
+    for (size_t j = c * ChunkSize; j < chunkEnd(c); ++j)
+      ++count[sortedKeys[j] >> RadixBits];
+  });
+  bucket_offsets(counts, numChunks);
+
+  // High digit: scatter the index triples straight into the output
+  for_chunks(numChunks, [&](size_t c)
+  {
+    size_t* offset = &counts[c * NumBuckets];
+    for (size_t j = c * ChunkSize; j < chunkEnd(c); ++j)
+    {
+      const size_t to = offset[sortedKeys[j] >> RadixBits]++;
+      const uint32_t* from = indices + 3 * static_cast<size_t>(ids[j]);
+      out[3 * to] = from[0];
+      out[3 * to + 1] = from[1];
+      out[3 * to + 2] = from[2];
+    }
+  });
+}
+
+bool DepthSorter::requestSort(const Vector& dir)
+{
+  if (sorting_)
+    return false;
+  sorting_ = true;
+  tasks_.run([this, dir]() { runSort(dir); });
+  return true;
+}
+
+void DepthSorter::runSort(const Vector& dir)
+{
+  try
+  {
+    pending_.resize(3 * triangles_.numTriangles);
+    sort(triangles_, dir, pending_.data(), workspace_);
+    pendingDirection_ = dir;
+    ready_ = true;
+  }
+  catch (const std::exception& e)
+  {
+    // The render thread keeps drawing the previous order
+    logError("Transparency depth sort failed: {}", e.what());
+  }
+  sorting_ = false;
+}
+
+void DepthSorter::sortNow(const Vector& dir)
+{
+  tasks_.wait();
+  indices_.resize(3 * triangles_.numTriangles);
+  sort(triangles_, dir, indices_.data(), workspace_);
+  direction_ = dir;
+  ready_ = false;
+}
+
+bool DepthSorter::isSorting() const
+{
+  return sorting_;
+}
+
+bool DepthSorter::takeResult()
+{
+  // ready_ is set before sorting_ is cleared, so a finished sort is complete here
+  if (sorting_ || !ready_)
+    return false;
+  indices_.swap(pending_);
+  direction_ = pendingDirection_;
+  ready_ = false;
+  return true;
+}
+
+} // namespace Render
+} // namespace SCIRun
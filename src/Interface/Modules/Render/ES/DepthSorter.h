@@ -0,0 +1,120 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INTERFACE_MODULES_RENDER_ES_DEPTHSORTER_H
+#define INTERFACE_MODULES_RENDER_ES_DEPTHSORTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <Core/GeometryPrimitives/Vector.h>
+#include <Core/Thread/ThreadPool.h>
+#include <Interface/Modules/Render/share.h>
+
+namespace SCIRun {
+namespace Render {
+
+/// Triangles of a uint32 index buffer over a vertex buffer whose vertices
+/// start with three float coordinates. The owners keep both buffers alive
+/// while a background sort reads them.
+struct SCISHARE TriangleBuffers
+{
+  TriangleBuffers();
+
+  const char*                 vertices;
+  size_t                      stride;
+  const uint32_t*             indices;
+  size_t                      numTriangles;
+  std::shared_ptr<const void> vertexOwner;
+  std::shared_ptr<const void> indexOwner;
+};
+
+/// View dependent ordering of transparent triangles. Triangles are ordered by
+/// increasing dot(dir, v1 + v2 + v3), which is back to front for the view
+/// direction the transparent passes use. Depths are quantized to DepthBits
+/// over their range and ordered with a stable parallel LSD radix sort, so
+/// triangles closer than one quantization step keep their index buffer order.
+///
+/// A sorter owns one index buffer worth of output that is reused by every
+/// sort. requestSort() runs on the shared thread pool while the render thread
+/// keeps drawing the previous order, and takeResult() picks up the new one.
+/// Apart from the background sort itself, a sorter is used from one thread.
+class SCISHARE DepthSorter : boost::noncopyable
+{
+public:
+  static const int DepthBits = 22;
+
+  explicit DepthSorter(const TriangleBuffers& triangles);
+
+  /// Writes the 3*numTriangles sorted indices to out on the calling thread.
+  static void sort(const TriangleBuffers& triangles, const Core::Geometry::Vector& dir, uint32_t* out);
+
+  /// Starts sorting for dir in the background. Returns false, and does
+  /// nothing, while a previous sort is still running.
+  bool requestSort(const Core::Geometry::Vector& dir);
+  /// Sorts for dir on the calling thread, once a background sort has finished.
+  void sortNow(const Core::Geometry::Vector& dir);
+  bool isSorting() const;
+  /// True once for each finished background sort; indices() then holds its order.
+  bool takeResult();
+
+  const std::vector<uint32_t>& indices() const { return indices_; }
+  /// The view direction indices() is sorted for
+  const Core::Geometry::Vector& direction() const { return direction_; }
+  const TriangleBuffers& triangles() const { return triangles_; }
+
+private:
+  struct Workspace
+  {
+    std::vector<uint32_t> keys[2];
+    std::vector<uint32_t> ids;
+    std::vector<size_t> counts;
+  };
+
+  static void sort(const TriangleBuffers& triangles, const Core::Geometry::Vector& dir,
+    uint32_t* out, Workspace& workspace);
+  void runSort(const Core::Geometry::Vector& dir);
+
+  TriangleBuffers triangles_;
+  std::vector<uint32_t> indices_;
+  std::vector<uint32_t> pending_;
+  Core::Geometry::Vector direction_;
+  Core::Geometry::Vector pendingDirection_;
+  Workspace workspace_;
+  std::atomic<bool> sorting_;
+  std::atomic<bool> ready_;
+  // Last, so that destruction waits for a running sort before the buffers go away
+  Core::Thread::TaskGroup tasks_;
+};
+
+} // namespace Render
+} // namespace SCIRun
+
+#endif
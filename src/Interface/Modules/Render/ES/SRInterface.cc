@@ -34,6 +34,7 @@
 
 #include <Interface/Modules/Render/ES/SRInterface.h>
 #include <Interface/Modules/Render/ES/SRCamera.h>
+#include <Interface/Modules/Render/ES/DepthSorter.h>
 
 #include <Core/Logging/Log.h>
 #include <Core/Application/Application.h>
@@ -899,11 +900,15 @@ namespace SCIRun {
             if (mRenderSortType == RenderState::TransparencySortType::LISTS_SORT)
             {
               RENDERER_LOG("Create sorted lists of Buffers for transparency in each direction of the axis.");
-              uint32_t* ibo_buffer = reinterpret_cast<uint32_t*>(ibo.data->getBuffer());
-              size_t num_triangles = ibo.data->getBufferSize() / (sizeof(uint32_t) * 3);
+              TriangleBuffers triangles;
+              triangles.vertices = vbo_buffer[nameIndex];
+              triangles.stride = stride_vbo[nameIndex];
+              triangles.indices = reinterpret_cast<const uint32_t*>(ibo.data->getBuffer());
+              triangles.numTriangles = ibo.data->getBufferSize() / (sizeof(uint32_t) * 3);
               Vector dir(0.0, 0.0, 0.0);
 
-              std::vector<DepthIndex> rel_depth(num_triangles);
+              // One sorted buffer, reused for each axis
+              std::vector<uint32_t> sorted(3 * triangles.numTriangles);
               for (int i = 0; i <= 6; ++i)
               {
                 std::string name = ibo.name;
@@ -944,40 +949,12 @@ namespace SCIRun {
                   dir = Vector(0.0, 0.0, -1.0);
                   name += "NegZ";
                 }
-                if (i > 0)
+                if (i > 0 && triangles.numTriangles > 0)
                 {
-                  for (size_t j = 0; j < num_triangles; j++)
-                  {
-                    float* vertex1 = reinterpret_cast<float*>(vbo_buffer[nameIndex] + stride_vbo[nameIndex] * (ibo_buffer[j * 3]));
-                    Point node1(vertex1[0], vertex1[1], vertex1[2]);
-
-                    float* vertex2 = reinterpret_cast<float*>(vbo_buffer[nameIndex] + stride_vbo[nameIndex] * (ibo_buffer[j * 3 + 1]));
-                    Point node2(vertex2[0], vertex2[1], vertex2[2]);
-
-                    float* vertex3 = reinterpret_cast<float*>(vbo_buffer[nameIndex] + stride_vbo[nameIndex] * (ibo_buffer[j * 3 + 2]));
-                    Point node3(vertex3[0], vertex3[1], vertex3[2]);
-
-                    rel_depth[j].mDepth = Dot(dir, node1) + Dot(dir, node2) + Dot(dir, node3);
-                    rel_depth[j].mIndex = j;
-                  }
-
-                  std::sort(rel_depth.begin(), rel_depth.end());
-
+                  DepthSorter::sort(triangles, dir, sorted.data());
                   int numPrimitives = ibo.data->getBufferSize() / ibo.indexSize;
-
-                  std::vector<char> sorted_buffer(ibo.data->getBufferSize());
-                  char* ibuffer = reinterpret_cast<char*>(ibo.data->getBuffer());
-                  char* sbuffer = !sorted_buffer.empty() ? reinterpret_cast<char*>(&sorted_buffer[0]) : 0;
-
-                  if (sbuffer && num_triangles > 0)
-                  {
-                    size_t tri_size = ibo.data->getBufferSize() / num_triangles;
-                    for (size_t j = 0; j < num_triangles; j++)
-                    {
-                      memcpy(sbuffer + j * tri_size, ibuffer + rel_depth[j].mIndex * tri_size, tri_size);
-                    }
-                    iboMan->addInMemoryIBO(sbuffer, ibo.data->getBufferSize(), primitive, primType, numPrimitives, name);
-                  }
+                  iboMan->addInMemoryIBO(sorted.data(), sorted.size() * sizeof(uint32_t),
+                    primitive, primType, numPrimitives, name);
                 }
               }
             }
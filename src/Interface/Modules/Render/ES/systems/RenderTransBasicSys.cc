@@ -26,6 +26,8 @@
  DEALINGS IN THE SOFTWARE.
 */
 
+#include <map>
+#include <memory>
 #include <glm/glm.hpp>
 #include <gl-platform/GLPlatform.hpp>
 #include <entity-system/GenericSystem.hpp>
@@ -58,6 +60,7 @@
 #include "../comp/StaticClippingPlanes.h"
 #include "../comp/LightingUniforms.h"
 #include "../comp/ClippingPlaneUniforms.h"
+#include "../DepthSorter.h"
 
 namespace es = spire;
 namespace shaders = spire;
@@ -114,102 +117,110 @@ public:
   }
 
 private:
+  /// Depth ordering of one transparent index buffer. Sorts run in the
+  /// background and are copied into the same buffer object when they finish;
+  /// until then the previous order, or the unsorted buffer, is drawn.
   class SortedObject
   {
   public:
-    std::string mName;
+    std::unique_ptr<DepthSorter> mSorter;
     GLuint mSortedID;
-    Core::Geometry::Vector prevDir = Core::Geometry::Vector(0.0);
+    Core::Geometry::Vector prevDir;
+    bool mVisited;
 
     SortedObject() :
-      mSortedID(0)
-    {}
-
-    SortedObject(const std::string& name, GLuint ID, Core::Geometry::Vector& dir) :
-      mName(name),
-      mSortedID(ID),
-      prevDir(dir)
+      mSortedID(0),
+      mVisited(false)
     {}
   };
 
-  std::vector<SortedObject> sortedObjects;
-
-  class DepthIndex {
-  public:
-    size_t mIndex;
-    double mDepth;
+  std::map<std::string, SortedObject> sortedObjects;
 
-    DepthIndex() :
-      mIndex(0),
-      mDepth(0.0)
-    {}
-
-    DepthIndex(size_t index, double depth) :
-      mIndex(index),
-      mDepth(depth)
-    {}
+  static TriangleBuffers triangleBuffers(const SpireSubPass& pass)
+  {
+    TriangleBuffers triangles;
+    triangles.vertices = reinterpret_cast<const char*>(pass.vbo.data->getBuffer());
+    for (const auto& a : pass.vbo.attributes)
+      triangles.stride += a.sizeInBytes;
+    triangles.indices = reinterpret_cast<const uint32_t*>(pass.ibo.data->getBuffer());
+    triangles.numTriangles = pass.ibo.data->getBufferSize() / (sizeof(uint32_t) * 3);
+    triangles.vertexOwner = pass.vbo.data;
+    triangles.indexOwner = pass.ibo.data;
+    return triangles;
+  }
 
-    bool operator<(const DepthIndex& di) const
+  /// Returns the sorted index buffer of the pass, or 0 while there is none.
+  /// A new sort starts once the view direction has moved by more than
+  /// threshold from the one last sorted for.
+  GLuint sortObjects(const Core::Geometry::Vector& dir, double threshold, const SpireSubPass& pass)
+  {
+    if (pass.ibo.prim != SpireIBO::PRIMITIVE::TRIANGLES || pass.ibo.indexSize != sizeof(uint32_t) ||
+      !pass.ibo.data || !pass.vbo.data)
     {
-      return this->mDepth < di.mDepth;
+      return 0;
     }
-  };
-
-  GLuint sortObjects(const Core::Geometry::Vector& dir,
-    const spire::ComponentGroup<ren::IBO>& ibo,
-    const spire::ComponentGroup<SpireSubPass>& pass,
-    const spire::ComponentGroup<ren::StaticIBOMan>& iboMan)
-  {
-    char* vbo_buffer = reinterpret_cast<char*>(pass.front().vbo.data->getBuffer());
-    uint32_t* ibo_buffer = reinterpret_cast<uint32_t*>(pass.front().ibo.data->getBuffer());
-    size_t num_triangles = pass.front().ibo.data->getBufferSize() / (sizeof(uint32_t) * 3);
 
-    size_t stride_vbo = 0;
-    for (auto a : pass.front().vbo.attributes)
-      stride_vbo += a.sizeInBytes;
+    SortedObject& object = sortedObjects[pass.ibo.name];
+    object.mVisited = true;
 
-    std::vector<DepthIndex> rel_depth(num_triangles);
-
-
-    for (size_t j = 0; j < num_triangles; j++)
+    // The geometry behind this name was replaced
+    if (!object.mSorter || object.mSorter->triangles().indexOwner != pass.ibo.data ||
+      object.mSorter->triangles().vertexOwner != pass.vbo.data)
     {
-      float* vertex1 = reinterpret_cast<float*>(vbo_buffer + stride_vbo * (ibo_buffer[j * 3]));
-      Core::Geometry::Point node1(vertex1[0], vertex1[1], vertex1[2]);
-
-      float* vertex2 = reinterpret_cast<float*>(vbo_buffer + stride_vbo * (ibo_buffer[j * 3 + 1]));
-      Core::Geometry::Point node2(vertex2[0], vertex2[1], vertex2[2]);
-
-      float* vertex3 = reinterpret_cast<float*>(vbo_buffer + stride_vbo * (ibo_buffer[j * 3 + 2]));
-      Core::Geometry::Point node3(vertex3[0], vertex3[1], vertex3[2]);
+      object.mSorter.reset(new DepthSorter(triangleBuffers(pass)));
+      if (object.mSortedID != 0)
+      {
+        GL(glDeleteBuffers(1, &object.mSortedID));
+        object.mSortedID = 0;
+      }
+      object.mSorter->requestSort(dir);
+      object.prevDir = dir;
+    }
 
-      rel_depth[j].mDepth = Core::Geometry::Dot(dir, node1) + Core::Geometry::Dot(dir, node2) + Core::Geometry::Dot(dir, node3);
-      rel_depth[j].mIndex = j;
+    DepthSorter& sorter = *object.mSorter;
+    if (sorter.takeResult())
+    {
+      const std::vector<uint32_t>& indices = sorter.indices();
+      const GLsizeiptr size = static_cast<GLsizeiptr>(indices.size() * sizeof(uint32_t));
+      if (object.mSortedID == 0)
+      {
+        GL(glGenBuffers(1, &object.mSortedID));
+        GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.mSortedID));
+        GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices.data(), GL_DYNAMIC_DRAW));
+      }
+      else
+      {
+        GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object.mSortedID));
+        GL(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, size, indices.data()));
+      }
     }
 
-    std::sort(rel_depth.begin(), rel_depth.end());
+    Core::Geometry::Vector diff = object.prevDir - dir;
+    if (Dot(diff, diff) > threshold * threshold && sorter.requestSort(dir))
+    {
+      object.prevDir = dir;
+    }
 
-    // setup index buffers
-    int numPrimitives = pass.front().ibo.data->getBufferSize() / pass.front().ibo.indexSize;
+    return object.mSortedID;
+  }
 
-    std::vector<char> sorted_buffer(pass.front().ibo.data->getBufferSize());
-    char* ibuffer = reinterpret_cast<char*>(pass.front().ibo.data->getBuffer());
-    char* sbuffer = !sorted_buffer.empty() ? reinterpret_cast<char*>(&sorted_buffer[0]) : 0;
-    GLuint result = ibo.front().glid;
-    if (sbuffer && num_triangles > 0)
+  void postWalkComponents(spire::ESCoreBase&) override
+  {
+    // Drop the buffers of objects that were not drawn transparent this frame
+    for (auto it = sortedObjects.begin(); it != sortedObjects.end();)
     {
-      size_t tri_size = pass.front().ibo.data->getBufferSize() / num_triangles;
-
-      for (size_t j = 0; j < num_triangles; j++)
+      if (!it->second.mVisited)
       {
-        memcpy(sbuffer + j * tri_size, ibuffer + rel_depth[j].mIndex * tri_size, tri_size);
+        if (it->second.mSortedID != 0)
+          GL(glDeleteBuffers(1, &it->second.mSortedID));
+        it = sortedObjects.erase(it);
+      }
+      else
+      {
+        it->second.mVisited = false;
+        ++it;
       }
-
-      std::string transIBOName = pass.front().ibo.name + "trans";
-      result = iboMan.front().instance_->addInMemoryIBO(sbuffer, pass.front().ibo.data->getBufferSize(), ibo.front().primMode, ibo.front().primType,
-        numPrimitives, transIBOName);
     }
-
-    return result;
   }
 
   void groupExecute(
@@ -270,40 +281,15 @@ private:
       switch (pass.front().renderState.mSortType)
       {
         case RenderState::TransparencySortType::CONTINUOUS_SORT:
-        {
-          iboID = sortObjects(dir, ibo, pass, iboMan);
-          break;
-        }
         case RenderState::TransparencySortType::UPDATE_SORT:
         {
-          unsigned int index = 0;
-          bool indexed = false;
-          for (int i = 0; i < sortedObjects.size(); ++i)
-          {
-            if (sortedObjects[i].mName == pass.front().ibo.name)
-            {
-              indexed = true;
-              index = i;
-            }
-          }
-          if (!indexed)
-          {
-            index = sortedObjects.size();
-            sortedObjects.push_back(SortedObject(pass.front().ibo.name, 0, dir));
-          }
-
-          Core::Geometry::Vector diff = sortedObjects[index].prevDir - dir;
-          double distance = sqrtf(Dot(diff, diff));
-          if (distance >= 1.23 || sortedObjects[index].mSortedID == 0)
-          {
-            if (sortedObjects[index].mSortedID != 0)
-            {
-              iboMan.front().instance_->removeInMemoryIBO(sortedObjects[index].mSortedID);
-            }
-            sortedObjects[index].prevDir = dir;
-            sortedObjects[index].mSortedID = sortObjects(dir, ibo, pass, iboMan);
-          }
-          iboID = sortedObjects[index].mSortedID;
+          // Continuous sorting follows every change of the view, updates
+          // wait for a noticeable turn (about 6 degrees)
+          const double threshold = pass.front().renderState.mSortType ==
+            RenderState::TransparencySortType::CONTINUOUS_SORT ? 0.0 : 0.1;
+          GLuint sortedID = sortObjects(dir, threshold, pass.front());
+          if (sortedID != 0)
+            iboID = sortedID;
           break;
         }
         case RenderState::TransparencySortType::LISTS_SORT:
@@ -579,14 +565,6 @@ private:
     }
 
 
-    if (!drawLines)
-    {
-      if (pass.front().renderState.mSortType == RenderState::TransparencySortType::CONTINUOUS_SORT)
-      {
-        iboMan.front().instance_->removeInMemoryIBO(iboID);
-      }
-    }
-
     if (depthMask)
     {
       GL(glDepthMask(GL_TRUE));
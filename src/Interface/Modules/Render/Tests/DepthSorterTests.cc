@@ -0,0 +1,242 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Interface/Modules/Render/ES/DepthSorter.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace SCIRun::Render;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  /// Random triangles over vertices laid out as position and normal, the
+  /// layout of the transparent surface passes
+  class TriangleSoup
+  {
+  public:
+    TriangleSoup(size_t numVertices, size_t numTriangles, unsigned seed = 3) :
+      vertices_(numVertices * 6), indices_(numTriangles * 3)
+    {
+      std::mt19937 gen(seed);
+      std::uniform_real_distribution<float> coord(-1.0f, 1.0f);
+      std::uniform_int_distribution<uint32_t> vertex(0, static_cast<uint32_t>(numVertices - 1));
+      for (auto& v : vertices_) v = coord(gen);
+      for (auto& i : indices_) i = vertex(gen);
+    }
+
+    TriangleBuffers buffers() const
+    {
+      TriangleBuffers t;
+      t.vertices = reinterpret_cast<const char*>(vertices_.data());
+      t.stride = 6 * sizeof(float);
+      t.indices = indices_.data();
+      t.numTriangles = indices_.size() / 3;
+      return t;
+    }
+
+    double depth(const uint32_t* tri, const Vector& dir) const
+    {
+      double depth = 0.0;
+      for (int v = 0; v < 3; ++v)
+      {
+        const float* p = &vertices_[6 * tri[v]];
+        depth += dir.x() * p[0] + dir.y() * p[1] + dir.z() * p[2];
+      }
+      return depth;
+    }
+
+    std::vector<float>& vertices() { return vertices_; }
+    std::vector<uint32_t>& indices() { return indices_; }
+    const std::vector<uint32_t>& indices() const { return indices_; }
+
+  private:
+    std::vector<float> vertices_;
+    std::vector<uint32_t> indices_;
+  };
+
+  std::vector<std::array<uint32_t, 3>> Triples(const std::vector<uint32_t>& indices)
+  {
+    std::vector<std::array<uint32_t, 3>> triples(indices.size() / 3);
+    for (size_t i = 0; i < triples.size(); ++i)
+      triples[i] = { { indices[3 * i], indices[3 * i + 1], indices[3 * i + 2] } };
+    return triples;
+  }
+
+  /// The sort the renderer used before: exact depths and std::sort
+  void ComparisonSort(const TriangleSoup& soup, const Vector& dir, std::vector<uint32_t>& out)
+  {
+    const size_t n = soup.indices().size() / 3;
+    std::vector<std::pair<double, size_t>> depths(n);
+    for (size_t j = 0; j < n; ++j)
+      depths[j] = std::make_pair(soup.depth(&soup.indices()[3 * j], dir), j);
+    std::sort(depths.begin(), depths.end(),
+      [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) { return a.first < b.first; });
+    for (size_t j = 0; j < n; ++j)
+      std::memcpy(&out[3 * j], &soup.indices()[3 * depths[j].second], 3 * sizeof(uint32_t));
+  }
+}
+
+TEST(DepthSorterTests, OrdersTrianglesBackToFrontAndKeepsEachTriangle)
+{
+  TriangleSoup soup(20000, 100000);
+  const Vector dir(0.3, -0.5, 0.8);
+  std::vector<uint32_t> sorted(soup.indices().size());
+  DepthSorter::sort(soup.buffers(), dir, sorted.data());
+
+  // Keys are quantized over the depth range, so neighbors may be out of
+  // order by up to one step
+  double lo = 1e10, hi = -1e10;
+  for (size_t j = 0; j < sorted.size() / 3; ++j)
+  {
+    lo = std::min(lo, soup.depth(&sorted[3 * j], dir));
+    hi = std::max(hi, soup.depth(&sorted[3 * j], dir));
+  }
+  const double step = (hi - lo) / (1 << DepthSorter::DepthBits);
+  for (size_t j = 1; j < sorted.size() / 3; ++j)
+    ASSERT_LE(soup.depth(&sorted[3 * (j - 1)], dir), soup.depth(&sorted[3 * j], dir) + 2 * step);
+
+  auto in = Triples(soup.indices());
+  auto out = Triples(sorted);
+  std::sort(in.begin(), in.end());
+  std::sort(out.begin(), out.end());
+  EXPECT_EQ(in, out);
+}
+
+TEST(DepthSorterTests, MatchesComparisonSortOnSeparatedDepths)
+{
+  // Triangles in planes z = k, given in a shuffled order
+  const size_t n = 70000;
+  TriangleSoup soup(3 * n, n);
+  std::vector<size_t> planes(n);
+  for (size_t k = 0; k < n; ++k) planes[k] = k;
+  std::shuffle(planes.begin(), planes.end(), std::mt19937(5));
+  for (size_t j = 0; j < n; ++j)
+  {
+    for (int v = 0; v < 3; ++v)
+    {
+      soup.indices()[3 * j + v] = static_cast<uint32_t>(3 * j + v);
+      soup.vertices()[6 * (3 * j + v) + 2] = static_cast<float>(planes[j]);
+    }
+  }
+
+  for (const Vector& dir : { Vector(0, 0, 1), Vector(0, 0, -1) })
+  {
+    std::vector<uint32_t> sorted(3 * n), expected(3 * n);
+    DepthSorter::sort(soup.buffers(), dir, sorted.data());
+    ComparisonSort(soup, dir, expected);
+    EXPECT_EQ(expected, sorted);
+  }
+}
+
+TEST(DepthSorterTests, EqualDepthsKeepIndexBufferOrder)
+{
+  TriangleSoup soup(1000, 50000);
+  for (size_t v = 0; v < 1000; ++v)
+    soup.vertices()[6 * v + 1] = 0.5f;
+
+  std::vector<uint32_t> sorted(soup.indices().size());
+  DepthSorter::sort(soup.buffers(), Vector(0, 1, 0), sorted.data());
+  EXPECT_EQ(soup.indices(), sorted);
+}
+
+TEST(DepthSorterTests, BackgroundSortIsPickedUpWhenDone)
+{
+  TriangleSoup soup(5000, 200000);
+  DepthSorter sorter(soup.buffers());
+  EXPECT_FALSE(sorter.takeResult());
+
+  const Vector dir(-1, 0.2, 0.1);
+  ASSERT_TRUE(sorter.requestSort(dir));
+  const auto start = std::chrono::steady_clock::now();
+  while (!sorter.takeResult())
+  {
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(30));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_FALSE(sorter.isSorting());
+  EXPECT_FALSE(sorter.takeResult());
+  EXPECT_EQ(dir, sorter.direction());
+
+  std::vector<uint32_t> expected(soup.indices().size());
+  DepthSorter::sort(soup.buffers(), dir, expected.data());
+  EXPECT_EQ(expected, sorter.indices());
+
+  // A synchronous sort waits for a background one and supersedes it
+  const Vector other(0, 0, 1);
+  ASSERT_TRUE(sorter.requestSort(dir));
+  sorter.sortNow(other);
+  EXPECT_FALSE(sorter.takeResult());
+  EXPECT_EQ(other, sorter.direction());
+  DepthSorter::sort(soup.buffers(), other, expected.data());
+  EXPECT_EQ(expected, sorter.indices());
+}
+
+TEST(DepthSorterTests, EmptyIndexBuffer)
+{
+  TriangleSoup soup(10, 0);
+  DepthSorter sorter(soup.buffers());
+  sorter.sortNow(Vector(1, 0, 0));
+  EXPECT_TRUE(sorter.indices().empty());
+}
+
+TEST(DepthSorterBenchmark, DISABLED_SortLatencyAgainstTriangleCount)
+{
+  const Vector dir(0.2, 0.9, -0.4);
+  std::cout << std::setw(12) << "triangles" << std::setw(16) << "std::sort ms"
+    << std::setw(14) << "radix ms" << std::setw(12) << "speedup" << std::endl;
+
+  for (size_t n : { 10000, 100000, 500000, 1000000, 2000000 })
+  {
+    TriangleSoup soup(n / 2, n);
+    std::vector<uint32_t> out(3 * n);
+
+    auto start = std::chrono::steady_clock::now();
+    ComparisonSort(soup, dir, out);
+    const double comparison = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    DepthSorter sorter(soup.buffers());
+    sorter.sortNow(dir);
+    const int repeats = 5;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r)
+      sorter.sortNow(dir);
+    const double radix = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeats;
+
+    std::cout << std::setw(12) << n << std::setw(16) << comparison
+      << std::setw(14) << radix << std::setw(12) << comparison / radix << std::endl;
+  }
+}
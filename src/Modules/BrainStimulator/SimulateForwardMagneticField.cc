@@ -53,6 +53,8 @@ SimulateForwardMagneticField::SimulateForwardMagneticField() : Module(staticInfo
 
 void SimulateForwardMagneticField::setStateDefaults()
 {
+  setStateBoolFromAlgo(Parameters::UseTreecode);
+  setStateDoubleFromAlgo(Parameters::TreecodeTolerance);
 }
 
 void SimulateForwardMagneticField::execute()
@@ -64,6 +66,8 @@ void SimulateForwardMagneticField::execute()
 
   if (needToExecute())
   {
+    setAlgoBoolFromState(Parameters::UseTreecode);
+    setAlgoDoubleFromState(Parameters::TreecodeTolerance);
      auto output = algo().run(make_input((ElectricField, EField)(ConductivityTensor, CondTensor)(DipoleSources, Dipoles)(DetectorLocations, Detectors)));
     sendOutputFromAlgorithm(MagneticField, output);
     sendOutputFromAlgorithm(MagneticFieldMagnitudes, output);
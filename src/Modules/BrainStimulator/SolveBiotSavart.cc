@@ -56,6 +56,8 @@ void SolveBiotSavart::setStateDefaults()
 {
   auto state = get_state();
   setStateIntFromAlgo(Parameters::OutType);
+  setStateBoolFromAlgo(Parameters::UseTreecode);
+  setStateDoubleFromAlgo(Parameters::TreecodeTolerance);
 }
 
 void SolveBiotSavart::execute()
@@ -85,6 +87,8 @@ void SolveBiotSavart::execute()
 
   if (needToExecute())  //newStatePresent
   {
+    setAlgoBoolFromState(Parameters::UseTreecode);
+    setAlgoDoubleFromState(Parameters::TreecodeTolerance);
     auto input = make_input((Mesh, mesh)(Coil, coil));
 
     if ((oport_connected(VectorBField) || oport_connected(VectorAField)))
@@ -168,6 +168,10 @@ void GenericWriter<HType, PortTag, PortDescriber>::execute()
       {
         stream = auto_ostream(filename_, "Binary", getLogger());
       }
+      else if (filetype_ == "Compressed")
+      {
+        stream = auto_ostream(filename_, "Compressed", getLogger());
+      }
       else
       {
         stream = auto_ostream(filename_, "Text", getLogger());
@@ -180,6 +184,11 @@ void GenericWriter<HType, PortTag, PortDescriber>::execute()
       else
       {
         Pio(*stream, handle_);
+        stream->finish();
+        if (stream->error())
+        {
+          MODULE_ERROR_WITH_TYPE(Dataflow::Networks::GeneralModuleError, "Could not write file " + filename_);
+        }
       }
     }
   }
@@ -98,7 +98,8 @@ void ApplyFEMVoltageSource::execute()
     }
     else
     {
-      odirichletMatrix.reset((*dirichlet)->clone());
+      // only read by the algorithm, so share the input instead of copying it
+      odirichletMatrix = *dirichlet;
     }
   }
   else
@@ -68,6 +68,8 @@ void BuildBEMatrix::setStateDefaults()
   get_state()->setValue(Parameters::BoundaryConditionList, VariableList());
   get_state()->setValue(Parameters::OutsideConductivityList, VariableList());
   get_state()->setValue(Parameters::InsideConductivityList, VariableList());
+  get_state()->setValue(Parameters::UseHierarchicalMatrix, false);
+  get_state()->setValue(Parameters::HierarchicalMatrixTolerance, 1e-6);
 }
 
 void BuildBEMatrix::execute()
@@ -82,7 +84,11 @@ void BuildBEMatrix::execute()
     auto outsideConds = state->getValue(Parameters::OutsideConductivityList).toVector();
     auto insideConds = state->getValue(Parameters::InsideConductivityList).toVector();
 
-    BuildBEMatrixImpl impl(fieldNames, boundaryConditions, outsideConds, insideConds, this);
+    BEMCompression compression;
+    compression.enabled = state->getValue(Parameters::UseHierarchicalMatrix).toBool();
+    compression.tolerance = state->getValue(Parameters::HierarchicalMatrixTolerance).toDouble();
+
+    BuildBEMatrixImpl impl(fieldNames, boundaryConditions, outsideConds, insideConds, compression, this);
     MatrixHandle transferMatrix = impl.executeImpl(inputs);
     auto fieldTypes = impl.getInputTypes();
     state->setTransientValue(Parameters::FieldTypeList, fieldTypes);
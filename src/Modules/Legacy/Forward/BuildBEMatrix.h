@@ -46,6 +46,7 @@ namespace SCIRun {
         void setStateDefaults() override;
         void execute() override;
         HAS_DYNAMIC_PORTS
+        CACHEABLE_EXECUTION
 
         INPUT_PORT_DYNAMIC(0, Surface, Field);
         OUTPUT_PORT(0, BEM_Forward_Matrix, Matrix);
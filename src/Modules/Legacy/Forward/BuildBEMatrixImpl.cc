@@ -46,6 +46,7 @@
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Logging/LoggerInterface.h>
+#include <sstream>
 
 using namespace SCIRun;
 using namespace SCIRun::Modules::Forward;
@@ -58,11 +59,13 @@ BuildBEMatrixImpl::BuildBEMatrixImpl(const VariableList& names,
   const VariableList& bdyConds,
   const VariableList& outside,
   const VariableList& inside,
+  const BEMCompression& compression,
   LegacyLoggerInterface* log) : 
   names_(names),
   bdyConds_(bdyConds),
   outside_(outside),
   inside_(inside),
+  compression_(compression),
   log_(log)
 {
 
@@ -137,5 +140,19 @@ MatrixHandle BuildBEMatrixImpl::executeImpl(const FieldList& inputs)
     log_->error("The combinations of input properties is not supported. Please see documentation for supported input field options.");
     return nullptr;
   }
-  return BEMalgo->compute(fields);
+
+  if (compression_.enabled && compression_.tolerance <= 0)
+    THROW_INVALID_ARGUMENT("The hierarchical matrix tolerance must be positive.");
+  BEMalgo->setCompression(compression_);
+  auto transfer = BEMalgo->compute(fields);
+
+  if (compression_.enabled)
+  {
+    const BEMStatistics& statistics = BEMalgo->statistics();
+    std::ostringstream ostr;
+    ostr << "Compressed BEM blocks: " << statistics.storedBytes / (1024 * 1024) << " MB instead of "
+      << statistics.denseBytes / (1024 * 1024) << " MB dense, largest rank " << statistics.largestRank << ".";
+    log_->remark(ostr.str());
+  }
+  return transfer;
 }
@@ -33,6 +33,7 @@
 #include <Core/Logging/LoggerFwd.h>
 #include <Core/Datatypes/DatatypeFwd.h>
 #include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/Legacy/Forward/BuildBEMatrixAlgo.h>
 #include <Modules/Legacy/Forward/share.h>
 
 namespace SCIRun {
@@ -47,6 +48,7 @@ namespace SCIRun {
           const Core::Algorithms::VariableList& bdyConds,
           const Core::Algorithms::VariableList& outside,
           const Core::Algorithms::VariableList& inside,
+          const Core::Algorithms::Forward::BEMCompression& compression,
           Core::Logging::LegacyLoggerInterface* log);
 
         Core::Datatypes::MatrixHandle executeImpl(const FieldList& inputs);
@@ -56,6 +58,7 @@ namespace SCIRun {
         const Core::Algorithms::VariableList& bdyConds_;
         const Core::Algorithms::VariableList& outside_;
         const Core::Algorithms::VariableList& inside_;
+        Core::Algorithms::Forward::BEMCompression compression_;
         const Core::Logging::LegacyLoggerInterface* log_;
         std::vector<std::string> inputTypes_;
       };
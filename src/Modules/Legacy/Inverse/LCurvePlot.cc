@@ -37,6 +37,7 @@
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Algorithms/Base/AlgorithmBase.h>
 #include <Modules/Legacy/Inverse/SolveInverseProblemWithTikhonov.h>
+#include <algorithm>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
@@ -50,20 +51,35 @@ LCurvePlot::LCurvePlot()
 std::string LCurvePlot::update_lcurve_gui(const std::string& module_id,
   const DenseMatrixHandle& lambda, const DenseMatrixHandle& input, const DenseMatrixHandle& lambda_index)
 {
-  int lam_ind = static_cast<int>(lambda_index->get(0,0));
-
   size_t nLambda = input->rows();
 
   auto eta = input->col(1);
   auto rho = input->col(2);
 
-  //estimate L curve corner
-  const double lower_y = std::min(eta[0] / 10.0, eta[nLambda - 1]);
-
   std::ostringstream str;
   str << module_id << " plot_graph \" ";
   for (int k = 0; k < nLambda; k++)    str << log10(rho[k]) << " " << log10(eta[k]) << " ";
 
+  // one lambda per time sample: each was picked on the curve of its own sample, so
+  // none of them marks a corner of the curve over all samples
+  if (lambda->nrows() > 1)
+  {
+    std::vector<double> lambdas(lambda->data(), lambda->data() + lambda->nrows());
+    std::sort(lambdas.begin(), lambdas.end());
+    std::ostringstream range;
+    range << lambdas.front() << " - " << lambdas.back() << " (median " << lambdas[lambdas.size() / 2] << ")";
+    lambdaText_ = range.str();
+    cornerPlot_.clear();
+
+    str << "\" \" \" " << lambdaText_ << " ; \n";
+    return str.str();
+  }
+
+  int lam_ind = static_cast<int>(lambda_index->get(0,0));
+
+  //estimate L curve corner
+  const double lower_y = std::min(eta[0] / 10.0, eta[nLambda - 1]);
+
   cornerPlot_.assign({log10(rho[0] / 10.0), log10(eta[lam_ind]), log10(rho[lam_ind]), log10(eta[lam_ind]), log10(rho[lam_ind]), log10(lower_y)});
 
   str << "\" \" " << cornerPlot_[0] << " " << cornerPlot_[1] << " ";
@@ -71,5 +87,9 @@ std::string LCurvePlot::update_lcurve_gui(const std::string& module_id,
   str << cornerPlot_[4] << " " << cornerPlot_[5] << " \" ";
   str << lambda->get(0,0) << " " << lam_ind << " ; \n";
 
+  std::ostringstream corner;
+  corner << lambda->get(0,0);
+  lambdaText_ = corner.str();
+
   return str.str();
 }
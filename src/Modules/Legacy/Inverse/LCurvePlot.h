@@ -48,9 +48,13 @@ namespace Inverse {
       const SCIRun::Core::Datatypes::DenseMatrixHandle& lambda,
       const SCIRun::Core::Datatypes::DenseMatrixHandle& input,
       const SCIRun::Core::Datatypes::DenseMatrixHandle& lambda_index);
+		/// Empty when a lambda was chosen per time sample: their corners are not on the plotted curve
 		const std::vector<double>& cornerPlot() const { return cornerPlot_; }
+		/// The chosen lambda, or the range and median of the lambdas chosen per time sample
+		const std::string& lambdaText() const { return lambdaText_; }
 	private:
 		std::vector<double> cornerPlot_;
+		std::string lambdaText_;
 	};
 }}}
 
@@ -82,6 +82,7 @@ void SolveInverseProblemWithTSVD::setStateDefaults()
   setStateStringFromAlgoOption(Parameters::RegularizationMethod);
   setStateDoubleFromAlgo(Parameters::LambdaFromDirectEntry);
   setStateDoubleFromAlgo(Parameters::LambdaSliderValue);
+  setStateBoolFromAlgo(Parameters::LambdaPerTimeSample);
 }
 
 void SolveInverseProblemWithTSVD::execute()
@@ -140,6 +141,7 @@ void SolveInverseProblemWithTSVD::execute()
 		setAlgoDoubleFromState(Parameters::LambdaMax);
 		setAlgoIntFromState(Parameters::LambdaNum);
 		setAlgoDoubleFromState(Parameters::LambdaSliderValue);
+		setAlgoBoolFromState(Parameters::LambdaPerTimeSample);
 
 		// run
 		auto output = algo().run(
@@ -168,7 +170,7 @@ void SolveInverseProblemWithTSVD::execute()
     {
 			LCurvePlot helper;
       auto str = helper.update_lcurve_gui(get_id(),lambda,lambda_array,lambda_index);
-      state->setTransientValue("LambdaCorner", lambda->get(0,0));
+      state->setTransientValue("LambdaCorner", helper.lambdaText());
       state->setTransientValue("LambdaCurveInfo", str);
       state->setTransientValue("LambdaCurve", lambda_array);
       state->setTransientValue("LambdaCornerPlot", helper.cornerPlot());
@@ -75,6 +75,7 @@ void SolveInverseProblemWithTikhonov::setStateDefaults()
 	setStateIntFromAlgo(Parameters::LambdaNum);
 	setStateDoubleFromAlgo(Parameters::LambdaResolution);
 	setStateDoubleFromAlgo(Parameters::LambdaSliderValue);
+	setStateBoolFromAlgo(Parameters::LambdaPerTimeSample);
 	setStateIntFromAlgo(Parameters::regularizationSolutionSubcase);
 	setStateIntFromAlgo(Parameters::regularizationResidualSubcase);
 }
@@ -106,6 +107,7 @@ void SolveInverseProblemWithTikhonov::execute()
     setAlgoIntFromState(Parameters::LambdaNum);
     setAlgoDoubleFromState(Parameters::LambdaResolution);
     setAlgoDoubleFromState(Parameters::LambdaSliderValue);
+    setAlgoBoolFromState(Parameters::LambdaPerTimeSample);
     setAlgoIntFromState(Parameters::regularizationSolutionSubcase);
     setAlgoIntFromState(Parameters::regularizationResidualSubcase);
 
@@ -126,7 +128,7 @@ void SolveInverseProblemWithTikhonov::execute()
     {
 			LCurvePlot helper;
       auto str = helper.update_lcurve_gui(get_id(),lambda,lambda_array,lambda_index);
-      state->setTransientValue("LambdaCorner", lambda->get(0,0));
+      state->setTransientValue("LambdaCorner", helper.lambdaText());
       state->setTransientValue("LambdaCurveInfo", str);
       state->setTransientValue("LambdaCurve", lambda_array);
 			state->setTransientValue("LambdaCornerPlot", helper.cornerPlot());
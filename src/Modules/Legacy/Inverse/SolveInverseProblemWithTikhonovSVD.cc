@@ -79,6 +79,7 @@ void SolveInverseProblemWithTikhonovSVD::setStateDefaults()
 	setStateIntFromAlgo(Parameters::LambdaNum);
 	setStateDoubleFromAlgo(Parameters::LambdaResolution);
 	setStateDoubleFromAlgo(Parameters::LambdaSliderValue);
+	setStateBoolFromAlgo(Parameters::LambdaPerTimeSample);
 }
 
 // execute function
@@ -112,6 +113,7 @@ void SolveInverseProblemWithTikhonovSVD::execute()
 		setAlgoIntFromState(Parameters::LambdaNum);
 		setAlgoDoubleFromState(Parameters::LambdaResolution);
 		setAlgoDoubleFromState(Parameters::LambdaSliderValue);
+		setAlgoBoolFromState(Parameters::LambdaPerTimeSample);
 
 		// run
 		auto output = algo().run(
@@ -141,7 +143,7 @@ void SolveInverseProblemWithTikhonovSVD::execute()
     {
 			LCurvePlot helper;
       auto str = helper.update_lcurve_gui(get_id(),lambda,lambda_array,lambda_index);
-      state->setTransientValue("LambdaCorner", lambda->get(0,0));
+      state->setTransientValue("LambdaCorner", helper.lambdaText());
       state->setTransientValue("LambdaCurveInfo", str);
       state->setTransientValue("LambdaCurve", lambda_array);
 			state->setTransientValue("LambdaCornerPlot", helper.cornerPlot());
@@ -42,6 +42,7 @@
 // Tikhonov specific
 #include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithStandardTikhonovImpl.h>
 #include <Modules/Legacy/Inverse/SolveInverseProblemWithTikhonov.h>
+#include <Modules/Legacy/Inverse/LCurvePlot.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Testing;
@@ -599,3 +600,38 @@ TEST_F(TikhonovFunctionalTest, loadIDNonSquaredMeasurementReguWithSquareOptionWr
     EXPECT_THROW(tikAlgImp->execute(), SCIRun::Core::DimensionMismatch);
 }
 */
+
+namespace
+{
+  // lambda, rho and eta of a three point L-curve
+  DenseMatrixHandle lcurve()
+  {
+    auto curve = boost::make_shared<DenseMatrix>(3, 3);
+    *curve << 0.01, 1.0, 100.0,
+              0.1, 2.0, 10.0,
+              1.0, 50.0, 5.0;
+    return curve;
+  }
+}
+
+TEST(LCurvePlotTest, SingleLambdaMarksCorner)
+{
+  LCurvePlot helper;
+  helper.update_lcurve_gui("tik", boost::make_shared<DenseMatrix>(1, 1, 0.1), lcurve(), boost::make_shared<DenseMatrix>(1, 1, 1.0));
+  EXPECT_EQ(6u, helper.cornerPlot().size());
+  EXPECT_EQ("0.1", helper.lambdaText());
+}
+
+TEST(LCurvePlotTest, LambdaPerTimeSampleReportsRangeWithoutCorner)
+{
+  auto lambdas = boost::make_shared<DenseMatrix>(3, 1);
+  *lambdas << 1.0, 0.01, 0.1;
+  auto indices = boost::make_shared<DenseMatrix>(3, 1);
+  *indices << 2, 0, 1;
+
+  LCurvePlot helper;
+  auto info = helper.update_lcurve_gui("tik", lambdas, lcurve(), indices);
+  EXPECT_TRUE(helper.cornerPlot().empty());
+  EXPECT_EQ("0.01 - 1 (median 0.1)", helper.lambdaText());
+  EXPECT_NE(std::string::npos, info.find(helper.lambdaText()));
+}
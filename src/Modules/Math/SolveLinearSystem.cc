@@ -66,14 +66,18 @@ void SolveLinearSystem::execute()
   if (needToExecute())
   {
     /// @todo: why aren't these checks in the algo class?
-    if (rhs->ncols() != 1)
-      THROW_ALGORITHM_INPUT_ERROR("Right-hand side matrix must contain only one column.");
     if (!matrixIs::sparse(A))
       THROW_ALGORITHM_INPUT_ERROR("Left-hand side matrix to solve must be sparse.");
 
-    auto rhsCol = castMatrix::toColumn(rhs);
-    if (!rhsCol)
-      rhsCol = convertMatrix::toColumn(rhs);
+    // several columns are solved together by the algorithm's block mode
+    MatrixHandle rhsInput = rhs;
+    if (rhs->ncols() == 1)
+    {
+      auto rhsCol = castMatrix::toColumn(rhs);
+      if (!rhsCol)
+        rhsCol = convertMatrix::toColumn(rhs);
+      rhsInput = rhsCol;
+    }
 
     auto tolerance = get_state()->getValue(Variables::TargetError).toDouble();
     auto maxIterations = get_state()->getValue(Variables::MaxIterations).toInt();
@@ -99,7 +103,7 @@ void SolveLinearSystem::execute()
       ScopedTimeRemarker perf(this, "Linear solver");
       remark("Using preconditioner: " + precond);
 
-      auto output = algo().run(withInputData((LHS, A)(RHS, rhsCol)));
+      auto output = algo().run(withInputData((LHS, A)(RHS, rhsInput)));
 
       sendOutputFromAlgorithm(Solution, output);
     }
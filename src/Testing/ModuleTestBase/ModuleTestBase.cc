@@ -45,6 +45,7 @@
 #include <Core/Logging/Log.h>
 #include <Dataflow/Network/SimpleSourceSink.h>
 #include <Dataflow/Network/ModuleBuilder.h>
+#include <Dataflow/Network/ExecutionCache.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
@@ -117,6 +118,8 @@ void ModuleTestBase::initModuleParameters(bool verbose)
   DefaultValue<AlgorithmOutput>::Set(AlgorithmOutput());
   DefaultValue<AlgorithmInput>::Set(AlgorithmInput());
   LogSettings::Instance().setVerbose(verbose);
+  // module tests must actually run the module, not replay a previous test run
+  ExecutionCache::instance().setEnabled(false);
 }
 
 ModuleHandle ModuleTestBase::makeModule(const std::string& name)